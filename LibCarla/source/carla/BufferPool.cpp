@@ -0,0 +1,176 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/BufferPool.h"
+
+#include "carla/Debug.h"
+
+#include <algorithm>
+
+namespace carla {
+
+  // ===========================================================================
+  // -- Buckets ----------------------------------------------------------------
+  // ===========================================================================
+
+  /// Bucket 0 holds buffers of up to 64 bytes, then every power of two is
+  /// split in four buckets so a buffer is at most 25% bigger than requested.
+  static constexpr uint64_t MIN_BUCKET_CAPACITY_LOG2 = 6u;
+  static constexpr uint64_t MIN_BUCKET_CAPACITY = 1u << MIN_BUCKET_CAPACITY_LOG2;
+  static constexpr uint64_t BUCKETS_PER_POWER_OF_TWO = 4u;
+
+  static uint64_t FloorLog2(uint64_t value) {
+    uint64_t result = 0u;
+    while (value >>= 1u) {
+      ++result;
+    }
+    return result;
+  }
+
+  static uint64_t BucketCapacity(size_t index) {
+    if (index == 0u) {
+      return MIN_BUCKET_CAPACITY;
+    }
+    const uint64_t power = MIN_BUCKET_CAPACITY_LOG2 + (index - 1u) / BUCKETS_PER_POWER_OF_TWO;
+    const uint64_t step = (index - 1u) % BUCKETS_PER_POWER_OF_TWO + 1u;
+    return (uint64_t(1u) << power) + step * (uint64_t(1u) << (power - 2u));
+  }
+
+  /// Smallest bucket whose capacity fits @a size bytes.
+  static size_t BucketCeil(uint64_t size) {
+    if (size <= MIN_BUCKET_CAPACITY) {
+      return 0u;
+    }
+    const uint64_t power = FloorLog2(size - 1u);
+    const uint64_t lower_bound = uint64_t(1u) << power;
+    const uint64_t step_size = lower_bound >> 2u;
+    const uint64_t step = (size - lower_bound + step_size - 1u) / step_size;
+    return static_cast<size_t>(
+        (power - MIN_BUCKET_CAPACITY_LOG2) * BUCKETS_PER_POWER_OF_TWO + step);
+  }
+
+  /// Biggest bucket whose capacity is not bigger than @a capacity, every buffer
+  /// in a bucket has at least the capacity of the bucket (except for bucket 0).
+  static size_t BucketFloor(uint64_t capacity) {
+    const size_t index = BucketCeil(capacity);
+    return ((index == 0u) || (BucketCapacity(index) == capacity)) ? index : index - 1u;
+  }
+
+  size_t BufferPool::GetBucketCapacity(size_t size) {
+    const uint64_t capacity = BucketCapacity(BucketCeil(size));
+    return static_cast<size_t>(std::min<uint64_t>(capacity, Buffer::max_size()));
+  }
+
+  // ===========================================================================
+  // -- BufferPool -------------------------------------------------------------
+  // ===========================================================================
+
+  BufferPool::~BufferPool() {
+    for (auto &bucket : _buckets) {
+      delete bucket.queue.load(std::memory_order_acquire);
+    }
+  }
+
+  Buffer BufferPool::Pop() {
+    Buffer item;
+    bool found = false;
+    for (auto i = 0u; (i < _buckets.size()) && !found; ++i) {
+      found = TryPop(i, item);
+    }
+    ++(found ? _hits : _misses);
+    SetParentPool(item);
+    return item;
+  }
+
+  Buffer BufferPool::Pop(size_t size) {
+    DEBUG_ASSERT(size <= Buffer::max_size());
+    Buffer item;
+    const size_t index = BucketCeil(size);
+    // The next bucket wastes at most a quarter of the buffer.
+    const bool found =
+        TryPop(index, item) ||
+        ((index + 1u < _buckets.size()) && TryPop(index + 1u, item));
+    ++(found ? _hits : _misses);
+    // Allocate the whole bucket capacity so the buffer returns to this bucket.
+    item.reset(static_cast<uint64_t>(GetBucketCapacity(size)));
+    item.reset(static_cast<uint64_t>(size));
+    SetParentPool(item);
+    return item;
+  }
+
+  void BufferPool::SetMaxRetainedBytes(size_t max_bytes) {
+    _max_retained_bytes = max_bytes;
+    Trim(max_bytes);
+  }
+
+  void BufferPool::Trim(size_t max_bytes) {
+    for (auto i = _buckets.size(); i > 0u; --i) {
+      Buffer item;
+      while ((_retained_bytes.load() > max_bytes) && TryPop(i - 1u, item)) {
+        ++_discarded;
+        item.clear();
+      }
+    }
+  }
+
+  BufferPool::Statistics BufferPool::GetStatistics() const {
+    Statistics result;
+    result.hits = _hits.load(std::memory_order_relaxed);
+    result.misses = _misses.load(std::memory_order_relaxed);
+    result.discarded = _discarded.load(std::memory_order_relaxed);
+    result.retained_bytes = _retained_bytes.load(std::memory_order_relaxed);
+    result.high_water_mark = _high_water_mark.load(std::memory_order_relaxed);
+    return result;
+  }
+
+  void BufferPool::Push(Buffer &&buffer) {
+    Buffer item(std::move(buffer));
+    // Buffers in the pool do not belong to it until popped again, so the ones
+    // deleted here or in Trim() do not come back.
+    item._parent_pool.reset();
+    const size_t bytes = item.capacity();
+    const size_t retained = _retained_bytes.fetch_add(bytes) + bytes;
+    if (retained > _max_retained_bytes.load(std::memory_order_relaxed)) {
+      _retained_bytes.fetch_sub(bytes);
+      ++_discarded;
+      return;
+    }
+    size_t high_water_mark = _high_water_mark.load(std::memory_order_relaxed);
+    while ((high_water_mark < retained) &&
+           !_high_water_mark.compare_exchange_weak(high_water_mark, retained)) {}
+    auto &bucket = _buckets[BucketFloor(bytes)];
+    GetQueue(bucket).enqueue(std::move(item));
+    ++bucket.count;
+  }
+
+  bool BufferPool::TryPop(size_t index, Buffer &buffer) {
+    auto &bucket = _buckets[index];
+    if (bucket.count.load(std::memory_order_relaxed) == 0u) {
+      return false;
+    }
+    auto *queue = bucket.queue.load(std::memory_order_acquire);
+    if ((queue == nullptr) || !queue->try_dequeue(buffer)) {
+      return false;
+    }
+    --bucket.count;
+    _retained_bytes -= buffer.capacity();
+    return true;
+  }
+
+  BufferPool::queue_type &BufferPool::GetQueue(Bucket &bucket) {
+    auto *queue = bucket.queue.load(std::memory_order_acquire);
+    if (queue == nullptr) {
+      auto created = _estimated_size > 0u ?
+          std::make_unique<queue_type>(_estimated_size) :
+          std::make_unique<queue_type>();
+      if (bucket.queue.compare_exchange_strong(queue, created.get())) {
+        queue = created.release();
+      }
+    }
+    return *queue;
+  }
+
+} // namespace carla
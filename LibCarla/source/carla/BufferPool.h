@@ -7,6 +7,7 @@
 #pragma once
 
 #include "carla/Buffer.h"
+#include "carla/NonCopyable.h"
 
 #if defined(__clang__)
 #  pragma clang diagnostic push
@@ -17,6 +18,10 @@
 #  pragma clang diagnostic pop
 #endif
 
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <limits>
 #include <memory>
 
 namespace carla {
@@ -24,37 +29,123 @@ namespace carla {
   /// A pool of Buffer. Buffers popped from this pool automatically return to
   /// the pool on destruction so the allocated memory can be reused.
   ///
+  /// Buffers are kept in buckets by capacity, four buckets per power of two
+  /// starting at 64 bytes, so a pool shared by big and small messages does not
+  /// hand out megabyte buffers for a few bytes of payload. Popping with a size
+  /// hint picks the bucket; popping without one returns the smallest buffer
+  /// available.
+  ///
   /// @warning Buffers adjust their size only by growing, they never shrink
-  /// unless explicitly cleared. The allocated memory is only deleted when this
-  /// pool is destroyed.
-  class BufferPool : public std::enable_shared_from_this<BufferPool> {
+  /// unless explicitly cleared. Unless a limit is set with
+  /// SetMaxRetainedBytes(), the allocated memory is only deleted when this pool
+  /// is destroyed.
+  class BufferPool
+    : public std::enable_shared_from_this<BufferPool>,
+      private NonCopyable {
   public:
 
+    /// Counters of the pool, for monitoring. Values are read independently
+    /// and may be slightly out of sync under concurrent use.
+    struct Statistics {
+      /// Pops served with a buffer returned to the pool.
+      uint64_t hits = 0u;
+
+      /// Pops that had to create a new buffer.
+      uint64_t misses = 0u;
+
+      /// Buffers deleted on return instead of kept, to stay under the limit of
+      /// retained bytes, plus the ones deleted by Trim().
+      uint64_t discarded = 0u;
+
+      /// Bytes allocated by the buffers currently held in the pool.
+      size_t retained_bytes = 0u;
+
+      /// Maximum value of retained_bytes since the pool was created.
+      size_t high_water_mark = 0u;
+    };
+
     BufferPool() = default;
 
-    explicit BufferPool(size_t estimated_size) : _queue(estimated_size) {}
+    /// @a estimated_size is the number of buffers each bucket preallocates
+    /// space for.
+    explicit BufferPool(size_t estimated_size) : _estimated_size(estimated_size) {}
 
-    /// Pop a Buffer from the queue, creates a new one if the queue is empty.
-    Buffer Pop() {
-      Buffer item;
-      _queue.try_dequeue(item); // we don't care if it fails.
-#if __cplusplus >= 201703L // C++17
-      item._parent_pool = weak_from_this();
-#else
-      item._parent_pool = shared_from_this();
-#endif
-      return item;
+    ~BufferPool();
+
+    /// Pop a Buffer from the pool, creates a new one if the pool is empty.
+    /// Buffers keep the size and contents they had when returned to the pool.
+    Buffer Pop();
+
+    /// Pop a Buffer with capacity for at least @a size bytes and its size set
+    /// to @a size, creates a new one if the bucket of @a size is empty. The
+    /// contents are unspecified.
+    Buffer Pop(size_t size);
+
+    /// Limit the bytes retained by the buffers held in the pool, returned
+    /// buffers that do not fit are deleted. Trims the pool down to the new
+    /// limit.
+    void SetMaxRetainedBytes(size_t max_bytes);
+
+    size_t GetMaxRetainedBytes() const {
+      return _max_retained_bytes.load(std::memory_order_relaxed);
     }
 
+    /// Delete buffers held in the pool, biggest first, until the retained
+    /// bytes are at most @a max_bytes.
+    void Trim(size_t max_bytes = 0u);
+
+    Statistics GetStatistics() const;
+
+    /// Capacity of the buffers created by Pop(size_t) for @a size bytes.
+    static size_t GetBucketCapacity(size_t size);
+
   private:
 
     friend class Buffer;
 
-    void Push(Buffer &&buffer) {
-      _queue.enqueue(std::move(buffer));
+    using queue_type = moodycamel::ConcurrentQueue<Buffer>;
+
+    struct Bucket {
+      /// Created on first use, most pools only see a handful of sizes.
+      std::atomic<queue_type *> queue{nullptr};
+
+      /// Approximate number of buffers in the queue, to skip empty buckets
+      /// without touching the queue.
+      std::atomic_size_t count{0u};
+    };
+
+    /// Enough buckets for any size up to Buffer::max_size().
+    static constexpr size_t number_of_buckets = 105u;
+
+    void Push(Buffer &&buffer);
+
+    bool TryPop(size_t index, Buffer &buffer);
+
+    queue_type &GetQueue(Bucket &bucket);
+
+    void SetParentPool(Buffer &buffer) {
+#if __cplusplus >= 201703L // C++17
+      buffer._parent_pool = weak_from_this();
+#else
+      buffer._parent_pool = shared_from_this();
+#endif
     }
 
-    moodycamel::ConcurrentQueue<Buffer> _queue;
+    const size_t _estimated_size = 0u;
+
+    std::array<Bucket, number_of_buckets> _buckets;
+
+    std::atomic_size_t _max_retained_bytes{(std::numeric_limits<size_t>::max)()};
+
+    std::atomic_size_t _retained_bytes{0u};
+
+    std::atomic_size_t _high_water_mark{0u};
+
+    std::atomic<uint64_t> _hits{0u};
+
+    std::atomic<uint64_t> _misses{0u};
+
+    std::atomic<uint64_t> _discarded{0u};
   };
 
 } // namespace carla
@@ -11,6 +11,16 @@
 
 #include <boost/filesystem/operations.hpp>
 
+#include <iomanip>
+#include <random>
+#include <sstream>
+
+#ifdef _WIN32
+#  include <process.h>
+#else
+#  include <unistd.h>
+#endif
+
 namespace carla {
 
   namespace fs = boost::filesystem;
@@ -30,6 +40,19 @@ namespace carla {
     filepath = path.string();
   }
 
+  std::string FileSystem::GetTemporaryFilePath(const std::string &filepath) {
+#ifdef _WIN32
+    const auto pid = _getpid();
+#else
+    const auto pid = getpid();
+#endif
+    static thread_local std::mt19937_64 generator{std::random_device{}()};
+    std::ostringstream result;
+    result << filepath << '.' << pid << '.'
+           << std::hex << std::setw(16) << std::setfill('0') << generator() << ".tmp";
+    return result.str();
+  }
+
   std::vector<std::string> FileSystem::ListFolder(
       const std::string &folder_path,
       const std::string &wildcard_pattern) {
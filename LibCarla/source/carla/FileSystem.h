@@ -26,6 +26,10 @@ namespace carla {
         std::string &filepath,
         const std::string &default_extension = "");
 
+    /// Name of a file next to @a filepath, unique to this process and call,
+    /// where its content can be written before moving it in place.
+    static std::string GetTemporaryFilePath(const std::string &filepath);
+
     /// List (not recursively) regular files at @a folder_path matching
     /// @a wildcard_pattern.
     ///
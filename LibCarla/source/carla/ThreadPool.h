@@ -14,9 +14,11 @@
 #include <boost/asio/io_context.hpp>
 #include <boost/asio/post.hpp>
 
+#include <algorithm>
 #include <future>
 #include <thread>
 #include <type_traits>
+#include <vector>
 
 namespace carla {
 
@@ -45,6 +47,52 @@ namespace carla {
       return future;
     }
 
+    /// Run @a functor for every index in [0, size), split in contiguous chunks
+    /// across the threads launched with AsyncRun, and wait for all of them.
+    /// Runs serially in this thread if no thread has been launched.
+    ///
+    /// @warning Do not call it from a task running in this pool.
+    template <typename FunctorT>
+    void ParallelFor(size_t size, FunctorT &&functor) {
+      ParallelForChunks(size, [&functor](size_t index, size_t) { functor(index); });
+    }
+
+    /// Same as ParallelFor, but @a functor is called as functor(index, chunk).
+    /// The indices of a chunk run serially in a single thread and chunk is
+    /// lower than the number of threads (zero when running serially), so it
+    /// can select scratch data owned by that thread.
+    ///
+    /// @warning Do not call it from a task running in this pool.
+    template <typename FunctorT>
+    void ParallelForChunks(size_t size, FunctorT &&functor) {
+      const size_t number_of_chunks = std::min(_workers.Size(), size);
+      if (number_of_chunks <= 1u) {
+        for (size_t index = 0u; index < size; ++index) {
+          functor(index, size_t(0u));
+        }
+        return;
+      }
+      std::vector<std::future<void>> chunks;
+      chunks.reserve(number_of_chunks);
+      for (size_t chunk = 0u; chunk < number_of_chunks; ++chunk) {
+        const size_t begin = chunk * size / number_of_chunks;
+        const size_t end = (chunk + 1u) * size / number_of_chunks;
+        chunks.emplace_back(Post([&functor, chunk, begin, end]() {
+          for (size_t index = begin; index < end; ++index) {
+            functor(index, chunk);
+          }
+        }));
+      }
+      // Every chunk references the functor, wait for all of them before
+      // rethrowing any exception.
+      for (auto &chunk : chunks) {
+        chunk.wait();
+      }
+      for (auto &chunk : chunks) {
+        chunk.get();
+      }
+    }
+
     /// Launch threads to run tasks asynchronously. Launch specific number of
     /// threads if @a worker_threads is provided, otherwise use all available
     /// hardware concurrency.
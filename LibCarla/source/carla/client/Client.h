@@ -41,6 +41,13 @@ namespace client {
       return _simulator->GetNetworkingTimeout();
     }
 
+    /// Ask the simulator to compress the sensor streams this client listens
+    /// to from now on. Only takes effect if the simulator was started with
+    /// streaming compression enabled.
+    void SetStreamingCompressionEnabled(bool enabled) {
+      _simulator->SetStreamingCompressionEnabled(enabled);
+    }
+
     /// Return the version string of this client API.
     std::string GetClientVersion() const {
       return _simulator->GetClientVersion();
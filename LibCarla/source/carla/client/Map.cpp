@@ -6,24 +6,106 @@
 
 #include "carla/client/Map.h"
 
+#include "carla/Debug.h"
+#include "carla/FileSystem.h"
+#include "carla/Logging.h"
+#include "carla/client/FileTransfer.h"
 #include "carla/client/Junction.h"
 #include "carla/client/Waypoint.h"
 #include "carla/opendrive/OpenDriveParser.h"
 #include "carla/road/Map.h"
+#include "carla/road/PrecompiledMap.h"
 #include "carla/road/RoadTypes.h"
 #include "carla/trafficmanager/InMemoryMap.h"
 
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
 #include <sstream>
 
 namespace carla {
 namespace client {
 
+  namespace bip = boost::interprocess;
+
+  using OpenDriveKey = road::precompiled_map::OpenDriveKey;
+
+  /// Precompiled maps are cached next to the files downloaded from the
+  /// server, named after the hash of the OpenDRIVE.
+  static std::string GetPrecompiledMapPath(const OpenDriveKey &opendrive_key) {
+    std::ostringstream name;
+    name << "maps/" << std::hex << std::setw(16) << std::setfill('0') << opendrive_key.hash << ".bin";
+    return FileTransfer::GetFullPath(name.str());
+  }
+
+  static boost::optional<road::Map> LoadPrecompiledMap(const std::string &filename, const OpenDriveKey &opendrive_key) {
+    std::unique_ptr<bip::mapped_region> region;
+    try {
+      bip::file_mapping file(filename.c_str(), bip::read_only);
+      region = std::make_unique<bip::mapped_region>(file, bip::read_only);
+    } catch (const bip::interprocess_exception &) {
+      // Not cached yet.
+      return {};
+    }
+    return road::PrecompiledMap::Load(
+        static_cast<const uint8_t *>(region->get_address()),
+        region->get_size(),
+        opendrive_key);
+  }
+
+  static void SavePrecompiledMap(std::string filename, const road::Map &map, const OpenDriveKey &opendrive_key) {
+    const std::vector<uint8_t> content = road::PrecompiledMap::Serialize(map, opendrive_key);
+    try {
+      FileSystem::ValidateFilePath(filename);
+    } catch (const std::exception &e) {
+      log_warning("Could not create the folder of the precompiled map", filename, ":", e.what());
+      return;
+    }
+
+    // Write to a temporary file of our own and move it in place, so that
+    // other clients never map a partially written file.
+    const std::string temporary_filename = FileSystem::GetTemporaryFilePath(filename);
+    std::ofstream out_file(temporary_filename, std::ios::binary);
+    if (!out_file.is_open()) {
+      log_warning("Could not open precompiled map", temporary_filename);
+      return;
+    }
+    out_file.write(reinterpret_cast<const char *>(content.data()), static_cast<std::streamsize>(content.size()));
+    out_file.close();
+    if (!out_file) {
+      log_warning("Could not write precompiled map", temporary_filename);
+      std::remove(temporary_filename.c_str());
+      return;
+    }
+    if (std::rename(temporary_filename.c_str(), filename.c_str()) != 0) {
+      // Some platforms do not replace existing files on rename. We only get
+      // here if the existing file failed to load, or another client cached
+      // the same map meanwhile, which is as good as ours.
+      std::remove(filename.c_str());
+      if (std::rename(temporary_filename.c_str(), filename.c_str()) != 0) {
+        log_warning("Could not move precompiled map to", filename);
+        std::remove(temporary_filename.c_str());
+      }
+    }
+  }
+
+  /// Restores the map from its precompiled form if it was cached before,
+  /// otherwise parses the OpenDRIVE and caches the result.
   static auto MakeMap(const std::string &opendrive_contents) {
-    auto stream = std::istringstream(opendrive_contents);
-    auto map = opendrive::OpenDriveParser::Load(stream.str());
+    const auto opendrive_key = road::PrecompiledMap::GetOpenDriveKey(opendrive_contents);
+    const std::string filename = GetPrecompiledMapPath(opendrive_key);
+    auto map = LoadPrecompiledMap(filename, opendrive_key);
+    if (map.has_value()) {
+      return std::move(*map);
+    }
+    map = opendrive::OpenDriveParser::Load(opendrive_contents);
     if (!map.has_value()) {
       throw_exception(std::runtime_error("failed to generate map"));
     }
+    SavePrecompiledMap(filename, *map, opendrive_key);
     return std::move(*map);
   }
 
@@ -56,6 +138,23 @@ namespace client {
     nullptr;
   }
 
+  std::vector<SharedPtr<Waypoint>> Map::GetWaypoints(
+      const std::vector<geom::Location> &locations,
+      bool project_to_road,
+      int32_t lane_type) const {
+    const auto waypoints = project_to_road ?
+        _map.GetClosestWaypointsOnRoad(locations, lane_type) :
+        _map.GetWaypoints(locations, lane_type);
+    std::vector<SharedPtr<Waypoint>> result;
+    result.reserve(waypoints.size());
+    for (const auto &waypoint : waypoints) {
+      result.emplace_back(waypoint.has_value() ?
+          SharedPtr<Waypoint>(new Waypoint{shared_from_this(), *waypoint}) :
+          nullptr);
+    }
+    return result;
+  }
+
   SharedPtr<Waypoint> Map::GetWaypointXODR(
       carla::road::RoadId road_id,
       carla::road::LaneId lane_id,
@@ -67,6 +166,24 @@ namespace client {
         nullptr;
   }
 
+  std::vector<SharedPtr<Waypoint>> Map::GetWaypointsXODR(
+      const std::vector<road::element::Waypoint> &waypoints,
+      const std::vector<geom::Transform> &transforms) const {
+    DEBUG_ASSERT(waypoints.size() == transforms.size());
+    std::vector<SharedPtr<Waypoint>> result;
+    result.reserve(waypoints.size());
+    for (size_t i = 0u; i < waypoints.size(); ++i) {
+      const auto &requested = waypoints[i];
+      auto waypoint = _map.GetWaypoint(requested.road_id, requested.lane_id, static_cast<float>(requested.s));
+      if (waypoint.has_value() && waypoint->section_id == requested.section_id) {
+        result.emplace_back(SharedPtr<Waypoint>(new Waypoint{shared_from_this(), *waypoint, transforms[i]}));
+      } else {
+        result.emplace_back(nullptr);
+      }
+    }
+    return result;
+  }
+
   Map::TopologyList Map::GetTopology() const {
     namespace re = carla::road::element;
     std::unordered_map<re::Waypoint, SharedPtr<Waypoint>> waypoints;
@@ -95,13 +212,21 @@ namespace client {
   std::vector<SharedPtr<Waypoint>> Map::GenerateWaypoints(double distance) const {
     std::vector<SharedPtr<Waypoint>> result;
     const auto waypoints = _map.GenerateWaypoints(distance);
+    const auto transforms = _map.ComputeTransforms(waypoints);
     result.reserve(waypoints.size());
-    for (const auto &waypoint : waypoints) {
-      result.emplace_back(SharedPtr<Waypoint>(new Waypoint{shared_from_this(), waypoint}));
+    for (size_t i = 0u; i < waypoints.size(); ++i) {
+      result.emplace_back(SharedPtr<Waypoint>(new Waypoint{shared_from_this(), waypoints[i], transforms[i]}));
     }
     return result;
   }
 
+  std::vector<geom::Transform> Map::ComputeTransformsXODR(
+      carla::road::RoadId road_id,
+      carla::road::LaneId lane_id,
+      const std::vector<double> &s_values) const {
+    return _map.ComputeTransforms(road_id, lane_id, s_values);
+  }
+
   std::vector<road::element::LaneMarking> Map::CalculateCrossedLanes(
   const geom::Location &origin,
   const geom::Location &destination) const {
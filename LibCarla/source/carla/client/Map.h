@@ -56,17 +56,39 @@ namespace client {
         bool project_to_road = true,
         int32_t lane_type = static_cast<uint32_t>(road::Lane::LaneType::Driving)) const;
 
+    /// Same as GetWaypoint for each of @a locations, resolved with a single
+    /// batch query on the map. Locations without a waypoint get a nullptr.
+    std::vector<SharedPtr<Waypoint>> GetWaypoints(
+        const std::vector<geom::Location> &locations,
+        bool project_to_road = true,
+        int32_t lane_type = static_cast<uint32_t>(road::Lane::LaneType::Driving)) const;
+
     SharedPtr<Waypoint> GetWaypointXODR(
       carla::road::RoadId road_id,
       carla::road::LaneId lane_id,
       float s) const;
 
+    /// Same as GetWaypointXODR for each of @a waypoints, but takes the
+    /// transforms from @a transforms instead of computing them, e.g. when
+    /// they were stored in a cache. Waypoints that do not exist in this map,
+    /// or that fall in a different lane section, get a nullptr.
+    std::vector<SharedPtr<Waypoint>> GetWaypointsXODR(
+        const std::vector<road::element::Waypoint> &waypoints,
+        const std::vector<geom::Transform> &transforms) const;
+
     using TopologyList = std::vector<std::pair<SharedPtr<Waypoint>, SharedPtr<Waypoint>>>;
 
     TopologyList GetTopology() const;
 
     std::vector<SharedPtr<Waypoint>> GenerateWaypoints(double distance) const;
 
+    /// Computes the transforms of lane @a lane_id of road @a road_id at each
+    /// of the distances in @a s_values, in a single pass per lane section.
+    std::vector<geom::Transform> ComputeTransformsXODR(
+        carla::road::RoadId road_id,
+        carla::road::LaneId lane_id,
+        const std::vector<double> &s_values) const;
+
     std::vector<road::element::LaneMarking> CalculateCrossedLanes(
         const geom::Location &origin,
         const geom::Location &destination) const;
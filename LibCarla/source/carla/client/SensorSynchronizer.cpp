@@ -0,0 +1,74 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/client/SensorSynchronizer.h"
+
+#include "carla/Exception.h"
+#include "carla/Logging.h"
+
+#include <algorithm>
+#include <exception>
+#include <stdexcept>
+
+namespace carla {
+namespace client {
+
+  SensorSynchronizer::SensorSynchronizer(
+      std::vector<SharedPtr<Sensor>> sensors,
+      const Settings &settings)
+    : _sensors(std::move(sensors)),
+      _synchronizer(std::make_shared<detail::FrameSynchronizer>(
+          std::max<size_t>(_sensors.size(), 1u),
+          settings)) {
+    if (_sensors.empty()) {
+      throw_exception(std::invalid_argument("sensor synchronizer needs at least one sensor"));
+    }
+    for (auto &sensor : _sensors) {
+      if (sensor == nullptr) {
+        throw_exception(std::invalid_argument("sensor synchronizer got a null sensor"));
+      }
+    }
+  }
+
+  SensorSynchronizer::~SensorSynchronizer() {
+    if (_is_listening) {
+      try {
+        Stop();
+      } catch (const std::exception &e) {
+        log_error("exception trying to stop sensor synchronizer:", e.what());
+      }
+    }
+  }
+
+  void SensorSynchronizer::Listen(CallbackFunctionType callback) {
+    if (_is_listening) {
+      Stop();
+    }
+    _synchronizer->Reset();
+    _synchronizer->SetCallback(std::move(callback));
+    std::weak_ptr<detail::FrameSynchronizer> weak = _synchronizer;
+    for (auto i = 0u; i < _sensors.size(); ++i) {
+      _sensors[i]->Listen([weak, i](SharedPtr<sensor::SensorData> data) {
+        auto synchronizer = weak.lock();
+        if ((synchronizer != nullptr) && (data != nullptr)) {
+          synchronizer->Push(i, std::move(data));
+        }
+      });
+    }
+    _is_listening = true;
+  }
+
+  void SensorSynchronizer::Stop() {
+    _is_listening = false;
+    for (auto &sensor : _sensors) {
+      if (sensor->IsListening()) {
+        sensor->Stop();
+      }
+    }
+  }
+
+} // namespace client
+} // namespace carla
@@ -0,0 +1,98 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/Memory.h"
+#include "carla/NonCopyable.h"
+#include "carla/Time.h"
+#include "carla/client/Sensor.h"
+#include "carla/client/detail/FrameSynchronizer.h"
+
+#include <memory>
+#include <vector>
+
+namespace carla {
+namespace client {
+
+  /// Listens to several sensors and delivers their data grouped by frame, one
+  /// bundle per frame once every sensor sent it. Meant for sensors that send
+  /// data every tick (cameras, lidars, radars, IMU, GNSS...), event sensors
+  /// like collisions only send data on events.
+  ///
+  /// Bundles are either passed to the callback given to Listen() or queued to
+  /// be retrieved with Get().
+  class SensorSynchronizer : private NonCopyable {
+  public:
+
+    using Bundle = detail::FrameSynchronizer::Bundle;
+
+    using CallbackFunctionType = detail::FrameSynchronizer::CallbackFunctionType;
+
+    using MissingFramePolicy = detail::FrameSynchronizer::MissingFramePolicy;
+
+    using Settings = detail::FrameSynchronizer::Settings;
+
+    using Statistics = detail::FrameSynchronizer::Statistics;
+
+    explicit SensorSynchronizer(
+        std::vector<SharedPtr<Sensor>> sensors,
+        const Settings &settings = Settings{});
+
+    ~SensorSynchronizer();
+
+    const std::vector<SharedPtr<Sensor>> &GetSensors() const {
+      return _sensors;
+    }
+
+    const Settings &GetSettings() const {
+      return _synchronizer->GetSettings();
+    }
+
+    /// Start listening to the sensors. Each bundle is passed to @a callback,
+    /// or queued for Get() if @a callback is empty.
+    ///
+    /// @warning This steals the data stream of each sensor from any callback
+    /// set with Sensor::Listen(). The callback must not call Listen() on this
+    /// synchronizer.
+    void Listen(CallbackFunctionType callback = {});
+
+    /// Stop listening to the sensors. Bundles already queued can still be
+    /// retrieved with Get().
+    void Stop();
+
+    bool IsListening() const {
+      return _is_listening;
+    }
+
+    /// Wait for the next bundle. Returns null on timeout.
+    SharedPtr<Bundle> Get(time_duration timeout) {
+      return _synchronizer->Get(timeout);
+    }
+
+    /// Wait for the bundle of @a frame, discarding the bundles of previous
+    /// frames. Returns null on timeout or if the frame was dropped.
+    SharedPtr<Bundle> Get(uint64_t frame, time_duration timeout) {
+      return _synchronizer->Get(frame, timeout);
+    }
+
+    Statistics GetStatistics() const {
+      return _synchronizer->GetStatistics();
+    }
+
+  private:
+
+    const std::vector<SharedPtr<Sensor>> _sensors;
+
+    /// Shared with the sensor callbacks, which may outlive this object for a
+    /// little while.
+    const std::shared_ptr<detail::FrameSynchronizer> _synchronizer;
+
+    bool _is_listening = false;
+  };
+
+} // namespace client
+} // namespace carla
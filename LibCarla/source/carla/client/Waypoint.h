@@ -106,6 +106,12 @@ namespace client {
 
     Waypoint(SharedPtr<const Map> parent, road::element::Waypoint waypoint);
 
+    /// Used when the transform has already been computed, e.g. in bulk.
+    Waypoint(
+        SharedPtr<const Map> parent,
+        road::element::Waypoint waypoint,
+        const geom::Transform &transform);
+
     SharedPtr<const Map> _parent;
 
     road::element::Waypoint _waypoint;
@@ -50,6 +50,22 @@ namespace client {
       return _state->size();
     }
 
+    /// Frame of the snapshot the actor delta is relative to, zero if the
+    /// delta is not available.
+    size_t GetActorDeltaBaseFrame() const {
+      return _state->GetActorDeltaBaseFrame();
+    }
+
+    /// Ids of the actors spawned since the snapshot of the base frame.
+    const std::vector<ActorId> &GetAddedActorIds() const {
+      return _state->GetAddedActorIds();
+    }
+
+    /// Ids of the actors destroyed since the snapshot of the base frame.
+    const std::vector<ActorId> &GetRemovedActorIds() const {
+      return _state->GetRemovedActorIds();
+    }
+
     /// Return a begin iterator to the list of ActorSnapshots.
     auto begin() const {
       return _state->begin();
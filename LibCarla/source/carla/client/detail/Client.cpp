@@ -132,6 +132,10 @@ namespace detail {
     return _pimpl->GetTimeout();
   }
 
+  void Client::SetStreamingCompressionEnabled(bool enabled) {
+    _pimpl->streaming_client.SetCompressionEnabled(enabled);
+  }
+
   const std::string Client::GetEndpoint() const {
     return _pimpl->endpoint;
   }
@@ -649,6 +653,14 @@ namespace detail {
     return result.as<std::vector<rpc::CommandResponse>>();
   }
 
+  uint32_t Client::ApplyVehicleControlBatch(
+      const rpc::VehicleControlBatch &batch,
+      std::vector<unsigned char> &buffer,
+      bool do_tick_cue) {
+    batch.Encode(buffer);
+    return _pimpl->CallAndWait<uint32_t>("apply_vehicle_control_batch", buffer, do_tick_cue);
+  }
+
   uint64_t Client::SendTickCue() {
     return _pimpl->CallAndWait<uint64_t>("tick_cue");
   }
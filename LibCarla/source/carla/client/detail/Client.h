@@ -25,6 +25,7 @@
 #include "carla/rpc/MapLayer.h"
 #include "carla/rpc/OpendriveGenerationParameters.h"
 #include "carla/rpc/TrafficLightState.h"
+#include "carla/rpc/VehicleControlBatch.h"
 #include "carla/rpc/VehicleDoor.h"
 #include "carla/rpc/VehicleLightStateList.h"
 #include "carla/rpc/VehicleLightState.h"
@@ -92,6 +93,8 @@ namespace detail {
 
     time_duration GetTimeout() const;
 
+    void SetStreamingCompressionEnabled(bool enabled);
+
     const std::string GetEndpoint() const;
 
     std::string GetClientVersion();
@@ -404,6 +407,14 @@ namespace detail {
         std::vector<rpc::Command> commands,
         bool do_tick_cue);
 
+    /// Applies a packed batch of vehicle commands, returns the number of
+    /// commands that failed. The batch is encoded into @a buffer, which the
+    /// caller may keep to reuse its memory on the next call.
+    uint32_t ApplyVehicleControlBatch(
+        const rpc::VehicleControlBatch &batch,
+        std::vector<unsigned char> &buffer,
+        bool do_tick_cue);
+
     uint64_t SendTickCue();
 
     std::vector<rpc::LightState> QueryLightsStateToServer() const;
@@ -58,7 +58,8 @@ using namespace std::chrono_literals;
       if (self != nullptr) {
 
         auto data = sensor::Deserializer::Deserialize(std::move(buffer));
-        auto next = std::make_shared<const EpisodeState>(CastData(*data));
+        auto next_state = std::make_shared<EpisodeState>(CastData(*data));
+        std::shared_ptr<const EpisodeState> next = next_state;
         auto prev = self->GetState();
 
         // TODO: Update how the map change is detected
@@ -85,6 +86,11 @@ using namespace std::chrono_literals;
               self->_on_tick_callbacks.Call(next);
               return;
             }
+            // Actors spawned and destroyed since the previous state, so that
+            // consumers do not need to compare the full actor lists.
+            if (!episode_changed && self->_actor_delta_consumers > 0u) {
+              next_state->SetActorDelta(*prev);
+            }
           } while (!self->_state.compare_exchange(&prev, next));
 
           if(UpdateLights || HasMapChanged) {
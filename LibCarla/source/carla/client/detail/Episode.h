@@ -7,6 +7,7 @@
 #pragma once
 
 #include "carla/AtomicSharedPtr.h"
+#include "carla/Debug.h"
 #include "carla/NonCopyable.h"
 #include "carla/RecurrentSharedFuture.h"
 #include "carla/client/Timestamp.h"
@@ -17,6 +18,7 @@
 #include "carla/client/detail/EpisodeProxy.h"
 #include "carla/rpc/EpisodeInfo.h"
 
+#include <atomic>
 #include <vector>
 
 namespace carla {
@@ -99,6 +101,19 @@ namespace detail {
 
     bool HasMapChangedSinceLastCall();
 
+    /// While there is at least one consumer, every episode state received
+    /// carries the actors spawned and destroyed since the previous one. The
+    /// delta costs a lookup per actor each tick, so it is only computed for
+    /// the consumers that asked for it, e.g. a traffic manager.
+    void AddActorDeltaConsumer() {
+      ++_actor_delta_consumers;
+    }
+
+    void RemoveActorDeltaConsumer() {
+      DEBUG_ASSERT(_actor_delta_consumers > 0u);
+      --_actor_delta_consumers;
+    }
+
     std::shared_ptr<WalkerNavigation> CreateNavigationIfMissing();
 
   private:
@@ -133,6 +148,8 @@ namespace detail {
 
     bool _should_update_map = true;
 
+    std::atomic<uint32_t> _actor_delta_consumers{0u};
+
     std::weak_ptr<Simulator> _simulator;
   };
 
@@ -36,6 +36,23 @@ namespace detail {
     }
   }
 
+  void EpisodeState::SetActorDelta(const EpisodeState &previous) {
+    DEBUG_ASSERT(previous.GetEpisodeId() == _episode_id);
+    _delta_base_frame = previous.GetFrame();
+    _added_actors.clear();
+    _removed_actors.clear();
+    for (const auto &actor : _actors) {
+      if (!previous.ContainsActorSnapshot(actor.first)) {
+        _added_actors.emplace_back(actor.first);
+      }
+    }
+    for (const auto &actor : previous._actors) {
+      if (!ContainsActorSnapshot(actor.first)) {
+        _removed_actors.emplace_back(actor.first);
+      }
+    }
+  }
+
 } // namespace detail
 } // namespace client
 } // namespace carla
@@ -18,6 +18,7 @@
 
 #include <memory>
 #include <unordered_map>
+#include <vector>
 
 namespace carla {
 namespace client {
@@ -86,6 +87,26 @@ namespace detail {
       return _actors.size();
     }
 
+    /// Frame of the state the actor delta was computed against, zero if
+    /// there is no delta for this state.
+    size_t GetActorDeltaBaseFrame() const {
+      return _delta_base_frame;
+    }
+
+    /// Actors present in this state but not in the state of the base frame.
+    const std::vector<ActorId> &GetAddedActorIds() const {
+      return _added_actors;
+    }
+
+    /// Actors present in the state of the base frame but not in this one.
+    const std::vector<ActorId> &GetRemovedActorIds() const {
+      return _removed_actors;
+    }
+
+    /// Computes the actors added and removed since @a previous, a state of the
+    /// same episode.
+    void SetActorDelta(const EpisodeState &previous);
+
     auto begin() const {
       return iterator::make_map_values_const_iterator(_actors.begin());
     }
@@ -113,6 +134,12 @@ namespace detail {
     SimulationState _simulation_state;
 
     std::unordered_map<ActorId, ActorSnapshot> _actors;
+
+    size_t _delta_base_frame = 0u;
+
+    std::vector<ActorId> _added_actors;
+
+    std::vector<ActorId> _removed_actors;
   };
 
 } // namespace detail
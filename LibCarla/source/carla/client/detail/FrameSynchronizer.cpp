@@ -0,0 +1,233 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/client/detail/FrameSynchronizer.h"
+
+#include "carla/Debug.h"
+#include "carla/sensor/SensorData.h"
+
+#include <algorithm>
+
+namespace carla {
+namespace client {
+namespace detail {
+
+  static FrameSynchronizer::Settings ValidateSettings(FrameSynchronizer::Settings settings) {
+    settings.max_pending_frames = std::max<size_t>(settings.max_pending_frames, 1u);
+    return settings;
+  }
+
+  FrameSynchronizer::FrameSynchronizer(size_t number_of_streams, const Settings &settings)
+    : _number_of_streams(number_of_streams),
+      _settings(ValidateSettings(settings)),
+      _slots(number_of_streams * _settings.max_pending_frames),
+      _last_frames(number_of_streams) {
+    DEBUG_ASSERT(number_of_streams > 0u);
+    for (auto &last_frame : _last_frames) {
+      last_frame = 0u;
+    }
+  }
+
+  void FrameSynchronizer::SetCallback(CallbackFunctionType callback) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _callback = std::move(callback);
+  }
+
+  void FrameSynchronizer::Reset() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    for (auto &slot : _slots) {
+      boost::atomic_store(&slot, DataPtr{});
+    }
+    for (auto &last_frame : _last_frames) {
+      last_frame = 0u;
+    }
+    _next_frame = 0u;
+    _has_started = false;
+    _callback_bundles.clear();
+    std::lock_guard<std::mutex> bundles_lock(_bundles_mutex);
+    _bundles.clear();
+    _closed_before = 0u;
+  }
+
+  void FrameSynchronizer::Push(size_t stream, DataPtr data) {
+    DEBUG_ASSERT(stream < _number_of_streams);
+    DEBUG_ASSERT(data != nullptr);
+    const uint64_t frame = data->GetFrame();
+    if (!_has_started) {
+      std::lock_guard<std::mutex> lock(_mutex);
+      if (!_has_started) {
+        _next_frame = frame;
+        _has_started = true;
+        std::lock_guard<std::mutex> bundles_lock(_bundles_mutex);
+        _closed_before = frame;
+      }
+    }
+    if (frame < _next_frame) {
+      ++_late;
+      return;
+    }
+    const auto window = _settings.max_pending_frames;
+    bool has_callback_bundles = false;
+    if (frame >= _next_frame + window) {
+      // The slot still holds a frame that is not closed, this stream is too far
+      // ahead of the others.
+      has_callback_bundles = Advance(frame - window + 1u);
+    }
+    auto &slot = GetSlots(stream)[frame % window];
+    const DataPtr stored = data;
+    boost::atomic_store(&slot, std::move(data));
+    _last_frames[stream] = frame + 1u;
+    // Another stream may have forced the frame closed since we checked above.
+    // Advance marks a frame closed before collecting its slots, and we check
+    // after filling ours, so at least one of us sees the other; whoever takes
+    // the data out of the slot decides whether it was delivered or late.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (frame < _next_frame) {
+      auto expected = stored;
+      if (boost::atomic_compare_exchange(&slot, &expected, DataPtr{})) {
+        ++_late;
+      }
+    }
+    // Only lock if every stream reached the oldest open frame, most of the
+    // data just sits in its slot until the last stream of the frame arrives.
+    const uint64_t next_frame = _next_frame;
+    const bool can_advance = std::all_of(_last_frames.begin(), _last_frames.end(), [=](auto &last_frame) {
+      return last_frame.load() > next_frame;
+    });
+    if (can_advance) {
+      has_callback_bundles = Advance(0u) || has_callback_bundles;
+    }
+    if (has_callback_bundles) {
+      CallCallback();
+    }
+  }
+
+  bool FrameSynchronizer::Advance(uint64_t close_before) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    const auto window = _settings.max_pending_frames;
+    const uint64_t first_frame = _next_frame;
+    uint64_t frame = first_frame;
+    for (;; ++frame) {
+      if ((frame >= first_frame + window) && (frame < close_before)) {
+        // Nothing is buffered past the window.
+        frame = close_before;
+      }
+      const bool is_decided = std::all_of(_last_frames.begin(), _last_frames.end(), [=](auto &last_frame) {
+        return last_frame.load() > frame;
+      });
+      if (!is_decided && (frame >= close_before)) {
+        break;
+      }
+      // Close the frame before collecting its slots, see Push.
+      _next_frame = frame + 1u;
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      auto bundle = MakeShared<Bundle>();
+      bundle->frame = frame;
+      bundle->data.resize(_number_of_streams);
+      size_t count = 0u;
+      for (auto i = 0u; i < _number_of_streams; ++i) {
+        auto &slot = GetSlots(i)[frame % window];
+        auto data = boost::atomic_load(&slot);
+        if ((data != nullptr) && (data->GetFrame() == frame)) {
+          // Release the slot, unless the stream already moved on.
+          auto expected = data;
+          boost::atomic_compare_exchange(&slot, &expected, DataPtr{});
+          bundle->data[i] = std::move(data);
+          ++count;
+        }
+      }
+      if (count == _number_of_streams) {
+        bundle->is_complete = true;
+        ++_complete;
+        Deliver(std::move(bundle));
+      } else if (count > 0u) {
+        if (_settings.missing_frame_policy == MissingFramePolicy::DeliverPartial) {
+          ++_partial;
+          Deliver(std::move(bundle));
+        } else {
+          ++_dropped;
+        }
+      }
+      // Frames nobody sent, e.g. the sensors tick at a lower rate, are skipped.
+    }
+    _next_frame = frame;
+    {
+      std::lock_guard<std::mutex> bundles_lock(_bundles_mutex);
+      _closed_before = frame;
+    }
+    _bundles_condition.notify_all();
+    return !_callback_bundles.empty();
+  }
+
+  void FrameSynchronizer::Deliver(SharedPtr<Bundle> bundle) {
+    if (_callback) {
+      _callback_bundles.emplace_back(std::move(bundle));
+      return;
+    }
+    std::lock_guard<std::mutex> lock(_bundles_mutex);
+    _bundles.emplace_back(std::move(bundle));
+    while (_bundles.size() > _settings.max_pending_frames) {
+      _bundles.pop_front();
+      ++_dropped;
+    }
+  }
+
+  void FrameSynchronizer::CallCallback() {
+    std::unique_lock<std::mutex> lock(_mutex);
+    if (_is_calling_callback) {
+      // That thread calls the callback with our bundles too, after its own.
+      return;
+    }
+    _is_calling_callback = true;
+    while (!_callback_bundles.empty() && _callback) {
+      auto bundle = std::move(_callback_bundles.front());
+      _callback_bundles.pop_front();
+      auto callback = _callback;
+      lock.unlock();
+      callback(std::move(bundle));
+      lock.lock();
+    }
+    _is_calling_callback = false;
+  }
+
+  SharedPtr<FrameSynchronizer::Bundle> FrameSynchronizer::Get(time_duration timeout) {
+    std::unique_lock<std::mutex> lock(_bundles_mutex);
+    if (!_bundles_condition.wait_for(lock, timeout.to_chrono(), [this]() { return !_bundles.empty(); })) {
+      return nullptr;
+    }
+    auto bundle = std::move(_bundles.front());
+    _bundles.pop_front();
+    return bundle;
+  }
+
+  SharedPtr<FrameSynchronizer::Bundle> FrameSynchronizer::Get(uint64_t frame, time_duration timeout) {
+    std::unique_lock<std::mutex> lock(_bundles_mutex);
+    _bundles_condition.wait_for(lock, timeout.to_chrono(), [this, frame]() {
+      return (_closed_before > frame) || (!_bundles.empty() && (_bundles.back()->frame >= frame));
+    });
+    while (!_bundles.empty() && (_bundles.front()->frame < frame)) {
+      _bundles.pop_front();
+    }
+    if (_bundles.empty() || (_bundles.front()->frame != frame)) {
+      return nullptr;
+    }
+    auto bundle = std::move(_bundles.front());
+    _bundles.pop_front();
+    return bundle;
+  }
+
+  FrameSynchronizer::Statistics FrameSynchronizer::GetStatistics() const {
+    Statistics result;
+    result.complete = _complete;
+    result.partial = _partial;
+    result.dropped = _dropped;
+    result.late = _late;
+    return result;
+  }
+
+} // namespace detail
+} // namespace client
+} // namespace carla
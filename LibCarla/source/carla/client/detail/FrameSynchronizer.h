@@ -0,0 +1,186 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/Memory.h"
+#include "carla/NonCopyable.h"
+#include "carla/Time.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+namespace carla {
+namespace sensor { class SensorData; }
+namespace client {
+namespace detail {
+
+  /// Groups the data of several sensor streams by frame.
+  ///
+  /// Each stream writes its data into its own ring of slots indexed by frame,
+  /// without locking. Once every stream has either sent a frame or moved past
+  /// it, the frame is closed and its bundle delivered, in increasing frame
+  /// order, to the callback or to the queue read by Get(). Data of a frame
+  /// that is closed before it arrives is counted as late.
+  ///
+  /// Data of a single stream is expected in increasing frame order, as the
+  /// streaming client delivers it.
+  class FrameSynchronizer : private NonCopyable {
+  public:
+
+    using DataPtr = SharedPtr<sensor::SensorData>;
+
+    /// Data of a single frame, one entry per stream in the order the streams
+    /// were given. Entries of streams that did not send the frame are null.
+    struct Bundle {
+      uint64_t frame = 0u;
+
+      bool is_complete = false;
+
+      std::vector<DataPtr> data;
+    };
+
+    using CallbackFunctionType = std::function<void(SharedPtr<Bundle>)>;
+
+    /// What to do with a frame some stream skipped, e.g. because a message was
+    /// dropped or the sensor ticks at a lower rate.
+    enum class MissingFramePolicy : uint8_t {
+      /// Discard the frame.
+      Drop,
+      /// Deliver the frame with null entries for the missing streams.
+      DeliverPartial
+    };
+
+    struct Settings {
+      /// Frames buffered per stream. A frame still incomplete when any stream
+      /// is this many frames ahead is closed as missing; data arriving for a
+      /// closed frame is late and discarded. Also bounds the bundles waiting
+      /// to be retrieved with Get().
+      size_t max_pending_frames = 8u;
+
+      MissingFramePolicy missing_frame_policy = MissingFramePolicy::Drop;
+    };
+
+    struct Statistics {
+      /// Bundles delivered with the data of every stream.
+      uint64_t complete = 0u;
+
+      /// Bundles delivered with some data missing.
+      uint64_t partial = 0u;
+
+      /// Incomplete frames discarded, plus bundles nobody retrieved in time.
+      uint64_t dropped = 0u;
+
+      /// Data discarded because its frame was already closed.
+      uint64_t late = 0u;
+    };
+
+    FrameSynchronizer(size_t number_of_streams, const Settings &settings);
+
+    size_t GetNumberOfStreams() const {
+      return _number_of_streams;
+    }
+
+    const Settings &GetSettings() const {
+      return _settings;
+    }
+
+    /// Deliver the bundles to @a callback instead of queuing them for Get().
+    /// The callback is called from the streaming threads, one bundle at a
+    /// time and without holding any lock, so it may call back into the
+    /// synchronizer or wait for other locks, e.g. the Python GIL.
+    void SetCallback(CallbackFunctionType callback);
+
+    /// Discard every pending frame and bundle, and start over from the next
+    /// frame received.
+    void Reset();
+
+    /// Add the data of @a stream, called from the stream's callback.
+    void Push(size_t stream, DataPtr data);
+
+    /// Wait for the next bundle. Returns null on timeout.
+    SharedPtr<Bundle> Get(time_duration timeout);
+
+    /// Wait for the bundle of @a frame, discarding the bundles of previous
+    /// frames. Returns null on timeout or if the frame was dropped.
+    SharedPtr<Bundle> Get(uint64_t frame, time_duration timeout);
+
+    Statistics GetStatistics() const;
+
+  private:
+
+    /// Ring of slots of a stream.
+    DataPtr *GetSlots(size_t stream) {
+      return _slots.data() + stream * _settings.max_pending_frames;
+    }
+
+    /// Close every frame that can be closed, and those older than
+    /// @a close_before regardless. Returns whether there are bundles waiting
+    /// for the callback.
+    bool Advance(uint64_t close_before);
+
+    /// Queue @a bundle for Get(), or for the callback if there is one. Must be
+    /// called with _mutex locked.
+    void Deliver(SharedPtr<Bundle> bundle);
+
+    /// Call the callback with the bundles waiting for it, unless another
+    /// thread is already doing so.
+    void CallCallback();
+
+    const size_t _number_of_streams;
+
+    const Settings _settings;
+
+    /// number_of_streams * max_pending_frames slots, only accessed atomically.
+    std::vector<DataPtr> _slots;
+
+    /// Newest frame received from each stream, plus one (zero means none).
+    std::vector<std::atomic<uint64_t>> _last_frames;
+
+    /// Frames before this one are closed.
+    std::atomic<uint64_t> _next_frame{0u};
+
+    std::atomic_bool _has_started{false};
+
+    /// Closes frames and guards the callback and its bundles.
+    std::mutex _mutex;
+
+    CallbackFunctionType _callback;
+
+    /// Closed bundles waiting for the callback.
+    std::deque<SharedPtr<Bundle>> _callback_bundles;
+
+    /// Whether a thread is calling the callback, so that bundles are
+    /// delivered one at a time and in order.
+    bool _is_calling_callback = false;
+
+    /// Guards the bundles waiting for Get().
+    std::mutex _bundles_mutex;
+
+    std::condition_variable _bundles_condition;
+
+    std::deque<SharedPtr<Bundle>> _bundles;
+
+    /// Copy of _next_frame for Get(), guarded by _bundles_mutex.
+    uint64_t _closed_before = 0u;
+
+    std::atomic<uint64_t> _complete{0u};
+
+    std::atomic<uint64_t> _partial{0u};
+
+    std::atomic<uint64_t> _dropped{0u};
+
+    std::atomic<uint64_t> _late{0u};
+  };
+
+} // namespace detail
+} // namespace client
+} // namespace carla
@@ -175,6 +175,10 @@ namespace detail {
       return _client.GetTimeout();
     }
 
+    void SetStreamingCompressionEnabled(bool enabled) {
+      _client.SetStreamingCompressionEnabled(enabled);
+    }
+
     std::string GetClientVersion() {
       return _client.GetClientVersion();
     }
@@ -201,6 +205,16 @@ namespace detail {
       _episode->RemoveOnTickEvent(id);
     }
 
+    void AddActorDeltaConsumer() {
+      DEBUG_ASSERT(_episode != nullptr);
+      _episode->AddActorDeltaConsumer();
+    }
+
+    void RemoveActorDeltaConsumer() {
+      DEBUG_ASSERT(_episode != nullptr);
+      _episode->RemoveActorDeltaConsumer();
+    }
+
     uint64_t Tick(time_duration timeout);
 
     /// @}
@@ -712,6 +726,13 @@ namespace detail {
       return _client.ApplyBatchSync(std::move(commands), do_tick_cue);
     }
 
+    uint32_t ApplyVehicleControlBatch(
+        const rpc::VehicleControlBatch &batch,
+        std::vector<unsigned char> &buffer,
+        bool do_tick_cue) {
+      return _client.ApplyVehicleControlBatch(batch, buffer, do_tick_cue);
+    }
+
     /// @}
     // =========================================================================
     /// @name Operations lights
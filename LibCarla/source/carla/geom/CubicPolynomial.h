@@ -9,6 +9,7 @@
 #include "carla/Debug.h"
 
 #include <array>
+#include <cstddef>
 
 namespace carla {
 namespace geom {
@@ -113,6 +114,23 @@ namespace geom {
       return _v[1] + x * (2 * _v[2] + x * 3 * _v[3]);
     }
 
+    /// Evaluates f(x) for @a count values of x. The coefficients are kept in
+    /// registers so the loop can be vectorized.
+    void Evaluate(const value_type *x, value_type *out, size_t count) const {
+      const value_type a = _v[0], b = _v[1], c = _v[2], d = _v[3];
+      for (size_t i = 0u; i < count; ++i) {
+        out[i] = a + x[i] * (b + x[i] * (c + x[i] * d));
+      }
+    }
+
+    /// Evaluates df/dx for @a count values of x.
+    void Tangent(const value_type *x, value_type *out, size_t count) const {
+      const value_type b = _v[1], c = _v[2], d = _v[3];
+      for (size_t i = 0u; i < count; ++i) {
+        out[i] = b + x[i] * (2 * c + x[i] * 3 * d);
+      }
+    }
+
     // =========================================================================
     // -- Arithmetic operators -------------------------------------------------
     // =========================================================================
@@ -17,11 +17,11 @@ namespace carla {
 namespace multigpu {
 
   /// Helper for reading incoming TCP messages. Allocates the whole message in
-  /// a single buffer.
+  /// a single buffer, popped from @a pool once the size is known.
   class IncomingMessage {
   public:
 
-    explicit IncomingMessage(Buffer &&buffer) : _buffer(std::move(buffer)) {}
+    explicit IncomingMessage(BufferPool &pool) : _pool(pool) {}
 
     boost::asio::mutable_buffer size_as_buffer() {
       return boost::asio::buffer(&_size, sizeof(_size));
@@ -29,7 +29,7 @@ namespace multigpu {
 
     boost::asio::mutable_buffer buffer() {
       DEBUG_ASSERT(_size > 0u);
-      _buffer.reset(_size);
+      _buffer = _pool.Pop(_size);
       return _buffer.buffer();
     }
 
@@ -43,6 +43,8 @@ namespace multigpu {
 
   private:
 
+    BufferPool &_pool;
+
     carla::streaming::detail::message_size_type _size = 0u;
 
     Buffer _buffer;
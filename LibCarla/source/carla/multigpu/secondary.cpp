@@ -230,7 +230,7 @@ namespace multigpu {
         return;
       }
 
-      auto message = std::make_shared<IncomingMessage>(self->_buffer_pool->Pop());
+      auto message = std::make_shared<IncomingMessage>(*self->_buffer_pool);
 
       auto handle_read_data = [weak, message](boost::system::error_code ec, size_t DEBUG_ONLY(bytes)) {
         auto self = weak.lock();
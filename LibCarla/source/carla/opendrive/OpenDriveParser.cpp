@@ -7,6 +7,7 @@
 #include "carla/opendrive/OpenDriveParser.h"
 
 #include "carla/Logging.h"
+#include "carla/ThreadPool.h"
 #include "carla/opendrive/parser/ControllerParser.h"
 #include "carla/opendrive/parser/GeoReferenceParser.h"
 #include "carla/opendrive/parser/GeometryParser.h"
@@ -21,10 +22,15 @@
 
 #include <pugixml/pugixml.hpp>
 
+#include <algorithm>
+#include <thread>
+
 namespace carla {
 namespace opendrive {
 
-  boost::optional<road::Map> OpenDriveParser::Load(const std::string &opendrive) {
+  boost::optional<road::Map> OpenDriveParser::Load(
+      const std::string &opendrive,
+      size_t number_of_threads) {
     pugi::xml_document xml;
     pugi::xml_parse_result parse_result = xml.load_string(opendrive.c_str());
 
@@ -33,20 +39,28 @@ namespace opendrive {
       return {};
     }
 
+    if (number_of_threads == 0u) {
+      number_of_threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    ThreadPool thread_pool;
+    if (number_of_threads > 1u) {
+      thread_pool.AsyncRun(number_of_threads);
+    }
+
     carla::road::MapBuilder map_builder;
 
     parser::GeoReferenceParser::Parse(xml, map_builder);
-    parser::RoadParser::Parse(xml, map_builder);
+    parser::RoadParser::Parse(xml, map_builder, thread_pool);
     parser::JunctionParser::Parse(xml, map_builder);
-    parser::GeometryParser::Parse(xml, map_builder);
-    parser::LaneParser::Parse(xml, map_builder);
-    parser::ProfilesParser::Parse(xml, map_builder);
+    parser::GeometryParser::Parse(xml, map_builder, thread_pool);
+    parser::LaneParser::Parse(xml, map_builder, thread_pool);
+    parser::ProfilesParser::Parse(xml, map_builder, thread_pool);
     parser::TrafficGroupParser::Parse(xml, map_builder);
-    parser::SignalParser::Parse(xml, map_builder);
+    parser::SignalParser::Parse(xml, map_builder, thread_pool);
     parser::ObjectParser::Parse(xml, map_builder);
     parser::ControllerParser::Parse(xml, map_builder);
 
-    return map_builder.Build();
+    return map_builder.Build(thread_pool);
   }
 
 } // namespace opendrive
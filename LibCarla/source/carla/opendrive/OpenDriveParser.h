@@ -10,6 +10,7 @@
 
 #include <boost/optional.hpp>
 
+#include <cstddef>
 #include <string>
 
 namespace carla {
@@ -18,7 +19,13 @@ namespace opendrive {
   class OpenDriveParser {
   public:
 
-    static boost::optional<road::Map> Load(const std::string &opendrive);
+    /// Parses the OpenDRIVE document and builds its map. By default everything
+    /// runs on the calling thread; callers may opt in to read the roads and
+    /// build the map on @a number_of_threads threads, all the available ones
+    /// if 0. The resulting map does not depend on the number of threads.
+    static boost::optional<road::Map> Load(
+        const std::string &opendrive,
+        size_t number_of_threads = 1u);
   };
 
 } // namespace opendrive
@@ -6,42 +6,122 @@
 
 #include "carla/opendrive/parser/LaneParser.h"
 
+#include "carla/opendrive/parser/RoadNodes.h"
 #include "carla/road/MapBuilder.h"
 
 #include <pugixml/pugixml.hpp>
 
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
 namespace carla {
 namespace opendrive {
 namespace parser {
 
+namespace {
+
+  struct LanePolynomial {
+    double s;
+    double a, b, c, d;
+  };
+
+  struct LaneRoadMarkLine {
+    double length;
+    double space;
+    double t;
+    double s;
+    std::string rule;
+    double width;
+  };
+
+  struct LaneRoadMark {
+    double s;
+    std::string type;
+    std::string weight;
+    std::string color;
+    std::string material;
+    double width;
+    std::string lane_change;
+    double height;
+    std::string type_name;
+    double type_width;
+    std::vector<LaneRoadMarkLine> lines;
+  };
+
+  struct LaneMaterial {
+    double s;
+    std::string surface;
+    double friction;
+    double roughness;
+  };
+
+  struct LaneVisibility {
+    double s;
+    double forward, back, left, right;
+  };
+
+  struct LaneSpeed {
+    double s;
+    double max;
+    std::string unit;
+  };
+
+  struct LaneAccess {
+    double s;
+    std::string restriction;
+  };
+
+  struct LaneHeight {
+    double s;
+    double inner, outer;
+  };
+
+  struct LaneRule {
+    double s;
+    std::string value;
+  };
+
+  struct LaneRecords {
+    road::LaneId id;
+    double section_s;
+    std::vector<LanePolynomial> widths;
+    std::vector<LanePolynomial> borders;
+    std::vector<LaneRoadMark> road_marks;
+    std::vector<LaneMaterial> materials;
+    std::vector<LaneVisibility> visibilities;
+    std::vector<LaneSpeed> speeds;
+    std::vector<LaneAccess> accesses;
+    std::vector<LaneHeight> heights;
+    std::vector<LaneRule> rules;
+  };
+
+  struct RoadLanes {
+    road::RoadId road_id { 0u };
+    std::vector<LaneRecords> lanes;
+  };
+
+} // namespace
+
   static void ParseLanes(
-      road::RoadId road_id,
       double s,
       const pugi::xml_node &parent_node,
-      carla::road::MapBuilder &map_builder) {
+      std::vector<LaneRecords> &lanes) {
     for (pugi::xml_node lane_node : parent_node.children("lane")) {
 
-      road::LaneId lane_id = lane_node.attribute("id").as_int();
-
-      road::Lane *lane = map_builder.GetLane(road_id, lane_id, s);
+      LaneRecords lane;
+      lane.id = lane_node.attribute("id").as_int();
+      lane.section_s = s;
 
       // Lane Width
-      int width_count = 0;
       for (pugi::xml_node lane_width_node : lane_node.children("width")) {
         const double s_offset = lane_width_node.attribute("sOffset").as_double();
         const double a = lane_width_node.attribute("a").as_double();
         const double b = lane_width_node.attribute("b").as_double();
         const double c = lane_width_node.attribute("c").as_double();
         const double d = lane_width_node.attribute("d").as_double();
-
-        // Call Map builder create Lane Width function
-        map_builder.CreateLaneWidth(lane, s_offset + s, a, b, c, d);
-        width_count++;
-      }
-      if (width_count == 0 && lane->GetId() != 0) {
-        map_builder.CreateLaneWidth(lane, s, 0.0, 0.0, 0.0, 0.0);
-        std::cout << "WARNING: In road " << lane->GetRoad()->GetId() << " lane " << lane->GetId() <<
-        " no \"<width>\" parameter found under \"<lane>\" tag. Using default values." << std::endl;
+        lane.widths.emplace_back(LanePolynomial{s_offset + s, a, b, c, d});
       }
 
       // Lane Border
@@ -51,84 +131,48 @@ namespace parser {
         const double b = lane_border_node.attribute("b").as_double();
         const double c = lane_border_node.attribute("c").as_double();
         const double d = lane_border_node.attribute("d").as_double();
-
-        // Call Map builder create Lane Border function
-        map_builder.CreateLaneBorder(lane, s_offset + s, a, b, c, d);
+        lane.borders.emplace_back(LanePolynomial{s_offset + s, a, b, c, d});
       }
 
       // Lane Road Mark
-      int road_mark_id = 0;
       for (pugi::xml_node lane_road_mark : lane_node.children("roadMark")) {
-        pugi::xml_node road_mark_type;
-        {
-          const double s_offset = lane_road_mark.attribute("sOffset").as_double();
-          const std::string type = lane_road_mark.attribute("type").value();
-          const std::string weight = lane_road_mark.attribute("weight").value();
-          const std::string color = lane_road_mark.attribute("color").value();
-          const std::string material = lane_road_mark.attribute("material").value();
-          const double width = lane_road_mark.attribute("width").as_double();
-          const std::string lane_change = lane_road_mark.attribute("laneChange").value();
-          const double height = lane_road_mark.attribute("height").as_double();
-
-          // Call map builder for LaneRoadMarkType
-
-          std::string type_name = "";
-          double type_width = 0.0;
-          road_mark_type = lane_road_mark.child("type");
-          if (road_mark_type) {
-            type_name = road_mark_type.attribute("name").value();
-            type_width = road_mark_type.attribute("width").as_double();
-          }
-
-          // Call map builder for LaneRoadMark
-          map_builder.CreateRoadMark(
-              lane,
-              road_mark_id,
-              s_offset + s,
-              type,
-              weight,
-              color,
-              material,
-              width,
-              lane_change,
-              height,
-              type_name,
-              type_width);
+        LaneRoadMark road_mark;
+        road_mark.s = lane_road_mark.attribute("sOffset").as_double() + s;
+        road_mark.type = lane_road_mark.attribute("type").value();
+        road_mark.weight = lane_road_mark.attribute("weight").value();
+        road_mark.color = lane_road_mark.attribute("color").value();
+        road_mark.material = lane_road_mark.attribute("material").value();
+        road_mark.width = lane_road_mark.attribute("width").as_double();
+        road_mark.lane_change = lane_road_mark.attribute("laneChange").value();
+        road_mark.height = lane_road_mark.attribute("height").as_double();
+        road_mark.type_width = 0.0;
+
+        pugi::xml_node road_mark_type = lane_road_mark.child("type");
+        if (road_mark_type) {
+          road_mark.type_name = road_mark_type.attribute("name").value();
+          road_mark.type_width = road_mark_type.attribute("width").as_double();
         }
 
         for (pugi::xml_node road_mark_type_line_node : road_mark_type.children("line")) {
-
-          const double length = road_mark_type_line_node.attribute("length").as_double();
-          const double space = road_mark_type_line_node.attribute("space").as_double();
-          const double t = road_mark_type_line_node.attribute("tOffset").as_double();
-          const double s_offset = road_mark_type_line_node.attribute("sOffset").as_double();
-          const std::string rule = road_mark_type_line_node.attribute("rule").value();
-          const double width = road_mark_type_line_node.attribute("width").as_double();
-
-          // Call map builder for LaneRoadMarkType LaneRoadMarkTypeLine
-          map_builder.CreateRoadMarkTypeLine(
-              lane,
-              road_mark_id,
-              length,
-              space,
-              t,
-              s_offset + s,
-              rule,
-              width);
+          LaneRoadMarkLine line;
+          line.length = road_mark_type_line_node.attribute("length").as_double();
+          line.space = road_mark_type_line_node.attribute("space").as_double();
+          line.t = road_mark_type_line_node.attribute("tOffset").as_double();
+          line.s = road_mark_type_line_node.attribute("sOffset").as_double() + s;
+          line.rule = road_mark_type_line_node.attribute("rule").value();
+          line.width = road_mark_type_line_node.attribute("width").as_double();
+          road_mark.lines.emplace_back(std::move(line));
         }
-        ++road_mark_id;
+        lane.road_marks.emplace_back(std::move(road_mark));
       }
 
       // Lane Material
       for (pugi::xml_node lane_material_node : lane_node.children("material")) {
-
         const double s_offset = lane_material_node.attribute("sOffset").as_double();
         const std::string surface = lane_material_node.attribute("surface").value();
         const double friction = lane_material_node.attribute("friction").as_double();
         const double roughness = lane_material_node.attribute("roughness").as_double();
-
-        // Create map builder for Lane Material
-        map_builder.CreateLaneMaterial(lane, s_offset + s, surface, friction, roughness);
+        lane.materials.emplace_back(LaneMaterial{s_offset + s, surface, friction, roughness});
       }
 
       // Lane Visibility
@@ -138,28 +182,22 @@ namespace parser {
         const double back = lane_visibility_node.attribute("back").as_double();
         const double left = lane_visibility_node.attribute("left").as_double();
         const double right = lane_visibility_node.attribute("right").as_double();
-
-        // Create map builder for Lane Visibility
-        map_builder.CreateLaneVisibility(lane, s_offset + s, forward, back, left, right);
+        lane.visibilities.emplace_back(LaneVisibility{s_offset + s, forward, back, left, right});
       }
 
       // Lane Speed
       for (pugi::xml_node lane_speed_node : lane_node.children("speed")) {
         const double s_offset = lane_speed_node.attribute("sOffset").as_double();
         const double max = lane_speed_node.attribute("max").as_double();
-        std::string unit = lane_speed_node.attribute("unit").value();
-
-        // Create map builder for Lane Speed
-        map_builder.CreateLaneSpeed(lane, s_offset + s, max, unit);
+        const std::string unit = lane_speed_node.attribute("unit").value();
+        lane.speeds.emplace_back(LaneSpeed{s_offset + s, max, unit});
       }
 
       // Lane Access
       for (pugi::xml_node lane_access_node : lane_node.children("access")) {
         const double s_offset = lane_access_node.attribute("sOffset").as_double();
         const std::string restriction = lane_access_node.attribute("restriction").value();
-
-        // Create map builder for Lane Access
-        map_builder.CreateLaneAccess(lane, s_offset + s, restriction);
+        lane.accesses.emplace_back(LaneAccess{s_offset + s, restriction});
       }
 
       // Lane Height
@@ -167,52 +205,147 @@ namespace parser {
         const double s_offset = lane_height_node.attribute("sOffset").as_double();
         const double inner = lane_height_node.attribute("inner").as_double();
         const double outer = lane_height_node.attribute("outer").as_double();
-
-        // Create map builder for Lane Height
-        map_builder.CreateLaneHeight(lane, s_offset + s, inner, outer);
+        lane.heights.emplace_back(LaneHeight{s_offset + s, inner, outer});
       }
 
       // Lane Rule
       for (pugi::xml_node lane_rule_node : lane_node.children("rule")) {
         const double s_offset = lane_rule_node.attribute("sOffset").as_double();
         const std::string value = lane_rule_node.attribute("value").value();
+        lane.rules.emplace_back(LaneRule{s_offset + s, value});
+      }
+
+      lanes.emplace_back(std::move(lane));
+    }
+  }
+
+  static RoadLanes ParseRoadLanes(const pugi::xml_node &road_node) {
+    RoadLanes road_lanes;
+    road_lanes.road_id = road_node.attribute("id").as_uint();
+
+    for (pugi::xml_node lanes_node : road_node.children("lanes")) {
 
-        // Create map builder for Lane Height
-        map_builder.CreateLaneRule(lane, s_offset + s, value);
+      for (pugi::xml_node lane_section_node : lanes_node.children("laneSection")) {
+        double s = lane_section_node.attribute("s").as_double();
+        pugi::xml_node left_node = lane_section_node.child("left");
+        if (left_node) {
+          ParseLanes(s, left_node, road_lanes.lanes);
+        }
+
+        pugi::xml_node center_node = lane_section_node.child("center");
+        if (center_node) {
+          ParseLanes(s, center_node, road_lanes.lanes);
+        }
+
+        pugi::xml_node right_node = lane_section_node.child("right");
+        if (right_node) {
+          ParseLanes(s, right_node, road_lanes.lanes);
+        }
       }
+    }
+    return road_lanes;
+  }
+
+  static void AddLane(
+      road::RoadId road_id,
+      const LaneRecords &records,
+      carla::road::MapBuilder &map_builder) {
+    road::Lane *lane = map_builder.GetLane(road_id, records.id, records.section_s);
+
+    // Lane Width
+    for (auto const &width : records.widths) {
+      map_builder.CreateLaneWidth(lane, width.s, width.a, width.b, width.c, width.d);
+    }
+    if (records.widths.empty() && lane->GetId() != 0) {
+      map_builder.CreateLaneWidth(lane, records.section_s, 0.0, 0.0, 0.0, 0.0);
+      std::cout << "WARNING: In road " << lane->GetRoad()->GetId() << " lane " << lane->GetId() <<
+      " no \"<width>\" parameter found under \"<lane>\" tag. Using default values." << std::endl;
+    }
+
+    // Lane Border
+    for (auto const &border : records.borders) {
+      map_builder.CreateLaneBorder(lane, border.s, border.a, border.b, border.c, border.d);
+    }
+
+    // Lane Road Mark
+    int road_mark_id = 0;
+    for (auto const &road_mark : records.road_marks) {
+      map_builder.CreateRoadMark(
+          lane,
+          road_mark_id,
+          road_mark.s,
+          road_mark.type,
+          road_mark.weight,
+          road_mark.color,
+          road_mark.material,
+          road_mark.width,
+          road_mark.lane_change,
+          road_mark.height,
+          road_mark.type_name,
+          road_mark.type_width);
+      for (auto const &line : road_mark.lines) {
+        map_builder.CreateRoadMarkTypeLine(
+            lane,
+            road_mark_id,
+            line.length,
+            line.space,
+            line.t,
+            line.s,
+            line.rule,
+            line.width);
+      }
+      ++road_mark_id;
+    }
+
+    // Lane Material
+    for (auto const &material : records.materials) {
+      map_builder.CreateLaneMaterial(lane, material.s, material.surface, material.friction, material.roughness);
+    }
+
+    // Lane Visibility
+    for (auto const &visibility : records.visibilities) {
+      map_builder.CreateLaneVisibility(
+          lane,
+          visibility.s,
+          visibility.forward,
+          visibility.back,
+          visibility.left,
+          visibility.right);
+    }
+
+    // Lane Speed
+    for (auto const &speed : records.speeds) {
+      map_builder.CreateLaneSpeed(lane, speed.s, speed.max, speed.unit);
+    }
+
+    // Lane Access
+    for (auto const &access : records.accesses) {
+      map_builder.CreateLaneAccess(lane, access.s, access.restriction);
+    }
 
+    // Lane Height
+    for (auto const &height : records.heights) {
+      map_builder.CreateLaneHeight(lane, height.s, height.inner, height.outer);
+    }
+
+    // Lane Rule
+    for (auto const &rule : records.rules) {
+      map_builder.CreateLaneRule(lane, rule.s, rule.value);
     }
   }
 
   void LaneParser::Parse(
       const pugi::xml_document &xml,
-      carla::road::MapBuilder &map_builder) {
-
-    pugi::xml_node open_drive_node = xml.child("OpenDRIVE");
+      carla::road::MapBuilder &map_builder,
+      ThreadPool &thread_pool) {
 
     // Lanes
-    for (pugi::xml_node road_node : open_drive_node.children("road")) {
-      road::RoadId road_id = road_node.attribute("id").as_uint();
-
-      for (pugi::xml_node lanes_node : road_node.children("lanes")) {
-
-        for (pugi::xml_node lane_section_node : lanes_node.children("laneSection")) {
-          double s = lane_section_node.attribute("s").as_double();
-          pugi::xml_node left_node = lane_section_node.child("left");
-          if (left_node) {
-            ParseLanes(road_id, s, left_node, map_builder);
-          }
-
-          pugi::xml_node center_node = lane_section_node.child("center");
-          if (center_node) {
-            ParseLanes(road_id, s, center_node, map_builder);
-          }
-
-          pugi::xml_node right_node = lane_section_node.child("right");
-          if (right_node) {
-            ParseLanes(road_id, s, right_node, map_builder);
-          }
-        }
+    const std::vector<RoadLanes> roads = ParseRoadNodes(xml, thread_pool, ParseRoadLanes);
+
+    // map_builder calls
+    for (auto const &road_lanes : roads) {
+      for (auto const &lane : road_lanes.lanes) {
+        AddLane(road_lanes.road_id, lane, map_builder);
       }
     }
   }
@@ -6,6 +6,7 @@
 
 #include "carla/opendrive/parser/ProfilesParser.h"
 
+#include "carla/opendrive/parser/RoadNodes.h"
 #include "carla/road/MapBuilder.h"
 
 #include <pugixml/pugixml.hpp>
@@ -15,7 +16,6 @@ namespace opendrive {
 namespace parser {
 
   struct ElevationProfile {
-    carla::road::Road *road { nullptr };
     double s            { 0.0 };
     double a            { 0.0 };
     double b            { 0.0 };
@@ -32,7 +32,6 @@ namespace parser {
   };
 
   struct LateralProfile {
-    carla::road::Road *road { nullptr };
     double s            { 0.0 };
     double a            { 0.0 };
     double b            { 0.0 };
@@ -43,103 +42,94 @@ namespace parser {
     LateralShape shape;
   };
 
-  void ProfilesParser::Parse(
-      const pugi::xml_document &xml,
-      carla::road::MapBuilder &map_builder) {
-
-    std::vector<ElevationProfile> elevation_profile;
-    std::vector<LateralProfile> lateral_profile;
-
-    for (pugi::xml_node node_road : xml.child("OpenDRIVE").children("road")) {
-
-      // parse elevation profile
-      pugi::xml_node node_profile = node_road.child("elevationProfile");
-      uint64_t number_profiles = 0;
-      if (node_profile) {
-        // all geometry
-        for (pugi::xml_node node_elevation : node_profile.children("elevation")) {
-          ElevationProfile elev;
-
-          // get road id
-          road::RoadId road_id = node_road.attribute("id").as_uint();
-          elev.road = map_builder.GetRoad(road_id);
-
-          // get common properties
-          elev.s = node_elevation.attribute("s").as_double();
-          elev.a = node_elevation.attribute("a").as_double();
-          elev.b = node_elevation.attribute("b").as_double();
-          elev.c = node_elevation.attribute("c").as_double();
-          elev.d = node_elevation.attribute("d").as_double();
-
-          // add it
-          elevation_profile.emplace_back(elev);
-          number_profiles++;
-        }
-      }
-      // add a default profile if none is found
-      if(number_profiles == 0){
+  struct RoadProfiles {
+    road::RoadId road_id { 0u };
+    std::vector<ElevationProfile> elevation;
+    std::vector<LateralProfile> lateral;
+  };
+
+  static RoadProfiles ParseRoadProfiles(const pugi::xml_node &node_road) {
+    RoadProfiles profiles;
+    profiles.road_id = node_road.attribute("id").as_uint();
+
+    // parse elevation profile
+    pugi::xml_node node_profile = node_road.child("elevationProfile");
+    if (node_profile) {
+      // all geometry
+      for (pugi::xml_node node_elevation : node_profile.children("elevation")) {
         ElevationProfile elev;
-        road::RoadId road_id = node_road.attribute("id").as_uint();
-        elev.road = map_builder.GetRoad(road_id);
 
         // get common properties
-        elev.s = 0;
-        elev.a = 0;
-        elev.b = 0;
-        elev.c = 0;
-        elev.d = 0;
+        elev.s = node_elevation.attribute("s").as_double();
+        elev.a = node_elevation.attribute("a").as_double();
+        elev.b = node_elevation.attribute("b").as_double();
+        elev.c = node_elevation.attribute("c").as_double();
+        elev.d = node_elevation.attribute("d").as_double();
 
         // add it
-        elevation_profile.emplace_back(elev);
+        profiles.elevation.emplace_back(elev);
       }
+    }
+    // add a default profile if none is found
+    if (profiles.elevation.empty()) {
+      profiles.elevation.emplace_back(ElevationProfile{});
+    }
+
+    // parse lateral profile
+    node_profile = node_road.child("lateralProfile");
+    if (node_profile) {
+      for (pugi::xml_node node : node_profile.children()) {
+        LateralProfile lateral;
 
-      // parse lateral profile
-      node_profile = node_road.child("lateralProfile");
-      if (node_profile) {
-        for (pugi::xml_node node : node_profile.children()) {
-          LateralProfile lateral;
-
-          // get road id
-          road::RoadId road_id = node_road.attribute("id").as_uint();
-          lateral.road = map_builder.GetRoad(road_id);
-
-          // get common properties
-          lateral.s = node.attribute("s").as_double();
-          lateral.a = node.attribute("a").as_double();
-          lateral.b = node.attribute("b").as_double();
-          lateral.c = node.attribute("c").as_double();
-          lateral.d = node.attribute("d").as_double();
-
-          // handle different types
-          lateral.type = node.name();
-          if (lateral.type == "crossfall") {
-            lateral.cross.side = node.attribute("side").value();
-          } else if (lateral.type == "shape") {
-            lateral.shape.t = node.attribute("t").as_double();
-          }
-
-          // add it
-          lateral_profile.emplace_back(lateral);
+        // get common properties
+        lateral.s = node.attribute("s").as_double();
+        lateral.a = node.attribute("a").as_double();
+        lateral.b = node.attribute("b").as_double();
+        lateral.c = node.attribute("c").as_double();
+        lateral.d = node.attribute("d").as_double();
+
+        // handle different types
+        lateral.type = node.name();
+        if (lateral.type == "crossfall") {
+          lateral.cross.side = node.attribute("side").value();
+        } else if (lateral.type == "shape") {
+          lateral.shape.t = node.attribute("t").as_double();
         }
+
+        // add it
+        profiles.lateral.emplace_back(lateral);
       }
     }
+    return profiles;
+  }
+
+  void ProfilesParser::Parse(
+      const pugi::xml_document &xml,
+      carla::road::MapBuilder &map_builder,
+      ThreadPool &thread_pool) {
+
+    const std::vector<RoadProfiles> roads =
+        ParseRoadNodes(xml, thread_pool, ParseRoadProfiles);
 
     // map_builder calls
-    for (auto const pro : elevation_profile) {
-      map_builder.AddRoadElevationProfile(pro.road, pro.s, pro.a, pro.b, pro.c, pro.d);
+    for (auto const &profiles : roads) {
+      carla::road::Road *road = map_builder.GetRoad(profiles.road_id);
+      for (auto const &pro : profiles.elevation) {
+        map_builder.AddRoadElevationProfile(road, pro.s, pro.a, pro.b, pro.c, pro.d);
+      }
+      /// @todo: RoadInfo classes must be created to fit this information
+      // for (auto const pro : profiles.lateral) {
+      //   if (pro.type == "superelevation")
+      //     map_builder.AddRoadLateralSuperElevation(road, pro.s, pro.a,
+      // pro.b, pro.c, pro.d);
+      //   else if (pro.type == "crossfall")
+      //     map_builder.AddRoadLateralCrossfall(road, pro.s, pro.a, pro.b,
+      // pro.c, pro.d, pro.cross.side);
+      //   else if (pro.type == "shape")
+      //     map_builder.AddRoadLateralShape(road, pro.s, pro.a, pro.b, pro.c,
+      // pro.d, pro.shape.t);
+      // }
     }
-    /// @todo: RoadInfo classes must be created to fit this information
-    // for (auto const pro : lateral_profile) {
-    //   if (pro.type == "superelevation")
-    //     map_builder.AddRoadLateralSuperElevation(pro.road, pro.s, pro.a,
-    // pro.b, pro.c, pro.d);
-    //   else if (pro.type == "crossfall")
-    //     map_builder.AddRoadLateralCrossfall(pro.road, pro.s, pro.a, pro.b,
-    // pro.c, pro.d, pro.cross.side);
-    //   else if (pro.type == "shape")
-    //     map_builder.AddRoadLateralShape(pro.road, pro.s, pro.a, pro.b, pro.c,
-    // pro.d, pro.shape.t);
-    // }
   }
 
 } // namespace parser
@@ -12,6 +12,8 @@ namespace pugi {
 
 namespace carla {
 
+  class ThreadPool;
+
 namespace road {
   class MapBuilder;
 } // namespace road
@@ -22,9 +24,12 @@ namespace parser {
   class ProfilesParser {
   public:
 
+    /// The roads are read in parallel on @a thread_pool and added to
+    /// @a map_builder in document order.
     static void Parse(
         const pugi::xml_document &xml,
-        carla::road::MapBuilder &map_builder);
+        carla::road::MapBuilder &map_builder,
+        ThreadPool &thread_pool);
 
   };
 
@@ -0,0 +1,45 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/ThreadPool.h"
+
+#include <pugixml/pugixml.hpp>
+
+#include <utility>
+#include <vector>
+
+namespace carla {
+namespace opendrive {
+namespace parser {
+
+  /// Calls @a parse_road for every "road" node of the document, splitting the
+  /// roads across the threads of @a thread_pool, and returns the results in
+  /// document order. @a parse_road must only read the node, the MapBuilder
+  /// calls are done afterwards in this order so that the map does not depend
+  /// on the number of threads.
+  template <
+      typename ParseRoadT,
+      typename ResultT = decltype(std::declval<ParseRoadT &>()(std::declval<const pugi::xml_node &>()))>
+  std::vector<ResultT> ParseRoadNodes(
+      const pugi::xml_document &xml,
+      ThreadPool &thread_pool,
+      ParseRoadT &&parse_road) {
+    std::vector<pugi::xml_node> road_nodes;
+    for (pugi::xml_node road_node : xml.child("OpenDRIVE").children("road")) {
+      road_nodes.emplace_back(road_node);
+    }
+    std::vector<ResultT> result(road_nodes.size());
+    thread_pool.ParallelFor(road_nodes.size(), [&](size_t index) {
+      result[index] = parse_road(road_nodes[index]);
+    });
+    return result;
+  }
+
+} // namespace parser
+} // namespace opendrive
+} // namespace carla
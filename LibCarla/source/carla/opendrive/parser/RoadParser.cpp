@@ -8,6 +8,7 @@
 
 #include "carla/Logging.h"
 #include "carla/StringUtil.h"
+#include "carla/opendrive/parser/RoadNodes.h"
 #include "carla/road/MapBuilder.h"
 #include "carla/road/RoadTypes.h"
 
@@ -110,149 +111,149 @@ namespace parser {
     }
   }
 
-  void RoadParser::Parse(
-      const pugi::xml_document &xml,
-      carla::road::MapBuilder &map_builder) {
+  static Road ParseRoad(const pugi::xml_node &node_road) {
+    Road road { 0, "", 0.0, -1, 0, 0, {}, {}, {} };
+
+    // attributes
+    road.id = node_road.attribute("id").as_uint();
+    road.name = node_road.attribute("name").value();
+    road.length = node_road.attribute("length").as_double();
+    road.junction_id = node_road.attribute("junction").as_int();
 
-    std::vector<Road> roads;
+    // link
+    pugi::xml_node link = node_road.child("link");
+    if (link) {
+      if (link.child("predecessor")) {
+        road.predecessor = link.child("predecessor").attribute("elementId").as_uint();
+      }
+      if (link.child("successor")) {
+        road.successor = link.child("successor").attribute("elementId").as_uint();
+      }
+    }
 
-    for (pugi::xml_node node_road : xml.child("OpenDRIVE").children("road")) {
-      Road road { 0, "", 0.0, -1, 0, 0, {}, {}, {} };
+    // types
+    for (pugi::xml_node node_type : node_road.children("type")) {
+      RoadTypeSpeed type { 0.0, "", 0.0, "" };
 
-      // attributes
-      road.id = node_road.attribute("id").as_uint();
-      road.name = node_road.attribute("name").value();
-      road.length = node_road.attribute("length").as_double();
-      road.junction_id = node_road.attribute("junction").as_int();
+      type.s = node_type.attribute("s").as_double();
+      type.type = node_type.attribute("type").value();
 
-      // link
-      pugi::xml_node link = node_road.child("link");
-      if (link) {
-        if (link.child("predecessor")) {
-          road.predecessor = link.child("predecessor").attribute("elementId").as_uint();
-        }
-        if (link.child("successor")) {
-          road.successor = link.child("successor").attribute("elementId").as_uint();
-        }
+      // speed type
+      pugi::xml_node speed = node_type.child("speed");
+      if (speed) {
+        type.max = speed.attribute("max").as_double();
+        type.unit = speed.attribute("unit").value();
       }
 
-      // types
-      for (pugi::xml_node node_type : node_road.children("type")) {
-        RoadTypeSpeed type { 0.0, "", 0.0, "" };
+      // add it
+      road.speed.emplace_back(type);
+    }
 
-        type.s = node_type.attribute("s").as_double();
-        type.type = node_type.attribute("type").value();
+    // section offsets
+    for (pugi::xml_node node_offset : node_road.child("lanes").children("laneOffset")) {
+      LaneOffset offset { 0.0, 0.0, 0.0, 0.0, 0.0 };
+      offset.s = node_offset.attribute("s").as_double();
+      offset.a = node_offset.attribute("a").as_double();
+      offset.b = node_offset.attribute("b").as_double();
+      offset.c = node_offset.attribute("c").as_double();
+      offset.d = node_offset.attribute("d").as_double();
+      road.section_offsets.emplace_back(offset);
+    }
+    // Add default lane offset if none is found
+    if(road.section_offsets.size() == 0) {
+      LaneOffset offset { 0.0, 0.0, 0.0, 0.0, 0.0 };
+      road.section_offsets.emplace_back(offset);
+    }
+
+    // lane sections
+    for (pugi::xml_node node_section : node_road.child("lanes").children("laneSection")) {
+      LaneSection section { 0.0, {} };
+
+      section.s = node_section.attribute("s").as_double();
+
+      // left lanes
+      for (pugi::xml_node node_lane : node_section.child("left").children("lane")) {
+        Lane lane { 0, road::Lane::LaneType::None, false, 0, 0 };
+
+        lane.id = node_lane.attribute("id").as_int();
+        lane.type = StringToLaneType(node_lane.attribute("type").value());
+        lane.level = node_lane.attribute("level").as_bool();
 
-        // speed type
-        pugi::xml_node speed = node_type.child("speed");
-        if (speed) {
-          type.max = speed.attribute("max").as_double();
-          type.unit = speed.attribute("unit").value();
+        // link
+        pugi::xml_node link2 = node_lane.child("link");
+        if (link2) {
+          if (link2.child("predecessor")) {
+            lane.predecessor = link2.child("predecessor").attribute("id").as_int();
+          }
+          if (link2.child("successor")) {
+            lane.successor = link2.child("successor").attribute("id").as_int();
+          }
         }
 
         // add it
-        road.speed.emplace_back(type);
+        section.lanes.emplace_back(lane);
       }
 
-      // section offsets
-      for (pugi::xml_node node_offset : node_road.child("lanes").children("laneOffset")) {
-        LaneOffset offset { 0.0, 0.0, 0.0, 0.0, 0.0 };
-        offset.s = node_offset.attribute("s").as_double();
-        offset.a = node_offset.attribute("a").as_double();
-        offset.b = node_offset.attribute("b").as_double();
-        offset.c = node_offset.attribute("c").as_double();
-        offset.d = node_offset.attribute("d").as_double();
-        road.section_offsets.emplace_back(offset);
-      }
-      // Add default lane offset if none is found
-      if(road.section_offsets.size() == 0) {
-        LaneOffset offset { 0.0, 0.0, 0.0, 0.0, 0.0 };
-        road.section_offsets.emplace_back(offset);
-      }
+      // center lane
+      for (pugi::xml_node node_lane : node_section.child("center").children("lane")) {
+        Lane lane { 0, road::Lane::LaneType::None, false, 0, 0 };
 
-      // lane sections
-      for (pugi::xml_node node_section : node_road.child("lanes").children("laneSection")) {
-        LaneSection section { 0.0, {} };
-
-        section.s = node_section.attribute("s").as_double();
-
-        // left lanes
-        for (pugi::xml_node node_lane : node_section.child("left").children("lane")) {
-          Lane lane { 0, road::Lane::LaneType::None, false, 0, 0 };
-
-          lane.id = node_lane.attribute("id").as_int();
-          lane.type = StringToLaneType(node_lane.attribute("type").value());
-          lane.level = node_lane.attribute("level").as_bool();
-
-          // link
-          pugi::xml_node link2 = node_lane.child("link");
-          if (link2) {
-            if (link2.child("predecessor")) {
-              lane.predecessor = link2.child("predecessor").attribute("id").as_int();
-            }
-            if (link2.child("successor")) {
-              lane.successor = link2.child("successor").attribute("id").as_int();
-            }
-          }
+        lane.id = node_lane.attribute("id").as_int();
+        lane.type = StringToLaneType(node_lane.attribute("type").value());
+        lane.level = node_lane.attribute("level").as_bool();
 
-          // add it
-          section.lanes.emplace_back(lane);
+        // link (probably it never exists)
+        pugi::xml_node link2 = node_lane.child("link");
+        if (link2) {
+          if (link2.child("predecessor")) {
+            lane.predecessor = link2.child("predecessor").attribute("id").as_int();
+          }
+          if (link2.child("successor")) {
+            lane.successor = link2.child("successor").attribute("id").as_int();
+          }
         }
 
-        // center lane
-        for (pugi::xml_node node_lane : node_section.child("center").children("lane")) {
-          Lane lane { 0, road::Lane::LaneType::None, false, 0, 0 };
-
-          lane.id = node_lane.attribute("id").as_int();
-          lane.type = StringToLaneType(node_lane.attribute("type").value());
-          lane.level = node_lane.attribute("level").as_bool();
-
-          // link (probably it never exists)
-          pugi::xml_node link2 = node_lane.child("link");
-          if (link2) {
-            if (link2.child("predecessor")) {
-              lane.predecessor = link2.child("predecessor").attribute("id").as_int();
-            }
-            if (link2.child("successor")) {
-              lane.successor = link2.child("successor").attribute("id").as_int();
-            }
-          }
+        // add it
+        section.lanes.emplace_back(lane);
+      }
 
-          // add it
-          section.lanes.emplace_back(lane);
-        }
+      // right lane
+      for (pugi::xml_node node_lane : node_section.child("right").children("lane")) {
+        Lane lane { 0, road::Lane::LaneType::None, false, 0, 0 };
 
-        // right lane
-        for (pugi::xml_node node_lane : node_section.child("right").children("lane")) {
-          Lane lane { 0, road::Lane::LaneType::None, false, 0, 0 };
-
-          lane.id = node_lane.attribute("id").as_int();
-          lane.type = StringToLaneType(node_lane.attribute("type").value());
-          lane.level = node_lane.attribute("level").as_bool();
-
-          // link
-          pugi::xml_node link2 = node_lane.child("link");
-          if (link2) {
-            if (link2.child("predecessor")) {
-              lane.predecessor = link2.child("predecessor").attribute("id").as_int();
-            }
-            if (link2.child("successor")) {
-              lane.successor = link2.child("successor").attribute("id").as_int();
-            }
-          }
+        lane.id = node_lane.attribute("id").as_int();
+        lane.type = StringToLaneType(node_lane.attribute("type").value());
+        lane.level = node_lane.attribute("level").as_bool();
 
-          // add it
-          section.lanes.emplace_back(lane);
+        // link
+        pugi::xml_node link2 = node_lane.child("link");
+        if (link2) {
+          if (link2.child("predecessor")) {
+            lane.predecessor = link2.child("predecessor").attribute("id").as_int();
+          }
+          if (link2.child("successor")) {
+            lane.successor = link2.child("successor").attribute("id").as_int();
+          }
         }
 
-        // add section
-        road.sections.emplace_back(section);
+        // add it
+        section.lanes.emplace_back(lane);
       }
 
-      // add road
-      roads.emplace_back(road);
+      // add section
+      road.sections.emplace_back(section);
     }
 
+    return road;
+  }
+
+  void RoadParser::Parse(
+      const pugi::xml_document &xml,
+      carla::road::MapBuilder &map_builder,
+      ThreadPool &thread_pool) {
+
+    const std::vector<Road> roads = ParseRoadNodes(xml, thread_pool, ParseRoad);
+
     // test print
     /*
        printf("Roads: %d\n", roads.size());
@@ -287,7 +288,7 @@ namespace parser {
      */
 
     // map_builder calls
-    for (auto const r : roads) {
+    for (auto const &r : roads) {
       carla::road::Road *road = map_builder.AddRoad(r.id,
           r.name,
           r.length,
@@ -6,147 +6,239 @@
 
 #include "carla/opendrive/parser/SignalParser.h"
 
+#include "carla/opendrive/parser/RoadNodes.h"
 #include "carla/road/MapBuilder.h"
 
 #include <pugixml/pugixml.hpp>
 
+#include <string>
+#include <utility>
+#include <vector>
+
 namespace carla {
 namespace opendrive {
 namespace parser {
 
-  static void AddValidity(
-    road::element::RoadInfoSignal* signal_reference,
+namespace {
+
+  struct LaneValidity {
+    road::LaneId from_lane;
+    road::LaneId to_lane;
+  };
+
+  struct Dependency {
+    std::string id;
+    std::string type;
+  };
+
+  struct PositionInertial {
+    double x, y, z;
+    double hdg, pitch, roll;
+  };
+
+  struct Signal {
+    double s_position;
+    double t_position;
+    road::SignId signal_id;
+    std::string name;
+    std::string dynamic;
+    std::string orientation;
+    double zOffset;
+    std::string country;
+    std::string type;
+    std::string subtype;
+    double value;
+    std::string unit;
+    double height;
+    double width;
+    std::string text;
+    double hOffset;
+    double pitch;
+    double roll;
+    std::vector<LaneValidity> validities;
+    std::vector<Dependency> dependencies;
+    std::vector<PositionInertial> positions;
+  };
+
+  struct SignalReference {
+    double s_position;
+    double t_position;
+    road::SignId signal_id;
+    std::string orientation;
+    std::vector<LaneValidity> validities;
+  };
+
+  struct RoadSignals {
+    road::RoadId road_id { 0u };
+    std::vector<Signal> signals;
+    std::vector<SignalReference> signal_references;
+  };
+
+} // namespace
+
+  static std::vector<LaneValidity> ParseValidities(
     pugi::xml_node parent_node,
-    const std::string &node_name,
-    road::MapBuilder &map_builder) {
+    const std::string &node_name) {
+    std::vector<LaneValidity> validities;
     for (pugi::xml_node validity_node = parent_node.child(node_name.c_str());
         validity_node;
         validity_node = validity_node.next_sibling("validity")) {
       const auto from_lane = validity_node.attribute("fromLane").as_int();
       const auto to_lane = validity_node.attribute("toLane").as_int();
-      map_builder.AddValidityToSignalReference(signal_reference, from_lane, to_lane);
+      validities.emplace_back(LaneValidity{from_lane, to_lane});
     }
+    return validities;
+  }
+
+  static void AddValidity(
+    road::element::RoadInfoSignal* signal_reference,
+    const std::vector<LaneValidity> &validities,
+    road::MapBuilder &map_builder) {
+    for (auto const &validity : validities) {
+      map_builder.AddValidityToSignalReference(signal_reference, validity.from_lane, validity.to_lane);
+    }
+  }
+
+  static RoadSignals ParseRoadSignals(const pugi::xml_node &road_node) {
+    RoadSignals road_signals;
+    road_signals.road_id = road_node.attribute("id").as_uint();
+
+    const pugi::xml_node signals_node = road_node.child("signals");
+    if(signals_node){
+      for (pugi::xml_node signal_node : signals_node.children("signal")) {
+        Signal signal;
+        signal.s_position = signal_node.attribute("s").as_double();
+        signal.t_position = signal_node.attribute("t").as_double();
+        signal.signal_id = signal_node.attribute("id").value();
+        signal.name = signal_node.attribute("name").value();
+        signal.dynamic =  signal_node.attribute("dynamic").value();
+        signal.orientation =  signal_node.attribute("orientation").value();
+        signal.zOffset = signal_node.attribute("zOffSet").as_double();
+        signal.country =  signal_node.attribute("country").value();
+        signal.type =  signal_node.attribute("type").value();
+        signal.subtype =  signal_node.attribute("subtype").value();
+        signal.value = signal_node.attribute("value").as_double();
+        signal.unit =  signal_node.attribute("unit").value();
+        signal.height = signal_node.attribute("height").as_double();
+        signal.width = signal_node.attribute("width").as_double();
+        signal.text =  signal_node.attribute("text").value();
+        signal.hOffset = signal_node.attribute("hOffset").as_double();
+        signal.pitch = signal_node.attribute("pitch").as_double();
+        signal.roll = signal_node.attribute("roll").as_double();
+        signal.validities = ParseValidities(signal_node, "validity");
+
+        for (pugi::xml_node dependency_node : signal_node.children("dependency")) {
+          signal.dependencies.emplace_back(Dependency{
+              dependency_node.attribute("id").value(),
+              dependency_node.attribute("type").value()});
+        }
+        for (pugi::xml_node position_node : signal_node.children("positionInertial")) {
+          signal.positions.emplace_back(PositionInertial{
+              position_node.attribute("x").as_double(),
+              position_node.attribute("y").as_double(),
+              position_node.attribute("z").as_double(),
+              position_node.attribute("hdg").as_double(),
+              position_node.attribute("pitch").as_double(),
+              position_node.attribute("roll").as_double()});
+        }
+        road_signals.signals.emplace_back(std::move(signal));
+      }
+      for (pugi::xml_node signal_reference_node : signals_node.children("signalReference")) {
+        SignalReference signal_reference;
+        signal_reference.s_position = signal_reference_node.attribute("s").as_double();
+        signal_reference.t_position = signal_reference_node.attribute("t").as_double();
+        signal_reference.signal_id = signal_reference_node.attribute("id").value();
+        signal_reference.orientation = signal_reference_node.attribute("orientation").value();
+        signal_reference.validities = ParseValidities(signal_reference_node, "validity");
+        road_signals.signal_references.emplace_back(std::move(signal_reference));
+      }
+    }
+    return road_signals;
   }
 
   void SignalParser::Parse(
       const pugi::xml_document &xml,
-      carla::road::MapBuilder &map_builder) {
-
-    // Extracting the OpenDRIVE
-    const pugi::xml_node opendrive_node = xml.child("OpenDRIVE");
-    const std::string validity = "validity";
-    for (pugi::xml_node road_node = opendrive_node.child("road");
-        road_node;
-        road_node = road_node.next_sibling("road")) {
-
-      road::RoadId road_id = road_node.attribute("id").as_uint();
-
-      const pugi::xml_node signals_node = road_node.child("signals");
-      if(signals_node){
-        for (pugi::xml_node signal_node : signals_node.children("signal")) {
-          const double s_position = signal_node.attribute("s").as_double();
-          const double t_position = signal_node.attribute("t").as_double();
-          const road::SignId signal_id = signal_node.attribute("id").value();
-          const std::string name = signal_node.attribute("name").value();
-          const std::string dynamic =  signal_node.attribute("dynamic").value();
-          const std::string orientation =  signal_node.attribute("orientation").value();
-          const double zOffset = signal_node.attribute("zOffSet").as_double();
-          const std::string country =  signal_node.attribute("country").value();
-          const std::string type =  signal_node.attribute("type").value();
-          const std::string subtype =  signal_node.attribute("subtype").value();
-          const double value = signal_node.attribute("value").as_double();
-          const std::string unit =  signal_node.attribute("unit").value();
-          const double height = signal_node.attribute("height").as_double();
-          const double width = signal_node.attribute("width").as_double();
-          const std::string text =  signal_node.attribute("text").value();
-          const double hOffset = signal_node.attribute("hOffset").as_double();
-          const double pitch = signal_node.attribute("pitch").as_double();
-          const double roll = signal_node.attribute("roll").as_double();
-          log_debug("Road: ",
-              road_id,
-              "Adding Signal: ",
-              s_position,
-              t_position,
-              signal_id,
-              name,
-              dynamic,
-              orientation,
-              zOffset,
-              country,
-              type,
-              subtype,
-              value,
-              unit,
-              height,
-              width,
-              text,
-              hOffset,
-              pitch,
-              roll);
-
-          carla::road::Road *road = map_builder.GetRoad(road_id);
-          auto signal_reference = map_builder.AddSignal(road,
-              signal_id,
-              s_position,
-              t_position,
-              name,
-              dynamic,
-              orientation,
-              zOffset,
-              country,
-              type,
-              subtype,
-              value,
-              unit,
-              height,
-              width,
-              text,
-              hOffset,
-              pitch,
-              roll);
-          AddValidity(signal_reference, signal_node, "validity", map_builder);
-
-          for (pugi::xml_node dependency_node : signal_node.children("dependency")) {
-            const std::string dependency_id = dependency_node.attribute("id").value();
-            const std::string dependency_type = dependency_node.attribute("type").value();
-            log_debug("Added dependency to signal ", signal_id, ":", dependency_id, dependency_type);
-            map_builder.AddDependencyToSignal(signal_id, dependency_id, dependency_type);
-          }
-          for (pugi::xml_node position_node : signal_node.children("positionInertial")) {
-            const double x = position_node.attribute("x").as_double();
-            const double y = position_node.attribute("y").as_double();
-            const double z = position_node.attribute("z").as_double();
-            const double hdg = position_node.attribute("hdg").as_double();
-            const double inertial_pitch = position_node.attribute("pitch").as_double();
-            const double inertial_roll = position_node.attribute("roll").as_double();
-            map_builder.AddSignalPositionInertial(
-                signal_id,
-                x, y, z,
-                hdg, inertial_pitch, inertial_roll);
-          }
+      carla::road::MapBuilder &map_builder,
+      ThreadPool &thread_pool) {
+
+    const std::vector<RoadSignals> roads = ParseRoadNodes(xml, thread_pool, ParseRoadSignals);
+
+    // map_builder calls
+    for (auto const &road_signals : roads) {
+      const road::RoadId road_id = road_signals.road_id;
+
+      for (auto const &signal : road_signals.signals) {
+        log_debug("Road: ",
+            road_id,
+            "Adding Signal: ",
+            signal.s_position,
+            signal.t_position,
+            signal.signal_id,
+            signal.name,
+            signal.dynamic,
+            signal.orientation,
+            signal.zOffset,
+            signal.country,
+            signal.type,
+            signal.subtype,
+            signal.value,
+            signal.unit,
+            signal.height,
+            signal.width,
+            signal.text,
+            signal.hOffset,
+            signal.pitch,
+            signal.roll);
+
+        carla::road::Road *road = map_builder.GetRoad(road_id);
+        auto signal_reference = map_builder.AddSignal(road,
+            signal.signal_id,
+            signal.s_position,
+            signal.t_position,
+            signal.name,
+            signal.dynamic,
+            signal.orientation,
+            signal.zOffset,
+            signal.country,
+            signal.type,
+            signal.subtype,
+            signal.value,
+            signal.unit,
+            signal.height,
+            signal.width,
+            signal.text,
+            signal.hOffset,
+            signal.pitch,
+            signal.roll);
+        AddValidity(signal_reference, signal.validities, map_builder);
+
+        for (auto const &dependency : signal.dependencies) {
+          log_debug("Added dependency to signal ", signal.signal_id, ":", dependency.id, dependency.type);
+          map_builder.AddDependencyToSignal(signal.signal_id, dependency.id, dependency.type);
         }
-        for (pugi::xml_node signal_reference_node : signals_node.children("signalReference")) {
-          const double s_position = signal_reference_node.attribute("s").as_double();
-          const double t_position = signal_reference_node.attribute("t").as_double();
-          const road::SignId signal_id = signal_reference_node.attribute("id").value();
-          const std::string signal_reference_orientation =
-              signal_reference_node.attribute("orientation").value();
-          log_debug("Road: ",
-              road_id,
-              "Added SignalReference ",
-              s_position,
-              t_position,
-              signal_reference_orientation);
-          carla::road::Road *road = map_builder.GetRoad(road_id);
-          auto signal_reference = map_builder.AddSignalReference(
-              road,
-              signal_id,
-              s_position,
-              t_position,
-              signal_reference_orientation);
-          AddValidity(signal_reference, signal_reference_node, "validity", map_builder);
+        for (auto const &position : signal.positions) {
+          map_builder.AddSignalPositionInertial(
+              signal.signal_id,
+              position.x, position.y, position.z,
+              position.hdg, position.pitch, position.roll);
         }
       }
+      for (auto const &signal_reference : road_signals.signal_references) {
+        log_debug("Road: ",
+            road_id,
+            "Added SignalReference ",
+            signal_reference.s_position,
+            signal_reference.t_position,
+            signal_reference.orientation);
+        carla::road::Road *road = map_builder.GetRoad(road_id);
+        auto signal_reference_info = map_builder.AddSignalReference(
+            road,
+            signal_reference.signal_id,
+            signal_reference.s_position,
+            signal_reference.t_position,
+            signal_reference.orientation);
+        AddValidity(signal_reference_info, signal_reference.validities, map_builder);
+      }
     }
   }
 } // namespace parser
@@ -0,0 +1,67 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/road/InformationSet.h"
+
+#include "carla/Debug.h"
+
+namespace carla {
+namespace road {
+
+  /// Visits every info once and appends it to the index of its kind.
+  class InformationSet::IndexBuilder final : public element::RoadInfoVisitor {
+  public:
+
+    explicit IndexBuilder(IndexTuple &indexes) : _indexes(indexes) {}
+
+    void Visit(element::RoadInfoCrosswalk &info) final { Add(info); }
+    void Visit(element::RoadInfoElevation &info) final { Add(info); }
+    void Visit(element::RoadInfoGeometry &info) final { Add(info); }
+    void Visit(element::RoadInfoLaneAccess &info) final { Add(info); }
+    void Visit(element::RoadInfoLaneBorder &info) final { Add(info); }
+    void Visit(element::RoadInfoLaneHeight &info) final { Add(info); }
+    void Visit(element::RoadInfoLaneMaterial &info) final { Add(info); }
+    void Visit(element::RoadInfoLaneOffset &info) final { Add(info); }
+    void Visit(element::RoadInfoLaneRule &info) final { Add(info); }
+    void Visit(element::RoadInfoLaneVisibility &info) final { Add(info); }
+    void Visit(element::RoadInfoLaneWidth &info) final { Add(info); }
+    void Visit(element::RoadInfoMarkRecord &info) final { Add(info); }
+    void Visit(element::RoadInfoMarkTypeLine &info) final { Add(info); }
+    void Visit(element::RoadInfoSignal &info) final { Add(info); }
+    void Visit(element::RoadInfoSpeed &info) final { Add(info); }
+
+    void SetCurrent(const element::RoadInfo &info) {
+      _distance = info.GetDistance();
+    }
+
+  private:
+
+    template <typename T>
+    void Add(T &info) {
+      auto &index = std::get<TypedIndex<T>>(_indexes);
+      index.keys.emplace_back(_distance);
+      index.values.emplace_back(&info);
+    }
+
+    IndexTuple &_indexes;
+
+    double _distance = 0.0;
+  };
+
+  InformationSet::InformationSet(std::vector<std::unique_ptr<element::RoadInfo>> &&vec)
+    : _road_set(std::move(vec)) {
+    // The set is already sorted by distance, and infos of the same kind keep
+    // their relative order, so every index comes out sorted too.
+    IndexBuilder builder(_indexes);
+    for (const auto &info : _road_set) {
+      DEBUG_ASSERT(info != nullptr);
+      builder.SetCurrent(*info);
+      info->AcceptVisitor(builder);
+    }
+  }
+
+} // road
+} // carla
@@ -9,64 +9,125 @@
 #include "carla/NonCopyable.h"
 #include "carla/road/RoadElementSet.h"
 #include "carla/road/element/RoadInfo.h"
-#include "carla/road/element/RoadInfoIterator.h"
+#include "carla/road/element/RoadInfoVisitor.h"
 
-#include <vector>
+#include <algorithm>
+#include <iterator>
+#include <limits>
 #include <memory>
+#include <tuple>
+#include <vector>
 
 namespace carla {
 namespace road {
 
+  /// Owns the infos of a road or a lane and keeps, for every kind of info, a
+  /// contiguous array of the infos of that kind sorted by distance. The
+  /// arrays are built once on construction, so the queries are a binary
+  /// search over the distances of a single kind, with no virtual calls.
   class InformationSet : private MovableNonCopyable {
   public:
 
     InformationSet() = default;
 
-    InformationSet(std::vector<std::unique_ptr<element::RoadInfo>> &&vec)
-      : _road_set(std::move(vec)) {}
+    InformationSet(std::vector<std::unique_ptr<element::RoadInfo>> &&vec);
+
+    /// Return all infos sorted by distance.
+    const std::vector<std::unique_ptr<element::RoadInfo>> &GetAll() const {
+      return _road_set.GetAll();
+    }
 
     /// Return all infos given a type from the start of the road
     template <typename T>
     std::vector<const T *> GetInfos() const {
-      std::vector<const T *> vec;
-      auto it = element::MakeRoadInfoIterator<T>(_road_set.GetAll());
-      for (; !it.IsAtEnd(); ++it) {
-        vec.emplace_back(&*it);
-      }
-      return vec;
+      return GetIndex<T>().values;
     }
 
     /// Returns single info given a type and a distance (s) from
     /// the start of the road
     template <typename T>
     const T *GetInfo(const double s) const {
-      auto it = element::MakeRoadInfoIterator<T>(_road_set.GetReverseSubset(s));
-      return it.IsAtEnd() ? nullptr : &*it;
+      const auto &index = GetIndex<T>();
+      const auto it = std::upper_bound(index.keys.begin(), index.keys.end(), s);
+      return it == index.keys.begin() ?
+          nullptr :
+          index.values[static_cast<size_t>(std::distance(index.keys.begin(), it)) - 1u];
+    }
+
+    /// Same as GetInfo(s), and also returns in [begin, end) the distances for
+    /// which GetInfo would return the same info, so that callers walking the
+    /// road can reuse it.
+    template <typename T>
+    const T *GetInfo(const double s, double &begin, double &end) const {
+      const auto &index = GetIndex<T>();
+      const auto it = std::upper_bound(index.keys.begin(), index.keys.end(), s);
+      end = it == index.keys.end() ? std::numeric_limits<double>::infinity() : *it;
+      if (it == index.keys.begin()) {
+        begin = -std::numeric_limits<double>::infinity();
+        return nullptr;
+      }
+      begin = *(it - 1);
+      return index.values[static_cast<size_t>(std::distance(index.keys.begin(), it)) - 1u];
     }
 
     /// Return all infos given a type in a given range of the road
     template <typename T>
     std::vector<const T *> GetInfos(const double min_s, const double max_s) const {
-      std::vector<const T *> vec;
+      const auto &index = GetIndex<T>();
+      const auto keys_begin = index.keys.begin();
+      const auto values_begin = index.values.begin();
       if(min_s < max_s) {
-        auto it = element::MakeRoadInfoIterator<T>(
-            _road_set.GetSubsetInRange(min_s, max_s)); //reverse
-        for (; !it.IsAtEnd(); ++it) {
-          vec.emplace_back(&*it);
-        }
+        const auto low_bound = std::lower_bound(keys_begin, index.keys.end(), min_s);
+        const auto up_bound = std::upper_bound(low_bound, index.keys.end(), max_s);
+        return std::vector<const T *>(
+            values_begin + std::distance(keys_begin, low_bound),
+            values_begin + std::distance(keys_begin, up_bound));
       } else {
-        auto it = element::MakeRoadInfoIterator<T>(
-            _road_set.GetReverseSubsetInRange(max_s, min_s)); //reverse
-        for (; !it.IsAtEnd(); ++it) {
-          vec.emplace_back(&*it);
-        }
+        const auto low_bound = std::lower_bound(keys_begin, index.keys.end(), max_s);
+        const auto up_bound = std::upper_bound(low_bound, index.keys.end(), min_s);
+        return std::vector<const T *>(
+            std::make_reverse_iterator(values_begin + std::distance(keys_begin, up_bound)),
+            std::make_reverse_iterator(values_begin + std::distance(keys_begin, low_bound)));
       }
-      return vec;
     }
 
   private:
 
+    /// Infos of a single kind, with their distances stored apart so the
+    /// binary search touches only contiguous doubles.
+    template <typename T>
+    struct TypedIndex {
+      std::vector<double> keys;
+      std::vector<const T *> values;
+    };
+
+    using IndexTuple = std::tuple<
+        TypedIndex<element::RoadInfoCrosswalk>,
+        TypedIndex<element::RoadInfoElevation>,
+        TypedIndex<element::RoadInfoGeometry>,
+        TypedIndex<element::RoadInfoLaneAccess>,
+        TypedIndex<element::RoadInfoLaneBorder>,
+        TypedIndex<element::RoadInfoLaneHeight>,
+        TypedIndex<element::RoadInfoLaneMaterial>,
+        TypedIndex<element::RoadInfoLaneOffset>,
+        TypedIndex<element::RoadInfoLaneRule>,
+        TypedIndex<element::RoadInfoLaneVisibility>,
+        TypedIndex<element::RoadInfoLaneWidth>,
+        TypedIndex<element::RoadInfoMarkRecord>,
+        TypedIndex<element::RoadInfoMarkTypeLine>,
+        TypedIndex<element::RoadInfoSignal>,
+        TypedIndex<element::RoadInfoSpeed>>;
+
+    class IndexBuilder;
+
+    template <typename T>
+    const TypedIndex<T> &GetIndex() const {
+      return std::get<TypedIndex<T>>(_indexes);
+    }
+
     RoadElementSet<std::unique_ptr<element::RoadInfo>> _road_set;
+
+    IndexTuple _indexes;
   };
 
 } // road
@@ -19,6 +19,7 @@ namespace carla {
 namespace road {
 
   class MapBuilder;
+  class PrecompiledMap;
 
   class Junction : private MovableNonCopyable {
   public:
@@ -89,6 +90,7 @@ namespace road {
   private:
 
     friend MapBuilder;
+    friend PrecompiledMap;
 
     JuncId _id;
 
@@ -6,9 +6,13 @@
 
 #include "carla/road/Lane.h"
 
+#include <algorithm>
+#include <cmath>
 #include <limits>
+#include <stdexcept>
 
 #include "carla/Debug.h"
+#include "carla/Exception.h"
 #include "carla/geom/Math.h"
 #include "carla/road/element/Geometry.h"
 #include "carla/road/element/RoadInfoElevation.h"
@@ -128,6 +132,37 @@ namespace road {
     return std::make_pair(dist, tangent);
   }
 
+  /// Number of distances Lane::ComputeTransforms evaluates at once.
+  static constexpr size_t COMPUTE_TRANSFORMS_BATCH_SIZE = 256u;
+
+  /// Turns a point on the center of the lane, still carrying the heading of
+  /// the road's reference line, into the lane's transform in Unreal's
+  /// coordinates
+  static geom::Transform ToLaneTransform(
+      element::DirectedPoint dp,
+      const float lane_tangent,
+      const LaneId lane_id) {
+    // Update the lane tangent with the road "laneOffset" at current s
+    dp.tangent -= lane_tangent;
+
+    // Unreal's Y axis hack
+    dp.location.y *= -1;
+    dp.tangent    *= -1;
+
+    geom::Rotation rot(
+        geom::Math::ToDegrees(static_cast<float>(dp.pitch)),
+        geom::Math::ToDegrees(static_cast<float>(dp.tangent)),
+        0.0f);
+
+    // Fix the direction of the possitive lanes
+    if (lane_id > 0) {
+      rot.yaw += 180.0f;
+      rot.pitch = 360.0f - rot.pitch;
+    }
+
+    return geom::Transform(dp.location, rot);
+  }
+
   geom::Transform Lane::ComputeTransform(const double s) const {
     const Road *road = GetRoad();
     DEBUG_ASSERT(road != nullptr);
@@ -182,25 +217,172 @@ namespace road {
     // Transform from the center of the road to the center of the lane
     dp.ApplyLateralOffset(lane_t_offset);
 
-    // Update the lane tangent with the road "laneOffset" at current s
-    dp.tangent -= lane_tangent;
+    return ToLaneTransform(dp, lane_tangent, GetId());
+  }
 
-    // Unreal's Y axis hack
-    dp.location.y *= -1;
-    dp.tangent    *= -1;
+  void Lane::ComputeTransforms(
+      const double *s_values,
+      const size_t count,
+      geom::Transform *out) const {
+    if (count == 0u) {
+      return;
+    }
+    const Road *road = GetRoad();
+    DEBUG_ASSERT(road != nullptr);
 
-    geom::Rotation rot(
-        geom::Math::ToDegrees(static_cast<float>(dp.pitch)),
-        geom::Math::ToDegrees(static_cast<float>(dp.tangent)),
-        0.0f);
+    const auto *lane_section = GetLaneSection();
+    DEBUG_ASSERT(lane_section != nullptr);
+    const std::map<LaneId, Lane> &lanes = lane_section->GetLanes();
 
-    // Fix the direction of the possitive lanes
-    if (GetId() > 0) {
-      rot.yaw += 180.0f;
-      rot.pitch = 360.0f - rot.pitch;
+    // check that lane_id exists on the current s
+    RELEASE_ASSERT(!lanes.empty());
+    RELEASE_ASSERT(GetId() >= lanes.begin()->first);
+    RELEASE_ASSERT(GetId() <= lanes.rbegin()->first);
+
+    // The lanes from lane 0 up to this one, in the order ComputeTotalLaneWidth
+    // accumulates their widths
+    std::vector<const Lane *> side_lanes;
+    if (GetId() < 0) {
+      for (auto it = std::make_reverse_iterator(lanes.lower_bound(0)); it != lanes.rend(); ++it) {
+        side_lanes.emplace_back(&it->second);
+        if (it->first == GetId()) {
+          break;
+        }
+      }
+    } else if (GetId() > 0) {
+      for (auto it = lanes.lower_bound(1); it != lanes.end(); ++it) {
+        side_lanes.emplace_back(&it->second);
+        if (it->first == GetId()) {
+          break;
+        }
+      }
     }
+    const double side = GetId() < 0 ? 1.0 : -1.0;
+
+    // Runs are processed in batches small enough for these buffers to stay
+    // in cache
+    const size_t buffer_size = std::min(count, COMPUTE_TRANSFORMS_BATCH_SIZE);
+    std::vector<double> width_value(buffer_size);
+    std::vector<double> width_tangent(buffer_size);
+    std::vector<double> lane_t_offset(buffer_size);
+    std::vector<double> lane_tangent(buffer_size);
+    std::vector<double> offset_value(buffer_size);
+    std::vector<double> offset_tangent(buffer_size);
+    std::vector<double> elevation_value(buffer_size);
+    std::vector<double> elevation_tangent(buffer_size);
+    std::vector<double> geometry_s(buffer_size);
+    std::vector<element::DirectedPoint> points(buffer_size);
+    const double road_length = road->GetLength();
+    float last_heading = std::numeric_limits<float>::quiet_NaN();
+    float normal_x = 0.0f;
+    float normal_y = 0.0f;
+
+    size_t first = 0u;
+    while (first < count) {
+      // Look up the records at the first s of the run, and extend the run
+      // while every record stays the same
+      const double run_s = s_values[first];
+      RELEASE_ASSERT(run_s <= road_length);
+      RELEASE_ASSERT(run_s >= 0.0);
+      double run_begin = -std::numeric_limits<double>::infinity();
+      double run_end = std::numeric_limits<double>::infinity();
+      double begin = 0.0;
+      double end = 0.0;
+      const auto narrow = [&]() {
+        run_begin = std::max(run_begin, begin);
+        run_end = std::min(run_end, end);
+      };
+
+      std::vector<const element::RoadInfoLaneWidth *> widths;
+      widths.reserve(side_lanes.size());
+      for (const auto *lane : side_lanes) {
+        widths.emplace_back(lane->GetInfo<element::RoadInfoLaneWidth>(run_s, begin, end));
+        RELEASE_ASSERT(widths.back() != nullptr);
+        narrow();
+      }
+      const auto *lane_offset = road->GetInfo<element::RoadInfoLaneOffset>(run_s, begin, end);
+      narrow();
+      const auto *geometry = road->GetInfo<element::RoadInfoGeometry>(run_s, begin, end);
+      DEBUG_ASSERT(geometry != nullptr);
+      narrow();
+      const auto *elevation = road->GetInfo<element::RoadInfoElevation>(run_s, begin, end);
+      if (elevation == nullptr) {
+        throw_exception(std::runtime_error("failed to find road elevation."));
+      }
+      narrow();
+
+      size_t last = first + 1u;
+      while (last < count &&
+             last - first < buffer_size &&
+             s_values[last] >= run_begin &&
+             s_values[last] < run_end) {
+        RELEASE_ASSERT(s_values[last] <= road_length);
+        RELEASE_ASSERT(s_values[last] >= 0.0);
+        ++last;
+      }
+      const size_t n = last - first;
+      const double *s = s_values + first;
+
+      // Lateral offset and heading of the lane, as in ComputeTotalLaneWidth
+      std::fill_n(lane_t_offset.begin(), n, 0.0);
+      std::fill_n(lane_tangent.begin(), n, 0.0);
+      for (size_t k = 0u; k < side_lanes.size(); ++k) {
+        widths[k]->GetPolynomial().Evaluate(s, width_value.data(), n);
+        widths[k]->GetPolynomial().Tangent(s, width_tangent.data(), n);
+        const double factor = side_lanes[k] == this ? side * 0.5 : side;
+        for (size_t i = 0u; i < n; ++i) {
+          lane_t_offset[i] += factor * width_value[i];
+          lane_tangent[i] += factor * width_tangent[i];
+        }
+      }
 
-    return geom::Transform(dp.location, rot);
+      // Road's "laneOffset"
+      if (lane_offset != nullptr) {
+        lane_offset->GetPolynomial().Evaluate(s, offset_value.data(), n);
+        lane_offset->GetPolynomial().Tangent(s, offset_tangent.data(), n);
+      } else {
+        std::fill_n(offset_value.begin(), n, 0.0);
+        std::fill_n(offset_tangent.begin(), n, 0.0);
+      }
+
+      elevation->GetPolynomial().Evaluate(s, elevation_value.data(), n);
+      elevation->GetPolynomial().Tangent(s, elevation_tangent.data(), n);
+
+      // Points on the road's reference line, as in Road::GetDirectedPointIn
+      for (size_t i = 0u; i < n; ++i) {
+        geometry_s[i] = s[i] - geometry->GetDistance();
+      }
+      geometry->GetGeometry().PosFromDists(geometry_s.data(), n, points.data());
+
+      for (size_t i = 0u; i < n; ++i) {
+        element::DirectedPoint &dp = points[i];
+        // Both lateral offsets below move the point along the same normal,
+        // which is also shared by consecutive points on a line, so it is
+        // only recomputed when the heading changes. Same operations as
+        // DirectedPoint::ApplyLateralOffset.
+        const float heading = static_cast<float>(dp.tangent);
+        if (heading != last_heading) {
+          last_heading = heading;
+          normal_x = std::sin(heading);
+          normal_y = -std::cos(heading);
+        }
+        // Unreal's Y axis hack (the minus on the offset)
+        const float offset = -static_cast<float>(offset_value[i]);
+        dp.location.x += offset * normal_x;
+        dp.location.y += offset * normal_y;
+        dp.location.z = static_cast<float>(elevation_value[i]);
+        dp.pitch = elevation_tangent[i];
+        // Transform from the center of the road to the center of the lane
+        const float t_offset = static_cast<float>(lane_t_offset[i]);
+        dp.location.x += t_offset * normal_x;
+        dp.location.y += t_offset * normal_y;
+        const float tangent =
+            static_cast<float>(lane_tangent[i]) - static_cast<float>(offset_tangent[i]);
+        out[first + i] = ToLaneTransform(dp, tangent, GetId());
+      }
+
+      first = last;
+    }
   }
 
   std::pair<geom::Vector3D, geom::Vector3D> Lane::GetCornerPositions(
@@ -20,6 +20,7 @@ namespace road {
 
   class LaneSection;
   class MapBuilder;
+  class PrecompiledMap;
   class Road;
 
   class Lane : private MovableNonCopyable {
@@ -81,6 +82,12 @@ namespace road {
       return _info.GetInfo<T>(s);
     }
 
+    template <typename T>
+    const T *GetInfo(const double s, double &begin, double &end) const {
+      DEBUG_ASSERT(_lane_section != nullptr);
+      return _info.GetInfo<T>(s, begin, end);
+    }
+
     template <typename T>
     std::vector<const T*> GetInfos() const {
       DEBUG_ASSERT(_lane_section != nullptr);
@@ -115,6 +122,12 @@ namespace road {
 
     geom::Transform ComputeTransform(const double s) const;
 
+    /// Computes the transforms of @a count distances of this lane, writing
+    /// them to @a out. Same results as ComputeTransform, but the road records
+    /// are looked up once per run of consecutive distances they cover, and
+    /// evaluated over the whole run at once.
+    void ComputeTransforms(const double *s_values, size_t count, geom::Transform *out) const;
+
     /// Computes the location of the edges given a s
     std::pair<geom::Vector3D, geom::Vector3D> GetCornerPositions(
       const double s, const float extra_width = 0.f) const;
@@ -122,6 +135,7 @@ namespace road {
   private:
 
     friend MapBuilder;
+    friend PrecompiledMap;
 
     LaneSection *_lane_section = nullptr;
 
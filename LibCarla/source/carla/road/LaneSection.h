@@ -20,6 +20,7 @@ namespace road {
 
   class Road;
   class MapBuilder;
+  class PrecompiledMap;
 
   class LaneSection : private MovableNonCopyable {
   public:
@@ -51,6 +52,7 @@ namespace road {
   private:
 
     friend MapBuilder;
+    friend PrecompiledMap;
 
     const SectionId _id = 0u;
 
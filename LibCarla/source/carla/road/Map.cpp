@@ -22,6 +22,8 @@
 
 #include "marchingcube/MeshReconstruction.h"
 
+#include <boost/container_hash/hash.hpp>
+
 #include <vector>
 #include <unordered_map>
 #include <stdexcept>
@@ -152,6 +154,27 @@ namespace road {
     }
   }
 
+  /// Identifies the lane of a waypoint without looking it up.
+  struct LaneKey {
+    RoadId road_id;
+    SectionId section_id;
+    LaneId lane_id;
+
+    bool operator==(const LaneKey &rhs) const {
+      return road_id == rhs.road_id && section_id == rhs.section_id && lane_id == rhs.lane_id;
+    }
+  };
+
+  struct LaneKeyHash {
+    size_t operator()(const LaneKey &key) const {
+      size_t seed = 0u;
+      boost::hash_combine(seed, key.road_id);
+      boost::hash_combine(seed, key.section_id);
+      boost::hash_combine(seed, key.lane_id);
+      return seed;
+    }
+  };
+
   /// Assumes road_id and section_id are valid.
   static bool IsLanePresent(const MapData &data, Waypoint waypoint) {
     const auto &section = data.GetRoad(waypoint.road_id).GetLaneSectionById(waypoint.section_id);
@@ -175,16 +198,48 @@ namespace road {
     if (query_result.size() == 0) {
       return boost::optional<Waypoint>{};
     }
+    return GetClosestWaypointOnSegment(pos, query_result.front());
+  }
 
-    Rtree::BSegment segment = query_result.front().first;
+  std::vector<boost::optional<Waypoint>> Map::GetClosestWaypointsOnRoad(
+      const std::vector<geom::Location> &positions,
+      int32_t lane_type) const {
+    // Reused by every batch of the same thread, so that per-frame queries do
+    // not allocate.
+    static thread_local std::vector<Rtree::BPoint> points;
+    static thread_local Rtree::NearestBatch batch;
+    points.clear();
+    for (const auto &pos : positions) {
+      points.emplace_back(pos.x, pos.y, pos.z);
+    }
+    _rtree.GetNearestNeighbourBatchWithFilter(points,
+        [&](Rtree::TreeElement const &element) {
+          const Lane &lane = GetLane(element.second.first);
+          return (lane_type & static_cast<int32_t>(lane.GetType())) > 0;
+        },
+        batch);
+
+    std::vector<boost::optional<Waypoint>> result(positions.size());
+    for (size_t i = 0u; i < positions.size(); ++i) {
+      if (batch.found[i] != 0u) {
+        result[i] = GetClosestWaypointOnSegment(positions[i], batch.elements[i]);
+      }
+    }
+    return result;
+  }
+
+  Waypoint Map::GetClosestWaypointOnSegment(
+      const geom::Location &pos,
+      const Rtree::TreeElement &element) const {
+    Rtree::BSegment segment = element.first;
     Rtree::BPoint s1 = segment.first;
     Rtree::BPoint s2 = segment.second;
     auto distance_to_segment = geom::Math::DistanceSegmentToPoint(pos,
         geom::Vector3D(s1.get<0>(), s1.get<1>(), s1.get<2>()),
         geom::Vector3D(s2.get<0>(), s2.get<1>(), s2.get<2>()));
 
-    Waypoint result_start = query_result.front().second.first;
-    Waypoint result_end = query_result.front().second.second;
+    Waypoint result_start = element.second.first;
+    Waypoint result_end = element.second.second;
 
     if (result_start.lane_id < 0) {
       double delta_s = distance_to_segment.first;
@@ -209,6 +264,16 @@ namespace road {
     }
   }
 
+  /// Whether @a pos lies within the lane of @a waypoint, the closest
+  /// waypoint on road to it.
+  static bool IsInsideLane(const Map &map, const Waypoint &waypoint, const geom::Location &pos) {
+    const auto dist = geom::Math::Distance2D(map.ComputeTransform(waypoint).location, pos);
+    const auto lane_width_info = map.GetLane(waypoint).GetInfo<RoadInfoLaneWidth>(waypoint.s);
+    const auto half_lane_width =
+        lane_width_info->GetPolynomial().Evaluate(waypoint.s) * 0.5;
+    return dist < half_lane_width;
+  }
+
   boost::optional<Waypoint> Map::GetWaypoint(
       const geom::Location &pos,
       int32_t lane_type) const {
@@ -218,18 +283,25 @@ namespace road {
       return w;
     }
 
-    const auto dist = geom::Math::Distance2D(ComputeTransform(*w).location, pos);
-    const auto lane_width_info = GetLane(*w).GetInfo<RoadInfoLaneWidth>(w->s);
-    const auto half_lane_width =
-        lane_width_info->GetPolynomial().Evaluate(w->s) * 0.5;
-
-    if (dist < half_lane_width) {
+    if (IsInsideLane(*this, *w, pos)) {
       return w;
     }
 
     return boost::optional<Waypoint>{};
   }
 
+  std::vector<boost::optional<Waypoint>> Map::GetWaypoints(
+      const std::vector<geom::Location> &positions,
+      int32_t lane_type) const {
+    auto result = GetClosestWaypointsOnRoad(positions, lane_type);
+    for (size_t i = 0u; i < positions.size(); ++i) {
+      if (result[i].has_value() && !IsInsideLane(*this, *result[i], positions[i])) {
+        result[i] = boost::none;
+      }
+    }
+    return result;
+  }
+
   boost::optional<Waypoint> Map::GetWaypoint(
       RoadId road_id,
       LaneId lane_id,
@@ -274,6 +346,87 @@ namespace road {
     return GetLane(waypoint).ComputeTransform(waypoint.s);
   }
 
+  std::vector<geom::Transform> Map::ComputeTransforms(
+      const std::vector<Waypoint> &waypoints) const {
+    // Group the waypoints by lane, keeping the order in which each lane first
+    // appears. Lanes are only looked up the first time they are seen.
+    std::unordered_map<LaneKey, size_t, LaneKeyHash> group_of_lane;
+    std::vector<std::pair<const Lane *, std::vector<size_t>>> groups;
+    LaneKey previous_key{0u, 0u, 0};
+    size_t group = 0u;
+    for (size_t i = 0u; i < waypoints.size(); ++i) {
+      const auto &waypoint = waypoints[i];
+      const LaneKey key{waypoint.road_id, waypoint.section_id, waypoint.lane_id};
+      if (i == 0u || !(key == previous_key)) {
+        const auto inserted = group_of_lane.emplace(key, groups.size());
+        if (inserted.second) {
+          groups.emplace_back(&GetLane(waypoint), std::vector<size_t>{});
+        }
+        group = inserted.first->second;
+        previous_key = key;
+      }
+      groups[group].second.emplace_back(i);
+    }
+
+    std::vector<geom::Transform> result(waypoints.size());
+    std::vector<double> s_values;
+    std::vector<geom::Transform> transforms;
+    for (const auto &group : groups) {
+      const auto &indices = group.second;
+      s_values.resize(indices.size());
+      transforms.resize(indices.size());
+      for (size_t i = 0u; i < indices.size(); ++i) {
+        s_values[i] = waypoints[indices[i]].s;
+      }
+      group.first->ComputeTransforms(s_values.data(), s_values.size(), transforms.data());
+      for (size_t i = 0u; i < indices.size(); ++i) {
+        result[indices[i]] = transforms[i];
+      }
+    }
+    return result;
+  }
+
+  std::vector<geom::Transform> Map::ComputeTransforms(
+      const RoadId road_id,
+      const LaneId lane_id,
+      const std::vector<double> &s_values) const {
+    if (!_data.ContainsRoad(road_id)) {
+      throw_exception(std::out_of_range("road " + std::to_string(road_id) + " not found"));
+    }
+    const Road &road = _data.GetRoad(road_id);
+    std::vector<geom::Transform> result(s_values.size());
+    // Consecutive distances in the same lane section are computed together
+    size_t first = 0u;
+    while (first < s_values.size()) {
+      const double s = s_values[first];
+      const Lane *lane = nullptr;
+      if (s >= 0.0 && s <= road.GetLength()) {
+        for (const auto &section : road.GetLaneSectionsAt(s)) {
+          lane = section.GetLane(lane_id);
+          if (lane != nullptr) {
+            break;
+          }
+        }
+      }
+      if (lane == nullptr) {
+        throw_exception(std::out_of_range(
+            "lane " + std::to_string(lane_id) + " of road " + std::to_string(road_id) +
+            " not found at s = " + std::to_string(s)));
+      }
+      const double section_begin = lane->GetDistance();
+      const double section_end = section_begin + lane->GetLength();
+      size_t last = first + 1u;
+      while (last < s_values.size() &&
+             s_values[last] > section_begin &&
+             s_values[last] < section_end) {
+        ++last;
+      }
+      lane->ComputeTransforms(s_values.data() + first, last - first, result.data() + first);
+      first = last;
+    }
+    return result;
+  }
+
   // ===========================================================================
   // -- Map: Road information --------------------------------------------------
   // ===========================================================================
@@ -846,7 +999,7 @@ namespace road {
       geom::Transform &current_transform,
       geom::Transform &next_transform,
       Waypoint &current_waypoint,
-      Waypoint &next_waypoint) {
+      Waypoint &next_waypoint) const {
     Rtree::BPoint init =
         Rtree::BPoint(
         current_transform.location.x,
@@ -866,7 +1019,7 @@ namespace road {
       std::vector<Rtree::TreeElement> &rtree_elements,
       geom::Transform &current_transform,
       Waypoint &current_waypoint,
-      Waypoint &next_waypoint) {
+      Waypoint &next_waypoint) const {
     geom::Transform next_transform = ComputeTransform(next_waypoint);
     AddElementToRtree(rtree_elements, current_transform, next_transform,
     current_waypoint, next_waypoint);
@@ -885,6 +1038,10 @@ namespace road {
   }
 
   void Map::CreateRtree() {
+    _rtree.Build(ComputeRtreeElements());
+  }
+
+  std::vector<Map::Rtree::TreeElement> Map::ComputeRtreeElements() const {
     const double epsilon = 0.000001; // small delta in the road (set to 1
                                      // micrometer to prevent numeric errors)
     const double min_delta_s = 1;    // segments of minimum 1m through the road
@@ -990,8 +1147,7 @@ namespace road {
         }
       }
     }
-    // Add segments to Rtree
-    _rtree.InsertElements(rtree_elements);
+    return rtree_elements;
   }
 
   Junction* Map::GetJunction(JuncId id) {
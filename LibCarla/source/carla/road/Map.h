@@ -55,10 +55,22 @@ namespace road {
         const geom::Location &location,
         int32_t lane_type = static_cast<int32_t>(Lane::LaneType::Driving)) const;
 
+    /// Same as GetClosestWaypointOnRoad for each of @a locations, with the
+    /// nearest segments of all of them found in a single batch query.
+    std::vector<boost::optional<element::Waypoint>> GetClosestWaypointsOnRoad(
+        const std::vector<geom::Location> &locations,
+        int32_t lane_type = static_cast<int32_t>(Lane::LaneType::Driving)) const;
+
     boost::optional<element::Waypoint> GetWaypoint(
         const geom::Location &location,
         int32_t lane_type = static_cast<int32_t>(Lane::LaneType::Driving)) const;
 
+    /// Same as GetWaypoint for each of @a locations, see
+    /// GetClosestWaypointsOnRoad.
+    std::vector<boost::optional<element::Waypoint>> GetWaypoints(
+        const std::vector<geom::Location> &locations,
+        int32_t lane_type = static_cast<int32_t>(Lane::LaneType::Driving)) const;
+
     boost::optional<element::Waypoint> GetWaypoint(
         RoadId road_id,
         LaneId lane_id,
@@ -66,6 +78,19 @@ namespace road {
 
     geom::Transform ComputeTransform(Waypoint waypoint) const;
 
+    /// Computes the transforms of many waypoints at once. Same results as
+    /// calling ComputeTransform on each of them, but the waypoints of each
+    /// lane are evaluated together with Lane::ComputeTransforms.
+    std::vector<geom::Transform> ComputeTransforms(const std::vector<Waypoint> &waypoints) const;
+
+    /// Computes the transforms of lane @a lane_id of road @a road_id at each
+    /// of the distances in @a s_values. Throws std::out_of_range if the road
+    /// does not exist or the lane does not exist at one of the distances.
+    std::vector<geom::Transform> ComputeTransforms(
+        RoadId road_id,
+        LaneId lane_id,
+        const std::vector<double> &s_values) const;
+
     /// ========================================================================
     /// -- Road information ----------------------------------------------------
     /// ========================================================================
@@ -204,26 +229,41 @@ namespace road {
 private:
 
     friend MapBuilder;
+    friend PrecompiledMap;
     MapData _data;
 
     using Rtree = geom::SegmentCloudRtree<Waypoint>;
     Rtree _rtree;
 
+    /// Restores a map with the Rtree segments computed when it was built.
+    Map(MapData m, const std::vector<Rtree::TreeElement> &rtree_elements)
+      : _data(std::move(m)) {
+      _rtree.Build(rtree_elements);
+    }
+
     void CreateRtree();
 
+    /// Projects @a location on the segment @a element of the Rtree.
+    Waypoint GetClosestWaypointOnSegment(
+        const geom::Location &location,
+        const Rtree::TreeElement &element) const;
+
+    /// Samples every lane into the segments of the Rtree.
+    std::vector<Rtree::TreeElement> ComputeRtreeElements() const;
+
     /// Helper Functions for constructing the rtree element list
     void AddElementToRtree(
         std::vector<Rtree::TreeElement> &rtree_elements,
         geom::Transform &current_transform,
         geom::Transform &next_transform,
         Waypoint &current_waypoint,
-        Waypoint &next_waypoint);
+        Waypoint &next_waypoint) const;
 
     void AddElementToRtreeAndUpdateTransforms(
         std::vector<Rtree::TreeElement> &rtree_elements,
         geom::Transform &current_transform,
         Waypoint &current_waypoint,
-        Waypoint &next_waypoint);
+        Waypoint &next_waypoint) const;
 
 public:
     inline float GetZPosInDeformation(float posx, float posy) const;
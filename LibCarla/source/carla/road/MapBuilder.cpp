@@ -5,6 +5,7 @@
 // For a copy, see <https://opensource.org/licenses/MIT>.
 
 #include "carla/StringUtil.h"
+#include "carla/ThreadPool.h"
 #include "carla/road/MapBuilder.h"
 #include "carla/road/element/RoadInfoElevation.h"
 #include "carla/road/element/RoadInfoGeometry.h"
@@ -22,6 +23,7 @@
 #include "carla/road/element/RoadInfoSignal.h"
 #include "carla/road/element/RoadInfoVisitor.h"
 #include "carla/road/element/RoadInfoCrosswalk.h"
+#include "carla/road/element/RoadInfoIterator.h"
 #include "carla/road/InformationSet.h"
 #include "carla/road/Signal.h"
 #include "carla/road/SignalType.h"
@@ -29,29 +31,51 @@
 #include <iterator>
 #include <memory>
 #include <algorithm>
+#include <vector>
 
 using namespace carla::road::element;
 
 namespace carla {
 namespace road {
 
+  /// Pointers to the elements of @a container, to split them across threads.
+  template <typename ContainerT>
+  static auto GetElementPointers(ContainerT &container) {
+    std::vector<decltype(&*container.begin())> result;
+    result.reserve(container.size());
+    for (auto &element : container) {
+      result.emplace_back(&element);
+    }
+    return result;
+  }
+
   boost::optional<Map> MapBuilder::Build() {
+    ThreadPool thread_pool;
+    return Build(thread_pool);
+  }
+
+  boost::optional<Map> MapBuilder::Build(ThreadPool &thread_pool) {
 
-    CreatePointersBetweenRoadSegments();
+    CreatePointersBetweenRoadSegments(thread_pool);
     RemoveZeroLaneValiditySignalReferences();
 
-    for (auto &&info : _temp_road_info_container) {
+    // each road and lane only sorts and indexes its own infos
+    const auto road_infos = GetElementPointers(_temp_road_info_container);
+    thread_pool.ParallelFor(road_infos.size(), [&](size_t index) {
+      auto &info = *road_infos[index];
       DEBUG_ASSERT(info.first != nullptr);
       info.first->_info = InformationSet(std::move(info.second));
-    }
+    });
 
-    for (auto &&info : _temp_lane_info_container) {
+    const auto lane_infos = GetElementPointers(_temp_lane_info_container);
+    thread_pool.ParallelFor(lane_infos.size(), [&](size_t index) {
+      auto &info = *lane_infos[index];
       DEBUG_ASSERT(info.first != nullptr);
       info.first->_info = InformationSet(std::move(info.second));
-    }
+    });
 
     // compute transform requires the roads to have the RoadInfo
-    SolveSignalReferencesAndTransforms();
+    SolveSignalReferencesAndTransforms(thread_pool);
 
     SolveControllerAndJuntionReferences();
 
@@ -63,9 +87,9 @@ namespace road {
     // you want to keep it (will return copy -> Map(const Map &))
     // or move it (will return move -> Map(Map &&))
     Map map(std::move(_map_data));
-    CreateJunctionBoundingBoxes(map);
-    ComputeJunctionRoadConflicts(map);
-    CheckSignalsOnRoads(map);
+    CreateJunctionBoundingBoxes(map, thread_pool);
+    ComputeJunctionRoadConflicts(map, thread_pool);
+    CheckSignalsOnRoads(map, thread_pool);
 
     return map;
   }
@@ -731,26 +755,35 @@ namespace road {
   }
 
   // assign pointers to the next lanes
-  void MapBuilder::CreatePointersBetweenRoadSegments(void) {
-    // process each lane to define its nexts
+  void MapBuilder::CreatePointersBetweenRoadSegments(ThreadPool &thread_pool) {
+    std::vector<Lane *> lanes;
     for (auto &road : _map_data._roads) {
       for (auto &section : road.second._lane_sections) {
         for (auto &lane : section.second._lanes) {
-
-          // assign the next lane pointers
-          lane.second._next_lanes = GetLaneNext(road.first, section.second._id, lane.first);
-
-          // add to each lane found, this as its predecessor
-          for (auto next_lane : lane.second._next_lanes) {
-            // add as previous
-            DEBUG_ASSERT(next_lane != nullptr);
-            next_lane->_prev_lanes.push_back(&lane.second);
-          }
-
+          lanes.emplace_back(&lane.second);
         }
       }
     }
 
+    // assign the next lane pointers, finding them only reads the roads and
+    // junctions
+    thread_pool.ParallelFor(lanes.size(), [&](size_t index) {
+      Lane &lane = *lanes[index];
+      lane._next_lanes = GetLaneNext(
+          lane.GetRoad()->GetId(),
+          lane.GetLaneSection()->GetId(),
+          lane.GetId());
+    });
+
+    // add to each lane found, this as its predecessor
+    for (auto *lane : lanes) {
+      for (auto next_lane : lane->_next_lanes) {
+        // add as previous
+        DEBUG_ASSERT(next_lane != nullptr);
+        next_lane->_prev_lanes.push_back(lane);
+      }
+    }
+
     // process each lane to define its nexts
     for (auto &road : _map_data._roads) {
       for (auto &section : road.second._lane_sections) {
@@ -797,16 +830,17 @@ namespace road {
     return transform;
   }
 
-  void MapBuilder::SolveSignalReferencesAndTransforms() {
+  void MapBuilder::SolveSignalReferencesAndTransforms(ThreadPool &thread_pool) {
     for(auto signal_reference : _temp_signal_reference_container){
       signal_reference->_signal =
           _temp_signal_container[signal_reference->_signal_id].get();
     }
 
-    for(auto& signal_pair : _temp_signal_container) {
-      auto& signal = signal_pair.second;
+    const auto signals = GetElementPointers(_temp_signal_container);
+    thread_pool.ParallelFor(signals.size(), [&](size_t index) {
+      auto& signal = signals[index]->second;
       if (signal->_using_inertial_position) {
-        continue;
+        return;
       }
       auto transform = ComputeSignalTransform(signal, _map_data);
       if (SignalType::IsTrafficLight(signal->GetType())) {
@@ -814,7 +848,7 @@ namespace road {
             geom::Location(transform.GetForwardVector()*0.25);
       }
       signal->_transform = transform;
-    }
+    });
 
     _map_data._signals = std::move(_temp_signal_container);
 
@@ -840,9 +874,11 @@ namespace road {
     }
   }
 
-  void MapBuilder::CreateJunctionBoundingBoxes(Map &map) {
-    for (auto &junctionpair : map._data.GetJunctions()) {
-      auto* junction = map.GetJunction(junctionpair.first);
+  void MapBuilder::CreateJunctionBoundingBoxes(Map &map, ThreadPool &thread_pool) {
+    // each junction only reads the map and writes its own bounding box
+    const auto junctions = GetElementPointers(map._data.GetJunctions());
+    thread_pool.ParallelFor(junctions.size(), [&](size_t index) {
+      auto* junction = &junctions[index]->second;
       auto waypoints = map.GetJunctionWaypoints(junction->GetId(), Lane::LaneType::Any);
       const int number_intervals = 10;
 
@@ -905,7 +941,7 @@ namespace road {
       carla::geom::Vector3D extent(0.5f * (maxx - minx), 0.5f * (maxy - miny), 0.5f * (maxz - minz));
 
       junction->_bounding_box = carla::geom::BoundingBox(location, extent);
-    }
+    });
   }
 
 void MapBuilder::CreateController(
@@ -936,11 +972,12 @@ void MapBuilder::CreateController(
     }
 }
 
-  void MapBuilder::ComputeJunctionRoadConflicts(Map &map) {
-    for (auto &junctionpair : map._data.GetJunctions()) {
-      auto& junction = junctionpair.second;
+  void MapBuilder::ComputeJunctionRoadConflicts(Map &map, ThreadPool &thread_pool) {
+    const auto junctions = GetElementPointers(map._data.GetJunctions());
+    thread_pool.ParallelFor(junctions.size(), [&](size_t index) {
+      auto& junction = junctions[index]->second;
       junction._road_conflicts = (map.ComputeJunctionConflicts(junction.GetId()));
-    }
+    });
   }
 
   void MapBuilder::GenerateDefaultValiditiesForSignalReferences() {
@@ -1041,9 +1078,11 @@ void MapBuilder::CreateController(
     }
   }
 
-  void MapBuilder::CheckSignalsOnRoads(Map &map) {
-    for (auto& signal_pair : map._data._signals) {
-      auto& signal = signal_pair.second;
+  void MapBuilder::CheckSignalsOnRoads(Map &map, ThreadPool &thread_pool) {
+    // each signal only queries the map and moves itself
+    const auto signals = GetElementPointers(map._data._signals);
+    thread_pool.ParallelFor(signals.size(), [&](size_t index) {
+      auto& signal = signals[index]->second;
       auto signal_position = signal->GetTransform().location;
       auto signal_rotation = signal->GetTransform().rotation;
       auto closest_waypoint_to_signal =
@@ -1054,7 +1093,7 @@ void MapBuilder::CreateController(
           signal->GetName().find("Stencil_STOP") != std::string::npos ||
           signal->GetName().find("STATIC") != std::string::npos ||
           signal->_using_inertial_position) {
-        continue;
+        return;
       }
       if(closest_waypoint_to_signal) {
         auto road_transform = map.ComputeTransform(closest_waypoint_to_signal.get());
@@ -1106,7 +1145,7 @@ void MapBuilder::CreateController(
           signal->_transform.rotation = signal_rotation;
         }
       }
-    }
+    });
   }
 
 } // namespace road
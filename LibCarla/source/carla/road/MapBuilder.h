@@ -15,6 +15,9 @@
 #include <map>
 
 namespace carla {
+
+  class ThreadPool;
+
 namespace road {
 
   class MapBuilder {
@@ -22,6 +25,10 @@ namespace road {
 
     boost::optional<Map> Build();
 
+    /// Same as Build(), but the steps that are independent per road, lane,
+    /// junction or signal are split across the threads of @a thread_pool.
+    boost::optional<Map> Build(ThreadPool &thread_pool);
+
     // called from road parser
     carla::road::Road *AddRoad(
         const RoadId road_id,
@@ -367,21 +374,21 @@ namespace road {
     MapData _map_data;
 
     /// Create the pointers between RoadSegments based on the ids.
-    void CreatePointersBetweenRoadSegments();
+    void CreatePointersBetweenRoadSegments(ThreadPool &thread_pool);
 
     /// Create the bounding boxes of each junction
-    void CreateJunctionBoundingBoxes(Map &map);
+    void CreateJunctionBoundingBoxes(Map &map, ThreadPool &thread_pool);
 
     geom::Transform ComputeSignalTransform(std::unique_ptr<Signal> &signal,  MapData &data);
 
     /// Solves the signal references in the road
-    void SolveSignalReferencesAndTransforms();
+    void SolveSignalReferencesAndTransforms(ThreadPool &thread_pool);
 
     /// Solve the references between Controllers and Juntions
     void SolveControllerAndJuntionReferences();
 
     /// Compute the conflicts of the roads (intersecting roads)
-    void ComputeJunctionRoadConflicts(Map &map);
+    void ComputeJunctionRoadConflicts(Map &map, ThreadPool &thread_pool);
 
     /// Generates a default validity field for signal references with missing validity record in OpenDRIVE
     void GenerateDefaultValiditiesForSignalReferences();
@@ -391,7 +398,7 @@ namespace road {
     void RemoveZeroLaneValiditySignalReferences();
 
     /// Checks signals overlapping driving lanes and emits a warning
-    void CheckSignalsOnRoads(Map &map);
+    void CheckSignalsOnRoads(Map &map, ThreadPool &thread_pool);
 
     /// Return the pointer to a lane object.
     Lane *GetEdgeLanePointer(RoadId road_id, bool from_start, LaneId lane_id);
@@ -25,6 +25,7 @@ namespace carla {
 namespace road {
 
   class Lane;
+  class PrecompiledMap;
 
   class MapData : private MovableNonCopyable {
   public:
@@ -86,6 +87,7 @@ namespace road {
   private:
 
     friend class MapBuilder;
+    friend PrecompiledMap;
 
     MapData() = default;
 
@@ -0,0 +1,1212 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/road/PrecompiledMap.h"
+
+#include "carla/Debug.h"
+#include "carla/Logging.h"
+#include "carla/ThreadPool.h"
+#include "carla/road/element/Geometry.h"
+#include "carla/road/element/RoadInfoCrosswalk.h"
+#include "carla/road/element/RoadInfoElevation.h"
+#include "carla/road/element/RoadInfoGeometry.h"
+#include "carla/road/element/RoadInfoLaneAccess.h"
+#include "carla/road/element/RoadInfoLaneBorder.h"
+#include "carla/road/element/RoadInfoLaneHeight.h"
+#include "carla/road/element/RoadInfoLaneMaterial.h"
+#include "carla/road/element/RoadInfoLaneOffset.h"
+#include "carla/road/element/RoadInfoLaneRule.h"
+#include "carla/road/element/RoadInfoLaneVisibility.h"
+#include "carla/road/element/RoadInfoLaneWidth.h"
+#include "carla/road/element/RoadInfoMarkRecord.h"
+#include "carla/road/element/RoadInfoMarkTypeLine.h"
+#include "carla/road/element/RoadInfoSignal.h"
+#include "carla/road/element/RoadInfoSpeed.h"
+#include "carla/road/element/RoadInfoVisitor.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <thread>
+#include <type_traits>
+
+namespace carla {
+namespace road {
+
+  using namespace precompiled_map;
+
+namespace {
+
+  /// FNV-1a applied to 64-bit words instead of bytes, fast enough to validate
+  /// the whole content on every load.
+  uint64_t Checksum(const uint8_t *data, size_t size) {
+    static constexpr uint64_t OFFSET_BASIS = 14695981039346656037ull;
+    static constexpr uint64_t PRIME = 1099511628211ull;
+    uint64_t hash = OFFSET_BASIS;
+    size_t i = 0u;
+    for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t)) {
+      uint64_t word;
+      std::memcpy(&word, data + i, sizeof(word));
+      hash ^= word;
+      hash *= PRIME;
+    }
+    for (; i < size; ++i) {
+      hash ^= data[i];
+      hash *= PRIME;
+    }
+    return hash;
+  }
+
+  /// Finalizer of MurmurHash3, every bit of the input affects every bit of
+  /// the result.
+  uint64_t Mix(uint64_t value) {
+    value ^= value >> 33u;
+    value *= 0xFF51AFD7ED558CCDull;
+    value ^= value >> 33u;
+    value *= 0xC4CEB9FE1A85EC53ull;
+    value ^= value >> 33u;
+    return value;
+  }
+
+  /// Tags the kind of every road info in the stream.
+  enum class InfoType : uint8_t {
+    Crosswalk,
+    Elevation,
+    Geometry,
+    LaneAccess,
+    LaneBorder,
+    LaneHeight,
+    LaneMaterial,
+    LaneOffset,
+    LaneRule,
+    LaneVisibility,
+    LaneWidth,
+    MarkRecord,
+    MarkTypeLine,
+    Signal,
+    Speed
+  };
+
+  class Writer {
+  public:
+
+    explicit Writer(std::vector<uint8_t> &buffer) : _buffer(buffer) {}
+
+    template <typename T>
+    void Write(const T &value) {
+      static_assert(std::is_trivially_copyable<T>::value, "Type cannot be written as raw bytes");
+      const auto *bytes = reinterpret_cast<const uint8_t *>(&value);
+      _buffer.insert(_buffer.end(), bytes, bytes + sizeof(T));
+    }
+
+    void Write(bool value) {
+      Write<uint8_t>(value ? 1u : 0u);
+    }
+
+    void Write(const std::string &value) {
+      WriteSize(value.size());
+      _buffer.insert(_buffer.end(), value.begin(), value.end());
+    }
+
+    void WriteSize(size_t size) {
+      Write(static_cast<uint32_t>(size));
+    }
+
+  private:
+
+    std::vector<uint8_t> &_buffer;
+  };
+
+  /// Reads the values written by Writer. Reading past the end marks the
+  /// reader as invalid and returns default values from then on, so that
+  /// callers check once at the end instead of after every read.
+  class Reader {
+  public:
+
+    Reader(const uint8_t *begin, const uint8_t *end) : _position(begin), _end(end) {}
+
+    template <typename T>
+    T Read() {
+      static_assert(std::is_trivially_copyable<T>::value, "Type cannot be read as raw bytes");
+      T value{};
+      if (Require(sizeof(T))) {
+        std::memcpy(&value, _position, sizeof(T));
+        _position += sizeof(T);
+      }
+      return value;
+    }
+
+    bool ReadBool() {
+      return Read<uint8_t>() != 0u;
+    }
+
+    std::string ReadString() {
+      const size_t size = ReadSize();
+      std::string value(reinterpret_cast<const char *>(_position), size);
+      _position += size;
+      return value;
+    }
+
+    /// Size of a string or a collection. Every element takes at least a
+    /// byte, so larger sizes can only come from broken content.
+    size_t ReadSize() {
+      const size_t size = Read<uint32_t>();
+      return Require(size) ? size : 0u;
+    }
+
+    void Invalidate() {
+      _is_valid = false;
+    }
+
+    bool IsValid() const {
+      return _is_valid;
+    }
+
+    bool AtEnd() const {
+      return _position == _end;
+    }
+
+  private:
+
+    bool Require(size_t size) {
+      if (_is_valid && static_cast<size_t>(_end - _position) < size) {
+        _is_valid = false;
+      }
+      return _is_valid;
+    }
+
+    const uint8_t *_position;
+
+    const uint8_t *_end;
+
+    bool _is_valid = true;
+  };
+
+} // namespace
+
+  // ===========================================================================
+  // -- PrecompiledMap::Encoder ------------------------------------------------
+  // ===========================================================================
+
+  /// Writes the map data and the road blocks. Road infos are written through
+  /// the visitor, each one preceded by its InfoType.
+  class PrecompiledMap::Encoder final : public element::RoadInfoVisitor {
+  public:
+
+    explicit Encoder(std::vector<uint8_t> &buffer) : _out(buffer) {}
+
+    void WriteMapData(const MapData &data) {
+      _out.Write(data._geo_reference);
+
+      _out.WriteSize(data._signals.size());
+      for (const auto &pair : data._signals) {
+        _out.Write(pair.first);
+        // Signal references to missing signals leave empty entries behind.
+        _out.Write(pair.second != nullptr);
+        if (pair.second != nullptr) {
+          WriteSignal(*pair.second);
+        }
+      }
+
+      _out.WriteSize(data._controllers.size());
+      for (const auto &pair : data._controllers) {
+        DEBUG_ASSERT(pair.second != nullptr);
+        const Controller &controller = *pair.second;
+        _out.Write(pair.first);
+        _out.Write(controller._id);
+        _out.Write(controller._name);
+        _out.Write(controller._sequence);
+        WriteSet(controller._junctions);
+        WriteSet(controller._signals);
+      }
+
+      _out.WriteSize(data._junctions.size());
+      for (const auto &pair : data._junctions) {
+        WriteJunction(pair.second);
+      }
+    }
+
+    void WriteRoad(const Road &road) {
+      _out.Write(road._id);
+      _out.Write(road._name);
+      _out.Write(road._length);
+      _out.Write(road._is_junction);
+      _out.Write(road._junction_id);
+      _out.Write(road._successor);
+      _out.Write(road._predecessor);
+      WriteRoadIds(road._nexts);
+      WriteRoadIds(road._prevs);
+      WriteInfos(road._info);
+
+      _out.WriteSize(static_cast<size_t>(std::distance(road._lane_sections.begin(), road._lane_sections.end())));
+      for (const auto &section_pair : road._lane_sections) {
+        const LaneSection &section = section_pair.second;
+        _out.Write(section._id);
+        _out.Write(section._s);
+        _out.Write(section._lane_offset);
+        _out.WriteSize(section._lanes.size());
+        for (const auto &lane_pair : section._lanes) {
+          const Lane &lane = lane_pair.second;
+          _out.Write(lane._id);
+          _out.Write(lane._type);
+          _out.Write(lane._level);
+          _out.Write(lane._successor);
+          _out.Write(lane._predecessor);
+          WriteInfos(lane._info);
+          WriteLaneIds(lane._next_lanes);
+          WriteLaneIds(lane._prev_lanes);
+        }
+      }
+    }
+
+    void Visit(element::RoadInfoCrosswalk &info) final {
+      _out.Write(InfoType::Crosswalk);
+      _out.Write(info.GetDistance());
+      _out.Write(info.GetName());
+      _out.Write(info.GetT());
+      _out.Write(info.GetZOffset());
+      _out.Write(info.GetHeading());
+      _out.Write(info.GetPitch());
+      _out.Write(info.GetRoll());
+      _out.Write(info.GetOrientation());
+      _out.Write(info.GetWidth());
+      _out.Write(info.GetLength());
+      _out.WriteSize(info.GetPoints().size());
+      for (const auto &point : info.GetPoints()) {
+        _out.Write(point.u);
+        _out.Write(point.v);
+        _out.Write(point.z);
+      }
+    }
+
+    void Visit(element::RoadInfoElevation &info) final {
+      _out.Write(InfoType::Elevation);
+      _out.Write(info.GetDistance());
+      _out.Write(info.GetPolynomial());
+    }
+
+    void Visit(element::RoadInfoGeometry &info) final {
+      _out.Write(InfoType::Geometry);
+      _out.Write(info.GetDistance());
+      const element::Geometry &geometry = info.GetGeometry();
+      _out.Write(geometry.GetType());
+      _out.Write(geometry.GetStartOffset());
+      _out.Write(geometry.GetLength());
+      _out.Write(geometry.GetHeading());
+      _out.Write(geometry.GetStartPosition());
+      switch (geometry.GetType()) {
+        case element::GeometryType::LINE:
+          break;
+        case element::GeometryType::ARC: {
+          const auto &arc = static_cast<const element::GeometryArc &>(geometry);
+          _out.Write(arc.GetCurvature());
+          break;
+        }
+        case element::GeometryType::SPIRAL: {
+          const auto &spiral = static_cast<const element::GeometrySpiral &>(geometry);
+          _out.Write(spiral.GetCurveStart());
+          _out.Write(spiral.GetCurveEnd());
+          break;
+        }
+        case element::GeometryType::POLY3: {
+          const auto &poly3 = static_cast<const element::GeometryPoly3 &>(geometry);
+          _out.Write(poly3.Geta());
+          _out.Write(poly3.Getb());
+          _out.Write(poly3.Getc());
+          _out.Write(poly3.Getd());
+          break;
+        }
+        case element::GeometryType::POLY3PARAM: {
+          const auto &param_poly3 = static_cast<const element::GeometryParamPoly3 &>(geometry);
+          _out.Write(param_poly3.GetaU());
+          _out.Write(param_poly3.GetbU());
+          _out.Write(param_poly3.GetcU());
+          _out.Write(param_poly3.GetdU());
+          _out.Write(param_poly3.GetaV());
+          _out.Write(param_poly3.GetbV());
+          _out.Write(param_poly3.GetcV());
+          _out.Write(param_poly3.GetdV());
+          _out.Write(param_poly3.IsArcLength());
+          break;
+        }
+      }
+    }
+
+    void Visit(element::RoadInfoLaneAccess &info) final {
+      _out.Write(InfoType::LaneAccess);
+      _out.Write(info.GetDistance());
+      _out.Write(info.GetRestriction());
+    }
+
+    void Visit(element::RoadInfoLaneBorder &info) final {
+      _out.Write(InfoType::LaneBorder);
+      _out.Write(info.GetDistance());
+      _out.Write(info.GetPolynomial());
+    }
+
+    void Visit(element::RoadInfoLaneHeight &info) final {
+      _out.Write(InfoType::LaneHeight);
+      _out.Write(info.GetDistance());
+      _out.Write(info.GetInner());
+      _out.Write(info.GetOuter());
+    }
+
+    void Visit(element::RoadInfoLaneMaterial &info) final {
+      _out.Write(InfoType::LaneMaterial);
+      _out.Write(info.GetDistance());
+      _out.Write(info.GetSurface());
+      _out.Write(info.GetFriction());
+      _out.Write(info.GetRoughness());
+    }
+
+    void Visit(element::RoadInfoLaneOffset &info) final {
+      _out.Write(InfoType::LaneOffset);
+      _out.Write(info.GetDistance());
+      _out.Write(info.GetPolynomial());
+    }
+
+    void Visit(element::RoadInfoLaneRule &info) final {
+      _out.Write(InfoType::LaneRule);
+      _out.Write(info.GetDistance());
+      _out.Write(info.GetValue());
+    }
+
+    void Visit(element::RoadInfoLaneVisibility &info) final {
+      _out.Write(InfoType::LaneVisibility);
+      _out.Write(info.GetDistance());
+      _out.Write(info.GetForward());
+      _out.Write(info.GetBack());
+      _out.Write(info.GetLeft());
+      _out.Write(info.GetRight());
+    }
+
+    void Visit(element::RoadInfoLaneWidth &info) final {
+      _out.Write(InfoType::LaneWidth);
+      _out.Write(info.GetDistance());
+      _out.Write(info.GetPolynomial());
+    }
+
+    void Visit(element::RoadInfoMarkRecord &info) final {
+      _out.Write(InfoType::MarkRecord);
+      _out.Write(info.GetDistance());
+      _out.Write(info.GetRoadMarkId());
+      _out.Write(info.GetType());
+      _out.Write(info.GetWeight());
+      _out.Write(info.GetColor());
+      _out.Write(info.GetMaterial());
+      _out.Write(info.GetWidth());
+      _out.Write(info.GetLaneChange());
+      _out.Write(info.GetHeight());
+      _out.Write(info.GetTypeName());
+      _out.Write(info.GetTypeWidth());
+      _out.WriteSize(info.GetLines().size());
+      for (const auto &line : info.GetLines()) {
+        DEBUG_ASSERT(line != nullptr);
+        WriteMarkTypeLine(*line);
+      }
+    }
+
+    void Visit(element::RoadInfoMarkTypeLine &info) final {
+      _out.Write(InfoType::MarkTypeLine);
+      WriteMarkTypeLine(info);
+    }
+
+    void Visit(element::RoadInfoSignal &info) final {
+      _out.Write(InfoType::Signal);
+      _out.Write(info.GetDistance());
+      _out.Write(info._signal_id);
+      _out.Write(info._road_id);
+      _out.Write(info._t);
+      _out.Write(info._orientation);
+      _out.WriteSize(info._validities.size());
+      for (const auto &validity : info._validities) {
+        _out.Write(validity._from_lane);
+        _out.Write(validity._to_lane);
+      }
+    }
+
+    void Visit(element::RoadInfoSpeed &info) final {
+      _out.Write(InfoType::Speed);
+      _out.Write(info.GetDistance());
+      _out.Write(info.GetSpeed());
+      _out.Write(info.GetType());
+    }
+
+  private:
+
+    void WriteSignal(const Signal &signal) {
+      _out.Write(signal._road_id);
+      _out.Write(signal._signal_id);
+      _out.Write(signal._s);
+      _out.Write(signal._t);
+      _out.Write(signal._name);
+      _out.Write(signal._dynamic);
+      _out.Write(signal._orientation);
+      _out.Write(signal._zOffset);
+      _out.Write(signal._country);
+      _out.Write(signal._type);
+      _out.Write(signal._subtype);
+      _out.Write(signal._value);
+      _out.Write(signal._unit);
+      _out.Write(signal._height);
+      _out.Write(signal._width);
+      _out.Write(signal._text);
+      _out.Write(signal._hOffset);
+      _out.Write(signal._pitch);
+      _out.Write(signal._roll);
+      _out.WriteSize(signal._dependencies.size());
+      for (const auto &dependency : signal._dependencies) {
+        _out.Write(dependency._dependency_id);
+        _out.Write(dependency._type);
+      }
+      _out.Write(signal._transform);
+      WriteSet(signal._controllers);
+      _out.Write(signal._using_inertial_position);
+    }
+
+    void WriteJunction(const Junction &junction) {
+      _out.Write(junction._id);
+      _out.Write(junction._name);
+      _out.WriteSize(junction._connections.size());
+      for (const auto &pair : junction._connections) {
+        const Junction::Connection &connection = pair.second;
+        _out.Write(connection.id);
+        _out.Write(connection.incoming_road);
+        _out.Write(connection.connecting_road);
+        _out.WriteSize(connection.lane_links.size());
+        for (const auto &lane_link : connection.lane_links) {
+          _out.Write(lane_link.from);
+          _out.Write(lane_link.to);
+        }
+      }
+      WriteSet(junction._controllers);
+      _out.WriteSize(junction._road_conflicts.size());
+      for (const auto &pair : junction._road_conflicts) {
+        _out.Write(pair.first);
+        WriteSet(pair.second);
+      }
+      _out.Write(junction._bounding_box);
+    }
+
+    void WriteMarkTypeLine(const element::RoadInfoMarkTypeLine &line) {
+      _out.Write(line.GetDistance());
+      _out.Write(line.GetRoadMarkId());
+      _out.Write(line.GetLength());
+      _out.Write(line.GetSpace());
+      _out.Write(line.GetTOffset());
+      _out.Write(line.GetRule());
+      _out.Write(line.GetWidth());
+    }
+
+    void WriteInfos(const InformationSet &infos) {
+      _out.WriteSize(infos.GetAll().size());
+      for (const auto &info : infos.GetAll()) {
+        DEBUG_ASSERT(info != nullptr);
+        info->AcceptVisitor(*this);
+      }
+    }
+
+    void WriteRoadIds(const std::vector<Road *> &roads) {
+      _out.WriteSize(roads.size());
+      for (const auto *road : roads) {
+        DEBUG_ASSERT(road != nullptr);
+        _out.Write(road->_id);
+      }
+    }
+
+    /// Lanes are identified by road, lane section and lane ids.
+    void WriteLaneIds(const std::vector<Lane *> &lanes) {
+      _out.WriteSize(lanes.size());
+      for (const auto *lane : lanes) {
+        DEBUG_ASSERT(lane != nullptr);
+        _out.Write(lane->GetRoad()->_id);
+        _out.Write(lane->GetLaneSection()->_id);
+        _out.Write(lane->_id);
+      }
+    }
+
+    template <typename SetT>
+    void WriteSet(const SetT &values) {
+      _out.WriteSize(values.size());
+      for (const auto &value : values) {
+        _out.Write(value);
+      }
+    }
+
+    Writer _out;
+  };
+
+  // ===========================================================================
+  // -- PrecompiledMap::Decoder ------------------------------------------------
+  // ===========================================================================
+
+  /// Reads what the Encoder writes. Roads are decoded in place, and their
+  /// links to other roads and lanes are returned to be resolved once every
+  /// road exists.
+  class PrecompiledMap::Decoder {
+  public:
+
+    struct LaneKey {
+      RoadId road_id;
+      SectionId section_id;
+      LaneId lane_id;
+    };
+
+    struct LaneLinks {
+      Lane *lane;
+      std::vector<LaneKey> next_lanes;
+      std::vector<LaneKey> prev_lanes;
+    };
+
+    struct RoadLinks {
+      std::vector<RoadId> nexts;
+      std::vector<RoadId> prevs;
+      std::vector<LaneLinks> lanes;
+    };
+
+    Decoder(const uint8_t *begin, const uint8_t *end) : _in(begin, end) {}
+
+    /// Whether everything was read and nothing was left.
+    bool IsValid() const {
+      return _in.IsValid() && _in.AtEnd();
+    }
+
+    void ReadMapData(MapData &data) {
+      data._geo_reference = _in.Read<geom::GeoLocation>();
+
+      const size_t signal_count = _in.ReadSize();
+      for (size_t i = 0u; i < signal_count; ++i) {
+        SignId signal_id = _in.ReadString();
+        std::unique_ptr<Signal> signal;
+        if (_in.ReadBool()) {
+          signal = ReadSignal();
+        }
+        data._signals.emplace(std::move(signal_id), std::move(signal));
+      }
+
+      const size_t controller_count = _in.ReadSize();
+      for (size_t i = 0u; i < controller_count; ++i) {
+        ContId key = _in.ReadString();
+        ContId controller_id = _in.ReadString();
+        std::string name = _in.ReadString();
+        const auto sequence = _in.Read<uint32_t>();
+        auto controller = std::make_unique<Controller>(std::move(controller_id), std::move(name), sequence);
+        ReadSet(controller->_junctions);
+        ReadSet(controller->_signals);
+        data._controllers.emplace(std::move(key), std::move(controller));
+      }
+
+      const size_t junction_count = _in.ReadSize();
+      for (size_t i = 0u; i < junction_count; ++i) {
+        const auto junction_id = _in.Read<JuncId>();
+        std::string name = _in.ReadString();
+        Junction &junction = data._junctions.emplace(junction_id, Junction(junction_id, std::move(name))).first->second;
+        ReadJunction(junction);
+      }
+    }
+
+    RoadLinks ReadRoad(const MapData &data, Road &road) {
+      RoadLinks links;
+      road._map_data = const_cast<MapData *>(&data);
+      road._id = _in.Read<RoadId>();
+      road._name = _in.ReadString();
+      road._length = _in.Read<double>();
+      road._is_junction = _in.ReadBool();
+      road._junction_id = _in.Read<JuncId>();
+      road._successor = _in.Read<RoadId>();
+      road._predecessor = _in.Read<RoadId>();
+      links.nexts = ReadRoadIds();
+      links.prevs = ReadRoadIds();
+      road._info = InformationSet(ReadInfos(data));
+
+      const size_t section_count = _in.ReadSize();
+      for (size_t i = 0u; i < section_count; ++i) {
+        const auto section_id = _in.Read<SectionId>();
+        const auto s = _in.Read<double>();
+        LaneSection &section = road._lane_sections.Emplace(section_id, s);
+        section._road = &road;
+        section._lane_offset = _in.Read<geom::CubicPolynomial>();
+
+        const size_t lane_count = _in.ReadSize();
+        for (size_t j = 0u; j < lane_count; ++j) {
+          const auto lane_id = _in.Read<LaneId>();
+          const auto type = _in.Read<Lane::LaneType>();
+          const bool level = _in.ReadBool();
+          const auto successor = _in.Read<LaneId>();
+          const auto predecessor = _in.Read<LaneId>();
+          auto infos = ReadInfos(data);
+          Lane &lane = section._lanes.emplace(lane_id, Lane(&section, lane_id, std::move(infos))).first->second;
+          lane._type = type;
+          lane._level = level;
+          lane._successor = successor;
+          lane._predecessor = predecessor;
+          LaneLinks lane_links;
+          lane_links.lane = &lane;
+          lane_links.next_lanes = ReadLaneKeys();
+          lane_links.prev_lanes = ReadLaneKeys();
+          links.lanes.emplace_back(std::move(lane_links));
+        }
+      }
+      return links;
+    }
+
+    /// Resolves the links of @a road. Returns false if any of the roads or
+    /// lanes linked does not exist.
+    static bool Link(MapData &data, Road &road, const RoadLinks &links) {
+      return
+          LinkRoads(data, links.nexts, road._nexts) &&
+          LinkRoads(data, links.prevs, road._prevs) &&
+          std::all_of(links.lanes.begin(), links.lanes.end(), [&](const LaneLinks &lane_links) {
+            return
+                LinkLanes(data, lane_links.next_lanes, lane_links.lane->_next_lanes) &&
+                LinkLanes(data, lane_links.prev_lanes, lane_links.lane->_prev_lanes);
+          });
+    }
+
+  private:
+
+    std::unique_ptr<Signal> ReadSignal() {
+      const auto road_id = _in.Read<RoadId>();
+      SignId signal_id = _in.ReadString();
+      const auto s = _in.Read<double>();
+      const auto t = _in.Read<double>();
+      std::string name = _in.ReadString();
+      std::string dynamic = _in.ReadString();
+      std::string orientation = _in.ReadString();
+      const auto z_offset = _in.Read<double>();
+      std::string country = _in.ReadString();
+      std::string type = _in.ReadString();
+      std::string subtype = _in.ReadString();
+      const auto value = _in.Read<double>();
+      std::string unit = _in.ReadString();
+      const auto height = _in.Read<double>();
+      const auto width = _in.Read<double>();
+      std::string text = _in.ReadString();
+      const auto h_offset = _in.Read<double>();
+      const auto pitch = _in.Read<double>();
+      const auto roll = _in.Read<double>();
+      auto signal = std::make_unique<Signal>(
+          road_id, std::move(signal_id), s, t, std::move(name), std::move(dynamic),
+          std::move(orientation), z_offset, std::move(country), std::move(type),
+          std::move(subtype), value, std::move(unit), height, width, std::move(text),
+          h_offset, pitch, roll);
+      const size_t dependency_count = _in.ReadSize();
+      for (size_t i = 0u; i < dependency_count; ++i) {
+        std::string dependency_id = _in.ReadString();
+        std::string dependency_type = _in.ReadString();
+        signal->_dependencies.emplace_back(std::move(dependency_id), std::move(dependency_type));
+      }
+      signal->_transform = _in.Read<geom::Transform>();
+      ReadSet(signal->_controllers);
+      signal->_using_inertial_position = _in.ReadBool();
+      return signal;
+    }
+
+    void ReadJunction(Junction &junction) {
+      const size_t connection_count = _in.ReadSize();
+      for (size_t i = 0u; i < connection_count; ++i) {
+        const auto connection_id = _in.Read<ConId>();
+        const auto incoming_road = _in.Read<RoadId>();
+        const auto connecting_road = _in.Read<RoadId>();
+        Junction::Connection &connection = junction._connections.emplace(
+            connection_id,
+            Junction::Connection(connection_id, incoming_road, connecting_road)).first->second;
+        const size_t lane_link_count = _in.ReadSize();
+        for (size_t j = 0u; j < lane_link_count; ++j) {
+          const auto from = _in.Read<LaneId>();
+          const auto to = _in.Read<LaneId>();
+          connection.AddLaneLink(from, to);
+        }
+      }
+      ReadSet(junction._controllers);
+      const size_t conflict_count = _in.ReadSize();
+      for (size_t i = 0u; i < conflict_count; ++i) {
+        const auto road_id = _in.Read<RoadId>();
+        ReadSet(junction._road_conflicts[road_id]);
+      }
+      junction._bounding_box = _in.Read<geom::BoundingBox>();
+    }
+
+    std::unique_ptr<element::RoadInfo> ReadInfo(const MapData &data) {
+      const auto type = _in.Read<InfoType>();
+      const auto s = _in.Read<double>();
+      switch (type) {
+        case InfoType::Crosswalk: {
+          std::string name = _in.ReadString();
+          const auto t = _in.Read<double>();
+          const auto z_offset = _in.Read<double>();
+          const auto heading = _in.Read<double>();
+          const auto pitch = _in.Read<double>();
+          const auto roll = _in.Read<double>();
+          std::string orientation = _in.ReadString();
+          const auto width = _in.Read<double>();
+          const auto length = _in.Read<double>();
+          std::vector<element::CrosswalkPoint> points;
+          const size_t point_count = _in.ReadSize();
+          for (size_t i = 0u; i < point_count; ++i) {
+            const auto u = _in.Read<double>();
+            const auto v = _in.Read<double>();
+            const auto z = _in.Read<double>();
+            points.emplace_back(u, v, z);
+          }
+          return std::make_unique<element::RoadInfoCrosswalk>(
+              s, std::move(name), t, z_offset, heading, pitch, roll,
+              std::move(orientation), width, length, std::move(points));
+        }
+        case InfoType::Elevation:
+          return std::make_unique<element::RoadInfoElevation>(s, _in.Read<geom::CubicPolynomial>());
+        case InfoType::Geometry: {
+          auto geometry = ReadGeometry();
+          if (geometry == nullptr) {
+            return nullptr;
+          }
+          return std::make_unique<element::RoadInfoGeometry>(s, std::move(geometry));
+        }
+        case InfoType::LaneAccess:
+          return std::make_unique<element::RoadInfoLaneAccess>(s, _in.ReadString());
+        case InfoType::LaneBorder:
+          return std::make_unique<element::RoadInfoLaneBorder>(s, _in.Read<geom::CubicPolynomial>());
+        case InfoType::LaneHeight: {
+          const auto inner = _in.Read<double>();
+          const auto outer = _in.Read<double>();
+          return std::make_unique<element::RoadInfoLaneHeight>(s, inner, outer);
+        }
+        case InfoType::LaneMaterial: {
+          std::string surface = _in.ReadString();
+          const auto friction = _in.Read<double>();
+          const auto roughness = _in.Read<double>();
+          return std::make_unique<element::RoadInfoLaneMaterial>(s, std::move(surface), friction, roughness);
+        }
+        case InfoType::LaneOffset:
+          return std::make_unique<element::RoadInfoLaneOffset>(s, _in.Read<geom::CubicPolynomial>());
+        case InfoType::LaneRule:
+          return std::make_unique<element::RoadInfoLaneRule>(s, _in.ReadString());
+        case InfoType::LaneVisibility: {
+          const auto forward = _in.Read<double>();
+          const auto back = _in.Read<double>();
+          const auto left = _in.Read<double>();
+          const auto right = _in.Read<double>();
+          return std::make_unique<element::RoadInfoLaneVisibility>(s, forward, back, left, right);
+        }
+        case InfoType::LaneWidth:
+          return std::make_unique<element::RoadInfoLaneWidth>(s, _in.Read<geom::CubicPolynomial>());
+        case InfoType::MarkRecord: {
+          const auto road_mark_id = _in.Read<int>();
+          std::string mark_type = _in.ReadString();
+          std::string weight = _in.ReadString();
+          std::string color = _in.ReadString();
+          std::string material = _in.ReadString();
+          const auto width = _in.Read<double>();
+          const auto lane_change = _in.Read<element::RoadInfoMarkRecord::LaneChange>();
+          const auto height = _in.Read<double>();
+          std::string type_name = _in.ReadString();
+          const auto type_width = _in.Read<double>();
+          auto mark_record = std::make_unique<element::RoadInfoMarkRecord>(
+              s, road_mark_id, std::move(mark_type), std::move(weight), std::move(color),
+              std::move(material), width, lane_change, height, std::move(type_name), type_width);
+          const size_t line_count = _in.ReadSize();
+          for (size_t i = 0u; i < line_count; ++i) {
+            mark_record->GetLines().emplace_back(ReadMarkTypeLine(_in.Read<double>()));
+          }
+          return mark_record;
+        }
+        case InfoType::MarkTypeLine:
+          return ReadMarkTypeLine(s);
+        case InfoType::Signal: {
+          SignId signal_id = _in.ReadString();
+          const auto road_id = _in.Read<RoadId>();
+          const auto t = _in.Read<double>();
+          std::string orientation = _in.ReadString();
+          const auto signal = data._signals.find(signal_id);
+          auto signal_reference = std::make_unique<element::RoadInfoSignal>(
+              signal_id,
+              signal != data._signals.end() ? signal->second.get() : nullptr,
+              road_id, s, t, std::move(orientation));
+          const size_t validity_count = _in.ReadSize();
+          for (size_t i = 0u; i < validity_count; ++i) {
+            const auto from_lane = _in.Read<LaneId>();
+            const auto to_lane = _in.Read<LaneId>();
+            signal_reference->_validities.emplace_back(from_lane, to_lane);
+          }
+          return signal_reference;
+        }
+        case InfoType::Speed: {
+          const auto speed = _in.Read<double>();
+          std::string speed_type = _in.ReadString();
+          return std::make_unique<element::RoadInfoSpeed>(s, speed, speed_type);
+        }
+      }
+      _in.Invalidate();
+      return nullptr;
+    }
+
+    std::unique_ptr<element::RoadInfoMarkTypeLine> ReadMarkTypeLine(double s) {
+      const auto road_mark_id = _in.Read<int>();
+      const auto length = _in.Read<double>();
+      const auto space = _in.Read<double>();
+      const auto t_offset = _in.Read<double>();
+      std::string rule = _in.ReadString();
+      const auto width = _in.Read<double>();
+      return std::make_unique<element::RoadInfoMarkTypeLine>(
+          s, road_mark_id, length, space, t_offset, std::move(rule), width);
+    }
+
+    std::unique_ptr<element::Geometry> ReadGeometry() {
+      const auto type = _in.Read<element::GeometryType>();
+      const auto start_offset = _in.Read<double>();
+      const auto length = _in.Read<double>();
+      const auto heading = _in.Read<double>();
+      const auto start_position = _in.Read<geom::Location>();
+      switch (type) {
+        case element::GeometryType::LINE:
+          return std::make_unique<element::GeometryLine>(start_offset, length, heading, start_position);
+        case element::GeometryType::ARC: {
+          const auto curvature = _in.Read<double>();
+          return std::make_unique<element::GeometryArc>(start_offset, length, heading, start_position, curvature);
+        }
+        case element::GeometryType::SPIRAL: {
+          const auto curve_start = _in.Read<double>();
+          const auto curve_end = _in.Read<double>();
+          return std::make_unique<element::GeometrySpiral>(
+              start_offset, length, heading, start_position, curve_start, curve_end);
+        }
+        case element::GeometryType::POLY3: {
+          const auto a = _in.Read<double>();
+          const auto b = _in.Read<double>();
+          const auto c = _in.Read<double>();
+          const auto d = _in.Read<double>();
+          return std::make_unique<element::GeometryPoly3>(start_offset, length, heading, start_position, a, b, c, d);
+        }
+        case element::GeometryType::POLY3PARAM: {
+          const auto a_u = _in.Read<double>();
+          const auto b_u = _in.Read<double>();
+          const auto c_u = _in.Read<double>();
+          const auto d_u = _in.Read<double>();
+          const auto a_v = _in.Read<double>();
+          const auto b_v = _in.Read<double>();
+          const auto c_v = _in.Read<double>();
+          const auto d_v = _in.Read<double>();
+          const bool arc_length = _in.ReadBool();
+          return std::make_unique<element::GeometryParamPoly3>(
+              start_offset, length, heading, start_position,
+              a_u, b_u, c_u, d_u, a_v, b_v, c_v, d_v, arc_length);
+        }
+      }
+      _in.Invalidate();
+      return nullptr;
+    }
+
+    std::vector<std::unique_ptr<element::RoadInfo>> ReadInfos(const MapData &data) {
+      std::vector<std::unique_ptr<element::RoadInfo>> infos;
+      const size_t count = _in.ReadSize();
+      infos.reserve(count);
+      for (size_t i = 0u; i < count && _in.IsValid(); ++i) {
+        auto info = ReadInfo(data);
+        if (info != nullptr) {
+          infos.emplace_back(std::move(info));
+        }
+      }
+      return infos;
+    }
+
+    std::vector<RoadId> ReadRoadIds() {
+      std::vector<RoadId> road_ids(_in.ReadSize());
+      for (auto &road_id : road_ids) {
+        road_id = _in.Read<RoadId>();
+      }
+      return road_ids;
+    }
+
+    std::vector<LaneKey> ReadLaneKeys() {
+      std::vector<LaneKey> keys(_in.ReadSize());
+      for (auto &key : keys) {
+        key.road_id = _in.Read<RoadId>();
+        key.section_id = _in.Read<SectionId>();
+        key.lane_id = _in.Read<LaneId>();
+      }
+      return keys;
+    }
+
+    template <typename SetT>
+    void ReadSet(SetT &values) {
+      using value_type = typename SetT::value_type;
+      const size_t count = _in.ReadSize();
+      for (size_t i = 0u; i < count; ++i) {
+        values.emplace(ReadValue(static_cast<const value_type *>(nullptr)));
+      }
+    }
+
+    std::string ReadValue(const std::string *) {
+      return _in.ReadString();
+    }
+
+    template <typename T>
+    T ReadValue(const T *) {
+      return _in.Read<T>();
+    }
+
+    static bool LinkRoads(MapData &data, const std::vector<RoadId> &road_ids, std::vector<Road *> &roads) {
+      for (const auto road_id : road_ids) {
+        const auto it = data._roads.find(road_id);
+        if (it == data._roads.end()) {
+          return false;
+        }
+        roads.emplace_back(&it->second);
+      }
+      return true;
+    }
+
+    static bool LinkLanes(MapData &data, const std::vector<LaneKey> &keys, std::vector<Lane *> &lanes) {
+      for (const auto &key : keys) {
+        Lane *lane = FindLane(data, key);
+        if (lane == nullptr) {
+          return false;
+        }
+        lanes.emplace_back(lane);
+      }
+      return true;
+    }
+
+    static Lane *FindLane(MapData &data, const LaneKey &key) {
+      const auto road = data._roads.find(key.road_id);
+      if (road == data._roads.end()) {
+        return nullptr;
+      }
+      for (auto &section_pair : road->second._lane_sections) {
+        LaneSection &section = section_pair.second;
+        if (section._id == key.section_id) {
+          const auto lane = section._lanes.find(key.lane_id);
+          return lane != section._lanes.end() ? &lane->second : nullptr;
+        }
+      }
+      return nullptr;
+    }
+
+    Reader _in;
+  };
+
+  // ===========================================================================
+  // -- PrecompiledMap ---------------------------------------------------------
+  // ===========================================================================
+
+  OpenDriveKey PrecompiledMap::GetOpenDriveKey(const std::string &opendrive) {
+    // Unlike the checksum, the key must tell apart any two documents, so
+    // every word is mixed before it goes into the hash and the size seeds it.
+    const auto *data = reinterpret_cast<const uint8_t *>(opendrive.data());
+    const size_t size = opendrive.size();
+    static constexpr uint64_t PRIME = 1099511628211ull;
+    uint64_t hash = Mix(size);
+    size_t i = 0u;
+    for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t)) {
+      uint64_t word;
+      std::memcpy(&word, data + i, sizeof(word));
+      hash = (hash ^ Mix(word)) * PRIME;
+    }
+    uint64_t tail = 0u;
+    std::memcpy(&tail, data + i, size - i);
+    hash = Mix((hash ^ Mix(tail)) * PRIME);
+    return {hash, size};
+  }
+
+  std::vector<uint8_t> PrecompiledMap::Serialize(const Map &map, const OpenDriveKey &opendrive_key) {
+    const MapData &data = map._data;
+
+    // Sorted so that the same map always gives the same content.
+    std::vector<const Road *> roads;
+    roads.reserve(data._roads.size());
+    for (const auto &pair : data._roads) {
+      roads.emplace_back(&pair.second);
+    }
+    std::sort(roads.begin(), roads.end(), [](const Road *lhs, const Road *rhs) {
+      return lhs->_id < rhs->_id;
+    });
+    const auto rtree_elements = map.ComputeRtreeElements();
+
+    Header header;
+    std::memset(&header, 0, sizeof(header));
+    header.magic = MAGIC;
+    header.version = VERSION;
+    header.opendrive_hash = opendrive_key.hash;
+    header.opendrive_size = opendrive_key.size;
+    header.road_count = static_cast<uint32_t>(roads.size());
+    header.segment_count = static_cast<uint32_t>(rtree_elements.size());
+
+    // The road table is filled once the road blocks are written.
+    std::vector<uint8_t> buffer(sizeof(Header) + roads.size() * sizeof(RoadRecord), 0u);
+
+    std::vector<SegmentRecord> segments(rtree_elements.size());
+    auto to_record = [](const Map::Waypoint &waypoint) {
+      WaypointRecord record;
+      std::memset(&record, 0, sizeof(record));
+      record.road_id = waypoint.road_id;
+      record.section_id = waypoint.section_id;
+      record.lane_id = waypoint.lane_id;
+      record.s = waypoint.s;
+      return record;
+    };
+    for (size_t i = 0u; i < rtree_elements.size(); ++i) {
+      const auto &segment = rtree_elements[i].first;
+      SegmentRecord &record = segments[i];
+      record.start[0] = segment.first.get<0>();
+      record.start[1] = segment.first.get<1>();
+      record.start[2] = segment.first.get<2>();
+      record.end[0] = segment.second.get<0>();
+      record.end[1] = segment.second.get<1>();
+      record.end[2] = segment.second.get<2>();
+      record.start_waypoint = to_record(rtree_elements[i].second.first);
+      record.end_waypoint = to_record(rtree_elements[i].second.second);
+    }
+    const auto *segment_bytes = reinterpret_cast<const uint8_t *>(segments.data());
+    buffer.insert(buffer.end(), segment_bytes, segment_bytes + segments.size() * sizeof(SegmentRecord));
+
+    Encoder encoder(buffer);
+    const size_t map_data_begin = buffer.size();
+    encoder.WriteMapData(data);
+    header.map_data_size = buffer.size() - map_data_begin;
+
+    std::vector<RoadRecord> road_records(roads.size());
+    for (size_t i = 0u; i < roads.size(); ++i) {
+      RoadRecord &record = road_records[i];
+      record.road_id = roads[i]->_id;
+      record.reserved = 0u;
+      record.offset = buffer.size() - sizeof(Header);
+      encoder.WriteRoad(*roads[i]);
+      record.size = buffer.size() - sizeof(Header) - record.offset;
+    }
+    if (!road_records.empty()) {
+      std::memcpy(buffer.data() + sizeof(Header), road_records.data(), road_records.size() * sizeof(RoadRecord));
+    }
+
+    header.payload_size = buffer.size() - sizeof(Header);
+    header.checksum = Checksum(buffer.data() + sizeof(Header), buffer.size() - sizeof(Header));
+    std::memcpy(buffer.data(), &header, sizeof(Header));
+    return buffer;
+  }
+
+  bool PrecompiledMap::HasHeader(const uint8_t *data, size_t size) {
+    uint32_t magic = 0u;
+    if (size < sizeof(Header)) {
+      return false;
+    }
+    std::memcpy(&magic, data, sizeof(magic));
+    return magic == MAGIC;
+  }
+
+  boost::optional<Map> PrecompiledMap::Load(
+      const uint8_t *data,
+      size_t size,
+      const OpenDriveKey &opendrive_key,
+      size_t number_of_threads) {
+    if (!HasHeader(data, size) || reinterpret_cast<uintptr_t>(data) % alignof(Header) != 0u) {
+      return {};
+    }
+    const auto *header = reinterpret_cast<const Header *>(data);
+    if (header->version != VERSION) {
+      log_warning("precompiled map version", header->version, "does not match the expected", VERSION);
+      return {};
+    }
+    if (header->opendrive_hash != opendrive_key.hash ||
+        header->opendrive_size != opendrive_key.size) {
+      return {};
+    }
+
+    const uint64_t tables_size =
+        static_cast<uint64_t>(header->road_count) * sizeof(RoadRecord) +
+        static_cast<uint64_t>(header->segment_count) * sizeof(SegmentRecord);
+    if (size - sizeof(Header) < header->payload_size ||
+        header->payload_size < tables_size ||
+        header->payload_size - tables_size < header->map_data_size) {
+      log_warning("invalid precompiled map: truncated content");
+      return {};
+    }
+    const uint8_t *payload = data + sizeof(Header);
+    if (Checksum(payload, header->payload_size) != header->checksum) {
+      log_warning("invalid precompiled map: checksum mismatch");
+      return {};
+    }
+
+    const auto *road_records = reinterpret_cast<const RoadRecord *>(payload);
+    const auto *segments = reinterpret_cast<const SegmentRecord *>(road_records + header->road_count);
+    const uint64_t road_data_offset = tables_size + header->map_data_size;
+    for (uint32_t i = 0u; i < header->road_count; ++i) {
+      const RoadRecord &record = road_records[i];
+      if (record.offset < road_data_offset ||
+          record.offset > header->payload_size ||
+          record.size > header->payload_size - record.offset) {
+        log_warning("invalid precompiled map: road", record.road_id, "out of bounds");
+        return {};
+      }
+    }
+
+    MapData map_data;
+    Decoder map_data_decoder(payload + tables_size, payload + road_data_offset);
+    map_data_decoder.ReadMapData(map_data);
+    if (!map_data_decoder.IsValid()) {
+      log_warning("invalid precompiled map: cannot decode the map data");
+      return {};
+    }
+
+    // Create every road first, so that they are decoded in place and keep
+    // their addresses.
+    std::vector<Road *> roads(header->road_count);
+    map_data._roads.reserve(header->road_count);
+    for (uint32_t i = 0u; i < header->road_count; ++i) {
+      auto result = map_data._roads.emplace(road_records[i].road_id, Road());
+      if (!result.second) {
+        log_warning("invalid precompiled map: road", road_records[i].road_id, "is repeated");
+        return {};
+      }
+      roads[i] = &result.first->second;
+    }
+
+    if (number_of_threads == 0u) {
+      number_of_threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    ThreadPool thread_pool;
+    if (number_of_threads > 1u) {
+      thread_pool.AsyncRun(number_of_threads);
+    }
+
+    // Every road writes only its own flag, no need for atomics.
+    std::vector<uint8_t> valid(roads.size(), 1u);
+    std::vector<Decoder::RoadLinks> links(roads.size());
+    thread_pool.ParallelFor(roads.size(), [&](size_t index) {
+      const RoadRecord &record = road_records[index];
+      Decoder decoder(payload + record.offset, payload + record.offset + record.size);
+      links[index] = decoder.ReadRoad(map_data, *roads[index]);
+      valid[index] = decoder.IsValid() && roads[index]->_id == record.road_id;
+    });
+    thread_pool.ParallelFor(roads.size(), [&](size_t index) {
+      valid[index] = valid[index] && Decoder::Link(map_data, *roads[index], links[index]);
+    });
+    if (std::find(valid.begin(), valid.end(), 0u) != valid.end()) {
+      log_warning("invalid precompiled map: cannot decode the roads");
+      return {};
+    }
+
+    std::vector<Map::Rtree::TreeElement> rtree_elements;
+    rtree_elements.reserve(header->segment_count);
+    auto to_waypoint = [](const WaypointRecord &record) {
+      Map::Waypoint waypoint;
+      waypoint.road_id = record.road_id;
+      waypoint.section_id = record.section_id;
+      waypoint.lane_id = record.lane_id;
+      waypoint.s = record.s;
+      return waypoint;
+    };
+    for (uint32_t i = 0u; i < header->segment_count; ++i) {
+      const SegmentRecord &record = segments[i];
+      rtree_elements.emplace_back(
+          Map::Rtree::BSegment(
+              Map::Rtree::BPoint(record.start[0], record.start[1], record.start[2]),
+              Map::Rtree::BPoint(record.end[0], record.end[1], record.end[2])),
+          std::make_pair(to_waypoint(record.start_waypoint), to_waypoint(record.end_waypoint)));
+    }
+    return Map(std::move(map_data), rtree_elements);
+  }
+
+} // namespace road
+} // namespace carla
@@ -0,0 +1,134 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/road/Map.h"
+
+#include <boost/optional.hpp>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace carla {
+namespace road {
+
+namespace precompiled_map {
+
+  /// "CRMP" in little endian.
+  static constexpr uint32_t MAGIC = 0x504D5243u;
+  /// Bump whenever the layout below, or what the map builder computes, changes.
+  static constexpr uint32_t VERSION = 2u;
+
+  /// Identifies the OpenDRIVE a precompiled map was built from.
+  struct OpenDriveKey {
+    /// Hash of the content of the OpenDRIVE.
+    uint64_t hash;
+    /// Size in bytes of the OpenDRIVE.
+    uint64_t size;
+  };
+
+  /// Header at the start of a precompiled map. It is followed by the payload,
+  /// made of these sections:
+  ///
+  ///   RoadRecord    roads[road_count];
+  ///   SegmentRecord segments[segment_count];
+  ///   uint8_t       map_data[map_data_size];
+  ///   uint8_t       road_data[];
+  ///
+  /// The map data holds the georeference, signals, controllers and junctions
+  /// of the map. Every road is encoded in its own block of the road data, so
+  /// that roads are decoded independently of each other. Links between roads
+  /// and lanes are stored as ids and resolved once every road is decoded.
+  struct Header {
+    uint32_t magic;
+    uint32_t version;
+    /// Key of the OpenDRIVE the map was built from.
+    uint64_t opendrive_hash;
+    uint64_t opendrive_size;
+    uint32_t road_count;
+    uint32_t segment_count;
+    uint64_t map_data_size;
+    /// Size in bytes of everything after the header.
+    uint64_t payload_size;
+    /// Word-wise FNV-1a hash of the payload.
+    uint64_t checksum;
+  };
+
+  static_assert(sizeof(Header) == 56u, "Unexpected padding in the precompiled map header");
+
+  /// Location of the block of a road, relative to the start of the payload.
+  struct RoadRecord {
+    uint32_t road_id;
+    uint32_t reserved;
+    uint64_t offset;
+    uint64_t size;
+  };
+
+  static_assert(sizeof(RoadRecord) == 24u, "Unexpected padding in the road record");
+
+  struct WaypointRecord {
+    uint32_t road_id;
+    uint32_t section_id;
+    int32_t lane_id;
+    uint32_t reserved;
+    double s;
+  };
+
+  static_assert(sizeof(WaypointRecord) == 24u, "Unexpected padding in the waypoint record");
+
+  /// Segment of the Rtree of the map, in the order they were inserted so that
+  /// the restored tree answers queries exactly like the original one.
+  struct SegmentRecord {
+    float start[3];
+    float end[3];
+    WaypointRecord start_waypoint;
+    WaypointRecord end_waypoint;
+  };
+
+  static_assert(sizeof(SegmentRecord) == 72u, "Unexpected padding in the segment record");
+
+} // namespace precompiled_map
+
+  /// Binary form of a fully built road::Map, including the segments of its
+  /// Rtree, so that the map can be restored without parsing the OpenDRIVE or
+  /// running the map builder. The content is versioned and checksummed, and
+  /// keyed by the hash and size of the OpenDRIVE, so it can be cached on disk
+  /// and mapped straight from the file.
+  class PrecompiledMap {
+  public:
+
+    PrecompiledMap() = delete;
+
+    /// Key of the precompiled maps of @a opendrive, from its content.
+    static precompiled_map::OpenDriveKey GetOpenDriveKey(const std::string &opendrive);
+
+    static std::vector<uint8_t> Serialize(const Map &map, const precompiled_map::OpenDriveKey &opendrive_key);
+
+    /// Whether the buffer starts like a precompiled map. Does not validate
+    /// the content.
+    static bool HasHeader(const uint8_t *data, size_t size);
+
+    /// Restores the map in the given buffer, decoding the roads on the calling
+    /// thread unless @a number_of_threads says otherwise (0 for one per
+    /// hardware thread). Returns an empty optional if the buffer is not a
+    /// valid precompiled map of the OpenDRIVE with key @a opendrive_key.
+    static boost::optional<Map> Load(
+        const uint8_t *data,
+        size_t size,
+        const precompiled_map::OpenDriveKey &opendrive_key,
+        size_t number_of_threads = 1u);
+
+  private:
+
+    class Encoder;
+
+    class Decoder;
+  };
+
+} // namespace road
+} // namespace carla
@@ -28,6 +28,7 @@ namespace road {
   class MapData;
   class Elevation;
   class MapBuilder;
+  class PrecompiledMap;
 
   class Road : private MovableNonCopyable {
   public:
@@ -114,6 +115,11 @@ namespace road {
       return _info.GetInfo<T>(s);
     }
 
+    template <typename T>
+    const T *GetInfo(const double s, double &begin, double &end) const {
+      return _info.GetInfo<T>(s, begin, end);
+    }
+
     template <typename T>
     std::vector<const T*> GetInfos() const {
       return _info.GetInfos<T>();
@@ -181,6 +187,7 @@ namespace road {
   private:
 
     friend MapBuilder;
+    friend PrecompiledMap;
 
     MapData *_map_data { nullptr };
 
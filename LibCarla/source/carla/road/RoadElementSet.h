@@ -34,7 +34,11 @@ namespace road {
     RoadElementSet(std::vector<InputTypeT> &&range)
       : _vec([](auto &&input) {
           static_assert(!std::is_const<InputTypeT>::value, "Input type cannot be const");
-          std::sort(std::begin(input), std::end(input), LessComp());
+          // Sorted input, like a set being restored, keeps the order of
+          // elements at the same distance.
+          if (!std::is_sorted(std::begin(input), std::end(input), LessComp())) {
+            std::sort(std::begin(input), std::end(input), LessComp());
+          }
           return decltype(_vec){
               std::make_move_iterator(std::begin(input)),
               std::make_move_iterator(std::end(input))};
@@ -20,6 +20,8 @@
 #include <algorithm>
 #include <cmath>
 #include <stdexcept>
+#include <utility>
+#include <vector>
 
 namespace carla {
 namespace road {
@@ -33,6 +35,12 @@ namespace element {
     location.y += lateral_offset * normal_y;
   }
 
+  void Geometry::PosFromDists(const double *dists, size_t count, DirectedPoint *out) const {
+    for (size_t i = 0u; i < count; ++i) {
+      out[i] = PosFromDist(dists[i]);
+    }
+  }
+
   DirectedPoint GeometryLine::PosFromDist(double dist) const {
     DEBUG_ASSERT(_length > 0.0);
     dist = geom::Math::Clamp(dist, 0.0, _length);
@@ -42,6 +50,19 @@ namespace element {
     return p;
   }
 
+  void GeometryLine::PosFromDists(const double *dists, size_t count, DirectedPoint *out) const {
+    DEBUG_ASSERT(_length > 0.0);
+    // Same operations as PosFromDist, with the heading terms computed once.
+    const double cos_heading = std::cos(_heading);
+    const double sin_heading = std::sin(_heading);
+    for (size_t i = 0u; i < count; ++i) {
+      const double dist = geom::Math::Clamp(dists[i], 0.0, _length);
+      out[i] = DirectedPoint(_start_position, _heading);
+      out[i].location.x += static_cast<float>(dist * cos_heading);
+      out[i].location.y += static_cast<float>(dist * sin_heading);
+    }
+  }
+
   DirectedPoint GeometryArc::PosFromDist(double dist) const {
     dist = geom::Math::Clamp(dist, 0.0, _length);
     DEBUG_ASSERT(_length > 0.0);
@@ -57,6 +78,23 @@ namespace element {
     return p;
   }
 
+  void GeometryArc::PosFromDists(const double *dists, size_t count, DirectedPoint *out) const {
+    DEBUG_ASSERT(_length > 0.0);
+    DEBUG_ASSERT(std::fabs(_curvature) > 1e-15);
+    const double radius = 1.0 / _curvature;
+    constexpr double pi_half = geom::Math::Pi<double>() / 2.0;
+    // Center of the arc, shared by every point.
+    geom::Location center = _start_position;
+    center.x += static_cast<float>(radius * std::cos(_heading + pi_half));
+    center.y += static_cast<float>(radius * std::sin(_heading + pi_half));
+    for (size_t i = 0u; i < count; ++i) {
+      const double dist = geom::Math::Clamp(dists[i], 0.0, _length);
+      out[i] = DirectedPoint(center, _heading + dist * _curvature);
+      out[i].location.x -= static_cast<float>(radius * std::cos(out[i].tangent + pi_half));
+      out[i].location.y -= static_cast<float>(radius * std::sin(out[i].tangent + pi_half));
+    }
+  }
+
   // helper function for rotating points
   geom::Vector2D RotatebyAngle(double angle, double x, double y) {
     const double cos_a = std::cos(angle);
@@ -141,6 +179,7 @@ namespace element {
     double last_v = _poly.Evaluate(current_u);
     double last_s = 0;
     RtreeValue last_val{last_u, last_v, last_s, _poly.Tangent(current_u)};
+    std::vector<Rtree::TreeElement> rtree_elements;
     while (current_s < _length + delta_u) {
       current_u += delta_u;
       double current_v = _poly.Evaluate(current_u);
@@ -153,7 +192,7 @@ namespace element {
 
       Rtree::BPoint p1(static_cast<float>(last_s));
       Rtree::BPoint p2(static_cast<float>(current_s));
-      _rtree.InsertElement(Rtree::BSegment(p1, p2), last_val, current_val);
+      rtree_elements.emplace_back(Rtree::BSegment(p1, p2), std::make_pair(last_val, current_val));
 
       last_u = current_u;
       last_v = current_v;
@@ -161,6 +200,7 @@ namespace element {
       last_val = current_val;
 
     }
+    _rtree.Build(rtree_elements);
   }
 
   DirectedPoint GeometryParamPoly3::PosFromDist(double dist) const {
@@ -208,6 +248,8 @@ namespace element {
         last_s,
         _polyU.Tangent(param_p),
         _polyV.Tangent(param_p) };
+    std::vector<Rtree::TreeElement> rtree_elements;
+    rtree_elements.reserve(number_intervals);
     for(size_t i = 0; i < number_intervals; ++i) {
       param_p += delta_p;
       double current_u = _polyU.Evaluate(param_p);
@@ -227,7 +269,7 @@ namespace element {
 
       Rtree::BPoint p1(static_cast<float>(last_s));
       Rtree::BPoint p2(static_cast<float>(current_s));
-      _rtree.InsertElement(Rtree::BSegment(p1, p2), last_val, current_val);
+      rtree_elements.emplace_back(Rtree::BSegment(p1, p2), std::make_pair(last_val, current_val));
 
       last_u = current_u;
       last_v = current_v;
@@ -238,6 +280,7 @@ namespace element {
         break;
       }
     }
+    _rtree.Build(rtree_elements);
   }
 } // namespace element
 } // namespace road
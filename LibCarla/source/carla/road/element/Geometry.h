@@ -62,7 +62,7 @@ namespace element {
       return _heading;
     }
 
-    const geom::Location &GetStartPosition() {
+    const geom::Location &GetStartPosition() const {
       return _start_position;
     }
 
@@ -70,6 +70,10 @@ namespace element {
 
     virtual DirectedPoint PosFromDist(double dist) const = 0;
 
+    /// Computes PosFromDist for @a count distances at once, writing the
+    /// results to @a out.
+    virtual void PosFromDists(const double *dists, size_t count, DirectedPoint *out) const;
+
     virtual std::pair<float, float> DistanceTo(const geom::Location &p) const = 0;
 
   protected:
@@ -109,6 +113,8 @@ namespace element {
 
     DirectedPoint PosFromDist(double dist) const override;
 
+    void PosFromDists(const double *dists, size_t count, DirectedPoint *out) const override;
+
     /// Returns a pair containing:
     /// - @b first:  distance to the nearest point in this line from the
     ///              beginning of the shape.
@@ -138,6 +144,8 @@ namespace element {
 
     DirectedPoint PosFromDist(double dist) const override;
 
+    void PosFromDists(const double *dists, size_t count, DirectedPoint *out) const override;
+
     /// Returns a pair containing:
     /// - @b first:  distance to the nearest point in this arc from the
     ///              beginning of the shape.
@@ -175,11 +183,11 @@ namespace element {
         _curve_start(curv_s),
         _curve_end(curv_e) {}
 
-    double GetCurveStart() {
+    double GetCurveStart() const {
       return _curve_start;
     }
 
-    double GetCurveEnd() {
+    double GetCurveEnd() const {
       return _curve_end;
     }
 
@@ -308,6 +316,9 @@ namespace element {
     double GetdV() const {
       return _dV;
     }
+    bool IsArcLength() const {
+      return _arcLength;
+    }
 
     DirectedPoint PosFromDist(double dist) const override;
 
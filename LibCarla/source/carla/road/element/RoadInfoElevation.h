@@ -25,6 +25,12 @@ namespace element {
       : RoadInfo(s),
         _elevation(a, b, c, d, s) {}
 
+    /// Takes the polynomial as already shifted to @a s, as returned by
+    /// GetPolynomial.
+    RoadInfoElevation(double s, const geom::CubicPolynomial &elevation)
+      : RoadInfo(s),
+        _elevation(elevation) {}
+
     void AcceptVisitor(RoadInfoVisitor &v) final {
       v.Visit(*this);
     }
@@ -32,6 +32,12 @@ namespace element {
       : RoadInfo(s),
         _border(a, b, c, d, s) {}
 
+    /// Takes the polynomial as already shifted to @a s, as returned by
+    /// GetPolynomial.
+    RoadInfoLaneBorder(double s, const geom::CubicPolynomial &border)
+      : RoadInfo(s),
+        _border(border) {}
+
     void AcceptVisitor(RoadInfoVisitor &v) final {
       v.Visit(*this);
     }
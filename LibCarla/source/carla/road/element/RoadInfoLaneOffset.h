@@ -31,6 +31,12 @@ namespace element {
       : RoadInfo(s),
         _offset(a, b, c, d, s) {}
 
+    /// Takes the polynomial as already shifted to @a s, as returned by
+    /// GetPolynomial.
+    RoadInfoLaneOffset(double s, const geom::CubicPolynomial &offset)
+      : RoadInfo(s),
+        _offset(offset) {}
+
     void AcceptVisitor(RoadInfoVisitor &v) final {
       v.Visit(*this);
     }
@@ -30,6 +30,12 @@ namespace element {
       : RoadInfo(s),
         _width(a, b, c, d, s) {}
 
+    /// Takes the polynomial as already shifted to @a s, as returned by
+    /// GetPolynomial.
+    RoadInfoLaneWidth(double s, const geom::CubicPolynomial &width)
+      : RoadInfo(s),
+        _width(width) {}
+
     void AcceptVisitor(RoadInfoVisitor &v) final {
       v.Visit(*this);
     }
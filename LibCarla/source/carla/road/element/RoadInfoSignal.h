@@ -88,6 +88,7 @@ namespace element {
 
   private:
     friend MapBuilder;
+    friend PrecompiledMap;
 
     SignId _signal_id;
 
@@ -0,0 +1,185 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/rpc/VehicleControlBatch.h"
+
+#include <cstring>
+#include <type_traits>
+
+namespace carla {
+namespace rpc {
+
+namespace {
+
+  static_assert(std::is_trivially_copyable<geom::Transform>::value,
+      "Transforms are copied as raw memory");
+
+  struct Header {
+    uint32_t version;
+    uint32_t number_of_controls;
+    uint32_t number_of_transforms;
+    uint32_t number_of_light_states;
+  };
+
+  constexpr std::size_t CONTROL_SIZE =
+      sizeof(ActorId) + 3u * sizeof(float) + sizeof(uint8_t) + sizeof(int32_t);
+  constexpr std::size_t TRANSFORM_SIZE = sizeof(ActorId) + sizeof(geom::Transform);
+  constexpr std::size_t LIGHT_STATE_SIZE = sizeof(ActorId) + sizeof(VehicleLightState::flag_type);
+
+  template <typename T>
+  void WriteArray(const std::vector<T> &array, unsigned char *&cursor) {
+    const std::size_t size = array.size() * sizeof(T);
+    if (size > 0u) {
+      std::memcpy(cursor, array.data(), size);
+      cursor += size;
+    }
+  }
+
+  template <typename T>
+  void ReadArray(std::vector<T> &array, std::size_t count, const unsigned char *&cursor) {
+    array.resize(count);
+    const std::size_t size = count * sizeof(T);
+    if (size > 0u) {
+      std::memcpy(array.data(), cursor, size);
+      cursor += size;
+    }
+  }
+
+} // namespace
+
+  void VehicleControlBatch::Clear() {
+    _control_actors.clear();
+    _throttle.clear();
+    _steer.clear();
+    _brake.clear();
+    _control_flags.clear();
+    _gear.clear();
+    _transform_actors.clear();
+    _transforms.clear();
+    _light_actors.clear();
+    _light_states.clear();
+  }
+
+  void VehicleControlBatch::Reserve(std::size_t number_of_vehicles) {
+    _control_actors.reserve(number_of_vehicles);
+    _throttle.reserve(number_of_vehicles);
+    _steer.reserve(number_of_vehicles);
+    _brake.reserve(number_of_vehicles);
+    _control_flags.reserve(number_of_vehicles);
+    _gear.reserve(number_of_vehicles);
+  }
+
+  void VehicleControlBatch::AddControl(ActorId actor_id, const VehicleControl &control) {
+    _control_actors.push_back(actor_id);
+    _throttle.push_back(control.throttle);
+    _steer.push_back(control.steer);
+    _brake.push_back(control.brake);
+    uint8_t flags = 0u;
+    if (control.hand_brake) {
+      flags |= HAND_BRAKE;
+    }
+    if (control.reverse) {
+      flags |= REVERSE;
+    }
+    if (control.manual_gear_shift) {
+      flags |= MANUAL_GEAR_SHIFT;
+    }
+    _control_flags.push_back(flags);
+    _gear.push_back(control.gear);
+  }
+
+  void VehicleControlBatch::AddTransform(ActorId actor_id, const geom::Transform &transform) {
+    _transform_actors.push_back(actor_id);
+    _transforms.push_back(transform);
+  }
+
+  void VehicleControlBatch::AddLightState(ActorId actor_id, VehicleLightState::flag_type light_state) {
+    _light_actors.push_back(actor_id);
+    _light_states.push_back(light_state);
+  }
+
+  bool VehicleControlBatch::Add(const Command &command) {
+    if (const auto *control = boost::variant2::get_if<Command::ApplyVehicleControl>(&command.command)) {
+      AddControl(control->actor, control->control);
+    } else if (const auto *transform = boost::variant2::get_if<Command::ApplyTransform>(&command.command)) {
+      AddTransform(transform->actor, transform->transform);
+    } else if (const auto *light = boost::variant2::get_if<Command::SetVehicleLightState>(&command.command)) {
+      AddLightState(light->actor, light->light_state);
+    } else {
+      return false;
+    }
+    return true;
+  }
+
+  VehicleControl VehicleControlBatch::GetControl(std::size_t index) const {
+    const uint8_t flags = _control_flags[index];
+    return VehicleControl(
+        _throttle[index],
+        _steer[index],
+        _brake[index],
+        (flags & HAND_BRAKE) != 0u,
+        (flags & REVERSE) != 0u,
+        (flags & MANUAL_GEAR_SHIFT) != 0u,
+        _gear[index]);
+  }
+
+  void VehicleControlBatch::Encode(std::vector<unsigned char> &buffer) const {
+    const Header header{
+        VERSION,
+        static_cast<uint32_t>(GetNumberOfControls()),
+        static_cast<uint32_t>(GetNumberOfTransforms()),
+        static_cast<uint32_t>(GetNumberOfLightStates())};
+    buffer.resize(
+        sizeof(Header) +
+        header.number_of_controls * CONTROL_SIZE +
+        header.number_of_transforms * TRANSFORM_SIZE +
+        header.number_of_light_states * LIGHT_STATE_SIZE);
+    unsigned char *cursor = buffer.data();
+    std::memcpy(cursor, &header, sizeof(Header));
+    cursor += sizeof(Header);
+    WriteArray(_control_actors, cursor);
+    WriteArray(_throttle, cursor);
+    WriteArray(_steer, cursor);
+    WriteArray(_brake, cursor);
+    WriteArray(_control_flags, cursor);
+    WriteArray(_gear, cursor);
+    WriteArray(_transform_actors, cursor);
+    WriteArray(_transforms, cursor);
+    WriteArray(_light_actors, cursor);
+    WriteArray(_light_states, cursor);
+  }
+
+  bool VehicleControlBatch::Decode(const unsigned char *data, std::size_t size) {
+    Clear();
+    Header header;
+    if (data == nullptr || size < sizeof(Header)) {
+      return false;
+    }
+    std::memcpy(&header, data, sizeof(Header));
+    const uint64_t expected_size =
+        sizeof(Header) +
+        uint64_t(header.number_of_controls) * CONTROL_SIZE +
+        uint64_t(header.number_of_transforms) * TRANSFORM_SIZE +
+        uint64_t(header.number_of_light_states) * LIGHT_STATE_SIZE;
+    if (header.version != VERSION || size != expected_size) {
+      return false;
+    }
+    const unsigned char *cursor = data + sizeof(Header);
+    ReadArray(_control_actors, header.number_of_controls, cursor);
+    ReadArray(_throttle, header.number_of_controls, cursor);
+    ReadArray(_steer, header.number_of_controls, cursor);
+    ReadArray(_brake, header.number_of_controls, cursor);
+    ReadArray(_control_flags, header.number_of_controls, cursor);
+    ReadArray(_gear, header.number_of_controls, cursor);
+    ReadArray(_transform_actors, header.number_of_transforms, cursor);
+    ReadArray(_transforms, header.number_of_transforms, cursor);
+    ReadArray(_light_actors, header.number_of_light_states, cursor);
+    ReadArray(_light_states, header.number_of_light_states, cursor);
+    return true;
+  }
+
+} // namespace rpc
+} // namespace carla
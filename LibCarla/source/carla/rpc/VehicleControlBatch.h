@@ -0,0 +1,125 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/geom/Transform.h"
+#include "carla/rpc/ActorId.h"
+#include "carla/rpc/Command.h"
+#include "carla/rpc/VehicleControl.h"
+#include "carla/rpc/VehicleLightState.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace carla {
+namespace rpc {
+
+  /// Vehicle controls, teleports and light states of a whole simulation step,
+  /// stored as a structure of arrays. The batch is sent as a single binary
+  /// blob of fixed-size arrays, so that encoding and decoding it is a copy per
+  /// array instead of a msgpack variant per command.
+  class VehicleControlBatch {
+  public:
+
+    /// Format version written in the header of the encoded batch.
+    static constexpr uint32_t VERSION = 1u;
+
+    void Clear();
+
+    void Reserve(std::size_t number_of_vehicles);
+
+    void AddControl(ActorId actor_id, const VehicleControl &control);
+
+    void AddTransform(ActorId actor_id, const geom::Transform &transform);
+
+    void AddLightState(ActorId actor_id, VehicleLightState::flag_type light_state);
+
+    /// Adds @a command to the batch if it is of one of the supported types,
+    /// returns false otherwise.
+    bool Add(const Command &command);
+
+    std::size_t GetNumberOfControls() const {
+      return _control_actors.size();
+    }
+
+    ActorId GetControlActor(std::size_t index) const {
+      return _control_actors[index];
+    }
+
+    VehicleControl GetControl(std::size_t index) const;
+
+    std::size_t GetNumberOfTransforms() const {
+      return _transform_actors.size();
+    }
+
+    ActorId GetTransformActor(std::size_t index) const {
+      return _transform_actors[index];
+    }
+
+    const geom::Transform &GetTransform(std::size_t index) const {
+      return _transforms[index];
+    }
+
+    std::size_t GetNumberOfLightStates() const {
+      return _light_actors.size();
+    }
+
+    ActorId GetLightStateActor(std::size_t index) const {
+      return _light_actors[index];
+    }
+
+    VehicleLightState::flag_type GetLightState(std::size_t index) const {
+      return _light_states[index];
+    }
+
+    std::size_t size() const {
+      return GetNumberOfControls() + GetNumberOfTransforms() + GetNumberOfLightStates();
+    }
+
+    bool empty() const {
+      return size() == 0u;
+    }
+
+    /// Writes the binary representation of the batch into @a buffer, reusing
+    /// its storage.
+    void Encode(std::vector<unsigned char> &buffer) const;
+
+    /// Replaces the content of the batch with the one encoded in @a data.
+    /// Returns false if @a data is not a valid batch of the current version.
+    bool Decode(const unsigned char *data, std::size_t size);
+
+  private:
+
+    enum ControlFlags : uint8_t {
+      HAND_BRAKE        = 1u << 0u,
+      REVERSE           = 1u << 1u,
+      MANUAL_GEAR_SHIFT = 1u << 2u
+    };
+
+    std::vector<ActorId> _control_actors;
+
+    std::vector<float> _throttle;
+
+    std::vector<float> _steer;
+
+    std::vector<float> _brake;
+
+    std::vector<uint8_t> _control_flags;
+
+    std::vector<int32_t> _gear;
+
+    std::vector<ActorId> _transform_actors;
+
+    std::vector<geom::Transform> _transforms;
+
+    std::vector<ActorId> _light_actors;
+
+    std::vector<VehicleLightState::flag_type> _light_states;
+  };
+
+} // namespace rpc
+} // namespace carla
@@ -18,7 +18,7 @@ namespace s11n {
 
   static Buffer PopBufferFromPool() {
     static auto pool = std::make_shared<BufferPool>();
-    return pool->Pop();
+    return pool->Pop(sizeof(SensorHeaderSerializer::Header));
   }
 
   Buffer SensorHeaderSerializer::Serialize(
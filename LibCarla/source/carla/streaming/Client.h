@@ -9,6 +9,7 @@
 #include "carla/Logging.h"
 #include "carla/ThreadPool.h"
 #include "carla/streaming/Token.h"
+#include "carla/streaming/detail/Compression.h"
 #include "carla/streaming/detail/tcp/Client.h"
 #include "carla/streaming/low_level/Client.h"
 
@@ -40,6 +41,13 @@ namespace streaming {
       _client.Subscribe(_service.io_context(), token, std::forward<Functor>(callback));
     }
 
+    /// Ask the server to compress the streams subscribed from now on with
+    /// any of the codecs this client supports. Only servers with compression
+    /// enabled honor it, the rest keep sending them uncompressed.
+    void SetCompressionEnabled(bool enabled) {
+      _client.SetAcceptedCodecs(enabled ? detail::GetSupportedCodecs() : detail::codec_mask_type(0u));
+    }
+
     void UnSubscribe(const Token &token) {
       _client.UnSubscribe(token);
     }
@@ -71,6 +71,41 @@ namespace streaming {
       _server.SetSynchronousMode(is_synchro);
     }
 
+    /// Publish the streams created from now on also through shared memory.
+    /// Clients on the same host read them from there instead of TCP.
+    void SetSharedMemoryTransport(bool enable) {
+      _server.SetSharedMemoryTransport(enable);
+    }
+
+    /// Compress the streams created from now on for the clients that support
+    /// @a settings.codec. Streams are sent raw by default.
+    void SetDefaultCompression(const detail::CompressionSettings &settings) {
+      _server.SetDefaultCompression(settings);
+    }
+
+    /// Compress the stream @a sensor_id for the clients subscribing from now
+    /// on.
+    void SetCompression(stream_id sensor_id, const detail::CompressionSettings &settings) {
+      _server.SetCompression(sensor_id, settings);
+    }
+
+    /// Maximum number of messages waiting to be sent to each client.
+    void SetSendQueueCapacity(size_t capacity) {
+      _server.SetSendQueueCapacity(capacity);
+    }
+
+    /// What to do with new messages when a client is too slow, only in
+    /// asynchronous mode.
+    void SetSendQueuePolicy(detail::tcp::SendQueuePolicy policy) {
+      _server.SetSendQueuePolicy(policy);
+    }
+
+    /// Send queue counters of all the clients this server sent data to, to
+    /// find out whether clients are too slow and messages are discarded.
+    detail::tcp::SendQueueStats GetSendQueueStats() const {
+      return _server.GetSendQueueStats();
+    }
+
     token_type GetToken(stream_id sensor_id) {
       return _server.GetToken(sensor_id);
     }
@@ -0,0 +1,368 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/streaming/detail/Compression.h"
+
+#include "carla/BufferPool.h"
+#include "carla/Debug.h"
+#include "carla/Logging.h"
+
+#ifndef LIBCARLA_STREAMING_WITH_LZ4_SUPPORT
+#  if defined(__has_include) && __has_include("lz4.h")
+#    define LIBCARLA_STREAMING_WITH_LZ4_SUPPORT true
+#  else
+#    define LIBCARLA_STREAMING_WITH_LZ4_SUPPORT false
+#  endif
+#endif
+
+#ifndef LIBCARLA_STREAMING_WITH_ZSTD_SUPPORT
+#  if defined(__has_include) && __has_include("zstd.h")
+#    define LIBCARLA_STREAMING_WITH_ZSTD_SUPPORT true
+#  else
+#    define LIBCARLA_STREAMING_WITH_ZSTD_SUPPORT false
+#  endif
+#endif
+
+#if LIBCARLA_STREAMING_WITH_LZ4_SUPPORT
+#  include <lz4.h>
+#endif
+#if LIBCARLA_STREAMING_WITH_ZSTD_SUPPORT
+#  include <zstd.h>
+#endif
+
+#include <cstring>
+
+namespace carla {
+namespace streaming {
+namespace detail {
+
+  codec_mask_type GetSupportedCodecs() {
+    codec_mask_type mask = 0u;
+#if LIBCARLA_STREAMING_WITH_LZ4_SUPPORT
+    mask |= ToCodecMask(Codec::LZ4);
+#endif
+#if LIBCARLA_STREAMING_WITH_ZSTD_SUPPORT
+    mask |= ToCodecMask(Codec::Zstd);
+#endif
+    return mask;
+  }
+
+  /// Replaces @a current with its difference against @a previous, and
+  /// @a previous with the current frame.
+  static void MakeDelta(unsigned char *current, unsigned char *previous, size_t size) {
+    size_t i = 0u;
+    // A word at a time, memcpy keeps the unaligned accesses well defined.
+    for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t)) {
+      uint64_t value, reference;
+      std::memcpy(&value, current + i, sizeof(value));
+      std::memcpy(&reference, previous + i, sizeof(reference));
+      const uint64_t delta = value ^ reference;
+      std::memcpy(current + i, &delta, sizeof(delta));
+      std::memcpy(previous + i, &value, sizeof(value));
+    }
+    for (; i < size; ++i) {
+      const unsigned char value = current[i];
+      current[i] ^= previous[i];
+      previous[i] = value;
+    }
+  }
+
+  /// Inverse of MakeDelta, replaces @a delta with the frame it encodes and
+  /// @a previous with the same frame.
+  static void ApplyDelta(unsigned char *delta, unsigned char *previous, size_t size) {
+    size_t i = 0u;
+    for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t)) {
+      uint64_t value, reference;
+      std::memcpy(&value, delta + i, sizeof(value));
+      std::memcpy(&reference, previous + i, sizeof(reference));
+      value ^= reference;
+      std::memcpy(delta + i, &value, sizeof(value));
+      std::memcpy(previous + i, &value, sizeof(value));
+    }
+    for (; i < size; ++i) {
+      previous[i] ^= delta[i];
+      delta[i] = previous[i];
+    }
+  }
+
+  // ===========================================================================
+  // -- Compressor -------------------------------------------------------------
+  // ===========================================================================
+
+  struct Compressor::Context {
+#if LIBCARLA_STREAMING_WITH_ZSTD_SUPPORT
+    ZSTD_CCtx *zstd = nullptr;
+
+    ~Context() {
+      ZSTD_freeCCtx(zstd);
+    }
+#endif // LIBCARLA_STREAMING_WITH_ZSTD_SUPPORT
+
+    /// Upper bound of the compressed size of @a size bytes.
+    static size_t Bound(Codec codec, size_t size) {
+      switch (codec) {
+#if LIBCARLA_STREAMING_WITH_LZ4_SUPPORT
+        case Codec::LZ4:
+          return static_cast<size_t>(LZ4_compressBound(static_cast<int>(size)));
+#endif
+#if LIBCARLA_STREAMING_WITH_ZSTD_SUPPORT
+        case Codec::Zstd:
+          return ZSTD_compressBound(size);
+#endif
+        default:
+          return size;
+      }
+    }
+
+    /// Returns the compressed size, or zero if @a source could not be
+    /// compressed.
+    size_t Compress(
+        Codec codec,
+        int level,
+        const unsigned char *source,
+        size_t size,
+        unsigned char *destination,
+        size_t capacity) {
+      switch (codec) {
+#if LIBCARLA_STREAMING_WITH_LZ4_SUPPORT
+        case Codec::LZ4: {
+          const int result = LZ4_compress_fast(
+              reinterpret_cast<const char *>(source),
+              reinterpret_cast<char *>(destination),
+              static_cast<int>(size),
+              static_cast<int>(capacity),
+              level > 0 ? level : 1);
+          return result > 0 ? static_cast<size_t>(result) : 0u;
+        }
+#endif
+#if LIBCARLA_STREAMING_WITH_ZSTD_SUPPORT
+        case Codec::Zstd: {
+          if (zstd == nullptr) {
+            zstd = ZSTD_createCCtx();
+          }
+          const size_t result = ZSTD_compressCCtx(
+              zstd,
+              destination,
+              capacity,
+              source,
+              size,
+              level != 0 ? level : ZSTD_CLEVEL_DEFAULT);
+          return ZSTD_isError(result) ? 0u : result;
+        }
+#endif
+        default:
+          return 0u;
+      }
+    }
+  };
+
+  Compressor::Compressor(Codec codec, const CompressionSettings &settings)
+    : _codec(codec),
+      _settings(settings),
+      _buffer_pool(std::make_shared<BufferPool>()),
+      _context(std::make_unique<Context>()) {
+    DEBUG_ASSERT(codec != Codec::None);
+    DEBUG_ASSERT(IsCodecSupported(codec));
+  }
+
+  Compressor::~Compressor() = default;
+
+  void Compressor::SetSettings(const CompressionSettings &settings) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _settings = settings;
+    _keyframe_requested = true;
+  }
+
+  void Compressor::RequestKeyframe() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _keyframe_requested = true;
+  }
+
+  Buffer Compressor::Compress(const std::vector<boost::asio::const_buffer> &buffers) {
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    size_t total_size = 0u;
+    for (auto &buffer : buffers) {
+      total_size += buffer.size();
+    }
+
+    compression_header header;
+    header.codec = _codec;
+    header.frame = ++_frame;
+    header.raw_size = static_cast<message_size_type>(total_size);
+
+    // Concatenate the buffers, unless a single one can be compressed in place.
+    const unsigned char *source = nullptr;
+    if ((buffers.size() == 1u) && !_settings.delta) {
+      source = static_cast<const unsigned char *>(buffers.front().data());
+    } else {
+      _scratch.reset(static_cast<message_size_type>(total_size));
+      size_t offset = 0u;
+      for (auto &buffer : buffers) {
+        std::memcpy(_scratch.data() + offset, buffer.data(), buffer.size());
+        offset += buffer.size();
+      }
+      source = _scratch.data();
+    }
+
+    if (_settings.delta) {
+      const bool is_delta =
+          !_keyframe_requested &&
+          (_previous.size() == total_size) &&
+          (_frames_since_keyframe + 1u < _settings.keyframe_interval);
+      if (is_delta) {
+        MakeDelta(_scratch.data(), _previous.data(), total_size);
+        header.flags = compression_header::delta;
+        ++_frames_since_keyframe;
+      } else {
+        _previous.copy_from(_scratch.data(), _scratch.size());
+        _frames_since_keyframe = 0u;
+      }
+      header.flags |= compression_header::reference;
+    }
+    _keyframe_requested = false;
+
+    const size_t capacity = Context::Bound(_codec, total_size);
+    auto message = _buffer_pool->Pop(sizeof(header) + capacity);
+    unsigned char *payload = message.data() + sizeof(header);
+    size_t payload_size = _context->Compress(
+        _codec,
+        _settings.level,
+        source,
+        total_size,
+        payload,
+        capacity);
+    if ((payload_size == 0u) || (payload_size >= total_size)) {
+      // Not worth it, send the payload raw.
+      header.codec = Codec::None;
+      std::memcpy(payload, source, total_size);
+      payload_size = total_size;
+    }
+    std::memcpy(message.data(), &header, sizeof(header));
+    message.reset(static_cast<uint64_t>(sizeof(header) + payload_size));
+    return message;
+  }
+
+  // ===========================================================================
+  // -- Decompressor -----------------------------------------------------------
+  // ===========================================================================
+
+  struct Decompressor::Context {
+#if LIBCARLA_STREAMING_WITH_ZSTD_SUPPORT
+    ZSTD_DCtx *zstd = nullptr;
+
+    ~Context() {
+      ZSTD_freeDCtx(zstd);
+    }
+#endif // LIBCARLA_STREAMING_WITH_ZSTD_SUPPORT
+
+    /// Returns false if @a source is not valid for @a codec or does not
+    /// decompress to exactly @a size bytes.
+    bool Decompress(
+        Codec codec,
+        const unsigned char *source,
+        size_t source_size,
+        unsigned char *destination,
+        size_t size) {
+      switch (codec) {
+        case Codec::None:
+          if (source_size != size) {
+            return false;
+          }
+          std::memcpy(destination, source, size);
+          return true;
+#if LIBCARLA_STREAMING_WITH_LZ4_SUPPORT
+        case Codec::LZ4:
+          return LZ4_decompress_safe(
+              reinterpret_cast<const char *>(source),
+              reinterpret_cast<char *>(destination),
+              static_cast<int>(source_size),
+              static_cast<int>(size)) == static_cast<int>(size);
+#endif
+#if LIBCARLA_STREAMING_WITH_ZSTD_SUPPORT
+        case Codec::Zstd: {
+          if (zstd == nullptr) {
+            zstd = ZSTD_createDCtx();
+          }
+          const size_t result = ZSTD_decompressDCtx(
+              zstd,
+              destination,
+              size,
+              source,
+              source_size);
+          return !ZSTD_isError(result) && (result == size);
+        }
+#endif
+        default:
+          return false;
+      }
+    }
+  };
+
+  Decompressor::Decompressor(
+      std::shared_ptr<BufferPool> buffer_pool,
+      message_size_type max_raw_size)
+    : _buffer_pool(std::move(buffer_pool)),
+      _max_raw_size(max_raw_size),
+      _context(std::make_unique<Context>()) {
+    DEBUG_ASSERT(_buffer_pool != nullptr);
+  }
+
+  Decompressor::~Decompressor() = default;
+
+  bool Decompressor::Decompress(Buffer &message) {
+    compression_header header;
+    if (message.size() < sizeof(header)) {
+      log_error("streaming client: compressed message too small:", message.size(), "bytes");
+      return false;
+    }
+    std::memcpy(&header, message.data(), sizeof(header));
+
+    const bool is_delta = (header.flags & compression_header::delta) != 0u;
+    if (is_delta && (
+          !_has_previous ||
+          (_previous_frame + 1u != header.frame) ||
+          (_previous.size() != header.raw_size))) {
+      log_debug("streaming client: missing reference of delta frame", header.frame, ", discarded");
+      _has_previous = false;
+      return false;
+    }
+
+    // The header comes from the network, bound the allocation it asks for.
+    if (header.raw_size > _max_raw_size) {
+      log_error("streaming client: compressed frame", header.frame, "too big:", header.raw_size, "bytes");
+      _has_previous = false;
+      return false;
+    }
+
+    auto result = _buffer_pool->Pop(header.raw_size);
+    const bool succeeded = _context->Decompress(
+        header.codec,
+        message.data() + sizeof(header),
+        message.size() - sizeof(header),
+        result.data(),
+        header.raw_size);
+    if (!succeeded) {
+      log_error("streaming client: failed to decompress frame", header.frame);
+      _has_previous = false;
+      return false;
+    }
+
+    if (is_delta) {
+      ApplyDelta(result.data(), _previous.data(), result.size());
+    } else if ((header.flags & compression_header::reference) != 0u) {
+      _previous.copy_from(result.data(), result.size());
+    }
+    _has_previous = (header.flags & compression_header::reference) != 0u;
+    _previous_frame = header.frame;
+
+    message = std::move(result);
+    return true;
+  }
+
+} // namespace detail
+} // namespace streaming
+} // namespace carla
@@ -0,0 +1,212 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/Buffer.h"
+#include "carla/NonCopyable.h"
+#include "carla/streaming/detail/Types.h"
+
+#include <boost/asio/buffer.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace carla {
+
+  class BufferPool;
+
+namespace streaming {
+namespace detail {
+
+  /// Compression applied to the payload of the messages of a stream.
+  enum class Codec : uint8_t {
+    None = 0u,
+    /// Fast, for streams that saturate the network but not the CPU.
+    LZ4 = 1u,
+    /// Slower, with a much better ratio.
+    Zstd = 2u
+  };
+
+  /// Bit mask of codecs, one bit per Codec value.
+  using codec_mask_type = uint8_t;
+
+  constexpr codec_mask_type ToCodecMask(Codec codec) {
+    return codec == Codec::None ?
+        codec_mask_type(0u) :
+        static_cast<codec_mask_type>(1u << (static_cast<uint8_t>(codec) - 1u));
+  }
+
+  /// Codecs this build of LibCarla is able to compress and decompress.
+  codec_mask_type GetSupportedCodecs();
+
+  inline bool IsCodecSupported(Codec codec) {
+    return codec == Codec::None || (GetSupportedCodecs() & ToCodecMask(codec)) != 0u;
+  }
+
+  /// Compression settings of a stream. Streams are not compressed by default.
+  struct CompressionSettings {
+    Codec codec = Codec::None;
+
+    /// Compression level for zstd, acceleration factor for LZ4. Zero selects
+    /// the default of each codec.
+    int level = 0;
+
+    /// Send each frame as the difference against the previous one, if both
+    /// have the same size. Mostly pays off with images where few pixels change
+    /// between frames, like semantic segmentation.
+    bool delta = false;
+
+    /// In delta mode, number of frames between two full frames. A client that
+    /// misses a frame (e.g., a session dropping messages) skips the following
+    /// ones until the next full frame.
+    uint32_t keyframe_interval = 30u;
+  };
+
+  /// Set in the stream id a client sends to subscribe when it is followed by
+  /// the codecs the client accepts. Without it, the stream id alone is the
+  /// whole handshake and the session is not compressed, which is what servers
+  /// without compression support expect. Such servers reject a stream id with
+  /// this flag, and the client falls back to the plain handshake.
+  static constexpr stream_id_type NEGOTIATE_CODEC_FLAG = stream_id_type(1u) << 31u;
+
+#pragma pack(push, 1)
+
+  /// Sent by the client right after connecting to subscribe to a stream. Only
+  /// the stream id is sent unless it carries NEGOTIATE_CODEC_FLAG.
+  struct session_request {
+    stream_id_type stream_id = 0u;
+
+    /// Codecs the client can decompress.
+    codec_mask_type codecs = 0u;
+  };
+
+  /// Sent by the server in front of the first message of a session that
+  /// negotiated its codec, the codec chosen for the session.
+  struct session_reply {
+    Codec codec = Codec::None;
+  };
+
+  /// Prepended to every message of a session with a codec. The payload may
+  /// still be raw if it did not compress.
+  struct compression_header {
+    enum flags : uint8_t {
+      none = 0u,
+      /// The payload is the XOR of this frame with the previous one.
+      delta = 1u,
+      /// The stream is in delta mode, the client keeps this frame to apply the
+      /// next delta on.
+      reference = 2u
+    };
+
+    Codec codec = Codec::None;
+
+    uint8_t flags = none;
+
+    /// Sequence number of the frame in the stream, to detect missing delta
+    /// frames.
+    uint32_t frame = 0u;
+
+    /// Size of the payload after decompression.
+    message_size_type raw_size = 0u;
+  };
+
+#pragma pack(pop)
+
+  /// Compresses the messages written to a stream with a single codec. Every
+  /// message is compressed once and shared by all the sessions using the same
+  /// codec.
+  class Compressor : private NonCopyable {
+  public:
+
+    Compressor(Codec codec, const CompressionSettings &settings);
+
+    ~Compressor();
+
+    Codec GetCodec() const {
+      return _codec;
+    }
+
+    /// Update level and delta settings; the next frame is a full frame.
+    void SetSettings(const CompressionSettings &settings);
+
+    /// Send the next frame complete, e.g. because a new session connected.
+    void RequestKeyframe();
+
+    /// Concatenates @a buffers and compresses them in a single pooled buffer,
+    /// prefixed with a compression_header.
+    Buffer Compress(const std::vector<boost::asio::const_buffer> &buffers);
+
+  private:
+
+    struct Context;
+
+    const Codec _codec;
+
+    std::mutex _mutex;
+
+    CompressionSettings _settings;
+
+    uint32_t _frame = 0u;
+
+    uint32_t _frames_since_keyframe = 0u;
+
+    bool _keyframe_requested = true;
+
+    /// Last frame written, only kept in delta mode.
+    Buffer _previous;
+
+    /// Concatenation or delta of the current frame.
+    Buffer _scratch;
+
+    const std::shared_ptr<BufferPool> _buffer_pool;
+
+    const std::unique_ptr<Context> _context;
+  };
+
+  /// Decompresses the messages of a session, in the order they are received.
+  class Decompressor : private NonCopyable {
+  public:
+
+    /// Largest message accepted by default, well above the biggest sensor
+    /// images.
+    static constexpr message_size_type DEFAULT_MAX_RAW_SIZE = 1u << 28u;
+
+    explicit Decompressor(
+        std::shared_ptr<BufferPool> buffer_pool,
+        message_size_type max_raw_size = DEFAULT_MAX_RAW_SIZE);
+
+    ~Decompressor();
+
+    /// Replaces @a message with its decompressed payload, in a buffer from the
+    /// pool. Returns false if the message has to be discarded, i.e. it is a
+    /// delta frame whose previous frame was never received, or it claims to
+    /// decompress to more than the maximum size given on construction.
+    bool Decompress(Buffer &message);
+
+  private:
+
+    struct Context;
+
+    const std::shared_ptr<BufferPool> _buffer_pool;
+
+    const message_size_type _max_raw_size;
+
+    const std::unique_ptr<Context> _context;
+
+    /// Last frame decoded, to apply delta frames on.
+    Buffer _previous;
+
+    uint32_t _previous_frame = 0u;
+
+    bool _has_previous = false;
+  };
+
+} // namespace detail
+} // namespace streaming
+} // namespace carla
@@ -9,6 +9,7 @@
 #include "carla/Exception.h"
 #include "carla/Logging.h"
 #include "carla/streaming/detail/MultiStreamState.h"
+#include "carla/streaming/detail/shm/Ring.h"
 
 #include <exception>
 
@@ -43,6 +44,7 @@ namespace detail {
     if (search == _stream_map.end()) {
       // creating new stream
       ptr = std::make_shared<MultiStreamState>(_cached_token);
+      ptr->SetCompression(_default_compression);
       auto result = _stream_map.emplace(std::make_pair(_cached_token.get_stream_id(), ptr));
       if (!result.second) {
         throw_exception(std::runtime_error("failed to create stream!"));
@@ -118,6 +120,7 @@ namespace detail {
       token_type temp_token(_cached_token);
       temp_token.set_stream_id(sensor_id);
       auto ptr = std::make_shared<MultiStreamState>(temp_token);
+      ptr->SetCompression(_default_compression);
       auto result = _stream_map.emplace(std::make_pair(temp_token.get_stream_id(), ptr));
       ptr->ForceActive();
       if (!result.second) {
@@ -129,6 +132,35 @@ namespace detail {
     return token_type();
   }
 
+  void Dispatcher::SetSharedMemoryTransport(bool enable) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (enable && !shm::IsSupported()) {
+      log_warning("shared memory streaming not supported on this platform, using TCP");
+      enable = false;
+    }
+    _cached_token.set_shared_memory(enable);
+  }
+
+  void Dispatcher::SetDefaultCompression(const CompressionSettings &settings) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (!IsCodecSupported(settings.codec)) {
+      log_warning("streaming codec", static_cast<int>(settings.codec), "not supported by this build, streams not compressed");
+      _default_compression = CompressionSettings{};
+      return;
+    }
+    _default_compression = settings;
+  }
+
+  void Dispatcher::SetCompression(
+      stream_id_type sensor_id,
+      const CompressionSettings &settings) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto search = _stream_map.find(sensor_id);
+    if (search != _stream_map.end()) {
+      search->second->SetCompression(settings);
+    }
+  }
+
 } // namespace detail
 } // namespace streaming
 } // namespace carla
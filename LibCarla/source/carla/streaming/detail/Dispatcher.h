@@ -8,6 +8,7 @@
 
 #include "carla/streaming/EndPoint.h"
 #include "carla/streaming/Stream.h"
+#include "carla/streaming/detail/Compression.h"
 #include "carla/streaming/detail/Session.h"
 #include "carla/streaming/detail/Stream.h"
 #include "carla/streaming/detail/Token.h"
@@ -43,6 +44,17 @@ namespace detail {
 
     token_type GetToken(stream_id_type sensor_id);
 
+    /// Publish the streams created from now on also through shared memory,
+    /// for the clients on the same host.
+    void SetSharedMemoryTransport(bool enable);
+
+    /// Compression of the streams created from now on.
+    void SetDefaultCompression(const CompressionSettings &settings);
+
+    /// Compression of the stream @a sensor_id, for the sessions opened from
+    /// now on.
+    void SetCompression(stream_id_type sensor_id, const CompressionSettings &settings);
+
     void EnableForROS(stream_id_type sensor_id) {
       auto search = _stream_map.find(sensor_id);
       if (search != _stream_map.end()) {
@@ -73,6 +85,8 @@ namespace detail {
 
     token_type _cached_token;
 
+    CompressionSettings _default_compression;
+
     StreamMap _stream_map;
   };
 
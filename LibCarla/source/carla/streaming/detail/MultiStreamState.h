@@ -8,12 +8,17 @@
 
 #include "carla/AtomicSharedPtr.h"
 #include "carla/Logging.h"
+#include "carla/streaming/detail/Compression.h"
 #include "carla/streaming/detail/StreamStateBase.h"
+#include "carla/streaming/detail/shm/Publisher.h"
 #include "carla/streaming/detail/tcp/Message.h"
 
+#include <array>
+#include <initializer_list>
 #include <mutex>
 #include <vector>
 #include <atomic>
+#include <memory>
 
 namespace carla {
 namespace streaming {
@@ -29,16 +34,29 @@ namespace detail {
 
     MultiStreamState(const token_type &token) :
       StreamStateBase(token),
-      _session(nullptr)
+      _session(nullptr),
+      _shared_memory(token.protocol_is_shared_memory() ?
+          std::make_unique<shm::Publisher>(token) :
+          nullptr)
       {};
 
     template <typename... Buffers>
     void Write(Buffers... buffers) {
+      SetMessageSizeHint(GetTotalSize(buffers...));
+
+      // publish once for all the clients on this host
+      if (_shared_memory != nullptr && _shared_memory->HasReaders()) {
+        _shared_memory->Publish(*Session::MakeMessage(buffers...));
+      }
+
       // try write single stream
       auto session = _session.load();
       if (session != nullptr) {
-        auto message = Session::MakeMessage(buffers...);
-        session->Write(std::move(message));
+        if (session->get_codec() == Codec::None) {
+          session->Write(Session::MakeMessage(buffers...));
+        } else {
+          session->Write(MakeCompressedMessage(session->get_codec(), buffers...));
+        }
         log_debug("sensor ", session->get_stream_id()," data sent");
         // Return here, _session is only valid if we have a
         // single session.
@@ -48,9 +66,17 @@ namespace detail {
       // try write multiple stream
       std::lock_guard<std::mutex> lock(_mutex);
       if (_sessions.size() > 0) {
-        auto message = Session::MakeMessage(buffers...);
+        // Each message is built once per codec and shared by its sessions.
+        std::array<std::shared_ptr<const tcp::Message>, NumberOfCodecs> messages;
         for (auto &s : _sessions) {
           if (s != nullptr) {
+            const auto codec = s->get_codec();
+            auto &message = messages[static_cast<size_t>(codec)];
+            if (message == nullptr) {
+              message = codec == Codec::None ?
+                  Session::MakeMessage(buffers...) :
+                  MakeCompressedMessage(codec, buffers...);
+            }
             s->Write(message);
             log_debug("sensor ", s->get_stream_id()," data sent ");
          }
@@ -58,6 +84,22 @@ namespace detail {
       }
     }
 
+    /// Compress the messages of the sessions opened from now on, if their
+    /// client supports the codec. Sessions already opened keep their codec.
+    void SetCompression(const CompressionSettings &settings) {
+      std::lock_guard<std::mutex> lock(_mutex);
+      if (!IsCodecSupported(settings.codec)) {
+        log_warning("streaming codec", static_cast<int>(settings.codec), "not supported by this build, stream not compressed");
+        _compression = CompressionSettings{};
+        return;
+      }
+      _compression = settings;
+      auto &compressor = _compressors[static_cast<size_t>(settings.codec)];
+      if (compressor != nullptr) {
+        compressor->SetSettings(settings);
+      }
+    }
+
     void ForceActive() {
       _force_active = true;
     }
@@ -75,12 +117,14 @@ namespace detail {
     }
 
     bool AreClientsListening() {
-      return (_sessions.size() > 0 || _force_active || _enabled_for_ros);
+      return (_sessions.size() > 0 || _force_active || _enabled_for_ros ||
+          (_shared_memory != nullptr && _shared_memory->HasReaders()));
     }
 
     void ConnectSession(std::shared_ptr<Session> session) final {
       DEBUG_ASSERT(session != nullptr);
       std::lock_guard<std::mutex> lock(_mutex);
+      NegotiateCodec(*session);
       _sessions.emplace_back(std::move(session));
       log_debug("Connecting multistream sessions:", _sessions.size());
       if (_sessions.size() == 1) {
@@ -131,6 +175,41 @@ namespace detail {
 
   private:
 
+    template <typename... Buffers>
+    static size_t GetTotalSize(const Buffers &... buffers) {
+      size_t total = 0u;
+      for (const size_t size : std::initializer_list<size_t>{buffers->size()...}) {
+        total += size;
+      }
+      return total;
+    }
+
+    static constexpr size_t NumberOfCodecs = 3u;
+
+    /// Must be called with the mutex locked, before the session is written.
+    void NegotiateCodec(Session &session) {
+      const auto codec = _compression.codec;
+      if ((codec == Codec::None) ||
+          ((session.get_accepted_codecs() & ToCodecMask(codec)) == 0u)) {
+        return;
+      }
+      session.SetCodec(codec);
+      auto &compressor = _compressors[static_cast<size_t>(codec)];
+      if (compressor == nullptr) {
+        compressor = std::make_shared<Compressor>(codec, _compression);
+      }
+      // The new client has no previous frame to apply deltas on.
+      compressor->RequestKeyframe();
+    }
+
+    template <typename... Buffers>
+    std::shared_ptr<const tcp::Message> MakeCompressedMessage(Codec codec, Buffers... buffers) {
+      auto compressor = _compressors[static_cast<size_t>(codec)];
+      DEBUG_ASSERT(compressor != nullptr);
+      auto buffer = compressor->Compress({buffers->cbuffer()...});
+      return Session::MakeMessage(BufferView::CreateFrom(std::move(buffer)));
+    }
+
     std::mutex _mutex;
 
     // if there is only one session, then we use atomic
@@ -139,6 +218,12 @@ namespace detail {
     std::vector<std::shared_ptr<Session>> _sessions;
     bool _force_active {false};
     bool _enabled_for_ros {false};
+    // only if the token selects the shared memory transport
+    const std::unique_ptr<shm::Publisher> _shared_memory;
+    CompressionSettings _compression;
+    // one per codec negotiated by a session, indexed by codec; never reset, so
+    // the single session path reads them without locking
+    std::array<std::shared_ptr<Compressor>, NumberOfCodecs> _compressors;
   };
 
 } // namespace detail
@@ -9,6 +9,7 @@
 #include "carla/Buffer.h"
 #include "carla/Debug.h"
 #include "carla/streaming/Token.h"
+#include "carla/streaming/detail/Compression.h"
 
 #include <memory>
 
@@ -41,12 +42,20 @@ namespace detail {
     ///
     /// @note Re-using buffers is optimized for the use case in which all the
     /// messages sent through the stream are big and have (approximately) the
-    /// same size.
+    /// same size, the buffer is sized after the last message written.
     Buffer MakeBuffer() {
       auto state = _shared_state;
       return state->MakeBuffer();
     }
 
+    /// Pull a buffer of @a size bytes from the buffer pool associated to this
+    /// stream. Prefer this overload when the size is known in advance, the pool
+    /// reuses buffers of a similar size.
+    Buffer MakeBuffer(size_t size) {
+      auto state = _shared_state;
+      return state->MakeBuffer(size);
+    }
+
     /// Flush @a buffers down the stream. No copies are made.
     template <typename... Buffers>
     void Write(Buffers &&... buffers) {
@@ -62,6 +71,12 @@ namespace detail {
       return *this;
     }
 
+    /// Compress the data sent to the clients subscribing from now on, if they
+    /// support @a settings.codec.
+    void SetCompression(const CompressionSettings &settings) {
+      _shared_state->SetCompression(settings);
+    }
+
     bool AreClientsListening()
     {
       return _shared_state ? _shared_state->AreClientsListening() : false;
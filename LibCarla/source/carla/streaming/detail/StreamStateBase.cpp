@@ -20,7 +20,13 @@ namespace detail {
 
   Buffer StreamStateBase::MakeBuffer() {
     auto pool = _buffer_pool;
-    return pool->Pop();
+    const size_t size = _message_size_hint.load(std::memory_order_relaxed);
+    return size > 0u ? pool->Pop(size) : pool->Pop();
+  }
+
+  Buffer StreamStateBase::MakeBuffer(size_t size) {
+    auto pool = _buffer_pool;
+    return pool->Pop(size);
   }
 
 } // namespace detail
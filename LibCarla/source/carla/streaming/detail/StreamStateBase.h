@@ -10,6 +10,8 @@
 #include "carla/streaming/detail/Session.h"
 #include "carla/streaming/detail/Token.h"
 
+#include <atomic>
+#include <cstddef>
 #include <memory>
 
 namespace carla {
@@ -32,19 +34,31 @@ namespace detail {
       return _token;
     }
 
+    /// Pops a buffer the size of the last message written, the messages of a
+    /// stream usually have similar sizes.
     Buffer MakeBuffer();
 
+    Buffer MakeBuffer(size_t size);
+
     virtual void ConnectSession(std::shared_ptr<Session> session) = 0;
 
     virtual void DisconnectSession(std::shared_ptr<Session> session) = 0;
 
     virtual void ClearSessions() = 0;
 
+  protected:
+
+    void SetMessageSizeHint(size_t size) {
+      _message_size_hint.store(size, std::memory_order_relaxed);
+    }
+
   private:
 
     const token_type _token;
 
     const std::shared_ptr<BufferPool> _buffer_pool;
+
+    std::atomic<size_t> _message_size_hint{0u};
   };
 
 } // namespace detail
@@ -29,7 +29,10 @@ namespace detail {
     enum class protocol : uint8_t {
       not_set,
       tcp,
-      udp
+      udp,
+      /// TCP stream also published to a shared memory segment for clients on
+      /// the same host.
+      shared_memory
     } protocol = protocol::not_set;
 
     enum class address : uint8_t {
@@ -155,6 +158,19 @@ namespace detail {
       return _token.protocol == token_data::protocol::tcp;
     }
 
+    bool protocol_is_shared_memory() const {
+      return _token.protocol == token_data::protocol::shared_memory;
+    }
+
+    /// Switches a TCP token to the shared memory transport, or back. The
+    /// endpoint is kept so clients on other hosts can still use TCP.
+    void set_shared_memory(bool enable) {
+      DEBUG_ASSERT(protocol_is_tcp() || protocol_is_shared_memory());
+      _token.protocol = enable ?
+          token_data::protocol::shared_memory :
+          token_data::protocol::tcp;
+    }
+
     template <typename Protocol>
     bool has_same_protocol(const boost::asio::ip::basic_endpoint<Protocol> &) const {
       return _token.protocol == get_protocol<Protocol>();
@@ -0,0 +1,152 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/streaming/detail/shm/Client.h"
+
+#include "carla/BufferPool.h"
+#include "carla/Debug.h"
+#include "carla/Logging.h"
+#include "carla/Time.h"
+#include "carla/streaming/detail/shm/Ring.h"
+
+#include <boost/asio/post.hpp>
+
+namespace carla {
+namespace streaming {
+namespace detail {
+namespace shm {
+
+  /// Maximum time between checks of the stop flag.
+  static const time_duration POLL_INTERVAL = time_duration::milliseconds(100u);
+
+  bool Client::IsAvailable(const token_type &token) {
+    return IsSupported() && (Ring::Open(MakeSegmentName(token)) != nullptr);
+  }
+
+  Client::Client(
+      boost::asio::io_context &io_context,
+      const token_type &token,
+      callback_function_type callback)
+    : LIBCARLA_INITIALIZE_LIFETIME_PROFILER(
+          std::string("shm client ") + std::to_string(token.get_stream_id())),
+      _token(token),
+      _segment_name(MakeSegmentName(token)),
+      _callback(std::move(callback)),
+      _strand(io_context),
+      _buffer_pool(std::make_shared<BufferPool>()) {}
+
+  Client::~Client() {
+    _done = true;
+    if (_thread.joinable()) {
+      // The reading thread may hold the last reference for a moment.
+      if (_thread.get_id() == std::this_thread::get_id()) {
+        _thread.detach();
+      } else {
+        _thread.join();
+      }
+    }
+  }
+
+  void Client::Connect() {
+    DEBUG_ASSERT(!_thread.joinable());
+    // The thread keeps the client alive until it is stopped.
+    _thread = std::thread([self=shared_from_this()]() { self->Run(); });
+  }
+
+  void Client::Stop() {
+    _done = true;
+    _callback_done.notify_all();
+  }
+
+  void Client::PostCallback(std::shared_ptr<Buffer> buffer) {
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _is_callback_pending = true;
+    }
+    boost::asio::post(_strand, [self=shared_from_this(), buffer]() {
+      if (!self->_done) {
+        self->_callback(std::move(*buffer));
+      }
+      {
+        std::lock_guard<std::mutex> lock(self->_mutex);
+        self->_is_callback_pending = false;
+      }
+      self->_callback_done.notify_all();
+    });
+  }
+
+  bool Client::WaitForCallback(const time_duration timeout) {
+    std::unique_lock<std::mutex> lock(_mutex);
+    return _callback_done.wait_for(lock, timeout.to_chrono(), [this]() {
+      return !_is_callback_pending || _done;
+    }) && !_is_callback_pending;
+  }
+
+  void Client::Run() {
+    std::unique_ptr<Ring> ring;
+    uint64_t next_sequence = 0u;
+    const uint64_t reader_id = Ring::MakeReaderId();
+    uint32_t reader = Ring::INVALID_READER;
+    while (!_done) {
+      if ((ring != nullptr) && ring->IsClosed()) {
+        // The stream was closed, wait for a server to publish it again.
+        ring->DetachReader(reader_id, reader);
+        ring = nullptr;
+        reader = Ring::INVALID_READER;
+      }
+      if ((ring == nullptr) || ring->IsReplaced()) {
+        auto new_ring = Ring::Open(_segment_name);
+        if ((new_ring == nullptr) || new_ring->IsClosed()) {
+          // The server is gone or replacing the segment, try again later.
+          std::this_thread::sleep_for(POLL_INTERVAL.to_chrono());
+          continue;
+        }
+        // Readers moving to a replacement segment keep their slot, and read
+        // it from its first message on. Otherwise, like a new TCP session,
+        // start with the next message.
+        const bool is_replacement = (ring != nullptr);
+        reader = new_ring->AttachReader(reader_id, reader);
+        log_debug("streaming client: reading", _segment_name);
+        ring = std::move(new_ring);
+        next_sequence = is_replacement ? 1u : ring->GetSequence() + 1u;
+        continue;
+      }
+      if ((reader != Ring::INVALID_READER) && !ring->Heartbeat(reader_id, reader)) {
+        // The publisher gave up on this reader, e.g. the process was stopped
+        // for longer than the reader timeout.
+        reader = ring->AttachReader(reader_id);
+      }
+
+      // A single message in flight, the callback gets the newest message
+      // published once it is done with the previous one.
+      if (!WaitForCallback(POLL_INTERVAL)) {
+        continue;
+      }
+      const uint32_t counter = ring->GetNotificationCounter();
+      const uint64_t last_sequence = ring->GetSequence();
+      if (last_sequence < next_sequence) {
+        ring->Wait(counter, POLL_INTERVAL);
+        continue;
+      }
+      if (last_sequence > next_sequence) {
+        log_debug("streaming client:", _segment_name, "too slow:", last_sequence - next_sequence, "messages discarded");
+      }
+      next_sequence = last_sequence + 1u;
+      auto buffer = std::make_shared<Buffer>(
+          _buffer_pool->Pop(ring->GetMessageSize(last_sequence)));
+      if (ring->Read(last_sequence, *buffer)) {
+        PostCallback(std::move(buffer));
+      }
+    }
+    if (ring != nullptr) {
+      ring->DetachReader(reader_id, reader);
+    }
+  }
+
+} // namespace shm
+} // namespace detail
+} // namespace streaming
+} // namespace carla
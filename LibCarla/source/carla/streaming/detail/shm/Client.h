@@ -0,0 +1,106 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/Buffer.h"
+#include "carla/NonCopyable.h"
+#include "carla/Time.h"
+#include "carla/profiler/LifetimeProfiled.h"
+#include "carla/streaming/detail/Token.h"
+#include "carla/streaming/detail/Types.h"
+
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/strand.hpp>
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace carla {
+
+  class BufferPool;
+
+namespace streaming {
+namespace detail {
+namespace shm {
+
+  /// A client that reads a single stream from the shared memory segment
+  /// published by a server on the same host. The segment is polled from a
+  /// dedicated thread that sleeps on the segment's futex, messages are passed
+  /// to the callback from the @a io_context one at a time; while the callback
+  /// runs, the messages published meanwhile are skipped but the newest.
+  ///
+  /// @warning This client should be stopped before releasing the shared pointer
+  /// or won't be destroyed.
+  class Client
+    : public std::enable_shared_from_this<Client>,
+      private profiler::LifetimeProfiled,
+      private NonCopyable {
+  public:
+
+    using callback_function_type = std::function<void (Buffer)>;
+
+    /// Whether the segment of the stream identified by @a token can be opened
+    /// from this process.
+    static bool IsAvailable(const token_type &token);
+
+    Client(
+        boost::asio::io_context &io_context,
+        const token_type &token,
+        callback_function_type callback);
+
+    ~Client();
+
+    void Connect();
+
+    stream_id_type GetStreamId() const {
+      return _token.get_stream_id();
+    }
+
+    void Stop();
+
+  private:
+
+    void Run();
+
+    /// Passes @a buffer to the callback in the @a io_context, and wakes up the
+    /// reading thread once it returns.
+    void PostCallback(std::shared_ptr<Buffer> buffer);
+
+    /// Waits until the callback posted returns or @a timeout expires. Returns
+    /// whether the callback is done.
+    bool WaitForCallback(time_duration timeout);
+
+    const token_type _token;
+
+    const std::string _segment_name;
+
+    callback_function_type _callback;
+
+    boost::asio::io_context::strand _strand;
+
+    std::shared_ptr<BufferPool> _buffer_pool;
+
+    std::atomic_bool _done{false};
+
+    std::mutex _mutex;
+
+    std::condition_variable _callback_done;
+
+    bool _is_callback_pending = false;
+
+    std::thread _thread;
+  };
+
+} // namespace shm
+} // namespace detail
+} // namespace streaming
+} // namespace carla
@@ -0,0 +1,101 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/streaming/detail/shm/Publisher.h"
+
+#include "carla/Logging.h"
+#include "carla/Time.h"
+
+#include <exception>
+
+namespace carla {
+namespace streaming {
+namespace detail {
+namespace shm {
+
+  /// Interval between checks for readers that died without detaching.
+  static const time_duration RECLAIM_INTERVAL = time_duration::seconds(1u);
+
+  /// Time after which a reader that stopped sending heartbeats is considered
+  /// gone. Clients send one at least every 100 ms.
+  static const time_duration READER_TIMEOUT = time_duration::seconds(5u);
+
+  static uint32_t NextPowerOfTwo(uint32_t size) {
+    uint32_t capacity = Publisher::INITIAL_SLOT_CAPACITY;
+    while (capacity < size) {
+      capacity *= 2u;
+    }
+    return capacity;
+  }
+
+  Publisher::Publisher(const token_type &token)
+    : _name(MakeSegmentName(token)) {
+#ifndef LIBCARLA_NO_EXCEPTIONS
+    try {
+#endif // LIBCARLA_NO_EXCEPTIONS
+      _ring = Ring::Create(_name, NUMBER_OF_SLOTS, INITIAL_SLOT_CAPACITY);
+#ifndef LIBCARLA_NO_EXCEPTIONS
+    } catch (const std::exception &e) {
+      // Local clients fall back to TCP when the segment is missing.
+      log_error("streaming server:", e.what());
+    }
+#endif // LIBCARLA_NO_EXCEPTIONS
+  }
+
+  Publisher::~Publisher() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_ring != nullptr) {
+      _ring->Invalidate(false);
+    }
+  }
+
+  bool Publisher::HasReaders() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_ring == nullptr) {
+      return false;
+    }
+    const auto now = std::chrono::steady_clock::now();
+    if (now - _last_reclaim >= RECLAIM_INTERVAL.to_chrono()) {
+      _last_reclaim = now;
+      _ring->ReclaimReaders(READER_TIMEOUT);
+    }
+    return _ring->GetNumberOfReaders() > 0u;
+  }
+
+  void Publisher::Publish(const tcp::Message &message) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_ring == nullptr) {
+      return;
+    }
+    if (message.size() > _ring->GetSlotCapacity()) {
+      // Free the name for the new ring, the readers still hold the old one
+      // until they are told to open the new one.
+      _ring->Unlink();
+#ifndef LIBCARLA_NO_EXCEPTIONS
+      try {
+#endif // LIBCARLA_NO_EXCEPTIONS
+        auto ring = Ring::Create(_name, NUMBER_OF_SLOTS, NextPowerOfTwo(message.size()));
+        // The readers of the old ring move to the new one without attaching
+        // again.
+        ring->CopyReaders(*_ring);
+        _ring->Invalidate(true);
+        _ring = std::move(ring);
+#ifndef LIBCARLA_NO_EXCEPTIONS
+      } catch (const std::exception &e) {
+        log_error("streaming server:", e.what());
+        _ring->Invalidate(false);
+        _ring = nullptr;
+        return;
+      }
+#endif // LIBCARLA_NO_EXCEPTIONS
+    }
+    _ring->Publish(message);
+  }
+
+} // namespace shm
+} // namespace detail
+} // namespace streaming
+} // namespace carla
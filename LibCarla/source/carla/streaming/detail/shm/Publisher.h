@@ -0,0 +1,60 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/NonCopyable.h"
+#include "carla/streaming/detail/Token.h"
+#include "carla/streaming/detail/shm/Ring.h"
+#include "carla/streaming/detail/tcp/Message.h"
+
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace carla {
+namespace streaming {
+namespace detail {
+namespace shm {
+
+  /// Server side of the shared memory transport of a stream. Owns the ring of
+  /// the stream and replaces it by a bigger one when a message does not fit.
+  class Publisher : private NonCopyable {
+  public:
+
+    /// Number of messages kept in the ring, readers further behind skip
+    /// messages.
+    static constexpr uint32_t NUMBER_OF_SLOTS = 4u;
+
+    /// Capacity of the slots of a new ring, grows with the messages.
+    static constexpr uint32_t INITIAL_SLOT_CAPACITY = 64u * 1024u;
+
+    explicit Publisher(const token_type &token);
+
+    ~Publisher();
+
+    /// Whether any client reads the segment. Readers that died without
+    /// detaching still count until their heartbeat times out.
+    bool HasReaders();
+
+    void Publish(const tcp::Message &message);
+
+  private:
+
+    std::mutex _mutex;
+
+    const std::string _name;
+
+    std::unique_ptr<Ring> _ring;
+
+    std::chrono::steady_clock::time_point _last_reclaim;
+  };
+
+} // namespace shm
+} // namespace detail
+} // namespace streaming
+} // namespace carla
@@ -0,0 +1,433 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/streaming/detail/shm/Ring.h"
+
+#include "carla/Debug.h"
+#include "carla/Exception.h"
+#include "carla/Logging.h"
+
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <cstring>
+#include <exception>
+#include <iterator>
+#include <new>
+#include <random>
+#include <thread>
+
+#if defined(__linux__)
+#  include <fcntl.h>
+#  include <linux/futex.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <sys/syscall.h>
+#  include <time.h>
+#  include <unistd.h>
+#endif
+
+namespace carla {
+namespace streaming {
+namespace detail {
+namespace shm {
+
+  static_assert(ATOMIC_INT_LOCK_FREE == 2, "Shared atomics must be lock-free");
+  static_assert(ATOMIC_LLONG_LOCK_FREE == 2, "Shared atomics must be lock-free");
+
+  constexpr uint32_t Ring::MAX_NUMBER_OF_READERS;
+
+  constexpr uint32_t Ring::INVALID_READER;
+
+  static constexpr uint32_t MAGIC = 0x4D485343u; // "CSHM"
+
+  static constexpr uint32_t VERSION = 3u;
+
+  static constexpr size_t ALIGNMENT = 64u;
+
+  enum State : uint32_t {
+    OPEN,
+    REPLACED,
+    CLOSED
+  };
+
+  /// Identifier of the reader holding the slot, 0 if free, and a counter the
+  /// reader increments while it is alive.
+  struct Ring::ReaderSlot {
+    std::atomic<uint64_t> id;
+    std::atomic<uint64_t> heartbeat;
+  };
+
+  struct Ring::Header {
+    std::atomic<uint32_t> magic;
+    uint32_t version;
+    uint32_t number_of_slots;
+    uint32_t slot_capacity;
+    alignas(ALIGNMENT) std::atomic<uint64_t> sequence;
+    std::atomic<uint32_t> notification_counter;
+    std::atomic<uint32_t> number_of_waiters;
+    std::atomic<uint32_t> state;
+    alignas(ALIGNMENT) ReaderSlot readers[MAX_NUMBER_OF_READERS];
+  };
+
+  /// The message data follows the slot header. The publisher increments
+  /// @a begin before writing the data and @a end after, a copy is valid if
+  /// both match the expected sequence number.
+  struct Ring::Slot {
+    std::atomic<uint64_t> begin;
+    std::atomic<uint64_t> end;
+    std::atomic<uint32_t> size;
+  };
+
+  static constexpr size_t RoundUp(size_t size) {
+    return (size + ALIGNMENT - 1u) / ALIGNMENT * ALIGNMENT;
+  }
+
+  static constexpr size_t HEADER_SIZE = RoundUp(sizeof(Ring::Header));
+
+  static constexpr size_t SLOT_HEADER_SIZE = RoundUp(sizeof(Ring::Slot));
+
+  static size_t GetSlotStride(uint32_t slot_capacity) {
+    return SLOT_HEADER_SIZE + RoundUp(slot_capacity);
+  }
+
+  static size_t GetSegmentSize(uint32_t number_of_slots, uint32_t slot_capacity) {
+    return HEADER_SIZE + number_of_slots * GetSlotStride(slot_capacity);
+  }
+
+  std::string MakeSegmentName(const token_type &token) {
+    return "/carla-streaming-" +
+        std::to_string(token.get_port()) + "-" +
+        std::to_string(token.get_stream_id());
+  }
+
+#if defined(__linux__)
+
+  bool IsSupported() {
+    return true;
+  }
+
+  static void FutexWait(std::atomic<uint32_t> &word, uint32_t expected, time_duration timeout) {
+    timespec ts;
+    ts.tv_sec = static_cast<time_t>(timeout.milliseconds() / 1000u);
+    ts.tv_nsec = static_cast<long>((timeout.milliseconds() % 1000u) * 1000000u);
+    // Not FUTEX_PRIVATE_FLAG, the word is shared between processes.
+    syscall(SYS_futex, reinterpret_cast<uint32_t *>(&word), FUTEX_WAIT, expected, &ts, nullptr, 0);
+  }
+
+  static void FutexWakeAll(std::atomic<uint32_t> &word) {
+    syscall(SYS_futex, reinterpret_cast<uint32_t *>(&word), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+  }
+
+  std::unique_ptr<Ring> Ring::Create(
+      const std::string &name,
+      const uint32_t number_of_slots,
+      const uint32_t slot_capacity) {
+    DEBUG_ASSERT(number_of_slots > 0u);
+    const size_t size = GetSegmentSize(number_of_slots, slot_capacity);
+    // Remove any segment left behind by a previous server.
+    shm_unlink(name.c_str());
+    const int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, S_IRUSR | S_IWUSR);
+    if (fd == -1) {
+      throw_exception(std::runtime_error("failed to create shared memory segment " + name));
+    }
+    if (ftruncate(fd, static_cast<off_t>(size)) != 0) {
+      close(fd);
+      shm_unlink(name.c_str());
+      throw_exception(std::runtime_error("failed to allocate shared memory segment " + name));
+    }
+    void *data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+      shm_unlink(name.c_str());
+      throw_exception(std::runtime_error("failed to map shared memory segment " + name));
+    }
+    std::unique_ptr<Ring> ring(new Ring(name, data, size, true));
+    Header *header = new (data) Header;
+    header->version = VERSION;
+    header->number_of_slots = number_of_slots;
+    header->slot_capacity = slot_capacity;
+    header->sequence.store(0u);
+    header->notification_counter.store(0u);
+    header->number_of_waiters.store(0u);
+    header->state.store(OPEN);
+    for (auto &reader : header->readers) {
+      new (&reader) ReaderSlot;
+      reader.id.store(0u);
+      reader.heartbeat.store(0u);
+    }
+    for (auto i = 0u; i < number_of_slots; ++i) {
+      Slot *slot = new (&ring->GetSlot(i)) Slot;
+      slot->begin.store(0u);
+      slot->end.store(0u);
+      slot->size.store(0u);
+    }
+    // Readers ignore the segment until the magic number is set.
+    header->magic.store(MAGIC, std::memory_order_release);
+    log_debug("created shared memory segment", name, "of", size, "bytes");
+    return ring;
+  }
+
+  std::unique_ptr<Ring> Ring::Open(const std::string &name) {
+    const int fd = shm_open(name.c_str(), O_RDWR, 0);
+    if (fd == -1) {
+      return nullptr;
+    }
+    struct stat status;
+    if ((fstat(fd, &status) != 0) || (static_cast<size_t>(status.st_size) < HEADER_SIZE)) {
+      close(fd);
+      return nullptr;
+    }
+    const size_t size = static_cast<size_t>(status.st_size);
+    void *data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+      return nullptr;
+    }
+    std::unique_ptr<Ring> ring(new Ring(name, data, size, false));
+    const Header &header = *ring->_header;
+    if ((header.magic.load(std::memory_order_acquire) != MAGIC) ||
+        (header.version != VERSION) ||
+        (header.number_of_slots == 0u) ||
+        (GetSegmentSize(header.number_of_slots, header.slot_capacity) > size)) {
+      return nullptr;
+    }
+    return ring;
+  }
+
+  Ring::~Ring() {
+    munmap(_data, _size);
+    if (_is_owner) {
+      shm_unlink(_name.c_str());
+    }
+  }
+
+  void Ring::Unlink() {
+    if (_is_owner) {
+      shm_unlink(_name.c_str());
+      _is_owner = false;
+    }
+  }
+
+  void Ring::Wait(const uint32_t counter, const time_duration timeout) {
+    ++_header->number_of_waiters;
+    if (_header->notification_counter == counter) {
+      FutexWait(_header->notification_counter, counter, timeout);
+    }
+    --_header->number_of_waiters;
+  }
+
+  void Ring::Invalidate(const bool replaced) {
+    _header->state.store(replaced ? REPLACED : CLOSED, std::memory_order_release);
+    ++_header->notification_counter;
+    FutexWakeAll(_header->notification_counter);
+  }
+
+  void Ring::Publish(const tcp::Message &message) {
+    DEBUG_ASSERT(message.size() <= GetSlotCapacity());
+    const uint64_t sequence = _header->sequence.load(std::memory_order_relaxed) + 1u;
+    Slot &slot = GetSlot(sequence);
+    slot.begin.store(sequence, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    auto *cursor = reinterpret_cast<unsigned char *>(&slot) + SLOT_HEADER_SIZE;
+    auto sequence_of_buffers = message.GetBufferSequence();
+    // Skip the size header used by the TCP transport.
+    for (auto it = std::next(sequence_of_buffers.begin()); it != sequence_of_buffers.end(); ++it) {
+      std::memcpy(cursor, it->data(), it->size());
+      cursor += it->size();
+    }
+    slot.size.store(message.size(), std::memory_order_relaxed);
+    slot.end.store(sequence, std::memory_order_release);
+    _header->sequence.store(sequence, std::memory_order_release);
+    ++_header->notification_counter;
+    if (_header->number_of_waiters > 0u) {
+      FutexWakeAll(_header->notification_counter);
+    }
+  }
+
+  uint32_t Ring::AttachReader(const uint64_t id, const uint32_t reader) {
+    DEBUG_ASSERT(id != 0u);
+    if ((reader < MAX_NUMBER_OF_READERS) && (_header->readers[reader].id == id)) {
+      return reader;
+    }
+    for (auto i = 0u; i < MAX_NUMBER_OF_READERS; ++i) {
+      uint64_t expected = 0u;
+      if (_header->readers[i].id.compare_exchange_strong(expected, id)) {
+        return i;
+      }
+    }
+    log_warning("shared memory segment", _name, "has too many readers");
+    return INVALID_READER;
+  }
+
+  uint32_t Ring::ReclaimReaders(const time_duration timeout) {
+    const auto now = std::chrono::steady_clock::now();
+    uint32_t count = 0u;
+    for (auto i = 0u; i < MAX_NUMBER_OF_READERS; ++i) {
+      ReaderSlot &reader = _header->readers[i];
+      ReaderLease &lease = _leases[i];
+      uint64_t id = reader.id;
+      const uint64_t heartbeat = reader.heartbeat;
+      if ((id != lease.id) || (heartbeat != lease.heartbeat)) {
+        // New reader or renewed lease.
+        lease.id = id;
+        lease.heartbeat = heartbeat;
+        lease.renewed = now;
+      } else if ((id != 0u) &&
+                 (now - lease.renewed >= timeout.to_chrono()) &&
+                 reader.id.compare_exchange_strong(id, 0u)) {
+        log_debug("shared memory segment", _name, "freed the slot of unresponsive reader", i);
+        lease.id = 0u;
+        ++count;
+      }
+    }
+    return count;
+  }
+
+#else
+
+  bool IsSupported() {
+    return false;
+  }
+
+  std::unique_ptr<Ring> Ring::Create(const std::string &name, uint32_t, uint32_t) {
+    throw_exception(std::runtime_error(
+        "failed to create shared memory segment " + name + ": not supported on this platform"));
+  }
+
+  std::unique_ptr<Ring> Ring::Open(const std::string &) {
+    return nullptr;
+  }
+
+  Ring::~Ring() = default;
+
+  void Ring::Unlink() {}
+
+  void Ring::Wait(uint32_t, const time_duration timeout) {
+    std::this_thread::sleep_for(timeout.to_chrono());
+  }
+
+  void Ring::Invalidate(bool) {}
+
+  void Ring::Publish(const tcp::Message &) {}
+
+  uint32_t Ring::AttachReader(uint64_t, uint32_t) {
+    return INVALID_READER;
+  }
+
+  uint32_t Ring::ReclaimReaders(time_duration) {
+    return 0u;
+  }
+
+#endif // __linux__
+
+  Ring::Ring(std::string name, void *data, size_t size, bool is_owner)
+    : _name(std::move(name)),
+      _data(data),
+      _size(size),
+      _is_owner(is_owner),
+      _header(reinterpret_cast<Header *>(data)) {}
+
+  Ring::Slot &Ring::GetSlot(const uint64_t sequence) const {
+    const size_t index = static_cast<size_t>(sequence % _header->number_of_slots);
+    auto *slot = reinterpret_cast<unsigned char *>(_data) +
+        HEADER_SIZE + index * GetSlotStride(_header->slot_capacity);
+    return *reinterpret_cast<Slot *>(slot);
+  }
+
+  uint32_t Ring::GetNumberOfSlots() const {
+    return _header->number_of_slots;
+  }
+
+  uint32_t Ring::GetSlotCapacity() const {
+    return _header->slot_capacity;
+  }
+
+  uint64_t Ring::GetSequence() const {
+    return _header->sequence.load(std::memory_order_acquire);
+  }
+
+  uint32_t Ring::GetNumberOfReaders() const {
+    uint32_t count = 0u;
+    for (const auto &reader : _header->readers) {
+      if (reader.id != 0u) {
+        ++count;
+      }
+    }
+    return count;
+  }
+
+  uint64_t Ring::MakeReaderId() {
+    std::random_device device;
+    uint64_t id = 0u;
+    while (id == 0u) {
+      id = (static_cast<uint64_t>(device()) << 32u) | device();
+    }
+    return id;
+  }
+
+  void Ring::CopyReaders(const Ring &other) {
+    for (auto i = 0u; i < MAX_NUMBER_OF_READERS; ++i) {
+      _header->readers[i].heartbeat = other._header->readers[i].heartbeat.load();
+      _header->readers[i].id = other._header->readers[i].id.load();
+    }
+  }
+
+  bool Ring::Heartbeat(const uint64_t id, const uint32_t reader) {
+    if ((reader >= MAX_NUMBER_OF_READERS) || (_header->readers[reader].id != id)) {
+      return false;
+    }
+    _header->readers[reader].heartbeat.fetch_add(1u, std::memory_order_relaxed);
+    return true;
+  }
+
+  void Ring::DetachReader(const uint64_t id, const uint32_t reader) {
+    if (reader < MAX_NUMBER_OF_READERS) {
+      // Leave the slot alone if it was reclaimed and taken by another reader.
+      uint64_t expected = id;
+      _header->readers[reader].id.compare_exchange_strong(expected, 0u);
+    }
+  }
+
+  bool Ring::IsReplaced() const {
+    return _header->state.load(std::memory_order_acquire) == REPLACED;
+  }
+
+  bool Ring::IsClosed() const {
+    return _header->state.load(std::memory_order_acquire) == CLOSED;
+  }
+
+  uint32_t Ring::GetNotificationCounter() const {
+    return _header->notification_counter;
+  }
+
+  uint32_t Ring::GetMessageSize(const uint64_t sequence) const {
+    return std::min(GetSlot(sequence).size.load(std::memory_order_relaxed), GetSlotCapacity());
+  }
+
+  bool Ring::Read(const uint64_t sequence, Buffer &buffer) const {
+    const Slot &slot = GetSlot(sequence);
+    if (slot.end.load(std::memory_order_acquire) != sequence) {
+      return false;
+    }
+    const uint32_t size = slot.size.load(std::memory_order_relaxed);
+    if ((size == 0u) || (size > GetSlotCapacity())) {
+      return false;
+    }
+    buffer.reset(size);
+    std::memcpy(
+        buffer.data(),
+        reinterpret_cast<const unsigned char *>(&slot) + SLOT_HEADER_SIZE,
+        size);
+    // Discard the copy if the publisher started overwriting the slot.
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return slot.begin.load(std::memory_order_relaxed) == sequence;
+  }
+
+} // namespace shm
+} // namespace detail
+} // namespace streaming
+} // namespace carla
@@ -0,0 +1,177 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/Buffer.h"
+#include "carla/NonCopyable.h"
+#include "carla/Time.h"
+#include "carla/streaming/detail/Token.h"
+#include "carla/streaming/detail/tcp/Message.h"
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace carla {
+namespace streaming {
+namespace detail {
+namespace shm {
+
+  /// Whether the shared memory transport is available on this platform. Only
+  /// Linux is supported, the notification relies on futexes.
+  bool IsSupported();
+
+  /// Name of the shared memory segment of the stream identified by @a token.
+  std::string MakeSegmentName(const token_type &token);
+
+  /// A ring of message slots in a named POSIX shared memory segment, written
+  /// by a single publisher and read by any number of processes on the same
+  /// host.
+  ///
+  /// Each slot is guarded by a sequence lock, readers copy a slot out and
+  /// discard it if the publisher overwrote it meanwhile; a slow reader skips
+  /// messages instead of slowing down the publisher. Readers waiting for new
+  /// messages sleep on a futex in the segment header.
+  class Ring : private NonCopyable {
+  public:
+
+    struct Header;
+
+    struct Slot;
+
+    struct ReaderSlot;
+
+    /// Maximum number of readers counted by a segment.
+    static constexpr uint32_t MAX_NUMBER_OF_READERS = 64u;
+
+    /// Returned by AttachReader when all the reader slots are taken.
+    static constexpr uint32_t INVALID_READER = MAX_NUMBER_OF_READERS;
+
+    /// Creates a segment named @a name, replacing any existing one.
+    static std::unique_ptr<Ring> Create(
+        const std::string &name,
+        uint32_t number_of_slots,
+        uint32_t slot_capacity);
+
+    /// Maps the existing segment named @a name, returns nullptr if it does not
+    /// exist or is not initialized yet.
+    static std::unique_ptr<Ring> Open(const std::string &name);
+
+    ~Ring();
+
+    uint32_t GetNumberOfSlots() const;
+
+    /// Maximum size in bytes of a message.
+    uint32_t GetSlotCapacity() const;
+
+    /// Sequence number of the last message published, starting at 1.
+    uint64_t GetSequence() const;
+
+    /// Number of reader slots in use, including those of readers that died
+    /// without detaching until ReclaimReaders frees them.
+    uint32_t GetNumberOfReaders() const;
+
+    /// Random identifier for a reader, to hold its slot across replacement
+    /// segments. Process ids are not used as they are not unique across PID
+    /// namespaces, e.g. a client in a container sharing /dev/shm.
+    static uint64_t MakeReaderId();
+
+    /// @name Publisher
+    /// @{
+
+    /// Copies the buffers of @a message into the next slot and wakes up the
+    /// readers. @pre message.size() <= GetSlotCapacity().
+    void Publish(const tcp::Message &message);
+
+    /// Removes the name of the segment, the mapping stays valid.
+    void Unlink();
+
+    /// Tells the readers that the segment was replaced by a new one with the
+    /// same name, or closed if @a replaced is false.
+    void Invalidate(bool replaced);
+
+    /// Frees the reader slots whose heartbeat did not change for @a timeout,
+    /// e.g. clients that crashed without detaching. The timeout counts from
+    /// the first call that sees the slot, clocks are never compared across
+    /// processes. Returns the number of slots freed.
+    uint32_t ReclaimReaders(time_duration timeout);
+
+    /// Copies the reader slots of the segment @a other replaces, so its readers
+    /// keep being counted while they move to this one.
+    void CopyReaders(const Ring &other);
+
+    /// @}
+    /// @name Reader
+    /// @{
+
+    /// Takes a reader slot for the reader @a id, or keeps @a reader if it
+    /// already holds it (a reader moving to a replacement segment). Returns the
+    /// slot to pass to Heartbeat and DetachReader, INVALID_READER if there is
+    /// none available; the reader can still read but the publisher does not
+    /// count it.
+    uint32_t AttachReader(uint64_t id, uint32_t reader = INVALID_READER);
+
+    /// Tells the publisher the reader @a id is alive. Returns false if its
+    /// slot was reclaimed meanwhile, the reader needs to attach again.
+    bool Heartbeat(uint64_t id, uint32_t reader);
+
+    void DetachReader(uint64_t id, uint32_t reader);
+
+    bool IsReplaced() const;
+
+    bool IsClosed() const;
+
+    /// Counter incremented on every notification, read it before checking for
+    /// new messages to pass it to Wait.
+    uint32_t GetNotificationCounter() const;
+
+    /// Blocks until the notification counter differs from @a counter or
+    /// @a timeout expires.
+    void Wait(uint32_t counter, time_duration timeout);
+
+    /// Size of the message @a sequence, a hint for the buffer to read it into;
+    /// the slot may be overwritten before it is read.
+    uint32_t GetMessageSize(uint64_t sequence) const;
+
+    /// Copies the message @a sequence into @a buffer. Returns false if the
+    /// message has not been published yet or was already overwritten.
+    bool Read(uint64_t sequence, Buffer &buffer) const;
+
+    /// @}
+
+  private:
+
+    Ring(std::string name, void *data, size_t size, bool is_owner);
+
+    Slot &GetSlot(uint64_t sequence) const;
+
+    const std::string _name;
+
+    void *_data;
+
+    const size_t _size;
+
+    bool _is_owner;
+
+    Header *_header;
+
+    /// Last heartbeat seen by the publisher in each reader slot.
+    struct ReaderLease {
+      uint64_t id = 0u;
+      uint64_t heartbeat = 0u;
+      std::chrono::steady_clock::time_point renewed;
+    };
+
+    std::array<ReaderLease, MAX_NUMBER_OF_READERS> _leases;
+  };
+
+} // namespace shm
+} // namespace detail
+} // namespace streaming
+} // namespace carla
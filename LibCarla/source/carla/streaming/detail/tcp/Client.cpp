@@ -30,11 +30,11 @@ namespace tcp {
   // ===========================================================================
 
   /// Helper for reading incoming TCP messages. Allocates the whole message in
-  /// a single buffer.
+  /// a single buffer, popped from @a pool once the size is known.
   class IncomingMessage {
   public:
 
-    explicit IncomingMessage(Buffer &&buffer) : _message(std::move(buffer)) {}
+    explicit IncomingMessage(BufferPool &pool) : _pool(pool) {}
 
     boost::asio::mutable_buffer size_as_buffer() {
       return boost::asio::buffer(&_size, sizeof(_size));
@@ -42,7 +42,7 @@ namespace tcp {
 
     boost::asio::mutable_buffer buffer() {
       DEBUG_ASSERT(_size > 0u);
-      _message.reset(_size);
+      _message = _pool.Pop(_size);
       return _message.buffer();
     }
 
@@ -56,6 +56,8 @@ namespace tcp {
 
   private:
 
+    BufferPool &_pool;
+
     message_size_type _size = 0u;
 
     Buffer _message;
@@ -68,7 +70,8 @@ namespace tcp {
   Client::Client(
       boost::asio::io_context &io_context,
       const token_type &token,
-      callback_function_type callback)
+      callback_function_type callback,
+      codec_mask_type accepted_codecs)
     : LIBCARLA_INITIALIZE_LIFETIME_PROFILER(
           std::string("tcp client ") + std::to_string(token.get_stream_id())),
       _token(token),
@@ -80,6 +83,8 @@ namespace tcp {
     if (!_token.protocol_is_tcp()) {
       throw_exception(std::invalid_argument("invalid token, only TCP tokens supported"));
     }
+    _request.stream_id = _token.get_stream_id();
+    _request.codecs = accepted_codecs & GetSupportedCodecs();
   }
 
   Client::~Client() = default;
@@ -110,21 +115,33 @@ namespace tcp {
           // Improves the sync mode velocity on Linux by a factor of ~3.
           _socket.set_option(boost::asio::ip::tcp::no_delay(true));
           log_debug("streaming client: connected to", ep);
-          // Send the stream id to subscribe to the stream.
-          const auto &stream_id = _token.get_stream_id();
-          log_debug("streaming client: sending stream id", stream_id);
+          // Send the stream id to subscribe to the stream, flagged and
+          // followed by the codecs we accept if we want to negotiate one.
+          const bool negotiate = (_request.codecs != 0u);
+          _request.stream_id = _token.get_stream_id();
+          if (negotiate) {
+            _request.stream_id |= NEGOTIATE_CODEC_FLAG;
+          }
+          const size_t request_size = negotiate ? sizeof(_request) : sizeof(_request.stream_id);
+          log_debug("streaming client: sending stream id", _token.get_stream_id());
           boost::asio::async_write(
               _socket,
-              boost::asio::buffer(&stream_id, sizeof(stream_id)),
+              boost::asio::buffer(&_request, request_size),
               boost::asio::bind_executor(_strand, [=](error_code ec, size_t DEBUG_ONLY(bytes)) {
                 // Ensures to stop the execution once the connection has been stopped.
                 if (_done) {
                   return;
                 }
                 if (!ec) {
-                  DEBUG_ASSERT_EQ(bytes, sizeof(stream_id));
-                  // If succeeded start reading data.
-                  ReadData();
+                  DEBUG_ASSERT_EQ(bytes, request_size);
+                  if (negotiate) {
+                    // If succeeded wait for the codec chosen by the server.
+                    ReadReply();
+                  } else {
+                    // Plain handshake, the session is not compressed.
+                    _decompressor = nullptr;
+                    ReadData();
+                  }
                 } else {
                   // Else try again.
                   log_debug("streaming client: failed to send stream id:", ec.message());
@@ -163,6 +180,49 @@ namespace tcp {
     });
   }
 
+  void Client::ReadReply() {
+    auto self = shared_from_this();
+    boost::asio::async_read(
+        _socket,
+        boost::asio::buffer(&_reply, sizeof(_reply)),
+        boost::asio::bind_executor(_strand, [this, self](
+            boost::system::error_code ec,
+            size_t DEBUG_ONLY(bytes)) {
+          if (_done) {
+            return;
+          }
+          if ((ec == boost::asio::error::eof) ||
+              (ec == boost::asio::error::connection_reset)) {
+            // Servers without compression support close the session when the
+            // stream id is flagged (with the codecs unread, hence the reset),
+            // subscribe again without negotiating.
+            log_info("streaming client: stream", _token.get_stream_id(), "does not negotiate compression");
+            _request.codecs = 0u;
+            Connect();
+            return;
+          }
+          if (ec) {
+            log_debug("streaming client: failed to read session reply:", ec.message());
+            Connect();
+            return;
+          }
+          DEBUG_ASSERT_EQ(bytes, sizeof(_reply));
+          if (_reply.codec == Codec::None) {
+            _decompressor = nullptr;
+          } else if (IsCodecSupported(_reply.codec)) {
+            log_debug("streaming client: stream", _token.get_stream_id(), "compressed with codec", static_cast<int>(_reply.codec));
+            // A new decompressor per session, previous frames are not valid
+            // across reconnections.
+            _decompressor = std::make_unique<Decompressor>(_buffer_pool);
+          } else {
+            log_error("streaming client: server chose an unsupported codec", static_cast<int>(_reply.codec));
+            Reconnect();
+            return;
+          }
+          ReadData();
+        }));
+  }
+
   void Client::ReadData() {
     auto self = shared_from_this();
     boost::asio::post(_strand, [this, self]() {
@@ -172,7 +232,7 @@ namespace tcp {
 
       // log_debug("streaming client: Client::ReadData");
 
-      auto message = std::make_shared<IncomingMessage>(_buffer_pool->Pop());
+      auto message = std::make_shared<IncomingMessage>(*_buffer_pool);
 
       auto handle_read_data = [this, self, message](boost::system::error_code ec, size_t DEBUG_ONLY(bytes)) {
         DEBUG_ONLY(log_debug("streaming client: Client::ReadData.handle_read_data", bytes, "bytes"));
@@ -182,7 +242,15 @@ namespace tcp {
           // Move the buffer to the callback function and start reading the next
           // piece of data.
           // log_debug("streaming client: success reading data, calling the callback");
-          boost::asio::post(_strand, [self, message]() { self->_callback(message->pop()); });
+          if (_decompressor == nullptr) {
+            boost::asio::post(_strand, [self, message]() { self->_callback(message->pop()); });
+          } else {
+            // Decompress here so the frames are decoded in order.
+            auto buffer = std::make_shared<Buffer>(message->pop());
+            if (_decompressor->Decompress(*buffer)) {
+              boost::asio::post(_strand, [self, buffer]() { self->_callback(std::move(*buffer)); });
+            }
+          }
           ReadData();
         } else {
           // As usual, if anything fails start over from the very top.
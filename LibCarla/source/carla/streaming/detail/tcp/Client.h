@@ -9,6 +9,7 @@
 #include "carla/Buffer.h"
 #include "carla/NonCopyable.h"
 #include "carla/profiler/LifetimeProfiled.h"
+#include "carla/streaming/detail/Compression.h"
 #include "carla/streaming/detail/Token.h"
 #include "carla/streaming/detail/Types.h"
 
@@ -43,10 +44,14 @@ namespace tcp {
     using protocol_type = endpoint::protocol_type;
     using callback_function_type = std::function<void (Buffer)>;
 
+    /// If @a accepted_codecs is not empty, the client asks the server to
+    /// choose one of them for the session. Otherwise, or if the server does
+    /// not support compression, the session is not compressed.
     Client(
         boost::asio::io_context &io_context,
         const token_type &token,
-        callback_function_type callback);
+        callback_function_type callback,
+        codec_mask_type accepted_codecs = 0u);
 
     ~Client();
 
@@ -62,6 +67,10 @@ namespace tcp {
 
     void Reconnect();
 
+    /// Reads the codec chosen by the server for this session, if the client
+    /// asked to negotiate it.
+    void ReadReply();
+
     void ReadData();
 
     const token_type _token;
@@ -76,6 +85,13 @@ namespace tcp {
 
     std::shared_ptr<BufferPool> _buffer_pool;
 
+    session_request _request;
+
+    session_reply _reply;
+
+    /// Only if the session has a codec. Only accessed from within the strand.
+    std::unique_ptr<Decompressor> _decompressor;
+
     std::atomic_bool _done{false};
   };
 
@@ -21,7 +21,9 @@ namespace tcp {
     : _io_context(io_context),
       _acceptor(_io_context, std::move(ep)),
       _timeout(time_duration::seconds(10u)),
-      _synchronous(false) {}
+      _synchronous(false),
+      _send_queue_capacity(8u),
+      _send_queue_policy(SendQueuePolicy::DropOldest) {}
 
   void Server::OpenSession(
       time_duration timeout,
@@ -28,6 +28,7 @@ namespace tcp {
 
     using endpoint = boost::asio::ip::tcp::endpoint;
     using protocol_type = endpoint::protocol_type;
+    using send_queue_policy = SendQueuePolicy;
 
     explicit Server(boost::asio::io_context &io_context, endpoint ep);
 
@@ -62,8 +63,38 @@ namespace tcp {
       return _synchronous;
     }
 
+    /// Maximum number of messages waiting to be sent in each session. Applies
+    /// to every session. By default 8 messages.
+    void SetSendQueueCapacity(size_t capacity) {
+      _send_queue_capacity = capacity > 0u ? capacity : 1u;
+    }
+
+    size_t GetSendQueueCapacity() const {
+      return _send_queue_capacity;
+    }
+
+    /// Policy applied by the sessions when their send queue is full in
+    /// asynchronous mode. By default the oldest message is dropped. In
+    /// synchronous mode the writer is always blocked instead, no message is
+    /// ever discarded.
+    void SetSendQueuePolicy(SendQueuePolicy policy) {
+      _send_queue_policy = policy;
+    }
+
+    SendQueuePolicy GetSendQueuePolicy() const {
+      return _synchronous ? SendQueuePolicy::Block : _send_queue_policy.load();
+    }
+
+    /// Send queue counters of all the sessions, closed ones included, since
+    /// the server was created.
+    SendQueueStats GetSendQueueStats() const {
+      return _send_queue_counters.Get();
+    }
+
   private:
 
+    friend class ServerSession;
+
     void OpenSession(
         time_duration timeout,
         ServerSession::callback_function_type on_session_opened,
@@ -75,7 +106,13 @@ namespace tcp {
 
     std::atomic<time_duration> _timeout;
 
-    bool _synchronous;
+    std::atomic_bool _synchronous;
+
+    std::atomic_size_t _send_queue_capacity;
+
+    std::atomic<SendQueuePolicy> _send_queue_policy;
+
+    SendQueueCounters _send_queue_counters;
   };
 
 } // namespace tcp
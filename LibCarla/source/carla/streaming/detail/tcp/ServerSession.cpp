@@ -16,7 +16,7 @@
 #include <boost/asio/post.hpp>
 
 #include <atomic>
-#include <thread>
+#include <iterator>
 
 namespace carla {
 namespace streaming {
@@ -53,13 +53,41 @@ namespace tcp {
     auto self = shared_from_this(); // To keep myself alive.
     boost::asio::post(_strand, [=]() {
 
-      auto handle_query = [this, self, callback=std::move(on_opened)](
+      auto handle_opened = [this, self, callback=std::move(on_opened)]() {
+        log_debug("session", _session_id, "for stream", _stream_id, " started");
+        boost::asio::post(_strand.context(), [=]() { callback(self); });
+      };
+
+      auto handle_codecs = [this, handle_opened](
+          const boost::system::error_code &ec,
+          size_t DEBUG_ONLY(bytes_received)) {
+        if (!ec) {
+          DEBUG_ASSERT_EQ(bytes_received, sizeof(_request.codecs));
+          _accepted_codecs = _request.codecs;
+          // The client waits for the codec of the session.
+          _is_reply_sent = false;
+          handle_opened();
+        } else {
+          log_error("session", _session_id, ": error retrieving accepted codecs :", ec.message());
+          CloseNow(ec);
+        }
+      };
+
+      auto handle_query = [this, handle_opened, handle_codecs](
           const boost::system::error_code &ec,
           size_t DEBUG_ONLY(bytes_received)) {
         if (!ec) {
-          DEBUG_ASSERT_EQ(bytes_received, sizeof(_stream_id));
-          log_debug("session", _session_id, "for stream", _stream_id, " started");
-          boost::asio::post(_strand.context(), [=]() { callback(self); });
+          DEBUG_ASSERT_EQ(bytes_received, sizeof(_request.stream_id));
+          _stream_id = _request.stream_id & ~NEGOTIATE_CODEC_FLAG;
+          if ((_request.stream_id & NEGOTIATE_CODEC_FLAG) == 0u) {
+            handle_opened();
+            return;
+          }
+          // Read the codecs accepted by the client.
+          boost::asio::async_read(
+              _socket,
+              boost::asio::buffer(&_request.codecs, sizeof(_request.codecs)),
+              boost::asio::bind_executor(_strand, handle_codecs));
         } else {
           log_error("session", _session_id, ": error retrieving stream id :", ec.message());
           CloseNow(ec);
@@ -70,7 +98,7 @@ namespace tcp {
       _deadline.expires_from_now(_timeout);
       boost::asio::async_read(
           _socket,
-          boost::asio::buffer(&_stream_id, sizeof(_stream_id)),
+          boost::asio::buffer(&_request.stream_id, sizeof(_request.stream_id)),
           boost::asio::bind_executor(_strand, handle_query));
     });
   }
@@ -78,44 +106,127 @@ namespace tcp {
   void ServerSession::Write(std::shared_ptr<const Message> message) {
     DEBUG_ASSERT(message != nullptr);
     DEBUG_ASSERT(!message->empty());
-    auto self = shared_from_this();
-    boost::asio::post(_strand, [=]() {
-      if (!_socket.is_open()) {
+    const size_t capacity = _server.GetSendQueueCapacity();
+    {
+      std::unique_lock<std::mutex> lock(_queue_mutex);
+      if (_is_closed) {
         return;
       }
-      if (_is_writing) {
-        if (_server.IsSynchronousMode()) {
-          // wait until previous message has been sent
-          while (_is_writing) {
-            std::this_thread::yield();
-          }
-        } else {
-          // ignore this message
-          log_debug("session", _session_id, ": connection too slow: message discarded");
-          return;
+      if (_queue.size() >= capacity) {
+        switch (_server.GetSendQueuePolicy()) {
+          case SendQueuePolicy::Block:
+            // Wait outside the strand so the streaming threads keep serving
+            // the other sessions.
+            _queue_condition.wait(lock, [&]() {
+              return _is_closed || _queue.size() < capacity;
+            });
+            if (_is_closed) {
+              return;
+            }
+            break;
+          case SendQueuePolicy::DropOldest:
+            while (_queue.size() >= capacity) {
+              Drop(*_queue.front());
+              _queue.pop_front();
+            }
+            break;
+          case SendQueuePolicy::KeepLatest:
+            for (auto &queued : _queue) {
+              Drop(*queued);
+            }
+            _queue.clear();
+            break;
         }
       }
+      _send_queue_counters.Queued(message->size());
+      _server._send_queue_counters.Queued(message->size());
+      _queue.emplace_back(std::move(message));
+      if (_is_writing) {
+        // The message is sent once the write in flight completes.
+        return;
+      }
       _is_writing = true;
+    }
+    boost::asio::post(_strand, [self=shared_from_this()]() { self->StartWrite(); });
+  }
+
+  void ServerSession::SetCodec(Codec codec) {
+    DEBUG_ASSERT(
+        (codec == Codec::None) ||
+        ((_accepted_codecs & ToCodecMask(codec)) != 0u));
+    std::lock_guard<std::mutex> lock(_queue_mutex);
+    DEBUG_ASSERT(_queue.empty() && !_is_writing);
+    _reply.codec = codec;
+  }
 
-      auto handle_sent = [this, self, message](const boost::system::error_code &ec, size_t DEBUG_ONLY(bytes)) {
+  SendQueueStats ServerSession::GetSendQueueStats() const {
+    return _send_queue_counters.Get();
+  }
+
+  void ServerSession::StartWrite() {
+    DEBUG_ASSERT(_in_flight.empty());
+    {
+      std::lock_guard<std::mutex> lock(_queue_mutex);
+      if (!_socket.is_open() || _queue.empty()) {
         _is_writing = false;
-        if (ec) {
-          log_info("session", _session_id, ": error sending data :", ec.message());
-          CloseNow(ec);
-        } else {
-          DEBUG_ONLY(log_debug("session", _session_id, ": successfully sent", bytes, "bytes"));
-          DEBUG_ASSERT_EQ(bytes, sizeof(message_size_type) + message->size());
-        }
-      };
+        return;
+      }
+      _in_flight.assign(
+          std::make_move_iterator(_queue.begin()),
+          std::make_move_iterator(_queue.end()));
+      _queue.clear();
+    }
+    _queue_condition.notify_all();
 
-      log_debug("session", _session_id, ": sending message of", message->size(), "bytes");
+    // Coalesce the size header and buffers of every message in a single
+    // buffer sequence, after the session reply in the first write.
+    _gather_buffers.clear();
+    size_t bytes_to_send = 0u;
+    size_t reply_size = 0u;
+    if (!_is_reply_sent) {
+      _gather_buffers.emplace_back(boost::asio::buffer(&_reply, sizeof(_reply)));
+      reply_size = sizeof(_reply);
+      bytes_to_send += reply_size;
+      _is_reply_sent = true;
+    }
+    for (auto &message : _in_flight) {
+      auto sequence = message->GetBufferSequence();
+      _gather_buffers.insert(_gather_buffers.end(), sequence.begin(), sequence.end());
+      bytes_to_send += sizeof(message_size_type) + message->size();
+    }
 
-      _deadline.expires_from_now(_timeout);
-      boost::asio::async_write(
-          _socket,
-          message->GetBufferSequence(),
-          handle_sent);
-    });
+    log_debug("session", _session_id, ": sending", _in_flight.size(), "messages of", bytes_to_send, "bytes");
+
+    auto handle_sent = [this, self=shared_from_this(), bytes_to_send, reply_size](
+        const boost::system::error_code &ec,
+        size_t bytes) {
+      if (ec) {
+        log_info("session", _session_id, ": error sending data :", ec.message());
+        _in_flight.clear();
+        CloseNow(ec);
+        return;
+      }
+      DEBUG_ONLY(log_debug("session", _session_id, ": successfully sent", bytes, "bytes"));
+      DEBUG_ASSERT_EQ(bytes, bytes_to_send);
+      (void) bytes_to_send;
+      const size_t sent_bytes = bytes - reply_size - _in_flight.size() * sizeof(message_size_type);
+      _send_queue_counters.Sent(_in_flight.size(), sent_bytes);
+      _server._send_queue_counters.Sent(_in_flight.size(), sent_bytes);
+      _in_flight.clear();
+      StartWrite();
+    };
+
+    _deadline.expires_from_now(_timeout);
+    boost::asio::async_write(
+        _socket,
+        _gather_buffers,
+        boost::asio::bind_executor(_strand, handle_sent));
+  }
+
+  void ServerSession::Drop(const Message &message) {
+    log_debug("session", _session_id, ": connection too slow: message discarded");
+    _send_queue_counters.Dropped(message.size());
+    _server._send_queue_counters.Dropped(message.size());
   }
 
   void ServerSession::Close() {
@@ -139,6 +250,13 @@ namespace tcp {
 
   void ServerSession::CloseNow(boost::system::error_code ec) {
     _deadline.cancel();
+    {
+      std::lock_guard<std::mutex> lock(_queue_mutex);
+      _is_closed = true;
+      _queue.clear();
+    }
+    // Release the writers blocked on a full queue.
+    _queue_condition.notify_all();
     if (!ec)
     {
       if (_socket.is_open()) {
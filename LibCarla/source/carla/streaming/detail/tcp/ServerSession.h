@@ -10,6 +10,7 @@
 #include "carla/Time.h"
 #include "carla/TypeTraits.h"
 #include "carla/profiler/LifetimeProfiled.h"
+#include "carla/streaming/detail/Compression.h"
 #include "carla/streaming/detail/Types.h"
 #include "carla/streaming/detail/tcp/Message.h"
 
@@ -25,8 +26,13 @@
 #  pragma clang diagnostic pop
 #endif
 
+#include <atomic>
+#include <condition_variable>
+#include <deque>
 #include <functional>
 #include <memory>
+#include <mutex>
+#include <vector>
 
 namespace carla {
 namespace streaming {
@@ -35,8 +41,78 @@ namespace tcp {
 
   class Server;
 
-  /// A TCP server session. When a session opens, it reads from the socket a
-  /// stream id object and passes itself to the callback functor. The session
+  /// What a session does with a new message when its send queue is full.
+  enum class SendQueuePolicy {
+    /// The writer waits until the queued messages are sent. Always used in
+    /// synchronous mode.
+    Block,
+    /// The oldest queued message is discarded.
+    DropOldest,
+    /// Every queued message is discarded, only the newest one is kept.
+    KeepLatest
+  };
+
+  /// Counters of the messages that went through the send queue of a session
+  /// since it was opened. Sizes count the payload only, not the size header
+  /// of each message.
+  struct SendQueueStats {
+    size_t queued_messages = 0u;
+    size_t queued_bytes = 0u;
+    size_t dropped_messages = 0u;
+    size_t dropped_bytes = 0u;
+    size_t sent_messages = 0u;
+    size_t sent_bytes = 0u;
+  };
+
+  /// Thread-safe counters behind SendQueueStats, kept by each session and
+  /// for all the sessions of a server.
+  class SendQueueCounters : private NonCopyable {
+  public:
+
+    void Queued(size_t bytes) {
+      ++_queued_messages;
+      _queued_bytes += bytes;
+    }
+
+    void Dropped(size_t bytes) {
+      ++_dropped_messages;
+      _dropped_bytes += bytes;
+    }
+
+    void Sent(size_t messages, size_t bytes) {
+      _sent_messages += messages;
+      _sent_bytes += bytes;
+    }
+
+    SendQueueStats Get() const {
+      SendQueueStats stats;
+      stats.queued_messages = _queued_messages;
+      stats.queued_bytes = _queued_bytes;
+      stats.dropped_messages = _dropped_messages;
+      stats.dropped_bytes = _dropped_bytes;
+      stats.sent_messages = _sent_messages;
+      stats.sent_bytes = _sent_bytes;
+      return stats;
+    }
+
+  private:
+
+    std::atomic_size_t _queued_messages{0u};
+
+    std::atomic_size_t _queued_bytes{0u};
+
+    std::atomic_size_t _dropped_messages{0u};
+
+    std::atomic_size_t _dropped_bytes{0u};
+
+    std::atomic_size_t _sent_messages{0u};
+
+    std::atomic_size_t _sent_bytes{0u};
+  };
+
+  /// A TCP server session. When a session opens, it reads from the socket the
+  /// stream id, followed by the codecs the client accepts if it asked to
+  /// negotiate one, and passes itself to the callback functor. The session
   /// closes itself after @a timeout of inactivity is met.
   class ServerSession
     : public std::enable_shared_from_this<ServerSession>,
@@ -64,6 +140,23 @@ namespace tcp {
       return _stream_id;
     }
 
+    /// Codecs the client can decompress, read along with the stream id. None
+    /// unless the client negotiates the codec.
+    codec_mask_type get_accepted_codecs() const {
+      return _accepted_codecs;
+    }
+
+    /// Codec of the messages written to this session. Codec::None unless set
+    /// with SetCodec.
+    Codec get_codec() const {
+      return _reply.codec;
+    }
+
+    /// Select the codec of this session, it is sent to the client in front of
+    /// the first message if the client negotiates the codec. Must be called
+    /// before the first Write, and the client must have accepted @a codec.
+    void SetCodec(Codec codec);
+
     template <typename... Buffers>
     static auto MakeMessage(Buffers... buffers) {
       static_assert(
@@ -72,7 +165,11 @@ namespace tcp {
       return std::make_shared<const Message>(buffers...);
     }
 
-    /// Writes some data to the socket.
+    /// Writes some data to the socket. The message is appended to a bounded
+    /// queue, and every message queued while the socket is busy is sent
+    /// together in a single write. When the queue is full, the server's
+    /// SendQueuePolicy decides whether this call blocks or which messages are
+    /// discarded.
     void Write(std::shared_ptr<const Message> message);
 
     /// Writes some data to the socket.
@@ -84,10 +181,18 @@ namespace tcp {
     /// Post a job to close the session.
     void Close();
 
+    SendQueueStats GetSendQueueStats() const;
+
   private:
 
     void StartTimer();
 
+    /// Sends every queued message in a single gather write. Must be called
+    /// from within the strand.
+    void StartWrite();
+
+    void Drop(const Message &message);
+
     void CloseNow(boost::system::error_code ec = boost::system::error_code());
 
     friend class Server;
@@ -98,6 +203,16 @@ namespace tcp {
 
     stream_id_type _stream_id = 0u;
 
+    codec_mask_type _accepted_codecs = 0u;
+
+    session_request _request;
+
+    session_reply _reply;
+
+    /// Whether the reply was already sent, or is not expected by the client.
+    /// Only accessed from within the strand.
+    bool _is_reply_sent = true;
+
     socket_type _socket;
 
     time_duration _timeout;
@@ -108,7 +223,23 @@ namespace tcp {
 
     callback_function_type _on_closed;
 
+    std::mutex _queue_mutex;
+
+    std::condition_variable _queue_condition;
+
+    std::deque<std::shared_ptr<const Message>> _queue;
+
     bool _is_writing = false;
+
+    bool _is_closed = false;
+
+    /// Messages of the write in flight, kept alive until it completes. Only
+    /// accessed from within the strand.
+    std::vector<std::shared_ptr<const Message>> _in_flight;
+
+    std::vector<boost::asio::const_buffer> _gather_buffers;
+
+    SendQueueCounters _send_queue_counters;
   };
 
 } // namespace tcp
@@ -7,10 +7,12 @@
 #pragma once
 
 #include "carla/streaming/detail/Token.h"
+#include "carla/streaming/detail/shm/Client.h"
 #include "carla/streaming/detail/tcp/Client.h"
 
 #include <boost/asio/io_context.hpp>
 
+#include <atomic>
 #include <memory>
 #include <unordered_map>
 
@@ -44,6 +46,15 @@ namespace low_level {
       for (auto &pair : _clients) {
         pair.second->Stop();
       }
+      for (auto &pair : _shared_memory_clients) {
+        pair.second->Stop();
+      }
+    }
+
+    /// Codecs the streams subscribed from now on ask the server to compress
+    /// with. Empty by default, the server sends those streams uncompressed.
+    void SetAcceptedCodecs(detail::codec_mask_type codecs) {
+      _accepted_codecs = codecs;
     }
 
     /// @warning cannot subscribe twice to the same stream (even if it's a
@@ -57,10 +68,26 @@ namespace low_level {
       if (!token.has_address()) {
         token.set_address(_fallback_address);
       }
+      if (token.protocol_is_shared_memory()) {
+        // Read from shared memory only if the server runs on this host,
+        // otherwise use the TCP endpoint of the token.
+        if (token.get_address().is_loopback() &&
+            detail::shm::Client::IsAvailable(token)) {
+          auto client = std::make_shared<detail::shm::Client>(
+              io_context,
+              token,
+              std::forward<Functor>(callback));
+          client->Connect();
+          _shared_memory_clients.emplace(token.get_stream_id(), std::move(client));
+          return;
+        }
+        token.set_shared_memory(false);
+      }
       auto client = std::make_shared<underlying_client>(
           io_context,
           token,
-          std::forward<Functor>(callback));
+          std::forward<Functor>(callback),
+          _accepted_codecs.load());
       client->Connect();
       _clients.emplace(token.get_stream_id(), std::move(client));
     }
@@ -72,15 +99,26 @@ namespace low_level {
         it->second->Stop();
         _clients.erase(it);
       }
+      auto shm_it = _shared_memory_clients.find(token.get_stream_id());
+      if (shm_it != _shared_memory_clients.end()) {
+        shm_it->second->Stop();
+        _shared_memory_clients.erase(shm_it);
+      }
     }
 
   private:
 
     boost::asio::ip::address _fallback_address;
 
+    std::atomic<detail::codec_mask_type> _accepted_codecs{0u};
+
     std::unordered_map<
         detail::stream_id_type,
         std::shared_ptr<underlying_client>> _clients;
+
+    std::unordered_map<
+        detail::stream_id_type,
+        std::shared_ptr<detail::shm::Client>> _shared_memory_clients;
   };
 
 } // namespace low_level
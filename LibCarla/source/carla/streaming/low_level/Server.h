@@ -77,6 +77,30 @@ namespace low_level {
       _server.SetSynchronousMode(is_synchro);
     }
 
+    void SetSharedMemoryTransport(bool enable) {
+      _dispatcher.SetSharedMemoryTransport(enable);
+    }
+
+    void SetDefaultCompression(const detail::CompressionSettings &settings) {
+      _dispatcher.SetDefaultCompression(settings);
+    }
+
+    void SetCompression(stream_id sensor_id, const detail::CompressionSettings &settings) {
+      _dispatcher.SetCompression(sensor_id, settings);
+    }
+
+    void SetSendQueueCapacity(size_t capacity) {
+      _server.SetSendQueueCapacity(capacity);
+    }
+
+    void SetSendQueuePolicy(typename underlying_server::send_queue_policy policy) {
+      _server.SetSendQueuePolicy(policy);
+    }
+
+    auto GetSendQueueStats() const {
+      return _server.GetSendQueueStats();
+    }
+
     token_type GetToken(stream_id sensor_id) {
       return _dispatcher.GetToken(sensor_id);
     }
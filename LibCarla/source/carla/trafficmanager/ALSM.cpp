@@ -19,7 +19,7 @@ ALSM::ALSM(
   BufferMap &buffer_map,
   TrackTraffic &track_traffic,
   std::vector<ActorId>& marked_for_removal,
-  const Parameters &parameters,
+  Parameters &parameters,
   const cc::World &world,
   const LocalMapPtr &local_map,
   SimulationState &simulation_state,
@@ -46,45 +46,35 @@ void ALSM::Update() {
 
   bool hybrid_physics_mode = parameters.GetHybridPhysicsMode();
 
-  std::set<ActorId> world_vehicle_ids;
-  std::set<ActorId> world_pedestrian_ids;
-  std::vector<ActorId> unregistered_list_to_be_deleted;
-
-  current_timestamp = world.GetSnapshot().GetTimestamp();
-  ActorList world_actors = world.GetActors();
-
-  // Find destroyed actors and perform clean up.
-  const ALSM::DestroyeddActors destroyed_actors = IdentifyDestroyedActors(world_actors);
-
-  const ActorIdSet &destroyed_registered = destroyed_actors.first;
-  for (const auto &deletion_id: destroyed_registered) {
-    RemoveActor(deletion_id, true);
-  }
-
-  const ActorIdSet &destroyed_unregistered = destroyed_actors.second;
-  for (auto deletion_id : destroyed_unregistered) {
-    RemoveActor(deletion_id, false);
+  const cc::WorldSnapshot snapshot = world.GetSnapshot();
+  current_timestamp = snapshot.GetTimestamp();
+
+  // Find spawned and destroyed actors.
+  std::vector<ActorId> new_actor_ids;
+  std::vector<ActorId> destroyed_actor_ids;
+  IdentifyActorChanges(snapshot, new_actor_ids, destroyed_actor_ids);
+
+  // Perform clean up of destroyed actors, invalidating hero actors that are
+  // not alive anymore.
+  for (const ActorId &deletion_id : destroyed_actor_ids) {
+    if (registered_vehicles.Contains(deletion_id)) {
+      RemoveActor(deletion_id, true);
+    } else if (unregistered_actors.find(deletion_id) != unregistered_actors.end()) {
+      RemoveActor(deletion_id, false);
+    }
+    hero_actors.erase(deletion_id);
   }
 
-  // Invalidate hero actor if it is not alive anymore.
-  if (hero_actors.size() != 0u) {
-    ActorIdSet hero_actors_to_delete;
-    for (auto &hero_actor_info: hero_actors) {
-      if (destroyed_unregistered.find(hero_actor_info.first) != destroyed_unregistered.end()) {
-        hero_actors_to_delete.insert(hero_actor_info.first);
-      }
-      if (destroyed_registered.find(hero_actor_info.first) != destroyed_registered.end()) {
-        hero_actors_to_delete.insert(hero_actor_info.first);
-      }
-    }
+  UpdateRegistrations();
 
-    for (auto &deletion_id: hero_actors_to_delete) {
-      hero_actors.erase(deletion_id);
+  // Scan for new unregistered actors.
+  for (const ActorId &actor_id : actors_to_identify) {
+    if (world_actor_ids.find(actor_id) != world_actor_ids.end()) {
+      new_actor_ids.push_back(actor_id);
     }
   }
-
-  // Scan for new unregistered actors.
-  IdentifyNewActors(world_actors);
+  actors_to_identify.clear();
+  IdentifyNewActors(new_actor_ids);
 
   // Update dynamic state and static attributes for all registered vehicles.
   ALSM::IdleInfo max_idle_time = std::make_pair(0u, current_timestamp.elapsed_seconds);
@@ -112,58 +102,99 @@ void ALSM::Update() {
   UpdateUnregisteredActorsData();
 }
 
-void ALSM::IdentifyNewActors(const ActorList &actor_list) {
-  for (auto iter = actor_list->begin(); iter != actor_list->end(); ++iter) {
-    ActorPtr actor = *iter;
-    ActorId actor_id = actor->GetId();
-    // Identify any new hero vehicle
-    if (actor->GetTypeId().front() == 'v') {
-     if (hero_actors.size() == 0u || hero_actors.find(actor_id) == hero_actors.end()) {
-      for (auto&& attribute: actor->GetAttributes()) {
-        if (attribute.GetId() == "role_name" && attribute.GetValue() == "hero") {
-          hero_actors.insert({actor_id, actor});
-        }
-      }
-    }
+void ALSM::IdentifyActorChanges(const cc::WorldSnapshot &snapshot,
+                                std::vector<ActorId> &new_actor_ids,
+                                std::vector<ActorId> &destroyed_actor_ids) {
+
+  const size_t frame = snapshot.GetFrame();
+  if (has_processed_frame && frame == last_processed_frame) {
+    return;
   }
-    if (!registered_vehicles.Contains(actor_id)
-        && unregistered_actors.find(actor_id) == unregistered_actors.end()) {
 
-      unregistered_actors.insert({actor_id, actor});
+  if (has_processed_frame && snapshot.GetActorDeltaBaseFrame() == last_processed_frame) {
+    // The snapshot directly follows the last processed one, only the actor
+    // delta has to be applied.
+    for (const ActorId &actor_id : snapshot.GetAddedActorIds()) {
+      if (world_actor_ids.insert(actor_id).second) {
+        new_actor_ids.push_back(actor_id);
+      }
+    }
+    for (const ActorId &actor_id : snapshot.GetRemovedActorIds()) {
+      if (world_actor_ids.erase(actor_id) != 0u) {
+        destroyed_actor_ids.push_back(actor_id);
+      }
     }
+  } else {
+    // Frames have been skipped, compare the full actor lists.
+    ActorIdSet current_actors;
+    current_actors.reserve(snapshot.size());
+    for (const cc::ActorSnapshot &actor_snapshot : snapshot) {
+      current_actors.insert(actor_snapshot.id);
+      if (world_actor_ids.find(actor_snapshot.id) == world_actor_ids.end()) {
+        new_actor_ids.push_back(actor_snapshot.id);
+      }
+    }
+    for (const ActorId &actor_id : world_actor_ids) {
+      if (current_actors.find(actor_id) == current_actors.end()) {
+        destroyed_actor_ids.push_back(actor_id);
+      }
+    }
+    world_actor_ids.swap(current_actors);
   }
-}
 
-ALSM::DestroyeddActors ALSM::IdentifyDestroyedActors(const ActorList &actor_list) {
+  has_processed_frame = true;
+  last_processed_frame = frame;
+}
 
-  ALSM::DestroyeddActors destroyed_actors;
-  ActorIdSet &deleted_registered = destroyed_actors.first;
-  ActorIdSet &deleted_unregistered = destroyed_actors.second;
+void ALSM::UpdateRegistrations() {
 
-  // Building hash set of actors present in current frame.
-  ActorIdSet current_actors;
-  for  (auto iter = actor_list->begin(); iter != actor_list->end(); ++iter) {
-    current_actors.insert((*iter)->GetId());
+  if (registered_vehicles.GetState() == registered_vehicles_state) {
+    return;
   }
 
-  // Searching for destroyed registered actors.
-  std::vector<ActorId> registered_ids = registered_vehicles.GetIDList();
-  for (const ActorId &actor_id : registered_ids) {
-    if (current_actors.find(actor_id) == current_actors.end()) {
-      deleted_registered.insert(actor_id);
+  for (const ActorId &actor_id : registered_vehicles.GetIDList()) {
+    if (world_actor_ids.find(actor_id) == world_actor_ids.end()) {
+      // Registered vehicle no longer present in the world.
+      RemoveActor(actor_id, true);
+      hero_actors.erase(actor_id);
+    } else if (unregistered_actors.find(actor_id) != unregistered_actors.end()) {
+      // Newly registered vehicle, it is not tracked as unregistered anymore.
+      unregistered_actors.erase(actor_id);
+      track_traffic.DeleteActor(actor_id);
+      simulation_state.RemoveActor(actor_id);
     }
   }
+  registered_vehicles_state = registered_vehicles.GetState();
+}
 
-  // Searching for destroyed unregistered actors.
-  for (const auto &actor_info: unregistered_actors) {
-    const ActorId &actor_id = actor_info.first;
-     if (current_actors.find(actor_id) == current_actors.end()
-         || registered_vehicles.Contains(actor_id)) {
-      deleted_unregistered.insert(actor_id);
-    }
+void ALSM::IdentifyNewActors(const std::vector<ActorId> &actor_ids) {
+  if (actor_ids.empty()) {
+    return;
   }
 
-  return destroyed_actors;
+  ActorList actor_list = world.GetActors(actor_ids);
+  for (auto iter = actor_list->begin(); iter != actor_list->end(); ++iter) {
+    ActorPtr actor = *iter;
+    ActorId actor_id = actor->GetId();
+    const char type = actor->GetTypeId().front();
+    // Identify any new hero vehicle
+    if (type == 'v') {
+      if (hero_actors.size() == 0u || hero_actors.find(actor_id) == hero_actors.end()) {
+        for (auto&& attribute: actor->GetAttributes()) {
+          if (attribute.GetId() == "role_name" && attribute.GetValue() == "hero") {
+            hero_actors.insert({actor_id, actor});
+          }
+        }
+      }
+    }
+    // Only vehicles and walkers take part in the traffic.
+    if ((type == 'v' || type == 'w')
+        && !registered_vehicles.Contains(actor_id)
+        && unregistered_actors.find(actor_id) == unregistered_actors.end()) {
+
+      unregistered_actors.insert({actor_id, actor});
+    }
+  }
 }
 
 void ALSM::UpdateRegisteredActorsData(const bool hybrid_physics_mode, ALSM::IdleInfo &max_idle_time) {
@@ -374,6 +405,14 @@ void ALSM::RemoveActor(const ActorId actor_id, const bool registered_actor) {
     traffic_light_stage.RemoveActor(actor_id);
     motion_plan_stage.RemoveActor(actor_id);
     vehicle_light_stage.RemoveActor(actor_id);
+    // Vehicles unregistered while still alive are tracked again as
+    // unregistered actors and keep their parameters, as they may be
+    // registered back.
+    if (world_actor_ids.find(actor_id) != world_actor_ids.end()) {
+      actors_to_identify.push_back(actor_id);
+    } else {
+      parameters.RemoveVehicle(actor_id);
+    }
   }
   else {
     unregistered_actors.erase(actor_id);
@@ -384,10 +423,23 @@ void ALSM::RemoveActor(const ActorId actor_id, const bool registered_actor) {
   simulation_state.RemoveActor(actor_id);
 }
 
+void ALSM::GetHeroLocations(std::vector<cg::Location> &hero_locations) const {
+  hero_locations.clear();
+  for (auto &hero_actor_info : hero_actors) {
+    if (simulation_state.ContainsActor(hero_actor_info.first)) {
+      hero_locations.push_back(simulation_state.GetLocation(hero_actor_info.first));
+    }
+  }
+}
+
 void ALSM::Reset() {
   unregistered_actors.clear();
   idle_time.clear();
   hero_actors.clear();
+  world_actor_ids.clear();
+  actors_to_identify.clear();
+  has_processed_frame = false;
+  registered_vehicles_state = -1;
   elapsed_last_actor_destruction = 0.0;
   current_timestamp = world.GetSnapshot().GetTimestamp();
 }
@@ -6,6 +6,7 @@
 #include "carla/client/ActorList.h"
 #include "carla/client/Timestamp.h"
 #include "carla/client/World.h"
+#include "carla/client/WorldSnapshot.h"
 #include "carla/Memory.h"
 
 #include "carla/trafficmanager/AtomicActorSet.h"
@@ -31,9 +32,10 @@ namespace cg = carla::geom;
 namespace cc = carla::client;
 
 using ActorList = carla::SharedPtr<cc::ActorList>;
+using ActorIdSet = std::unordered_set<ActorId>;
 using ActorMap = std::unordered_map<ActorId, ActorPtr>;
 using IdleTimeMap = std::unordered_map<ActorId, double>;
-using LocalMapPtr = std::shared_ptr<InMemoryMap>;
+using LocalMapPtr = std::shared_ptr<const InMemoryMap>;
 
 /// ALSM: Agent Lifecycle and State Managerment
 /// This class has functionality to update the local cache of kinematic states
@@ -52,7 +54,7 @@ private:
   TrackTraffic &track_traffic;
   // Array of vehicles marked by stages for removal.
   std::vector<ActorId>& marked_for_removal;
-  const Parameters &parameters;
+  Parameters &parameters;
   const cc::World &world;
   const LocalMapPtr &local_map;
   SimulationState &simulation_state;
@@ -65,6 +67,17 @@ private:
   double elapsed_last_actor_destruction {0.0};
   cc::Timestamp current_timestamp;
   std::unordered_map<ActorId, bool> has_physics_enabled;
+  // Whether a world snapshot has been processed since the last reset.
+  bool has_processed_frame {false};
+  // Frame of the last world snapshot processed.
+  size_t last_processed_frame {0u};
+  // Ids of all the actors in the world at the last processed frame.
+  ActorIdSet world_actor_ids;
+  // Actors still alive that have to be identified again, e.g. after being
+  // unregistered from the traffic manager.
+  std::vector<ActorId> actors_to_identify;
+  // State of the registered vehicles set at the last update.
+  int registered_vehicles_state {-1};
 
   // Updates the duration for which a registered vehicle is stuck at a location.
   void UpdateIdleTime(std::pair<ActorId, double>& max_idle_time, const ActorId& actor_id);
@@ -72,13 +85,18 @@ private:
   // Method to determine if a vehicle is stuck at a place for too long.
   bool IsVehicleStuck(const ActorId& actor_id);
 
-  // Method to identify actors newly spawned in the simulation since last tick.
-  void IdentifyNewActors(const ActorList &actor_list);
+  // Method to find the actors spawned and destroyed since the last processed
+  // frame. Uses the actor delta of the snapshot when it follows that frame,
+  // and compares the full actor lists otherwise.
+  void IdentifyActorChanges(const cc::WorldSnapshot &snapshot,
+                            std::vector<ActorId> &new_actor_ids,
+                            std::vector<ActorId> &destroyed_actor_ids);
+
+  // Method to keep track of the vehicles registered since the last update.
+  void UpdateRegistrations();
 
-  using DestroyeddActors = std::pair<ActorIdSet, ActorIdSet>;
-  // Method to identify actors deleted in the last frame.
-  // Arrays of registered and unregistered actors are returned separately.
-  DestroyeddActors IdentifyDestroyedActors(const ActorList &actor_list);
+  // Method to identify actors newly spawned in the simulation since last tick.
+  void IdentifyNewActors(const std::vector<ActorId> &actor_ids);
 
   using IdleInfo = std::pair<ActorId, double>;
   void UpdateRegisteredActorsData(const bool hybrid_physics_mode, IdleInfo &max_idle_time);
@@ -93,7 +111,7 @@ public:
        BufferMap &buffer_map,
        TrackTraffic &track_traffic,
        std::vector<ActorId>& marked_for_removal,
-       const Parameters &parameters,
+       Parameters &parameters,
        const cc::World &world,
        const LocalMapPtr &local_map,
        SimulationState &simulation_state,
@@ -109,6 +127,9 @@ public:
   // from various stages tracking the said vehicle.
   void RemoveActor(const ActorId actor_id, const bool registered_actor);
 
+  // Fills the current locations of the hero vehicles.
+  void GetHeroLocations(std::vector<cg::Location> &hero_locations) const;
+
   void Reset();
 };
 
@@ -0,0 +1,203 @@
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "carla/Debug.h"
+
+#include "carla/trafficmanager/CollisionGeometry.h"
+#include "carla/trafficmanager/Constants.h"
+
+namespace carla {
+namespace traffic_manager {
+
+namespace {
+
+  /// Number of independent accumulators used by the distance kernel, so that
+  /// the reduction maps to vector registers.
+  static constexpr std::size_t KERNEL_LANES = 4u;
+
+} // namespace
+
+BoundaryPolygon::BoundaryPolygon(const std::vector<cg::Location> &boundary) {
+  const std::size_t size = boundary.size();
+  x.reserve(size);
+  y.reserve(size);
+  dx.reserve(size);
+  dy.reserve(size);
+  inverse_length_squared.reserve(size);
+
+  min_x = min_y = std::numeric_limits<double>::infinity();
+  max_x = max_y = -std::numeric_limits<double>::infinity();
+  for (std::size_t i = 0u; i < size; ++i) {
+    const cg::Location &start = boundary[i];
+    const cg::Location &end = boundary[(i + 1u) % size];
+    const double start_x = static_cast<double>(start.x);
+    const double start_y = static_cast<double>(start.y);
+    const double edge_x = static_cast<double>(end.x) - start_x;
+    const double edge_y = static_cast<double>(end.y) - start_y;
+    const double length_squared = edge_x * edge_x + edge_y * edge_y;
+
+    x.push_back(start_x);
+    y.push_back(start_y);
+    dx.push_back(edge_x);
+    dy.push_back(edge_y);
+    inverse_length_squared.push_back(length_squared > 0.0 ? 1.0 / length_squared : 0.0);
+
+    min_x = std::min(min_x, start_x);
+    min_y = std::min(min_y, start_y);
+    max_x = std::max(max_x, start_x);
+    max_y = std::max(max_y, start_y);
+  }
+}
+
+double BoundaryPolygon::BoundingBoxDistance(const BoundaryPolygon &other) const {
+  const double gap_x = std::max(0.0, std::max(min_x - other.max_x, other.min_x - max_x));
+  const double gap_y = std::max(0.0, std::max(min_y - other.max_y, other.min_y - max_y));
+  return std::sqrt(gap_x * gap_x + gap_y * gap_y);
+}
+
+double BoundaryPolygon::DistanceSquaredToEdges(const double px, const double py) const {
+  const std::size_t size = Size();
+  const double *const edge_x = x.data();
+  const double *const edge_y = y.data();
+  const double *const edge_dx = dx.data();
+  const double *const edge_dy = dy.data();
+  const double *const edge_inverse = inverse_length_squared.data();
+
+  // Projects the point on the edge, clamped to its end points.
+  auto edge_distance_squared = [&](const std::size_t i) {
+    const double rx = px - edge_x[i];
+    const double ry = py - edge_y[i];
+    double t = (rx * edge_dx[i] + ry * edge_dy[i]) * edge_inverse[i];
+    t = std::min(std::max(t, 0.0), 1.0);
+    const double ex = rx - t * edge_dx[i];
+    const double ey = ry - t * edge_dy[i];
+    return ex * ex + ey * ey;
+  };
+
+  double lane_minimum[KERNEL_LANES];
+  std::fill(lane_minimum, lane_minimum + KERNEL_LANES, std::numeric_limits<double>::infinity());
+  std::size_t i = 0u;
+  for (; i + KERNEL_LANES <= size; i += KERNEL_LANES) {
+    for (std::size_t lane = 0u; lane < KERNEL_LANES; ++lane) {
+      lane_minimum[lane] = std::min(lane_minimum[lane], edge_distance_squared(i + lane));
+    }
+  }
+  double minimum = *std::min_element(lane_minimum, lane_minimum + KERNEL_LANES);
+  for (; i < size; ++i) {
+    minimum = std::min(minimum, edge_distance_squared(i));
+  }
+  return minimum;
+}
+
+bool BoundaryPolygon::CrossesEdges(const BoundaryPolygon &other) const {
+  const std::size_t other_size = other.Size();
+  for (std::size_t i = 0u; i < Size(); ++i) {
+    const double ax = x[i];
+    const double ay = y[i];
+    const double adx = dx[i];
+    const double ady = dy[i];
+    // Sides of the end points of each edge with respect to the other edge;
+    // the edges cross when both pairs of end points lie on opposite sides.
+    // Touching edges are left to the vertex to edge distance.
+    bool crosses = false;
+    for (std::size_t j = 0u; j < other_size; ++j) {
+      const double rx = ax - other.x[j];
+      const double ry = ay - other.y[j];
+      const double direction_cross = other.dx[j] * ady - other.dy[j] * adx;
+      const double side_a_start = other.dx[j] * ry - other.dy[j] * rx;
+      const double side_a_end = side_a_start + direction_cross;
+      const double side_b_start = ady * rx - adx * ry;
+      const double side_b_end = side_b_start - direction_cross;
+      crosses |= (side_a_start * side_a_end < 0.0) & (side_b_start * side_b_end < 0.0);
+    }
+    if (crosses) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool BoundaryPolygon::Contains(const double px, const double py) const {
+  bool inside = false;
+  for (std::size_t i = 0u; i < Size(); ++i) {
+    const double start_y = y[i];
+    const double end_y = y[i] + dy[i];
+    if ((start_y > py) != (end_y > py)
+        && px < x[i] + (py - start_y) * dx[i] / dy[i]) {
+      inside = !inside;
+    }
+  }
+  return inside;
+}
+
+double BoundaryPolygon::Distance(const BoundaryPolygon &other) const {
+  DEBUG_ASSERT(!Empty() && !other.Empty());
+
+  double minimum = std::numeric_limits<double>::infinity();
+  for (std::size_t i = 0u; i < other.Size(); ++i) {
+    minimum = std::min(minimum, DistanceSquaredToEdges(other.x[i], other.y[i]));
+  }
+  for (std::size_t i = 0u; i < Size(); ++i) {
+    minimum = std::min(minimum, other.DistanceSquaredToEdges(x[i], y[i]));
+  }
+  if (minimum <= 0.0) {
+    return 0.0;
+  }
+
+  // The boundaries do not touch, but they may still cross each other or one
+  // may lie inside the other.
+  if (CrossesEdges(other)
+      || other.Contains(x.front(), y.front())
+      || Contains(other.x.front(), other.y.front())) {
+    return 0.0;
+  }
+
+  return std::sqrt(minimum);
+}
+
+GeometryComparison CompareGeometry(const BoundaryPolygon &reference_bbox,
+                                   const BoundaryPolygon &reference_geodesic,
+                                   const BoundaryPolygon &other_bbox,
+                                   const BoundaryPolygon &other_geodesic) {
+  using constants::Collision::OVERLAP_THRESHOLD;
+
+  // Broad phase. No hazard can be found between vehicles whose path boundaries
+  // do not overlap, so the bounding box distance, a lower bound of every
+  // distance below, stands in for all of them.
+  const double geodesic_bounding_box_distance = reference_geodesic.BoundingBoxDistance(other_geodesic);
+  if (geodesic_bounding_box_distance >= OVERLAP_THRESHOLD) {
+    return {geodesic_bounding_box_distance,
+            geodesic_bounding_box_distance,
+            geodesic_bounding_box_distance,
+            geodesic_bounding_box_distance};
+  }
+  return {reference_bbox.Distance(other_geodesic),
+          other_bbox.Distance(reference_geodesic),
+          reference_geodesic.Distance(other_geodesic),
+          reference_bbox.Distance(other_bbox)};
+}
+
+bool IsCollisionHazard(const GeometryComparison &comparison, const bool ego_angular_priority) {
+  using constants::Collision::OVERLAP_THRESHOLD;
+
+  // Conditions for collision negotiation.
+  bool geodesic_path_bbox_touching = comparison.inter_geodesic_distance < OVERLAP_THRESHOLD;
+  bool vehicle_bbox_touching = comparison.inter_bbox_distance < OVERLAP_THRESHOLD;
+  bool ego_path_clear = comparison.other_vehicle_to_reference_geodesic > OVERLAP_THRESHOLD;
+  bool other_path_clear = comparison.reference_vehicle_to_other_geodesic > OVERLAP_THRESHOLD;
+  bool ego_path_priority = comparison.reference_vehicle_to_other_geodesic < comparison.other_vehicle_to_reference_geodesic;
+  bool other_path_priority = comparison.reference_vehicle_to_other_geodesic > comparison.other_vehicle_to_reference_geodesic;
+
+  // Whichever vehicle's path is farthest away from the other vehicle gets priority to move.
+  bool lower_priority = !ego_path_priority && (other_path_priority || !ego_angular_priority);
+  bool blocked_by_other_or_lower_priority = !ego_path_clear || (other_path_clear && lower_priority);
+  bool yield_pre_crash = !vehicle_bbox_touching && blocked_by_other_or_lower_priority;
+  bool yield_post_crash = vehicle_bbox_touching && !ego_angular_priority;
+
+  return geodesic_path_bbox_touching && (yield_pre_crash || yield_post_crash);
+}
+
+} // namespace traffic_manager
+} // namespace carla
@@ -0,0 +1,93 @@
+
+#pragma once
+
+#include <vector>
+
+#include "carla/geom/Location.h"
+
+namespace carla {
+namespace traffic_manager {
+
+namespace cg = carla::geom;
+
+/// Top view of a closed boundary, a vehicle's bounding box or the path ahead
+/// of it, used by the collision stage. Edges are stored as a structure of
+/// arrays so that the distance kernels below run over contiguous memory and
+/// can be vectorized by the compiler.
+class BoundaryPolygon {
+public:
+
+  BoundaryPolygon() = default;
+
+  /// Builds the polygon from its vertices; the boundary is closed implicitly.
+  explicit BoundaryPolygon(const std::vector<cg::Location> &boundary);
+
+  std::size_t Size() const {
+    return x.size();
+  }
+
+  bool Empty() const {
+    return x.empty();
+  }
+
+  /// Distance between the axis aligned bounding boxes of both polygons. This
+  /// is a lower bound of the distance between the polygons.
+  double BoundingBoxDistance(const BoundaryPolygon &other) const;
+
+  /// Distance between both polygons considered as areas. Zero if they touch,
+  /// overlap or one contains the other.
+  double Distance(const BoundaryPolygon &other) const;
+
+private:
+
+  /// Squared distance from the point to the closest edge of this polygon.
+  double DistanceSquaredToEdges(const double px, const double py) const;
+
+  /// Whether any edge of this polygon properly crosses an edge of other.
+  bool CrossesEdges(const BoundaryPolygon &other) const;
+
+  /// Even-odd point in polygon test.
+  bool Contains(const double px, const double py) const;
+
+  /// Start point of every edge.
+  std::vector<double> x;
+  std::vector<double> y;
+  /// Direction of every edge, from its start point to the next vertex.
+  std::vector<double> dx;
+  std::vector<double> dy;
+  /// Inverse of the squared length of every edge, zero for degenerate edges.
+  std::vector<double> inverse_length_squared;
+
+  double min_x = 0.0;
+  double min_y = 0.0;
+  double max_x = 0.0;
+  double max_y = 0.0;
+};
+
+/// Distances between two actors, each given by its bounding box and the
+/// boundary of its path.
+struct GeometryComparison {
+  double reference_vehicle_to_other_geodesic;
+  double other_vehicle_to_reference_geodesic;
+  double inter_geodesic_distance;
+  double inter_bbox_distance;
+};
+
+/// Compares the bounding boxes and path boundaries of two actors. Path
+/// boundaries whose bounding boxes are further apart than the overlap
+/// threshold are rejected before any distance between polygons is computed;
+/// every distance is then the one between those bounding boxes, a lower bound
+/// of all of them.
+GeometryComparison CompareGeometry(const BoundaryPolygon &reference_bbox,
+                                   const BoundaryPolygon &reference_geodesic,
+                                   const BoundaryPolygon &other_bbox,
+                                   const BoundaryPolygon &other_geodesic);
+
+/// Geometric part of the collision negotiation: whether the reference vehicle
+/// has to yield to the other actor. Whichever vehicle's path is farthest away
+/// from the other vehicle gets priority to move, ties are broken by
+/// @a ego_angular_priority.
+bool IsCollisionHazard(const GeometryComparison &comparison, const bool ego_angular_priority);
+
+} // namespace traffic_manager
+} // namespace carla
@@ -9,7 +9,6 @@
 namespace carla {
 namespace traffic_manager {
 
-using Point2D = bg::model::point<double, 2, bg::cs::cartesian>;
 using TLS = carla::rpc::TrafficLightState;
 
 using namespace constants::Collision;
@@ -29,27 +28,68 @@ CollisionStage::CollisionStage(
     track_traffic(track_traffic),
     parameters(parameters),
     output_array(output_array),
+    cycle_caches(1u),
     random_device(random_device) {}
 
 void CollisionStage::Update(const unsigned long index) {
+  const ActorId ego_actor_id = vehicle_id_list.at(index);
+  CollisionLockEntry ego_lock = FindCollisionLock(ego_actor_id);
+  EvaluateHazard(index, cycle_caches.front(), ego_lock, random_device, false);
+}
+
+void CollisionStage::PrepareParallelUpdate(const std::size_t number_of_workers) {
+  if (cycle_caches.size() < number_of_workers) {
+    cycle_caches.resize(number_of_workers);
+  }
+
+  const std::size_t number_of_vehicles = vehicle_id_list.size();
+  pending_locks.resize(number_of_vehicles);
+  for (std::size_t i = 0u; i < number_of_vehicles; ++i) {
+    const ActorId actor_id = vehicle_id_list[i];
+    pending_locks[i] = FindCollisionLock(actor_id);
+    if (random_streams.find(actor_id) == random_streams.end()) {
+      random_streams.emplace(actor_id, RandomGenerator(random_device.NextSeed()));
+    }
+  }
+}
+
+void CollisionStage::ParallelUpdate(const unsigned long index, const std::size_t worker_index) {
+  RandomGenerator &random = random_streams.at(vehicle_id_list.at(index));
+  EvaluateHazard(index, cycle_caches.at(worker_index), pending_locks.at(index), random, true);
+}
+
+void CollisionStage::FinishParallelUpdate() {
+  for (std::size_t i = 0u; i < pending_locks.size() && i < vehicle_id_list.size(); ++i) {
+    CommitCollisionLock(vehicle_id_list[i], pending_locks[i]);
+  }
+  pending_locks.clear();
+}
+
+void CollisionStage::EvaluateHazard(const unsigned long index,
+                                    CollisionCycleCache &cache,
+                                    CollisionLockEntry &ego_lock,
+                                    RandomGenerator &random,
+                                    const bool parallel) {
   ActorId obstacle_id = 0u;
   bool collision_hazard = false;
   float available_distance_margin = std::numeric_limits<float>::infinity();
 
   const ActorId ego_actor_id = vehicle_id_list.at(index);
-  if (simulation_state.ContainsActor(ego_actor_id)) {
-    const cg::Location ego_location = simulation_state.GetLocation(ego_actor_id);
+  const std::size_t ego_slot = simulation_state.FindSlot(ego_actor_id);
+  if (ego_slot < simulation_state.Size()) {
+    const cg::Location ego_location = simulation_state.GetLocationAt(ego_slot);
     const Buffer &ego_buffer = buffer_map.at(ego_actor_id);
     const unsigned long look_ahead_index = GetTargetWaypoint(ego_buffer, JUNCTION_LOOK_AHEAD).second;
-    const float velocity = simulation_state.GetVelocity(ego_actor_id).Length();
+    const float velocity = simulation_state.GetVelocityAt(ego_slot).Length();
 
-    ActorIdSet overlapping_actors = track_traffic.GetOverlappingVehicles(ego_actor_id);
-    std::vector<ActorId> collision_candidate_ids;
+    ActorIdList &overlapping_actors = cache.overlapping_actors;
+    track_traffic.GetOverlappingVehicles(ego_actor_id, overlapping_actors);
+    std::vector<CollisionCandidate> collision_candidates;
     // Run through vehicles with overlapping paths and filter them;
     const float distance_to_leading = parameters.GetDistanceToLeadingVehicle(ego_actor_id);
     float collision_radius_square = SQUARE(COLLISION_RADIUS_RATE * velocity + COLLISION_RADIUS_MIN);
     if (velocity < 2.0f) {
-      const float length = simulation_state.GetDimensions(ego_actor_id).x;
+      const float length = simulation_state.GetDimensionsAt(ego_slot).x;
       const float collision_radius_stop = COLLISION_RADIUS_STOP + length;
       collision_radius_square = SQUARE(collision_radius_stop);
     }
@@ -59,41 +99,48 @@ void CollisionStage::Update(const unsigned long index) {
 
     for (ActorId overlapping_actor_id : overlapping_actors) {
       // If actor is within maximum collision avoidance and vertical overlap range.
-      const cg::Location &overlapping_actor_location = simulation_state.GetLocation(overlapping_actor_id);
+      const std::size_t overlapping_actor_slot = simulation_state.GetSlot(overlapping_actor_id);
+      const cg::Location &overlapping_actor_location = simulation_state.GetLocationAt(overlapping_actor_slot);
+      const float distance_square = cg::Math::DistanceSquared(overlapping_actor_location, ego_location);
       if (overlapping_actor_id != ego_actor_id
-          && cg::Math::DistanceSquared(overlapping_actor_location, ego_location) < collision_radius_square
+          && distance_square < collision_radius_square
           && std::abs(ego_location.z - overlapping_actor_location.z) < VERTICAL_OVERLAP_THRESHOLD) {
-        collision_candidate_ids.push_back(overlapping_actor_id);
+        collision_candidates.push_back({distance_square, overlapping_actor_id, overlapping_actor_slot});
       }
     }
 
     // Sorting collision candidates in accending order of distance to current vehicle.
-    std::sort(collision_candidate_ids.begin(), collision_candidate_ids.end(),
-              [this, &ego_location](const ActorId &a_id_1, const ActorId &a_id_2) {
-                const cg::Location &e_loc = ego_location;
-                const cg::Location &loc_1 = simulation_state.GetLocation(a_id_1);
-                const cg::Location &loc_2 = simulation_state.GetLocation(a_id_2);
-                return (cg::Math::DistanceSquared(e_loc, loc_1) < cg::Math::DistanceSquared(e_loc, loc_2));
+    std::sort(collision_candidates.begin(), collision_candidates.end(),
+              [](const CollisionCandidate &candidate_1, const CollisionCandidate &candidate_2) {
+                return candidate_1.distance_square < candidate_2.distance_square;
               });
 
     // Check every actor in the vicinity if it poses a collision hazard.
-    for (auto iter = collision_candidate_ids.begin();
-         iter != collision_candidate_ids.end() && !collision_hazard;
+    for (auto iter = collision_candidates.begin();
+         iter != collision_candidates.end() && !collision_hazard;
          ++iter) {
-      const ActorId other_actor_id = *iter;
-      const ActorType other_actor_type = simulation_state.GetType(other_actor_id);
+      const ActorId other_actor_id = iter->actor_id;
+      const std::size_t other_slot = iter->slot;
+      const ActorType other_actor_type = simulation_state.GetTypeAt(other_slot);
 
+      // Candidates were found in the simulation state, so they are present.
       if (parameters.GetCollisionDetection(ego_actor_id, other_actor_id)
-          && buffer_map.find(ego_actor_id) != buffer_map.end()
-          && simulation_state.ContainsActor(other_actor_id)) {
+          && buffer_map.find(ego_actor_id) != buffer_map.end()) {
         std::pair<bool, float> negotiation_result = NegotiateCollision(ego_actor_id,
+                                                                       ego_slot,
                                                                        other_actor_id,
-                                                                       look_ahead_index);
+                                                                       other_slot,
+                                                                       look_ahead_index,
+                                                                       cache,
+                                                                       ego_lock);
+        if (!parallel) {
+          CommitCollisionLock(ego_actor_id, ego_lock);
+        }
         if (negotiation_result.first) {
           if ((other_actor_type == ActorType::Vehicle
-               && parameters.GetPercentageIgnoreVehicles(ego_actor_id) <= random_device.next())
+               && parameters.GetPercentageIgnoreVehicles(ego_actor_id) <= random.next())
               || (other_actor_type == ActorType::Pedestrian
-                  && parameters.GetPercentageIgnoreWalkers(ego_actor_id) <= random_device.next())) {
+                  && parameters.GetPercentageIgnoreWalkers(ego_actor_id) <= random.next())) {
             collision_hazard = true;
             obstacle_id = other_actor_id;
             available_distance_margin = negotiation_result.second;
@@ -111,15 +158,37 @@ void CollisionStage::Update(const unsigned long index) {
 
 void CollisionStage::RemoveActor(const ActorId actor_id) {
   collision_locks.erase(actor_id);
+  random_streams.erase(actor_id);
 }
 
 void CollisionStage::Reset() {
   collision_locks.clear();
+  pending_locks.clear();
+  random_streams.clear();
+  ClearCycleCache();
+}
+
+CollisionLockEntry CollisionStage::FindCollisionLock(const ActorId actor_id) const {
+  CollisionLockEntry entry{false, {0.0, 0.0, 0u}};
+  auto lock_it = collision_locks.find(actor_id);
+  if (lock_it != collision_locks.end()) {
+    entry.locked = true;
+    entry.lock = lock_it->second;
+  }
+  return entry;
 }
 
-float CollisionStage::GetBoundingBoxExtention(const ActorId actor_id) {
+void CollisionStage::CommitCollisionLock(const ActorId actor_id, const CollisionLockEntry &entry) {
+  if (entry.locked) {
+    collision_locks[actor_id] = entry.lock;
+  } else {
+    collision_locks.erase(actor_id);
+  }
+}
 
-  const float velocity = cg::Math::Dot(simulation_state.GetVelocity(actor_id), simulation_state.GetHeading(actor_id));
+float CollisionStage::GetBoundingBoxExtention(const ActorId actor_id, const std::size_t slot) {
+
+  const float velocity = cg::Math::Dot(simulation_state.GetVelocityAt(slot), simulation_state.GetHeadingAt(slot));
   float bbox_extension;
   // Using a function to calculate boundary length.
   float velocity_extension = VEL_EXT_FACTOR * velocity;
@@ -138,17 +207,17 @@ float CollisionStage::GetBoundingBoxExtention(const ActorId actor_id) {
   return bbox_extension;
 }
 
-LocationVector CollisionStage::GetBoundary(const ActorId actor_id) {
-  const ActorType actor_type = simulation_state.GetType(actor_id);
-  const cg::Vector3D heading_vector = simulation_state.GetHeading(actor_id);
+LocationVector CollisionStage::GetBoundary(const std::size_t slot) {
+  const ActorType actor_type = simulation_state.GetTypeAt(slot);
+  const cg::Vector3D heading_vector = simulation_state.GetHeadingAt(slot);
 
   float forward_extension = 0.0f;
   if (actor_type == ActorType::Pedestrian) {
     // Extend the pedestrians bbox to "predict" where they'll be and avoid collisions.
-    forward_extension = simulation_state.GetVelocity(actor_id).Length() * WALKER_TIME_EXTENSION;
+    forward_extension = simulation_state.GetVelocityAt(slot).Length() * WALKER_TIME_EXTENSION;
   }
 
-  cg::Vector3D dimensions = simulation_state.GetDimensions(actor_id);
+  cg::Vector3D dimensions = simulation_state.GetDimensionsAt(slot);
 
   float bbox_x = dimensions.x;
   float bbox_y = dimensions.y;
@@ -158,7 +227,7 @@ LocationVector CollisionStage::GetBoundary(const ActorId actor_id) {
   const cg::Vector3D y_boundary_vector = perpendicular_vector * (bbox_y + forward_extension);
 
   // Four corners of the vehicle in top view clockwise order (left-handed system).
-  const cg::Location location = simulation_state.GetLocation(actor_id);
+  const cg::Location location = simulation_state.GetLocationAt(slot);
   LocationVector bbox_boundary = {
       location + cg::Location(x_boundary_vector - y_boundary_vector),
       location + cg::Location(-1.0f * x_boundary_vector - y_boundary_vector),
@@ -169,23 +238,25 @@ LocationVector CollisionStage::GetBoundary(const ActorId actor_id) {
   return bbox_boundary;
 }
 
-LocationVector CollisionStage::GetGeodesicBoundary(const ActorId actor_id) {
-  LocationVector geodesic_boundary;
+const ActorBoundaries &CollisionStage::GetBoundaries(const ActorId actor_id,
+                                                     const std::size_t slot,
+                                                     CollisionCycleCache &cache) {
+  ActorBoundariesMap &boundaries_map = cache.boundaries_map;
 
-  if (geodesic_boundary_map.find(actor_id) != geodesic_boundary_map.end()) {
-    geodesic_boundary = geodesic_boundary_map.at(actor_id);
-  } else {
-    const LocationVector bbox = GetBoundary(actor_id);
+  auto boundaries_it = boundaries_map.find(actor_id);
+  if (boundaries_it == boundaries_map.end()) {
+    LocationVector geodesic_boundary;
+    const LocationVector bbox = GetBoundary(slot);
 
     if (buffer_map.find(actor_id) != buffer_map.end()) {
-      float bbox_extension = GetBoundingBoxExtention(actor_id);
+      float bbox_extension = GetBoundingBoxExtention(actor_id, slot);
       const float specific_lead_distance = parameters.GetDistanceToLeadingVehicle(actor_id);
       bbox_extension = std::max(specific_lead_distance, bbox_extension);
       const float bbox_extension_square = SQUARE(bbox_extension);
 
       LocationVector left_boundary;
       LocationVector right_boundary;
-      cg::Vector3D dimensions = simulation_state.GetDimensions(actor_id);
+      cg::Vector3D dimensions = simulation_state.GetDimensionsAt(slot);
       const float width = dimensions.y;
       const float length = dimensions.x;
 
@@ -236,26 +307,18 @@ LocationVector CollisionStage::GetGeodesicBoundary(const ActorId actor_id) {
       geodesic_boundary = bbox;
     }
 
-    geodesic_boundary_map.insert({actor_id, geodesic_boundary});
-  }
-
-  return geodesic_boundary;
-}
-
-Polygon CollisionStage::GetPolygon(const LocationVector &boundary) {
-
-  traffic_manager::Polygon boundary_polygon;
-  for (const cg::Location &location : boundary) {
-    bg::append(boundary_polygon.outer(), Point2D(location.x, location.y));
+    boundaries_it = boundaries_map.emplace(actor_id, ActorBoundaries{BoundaryPolygon(bbox), BoundaryPolygon(geodesic_boundary)}).first;
   }
-  bg::append(boundary_polygon.outer(), Point2D(boundary.front().x, boundary.front().y));
 
-  return boundary_polygon;
+  return boundaries_it->second;
 }
 
 GeometryComparison CollisionStage::GetGeometryBetweenActors(const ActorId reference_vehicle_id,
-                                                            const ActorId other_actor_id) {
-
+                                                            const std::size_t reference_slot,
+                                                            const ActorId other_actor_id,
+                                                            const std::size_t other_slot,
+                                                            CollisionCycleCache &cache) {
+  GeometryComparisonMap &geometry_cache = cache.geometry_cache;
 
   std::pair<ActorId, ActorId> key_parts;
   if (reference_vehicle_id < other_actor_id) {
@@ -279,22 +342,10 @@ GeometryComparison CollisionStage::GetGeometryBetweenActors(const ActorId refere
     comparision_result.other_vehicle_to_reference_geodesic = mref_veh_other;
   } else {
 
-    const Polygon reference_polygon = GetPolygon(GetBoundary(reference_vehicle_id));
-    const Polygon other_polygon = GetPolygon(GetBoundary(other_actor_id));
-
-    const Polygon reference_geodesic_polygon = GetPolygon(GetGeodesicBoundary(reference_vehicle_id));
-
-    const Polygon other_geodesic_polygon = GetPolygon(GetGeodesicBoundary(other_actor_id));
-
-    const double reference_vehicle_to_other_geodesic = bg::distance(reference_polygon, other_geodesic_polygon);
-    const double other_vehicle_to_reference_geodesic = bg::distance(other_polygon, reference_geodesic_polygon);
-    const auto inter_geodesic_distance = bg::distance(reference_geodesic_polygon, other_geodesic_polygon);
-    const auto inter_bbox_distance = bg::distance(reference_polygon, other_polygon);
-
-    comparision_result = {reference_vehicle_to_other_geodesic,
-              other_vehicle_to_reference_geodesic,
-              inter_geodesic_distance,
-              inter_bbox_distance};
+    const ActorBoundaries &reference_boundaries = GetBoundaries(reference_vehicle_id, reference_slot, cache);
+    const ActorBoundaries &other_boundaries = GetBoundaries(other_actor_id, other_slot, cache);
+    comparision_result = CompareGeometry(reference_boundaries.bbox, reference_boundaries.geodesic,
+                                         other_boundaries.bbox, other_boundaries.geodesic);
 
     geometry_cache.insert({actor_id_key, comparision_result});
   }
@@ -303,33 +354,37 @@ GeometryComparison CollisionStage::GetGeometryBetweenActors(const ActorId refere
 }
 
 std::pair<bool, float> CollisionStage::NegotiateCollision(const ActorId reference_vehicle_id,
+                                                          const std::size_t reference_slot,
                                                           const ActorId other_actor_id,
-                                                          const uint64_t reference_junction_look_ahead_index) {
+                                                          const std::size_t other_slot,
+                                                          const uint64_t reference_junction_look_ahead_index,
+                                                          CollisionCycleCache &cache,
+                                                          CollisionLockEntry &reference_lock) {
   // Output variables for the method.
   bool hazard = false;
   float available_distance_margin = std::numeric_limits<float>::infinity();
 
-  const cg::Location reference_location = simulation_state.GetLocation(reference_vehicle_id);
-  const cg::Location other_location = simulation_state.GetLocation(other_actor_id);
+  const cg::Location reference_location = simulation_state.GetLocationAt(reference_slot);
+  const cg::Location other_location = simulation_state.GetLocationAt(other_slot);
 
   // Ego and other vehicle heading.
-  const cg::Vector3D reference_heading = simulation_state.GetHeading(reference_vehicle_id);
+  const cg::Vector3D reference_heading = simulation_state.GetHeadingAt(reference_slot);
   // Vector from ego position to position of the other vehicle.
   cg::Vector3D reference_to_other = other_location - reference_location;
   reference_to_other = reference_to_other.MakeSafeUnitVector(EPSILON);
 
   // Other vehicle heading.
-  const cg::Vector3D other_heading = simulation_state.GetHeading(other_actor_id);
+  const cg::Vector3D other_heading = simulation_state.GetHeadingAt(other_slot);
   // Vector from other vehicle position to ego position.
   cg::Vector3D other_to_reference = reference_location - other_location;
   other_to_reference = other_to_reference.MakeSafeUnitVector(EPSILON);
 
-  float reference_vehicle_length = simulation_state.GetDimensions(reference_vehicle_id).x * SQUARE_ROOT_OF_TWO;
-  float other_vehicle_length = simulation_state.GetDimensions(other_actor_id).x * SQUARE_ROOT_OF_TWO;
+  float reference_vehicle_length = simulation_state.GetDimensionsAt(reference_slot).x * SQUARE_ROOT_OF_TWO;
+  float other_vehicle_length = simulation_state.GetDimensionsAt(other_slot).x * SQUARE_ROOT_OF_TWO;
 
   float inter_vehicle_distance = cg::Math::DistanceSquared(reference_location, other_location);
-  float ego_bounding_box_extension = GetBoundingBoxExtention(reference_vehicle_id);
-  float other_bounding_box_extension = GetBoundingBoxExtention(other_actor_id);
+  float ego_bounding_box_extension = GetBoundingBoxExtention(reference_vehicle_id, reference_slot);
+  float other_bounding_box_extension = GetBoundingBoxExtention(other_actor_id, other_slot);
   // Calculate minimum distance between vehicle to consider collision negotiation.
   float inter_vehicle_length = reference_vehicle_length + other_vehicle_length;
   float ego_detection_range = SQUARE(ego_bounding_box_extension + inter_vehicle_length);
@@ -343,7 +398,7 @@ std::pair<bool, float> CollisionStage::NegotiateCollision(const ActorId referenc
   const Buffer &reference_vehicle_buffer = buffer_map.at(reference_vehicle_id);
   SimpleWaypointPtr closest_point = reference_vehicle_buffer.front();
   bool ego_inside_junction = closest_point->CheckJunction();
-  TrafficLightState reference_tl_state = simulation_state.GetTLS(reference_vehicle_id);
+  const TrafficLightState &reference_tl_state = simulation_state.GetTLSAt(reference_slot);
   bool ego_at_traffic_light = reference_tl_state.at_traffic_light;
   bool ego_stopped_by_light = reference_tl_state.tl_state != TLS::Green && reference_tl_state.tl_state != TLS::Off;
   SimpleWaypointPtr look_ahead_point = reference_vehicle_buffer.at(reference_junction_look_ahead_index);
@@ -353,24 +408,12 @@ std::pair<bool, float> CollisionStage::NegotiateCollision(const ActorId referenc
   if (!(ego_at_junction_entrance && ego_at_traffic_light && ego_stopped_by_light)
       && ((ego_inside_junction && other_vehicles_in_cross_detection_range)
           || (!ego_inside_junction && other_vehicle_in_front && other_vehicle_in_ego_range))) {
-    GeometryComparison geometry_comparison = GetGeometryBetweenActors(reference_vehicle_id, other_actor_id);
-
-    // Conditions for collision negotiation.
-    bool geodesic_path_bbox_touching = geometry_comparison.inter_geodesic_distance < OVERLAP_THRESHOLD;
-    bool vehicle_bbox_touching = geometry_comparison.inter_bbox_distance < OVERLAP_THRESHOLD;
-    bool ego_path_clear = geometry_comparison.other_vehicle_to_reference_geodesic > OVERLAP_THRESHOLD;
-    bool other_path_clear = geometry_comparison.reference_vehicle_to_other_geodesic > OVERLAP_THRESHOLD;
-    bool ego_path_priority = geometry_comparison.reference_vehicle_to_other_geodesic < geometry_comparison.other_vehicle_to_reference_geodesic;
-    bool other_path_priority = geometry_comparison.reference_vehicle_to_other_geodesic > geometry_comparison.other_vehicle_to_reference_geodesic;
-    bool ego_angular_priority = reference_heading_to_other_dot< cg::Math::Dot(other_heading, other_to_reference);
+    GeometryComparison geometry_comparison = GetGeometryBetweenActors(reference_vehicle_id, reference_slot,
+                                                                      other_actor_id, other_slot, cache);
 
-    // Whichever vehicle's path is farthest away from the other vehicle gets priority to move.
-    bool lower_priority = !ego_path_priority && (other_path_priority || !ego_angular_priority);
-    bool blocked_by_other_or_lower_priority = !ego_path_clear || (other_path_clear && lower_priority);
-    bool yield_pre_crash = !vehicle_bbox_touching && blocked_by_other_or_lower_priority;
-    bool yield_post_crash = vehicle_bbox_touching && !ego_angular_priority;
+    bool ego_angular_priority = reference_heading_to_other_dot< cg::Math::Dot(other_heading, other_to_reference);
 
-    if (geodesic_path_bbox_touching && (yield_pre_crash || yield_post_crash)) {
+    if (IsCollisionHazard(geometry_comparison, ego_angular_priority)) {
 
       hazard = true;
 
@@ -385,8 +428,8 @@ std::pair<bool, float> CollisionStage::NegotiateCollision(const ActorId referenc
       // This enables us to smoothly approach the lead vehicle.
 
       // When possible collision found, check if an entry for collision lock present.
-      if (collision_locks.find(reference_vehicle_id) != collision_locks.end()) {
-        CollisionLock &lock = collision_locks.at(reference_vehicle_id);
+      if (reference_lock.locked) {
+        CollisionLock &lock = reference_lock.lock;
         // Check if the same vehicle is under lock.
         if (other_actor_id == lock.lead_vehicle_id) {
           // If the body of the lead vehicle is touching the reference vehicle bounding box.
@@ -403,25 +446,27 @@ std::pair<bool, float> CollisionStage::NegotiateCollision(const ActorId referenc
         }
       } else {
         // Insert and initialize lock entry if not present.
-        collision_locks.insert({reference_vehicle_id,
-                                {geometry_comparison.inter_bbox_distance,
-                                 geometry_comparison.inter_bbox_distance,
-                                 other_actor_id}});
+        reference_lock.locked = true;
+        reference_lock.lock = {geometry_comparison.inter_bbox_distance,
+                               geometry_comparison.inter_bbox_distance,
+                               other_actor_id};
       }
     }
   }
 
   // If no collision hazard detected, then flush collision lock held by the vehicle.
-  if (!hazard && collision_locks.find(reference_vehicle_id) != collision_locks.end()) {
-    collision_locks.erase(reference_vehicle_id);
+  if (!hazard && reference_lock.locked) {
+    reference_lock.locked = false;
   }
 
   return {hazard, available_distance_margin};
 }
 
 void CollisionStage::ClearCycleCache() {
-  geodesic_boundary_map.clear();
-  geometry_cache.clear();
+  for (CollisionCycleCache &cache : cycle_caches) {
+    cache.boundaries_map.clear();
+    cache.geometry_cache.clear();
+  }
 }
 
 } // namespace traffic_manager
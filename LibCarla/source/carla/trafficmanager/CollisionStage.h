@@ -3,34 +3,17 @@
 
 #include <memory>
 
-#if defined(__clang__)
-#  pragma clang diagnostic push
-#  pragma clang diagnostic ignored "-Wshadow"
-#endif
-#include "boost/geometry.hpp"
-#include "boost/geometry/geometries/geometries.hpp"
-#include "boost/geometry/geometries/point_xy.hpp"
-#include "boost/geometry/geometries/polygon.hpp"
-#if defined(__clang__)
-#  pragma clang diagnostic pop
-#endif
-
+#include "carla/trafficmanager/CollisionGeometry.h"
 #include "carla/trafficmanager/DataStructures.h"
 #include "carla/trafficmanager/Parameters.h"
 #include "carla/trafficmanager/RandomGenerator.h"
 #include "carla/trafficmanager/SimulationState.h"
 #include "carla/trafficmanager/Stage.h"
+#include "carla/trafficmanager/TrackTraffic.h"
 
 namespace carla {
 namespace traffic_manager {
 
-struct GeometryComparison {
-  double reference_vehicle_to_other_geodesic;
-  double other_vehicle_to_reference_geodesic;
-  double inter_geodesic_distance;
-  double inter_bbox_distance;
-};
-
 struct CollisionLock {
   double distance_to_lead_vehicle;
   double initial_lock_distance;
@@ -38,15 +21,41 @@ struct CollisionLock {
 };
 using CollisionLockMap = std::unordered_map<ActorId, CollisionLock>;
 
+/// Collision lock held by a vehicle, if any.
+struct CollisionLockEntry {
+  bool locked;
+  CollisionLock lock;
+};
+
+/// Actor near a vehicle, with its squared distance to the vehicle and its
+/// slot in the simulation state.
+struct CollisionCandidate {
+  float distance_square;
+  ActorId actor_id;
+  std::size_t slot;
+};
+
 namespace cc = carla::client;
-namespace bg = boost::geometry;
 
-using Buffer = std::deque<std::shared_ptr<SimpleWaypoint>>;
+using Buffer = WaypointBuffer;
 using BufferMap = std::unordered_map<carla::ActorId, Buffer>;
 using LocationVector = std::vector<cg::Location>;
-using GeodesicBoundaryMap = std::unordered_map<ActorId, LocationVector>;
+/// Top view of an actor: its bounding box and the boundary of its path.
+struct ActorBoundaries {
+  BoundaryPolygon bbox;
+  BoundaryPolygon geodesic;
+};
+using ActorBoundariesMap = std::unordered_map<ActorId, ActorBoundaries>;
 using GeometryComparisonMap = std::unordered_map<uint64_t, GeometryComparison>;
-using Polygon = bg::model::polygon<bg::model::d2::point_xy<double>>;
+
+/// Geometry computed within one update cycle, along with the buffer reused by
+/// overlap queries. When the stage is updated in parallel every worker owns
+/// one of these, so no locking is needed.
+struct CollisionCycleCache {
+  GeometryComparisonMap geometry_cache;
+  ActorBoundariesMap boundaries_map;
+  ActorIdList overlapping_actors;
+};
 
 /// This class has functionality to detect potential collision with a nearby actor.
 class CollisionStage : Stage {
@@ -62,30 +71,64 @@ private:
   // Structures to cache geodesic boundaries of vehicle and
   // comparision between vehicle boundaries
   // to avoid repeated computation within a cycle.
-  GeometryComparisonMap geometry_cache;
-  GeodesicBoundaryMap geodesic_boundary_map;
+  // The first cache is the one used by the serial update.
+  std::vector<CollisionCycleCache> cycle_caches;
+  // Collision locks decided during a parallel update, indexed like
+  // vehicle_id_list. They are applied once all workers are done so that
+  // every worker reads the same collision locks.
+  std::vector<CollisionLockEntry> pending_locks;
+  // Random stream of every vehicle updated in parallel, seeded from
+  // random_device the first time the vehicle is prepared. A vehicle only
+  // draws from its own stream, so the draws do not depend on the order in
+  // which the workers update the vehicles.
+  std::unordered_map<ActorId, RandomGenerator> random_streams;
   RandomGenerator &random_device;
 
+  // Method to run the collision checks of a vehicle, drawing the chance of
+  // ignoring other actors from random. In parallel mode the collision lock
+  // is only written to ego_lock.
+  void EvaluateHazard(const unsigned long index,
+                      CollisionCycleCache &cache,
+                      CollisionLockEntry &ego_lock,
+                      RandomGenerator &random,
+                      const bool parallel);
+
   // Method to determine if a vehicle is on a collision path to another.
+  // Actors are given along with their slot in the simulation state.
   std::pair<bool, float> NegotiateCollision(const ActorId reference_vehicle_id,
+                                            const std::size_t reference_slot,
                                             const ActorId other_actor_id,
-                                            const uint64_t reference_junction_look_ahead_index);
+                                            const std::size_t other_slot,
+                                            const uint64_t reference_junction_look_ahead_index,
+                                            CollisionCycleCache &cache,
+                                            CollisionLockEntry &reference_lock);
 
-  // Method to calculate bounding box extention length ahead of the vehicle.
-  float GetBoundingBoxExtention(const ActorId actor_id);
+  // Method to retrieve the collision lock currently held by a vehicle.
+  CollisionLockEntry FindCollisionLock(const ActorId actor_id) const;
 
-  // Method to calculate polygon points around the vehicle's bounding box.
-  LocationVector GetBoundary(const ActorId actor_id);
+  // Method to store the collision lock held by a vehicle.
+  void CommitCollisionLock(const ActorId actor_id, const CollisionLockEntry &entry);
 
-  // Method to construct polygon points around the path boundary of the vehicle.
-  LocationVector GetGeodesicBoundary(const ActorId actor_id);
+  // Method to calculate bounding box extention length ahead of the vehicle.
+  float GetBoundingBoxExtention(const ActorId actor_id, const std::size_t slot);
 
-  Polygon GetPolygon(const LocationVector &boundary);
+  // Method to calculate polygon points around the bounding box of the actor
+  // in the given slot.
+  LocationVector GetBoundary(const std::size_t slot);
+
+  // Method to construct the polygons around the bounding box and the path
+  // boundary of the vehicle. They are cached for reuse in current update cycle.
+  const ActorBoundaries &GetBoundaries(const ActorId actor_id,
+                                       const std::size_t slot,
+                                       CollisionCycleCache &cache);
 
   // Method to compare path boundaries, bounding boxes of vehicles
   // and cache the results for reuse in current update cycle.
   GeometryComparison GetGeometryBetweenActors(const ActorId reference_vehicle_id,
-                                              const ActorId other_actor_id);
+                                              const std::size_t reference_slot,
+                                              const ActorId other_actor_id,
+                                              const std::size_t other_slot,
+                                              CollisionCycleCache &cache);
 
   // Method to draw path boundary.
   void DrawBoundary(const LocationVector &boundary);
@@ -101,6 +144,20 @@ public:
 
   void Update (const unsigned long index) override;
 
+  // Method to prepare the stage for being updated by number_of_workers threads.
+  // Must be called after the frames are resized and before any ParallelUpdate.
+  void PrepareParallelUpdate(const std::size_t number_of_workers);
+
+  // Thread-safe counterpart of Update. Vehicles sharing a worker_index
+  // must not be updated concurrently. The result does not depend on the
+  // number of workers nor on how vehicles are distributed among them, but
+  // differs from Update, as every vehicle reads the collision locks as they
+  // were when the update was prepared and draws from its own random stream.
+  void ParallelUpdate(const unsigned long index, const std::size_t worker_index);
+
+  // Method to apply the collision locks decided during a parallel update.
+  void FinishParallelUpdate();
+
   void RemoveActor(const ActorId actor_id) override;
 
   void Reset() override;
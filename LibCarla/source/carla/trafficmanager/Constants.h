@@ -48,6 +48,8 @@ static const float MAX_START_DISTANCE = 20.0f;
 static const float MINIMUM_HORIZON_LENGTH = 15.0f;
 static const float HORIZON_RATE = 2.0f;
 static const float HIGH_SPEED_HORIZON_RATE = 4.0f;
+// Initial capacity of a vehicle's waypoint buffer, must be a power of two.
+static const uint32_t INITIAL_BUFFER_CAPACITY = 64u;
 } // namespace PathBufferUpdate
 
 namespace WaypointSelection {
@@ -160,6 +162,23 @@ static const uint64_t BUFFER_STEP_THROUGH = 5;
 static const float INV_BUFFER_STEP_THROUGH = 1.0f / static_cast<float>(BUFFER_STEP_THROUGH);
 } // namespace TrackTraffic
 
+namespace TickLOD {
+// Default distance bands, in meters, and the update period of each band.
+static constexpr float DEFAULT_DISTANCES[] = {150.0f, 300.0f, 600.0f};
+static constexpr uint16_t DEFAULT_PERIODS[] = {2u, 4u, 8u};
+// Teleports moving a vehicle further than this are not extrapolated.
+static const float MAX_EXTRAPOLATED_DISPLACEMENT = 10.0f;
+} // namespace TickLOD
+
+namespace Profiler {
+// Linear sub-buckets per power of two in the duration histograms.
+static const uint32_t HISTOGRAM_SUB_BUCKETS = 8u;
+// Powers of two covered by the histograms, durations are in nanoseconds.
+static const uint32_t HISTOGRAM_OCTAVES = 40u;
+// Number of cycles kept for the trace export.
+static const uint32_t TRACE_CAPACITY = 1024u;
+} // namespace Profiler
+
 } // namespace constants
 } // namespace traffic_manager
 } // namespace carla
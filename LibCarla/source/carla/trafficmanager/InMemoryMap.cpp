@@ -4,12 +4,19 @@
 // This work is licensed under the terms of the MIT license.
 // For a copy, see <https://opensource.org/licenses/MIT>.
 
+#include "carla/FileSystem.h"
 #include "carla/Logging.h"
+#include "carla/ThreadPool.h"
 
 #include "carla/trafficmanager/Constants.h"
 #include "carla/trafficmanager/InMemoryMap.h"
 #include <boost/geometry/geometries/box.hpp>
 
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+
 namespace carla {
 namespace traffic_manager {
 
@@ -82,34 +89,169 @@ namespace traffic_manager {
       filename = path;
     }
 
+    // Describe the dense topology with indices instead of waypoint ids.
+    std::vector<map_cache::WaypointRecord> records;
+    std::vector<std::vector<uint32_t>> next_links(dense_topology.size());
+    std::vector<std::vector<uint32_t>> previous_links(dense_topology.size());
+    records.reserve(dense_topology.size());
+    auto index_of = [](const SimpleWaypointPtr &swp) {
+      return swp != nullptr ? swp->GetIndex() : map_cache::INVALID_INDEX;
+    };
+    for (std::size_t i = 0u; i < dense_topology.size(); ++i) {
+      const SimpleWaypointPtr &swp = dense_topology[i];
+      const WaypointPtr waypoint = swp->GetWaypoint();
+      const cg::Transform transform = swp->GetTransform();
+
+      map_cache::WaypointRecord record;
+      std::memset(&record, 0, sizeof(record));
+      record.road_id = waypoint->GetRoadId();
+      record.section_id = waypoint->GetSectionId();
+      record.lane_id = waypoint->GetLaneId();
+      record.s = static_cast<float>(waypoint->GetDistance());
+      record.x = transform.location.x;
+      record.y = transform.location.y;
+      record.z = transform.location.z;
+      record.pitch = transform.rotation.pitch;
+      record.yaw = transform.rotation.yaw;
+      record.roll = transform.rotation.roll;
+      record.geodesic_grid_id = swp->GetGeodesicGridId();
+      record.left_index = index_of(swp->GetLeftWaypoint());
+      record.right_index = index_of(swp->GetRightWaypoint());
+      record.is_junction = swp->CheckJunction() ? 1u : 0u;
+      record.road_option = static_cast<uint8_t>(swp->GetRoadOption());
+      records.push_back(record);
+
+      for (auto &next_waypoint : swp->GetNextWaypoint()) {
+        next_links[i].push_back(next_waypoint->GetIndex());
+      }
+      for (auto &previous_waypoint : swp->GetPreviousWaypoint()) {
+        previous_links[i].push_back(previous_waypoint->GetIndex());
+      }
+    }
+    const std::vector<uint8_t> content = InMemoryMapCache::Serialize(records, next_links, previous_links, GetOpenDriveKey());
+
+    // Write to a temporary file and move it in place, so that other processes
+    // never map a partially written cache.
+    const std::string temporary_filename = FileSystem::GetTemporaryFilePath(filename);
     std::ofstream out_file;
-    out_file.open(filename, std::ios::binary);
+    out_file.open(temporary_filename, std::ios::binary);
     if (!out_file.is_open()) {
       log_error("Could not open binary file");
       return;
     }
+    out_file.write(reinterpret_cast<const char *>(content.data()), static_cast<std::streamsize>(content.size()));
+    out_file.close();
+    if (!out_file) {
+      log_error("Could not write binary file");
+      std::remove(temporary_filename.c_str());
+      return;
+    }
+
+    if (std::rename(temporary_filename.c_str(), filename.c_str()) != 0) {
+      // Some platforms do not replace existing files on rename.
+      std::remove(filename.c_str());
+      if (std::rename(temporary_filename.c_str(), filename.c_str()) != 0) {
+        log_error("Could not move binary file to", filename);
+        std::remove(temporary_filename.c_str());
+      }
+    }
+  }
+
+  bool InMemoryMap::Load(const std::string& filename) {
+    InMemoryMapCache cache;
+    return cache.Open(filename, GetOpenDriveKey()) && LoadCache(cache);
+  }
 
-    // write total records
-    uint32_t total = static_cast<uint32_t>(dense_topology.size());
-    out_file.write(reinterpret_cast<const char *>(&total), sizeof(uint32_t));
+  InMemoryMapCache::OpenDriveKey InMemoryMap::GetOpenDriveKey() const {
+    assert(_world_map != nullptr && "No map reference found.");
+    return crd::PrecompiledMap::GetOpenDriveKey(_world_map->GetOpenDrive());
+  }
 
-    // write simple waypoints
-    std::unordered_set<uint64_t> used_ids;
-    for (auto& wp: dense_topology) {
-      if (used_ids.find(wp->GetId()) != used_ids.end()) {
-        log_error("Could not generate the binary file. There are repeated waypoints");
+  bool InMemoryMap::LoadCache(const InMemoryMapCache &cache) {
+    const uint32_t total = cache.GetWaypointCount();
+    std::vector<crd::element::Waypoint> road_waypoints;
+    std::vector<cg::Transform> transforms;
+    road_waypoints.reserve(total);
+    transforms.reserve(total);
+    for (uint32_t i = 0u; i < total; ++i) {
+      const map_cache::WaypointRecord &record = cache.GetRecord(i);
+      crd::element::Waypoint road_waypoint;
+      road_waypoint.road_id = record.road_id;
+      road_waypoint.section_id = record.section_id;
+      road_waypoint.lane_id = record.lane_id;
+      road_waypoint.s = record.s;
+      road_waypoints.push_back(road_waypoint);
+      transforms.emplace_back(
+          cg::Location(record.x, record.y, record.z),
+          cg::Rotation(record.pitch, record.yaw, record.roll));
+    }
+    // The stored transforms spare evaluating the road geometry per waypoint.
+    const auto waypoint_ptrs = _world_map->GetWaypointsXODR(road_waypoints, transforms);
+
+    NodeList waypoints;
+    std::vector<SpatialTreeEntry> spatial_tree_entries;
+    waypoints.reserve(total);
+    spatial_tree_entries.reserve(total);
+
+    // create simple waypoints
+    for (uint32_t i = 0u; i < total; ++i) {
+      const map_cache::WaypointRecord &record = cache.GetRecord(i);
+      const WaypointPtr &waypoint_ptr = waypoint_ptrs[i];
+      if (waypoint_ptr == nullptr) {
+        log_warning("InMemoryMap cache does not match the current map");
+        return false;
       }
-      CachedSimpleWaypoint cached_wp(wp);
-      cached_wp.Write(out_file);
+      SimpleWaypointPtr wp = std::make_shared<SimpleWaypoint>(waypoint_ptr);
+      wp->SetGeodesicGridId(record.geodesic_grid_id);
+      wp->SetIsJunction(record.is_junction != 0u);
+      wp->SetRoadOption(static_cast<RoadOption>(record.road_option));
+      wp->SetIndex(i);
+      waypoints.push_back(wp);
+      spatial_tree_entries.emplace_back(Point3D(record.x, record.y, record.z), wp);
+    }
 
-      used_ids.insert(wp->GetId());
+    // connect waypoints
+    NodeList links;
+    for (uint32_t i = 0u; i < total; ++i) {
+      const map_cache::WaypointRecord &record = cache.GetRecord(i);
+      SimpleWaypointPtr &wp = waypoints[i];
+
+      links.clear();
+      for (uint32_t index : cache.GetNext(i)) {
+        links.push_back(waypoints[index]);
+      }
+      wp->SetNextWaypoint(links);
+      links.clear();
+      for (uint32_t index : cache.GetPrevious(i)) {
+        links.push_back(waypoints[index]);
+      }
+      wp->SetPreviousWaypoint(links);
+      if (record.left_index != map_cache::INVALID_INDEX) {
+        wp->SetLeftWaypoint(waypoints[record.left_index]);
+      }
+      if (record.right_index != map_cache::INVALID_INDEX) {
+        wp->SetRightWaypoint(waypoints[record.right_index]);
+      }
     }
 
-    out_file.close();
-    return;
+    // bulk load the spatial tree from the cached locations
+    dense_topology = std::move(waypoints);
+    rtree = Rtree(spatial_tree_entries.begin(), spatial_tree_entries.end());
+
+    return true;
   }
 
   bool InMemoryMap::Load(const std::vector<uint8_t>& content) {
+    if (InMemoryMapCache::HasCacheHeader(content.data(), content.size())) {
+      InMemoryMapCache cache;
+      if (!cache.Open(content.data(), content.size(), GetOpenDriveKey())) {
+        log_warning("Invalid InMemoryMap cache");
+        return false;
+      }
+      return LoadCache(cache);
+    }
+
+    // Older format, made of a sequence of CachedSimpleWaypoint.
     unsigned long pos = 0;
     std::vector<CachedSimpleWaypoint> cached_waypoints;
     std::unordered_map<uint64_t, uint32_t> id2index;
@@ -131,6 +273,7 @@ namespace traffic_manager {
       wp->SetGeodesicGridId(cached_wp.geodesic_grid_id);
       wp->SetIsJunction(cached_wp.is_junction);
       wp->SetRoadOption(static_cast<RoadOption>(cached_wp.road_option));
+      wp->SetIndex(static_cast<uint32_t>(dense_topology.size()));
       dense_topology.push_back(wp);
     }
 
@@ -163,7 +306,14 @@ namespace traffic_manager {
     return true;
   }
 
-  void InMemoryMap::SetUp() {
+  void InMemoryMap::SetUp(std::size_t number_of_threads) {
+    if (number_of_threads == 0u) {
+      number_of_threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    ThreadPool thread_pool;
+    if (number_of_threads > 1u) {
+      thread_pool.AsyncRun(number_of_threads);
+    }
 
     // 1. Building segment topology (i.e., defining set of segment predecessors and successors)
     assert(_world_map != nullptr && "No map reference found.");
@@ -252,12 +402,21 @@ namespace traffic_manager {
       return x ^ ((x ^ y) & -(x < y));
     };
 
-    GeoGridId geodesic_grid_id_counter = -1;
+    // Segments are processed independently. Geodesic grid ids are first
+    // numbered within each segment and then offset by the number of ids used
+    // by the preceding segments, which gives the same ids as a serial pass.
+    std::vector<SegmentMap::value_type *> segments;
+    segments.reserve(segment_map.size());
     for (auto &segment: segment_map) {
-      auto &segment_waypoints = segment.second;
+      segments.push_back(&segment);
+    }
+    std::vector<GeoGridId> segment_grid_ids(segments.size());
+
+    thread_pool.ParallelFor(segments.size(), [&](std::size_t segment_index) {
+      auto &segment_waypoints = segments[segment_index]->second;
 
       // Generating geodesic grid ids.
-      ++geodesic_grid_id_counter;
+      GeoGridId geodesic_grid_id_counter = 0;
 
       // Ordering waypoints according to road direction.
       std::sort(segment_waypoints.begin(), segment_waypoints.end(), compare_s);
@@ -307,8 +466,8 @@ namespace traffic_manager {
 
       }
       segment_waypoints.back()->SetGeodesicGridId(geodesic_grid_id_counter);
+      segment_grid_ids[segment_index] = geodesic_grid_id_counter + 1;
 
-      // Adding simple waypoints to processed dense topology.
       for (auto swp: segment_waypoints) {
         // Checking whether the waypoint is in a real junction.
         auto wpt = swp->GetWaypoint();
@@ -318,31 +477,42 @@ namespace traffic_manager {
         } else {
           swp->SetIsJunction(swp->GetWaypoint()->IsJunction());
         }
-
+      }
+    });
+
+    // Adding simple waypoints to processed dense topology.
+    GeoGridId geodesic_grid_id_offset = 0;
+    for (std::size_t segment_index = 0u; segment_index < segments.size(); ++segment_index) {
+      for (auto &swp: segments[segment_index]->second) {
+        swp->SetGeodesicGridId(geodesic_grid_id_offset + swp->GetGeodesicGridId());
+        swp->SetIndex(static_cast<uint32_t>(dense_topology.size()));
         dense_topology.push_back(swp);
       }
+      geodesic_grid_id_offset += segment_grid_ids[segment_index];
     }
 
     SetUpSpatialTree();
 
     // Placing inter-segment connections.
-    for (auto &segment : segment_map) {
-      SegmentId segment_id = segment.first;
-      auto &segment_waypoints = segment.second;
+    thread_pool.ParallelFor(segments.size(), [&](std::size_t segment_index) {
+      SegmentId segment_id = segments[segment_index]->first;
+      auto &segment_waypoints = segments[segment_index]->second;
 
       auto successors = GetSuccessors(segment_id, segment_topology, segment_map);
       auto predecessors = GetPredecessors(segment_id, segment_topology, segment_map);
 
       segment_waypoints.front()->SetPreviousWaypoint(predecessors);
       segment_waypoints.back()->SetNextWaypoint(successors);
-    }
+    });
 
-    // Linking lane change connections.
-    for (auto &swp : dense_topology) {
+    // Linking lane change connections. Each waypoint only links itself, and
+    // the spatial tree is only read.
+    thread_pool.ParallelFor(dense_topology.size(), [&](std::size_t index) {
+      const SimpleWaypointPtr &swp = dense_topology[index];
       if (!swp->CheckJunction()) {
         FindAndLinkLaneChange(swp);
       }
-    }
+    });
 
     // Linking any unconnected segments.
     for (auto &swp : dense_topology) {
@@ -366,13 +536,18 @@ namespace traffic_manager {
   }
 
   void InMemoryMap::SetUpSpatialTree() {
+    std::vector<SpatialTreeEntry> entries;
+    entries.reserve(dense_topology.size());
     for (auto &simple_waypoint: dense_topology) {
       if (simple_waypoint != nullptr) {
         const cg::Location loc = simple_waypoint->GetLocation();
         Point3D point(loc.x, loc.y, loc.z);
-        rtree.insert(std::make_pair(point, simple_waypoint));
+        entries.emplace_back(point, simple_waypoint);
       }
     }
+    // Bulk loading packs the tree, which is faster to build and to query than
+    // inserting the waypoints one by one.
+    rtree = Rtree(entries.begin(), entries.end());
   }
 
   void InMemoryMap::SetUpRoadOption() {
@@ -505,7 +680,7 @@ namespace traffic_manager {
     return result;
   }
 
-  NodeList InMemoryMap::GetDenseTopology() const {
+  const NodeList &InMemoryMap::GetDenseTopology() const {
     return dense_topology;
   }
 
@@ -575,7 +750,7 @@ namespace traffic_manager {
     }
   }
 
-  std::string InMemoryMap::GetMapName() {
+  std::string InMemoryMap::GetMapName() const {
     assert(_world_map != nullptr && "No map reference found.");
     return _world_map->GetName();
   }
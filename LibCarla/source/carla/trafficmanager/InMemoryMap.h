@@ -32,6 +32,7 @@
 #include "carla/trafficmanager/RandomGenerator.h"
 #include "carla/trafficmanager/SimpleWaypoint.h"
 #include "carla/trafficmanager/CachedSimpleWaypoint.h"
+#include "carla/trafficmanager/InMemoryMapCache.h"
 
 namespace carla {
 namespace traffic_manager {
@@ -79,11 +80,24 @@ namespace bgi = boost::geometry::index;
 
     static void Cook(WorldMap world_map, const std::string& path);
 
-    //bool Load(const std::string& filename);
+    /// Loads the local map from a cache file, mapping it in memory. Returns
+    /// false if the file is not a valid cache in the current format built from
+    /// the OpenDRIVE of the world map.
+    bool Load(const std::string& filename);
+
+    /// Loads the local map from the content of a cache, either in the current
+    /// format, built from the OpenDRIVE of the world map, or in the older
+    /// CachedSimpleWaypoint based one.
     bool Load(const std::vector<uint8_t>& content);
 
+    /// Writes the local map as a cache in the current format.
+    void Save(const std::string& path);
+
     /// This method constructs the local map with a resolution of sampling_resolution.
-    void SetUp();
+    /// Independent segments and waypoints are processed on @a number_of_threads
+    /// threads, all the available ones if zero. The result does not depend on
+    /// the number of threads.
+    void SetUp(std::size_t number_of_threads = 0u);
 
     /// This method returns the closest waypoint to a given location on the map.
     SimpleWaypointPtr GetWaypoint(const cg::Location loc) const;
@@ -92,14 +106,19 @@ namespace bgi = boost::geometry::index;
     NodeList GetWaypointsInDelta(const cg::Location loc, const uint16_t n_points, const float random_sample) const;
 
     /// This method returns the full list of discrete samples of the map in the local cache.
-    NodeList GetDenseTopology() const;
+    /// Waypoints are stored at the position given by SimpleWaypoint::GetIndex().
+    const NodeList &GetDenseTopology() const;
 
-    std::string GetMapName();
+    std::string GetMapName() const;
 
     const cc::Map& GetMap() const;
 
   private:
-    void Save(const std::string& path);
+    /// Builds the local map from a validated cache.
+    bool LoadCache(const InMemoryMapCache &cache);
+
+    /// Key of the OpenDRIVE of the world map, which caches are built from.
+    InMemoryMapCache::OpenDriveKey GetOpenDriveKey() const;
 
     void SetUpDenseTopology();
     void SetUpSpatialTree();
@@ -0,0 +1,224 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/trafficmanager/InMemoryMapCache.h"
+
+#include "carla/Debug.h"
+#include "carla/Logging.h"
+
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#include <cstring>
+
+namespace carla {
+namespace traffic_manager {
+
+  namespace bip = boost::interprocess;
+  using namespace map_cache;
+
+namespace {
+
+  /// FNV-1a applied to 64-bit words instead of bytes, so that validating a
+  /// large cache costs a fraction of a millisecond per megabyte.
+  uint64_t Checksum(const uint8_t *data, std::size_t size) {
+    static constexpr uint64_t OFFSET_BASIS = 14695981039346656037ull;
+    static constexpr uint64_t PRIME = 1099511628211ull;
+    uint64_t hash = OFFSET_BASIS;
+    std::size_t i = 0u;
+    for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t)) {
+      uint64_t word;
+      std::memcpy(&word, data + i, sizeof(word));
+      hash ^= word;
+      hash *= PRIME;
+    }
+    for (; i < size; ++i) {
+      hash ^= data[i];
+      hash *= PRIME;
+    }
+    return hash;
+  }
+
+  template <typename T>
+  void Append(std::vector<uint8_t> &buffer, const T *values, std::size_t count) {
+    const auto *bytes = reinterpret_cast<const uint8_t *>(values);
+    buffer.insert(buffer.end(), bytes, bytes + count * sizeof(T));
+  }
+
+  /// Appends the offsets and the indices of the links in CSR form.
+  void AppendLinks(std::vector<uint8_t> &buffer, const std::vector<std::vector<uint32_t>> &links) {
+    std::vector<uint32_t> offsets;
+    std::vector<uint32_t> indices;
+    offsets.reserve(links.size() + 1u);
+    offsets.push_back(0u);
+    for (const auto &waypoint_links : links) {
+      indices.insert(indices.end(), waypoint_links.begin(), waypoint_links.end());
+      offsets.push_back(static_cast<uint32_t>(indices.size()));
+    }
+    Append(buffer, offsets.data(), offsets.size());
+    Append(buffer, indices.data(), indices.size());
+  }
+
+  std::size_t CountLinks(const std::vector<std::vector<uint32_t>> &links) {
+    std::size_t count = 0u;
+    for (const auto &waypoint_links : links) {
+      count += waypoint_links.size();
+    }
+    return count;
+  }
+
+  /// Whether the offsets are monotonic, end at the number of links and every
+  /// link points to a valid waypoint.
+  bool ValidLinks(const uint32_t *offsets, const uint32_t *indices, uint32_t waypoint_count, uint32_t link_count) {
+    if (offsets[0] != 0u || offsets[waypoint_count] != link_count) {
+      return false;
+    }
+    for (uint32_t i = 0u; i < waypoint_count; ++i) {
+      if (offsets[i] > offsets[i + 1u]) {
+        return false;
+      }
+    }
+    for (uint32_t i = 0u; i < link_count; ++i) {
+      if (indices[i] >= waypoint_count) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+} // namespace
+
+  std::vector<uint8_t> InMemoryMapCache::Serialize(
+      const std::vector<WaypointRecord> &records,
+      const std::vector<std::vector<uint32_t>> &next,
+      const std::vector<std::vector<uint32_t>> &previous,
+      const OpenDriveKey &opendrive_key) {
+    DEBUG_ASSERT(next.size() == records.size());
+    DEBUG_ASSERT(previous.size() == records.size());
+
+    Header header;
+    std::memset(&header, 0, sizeof(header));
+    header.magic = MAGIC;
+    header.version = VERSION;
+    header.waypoint_count = static_cast<uint32_t>(records.size());
+    header.next_link_count = static_cast<uint32_t>(CountLinks(next));
+    header.previous_link_count = static_cast<uint32_t>(CountLinks(previous));
+    header.opendrive_hash = opendrive_key.hash;
+    header.opendrive_size = opendrive_key.size;
+
+    std::vector<uint8_t> buffer(sizeof(Header));
+    Append(buffer, records.data(), records.size());
+    AppendLinks(buffer, next);
+    AppendLinks(buffer, previous);
+
+    header.payload_size = buffer.size() - sizeof(Header);
+    header.checksum = Checksum(buffer.data() + sizeof(Header), buffer.size() - sizeof(Header));
+    std::memcpy(buffer.data(), &header, sizeof(Header));
+    return buffer;
+  }
+
+  bool InMemoryMapCache::HasCacheHeader(const uint8_t *data, std::size_t size) {
+    uint32_t magic = 0u;
+    if (size < sizeof(Header)) {
+      return false;
+    }
+    std::memcpy(&magic, data, sizeof(magic));
+    return magic == MAGIC;
+  }
+
+  std::string InMemoryMapCache::GetVersionedFilename(const std::string &filename) {
+    const std::string suffix = ".v" + std::to_string(VERSION);
+    const auto separator = filename.find_last_of("/\\");
+    const auto extension = filename.find_last_of('.');
+    if (extension == std::string::npos ||
+        (separator != std::string::npos && extension < separator)) {
+      return filename + suffix;
+    }
+    return filename.substr(0u, extension) + suffix + filename.substr(extension);
+  }
+
+  bool InMemoryMapCache::Open(const std::string &filename, const OpenDriveKey &opendrive_key) {
+    std::shared_ptr<bip::mapped_region> region;
+    try {
+      bip::file_mapping file(filename.c_str(), bip::read_only);
+      region = std::make_shared<bip::mapped_region>(file, bip::read_only);
+    } catch (const bip::interprocess_exception &e) {
+      log_warning("Could not map InMemoryMap cache", filename, ":", e.what());
+      return false;
+    }
+    const auto *data = static_cast<const uint8_t *>(region->get_address());
+    if (!Validate(data, region->get_size(), opendrive_key)) {
+      // Files in older formats are expected, only report broken caches.
+      if (HasCacheHeader(data, region->get_size())) {
+        log_warning("Invalid InMemoryMap cache", filename);
+      }
+      return false;
+    }
+    _mapping = region;
+    return true;
+  }
+
+  bool InMemoryMapCache::Open(const uint8_t *data, std::size_t size, const OpenDriveKey &opendrive_key) {
+    _mapping.reset();
+    return Validate(data, size, opendrive_key);
+  }
+
+  bool InMemoryMapCache::Validate(const uint8_t *data, std::size_t size, const OpenDriveKey &opendrive_key) {
+    _header = nullptr;
+    if (!HasCacheHeader(data, size) || reinterpret_cast<uintptr_t>(data) % alignof(Header) != 0u) {
+      return false;
+    }
+    const auto *header = reinterpret_cast<const Header *>(data);
+    if (header->version != VERSION) {
+      log_warning("InMemoryMap cache version", header->version, "does not match the expected", VERSION);
+      return false;
+    }
+    if (header->opendrive_hash != opendrive_key.hash || header->opendrive_size != opendrive_key.size) {
+      log_warning("InMemoryMap cache was built from another OpenDRIVE");
+      return false;
+    }
+
+    const uint64_t waypoint_count = header->waypoint_count;
+    const uint64_t expected_payload_size =
+        waypoint_count * sizeof(WaypointRecord) +
+        (2u * (waypoint_count + 1u) + header->next_link_count + header->previous_link_count) * sizeof(uint32_t);
+    if (header->payload_size != expected_payload_size || size - sizeof(Header) < expected_payload_size) {
+      return false;
+    }
+    const uint8_t *payload = data + sizeof(Header);
+    if (Checksum(payload, expected_payload_size) != header->checksum) {
+      return false;
+    }
+
+    const auto *records = reinterpret_cast<const WaypointRecord *>(payload);
+    const auto *next_offsets = reinterpret_cast<const uint32_t *>(records + waypoint_count);
+    const uint32_t *next_indices = next_offsets + waypoint_count + 1u;
+    const uint32_t *previous_offsets = next_indices + header->next_link_count;
+    const uint32_t *previous_indices = previous_offsets + waypoint_count + 1u;
+
+    if (!ValidLinks(next_offsets, next_indices, header->waypoint_count, header->next_link_count) ||
+        !ValidLinks(previous_offsets, previous_indices, header->waypoint_count, header->previous_link_count)) {
+      return false;
+    }
+    for (uint32_t i = 0u; i < header->waypoint_count; ++i) {
+      const WaypointRecord &record = records[i];
+      if ((record.left_index != INVALID_INDEX && record.left_index >= waypoint_count) ||
+          (record.right_index != INVALID_INDEX && record.right_index >= waypoint_count)) {
+        return false;
+      }
+    }
+
+    _header = header;
+    _records = records;
+    _next_offsets = next_offsets;
+    _next_indices = next_indices;
+    _previous_offsets = previous_offsets;
+    _previous_indices = previous_indices;
+    return true;
+  }
+
+} // namespace traffic_manager
+} // namespace carla
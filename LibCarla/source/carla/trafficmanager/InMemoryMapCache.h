@@ -0,0 +1,166 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "carla/ListView.h"
+#include "carla/road/PrecompiledMap.h"
+
+namespace carla {
+namespace traffic_manager {
+
+namespace map_cache {
+
+  /// "CTMC" in little endian.
+  static constexpr uint32_t MAGIC = 0x434D5443u;
+  /// Bump whenever the layout below changes.
+  static constexpr uint32_t VERSION = 3u;
+  /// Marks missing lane change links.
+  static constexpr uint32_t INVALID_INDEX = std::numeric_limits<uint32_t>::max();
+
+  /// Header at the start of a cache file. It is followed by the payload, made
+  /// of these sections:
+  ///
+  ///   WaypointRecord records[waypoint_count];
+  ///   uint32_t       next_offsets[waypoint_count + 1];
+  ///   uint32_t       next_indices[next_link_count];
+  ///   uint32_t       previous_offsets[waypoint_count + 1];
+  ///   uint32_t       previous_indices[previous_link_count];
+  ///
+  /// Links are stored in compressed sparse row form: the successors of the
+  /// i-th waypoint are next_indices[next_offsets[i]] up to
+  /// next_indices[next_offsets[i + 1]]. All the indices refer to positions in
+  /// the records array, which is the dense topology of the map.
+  struct Header {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t waypoint_count;
+    uint32_t next_link_count;
+    uint32_t previous_link_count;
+    uint32_t reserved;
+    /// Size in bytes of everything after the header.
+    uint64_t payload_size;
+    /// Word-wise FNV-1a hash of the payload.
+    uint64_t checksum;
+    /// Hash and size of the OpenDRIVE the cache was built from, as computed by
+    /// road::PrecompiledMap::GetOpenDriveKey.
+    uint64_t opendrive_hash;
+    uint64_t opendrive_size;
+  };
+
+  static_assert(sizeof(Header) == 56u, "Unexpected padding in the cache header");
+
+  /// Fixed size description of a waypoint of the dense topology. The
+  /// transform is stored so that neither the waypoints nor the spatial index
+  /// need to evaluate the road geometry on load.
+  struct WaypointRecord {
+    uint32_t road_id;
+    uint32_t section_id;
+    int32_t lane_id;
+    float s;
+    float x;
+    float y;
+    float z;
+    float pitch;
+    float yaw;
+    float roll;
+    int32_t geodesic_grid_id;
+    uint32_t left_index;
+    uint32_t right_index;
+    uint8_t is_junction;
+    uint8_t road_option;
+    uint8_t padding[2];
+  };
+
+  static_assert(sizeof(WaypointRecord) == 56u, "Unexpected padding in the waypoint record");
+
+} // namespace map_cache
+
+  /// Read-only view of an InMemoryMap cache. The cache is either mapped from
+  /// a file, which avoids reading it into a buffer first, or viewed in place
+  /// from a buffer owned by the caller. The view is only needed while the
+  /// records are turned into SimpleWaypoints.
+  class InMemoryMapCache {
+  public:
+
+    using IndexList = ListView<const uint32_t *>;
+
+    using OpenDriveKey = road::precompiled_map::OpenDriveKey;
+
+    /// Serializes the given dense topology of the OpenDRIVE with key
+    /// @a opendrive_key. @a next and @a previous hold the links of every
+    /// record.
+    static std::vector<uint8_t> Serialize(
+        const std::vector<map_cache::WaypointRecord> &records,
+        const std::vector<std::vector<uint32_t>> &next,
+        const std::vector<std::vector<uint32_t>> &previous,
+        const OpenDriveKey &opendrive_key);
+
+    /// Whether the buffer starts like a cache, so that older formats can be
+    /// told apart. Does not validate the content.
+    static bool HasCacheHeader(const uint8_t *data, std::size_t size);
+
+    /// Name under which the cache of the current version is stored next to
+    /// @a filename, e.g. "Town01.bin" becomes "Town01.v2.bin". Keeps caches
+    /// of other formats, which older clients may still read, untouched.
+    static std::string GetVersionedFilename(const std::string &filename);
+
+    /// Maps the given file. Returns false if the file cannot be mapped or is
+    /// not a valid cache of the OpenDRIVE with key @a opendrive_key.
+    bool Open(const std::string &filename, const OpenDriveKey &opendrive_key);
+
+    /// Views the given buffer, which must outlive this object. Returns false
+    /// if the buffer is not a valid cache of the OpenDRIVE with key
+    /// @a opendrive_key.
+    bool Open(const uint8_t *data, std::size_t size, const OpenDriveKey &opendrive_key);
+
+    uint32_t GetWaypointCount() const {
+      return _header->waypoint_count;
+    }
+
+    const map_cache::WaypointRecord &GetRecord(uint32_t index) const {
+      return _records[index];
+    }
+
+    IndexList GetNext(uint32_t index) const {
+      return MakeListView(_next_indices + _next_offsets[index], _next_indices + _next_offsets[index + 1u]);
+    }
+
+    IndexList GetPrevious(uint32_t index) const {
+      return MakeListView(_previous_indices + _previous_offsets[index], _previous_indices + _previous_offsets[index + 1u]);
+    }
+
+  private:
+
+    /// Checks the header, the OpenDRIVE it was built from, the size and
+    /// checksum of the payload and that every index is within bounds, then
+    /// sets up the section pointers.
+    bool Validate(const uint8_t *data, std::size_t size, const OpenDriveKey &opendrive_key);
+
+    /// Keeps the file mapping alive, if any.
+    std::shared_ptr<const void> _mapping;
+
+    const map_cache::Header *_header = nullptr;
+
+    const map_cache::WaypointRecord *_records = nullptr;
+
+    const uint32_t *_next_offsets = nullptr;
+
+    const uint32_t *_next_indices = nullptr;
+
+    const uint32_t *_previous_offsets = nullptr;
+
+    const uint32_t *_previous_indices = nullptr;
+  };
+
+} // namespace traffic_manager
+} // namespace carla
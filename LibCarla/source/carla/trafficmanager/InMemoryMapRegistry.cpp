@@ -0,0 +1,92 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/trafficmanager/InMemoryMapRegistry.h"
+
+#include <exception>
+
+namespace carla {
+namespace traffic_manager {
+
+  std::mutex InMemoryMapRegistry::_mutex;
+
+  std::unordered_map<std::string, InMemoryMapRegistry::Entry> InMemoryMapRegistry::_maps;
+
+  std::string InMemoryMapRegistry::GetKey(const cc::Map &world_map) {
+    const std::size_t hash = std::hash<std::string>()(world_map.GetOpenDrive());
+    return world_map.GetName() + "#" + std::to_string(hash);
+  }
+
+  InMemoryMapRegistry::LocalMapPtr InMemoryMapRegistry::Get(const cc::Map &world_map, const Builder &builder) {
+    return Get(GetKey(world_map), builder);
+  }
+
+  InMemoryMapRegistry::LocalMapPtr InMemoryMapRegistry::Get(const std::string &key, const Builder &builder) {
+    std::promise<LocalMapPtr> promise;
+    std::shared_future<LocalMapPtr> build;
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      // Drop the entries of the maps already released.
+      for (auto it = _maps.begin(); it != _maps.end();) {
+        if (!it->second.build.valid() && it->second.map.expired()) {
+          it = _maps.erase(it);
+        } else {
+          ++it;
+        }
+      }
+      Entry &entry = _maps[key];
+      LocalMapPtr local_map = entry.map.lock();
+      if (local_map != nullptr) {
+        return local_map;
+      }
+      if (entry.build.valid()) {
+        build = entry.build;
+      } else {
+        entry.build = promise.get_future().share();
+      }
+    }
+
+    if (build.valid()) {
+      // Another traffic manager is building this map, wait for it without
+      // holding the registry.
+      return build.get();
+    }
+
+    // Build outside the lock, it may take long and call the simulator.
+    LocalMapPtr local_map;
+    try {
+      local_map = builder();
+    } catch (...) {
+      {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _maps[key].build = {};
+      }
+      promise.set_exception(std::current_exception());
+      throw;
+    }
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      Entry &entry = _maps[key];
+      entry.map = local_map;
+      entry.build = {};
+    }
+    promise.set_value(local_map);
+    return local_map;
+  }
+
+  std::size_t InMemoryMapRegistry::Size() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    std::size_t size = 0u;
+    for (const auto &entry : _maps) {
+      if (!entry.second.map.expired()) {
+        ++size;
+      }
+    }
+    return size;
+  }
+
+} // namespace traffic_manager
+} // namespace carla
@@ -0,0 +1,63 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "carla/trafficmanager/InMemoryMap.h"
+
+namespace carla {
+namespace traffic_manager {
+
+/// Process wide registry of the local maps in use. Traffic managers attached
+/// to the same map share a single InMemoryMap, which is released once the
+/// last of them drops its reference. The registry hands it out as const, so
+/// the traffic managers cannot modify it through their pointer by accident;
+/// nothing stops code from modifying the waypoints it points to. Everything
+/// that changes per traffic manager, like the grid occupancy and the waypoint
+/// buffers, lives in the traffic manager itself.
+class InMemoryMapRegistry {
+public:
+
+  using LocalMapPtr = std::shared_ptr<const InMemoryMap>;
+  using Builder = std::function<std::shared_ptr<InMemoryMap>()>;
+
+  /// Returns the local map of @a world_map, running @a builder to construct
+  /// it if no traffic manager holds it. Concurrent requests for the same map
+  /// wait for a single build, requests for other maps do not wait for it.
+  static LocalMapPtr Get(const cc::Map &world_map, const Builder &builder);
+
+  /// Returns the local map registered under @a key, see Get above.
+  static LocalMapPtr Get(const std::string &key, const Builder &builder);
+
+  /// Number of local maps alive in the process.
+  static std::size_t Size();
+
+  /// Key identifying a map by its name and the hash of its OpenDRIVE content.
+  static std::string GetKey(const cc::Map &world_map);
+
+private:
+
+  struct Entry {
+    std::weak_ptr<const InMemoryMap> map;
+
+    /// Valid while a traffic manager builds the map.
+    std::shared_future<LocalMapPtr> build;
+  };
+
+  static std::mutex _mutex;
+
+  static std::unordered_map<std::string, Entry> _maps;
+};
+
+} // namespace traffic_manager
+} // namespace carla
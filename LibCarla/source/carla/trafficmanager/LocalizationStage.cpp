@@ -36,9 +36,10 @@ LocalizationStage::LocalizationStage(
 void LocalizationStage::Update(const unsigned long index) {
 
   const ActorId actor_id = vehicle_id_list.at(index);
-  const cg::Location vehicle_location = simulation_state.GetLocation(actor_id);
-  const cg::Vector3D heading_vector = simulation_state.GetHeading(actor_id);
-  const cg::Vector3D vehicle_velocity_vector = simulation_state.GetVelocity(actor_id);
+  const std::size_t actor_slot = simulation_state.GetSlot(actor_id);
+  const cg::Location vehicle_location = simulation_state.GetLocationAt(actor_slot);
+  const cg::Vector3D heading_vector = simulation_state.GetHeadingAt(actor_slot);
+  const cg::Vector3D vehicle_velocity_vector = simulation_state.GetVelocityAt(actor_slot);
   const float vehicle_speed = vehicle_velocity_vector.Length();
 
   // Speed dependent waypoint horizon length.
@@ -49,7 +50,7 @@ void LocalizationStage::Update(const unsigned long index) {
   const float horizon_square = SQUARE(horizon_length);
 
   if (buffer_map.find(actor_id) == buffer_map.end()) {
-    buffer_map.insert({actor_id, Buffer()});
+    buffer_map.insert({actor_id, Buffer(local_map->GetDenseTopology())});
   }
   Buffer &waypoint_buffer = buffer_map.at(actor_id);
 
@@ -349,7 +350,7 @@ SimpleWaypointPtr LocalizationStage::AssignLaneChange(const ActorId actor_id,
     const SimpleWaypointPtr right_waypoint = current_waypoint->GetRightWaypoint();
 
     // Retrieve vehicles with overlapping waypoint buffers with current vehicle.
-    const auto blocking_vehicles = track_traffic.GetOverlappingVehicles(actor_id);
+    track_traffic.GetOverlappingVehicles(actor_id, blocking_vehicles);
 
     // Find immediate in-lane obstacle and check if any are too close to initiate lane change.
     bool obstacle_too_close = false;
@@ -458,7 +459,7 @@ void LocalizationStage::ImportPath(Path &imported_path, Buffer &waypoint_buffer,
         PopWaypoint(actor_id, track_traffic, waypoint_buffer, false);
       }
       // We have successfully imported the path. Remove it from the list of paths to be imported.
-      parameters.RemoveUploadPath(actor_id, false);
+      parameters.ConsumeUploadPath(actor_id);
     }
 
     // Get the latest imported waypoint. and find its closest waypoint in TM's InMemoryMap.
@@ -541,7 +542,7 @@ void LocalizationStage::ImportRoute(Route &imported_actions, Buffer &waypoint_bu
         PopWaypoint(actor_id, track_traffic, waypoint_buffer, false);
       }
       // We have successfully imported the route. Remove it from the list of routes to be imported.
-      parameters.RemoveImportedRoute(actor_id, false);
+      parameters.ConsumeUploadRoute(actor_id);
     }
 
     RoadOption next_road_option = static_cast<RoadOption>(imported_actions.front());
@@ -590,7 +591,7 @@ void LocalizationStage::ImportRoute(Route &imported_actions, Buffer &waypoint_bu
 }
 
 Action LocalizationStage::ComputeNextAction(const ActorId& actor_id) {
-  auto waypoint_buffer = buffer_map.at(actor_id);
+  const Buffer &waypoint_buffer = buffer_map.at(actor_id);
   auto next_action = std::make_pair(RoadOption::LaneFollow, waypoint_buffer.back()->GetWaypoint());
   bool is_lane_change = false;
   if (last_lane_change_swpt.find(actor_id) != last_lane_change_swpt.end()) {
@@ -624,7 +625,7 @@ Action LocalizationStage::ComputeNextAction(const ActorId& actor_id) {
 
 ActionBuffer LocalizationStage::ComputeActionBuffer(const ActorId& actor_id) {
 
-  auto waypoint_buffer = buffer_map.at(actor_id);
+  const Buffer &waypoint_buffer = buffer_map.at(actor_id);
   ActionBuffer action_buffer;
   Action lane_change;
   bool is_lane_change = false;
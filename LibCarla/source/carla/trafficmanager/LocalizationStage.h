@@ -17,7 +17,7 @@ namespace traffic_manager {
 
 namespace cc = carla::client;
 
-using LocalMapPtr = std::shared_ptr<InMemoryMap>;
+using LocalMapPtr = std::shared_ptr<const InMemoryMap>;
 using LaneChangeSWptMap = std::unordered_map<ActorId, SimpleWaypointPtr>;
 using WaypointPtr = carla::SharedPtr<cc::Waypoint>;
 using Action = std::pair<RoadOption, WaypointPtr>;
@@ -45,6 +45,8 @@ private:
   using SimpleWaypointPair = std::pair<SimpleWaypointPtr, SimpleWaypointPtr>;
   std::unordered_map<ActorId, SimpleWaypointPair> vehicles_at_junction_entrance;
   RandomGenerator &random_device;
+  // Buffer reused by overlap queries.
+  ActorIdList blocking_vehicles;
 
   SimpleWaypointPtr AssignLaneChange(const ActorId actor_id,
                                      const cg::Location vehicle_location,
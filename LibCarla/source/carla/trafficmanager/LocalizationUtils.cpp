@@ -46,7 +46,7 @@ void PushWaypoint(ActorId actor_id, TrackTraffic &track_traffic,
 void PopWaypoint(ActorId actor_id, TrackTraffic &track_traffic,
                  Buffer &buffer, bool front_or_back) {
 
-  SimpleWaypointPtr removed_waypoint = front_or_back ? buffer.front() : buffer.back();
+  const SimpleWaypointPtr &removed_waypoint = front_or_back ? buffer.front() : buffer.back();
   const uint64_t removed_waypoint_id = removed_waypoint->GetId();
   if (front_or_back) {
     buffer.pop_front();
@@ -17,6 +17,7 @@
 #include "carla/trafficmanager/Constants.h"
 #include "carla/trafficmanager/SimpleWaypoint.h"
 #include "carla/trafficmanager/TrackTraffic.h"
+#include "carla/trafficmanager/WaypointBuffer.h"
 
 namespace carla {
 namespace traffic_manager {
@@ -27,7 +28,7 @@ namespace traffic_manager {
   using ActorId = carla::ActorId;
   using ActorIdSet = std::unordered_set<ActorId>;
   using SimpleWaypointPtr = std::shared_ptr<SimpleWaypoint>;
-  using Buffer = std::deque<SimpleWaypointPtr>;
+  using Buffer = WaypointBuffer;
   using GeoGridId = carla::road::JuncId;
   using constants::Map::MAP_RESOLUTION;
   using constants::Map::INV_MAP_RESOLUTION;
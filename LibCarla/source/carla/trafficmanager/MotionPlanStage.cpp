@@ -39,7 +39,7 @@ MotionPlanStage::MotionPlanStage(
   const LocalizationFrame &localization_frame,
   const CollisionFrame&collision_frame,
   const TLFrame &tl_frame,
-  const cc::World &world,
+  const cc::Timestamp &current_timestamp,
   ControlFrame &output_array,
   RandomGenerator &random_device,
   const LocalMapPtr &local_map)
@@ -55,25 +55,26 @@ MotionPlanStage::MotionPlanStage(
     localization_frame(localization_frame),
     collision_frame(collision_frame),
     tl_frame(tl_frame),
-    world(world),
+    current_timestamp(current_timestamp),
     output_array(output_array),
     random_device(random_device),
     local_map(local_map) {}
 
 void MotionPlanStage::Update(const unsigned long index) {
   const ActorId actor_id = vehicle_id_list.at(index);
-  const cg::Location vehicle_location = simulation_state.GetLocation(actor_id);
-  const cg::Vector3D vehicle_velocity = simulation_state.GetVelocity(actor_id);
-  const cg::Rotation vehicle_rotation = simulation_state.GetRotation(actor_id);
+  const std::size_t actor_slot = simulation_state.GetSlot(actor_id);
+  const cg::Location vehicle_location = simulation_state.GetLocationAt(actor_slot);
+  const cg::Vector3D vehicle_velocity = simulation_state.GetVelocityAt(actor_slot);
+  const cg::Rotation vehicle_rotation = simulation_state.GetRotationAt(actor_slot);
   const float vehicle_speed = vehicle_velocity.Length();
-  const cg::Vector3D vehicle_heading = simulation_state.GetHeading(actor_id);
-  const bool vehicle_physics_enabled = simulation_state.IsPhysicsEnabled(actor_id);
-  const float vehicle_speed_limit = simulation_state.GetSpeedLimit(actor_id);
+  const cg::Vector3D vehicle_heading = simulation_state.GetHeadingAt(actor_slot);
+  const bool vehicle_physics_enabled = simulation_state.IsPhysicsEnabledAt(actor_slot);
+  const float vehicle_speed_limit = simulation_state.GetSpeedLimitAt(actor_slot);
+  const bool vehicle_dormant = simulation_state.IsDormantAt(actor_slot);
   const Buffer &waypoint_buffer = buffer_map.at(actor_id);
   const LocalizationData &localization = localization_frame.at(index);
   const CollisionHazardData &collision_hazard = collision_frame.at(index);
   const bool &tl_hazard = tl_frame.at(index);
-  current_timestamp = world.GetSnapshot().GetTimestamp();
   StateEntry current_state;
 
   // Instanciating teleportation transform as current vehicle transform.
@@ -83,7 +84,7 @@ void MotionPlanStage::Update(const unsigned long index) {
   cg::Location hero_location = track_traffic.GetHeroLocation();
   bool is_hero_alive = hero_location != cg::Location(0, 0, 0);
 
-  if (simulation_state.IsDormant(actor_id) && parameters.GetRespawnDormantVehicles() && is_hero_alive) {
+  if (vehicle_dormant && parameters.GetRespawnDormantVehicles() && is_hero_alive) {
     // Flushing controller state for vehicle.
     current_state = {current_timestamp,
                     0.0f, 0.0f,
@@ -123,7 +124,7 @@ void MotionPlanStage::Update(const unsigned long index) {
     KinematicState kinematic_state{teleportation_transform.location,
                                    teleportation_transform.rotation,
                                    vehicle_velocity, vehicle_speed_limit,
-                                   vehicle_physics_enabled, simulation_state.IsDormant(actor_id),
+                                   vehicle_physics_enabled, vehicle_dormant,
                                    teleportation_transform.location};
     simulation_state.UpdateKinematicState(actor_id, kinematic_state);
   }
@@ -152,7 +153,7 @@ void MotionPlanStage::Update(const unsigned long index) {
     // In case of collision or traffic light hazard.
     bool emergency_stop = tl_hazard || collision_emergency_stop || !safe_after_junction;
 
-    if (vehicle_physics_enabled && !simulation_state.IsDormant(actor_id)) {
+    if (vehicle_physics_enabled && !vehicle_dormant) {
       ActuationSignal actuation_signal{0.0f, 0.0f, 0.0f};
 
       const float target_point_distance = std::max(vehicle_speed * TARGET_WAYPOINT_TIME_HORIZON,
@@ -258,7 +259,7 @@ void MotionPlanStage::Update(const unsigned long index) {
       // In case of an emergency stop, stay in the same location.
       // Also, teleport only once every dt in asynchronous mode.
       } else {
-        teleportation_transform = cg::Transform(vehicle_location, simulation_state.GetRotation(actor_id));
+        teleportation_transform = cg::Transform(vehicle_location, vehicle_rotation);
       }
       // Constructing the actuation signal.
       output_array.at(index) = carla::rpc::Command::ApplyTransform(actor_id, teleportation_transform);
@@ -292,9 +293,10 @@ bool MotionPlanStage::SafeAfterJunction(const LocalizationData &localization,
                         std::inserter(difference, difference.begin()));
     if (difference.size() > 0) {
       for (const ActorId &blocking_id: difference) {
-        cg::Location blocking_actor_location = simulation_state.GetLocation(blocking_id);
+        const std::size_t blocking_slot = simulation_state.GetSlot(blocking_id);
+        cg::Location blocking_actor_location = simulation_state.GetLocationAt(blocking_slot);
         if (cg::Math::DistanceSquared(blocking_actor_location, mid_point) < SQUARE(MAX_JUNCTION_BLOCK_DISTANCE)
-            && simulation_state.GetVelocity(blocking_id).SquaredLength() < SQUARE(AFTER_JUNCTION_MIN_SPEED)) {
+            && simulation_state.GetVelocityAt(blocking_slot).SquaredLength() < SQUARE(AFTER_JUNCTION_MIN_SPEED)) {
           safe_after_junction = false;
           break;
         }
@@ -16,7 +16,7 @@
 namespace carla {
 namespace traffic_manager {
 
-using LocalMapPtr = std::shared_ptr<InMemoryMap>;
+using LocalMapPtr = std::shared_ptr<const InMemoryMap>;
 using TLMap = std::unordered_map<std::string, SharedPtr<client::Actor>>;
 
 class MotionPlanStage: Stage {
@@ -34,14 +34,14 @@ private:
   const LocalizationFrame &localization_frame;
   const CollisionFrame &collision_frame;
   const TLFrame &tl_frame;
-  const cc::World &world;
+  /// Timestamp of the current cycle.
+  const cc::Timestamp &current_timestamp;
   // Structure holding the controller state for registered vehicles.
   std::unordered_map<ActorId, StateEntry> pid_state_map;
   // Structure to keep track of duration between teleportation
   // in hybrid physics mode.
   std::unordered_map<ActorId, cc::Timestamp> teleportation_instance;
   ControlFrame &output_array;
-  cc::Timestamp current_timestamp;
   RandomGenerator &random_device;
   const LocalMapPtr &local_map;
 
@@ -80,7 +80,7 @@ public:
                   const LocalizationFrame &localization_frame,
                   const CollisionFrame &collision_frame,
                   const TLFrame &tl_frame,
-                  const cc::World &world,
+                  const cc::Timestamp &current_timestamp,
                   ControlFrame &output_array,
                   RandomGenerator &random_device,
                   const LocalMapPtr &local_map);
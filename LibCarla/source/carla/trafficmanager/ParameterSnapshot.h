@@ -0,0 +1,144 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "carla/rpc/ActorId.h"
+
+namespace carla {
+namespace traffic_manager {
+
+using ActorId = carla::ActorId;
+
+struct ChangeLaneInfo {
+  bool change_lane = false;
+  bool direction = false;
+};
+
+/// Settings of a single vehicle. Fields without a flag are always valid,
+/// the others only when their flag is set, otherwise the global value applies.
+struct VehicleParameters {
+
+  enum Flags : uint16_t {
+    PERCENTAGE_SPEED_DIFFERENCE = 1u << 0u,
+    EXACT_DESIRED_SPEED         = 1u << 1u,
+    LANE_OFFSET                 = 1u << 2u,
+    DISTANCE_TO_LEADING_VEHICLE = 1u << 3u,
+    FORCE_LANE_CHANGE           = 1u << 4u,
+    CUSTOM_PATH                 = 1u << 5u,
+    IMPORTED_ROUTE              = 1u << 6u,
+    UPLOAD_PATH                 = 1u << 7u,
+    UPLOAD_ROUTE                = 1u << 8u
+  };
+
+  bool Has(Flags flag) const {
+    return (flags & flag) != 0u;
+  }
+
+  uint16_t flags = 0u;
+  float percentage_speed_difference = 0.0f;
+  float exact_desired_speed = 0.0f;
+  float lane_offset = 0.0f;
+  float distance_to_leading_vehicle = 0.0f;
+  ChangeLaneInfo force_lane_change;
+  /// Incremented by every force lane change, path upload and route upload
+  /// command respectively, so that consuming a command does not clear one set
+  /// after it.
+  uint32_t force_lane_change_sequence = 0u;
+  uint32_t upload_path_sequence = 0u;
+  uint32_t upload_route_sequence = 0u;
+  bool auto_lane_change = true;
+  bool auto_update_vehicle_lights = false;
+  float perc_run_traffic_light = 0.0f;
+  float perc_run_traffic_sign = 0.0f;
+  float perc_ignore_walkers = 0.0f;
+  float perc_ignore_vehicles = 0.0f;
+  float perc_keep_right = -1.0f;
+  float perc_random_left = -1.0f;
+  float perc_random_right = -1.0f;
+  /// Sorted ids of the actors this vehicle ignores during collision detection.
+  std::vector<ActorId> ignore_collision;
+};
+
+/// Vehicles farther than @a distance from every hero vehicle are updated
+/// once every @a period cycles.
+struct TickLODBand {
+  float distance;
+  uint16_t period;
+};
+
+/// Settings shared by all the vehicles.
+struct GlobalParameters {
+  float percentage_speed_difference = 0.0f;
+  float lane_offset = 0.0f;
+  float distance_to_leading_vehicle = 2.0f;
+  /// Bands of the tick level of detail, sorted by increasing distance.
+  std::vector<TickLODBand> tick_lod_bands;
+};
+
+/// Immutable copy of the parameters of all the vehicles, published once per
+/// traffic manager cycle. Records are stored contiguously and looked up
+/// through a single index, so the stages read them without taking any lock.
+class ParameterSnapshot {
+public:
+
+  /// Replaces the content with a copy of @a vehicles and @a globals, reusing
+  /// the storage of the previous content.
+  void Assign(
+      const std::unordered_map<ActorId, VehicleParameters> &vehicles,
+      const GlobalParameters &globals) {
+    _globals = globals;
+    _index.clear();
+    _index.reserve(vehicles.size());
+    _records.resize(vehicles.size());
+    uint32_t position = 0u;
+    for (const auto &entry : vehicles) {
+      _index.emplace(entry.first, position);
+      _records[position] = entry.second;
+      ++position;
+    }
+  }
+
+  const GlobalParameters &GetGlobals() const {
+    return _globals;
+  }
+
+  /// Returns the parameters of the given vehicle, or nullptr if none of them
+  /// has been set.
+  const VehicleParameters *Find(ActorId actor_id) const {
+    const auto it = _index.find(actor_id);
+    return it != _index.end() ? &_records[it->second] : nullptr;
+  }
+
+  std::size_t size() const {
+    return _records.size();
+  }
+
+  /// Whether @a reference_id detects collisions against @a other_id.
+  bool GetCollisionDetection(ActorId reference_id, ActorId other_id) const {
+    const VehicleParameters *record = Find(reference_id);
+    return record == nullptr || !std::binary_search(
+        record->ignore_collision.begin(),
+        record->ignore_collision.end(),
+        other_id);
+  }
+
+private:
+
+  GlobalParameters _globals;
+
+  std::unordered_map<ActorId, uint32_t> _index;
+
+  std::vector<VehicleParameters> _records;
+};
+
+} // namespace traffic_manager
+} // namespace carla
@@ -7,17 +7,89 @@
 #include "carla/trafficmanager/Parameters.h"
 #include "carla/trafficmanager/Constants.h"
 
+#include <algorithm>
+#include <iterator>
+
 namespace carla {
 namespace traffic_manager {
 
-Parameters::Parameters() {
+Parameters::Parameters()
+  : published_snapshot(&snapshots[0u]) {
 
   /// Set default synchronous mode time out.
   synchronous_time_out = std::chrono::duration<int, std::milli>(10);
+
+  /// Set default tick level of detail bands.
+  SetTickLODBands(
+      std::vector<float>(std::begin(constants::TickLOD::DEFAULT_DISTANCES), std::end(constants::TickLOD::DEFAULT_DISTANCES)),
+      std::vector<uint16_t>(std::begin(constants::TickLOD::DEFAULT_PERIODS), std::end(constants::TickLOD::DEFAULT_PERIODS)));
+  PublishSnapshot();
 }
 
 Parameters::~Parameters() {}
 
+namespace {
+
+  /// Sequence number of the command marked by @a flag.
+  uint32_t GetCommandSequence(const VehicleParameters &vehicle, const VehicleParameters::Flags flag) {
+    switch (flag) {
+      case VehicleParameters::UPLOAD_PATH:
+        return vehicle.upload_path_sequence;
+      case VehicleParameters::UPLOAD_ROUTE:
+        return vehicle.upload_route_sequence;
+      default:
+        return vehicle.force_lane_change_sequence;
+    }
+  }
+
+} // namespace
+
+void Parameters::PublishSnapshot() {
+
+  std::lock_guard<std::mutex> lock(staging_mutex);
+  // Commands consumed in the last cycle are cleared, unless a new one was set
+  // after the snapshot they were read from was published.
+  for (const ConsumedCommand &command : consumed_commands) {
+    const auto staged = staging_vehicles.find(command.actor_id);
+    if (staged != staging_vehicles.end() &&
+        GetCommandSequence(staged->second, command.flag) == command.sequence) {
+      staged->second.flags &= ~command.flag;
+      staging_dirty = true;
+    }
+  }
+  consumed_commands.clear();
+  if (!staging_dirty) {
+    return;
+  }
+  // The stages of the previous cycle are done with the published snapshot
+  // by now, so the other one can be rebuilt and swapped in.
+  const ParameterSnapshot *current = published_snapshot.load(std::memory_order_relaxed);
+  ParameterSnapshot &next = current == &snapshots[0u] ? snapshots[1u] : snapshots[0u];
+  next.Assign(staging_vehicles, staging_globals);
+  published_snapshot.store(&next, std::memory_order_release);
+  staging_dirty = false;
+}
+
+template <typename Functor>
+void Parameters::UpdateVehicle(const ActorId actor_id, Functor &&functor) {
+  std::lock_guard<std::mutex> lock(staging_mutex);
+  functor(staging_vehicles[actor_id]);
+  staging_dirty = true;
+}
+
+template <typename Functor>
+void Parameters::UpdateGlobals(Functor &&functor) {
+  std::lock_guard<std::mutex> lock(staging_mutex);
+  functor(staging_globals);
+  staging_dirty = true;
+}
+
+void Parameters::ConsumeCommand(const ActorId actor_id,
+                                const VehicleParameters &vehicle,
+                                const VehicleParameters::Flags flag) {
+  consumed_commands.push_back({actor_id, flag, GetCommandSequence(vehicle, flag)});
+}
+
 //////////////////////////////////// SETTERS //////////////////////////////////
 
 void Parameters::SetHybridPhysicsMode(const bool mode_switch) {
@@ -41,106 +113,126 @@ void Parameters::SetBoundariesRespawnDormantVehicles(const float lower_bound, co
 }
 
 void Parameters::SetPercentageSpeedDifference(const ActorPtr &actor, const float percentage) {
+  SetPercentageSpeedDifference(actor->GetId(), percentage);
+}
+
+void Parameters::SetPercentageSpeedDifference(const ActorId actor_id, const float percentage) {
 
   float new_percentage = std::min(100.0f, percentage);
-  percentage_difference_from_speed_limit.AddEntry({actor->GetId(), new_percentage});
-  if (exact_desired_speed.Contains(actor->GetId())) {
-    exact_desired_speed.RemoveEntry(actor->GetId());
-  }
+  UpdateVehicle(actor_id, [new_percentage](VehicleParameters &vehicle) {
+    vehicle.percentage_speed_difference = new_percentage;
+    vehicle.flags |= VehicleParameters::PERCENTAGE_SPEED_DIFFERENCE;
+    vehicle.flags &= ~VehicleParameters::EXACT_DESIRED_SPEED;
+  });
 }
 
 void Parameters::SetLaneOffset(const ActorPtr &actor, const float offset) {
-  const auto entry = std::make_pair(actor->GetId(), offset);
-  lane_offset.AddEntry(entry);
+  UpdateVehicle(actor->GetId(), [offset](VehicleParameters &vehicle) {
+    vehicle.lane_offset = offset;
+    vehicle.flags |= VehicleParameters::LANE_OFFSET;
+  });
 }
 
 void Parameters::SetDesiredSpeed(const ActorPtr &actor, const float value) {
+  SetDesiredSpeed(actor->GetId(), value);
+}
+
+void Parameters::SetDesiredSpeed(const ActorId actor_id, const float value) {
 
   float new_value = std::max(0.0f, value);
-  exact_desired_speed.AddEntry({actor->GetId(), new_value});
-  if (percentage_difference_from_speed_limit.Contains(actor->GetId())) {
-    percentage_difference_from_speed_limit.RemoveEntry(actor->GetId());
-  }
+  UpdateVehicle(actor_id, [new_value](VehicleParameters &vehicle) {
+    vehicle.exact_desired_speed = new_value;
+    vehicle.flags |= VehicleParameters::EXACT_DESIRED_SPEED;
+    vehicle.flags &= ~VehicleParameters::PERCENTAGE_SPEED_DIFFERENCE;
+  });
 }
 
 void Parameters::SetGlobalPercentageSpeedDifference(const float percentage) {
   float new_percentage = std::min(100.0f, percentage);
-  global_percentage_difference_from_limit = new_percentage;
+  UpdateGlobals([new_percentage](GlobalParameters &globals) {
+    globals.percentage_speed_difference = new_percentage;
+  });
 }
 
 void Parameters::SetGlobalLaneOffset(const float offset) {
-  global_lane_offset = offset;
+  UpdateGlobals([offset](GlobalParameters &globals) {
+    globals.lane_offset = offset;
+  });
 }
 
 void Parameters::SetCollisionDetection(const ActorPtr &reference_actor, const ActorPtr &other_actor, const bool detect_collision) {
   const ActorId reference_id = reference_actor->GetId();
   const ActorId other_id = other_actor->GetId();
 
-  if (detect_collision) {
-    if (ignore_collision.Contains(reference_id)) {
-      std::shared_ptr<AtomicActorSet> actor_set = ignore_collision.GetValue(reference_id);
-      if (actor_set->Contains(other_id)) {
-        actor_set->Remove({other_id});
-      }
-    }
-  } else {
-    if (ignore_collision.Contains(reference_id)) {
-      std::shared_ptr<AtomicActorSet> actor_set = ignore_collision.GetValue(reference_id);
-      if (!actor_set->Contains(other_id)) {
-        actor_set->Insert({other_actor});
-      }
-    } else {
-      std::shared_ptr<AtomicActorSet> actor_set = std::make_shared<AtomicActorSet>();
-      actor_set->Insert({other_actor});
-      auto entry = std::make_pair(reference_id, actor_set);
-      ignore_collision.AddEntry(entry);
+  UpdateVehicle(reference_id, [other_id, detect_collision](VehicleParameters &vehicle) {
+    std::vector<ActorId> &ignored = vehicle.ignore_collision;
+    const auto it = std::lower_bound(ignored.begin(), ignored.end(), other_id);
+    const bool is_ignored = it != ignored.end() && *it == other_id;
+    if (detect_collision && is_ignored) {
+      ignored.erase(it);
+    } else if (!detect_collision && !is_ignored) {
+      ignored.insert(it, other_id);
     }
-  }
+  });
 }
 
 void Parameters::SetForceLaneChange(const ActorPtr &actor, const bool direction) {
+  SetForceLaneChange(actor->GetId(), direction);
+}
+
+void Parameters::SetForceLaneChange(const ActorId actor_id, const bool direction) {
 
   const ChangeLaneInfo lane_change_info = {true, direction};
-  const auto entry = std::make_pair(actor->GetId(), lane_change_info);
-  force_lane_change.AddEntry(entry);
+  UpdateVehicle(actor_id, [lane_change_info](VehicleParameters &vehicle) {
+    vehicle.force_lane_change = lane_change_info;
+    vehicle.flags |= VehicleParameters::FORCE_LANE_CHANGE;
+    ++vehicle.force_lane_change_sequence;
+  });
 }
 
 void Parameters::SetKeepRightPercentage(const ActorPtr &actor, const float percentage) {
 
-  const auto entry = std::make_pair(actor->GetId(), percentage);
-  perc_keep_right.AddEntry(entry);
+  UpdateVehicle(actor->GetId(), [percentage](VehicleParameters &vehicle) {
+    vehicle.perc_keep_right = percentage;
+  });
 }
 
 void Parameters::SetRandomLeftLaneChangePercentage(const ActorPtr &actor, const float percentage) {
 
-  const auto entry = std::make_pair(actor->GetId(), percentage);
-  perc_random_left.AddEntry(entry);
+  UpdateVehicle(actor->GetId(), [percentage](VehicleParameters &vehicle) {
+    vehicle.perc_random_left = percentage;
+  });
 }
 
 void Parameters::SetRandomRightLaneChangePercentage(const ActorPtr &actor, const float percentage) {
 
-  const auto entry = std::make_pair(actor->GetId(), percentage);
-  perc_random_right.AddEntry(entry);
+  UpdateVehicle(actor->GetId(), [percentage](VehicleParameters &vehicle) {
+    vehicle.perc_random_right = percentage;
+  });
 
 }
 
 void Parameters::SetUpdateVehicleLights(const ActorPtr &actor, const bool do_update) {
 
-  const auto entry = std::make_pair(actor->GetId(), do_update);
-  auto_update_vehicle_lights.AddEntry(entry);
+  UpdateVehicle(actor->GetId(), [do_update](VehicleParameters &vehicle) {
+    vehicle.auto_update_vehicle_lights = do_update;
+  });
 }
 
 void Parameters::SetAutoLaneChange(const ActorPtr &actor, const bool enable) {
 
-  const auto entry = std::make_pair(actor->GetId(), enable);
-  auto_lane_change.AddEntry(entry);
+  UpdateVehicle(actor->GetId(), [enable](VehicleParameters &vehicle) {
+    vehicle.auto_lane_change = enable;
+  });
 }
 
 void Parameters::SetDistanceToLeadingVehicle(const ActorPtr &actor, const float distance) {
 
   float new_distance = std::max(0.0f, distance);
-  const auto entry = std::make_pair(actor->GetId(), new_distance);
-  distance_to_leading_vehicle.AddEntry(entry);
+  UpdateVehicle(actor->GetId(), [new_distance](VehicleParameters &vehicle) {
+    vehicle.distance_to_leading_vehicle = new_distance;
+    vehicle.flags |= VehicleParameters::DISTANCE_TO_LEADING_VEHICLE;
+  });
 }
 
 void Parameters::SetSynchronousMode(const bool mode_switch) {
@@ -153,35 +245,41 @@ void Parameters::SetSynchronousModeTimeOutInMiliSecond(const double time) {
 
 void Parameters::SetGlobalDistanceToLeadingVehicle(const float dist) {
 
-  distance_margin.store(dist);
+  UpdateGlobals([dist](GlobalParameters &globals) {
+    globals.distance_to_leading_vehicle = dist;
+  });
 }
 
 void Parameters::SetPercentageRunningLight(const ActorPtr &actor, const float perc) {
 
   float new_perc = cg::Math::Clamp(perc, 0.0f, 100.0f);
-  const auto entry = std::make_pair(actor->GetId(), new_perc);
-  perc_run_traffic_light.AddEntry(entry);
+  UpdateVehicle(actor->GetId(), [new_perc](VehicleParameters &vehicle) {
+    vehicle.perc_run_traffic_light = new_perc;
+  });
 }
 
 void Parameters::SetPercentageRunningSign(const ActorPtr &actor, const float perc) {
 
   float new_perc = cg::Math::Clamp(perc, 0.0f, 100.0f);
-  const auto entry = std::make_pair(actor->GetId(), new_perc);
-  perc_run_traffic_sign.AddEntry(entry);
+  UpdateVehicle(actor->GetId(), [new_perc](VehicleParameters &vehicle) {
+    vehicle.perc_run_traffic_sign = new_perc;
+  });
 }
 
 void Parameters::SetPercentageIgnoreVehicles(const ActorPtr &actor, const float perc) {
 
   float new_perc = cg::Math::Clamp(perc, 0.0f, 100.0f);
-  const auto entry = std::make_pair(actor->GetId(), new_perc);
-  perc_ignore_vehicles.AddEntry(entry);
+  UpdateVehicle(actor->GetId(), [new_perc](VehicleParameters &vehicle) {
+    vehicle.perc_ignore_vehicles = new_perc;
+  });
 }
 
 void Parameters::SetPercentageIgnoreWalkers(const ActorPtr &actor, const float perc) {
 
   float new_perc = cg::Math::Clamp(perc,0.0f,100.0f);
-  const auto entry = std::make_pair(actor->GetId(), new_perc);
-  perc_ignore_walkers.AddEntry(entry);
+  UpdateVehicle(actor->GetId(), [new_perc](VehicleParameters &vehicle) {
+    vehicle.perc_ignore_walkers = new_perc;
+  });
 }
 
 void Parameters::SetHybridPhysicsRadius(const float radius) {
@@ -193,18 +291,71 @@ void Parameters::SetOSMMode(const bool mode_switch) {
   osm_mode.store(mode_switch);
 }
 
+void Parameters::SetParallelStageThreads(const uint16_t num_threads) {
+  parallel_stage_threads.store(num_threads);
+}
+
+void Parameters::SetTickLODMode(const bool mode_switch) {
+  tick_lod_mode.store(mode_switch);
+}
+
+void Parameters::SetTickLODBands(const std::vector<float> &distances, const std::vector<uint16_t> &periods) {
+  std::vector<TickLODBand> bands;
+  for (std::size_t i = 0u; i < std::min(distances.size(), periods.size()); ++i) {
+    bands.push_back({std::max(0.0f, distances[i]), std::max<uint16_t>(1u, periods[i])});
+  }
+  std::sort(bands.begin(), bands.end(), [](const TickLODBand &lhs, const TickLODBand &rhs) {
+    return lhs.distance < rhs.distance;
+  });
+  UpdateGlobals([&bands](GlobalParameters &globals) {
+    globals.tick_lod_bands = std::move(bands);
+  });
+}
+
 void Parameters::SetCustomPath(const ActorPtr &actor, const Path path, const bool empty_buffer) {
-  const auto entry = std::make_pair(actor->GetId(), path);
+  SetCustomPath(actor->GetId(), path, empty_buffer);
+}
+
+void Parameters::SetCustomPath(const ActorId actor_id, const Path path, const bool empty_buffer) {
+  const auto entry = std::make_pair(actor_id, path);
   custom_path.AddEntry(entry);
-  const auto entry2 = std::make_pair(actor->GetId(), empty_buffer);
-  upload_path.AddEntry(entry2);
+  UpdateVehicle(actor_id, [empty_buffer](VehicleParameters &vehicle) {
+    vehicle.flags |= VehicleParameters::CUSTOM_PATH;
+    if (empty_buffer) {
+      vehicle.flags |= VehicleParameters::UPLOAD_PATH;
+      ++vehicle.upload_path_sequence;
+    } else {
+      vehicle.flags &= ~VehicleParameters::UPLOAD_PATH;
+    }
+  });
+}
+
+void Parameters::RemoveVehicle(const ActorId actor_id) {
+  custom_path.RemoveEntry(actor_id);
+  custom_route.RemoveEntry(actor_id);
+  std::lock_guard<std::mutex> lock(staging_mutex);
+  if (staging_vehicles.erase(actor_id) > 0u) {
+    staging_dirty = true;
+  }
 }
 
 void Parameters::RemoveUploadPath(const ActorId &actor_id, const bool remove_path) {
   if (!remove_path) {
-    upload_path.RemoveEntry(actor_id);
+    UpdateVehicle(actor_id, [](VehicleParameters &vehicle) {
+      vehicle.flags &= ~VehicleParameters::UPLOAD_PATH;
+    });
   } else {
     custom_path.RemoveEntry(actor_id);
+    UpdateVehicle(actor_id, [](VehicleParameters &vehicle) {
+      vehicle.flags &= ~VehicleParameters::CUSTOM_PATH;
+    });
+  }
+}
+
+void Parameters::ConsumeUploadPath(const ActorId actor_id) {
+  const VehicleParameters *vehicle = GetSnapshot().Find(actor_id);
+  if (vehicle != nullptr && vehicle->Has(VehicleParameters::UPLOAD_PATH)) {
+    ConsumeCommand(actor_id, *vehicle, VehicleParameters::UPLOAD_PATH);
   }
 }
 
@@ -215,17 +366,40 @@ void Parameters::UpdateUploadPath(const ActorId &actor_id, const Path path) {
 }
 
 void Parameters::SetImportedRoute(const ActorPtr &actor, const Route route, const bool empty_buffer) {
-  const auto entry = std::make_pair(actor->GetId(), route);
+  SetImportedRoute(actor->GetId(), route, empty_buffer);
+}
+
+void Parameters::SetImportedRoute(const ActorId actor_id, const Route route, const bool empty_buffer) {
+  const auto entry = std::make_pair(actor_id, route);
   custom_route.AddEntry(entry);
-  const auto entry2 = std::make_pair(actor->GetId(), empty_buffer);
-  upload_route.AddEntry(entry2);
+  UpdateVehicle(actor_id, [empty_buffer](VehicleParameters &vehicle) {
+    vehicle.flags |= VehicleParameters::IMPORTED_ROUTE;
+    if (empty_buffer) {
+      vehicle.flags |= VehicleParameters::UPLOAD_ROUTE;
+      ++vehicle.upload_route_sequence;
+    } else {
+      vehicle.flags &= ~VehicleParameters::UPLOAD_ROUTE;
+    }
+  });
 }
 
 void Parameters::RemoveImportedRoute(const ActorId &actor_id, const bool remove_path) {
   if (!remove_path) {
-    upload_route.RemoveEntry(actor_id);
+    UpdateVehicle(actor_id, [](VehicleParameters &vehicle) {
+      vehicle.flags &= ~VehicleParameters::UPLOAD_ROUTE;
+    });
   } else {
     custom_route.RemoveEntry(actor_id);
+    UpdateVehicle(actor_id, [](VehicleParameters &vehicle) {
+      vehicle.flags &= ~VehicleParameters::IMPORTED_ROUTE;
+    });
+  }
+}
+
+void Parameters::ConsumeUploadRoute(const ActorId actor_id) {
+  const VehicleParameters *vehicle = GetSnapshot().Find(actor_id);
+  if (vehicle != nullptr && vehicle->Has(VehicleParameters::UPLOAD_ROUTE)) {
+    ConsumeCommand(actor_id, *vehicle, VehicleParameters::UPLOAD_ROUTE);
   }
 }
 
@@ -252,160 +426,113 @@ double Parameters::GetSynchronousModeTimeOutInMiliSecond() const {
 
 float Parameters::GetVehicleTargetVelocity(const ActorId &actor_id, const float speed_limit) const {
 
-  float percentage_difference = global_percentage_difference_from_limit;
+  const ParameterSnapshot &snapshot = GetSnapshot();
+  float percentage_difference = snapshot.GetGlobals().percentage_speed_difference;
 
-  if (percentage_difference_from_speed_limit.Contains(actor_id)) {
-    percentage_difference = percentage_difference_from_speed_limit.GetValue(actor_id);
-  } else if (exact_desired_speed.Contains(actor_id)) {
-    return exact_desired_speed.GetValue(actor_id);
+  const VehicleParameters *vehicle = snapshot.Find(actor_id);
+  if (vehicle != nullptr) {
+    if (vehicle->Has(VehicleParameters::PERCENTAGE_SPEED_DIFFERENCE)) {
+      percentage_difference = vehicle->percentage_speed_difference;
+    } else if (vehicle->Has(VehicleParameters::EXACT_DESIRED_SPEED)) {
+      return vehicle->exact_desired_speed;
+    }
   }
 
   return speed_limit * (1.0f - percentage_difference / 100.0f);
 }
 
 float Parameters::GetLaneOffset(const ActorId &actor_id) const {
-  float offset = global_lane_offset;
 
-  if (lane_offset.Contains(actor_id)) {
-    offset = lane_offset.GetValue(actor_id);
+  const ParameterSnapshot &snapshot = GetSnapshot();
+  const VehicleParameters *vehicle = snapshot.Find(actor_id);
+  if (vehicle != nullptr && vehicle->Has(VehicleParameters::LANE_OFFSET)) {
+    return vehicle->lane_offset;
   }
 
-  return offset;
+  return snapshot.GetGlobals().lane_offset;
 }
 
 bool Parameters::GetCollisionDetection(const ActorId &reference_actor_id, const ActorId &other_actor_id) const {
 
-  bool avoid_collision = true;
-
-  if (ignore_collision.Contains(reference_actor_id) &&
-    ignore_collision.GetValue(reference_actor_id)->Contains(other_actor_id)) {
-    avoid_collision = false;
-  }
-
-  return avoid_collision;
+  return GetSnapshot().GetCollisionDetection(reference_actor_id, other_actor_id);
 }
 
 ChangeLaneInfo Parameters::GetForceLaneChange(const ActorId &actor_id) {
 
   ChangeLaneInfo change_lane_info {false, false};
 
-  if (force_lane_change.Contains(actor_id)) {
-    change_lane_info = force_lane_change.GetValue(actor_id);
+  const VehicleParameters *vehicle = GetSnapshot().Find(actor_id);
+  if (vehicle != nullptr && vehicle->Has(VehicleParameters::FORCE_LANE_CHANGE)) {
+    change_lane_info = vehicle->force_lane_change;
+    ConsumeCommand(actor_id, *vehicle, VehicleParameters::FORCE_LANE_CHANGE);
   }
 
-  force_lane_change.RemoveEntry(actor_id);
-
   return change_lane_info;
 }
 
 float Parameters::GetKeepRightPercentage(const ActorId &actor_id) {
 
-  float percentage = -1.0f;
-
-  if (perc_keep_right.Contains(actor_id)) {
-    percentage = perc_keep_right.GetValue(actor_id);
-  }
-
-  return percentage;
+  const VehicleParameters *vehicle = GetSnapshot().Find(actor_id);
+  return vehicle != nullptr ? vehicle->perc_keep_right : -1.0f;
 }
 
 float Parameters::GetRandomLeftLaneChangePercentage(const ActorId &actor_id) {
 
-  float percentage = -1.0f;
-
-  if (perc_random_left.Contains(actor_id)) {
-    percentage = perc_random_left.GetValue(actor_id);
-  }
-
-  return percentage;
+  const VehicleParameters *vehicle = GetSnapshot().Find(actor_id);
+  return vehicle != nullptr ? vehicle->perc_random_left : -1.0f;
 }
 
 float Parameters::GetRandomRightLaneChangePercentage(const ActorId &actor_id) {
 
-  float percentage = -1.0f;
-
-  if (perc_random_right.Contains(actor_id)) {
-    percentage = perc_random_right.GetValue(actor_id);
-  }
-
-  return percentage;
+  const VehicleParameters *vehicle = GetSnapshot().Find(actor_id);
+  return vehicle != nullptr ? vehicle->perc_random_right : -1.0f;
 }
 
 bool Parameters::GetAutoLaneChange(const ActorId &actor_id) const {
 
-  bool auto_lane_change_policy = true;
-
-  if (auto_lane_change.Contains(actor_id)) {
-    auto_lane_change_policy = auto_lane_change.GetValue(actor_id);
-  }
-
-  return auto_lane_change_policy;
+  const VehicleParameters *vehicle = GetSnapshot().Find(actor_id);
+  return vehicle != nullptr ? vehicle->auto_lane_change : true;
 }
 
 float Parameters::GetDistanceToLeadingVehicle(const ActorId &actor_id) const {
 
-  float specific_distance_margin = 0.0f;
-  if (distance_to_leading_vehicle.Contains(actor_id)) {
-    specific_distance_margin = distance_to_leading_vehicle.GetValue(actor_id);
-  } else {
-    specific_distance_margin = distance_margin;
+  const ParameterSnapshot &snapshot = GetSnapshot();
+  const VehicleParameters *vehicle = snapshot.Find(actor_id);
+  if (vehicle != nullptr && vehicle->Has(VehicleParameters::DISTANCE_TO_LEADING_VEHICLE)) {
+    return vehicle->distance_to_leading_vehicle;
   }
 
-  return specific_distance_margin;
+  return snapshot.GetGlobals().distance_to_leading_vehicle;
 }
 
 float Parameters::GetPercentageRunningLight(const ActorId &actor_id) const {
 
-  float percentage = 0.0f;
-
-  if (perc_run_traffic_light.Contains(actor_id)) {
-    percentage = perc_run_traffic_light.GetValue(actor_id);
-  }
-
-  return percentage;
+  const VehicleParameters *vehicle = GetSnapshot().Find(actor_id);
+  return vehicle != nullptr ? vehicle->perc_run_traffic_light : 0.0f;
 }
 
 float Parameters::GetPercentageRunningSign(const ActorId &actor_id) const {
 
-  float percentage = 0.0f;
-
-  if (perc_run_traffic_sign.Contains(actor_id)) {
-    percentage = perc_run_traffic_sign.GetValue(actor_id);
-  }
-
-  return percentage;
+  const VehicleParameters *vehicle = GetSnapshot().Find(actor_id);
+  return vehicle != nullptr ? vehicle->perc_run_traffic_sign : 0.0f;
 }
 
 float Parameters::GetPercentageIgnoreWalkers(const ActorId &actor_id) const {
 
-  float percentage = 0.0f;
-
-  if (perc_ignore_walkers.Contains(actor_id)) {
-    percentage = perc_ignore_walkers.GetValue(actor_id);
-  }
-
-  return percentage;
+  const VehicleParameters *vehicle = GetSnapshot().Find(actor_id);
+  return vehicle != nullptr ? vehicle->perc_ignore_walkers : 0.0f;
 }
 
 bool Parameters::GetUpdateVehicleLights(const ActorId &actor_id) const {
-  bool do_update = false;
 
-  if (auto_update_vehicle_lights.Contains(actor_id)) {
-    do_update = auto_update_vehicle_lights.GetValue(actor_id);
-  }
-
-  return do_update;
+  const VehicleParameters *vehicle = GetSnapshot().Find(actor_id);
+  return vehicle != nullptr ? vehicle->auto_update_vehicle_lights : false;
 }
 
 float Parameters::GetPercentageIgnoreVehicles(const ActorId &actor_id) const {
 
-  float percentage = 0.0f;
-
-  if (perc_ignore_vehicles.Contains(actor_id)) {
-    percentage = perc_ignore_vehicles.GetValue(actor_id);
-  }
-
-  return percentage;
+  const VehicleParameters *vehicle = GetSnapshot().Find(actor_id);
+  return vehicle != nullptr ? vehicle->perc_ignore_vehicles : 0.0f;
 }
 
 bool Parameters::GetHybridPhysicsMode() const {
@@ -434,22 +561,34 @@ bool Parameters::GetOSMMode() const {
   return osm_mode.load();
 }
 
-bool Parameters::GetUploadPath(const ActorId &actor_id) const {
+uint16_t Parameters::GetParallelStageThreads() const {
 
-  bool custom_path_bool = false;
+  return parallel_stage_threads.load();
+}
 
-  if (upload_path.Contains(actor_id)) {
-    custom_path_bool = upload_path.GetValue(actor_id);
-  }
+bool Parameters::GetTickLODMode() const {
+
+  return tick_lod_mode.load();
+}
+
+const std::vector<TickLODBand> &Parameters::GetTickLODBands() const {
+
+  return GetSnapshot().GetGlobals().tick_lod_bands;
+}
+
+bool Parameters::GetUploadPath(const ActorId &actor_id) const {
 
-  return custom_path_bool;
+  const VehicleParameters *vehicle = GetSnapshot().Find(actor_id);
+  return vehicle != nullptr && vehicle->Has(VehicleParameters::UPLOAD_PATH);
 }
 
 Path Parameters::GetCustomPath(const ActorId &actor_id) const {
 
   Path custom_path_import;
 
-  if (custom_path.Contains(actor_id)) {
+  // Only vehicles flagged in the snapshot need to look up the shared paths.
+  const VehicleParameters *vehicle = GetSnapshot().Find(actor_id);
+  if (vehicle != nullptr && vehicle->Has(VehicleParameters::CUSTOM_PATH) && custom_path.Contains(actor_id)) {
     custom_path_import = custom_path.GetValue(actor_id);
   }
 
@@ -459,20 +598,16 @@ Path Parameters::GetCustomPath(const ActorId &actor_id) const {
 
 bool Parameters::GetUploadRoute(const ActorId &actor_id) const {
 
-  bool custom_route_bool = false;
-
-  if (upload_route.Contains(actor_id)) {
-    custom_route_bool = upload_route.GetValue(actor_id);
-  }
-
-  return custom_route_bool;
+  const VehicleParameters *vehicle = GetSnapshot().Find(actor_id);
+  return vehicle != nullptr && vehicle->Has(VehicleParameters::UPLOAD_ROUTE);
 }
 
 Route Parameters::GetImportedRoute(const ActorId &actor_id) const {
 
   Route custom_route_import;
 
-  if (custom_route.Contains(actor_id)) {
+  const VehicleParameters *vehicle = GetSnapshot().Find(actor_id);
+  if (vehicle != nullptr && vehicle->Has(VehicleParameters::IMPORTED_ROUTE) && custom_route.Contains(actor_id)) {
     custom_route_import = custom_route.GetValue(actor_id);
   }
 
@@ -8,16 +8,18 @@
 
 #include <atomic>
 #include <chrono>
+#include <mutex>
 #include <random>
 #include <unordered_map>
+#include <vector>
 
 #include "carla/client/Actor.h"
 #include "carla/client/Vehicle.h"
 #include "carla/Memory.h"
 #include "carla/rpc/ActorId.h"
 
-#include "carla/trafficmanager/AtomicActorSet.h"
 #include "carla/trafficmanager/AtomicMap.h"
+#include "carla/trafficmanager/ParameterSnapshot.h"
 
 namespace carla {
 namespace traffic_manager {
@@ -25,56 +27,37 @@ namespace traffic_manager {
 namespace cc = carla::client;
 namespace cg = carla::geom;
 using ActorPtr = carla::SharedPtr<cc::Actor>;
-using ActorId = carla::ActorId;
 using Path = std::vector<cg::Location>;
 using Route = std::vector<uint8_t>;
 
-struct ChangeLaneInfo {
-  bool change_lane = false;
-  bool direction = false;
-};
-
 class Parameters {
 
 private:
-  /// Target velocity map for individual vehicles, based on a % diffrerence from speed limit.
-  AtomicMap<ActorId, float> percentage_difference_from_speed_limit;
-  /// Lane offset map for individual vehicles.
-  AtomicMap<ActorId, float> lane_offset;
-  /// Target velocity map for individual vehicles, based on a desired velocity.
-  AtomicMap<ActorId, float> exact_desired_speed;
-  /// Global target velocity limit % difference.
-  float global_percentage_difference_from_limit = 0;
-  /// Global lane offset
-  float global_lane_offset = 0;
-  /// Map containing a set of actors to be ignored during collision detection.
-  AtomicMap<ActorId, std::shared_ptr<AtomicActorSet>> ignore_collision;
-  /// Map containing distance to leading vehicle command.
-  AtomicMap<ActorId, float> distance_to_leading_vehicle;
-  /// Map containing force lane change commands.
-  AtomicMap<ActorId, ChangeLaneInfo> force_lane_change;
-  /// Map containing auto lane change commands.
-  AtomicMap<ActorId, bool> auto_lane_change;
-  /// Map containing % of running a traffic light.
-  AtomicMap<ActorId, float> perc_run_traffic_light;
-  /// Map containing % of running a traffic sign.
-  AtomicMap<ActorId, float> perc_run_traffic_sign;
-  /// Map containing % of ignoring walkers.
-  AtomicMap<ActorId, float> perc_ignore_walkers;
-  /// Map containing % of ignoring vehicles.
-  AtomicMap<ActorId, float> perc_ignore_vehicles;
-  /// Map containing % of keep right rule.
-  AtomicMap<ActorId, float> perc_keep_right;
-  /// Map containing % of random left lane change.
-  AtomicMap<ActorId, float> perc_random_left;
-  /// Map containing % of random right lane change.
-  AtomicMap<ActorId, float> perc_random_right;
-  /// Map containing the automatic vehicle lights update flag
-  AtomicMap<ActorId, bool> auto_update_vehicle_lights;
+  /// Guards the staging copy of the parameters.
+  mutable std::mutex staging_mutex;
+  /// Parameters of individual vehicles written by the setters.
+  std::unordered_map<ActorId, VehicleParameters> staging_vehicles;
+  /// Global parameters written by the setters.
+  GlobalParameters staging_globals;
+  /// Whether the staging copy changed since the last published snapshot.
+  bool staging_dirty = false;
+  /// Command read from the published snapshot by the stages.
+  struct ConsumedCommand {
+    ActorId actor_id;
+    VehicleParameters::Flags flag;
+    uint32_t sequence;
+  };
+  /// Commands consumed during the current cycle, cleared from the staging
+  /// copy by the next PublishSnapshot. Only the traffic manager thread, which
+  /// runs both the stages and PublishSnapshot, touches it, so it needs no lock.
+  std::vector<ConsumedCommand> consumed_commands;
+  /// Double buffered snapshots, one published and the other rebuilt on the
+  /// next cycle.
+  ParameterSnapshot snapshots[2u];
+  /// Snapshot read by the stages.
+  std::atomic<const ParameterSnapshot *> published_snapshot;
   /// Synchronous mode switch.
   std::atomic<bool> synchronous_mode{false};
-  /// Distance margin
-  std::atomic<float> distance_margin{2.0};
   /// Hybrid physics mode switch.
   std::atomic<bool> hybrid_physics_mode{false};
   /// Automatic respawn mode switch.
@@ -91,24 +74,48 @@ private:
   std::atomic<float> hybrid_physics_radius {70.0};
   /// Parameter specifying Open Street Map mode.
   std::atomic<bool> osm_mode {true};
-  /// Parameter specifying if importing a custom path.
-  AtomicMap<ActorId, bool> upload_path;
+  /// Tick level of detail switch.
+  std::atomic<bool> tick_lod_mode {false};
+  /// Number of threads the per-vehicle stages are sharded across.
+  /// Values lower than 2 run the stages serially.
+  std::atomic<uint16_t> parallel_stage_threads {0u};
   /// Structure to hold all custom paths.
   AtomicMap<ActorId, Path> custom_path;
-  /// Parameter specifying if importing a custom route.
-  AtomicMap<ActorId, bool> upload_route;
   /// Structure to hold all custom routes.
   AtomicMap<ActorId, Route> custom_route;
 
+  /// Applies @a functor to the staged parameters of a vehicle.
+  template <typename Functor>
+  void UpdateVehicle(const ActorId actor_id, Functor &&functor);
+
+  /// Applies @a functor to the staged global parameters.
+  template <typename Functor>
+  void UpdateGlobals(Functor &&functor);
+
+  /// Queues the command marked by @a flag in the published parameters of a
+  /// vehicle to be cleared by the next PublishSnapshot.
+  void ConsumeCommand(const ActorId actor_id, const VehicleParameters &vehicle, const VehicleParameters::Flags flag);
+
 public:
   Parameters();
   ~Parameters();
 
+  /// Publishes the parameters set since the last call, so that they are
+  /// visible to the getters. Called by the traffic manager at the start of
+  /// every cycle, before running the stages.
+  void PublishSnapshot();
+
+  /// Snapshot of the parameters read by the stages during the current cycle.
+  const ParameterSnapshot &GetSnapshot() const {
+    return *published_snapshot.load(std::memory_order_acquire);
+  }
+
   ////////////////////////////////// SETTERS /////////////////////////////////////
 
   /// Set a vehicle's % decrease in velocity with respect to the speed limit.
   /// If less than 0, it's a % increase.
   void SetPercentageSpeedDifference(const ActorPtr &actor, const float percentage);
+  void SetPercentageSpeedDifference(const ActorId actor_id, const float percentage);
 
   /// Method to set a lane offset displacement from the center line.
   /// Positive values imply a right offset while negative ones mean a left one.
@@ -116,6 +123,7 @@ public:
 
   /// Set a vehicle's exact desired velocity.
   void SetDesiredSpeed(const ActorPtr &actor, const float value);
+  void SetDesiredSpeed(const ActorId actor_id, const float value);
 
   /// Set a global % decrease in velocity with respect to the speed limit.
   /// If less than 0, it's a % increase.
@@ -134,6 +142,7 @@ public:
   /// Method to force lane change on a vehicle.
   /// Direction flag can be set to true for left and false for right.
   void SetForceLaneChange(const ActorPtr &actor, const bool direction);
+  void SetForceLaneChange(const ActorId actor_id, const bool direction);
 
   /// Enable/disable automatic lane change on a vehicle.
   void SetAutoLaneChange(const ActorPtr &actor, const bool enable);
@@ -184,6 +193,18 @@ public:
   /// Method to set Open Street Map mode.
   void SetOSMMode(const bool mode_switch);
 
+  /// Method to set the number of threads used to run the stages in parallel.
+  void SetParallelStageThreads(const uint16_t num_threads);
+
+  /// Method to set the tick level of detail mode, which updates vehicles far
+  /// from the hero vehicles less often.
+  void SetTickLODMode(const bool mode_switch);
+
+  /// Method to set the distance bands of the tick level of detail. Vehicles
+  /// farther than distances[i] from every hero vehicle are updated once
+  /// every periods[i] cycles.
+  void SetTickLODBands(const std::vector<float> &distances, const std::vector<uint16_t> &periods);
+
   /// Method to set if we are automatically respawning vehicles.
   void SetRespawnDormantVehicles(const bool mode_switch);
 
@@ -195,19 +216,34 @@ public:
 
   /// Method to set our own imported path.
   void SetCustomPath(const ActorPtr &actor, const Path path, const bool empty_buffer);
+  void SetCustomPath(const ActorId actor_id, const Path path, const bool empty_buffer);
+
+  /// Method to drop every parameter set for a vehicle, once it is destroyed.
+  /// Vehicles unregistered while alive keep their parameters, which apply
+  /// again if they are registered back.
+  void RemoveVehicle(const ActorId actor_id);
 
   /// Method to remove a list of points.
   void RemoveUploadPath(const ActorId &actor_id, const bool remove_path);
 
+  /// Method for the stages to mark the upload of a custom path as done. The
+  /// upload is cleared from the next snapshot.
+  void ConsumeUploadPath(const ActorId actor_id);
+
   /// Method to update an already set list of points.
   void UpdateUploadPath(const ActorId &actor_id, const Path path);
 
   /// Method to set our own imported route.
   void SetImportedRoute(const ActorPtr &actor, const Route route, const bool empty_buffer);
+  void SetImportedRoute(const ActorId actor_id, const Route route, const bool empty_buffer);
 
   /// Method to remove a route.
   void RemoveImportedRoute(const ActorId &actor_id, const bool remove_path);
 
+  /// Method for the stages to mark the upload of an imported route as done.
+  /// The upload is cleared from the next snapshot.
+  void ConsumeUploadRoute(const ActorId actor_id);
+
   /// Method to update an already set route.
   void UpdateImportedRoute(const ActorId &actor_id, const Route route);
 
@@ -225,7 +261,8 @@ public:
   /// Method to query collision avoidance rule between a pair of vehicles.
   bool GetCollisionDetection(const ActorId &reference_actor_id, const ActorId &other_actor_id) const;
 
-  /// Method to query lane change command for a vehicle.
+  /// Method to query lane change command for a vehicle. The command is
+  /// consumed, it is cleared from the next snapshot unless a new one is set.
   ChangeLaneInfo GetForceLaneChange(const ActorId &actor_id);
 
   /// Method to query percentage probability of keep right rule for a vehicle.
@@ -279,6 +316,15 @@ public:
   /// Method to get Open Street Map mode.
   bool GetOSMMode() const;
 
+  /// Method to get the number of threads used to run the stages in parallel.
+  uint16_t GetParallelStageThreads() const;
+
+  /// Method to get the tick level of detail mode.
+  bool GetTickLODMode() const;
+
+  /// Method to get the distance bands of the tick level of detail.
+  const std::vector<TickLODBand> &GetTickLODBands() const;
+
   /// Method to get if we are uploading a path.
   bool GetUploadPath(const ActorId &actor_id) const;
 
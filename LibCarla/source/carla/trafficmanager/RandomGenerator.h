@@ -13,6 +13,8 @@ class RandomGenerator {
 public:
     RandomGenerator(const uint64_t seed): mt(std::mt19937(seed)), dist(0.0, 100.0) {}
     double next() { return dist(mt); }
+    /// Draws the seed of another generator, e.g. the stream of a vehicle.
+    uint64_t NextSeed() { return mt(); }
 private:
     std::mt19937 mt;
     std::uniform_real_distribution<double> dist;
@@ -126,6 +126,14 @@ namespace traffic_manager {
     return grid_id;
   }
 
+  void SimpleWaypoint::SetIndex(uint32_t _index) {
+    index = _index;
+  }
+
+  uint32_t SimpleWaypoint::GetIndex() const {
+    return index;
+  }
+
   GeoGridId SimpleWaypoint::GetJunctionId() const {
     return waypoint->GetJunctionId();
   }
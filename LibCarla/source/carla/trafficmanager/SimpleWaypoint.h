@@ -6,6 +6,7 @@
 
 #pragma once
 
+#include <limits>
 #include <memory.h>
 
 #include "carla/client/Waypoint.h"
@@ -57,6 +58,8 @@ namespace traffic_manager {
     GeoGridId geodesic_grid_id = 0;
     // Boolean to hold if the waypoint belongs to a junction
     bool _is_junction = false;
+    /// Position of the waypoint in the dense topology of the map holding it.
+    uint32_t index = std::numeric_limits<uint32_t>::max();
 
   public:
 
@@ -103,6 +106,10 @@ namespace traffic_manager {
     void SetGeodesicGridId(GeoGridId _geodesic_grid_id);
     GeoGridId GetGeodesicGridId();
 
+    /// Accessor methods for the position of the waypoint in the dense topology.
+    void SetIndex(uint32_t _index);
+    uint32_t GetIndex() const;
+
     /// Method to retreive junction id of the waypoint.
     GeoGridId GetJunctionId() const;
 
@@ -1,7 +1,9 @@
 
 #pragma once
 
+#include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
 #include "carla/trafficmanager/DataStructures.h"
 
@@ -23,13 +25,11 @@ struct KinematicState {
   bool is_dormant;
   cg::Location hybrid_end_location;
 };
-using KinematicStateMap = std::unordered_map<ActorId, KinematicState>;
 
 struct TrafficLightState {
   TLS tl_state;
   bool at_traffic_light;
 };
-using TrafficLightStateMap = std::unordered_map<ActorId, TrafficLightState>;
 
 struct StaticAttributes {
   ActorType actor_type;
@@ -37,20 +37,37 @@ struct StaticAttributes {
   float half_width;
   float half_height;
 };
-using StaticAttributeMap = std::unordered_map<ActorId, StaticAttributes>;
 
 /// This class holds the state of all the vehicles in the simlation.
+/// The state is stored as a structure of arrays. Every actor owns one slot,
+/// the same in all the arrays. The stages resolve the slot of a vehicle once
+/// and read its state through the Get*At accessors, which do no lookup.
+/// Slots are dense: removing an actor moves the actor in the last slot into
+/// the freed one.
 class SimulationState {
 
 private:
-  // Structure to hold ids of all actors in the simulation.
-  std::unordered_set<ActorId> actor_set;
-  // Structure containing dynamic motion related state of actors.
-  KinematicStateMap kinematic_state_map;
-  // Structure containing static attributes of actors.
-  StaticAttributeMap static_attribute_map;
+  // Structure mapping actor ids to their slot in the state arrays.
+  std::unordered_map<ActorId, std::size_t> actor_slots;
+  // Actor ids indexed by slot.
+  std::vector<ActorId> actor_ids;
+  // Structures containing dynamic motion related state of actors.
+  std::vector<cg::Location> locations;
+  std::vector<cg::Rotation> rotations;
+  std::vector<cg::Vector3D> headings;
+  std::vector<cg::Vector3D> velocities;
+  std::vector<float> speed_limits;
+  std::vector<uint8_t> physics_enabled;
+  std::vector<uint8_t> dormant;
+  std::vector<cg::Location> hybrid_end_locations;
+  // Structures containing static attributes of actors.
+  std::vector<ActorType> actor_types;
+  std::vector<cg::Vector3D> dimensions;
   // Structure containing dynamic traffic light related state of actors.
-  TrafficLightStateMap tl_state_map;
+  std::vector<TrafficLightState> tl_states;
+
+  // Method to write a kinematic state into the given slot.
+  void SetKinematicState(const std::size_t slot, const KinematicState &state);
 
 public :
   SimulationState();
@@ -100,6 +117,73 @@ public :
 
   cg::Vector3D GetDimensions(const ActorId actor_id) const;
 
+  ///////////////////////////// SLOT ACCESS /////////////////////////////////
+
+  // Number of actors, slots range from 0 to Size() - 1.
+  std::size_t Size() const {
+    return actor_ids.size();
+  }
+
+  // Method to retrieve the slot of an actor. Slots remain valid until an
+  // actor is removed.
+  std::size_t GetSlot(const ActorId actor_id) const {
+    return actor_slots.at(actor_id);
+  }
+
+  // Method to retrieve the slot of an actor, or Size() if the actor is not
+  // present in the simulation state.
+  std::size_t FindSlot(const ActorId actor_id) const {
+    auto slot_it = actor_slots.find(actor_id);
+    return slot_it != actor_slots.end() ? slot_it->second : actor_ids.size();
+  }
+
+  ActorId GetActorIdAt(const std::size_t slot) const {
+    return actor_ids[slot];
+  }
+
+  const cg::Location &GetLocationAt(const std::size_t slot) const {
+    return locations[slot];
+  }
+
+  const cg::Location &GetHybridEndLocationAt(const std::size_t slot) const {
+    return hybrid_end_locations[slot];
+  }
+
+  const cg::Rotation &GetRotationAt(const std::size_t slot) const {
+    return rotations[slot];
+  }
+
+  const cg::Vector3D &GetHeadingAt(const std::size_t slot) const {
+    return headings[slot];
+  }
+
+  const cg::Vector3D &GetVelocityAt(const std::size_t slot) const {
+    return velocities[slot];
+  }
+
+  float GetSpeedLimitAt(const std::size_t slot) const {
+    return speed_limits[slot];
+  }
+
+  bool IsPhysicsEnabledAt(const std::size_t slot) const {
+    return physics_enabled[slot] != 0u;
+  }
+
+  bool IsDormantAt(const std::size_t slot) const {
+    return dormant[slot] != 0u;
+  }
+
+  const TrafficLightState &GetTLSAt(const std::size_t slot) const {
+    return tl_states[slot];
+  }
+
+  ActorType GetTypeAt(const std::size_t slot) const {
+    return actor_types[slot];
+  }
+
+  const cg::Vector3D &GetDimensionsAt(const std::size_t slot) const {
+    return dimensions[slot];
+  }
 };
 
 } // namespace traffic_manager
@@ -0,0 +1,209 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/trafficmanager/StageProfiler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+namespace carla {
+namespace traffic_manager {
+
+using constants::Profiler::HISTOGRAM_SUB_BUCKETS;
+using constants::Profiler::TRACE_CAPACITY;
+
+namespace {
+
+  constexpr uint32_t Log2(uint32_t value) {
+    uint32_t result = 0u;
+    while (value > 1u) {
+      value >>= 1u;
+      ++result;
+    }
+    return result;
+  }
+
+  constexpr uint32_t SUB_BUCKET_BITS = Log2(HISTOGRAM_SUB_BUCKETS);
+
+  static_assert((1u << SUB_BUCKET_BITS) == HISTOGRAM_SUB_BUCKETS,
+      "The number of sub-buckets must be a power of two");
+
+  double ToMilliseconds(uint64_t nanoseconds) {
+    return static_cast<double>(nanoseconds) * 1e-6;
+  }
+
+  double ToMicroseconds(uint64_t nanoseconds) {
+    return static_cast<double>(nanoseconds) * 1e-3;
+  }
+
+} // namespace
+
+StageProfiler::StageProfiler()
+  : _epoch(Clock::now()),
+    _cycle_begin(_epoch),
+    _trace(TRACE_CAPACITY) {
+  Reset();
+}
+
+const char *StageProfiler::GetStageName(TMStage stage) {
+  switch (stage) {
+    case TMStage::ALSM:         return "ALSM";
+    case TMStage::Localization: return "Localization";
+    case TMStage::Collision:    return "Collision";
+    case TMStage::TrafficLight: return "TrafficLight";
+    case TMStage::MotionPlan:   return "MotionPlan";
+    case TMStage::VehicleLight: return "VehicleLight";
+    case TMStage::ApplyBatch:   return "ApplyBatch";
+    case TMStage::Cycle:        return "Cycle";
+    default:                    return "Unknown";
+  }
+}
+
+std::size_t StageProfiler::GetBucket(uint64_t duration_ns) {
+  if (duration_ns < HISTOGRAM_SUB_BUCKETS) {
+    return static_cast<std::size_t>(duration_ns);
+  }
+  uint32_t octave = 0u;
+  for (uint64_t value = duration_ns; value > 1u; value >>= 1u) {
+    ++octave;
+  }
+  const std::size_t bucket =
+      (octave - SUB_BUCKET_BITS + 1u) * HISTOGRAM_SUB_BUCKETS +
+      static_cast<std::size_t>((duration_ns >> (octave - SUB_BUCKET_BITS)) - HISTOGRAM_SUB_BUCKETS);
+  return std::min(bucket, NUMBER_OF_BUCKETS - 1u);
+}
+
+uint64_t StageProfiler::GetBucketValue(std::size_t bucket) {
+  if (bucket < HISTOGRAM_SUB_BUCKETS) {
+    return bucket;
+  }
+  const uint32_t shift = static_cast<uint32_t>(bucket / HISTOGRAM_SUB_BUCKETS) - 1u;
+  const uint64_t sub_bucket = bucket % HISTOGRAM_SUB_BUCKETS;
+  const uint64_t lower_bound = (HISTOGRAM_SUB_BUCKETS + sub_bucket) << shift;
+  return lower_bound + ((uint64_t(1u) << shift) >> 1u);
+}
+
+double StageProfiler::GetPercentile(const StageStatistics &statistics, double percentile) {
+  if (statistics.cycles == 0u) {
+    return 0.0;
+  }
+  const uint64_t rank = std::max<uint64_t>(1u,
+      static_cast<uint64_t>(std::ceil(percentile * static_cast<double>(statistics.cycles))));
+  uint64_t count = 0u;
+  for (std::size_t bucket = 0u; bucket < NUMBER_OF_BUCKETS; ++bucket) {
+    count += statistics.histogram[bucket];
+    if (count >= rank) {
+      return ToMilliseconds(std::min(GetBucketValue(bucket), statistics.max_ns));
+    }
+  }
+  return ToMilliseconds(statistics.max_ns);
+}
+
+void StageProfiler::BeginCycle() {
+  _current = CycleRecord();
+  _cycle_begin = Clock::now();
+}
+
+void StageProfiler::EndCycle(std::size_t number_of_vehicles) {
+  Add(TMStage::Cycle, _cycle_begin, Clock::now());
+  _current.vehicles = static_cast<uint32_t>(number_of_vehicles);
+
+  std::lock_guard<std::mutex> lock(_mutex);
+  for (std::size_t i = 0u; i < NUMBER_OF_STAGES; ++i) {
+    const uint64_t duration_ns = _current.stages[i].duration_ns;
+    StageStatistics &statistics = _statistics[i];
+    ++statistics.histogram[GetBucket(duration_ns)];
+    ++statistics.cycles;
+    statistics.total_ns += duration_ns;
+    statistics.max_ns = std::max(statistics.max_ns, duration_ns);
+    statistics.last_ns = duration_ns;
+    statistics.last_vehicles = _current.vehicles;
+    statistics.max_vehicles = std::max(statistics.max_vehicles, _current.vehicles);
+  }
+  _trace[(_trace_head + _trace_size) % _trace.size()] = _current;
+  if (_trace_size < _trace.size()) {
+    ++_trace_size;
+  } else {
+    _trace_head = (_trace_head + 1u) % _trace.size();
+  }
+}
+
+std::vector<StageProfile> StageProfiler::GetProfile() const {
+  std::vector<StageProfile> profile(NUMBER_OF_STAGES);
+  std::lock_guard<std::mutex> lock(_mutex);
+  for (std::size_t i = 0u; i < NUMBER_OF_STAGES; ++i) {
+    const StageStatistics &statistics = _statistics[i];
+    StageProfile &stage = profile[i];
+    stage.name = GetStageName(static_cast<TMStage>(i));
+    stage.cycles = statistics.cycles;
+    if (statistics.cycles > 0u) {
+      stage.mean_ms = ToMilliseconds(statistics.total_ns) / static_cast<double>(statistics.cycles);
+    }
+    stage.p50_ms = GetPercentile(statistics, 0.50);
+    stage.p99_ms = GetPercentile(statistics, 0.99);
+    stage.max_ms = ToMilliseconds(statistics.max_ns);
+    stage.last_ms = ToMilliseconds(statistics.last_ns);
+    stage.last_vehicles = statistics.last_vehicles;
+    stage.max_vehicles = statistics.max_vehicles;
+  }
+  return profile;
+}
+
+void StageProfiler::Reset() {
+  std::lock_guard<std::mutex> lock(_mutex);
+  for (StageStatistics &statistics : _statistics) {
+    statistics = StageStatistics();
+    statistics.histogram.fill(0u);
+  }
+  _trace_head = 0u;
+  _trace_size = 0u;
+}
+
+std::string StageProfiler::GetChromeTrace() const {
+  std::string trace = "{\"traceEvents\":[";
+  char event[256];
+  bool first = true;
+  auto append = [&](int length) {
+    if (length > 0) {
+      if (!first) {
+        trace += ',';
+      }
+      trace.append(event, std::min<std::size_t>(static_cast<std::size_t>(length), sizeof(event) - 1u));
+      first = false;
+    }
+  };
+
+  // Name the track of every stage.
+  for (std::size_t i = 0u; i < NUMBER_OF_STAGES; ++i) {
+    append(std::snprintf(event, sizeof(event),
+        "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":%u,\"args\":{\"name\":\"%s\"}}",
+        static_cast<unsigned>(i), GetStageName(static_cast<TMStage>(i))));
+  }
+
+  std::lock_guard<std::mutex> lock(_mutex);
+  trace.reserve(trace.size() + _trace_size * NUMBER_OF_STAGES * 128u);
+  for (std::size_t n = 0u; n < _trace_size; ++n) {
+    const CycleRecord &cycle = _trace[(_trace_head + n) % _trace.size()];
+    for (std::size_t i = 0u; i < NUMBER_OF_STAGES; ++i) {
+      const CycleRecord::Interval &interval = cycle.stages[i];
+      if (interval.duration_ns == 0u) {
+        continue;
+      }
+      append(std::snprintf(event, sizeof(event),
+          "{\"name\":\"%s\",\"cat\":\"tm\",\"ph\":\"X\",\"pid\":0,\"tid\":%u,"
+          "\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"vehicles\":%u}}",
+          GetStageName(static_cast<TMStage>(i)), static_cast<unsigned>(i),
+          ToMicroseconds(interval.begin_ns), ToMicroseconds(interval.duration_ns),
+          cycle.vehicles));
+    }
+  }
+  trace += "],\"displayTimeUnit\":\"ms\"}";
+  return trace;
+}
+
+} // namespace traffic_manager
+} // namespace carla
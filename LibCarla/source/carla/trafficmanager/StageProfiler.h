@@ -0,0 +1,170 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "carla/MsgPack.h"
+
+#include "carla/trafficmanager/Constants.h"
+
+namespace carla {
+namespace traffic_manager {
+
+/// Steps of a traffic manager cycle measured by the StageProfiler.
+enum class TMStage : uint8_t {
+  ALSM,
+  Localization,
+  Collision,
+  TrafficLight,
+  MotionPlan,
+  VehicleLight,
+  ApplyBatch,
+  /// The whole cycle, from the start of ALSM to the end of ApplyBatch.
+  Cycle,
+  SIZE
+};
+
+/// Summary of the measurements of a stage since the last reset.
+struct StageProfile {
+  std::string name;
+  /// Number of cycles measured.
+  uint64_t cycles = 0u;
+  double mean_ms = 0.0;
+  double p50_ms = 0.0;
+  double p99_ms = 0.0;
+  double max_ms = 0.0;
+  /// Duration in the last cycle.
+  double last_ms = 0.0;
+  /// Number of registered vehicles in the last cycle.
+  uint32_t last_vehicles = 0u;
+  /// Maximum number of registered vehicles in a cycle.
+  uint32_t max_vehicles = 0u;
+
+  MSGPACK_DEFINE_ARRAY(name, cycles, mean_ms, p50_ms, p99_ms, max_ms, last_ms, last_vehicles, max_vehicles);
+};
+
+/// Always-on instrumentation of the traffic manager stages. The traffic
+/// manager thread measures each stage with steady_clock into the current
+/// cycle record; at the end of the cycle the record is merged into
+/// preallocated per-stage histograms and a ring of the latest cycles, which
+/// are read by other threads.
+class StageProfiler {
+public:
+
+  using Clock = std::chrono::steady_clock;
+
+  StageProfiler();
+
+  static Clock::time_point Now() {
+    return Clock::now();
+  }
+
+  /// Starts the measurements of a new cycle.
+  void BeginCycle();
+
+  /// Adds the interval between @a begin and @a end to the duration of
+  /// @a stage in the current cycle. A stage measured several times per cycle
+  /// accumulates its durations.
+  void Add(TMStage stage, Clock::time_point begin, Clock::time_point end) {
+    Add(stage, begin, end - begin);
+  }
+
+  /// Adds @a duration, measured from @a begin, to the duration of @a stage in
+  /// the current cycle. Stages interleaved per vehicle add up their durations
+  /// over all the vehicles and record the sum once.
+  void Add(TMStage stage, Clock::time_point begin, Clock::duration duration) {
+    CycleRecord::Interval &interval = _current.stages[static_cast<std::size_t>(stage)];
+    if (interval.duration_ns == 0u) {
+      interval.begin_ns = ToNanoseconds(begin - _epoch);
+    }
+    interval.duration_ns += ToNanoseconds(duration);
+  }
+
+  /// Ends the current cycle and publishes its measurements.
+  void EndCycle(std::size_t number_of_vehicles);
+
+  /// Summary of every stage, in the order of TMStage.
+  std::vector<StageProfile> GetProfile() const;
+
+  /// Discards all the measurements.
+  void Reset();
+
+  /// The latest cycles in Chrome trace event format, one track per stage.
+  std::string GetChromeTrace() const;
+
+  static const char *GetStageName(TMStage stage);
+
+private:
+
+  static constexpr std::size_t NUMBER_OF_STAGES = static_cast<std::size_t>(TMStage::SIZE);
+
+  static constexpr std::size_t NUMBER_OF_BUCKETS =
+      constants::Profiler::HISTOGRAM_SUB_BUCKETS * (constants::Profiler::HISTOGRAM_OCTAVES + 1u);
+
+  static uint64_t ToNanoseconds(Clock::duration duration) {
+    const auto count = std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+    return count > 0 ? static_cast<uint64_t>(count) : 0u;
+  }
+
+  /// Log-linear bucket of a duration: exact below HISTOGRAM_SUB_BUCKETS
+  /// nanoseconds, then HISTOGRAM_SUB_BUCKETS linear buckets per power of two.
+  static std::size_t GetBucket(uint64_t duration_ns);
+
+  /// Middle of the range of durations that fall in a bucket.
+  static uint64_t GetBucketValue(std::size_t bucket);
+
+  struct CycleRecord {
+    struct Interval {
+      /// Start of the first measurement, relative to the profiler creation.
+      uint64_t begin_ns = 0u;
+      uint64_t duration_ns = 0u;
+    };
+    std::array<Interval, NUMBER_OF_STAGES> stages;
+    uint32_t vehicles = 0u;
+  };
+
+  struct StageStatistics {
+    std::array<uint64_t, NUMBER_OF_BUCKETS> histogram;
+    uint64_t cycles = 0u;
+    uint64_t total_ns = 0u;
+    uint64_t max_ns = 0u;
+    uint64_t last_ns = 0u;
+    uint32_t last_vehicles = 0u;
+    uint32_t max_vehicles = 0u;
+  };
+
+  /// Duration, in milliseconds, of the given percentile of a histogram.
+  static double GetPercentile(const StageStatistics &statistics, double percentile);
+
+  const Clock::time_point _epoch;
+
+  /// Cycle being measured, only accessed by the traffic manager thread.
+  CycleRecord _current;
+
+  Clock::time_point _cycle_begin;
+
+  /// Guards everything below.
+  mutable std::mutex _mutex;
+
+  std::array<StageStatistics, NUMBER_OF_STAGES> _statistics;
+
+  /// Ring of the latest cycles.
+  std::vector<CycleRecord> _trace;
+
+  std::size_t _trace_head = 0u;
+
+  std::size_t _trace_size = 0u;
+};
+
+} // namespace traffic_manager
+} // namespace carla
@@ -0,0 +1,104 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/trafficmanager/StageSequence.h"
+
+namespace carla {
+namespace traffic_manager {
+
+StageSequence::StageSequence(const std::vector<ActorId> &vehicle_id_list,
+                             const SimulationState &simulation_state,
+                             ControlFrame &control_frame,
+                             LocalizationStage &localization_stage,
+                             CollisionStage &collision_stage,
+                             TrafficLightStage &traffic_light_stage,
+                             MotionPlanStage &motion_plan_stage,
+                             VehicleLightStage &vehicle_light_stage,
+                             TickScheduler &tick_scheduler,
+                             StageProfiler &profiler)
+  : vehicle_id_list(vehicle_id_list),
+    simulation_state(simulation_state),
+    control_frame(control_frame),
+    localization_stage(localization_stage),
+    collision_stage(collision_stage),
+    traffic_light_stage(traffic_light_stage),
+    motion_plan_stage(motion_plan_stage),
+    vehicle_light_stage(vehicle_light_stage),
+    tick_scheduler(tick_scheduler),
+    profiler(profiler) {}
+
+void StageSequence::Update(const std::vector<unsigned long> &scheduled_vehicles,
+                           const std::vector<unsigned long> &skipped_vehicles,
+                           const bool store_commands,
+                           ThreadPool *pool,
+                           const std::size_t pool_size,
+                           rpc::VehicleLightStateList light_states,
+                           const rpc::WeatherParameters &weather) {
+  const unsigned long number_of_vehicles = vehicle_id_list.size();
+  StageProfiler::Clock::time_point stage_begin = StageProfiler::Now();
+  for (unsigned long index = 0u; index < number_of_vehicles; ++index) {
+    localization_stage.Update(index);
+  }
+  StageProfiler::Clock::time_point stage_end = StageProfiler::Now();
+  profiler.Add(TMStage::Localization, stage_begin, stage_end);
+  stage_begin = stage_end;
+  if (pool != nullptr) {
+    // Collision checks only read the state left by localization, so they are
+    // sharded across the pool. Localization, traffic light and motion
+    // planning update shared tracking structures in vehicle order and stay serial.
+    collision_stage.PrepareParallelUpdate(pool_size);
+    pool->ParallelForChunks(scheduled_vehicles.size(), [&](const size_t position, const size_t chunk) {
+      collision_stage.ParallelUpdate(scheduled_vehicles[position], chunk);
+    });
+    collision_stage.FinishParallelUpdate();
+  } else {
+    for (const unsigned long index : scheduled_vehicles) {
+      collision_stage.Update(index);
+    }
+  }
+  collision_stage.ClearCycleCache();
+  stage_end = StageProfiler::Now();
+  profiler.Add(TMStage::Collision, stage_begin, stage_end);
+  stage_begin = stage_end;
+  vehicle_light_stage.UpdateWorldInfo(std::move(light_states), weather);
+  // Traffic light, motion planning and vehicle light stages run one vehicle
+  // at a time, as they draw from the same random device in this order.
+  // Their durations are added up over the vehicles.
+  const StageProfiler::Clock::time_point vehicle_loop_begin = StageProfiler::Now();
+  StageProfiler::Clock::duration traffic_light_duration{0};
+  StageProfiler::Clock::duration motion_plan_duration{0};
+  StageProfiler::Clock::duration vehicle_light_duration = vehicle_loop_begin - stage_begin;
+  stage_end = vehicle_loop_begin;
+  for (const unsigned long index : scheduled_vehicles) {
+    stage_begin = stage_end;
+    traffic_light_stage.Update(index);
+    stage_end = StageProfiler::Now();
+    traffic_light_duration += stage_end - stage_begin;
+    stage_begin = stage_end;
+    motion_plan_stage.Update(index);
+    if (store_commands) {
+      const ActorId actor_id = vehicle_id_list[index];
+      tick_scheduler.StoreCommand(actor_id, control_frame[index], simulation_state.GetLocation(actor_id));
+    }
+    stage_end = StageProfiler::Now();
+    motion_plan_duration += stage_end - stage_begin;
+    stage_begin = stage_end;
+    vehicle_light_stage.Update(index);
+    stage_end = StageProfiler::Now();
+    vehicle_light_duration += stage_end - stage_begin;
+  }
+  profiler.Add(TMStage::TrafficLight, vehicle_loop_begin, traffic_light_duration);
+  profiler.Add(TMStage::MotionPlan, vehicle_loop_begin, motion_plan_duration);
+  profiler.Add(TMStage::VehicleLight, vehicle_loop_begin, vehicle_light_duration);
+  // Vehicles not updated in this cycle keep following their last command.
+  for (const unsigned long index : skipped_vehicles) {
+    const ActorId actor_id = vehicle_id_list[index];
+    control_frame[index] = tick_scheduler.ExtrapolateCommand(actor_id, simulation_state.GetLocation(actor_id));
+  }
+}
+
+} // namespace traffic_manager
+} // namespace carla
@@ -0,0 +1,74 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include <vector>
+
+#include "carla/ThreadPool.h"
+#include "carla/rpc/VehicleLightStateList.h"
+#include "carla/rpc/WeatherParameters.h"
+
+#include "carla/trafficmanager/CollisionStage.h"
+#include "carla/trafficmanager/DataStructures.h"
+#include "carla/trafficmanager/LocalizationStage.h"
+#include "carla/trafficmanager/MotionPlanStage.h"
+#include "carla/trafficmanager/SimulationState.h"
+#include "carla/trafficmanager/StageProfiler.h"
+#include "carla/trafficmanager/TickScheduler.h"
+#include "carla/trafficmanager/TrafficLightStage.h"
+#include "carla/trafficmanager/VehicleLightStage.h"
+
+namespace carla {
+namespace traffic_manager {
+
+/// Runs the per-vehicle stages of a traffic manager cycle in their order,
+/// measuring each of them with the StageProfiler. The inter-stage frames must
+/// be sized for the current vehicles before each update; the actor life cycle
+/// management and the application of the commands are left to the caller.
+class StageSequence {
+private:
+  const std::vector<ActorId> &vehicle_id_list;
+  const SimulationState &simulation_state;
+  ControlFrame &control_frame;
+  LocalizationStage &localization_stage;
+  CollisionStage &collision_stage;
+  TrafficLightStage &traffic_light_stage;
+  MotionPlanStage &motion_plan_stage;
+  VehicleLightStage &vehicle_light_stage;
+  TickScheduler &tick_scheduler;
+  StageProfiler &profiler;
+
+public:
+  StageSequence(const std::vector<ActorId> &vehicle_id_list,
+                const SimulationState &simulation_state,
+                ControlFrame &control_frame,
+                LocalizationStage &localization_stage,
+                CollisionStage &collision_stage,
+                TrafficLightStage &traffic_light_stage,
+                MotionPlanStage &motion_plan_stage,
+                VehicleLightStage &vehicle_light_stage,
+                TickScheduler &tick_scheduler,
+                StageProfiler &profiler);
+
+  /// Runs the stages for the current cycle. Every vehicle is localized, so
+  /// that the buffers and the traffic tracking of the skipped ones stay
+  /// current for the vehicles around them; only the vehicles in
+  /// @a scheduled_vehicles are planned, the commands of the ones in
+  /// @a skipped_vehicles are extrapolated. Planned commands are stored in the
+  /// tick scheduler if @a store_commands is set. The collision stage is
+  /// sharded across @a pool, running @a pool_size threads, unless it is null.
+  void Update(const std::vector<unsigned long> &scheduled_vehicles,
+              const std::vector<unsigned long> &skipped_vehicles,
+              bool store_commands,
+              ThreadPool *pool,
+              std::size_t pool_size,
+              rpc::VehicleLightStateList light_states,
+              const rpc::WeatherParameters &weather);
+};
+
+} // namespace traffic_manager
+} // namespace carla
@@ -0,0 +1,111 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/trafficmanager/TickScheduler.h"
+
+#include <algorithm>
+#include <limits>
+#include <unordered_set>
+
+#include "carla/geom/Math.h"
+
+#include "carla/trafficmanager/Constants.h"
+
+namespace carla {
+namespace traffic_manager {
+
+using ApplyTransform = carla::rpc::Command::ApplyTransform;
+using constants::TickLOD::MAX_EXTRAPOLATED_DISPLACEMENT;
+
+void TickScheduler::Schedule(const std::vector<ActorId> &vehicle_id_list,
+                             const SimulationState &simulation_state,
+                             const std::vector<cg::Location> &reference_locations,
+                             const std::vector<TickLODBand> &bands,
+                             std::vector<unsigned long> &scheduled,
+                             std::vector<unsigned long> &skipped) {
+  ++cycle;
+  scheduled.clear();
+  skipped.clear();
+  const unsigned long number_of_vehicles = vehicle_id_list.size();
+  if (bands.empty() || reference_locations.empty()) {
+    for (unsigned long index = 0u; index < number_of_vehicles; ++index) {
+      scheduled.push_back(index);
+    }
+    return;
+  }
+
+  for (unsigned long index = 0u; index < number_of_vehicles; ++index) {
+    const ActorId actor_id = vehicle_id_list[index];
+    uint64_t period = 1u;
+    // Vehicles without a planned command have to be updated.
+    const std::size_t slot = simulation_state.FindSlot(actor_id);
+    if (slot < simulation_state.Size() && last_commands.find(actor_id) != last_commands.end()) {
+      const cg::Location &location = simulation_state.GetLocationAt(slot);
+      float min_distance_squared = std::numeric_limits<float>::max();
+      for (const cg::Location &reference : reference_locations) {
+        min_distance_squared = std::min(min_distance_squared, cg::Math::DistanceSquared(location, reference));
+      }
+      for (const TickLODBand &band : bands) {
+        if (min_distance_squared < SQUARE(band.distance)) {
+          break;
+        }
+        period = band.period;
+      }
+    }
+    if ((cycle + actor_id) % period == 0u) {
+      scheduled.push_back(index);
+    } else {
+      skipped.push_back(index);
+    }
+  }
+}
+
+void TickScheduler::StoreCommand(const ActorId actor_id,
+                                 const carla::rpc::Command &command,
+                                 const cg::Location &vehicle_location) {
+  LastCommand &last_command = last_commands[actor_id];
+  last_command.command = command;
+  const auto *transform_command = boost::variant2::get_if<ApplyTransform>(&command.command);
+  last_command.displacement = cg::Vector3D();
+  if (transform_command != nullptr) {
+    const cg::Vector3D displacement = transform_command->transform.location - vehicle_location;
+    // Respawns of dormant vehicles jump far away and are not repeated.
+    if (displacement.SquaredLength() < SQUARE(MAX_EXTRAPOLATED_DISPLACEMENT)) {
+      last_command.displacement = displacement;
+    }
+  }
+}
+
+carla::rpc::Command TickScheduler::ExtrapolateCommand(const ActorId actor_id,
+                                                      const cg::Location &vehicle_location) const {
+  const LastCommand &last_command = last_commands.at(actor_id);
+  const auto *transform_command = boost::variant2::get_if<ApplyTransform>(&last_command.command.command);
+  if (transform_command == nullptr) {
+    return last_command.command;
+  }
+  cg::Transform transform = transform_command->transform;
+  transform.location = vehicle_location + cg::Location(last_command.displacement);
+  return ApplyTransform(actor_id, transform);
+}
+
+void TickScheduler::Retain(const std::vector<ActorId> &vehicle_id_list) {
+  const std::unordered_set<ActorId> vehicles(vehicle_id_list.begin(), vehicle_id_list.end());
+  for (auto it = last_commands.begin(); it != last_commands.end();) {
+    if (vehicles.find(it->first) == vehicles.end()) {
+      it = last_commands.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+void TickScheduler::Reset() {
+  cycle = 0u;
+  last_commands.clear();
+}
+
+} // namespace traffic_manager
+} // namespace carla
@@ -0,0 +1,74 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "carla/geom/Location.h"
+#include "carla/rpc/Command.h"
+
+#include "carla/trafficmanager/ParameterSnapshot.h"
+#include "carla/trafficmanager/SimulationState.h"
+
+namespace carla {
+namespace traffic_manager {
+
+namespace cg = carla::geom;
+
+/// Level of detail scheduling of the vehicle updates. Vehicles far from every
+/// hero vehicle are localized every cycle but run through the planning stages
+/// only once every few cycles, according to the distance bands set in the
+/// Parameters. Vehicles sharing a period are
+/// spread over the cycles by their id, so that the cost of a band is evenly
+/// distributed. In the cycles a vehicle is not updated, its last command is
+/// extrapolated: vehicle controls are applied again and teleports keep the
+/// displacement of the last planned one.
+class TickScheduler {
+public:
+
+  /// Splits the indices of @a vehicle_id_list into the vehicles to update in
+  /// this cycle and the vehicles whose last command is extrapolated. With no
+  /// bands or no reference locations every vehicle is updated.
+  void Schedule(const std::vector<ActorId> &vehicle_id_list,
+                const SimulationState &simulation_state,
+                const std::vector<cg::Location> &reference_locations,
+                const std::vector<TickLODBand> &bands,
+                std::vector<unsigned long> &scheduled,
+                std::vector<unsigned long> &skipped);
+
+  /// Stores the command planned for an updated vehicle.
+  void StoreCommand(const ActorId actor_id,
+                    const carla::rpc::Command &command,
+                    const cg::Location &vehicle_location);
+
+  /// Command for a vehicle not updated in this cycle. Only valid for the
+  /// vehicles returned as skipped by the last call to Schedule.
+  carla::rpc::Command ExtrapolateCommand(const ActorId actor_id, const cg::Location &vehicle_location) const;
+
+  /// Drops the commands of the vehicles not in @a vehicle_id_list.
+  void Retain(const std::vector<ActorId> &vehicle_id_list);
+
+  void Reset();
+
+private:
+
+  struct LastCommand {
+    carla::rpc::Command command;
+    /// Displacement of the last teleport with respect to the vehicle location
+    /// at the time it was planned.
+    cg::Vector3D displacement;
+  };
+
+  uint64_t cycle = 0u;
+
+  std::unordered_map<ActorId, LastCommand> last_commands;
+};
+
+} // namespace traffic_manager
+} // namespace carla
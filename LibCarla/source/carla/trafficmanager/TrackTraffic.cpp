@@ -1,4 +1,7 @@
 
+#include <algorithm>
+#include <limits>
+
 #include "carla/trafficmanager/Constants.h"
 
 #include "carla/trafficmanager/TrackTraffic.h"
@@ -11,81 +14,151 @@ using constants::TrackTraffic::INV_BUFFER_STEP_THROUGH;
 
 TrackTraffic::TrackTraffic() {}
 
-void TrackTraffic::UpdateUnregisteredGridPosition(const ActorId actor_id,
-                                                  const std::vector<SimpleWaypointPtr> waypoints) {
+namespace {
 
-    DeleteActor(actor_id);
+  static const uint32_t EMPTY_GRID_CELL = std::numeric_limits<uint32_t>::max();
+  static const std::size_t INITIAL_GRID_TABLE_SIZE = 1024u;
 
-    std::unordered_set<GeoGridId> current_grids;
-    // Step through waypoints and update grid list for actor and actor list for grids.
-    for (auto &waypoint : waypoints) {
-        UpdatePassingVehicle(waypoint->GetId(), actor_id);
+  inline std::size_t HashGridId(const GeoGridId grid_id) {
+    // Fibonacci hashing, the table size is always a power of two.
+    const uint32_t hash = static_cast<uint32_t>(grid_id) * 2654435769u;
+    return static_cast<std::size_t>(hash ^ (hash >> 16u));
+  }
+
+} // namespace
+
+uint32_t TrackTraffic::FindGridCell(const GeoGridId grid_id) const {
+    if (grid_table.empty()) {
+        return EMPTY_GRID_CELL;
+    }
+    const std::size_t mask = grid_table.size() - 1u;
+    for (std::size_t i = HashGridId(grid_id) & mask; ; i = (i + 1u) & mask) {
+        const GridTableEntry &entry = grid_table[i];
+        if (entry.cell == EMPTY_GRID_CELL || entry.grid_id == grid_id) {
+            return entry.cell;
+        }
+    }
+}
 
-        GeoGridId ggid = waypoint->GetGeodesicGridId();
-        current_grids.insert(ggid);
+uint32_t TrackTraffic::FindOrAddGridCell(const GeoGridId grid_id) {
+    // Keep the load factor of the table below one half.
+    if (2u * (grid_cells.size() + 1u) > grid_table.size()) {
+        GrowGridTable();
+    }
+    const std::size_t mask = grid_table.size() - 1u;
+    std::size_t i = HashGridId(grid_id) & mask;
+    while (grid_table[i].cell != EMPTY_GRID_CELL) {
+        if (grid_table[i].grid_id == grid_id) {
+            return grid_table[i].cell;
+        }
+        i = (i + 1u) & mask;
+    }
+    const uint32_t cell = static_cast<uint32_t>(grid_cells.size());
+    grid_table[i] = GridTableEntry{grid_id, cell};
+    grid_cells.emplace_back();
+    return cell;
+}
 
-        if (grid_to_actors.find(ggid) != grid_to_actors.end()) {
-            ActorIdSet &actor_ids = grid_to_actors.at(ggid);
-            if (actor_ids.find(actor_id) == actor_ids.end()) {
-                actor_ids.insert(actor_id);
+void TrackTraffic::GrowGridTable() {
+    const std::size_t new_size = grid_table.empty() ? INITIAL_GRID_TABLE_SIZE : 2u * grid_table.size();
+    std::vector<GridTableEntry> old_table(new_size, GridTableEntry{0, EMPTY_GRID_CELL});
+    old_table.swap(grid_table);
+    const std::size_t mask = new_size - 1u;
+    for (const GridTableEntry &entry : old_table) {
+        if (entry.cell != EMPTY_GRID_CELL) {
+            std::size_t i = HashGridId(entry.grid_id) & mask;
+            while (grid_table[i].cell != EMPTY_GRID_CELL) {
+                i = (i + 1u) & mask;
             }
+            grid_table[i] = entry;
+        }
+    }
+}
+
+void TrackTraffic::AddToGrid(const GeoGridId grid_id, const ActorId actor_id) {
+    ActorIdList &actor_ids = grid_cells[FindOrAddGridCell(grid_id)];
+    if (std::find(actor_ids.begin(), actor_ids.end(), actor_id) == actor_ids.end()) {
+        actor_ids.push_back(actor_id);
+    }
+}
+
+void TrackTraffic::RemoveFromGrid(const GeoGridId grid_id, const ActorId actor_id) {
+    const uint32_t cell = FindGridCell(grid_id);
+    if (cell != EMPTY_GRID_CELL) {
+        ActorIdList &actor_ids = grid_cells[cell];
+        auto it = std::find(actor_ids.begin(), actor_ids.end(), actor_id);
+        if (it != actor_ids.end()) {
+            *it = actor_ids.back();
+            actor_ids.pop_back();
+        }
+    }
+}
+
+void TrackTraffic::UpdateActorGrids(const ActorId actor_id) {
+    std::sort(grid_scratch.begin(), grid_scratch.end());
+    grid_scratch.erase(std::unique(grid_scratch.begin(), grid_scratch.end()), grid_scratch.end());
+
+    // Both lists are sorted, step through them together to find the grids
+    // the actor left and the grids the actor entered.
+    GeoGridIdList &current_grids = actor_to_grids[actor_id];
+    auto current = current_grids.begin();
+    auto next = grid_scratch.begin();
+    while (current != current_grids.end() || next != grid_scratch.end()) {
+        if (next == grid_scratch.end() || (current != current_grids.end() && *current < *next)) {
+            RemoveFromGrid(*current, actor_id);
+            ++current;
+        } else if (current == current_grids.end() || *next < *current) {
+            AddToGrid(*next, actor_id);
+            ++next;
         } else {
-            grid_to_actors.insert({ggid, {actor_id}});
+            ++current;
+            ++next;
         }
     }
 
-    actor_to_grids.insert({actor_id, current_grids});
+    // The previous list becomes the scratch list of the next update.
+    current_grids.swap(grid_scratch);
 }
 
-void TrackTraffic::UpdateGridPosition(const ActorId actor_id, const Buffer &buffer) {
-    if (!buffer.empty()) {
+void TrackTraffic::UpdateUnregisteredGridPosition(const ActorId actor_id,
+                                                  const std::vector<SimpleWaypointPtr> &waypoints) {
 
-        // Clear current actor from all grids containing itself.
-        if (actor_to_grids.find(actor_id) != actor_to_grids.end()) {
-            std::unordered_set<GeoGridId> &current_grids = actor_to_grids.at(actor_id);
-            for (auto &grid_id : current_grids) {
-                if (grid_to_actors.find(grid_id) != grid_to_actors.end()) {
-                    ActorIdSet &actor_ids = grid_to_actors.at(grid_id);
-                    actor_ids.erase(actor_id);
-                }
-            }
+    DeleteActor(actor_id);
 
-            actor_to_grids.erase(actor_id);
-        }
+    // Step through waypoints and update grid list for actor and actor list for grids.
+    grid_scratch.clear();
+    for (auto &waypoint : waypoints) {
+        UpdatePassingVehicle(waypoint->GetId(), actor_id);
+        grid_scratch.push_back(waypoint->GetGeodesicGridId());
+    }
 
-        // Step through buffer and update grid list for actor and actor list for grids.
-        std::unordered_set<GeoGridId> current_grids;
-        uint64_t buffer_size = buffer.size();
-        for (uint64_t i = 0u; i <= buffer_size - 1u; ++i) {
-            auto waypoint = buffer.at(i);
-            GeoGridId ggid = waypoint->GetGeodesicGridId();
-            current_grids.insert(ggid);
-            // Add grid entry if not present.
-            if (grid_to_actors.find(ggid) == grid_to_actors.end()) {
-                grid_to_actors.insert({ggid, {}});
-            }
+    UpdateActorGrids(actor_id);
+}
 
-            ActorIdSet &actor_ids = grid_to_actors.at(ggid);
-            if (actor_ids.find(actor_id) == actor_ids.end()) {
-                actor_ids.insert(actor_id);
-            }
+void TrackTraffic::UpdateGridPosition(const ActorId actor_id, const Buffer &buffer) {
+    if (!buffer.empty()) {
+        // Step through buffer and update grid list for actor and actor list for grids.
+        grid_scratch.clear();
+        for (const SimpleWaypointPtr &waypoint : buffer) {
+            grid_scratch.push_back(waypoint->GetGeodesicGridId());
         }
 
-        actor_to_grids.insert({actor_id, current_grids});
+        UpdateActorGrids(actor_id);
     }
 }
 
 
 bool TrackTraffic::IsGeoGridFree(const GeoGridId geogrid_id) const {
-    if (grid_to_actors.find(geogrid_id) != grid_to_actors.end()) {
-        return grid_to_actors.at(geogrid_id).empty();
+    const uint32_t cell = FindGridCell(geogrid_id);
+    if (cell != EMPTY_GRID_CELL) {
+        return grid_cells[cell].empty();
     }
     return true;
 }
 
 void TrackTraffic::AddTakenGrid(const GeoGridId geogrid_id, const ActorId actor_id) {
-    if (grid_to_actors.find(geogrid_id) == grid_to_actors.end()) {
-        grid_to_actors.insert({geogrid_id, {actor_id}});
+    if (FindGridCell(geogrid_id) == EMPTY_GRID_CELL) {
+        grid_cells[FindOrAddGridCell(geogrid_id)].push_back(actor_id);
     }
 }
 
@@ -98,32 +171,32 @@ cg::Location TrackTraffic::GetHeroLocation() const {
     return hero_location;
 }
 
-ActorIdSet TrackTraffic::GetOverlappingVehicles(ActorId actor_id) const {
-    ActorIdSet actor_id_set;
-
-    if (actor_to_grids.find(actor_id) != actor_to_grids.end()) {
-        const std::unordered_set<GeoGridId> &grid_ids = actor_to_grids.at(actor_id);
-        for (auto &grid_id : grid_ids) {
-            if (grid_to_actors.find(grid_id) != grid_to_actors.end()) {
-                const ActorIdSet &actor_ids = grid_to_actors.at(grid_id);
-                actor_id_set.insert(actor_ids.begin(), actor_ids.end());
+void TrackTraffic::GetOverlappingVehicles(const ActorId actor_id,
+                                          ActorIdList &overlapping_vehicles) const {
+    overlapping_vehicles.clear();
+
+    auto grids = actor_to_grids.find(actor_id);
+    if (grids != actor_to_grids.end()) {
+        for (const GeoGridId grid_id : grids->second) {
+            const uint32_t cell = FindGridCell(grid_id);
+            if (cell != EMPTY_GRID_CELL) {
+                const ActorIdList &actor_ids = grid_cells[cell];
+                overlapping_vehicles.insert(overlapping_vehicles.end(), actor_ids.begin(), actor_ids.end());
             }
         }
+        std::sort(overlapping_vehicles.begin(), overlapping_vehicles.end());
+        overlapping_vehicles.erase(std::unique(overlapping_vehicles.begin(), overlapping_vehicles.end()),
+                                   overlapping_vehicles.end());
     }
-
-    return actor_id_set;
 }
 
 void TrackTraffic::DeleteActor(ActorId actor_id) {
-    if (actor_to_grids.find(actor_id) != actor_to_grids.end()) {
-        std::unordered_set<GeoGridId> &grid_ids = actor_to_grids.at(actor_id);
-        for (auto &grid_id : grid_ids) {
-            if (grid_to_actors.find(grid_id) != grid_to_actors.end()) {
-                ActorIdSet &actor_ids = grid_to_actors.at(grid_id);
-                actor_ids.erase(actor_id);
-                }
-            }
-        actor_to_grids.erase(actor_id);
+    auto grids = actor_to_grids.find(actor_id);
+    if (grids != actor_to_grids.end()) {
+        for (const GeoGridId grid_id : grids->second) {
+            RemoveFromGrid(grid_id, actor_id);
+        }
+        actor_to_grids.erase(grids);
     }
 
     if (waypoint_occupied.find(actor_id) != waypoint_occupied.end()) {
@@ -187,7 +260,8 @@ void TrackTraffic::Clear() {
     waypoint_overlap_tracker.clear();
     waypoint_occupied.clear();
     actor_to_grids.clear();
-    grid_to_actors.clear();
+    grid_table.clear();
+    grid_cells.clear();
 }
 
 } // namespace traffic_manager
@@ -1,18 +1,25 @@
 
 #pragma once
 
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
 #include "carla/road/RoadTypes.h"
 #include "carla/rpc/ActorId.h"
 
 #include "carla/trafficmanager/SimpleWaypoint.h"
+#include "carla/trafficmanager/WaypointBuffer.h"
 
 namespace carla {
 namespace traffic_manager {
 
 using ActorId = carla::ActorId;
 using ActorIdSet = std::unordered_set<ActorId>;
+using ActorIdList = std::vector<ActorId>;
 using SimpleWaypointPtr = std::shared_ptr<SimpleWaypoint>;
-using Buffer = std::deque<SimpleWaypointPtr>;
+using Buffer = WaypointBuffer;
 using GeoGridId = carla::road::JuncId;
 
 // This class is used to track the waypoint occupancy of all the actors.
@@ -28,10 +35,35 @@ private:
     using WaypointOccupancyMap = std::unordered_map<ActorId, WaypointIdSet>;
     WaypointOccupancyMap waypoint_occupied;
 
-    /// Geodesic grids occupied by actors's paths.
-    std::unordered_map<ActorId, std::unordered_set<GeoGridId>> actor_to_grids;
-    /// Actors currently passing through grids.
-    std::unordered_map<GeoGridId, ActorIdSet> grid_to_actors;
+    /// Geodesic grids occupied by actors's paths, sorted and without duplicates.
+    using GeoGridIdList = std::vector<GeoGridId>;
+    std::unordered_map<ActorId, GeoGridIdList> actor_to_grids;
+    /// Scratch list reused to collect the grids of a path on every update.
+    GeoGridIdList grid_scratch;
+
+    /// Flat, open addressed spatial hash of the geodesic grids. Every entry of
+    /// the table points to a cell holding the actors passing through the grid.
+    /// Cells are never released until Clear() so that updates only touch the
+    /// grids whose occupancy changed.
+    struct GridTableEntry {
+      GeoGridId grid_id;
+      uint32_t cell;
+    };
+    std::vector<GridTableEntry> grid_table;
+    /// Actors currently passing through grids, indexed by cell.
+    std::vector<ActorIdList> grid_cells;
+
+    /// Returns the cell of a grid, or EMPTY_GRID_CELL if the grid is not tracked.
+    uint32_t FindGridCell(const GeoGridId grid_id) const;
+    /// Returns the cell of a grid, creating it if not present.
+    uint32_t FindOrAddGridCell(const GeoGridId grid_id);
+    void GrowGridTable();
+
+    void AddToGrid(const GeoGridId grid_id, const ActorId actor_id);
+    void RemoveFromGrid(const GeoGridId grid_id, const ActorId actor_id);
+    /// Moves the actor to the grids in grid_scratch, touching only the grids
+    /// the actor enters or leaves.
+    void UpdateActorGrids(const ActorId actor_id);
     /// Current hero location.
     cg::Location hero_location = cg::Location(0,0,0);
 
@@ -46,9 +78,11 @@ public:
 
     void UpdateGridPosition(const ActorId actor_id, const Buffer &buffer);
     void UpdateUnregisteredGridPosition(const ActorId actor_id,
-                                        const std::vector<SimpleWaypointPtr> waypoints);
+                                        const std::vector<SimpleWaypointPtr> &waypoints);
 
-    ActorIdSet GetOverlappingVehicles(ActorId actor_id) const;
+    /// Writes the actors sharing a grid with the given actor's path, including
+    /// the actor itself, sorted by id into the caller provided buffer.
+    void GetOverlappingVehicles(const ActorId actor_id, ActorIdList &overlapping_vehicles) const;
     bool IsGeoGridFree(const GeoGridId geogrid_id) const;
     void AddTakenGrid(const GeoGridId geogrid_id, const ActorId actor_id);
 
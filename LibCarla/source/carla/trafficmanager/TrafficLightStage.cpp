@@ -17,14 +17,14 @@ TrafficLightStage::TrafficLightStage(
   const SimulationState &simulation_state,
   const BufferMap &buffer_map,
   const Parameters &parameters,
-  const cc::World &world,
+  const cc::Timestamp &current_timestamp,
   TLFrame &output_array,
   RandomGenerator &random_device)
   : vehicle_id_list(vehicle_id_list),
     simulation_state(simulation_state),
     buffer_map(buffer_map),
     parameters(parameters),
-    world(world),
+    current_timestamp(current_timestamp),
     output_array(output_array),
     random_device(random_device) {}
 
@@ -32,7 +32,8 @@ void TrafficLightStage::Update(const unsigned long index) {
   bool traffic_light_hazard = false;
 
   const ActorId ego_actor_id = vehicle_id_list.at(index);
-  if (!simulation_state.IsDormant(ego_actor_id)) {
+  const std::size_t ego_slot = simulation_state.GetSlot(ego_actor_id);
+  if (!simulation_state.IsDormantAt(ego_slot)) {
 
     JunctionID current_junction_id = -1;
     if (vehicle_last_junction.find(ego_actor_id) != vehicle_last_junction.end()) {
@@ -40,9 +41,7 @@ void TrafficLightStage::Update(const unsigned long index) {
     }
     auto affected_junction_id = GetAffectedJunctionId(ego_actor_id);
 
-    current_timestamp = world.GetSnapshot().GetTimestamp();
-
-    const TrafficLightState tl_state = simulation_state.GetTLS(ego_actor_id);
+    const TrafficLightState &tl_state = simulation_state.GetTLSAt(ego_slot);
     const TLS traffic_light_state = tl_state.tl_state;
     const bool is_at_traffic_light = tl_state.at_traffic_light;
 
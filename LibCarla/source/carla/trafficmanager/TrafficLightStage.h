@@ -18,7 +18,8 @@ private:
   const SimulationState &simulation_state;
   const BufferMap &buffer_map;
   const Parameters &parameters;
-  const cc::World &world;
+  /// Timestamp of the current cycle.
+  const cc::Timestamp &current_timestamp;
 
   /// Variables used to handle non signalized junctions
 
@@ -30,7 +31,6 @@ private:
   std::unordered_map<ActorId, cc::Timestamp> vehicle_stop_time;
   TLFrame &output_array;
   RandomGenerator &random_device;
-  cc::Timestamp current_timestamp;
 
   /// This controls all vehicle's interactions at non signalized junctions. Priorities are done by order of arrival
   /// and no two vehicle will enter the junction at the same time. Only once it is exiting can the next one enter.
@@ -49,7 +49,7 @@ public:
                     const SimulationState &Simulation_state,
                     const BufferMap &buffer_map,
                     const Parameters &parameters,
-                    const cc::World &world,
+                    const cc::Timestamp &current_timestamp,
                     TLFrame &output_array,
                     RandomGenerator &random_device);
 
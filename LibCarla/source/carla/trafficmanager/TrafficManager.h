@@ -65,6 +65,34 @@ public:
     }
   }
 
+  /// Method to set the number of threads the per-vehicle stages are sharded across.
+  /// Values lower than 2 run the stages serially.
+  void SetParallelStageThreads(const uint16_t num_threads) {
+    TrafficManagerBase* tm_ptr = GetTM(_port);
+    if (tm_ptr != nullptr) {
+      tm_ptr->SetParallelStageThreads(num_threads);
+    }
+  }
+
+  /// Method to set the tick level of detail mode, in which vehicles far from
+  /// every hero vehicle are updated less often.
+  void SetTickLODMode(const bool mode_switch) {
+    TrafficManagerBase* tm_ptr = GetTM(_port);
+    if (tm_ptr != nullptr) {
+      tm_ptr->SetTickLODMode(mode_switch);
+    }
+  }
+
+  /// Method to set the distance bands of the tick level of detail. Vehicles
+  /// farther than distances[i] from every hero vehicle are updated once every
+  /// periods[i] cycles.
+  void SetTickLODBands(const std::vector<float> &distances, const std::vector<uint16_t> &periods) {
+    TrafficManagerBase* tm_ptr = GetTM(_port);
+    if (tm_ptr != nullptr) {
+      tm_ptr->SetTickLODBands(distances, periods);
+    }
+  }
+
   /// Method to set our own imported path.
   void SetCustomPath(const ActorPtr &actor, const Path path, const bool empty_buffer) {
     TrafficManagerBase* tm_ptr = GetTM(_port);
@@ -375,6 +403,33 @@ public:
     return action_buffer;
   }
 
+  /// Method to get the execution time statistics of every stage.
+  std::vector<StageProfile> GetStageProfile() {
+    TrafficManagerBase* tm_ptr = GetTM(_port);
+    if (tm_ptr != nullptr) {
+      return tm_ptr->GetStageProfile();
+    }
+    return std::vector<StageProfile>();
+  }
+
+  /// Method to discard the execution time statistics of every stage.
+  void ResetStageProfile() {
+    TrafficManagerBase* tm_ptr = GetTM(_port);
+    if (tm_ptr != nullptr) {
+      tm_ptr->ResetStageProfile();
+    }
+  }
+
+  /// Method to get the latest cycles in Chrome trace event format, which can
+  /// be loaded in chrome://tracing or Perfetto.
+  std::string GetStageProfileTrace() {
+    TrafficManagerBase* tm_ptr = GetTM(_port);
+    if (tm_ptr != nullptr) {
+      return tm_ptr->GetStageProfileTrace();
+    }
+    return std::string();
+  }
+
 private:
 
   void CreateTrafficManagerServer(
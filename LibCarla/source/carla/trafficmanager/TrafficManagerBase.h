@@ -7,8 +7,10 @@
 #pragma once
 
 #include <memory>
+#include <string>
 #include "carla/client/Actor.h"
 #include "carla/trafficmanager/SimpleWaypoint.h"
+#include "carla/trafficmanager/StageProfiler.h"
 
 namespace carla {
 namespace traffic_manager {
@@ -134,6 +136,15 @@ public:
   /// Method to set Open Street Map mode.
   virtual void SetOSMMode(const bool mode_switch) = 0;
 
+  /// Method to set the number of threads the per-vehicle stages are sharded across.
+  virtual void SetParallelStageThreads(const uint16_t num_threads) = 0;
+
+  /// Method to set the tick level of detail mode.
+  virtual void SetTickLODMode(const bool mode_switch) = 0;
+
+  /// Method to set the distance bands of the tick level of detail.
+  virtual void SetTickLODBands(const std::vector<float> &distances, const std::vector<uint16_t> &periods) = 0;
+
   /// Method to set our own imported path.
   virtual void SetCustomPath(const ActorPtr &actor, const Path path, const bool empty_buffer) = 0;
 
@@ -167,6 +178,15 @@ public:
   /// Method to get the vehicle's action buffer.
   virtual ActionBuffer GetActionBuffer(const ActorId &actor_id) = 0;
 
+  /// Method to get the execution time statistics of every stage.
+  virtual std::vector<StageProfile> GetStageProfile() = 0;
+
+  /// Method to discard the execution time statistics of every stage.
+  virtual void ResetStageProfile() = 0;
+
+  /// Method to get the latest cycles in Chrome trace event format.
+  virtual std::string GetStageProfileTrace() = 0;
+
   virtual void ShutDown() = 0;
 
 protected:
@@ -7,6 +7,7 @@
 #pragma once
 
 #include "carla/trafficmanager/Constants.h"
+#include "carla/trafficmanager/StageProfiler.h"
 #include "carla/rpc/Actor.h"
 
 #include <rpc/client.h>
@@ -237,6 +238,24 @@ public:
     _client->call("set_osm_mode", mode_switch);
   }
 
+  /// Method to set the number of threads the stages are sharded across.
+  void SetParallelStageThreads(const uint16_t num_threads) {
+    DEBUG_ASSERT(_client != nullptr);
+    _client->call("set_parallel_stage_threads", num_threads);
+  }
+
+  /// Method to set the tick level of detail mode.
+  void SetTickLODMode(const bool mode_switch) {
+    DEBUG_ASSERT(_client != nullptr);
+    _client->call("set_tick_lod_mode", mode_switch);
+  }
+
+  /// Method to set the distance bands of the tick level of detail.
+  void SetTickLODBands(const std::vector<float> &distances, const std::vector<uint16_t> &periods) {
+    DEBUG_ASSERT(_client != nullptr);
+    _client->call("set_tick_lod_bands", distances, periods);
+  }
+
   /// Method to set our own imported path.
   void SetCustomPath(const carla::rpc::Actor &actor, const Path path, const bool empty_buffer) {
     DEBUG_ASSERT(_client != nullptr);
@@ -305,6 +324,24 @@ public:
     return ActionBuffer();
   }
 
+  /// Method to get the execution time statistics of every stage.
+  std::vector<StageProfile> GetStageProfile() {
+    DEBUG_ASSERT(_client != nullptr);
+    return _client->call("get_stage_profile").as<std::vector<StageProfile>>();
+  }
+
+  /// Method to discard the execution time statistics of every stage.
+  void ResetStageProfile() {
+    DEBUG_ASSERT(_client != nullptr);
+    _client->call("reset_stage_profile");
+  }
+
+  /// Method to get the latest cycles in Chrome trace event format.
+  std::string GetStageProfileTrace() {
+    DEBUG_ASSERT(_client != nullptr);
+    return _client->call("get_stage_profile_trace").as<std::string>();
+  }
+
   void ShutDown() {
     DEBUG_ASSERT(_client != nullptr);
     _client->call("shut_down");
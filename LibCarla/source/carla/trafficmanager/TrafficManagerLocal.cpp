@@ -9,7 +9,10 @@
 #include "carla/Logging.h"
 
 #include "carla/client/detail/Simulator.h"
+#include "carla/client/FileTransfer.h"
+#include "carla/client/TimeoutException.h"
 
+#include "carla/trafficmanager/InMemoryMapRegistry.h"
 #include "carla/trafficmanager/TrafficManagerLocal.h"
 
 namespace carla {
@@ -56,7 +59,7 @@ TrafficManagerLocal::TrafficManagerLocal(
                                           simulation_state,
                                           buffer_map,
                                           parameters,
-                                          world,
+                                          current_timestamp,
                                           tl_frame,
                                           random_device)),
 
@@ -72,7 +75,7 @@ TrafficManagerLocal::TrafficManagerLocal(
                                       localization_frame,
                                       collision_frame,
                                       tl_frame,
-                                      world,
+                                      current_timestamp,
                                       control_frame,
                                       random_device,
                                       local_map)),
@@ -80,7 +83,6 @@ TrafficManagerLocal::TrafficManagerLocal(
     vehicle_light_stage(VehicleLightStage(vehicle_id_list,
                                           buffer_map,
                                           parameters,
-                                          world,
                                           control_frame)),
 
     alsm(ALSM(registered_vehicles,
@@ -97,39 +99,71 @@ TrafficManagerLocal::TrafficManagerLocal(
               motion_plan_stage,
               vehicle_light_stage)),
 
+    stage_sequence(StageSequence(vehicle_id_list,
+                                 simulation_state,
+                                 control_frame,
+                                 localization_stage,
+                                 collision_stage,
+                                 traffic_light_stage,
+                                 motion_plan_stage,
+                                 vehicle_light_stage,
+                                 tick_scheduler,
+                                 profiler)),
+
     server(TrafficManagerServer(RPCportTM, static_cast<carla::traffic_manager::TrafficManagerBase *>(this))) {
 
   parameters.SetGlobalPercentageSpeedDifference(perc_difference_from_limit);
 
   registered_vehicles_state = -1;
 
+  // ALSM follows the actors spawned and destroyed every tick.
+  episode_proxy.Lock()->AddActorDeltaConsumer();
+
   SetupLocalMap();
 
   Start();
 }
 
 TrafficManagerLocal::~TrafficManagerLocal() {
+  episode_proxy.Lock()->RemoveActorDeltaConsumer();
   episode_proxy.Lock()->DestroyTrafficManager(server.port());
   Release();
 }
 
 void TrafficManagerLocal::SetupLocalMap() {
   const carla::SharedPtr<const cc::Map> world_map = world.GetMap();
-  local_map = std::make_shared<InMemoryMap>(world_map);
+  // Traffic managers of the same process attached to the same map share it.
+  local_map = InMemoryMapRegistry::Get(*world_map, [this, &world_map]() {
+    return BuildLocalMap(world_map);
+  });
+}
+
+std::shared_ptr<InMemoryMap> TrafficManagerLocal::BuildLocalMap(const carla::SharedPtr<const cc::Map> &world_map) {
+  auto new_map = std::make_shared<InMemoryMap>(world_map);
 
   auto files = episode_proxy.Lock()->GetRequiredFiles("TM");
   if (!files.empty()) {
+    // Map the cache in place if it is already on disk in the current format
+    // and was built from the OpenDRIVE of this map. It has a name of its own,
+    // so the file sent by the server is never overwritten.
+    const std::string cache_file = InMemoryMapCache::GetVersionedFilename(files[0]);
+    const std::string cache_path = cc::FileTransfer::GetFullPath(cache_file);
+    if (cc::FileTransfer::FileExists(cache_file) && new_map->Load(cache_path)) {
+      return new_map;
+    }
     auto content = episode_proxy.Lock()->GetCacheFile(files[0], true);
-    if (content.size() != 0) {
-      local_map->Load(content);
-    } else {
+    if (content.size() == 0 || !new_map->Load(content)) {
       log_warning("No InMemoryMap cache found. Setting up local map. This may take a while...");
-      local_map->SetUp();
+      new_map->SetUp();
     }
+    // Store the current format so that the next start can map it, replacing
+    // any cache built from another OpenDRIVE.
+    new_map->Save(cache_path);
   } else {
     log_warning("No InMemoryMap cache found. Setting up local map. This may take a while...");
-    local_map->SetUp();
+    new_map->SetUp();
   }
+  return new_map;
 }
 
 void TrafficManagerLocal::Start() {
@@ -179,9 +213,17 @@ void TrafficManagerLocal::Run() {
       last_frame = timestamp.frame;
     }
 
+    profiler.BeginCycle();
     std::unique_lock<std::mutex> registration_lock(registration_mutex);
     // Updating simulation state, actor life cycle and performing necessary cleanup.
+    StageProfiler::Clock::time_point stage_begin = StageProfiler::Now();
     alsm.Update();
+    current_timestamp = world.GetSnapshot().GetTimestamp();
+    profiler.Add(TMStage::ALSM, stage_begin, StageProfiler::Now());
+
+    // Publishing the parameters set since the last cycle, stages read them
+    // from this snapshot without locking.
+    parameters.PublishSnapshot();
 
     // Re-allocating inter-stage communication frames based on changed number of registered vehicles.
     int current_registered_vehicles_state = registered_vehicles.GetState();
@@ -189,6 +231,7 @@ void TrafficManagerLocal::Run() {
     if (registered_vehicles_state != current_registered_vehicles_state || number_of_vehicles != registered_vehicles.Size()) {
       vehicle_id_list = registered_vehicles.GetIDList();
       number_of_vehicles = vehicle_id_list.size();
+      tick_scheduler.Retain(vehicle_id_list);
 
       // Reserve more space if needed.
       uint64_t growth_factor = static_cast<uint64_t>(static_cast<float>(number_of_vehicles) * INV_GROWTH_STEP_SIZE);
@@ -218,34 +261,96 @@ void TrafficManagerLocal::Run() {
     // that will be inserted by the motion_plan_stage stage.
     control_frame.resize(number_of_vehicles);
 
-    // Run core operation stages.
-    for (unsigned long index = 0u; index < vehicle_id_list.size(); ++index) {
-      localization_stage.Update(index);
-    }
-    for (unsigned long index = 0u; index < vehicle_id_list.size(); ++index) {
-      collision_stage.Update(index);
-    }
-    collision_stage.ClearCycleCache();
-    vehicle_light_stage.UpdateWorldInfo();
-    for (unsigned long index = 0u; index < vehicle_id_list.size(); ++index) {
-      traffic_light_stage.Update(index);
-      motion_plan_stage.Update(index);
-      vehicle_light_stage.Update(index);
+    // Selecting the vehicles to update in this cycle, distant vehicles only
+    // run through the stages once every few cycles in tick LOD mode.
+    const bool tick_lod_mode = parameters.GetTickLODMode();
+    if (tick_lod_mode) {
+      alsm.GetHeroLocations(hero_locations);
+      tick_scheduler.Schedule(vehicle_id_list, simulation_state, hero_locations,
+                              parameters.GetTickLODBands(), scheduled_vehicles, skipped_vehicles);
+    } else {
+      tick_scheduler.Reset();
+      skipped_vehicles.clear();
+      scheduled_vehicles.resize(number_of_vehicles);
+      for (unsigned long index = 0u; index < number_of_vehicles; ++index) {
+        scheduled_vehicles[index] = index;
+      }
     }
 
+    // Run core operation stages.
+    UpdateStagePool();
+    stage_sequence.Update(scheduled_vehicles, skipped_vehicles, tick_lod_mode,
+                          stage_pool.get(), stage_pool_size,
+                          world.GetVehiclesLightStates(), world.GetWeather());
+
     registration_lock.unlock();
 
     // Sending the current cycle's batch command to the simulator.
+    stage_begin = StageProfiler::Now();
     if (synchronous_mode) {
-      episode_proxy.Lock()->ApplyBatchSync(control_frame, false);
+      ApplyControlFrame();
+      profiler.Add(TMStage::ApplyBatch, stage_begin, StageProfiler::Now());
+      profiler.EndCycle(number_of_vehicles);
       step_end.store(true);
       step_end_trigger.notify_one();
     } else {
       if (control_frame.size() > 0){
-        episode_proxy.Lock()->ApplyBatchSync(control_frame, false);
+        ApplyControlFrame();
+      }
+      profiler.Add(TMStage::ApplyBatch, stage_begin, StageProfiler::Now());
+      profiler.EndCycle(number_of_vehicles);
+    }
+  }
+}
+
+void TrafficManagerLocal::ApplyControlFrame() {
+  // Commands are packed in a single binary batch, only frames holding
+  // commands the batch does not support go through the generic path.
+  control_batch.Clear();
+  control_batch.Reserve(control_frame.size());
+  bool packed = true;
+  for (const carla::rpc::Command &command : control_frame) {
+    if (!control_batch.Add(command)) {
+      packed = false;
+      break;
+    }
+  }
+  uint64_t failed = 0u;
+  if (packed && use_control_batch) {
+    try {
+      failed = episode_proxy.Lock()->ApplyVehicleControlBatch(control_batch, control_batch_buffer, false);
+    } catch (const cc::TimeoutException &) {
+      throw;
+    } catch (const std::exception &e) {
+      log_warning("traffic manager: the simulator rejected the vehicle control batch, using the generic batch:", e.what());
+      use_control_batch = false;
+      packed = false;
+    }
+  }
+  if (!packed || !use_control_batch) {
+    for (const carla::rpc::CommandResponse &response : episode_proxy.Lock()->ApplyBatchSync(control_frame, false)) {
+      if (response.HasError()) {
+        ++failed;
       }
     }
   }
+  if (failed > 0u) {
+    log_debug("traffic manager:", failed, "commands failed");
+    failed_commands += failed;
+  }
+}
+
+void TrafficManagerLocal::UpdateStagePool() {
+  const uint16_t requested_threads = parameters.GetParallelStageThreads();
+  const uint16_t pool_size = requested_threads > 1u ? requested_threads : 0u;
+  if (pool_size != stage_pool_size) {
+    stage_pool.reset();
+    if (pool_size > 0u) {
+      stage_pool = std::make_unique<ThreadPool>();
+      stage_pool->AsyncRun(pool_size);
+    }
+    stage_pool_size = pool_size;
+  }
 }
 
 bool TrafficManagerLocal::SynchronousTick() {
@@ -273,6 +378,8 @@ void TrafficManagerLocal::Stop() {
     }
     worker_thread.release();
   }
+  stage_pool.reset();
+  stage_pool_size = 0u;
 
   vehicle_id_list.clear();
   registered_vehicles.Clear();
@@ -286,6 +393,7 @@ void TrafficManagerLocal::Stop() {
   collision_stage.Reset();
   traffic_light_stage.Reset();
   motion_plan_stage.Reset();
+  tick_scheduler.Reset();
 
   buffer_map.clear();
   localization_frame.clear();
@@ -411,6 +519,18 @@ void TrafficManagerLocal::SetOSMMode(const bool mode_switch) {
   parameters.SetOSMMode(mode_switch);
 }
 
+void TrafficManagerLocal::SetParallelStageThreads(const uint16_t num_threads) {
+  parameters.SetParallelStageThreads(num_threads);
+}
+
+void TrafficManagerLocal::SetTickLODMode(const bool mode_switch) {
+  parameters.SetTickLODMode(mode_switch);
+}
+
+void TrafficManagerLocal::SetTickLODBands(const std::vector<float> &distances, const std::vector<uint16_t> &periods) {
+  parameters.SetTickLODBands(distances, periods);
+}
+
 void TrafficManagerLocal::SetCustomPath(const ActorPtr &actor, const Path path, const bool empty_buffer) {
   parameters.SetCustomPath(actor, path, empty_buffer);
 }
@@ -455,6 +575,18 @@ ActionBuffer TrafficManagerLocal::GetActionBuffer(const ActorId &actor_id) {
   return localization_stage.ComputeActionBuffer(actor_id);
 }
 
+std::vector<StageProfile> TrafficManagerLocal::GetStageProfile() {
+  return profiler.GetProfile();
+}
+
+void TrafficManagerLocal::ResetStageProfile() {
+  profiler.Reset();
+}
+
+std::string TrafficManagerLocal::GetStageProfileTrace() {
+  return profiler.GetChromeTrace();
+}
+
 bool TrafficManagerLocal::CheckAllFrozen(TLGroup tl_to_freeze) {
   for (auto &elem : tl_to_freeze) {
     if (!elem->IsFrozen() || elem->GetState() != TLS::Red) {
@@ -16,13 +16,18 @@
 #include "carla/client/TrafficLight.h"
 #include "carla/client/World.h"
 #include "carla/Memory.h"
+#include "carla/ThreadPool.h"
 #include "carla/rpc/Command.h"
+#include "carla/rpc/VehicleControlBatch.h"
 
 #include "carla/trafficmanager/AtomicActorSet.h"
 #include "carla/trafficmanager/InMemoryMap.h"
 #include "carla/trafficmanager/Parameters.h"
 #include "carla/trafficmanager/RandomGenerator.h"
 #include "carla/trafficmanager/SimulationState.h"
+#include "carla/trafficmanager/StageProfiler.h"
+#include "carla/trafficmanager/StageSequence.h"
+#include "carla/trafficmanager/TickScheduler.h"
 #include "carla/trafficmanager/TrackTraffic.h"
 #include "carla/trafficmanager/TrafficManagerBase.h"
 #include "carla/trafficmanager/TrafficManagerServer.h"
@@ -42,7 +47,7 @@ using namespace std::chrono_literals;
 
 using TimePoint = chr::time_point<chr::system_clock, chr::nanoseconds>;
 using TLGroup = std::vector<carla::SharedPtr<carla::client::TrafficLight>>;
-using LocalMapPtr = std::shared_ptr<InMemoryMap>;
+using LocalMapPtr = std::shared_ptr<const InMemoryMap>;
 using constants::HybridMode::HYBRID_MODE_DT;
 
 /// The function of this class is to integrate all the various stages of
@@ -59,6 +64,8 @@ private:
   carla::client::detail::EpisodeProxy episode_proxy;
   /// CARLA client and object.
   cc::World world;
+  /// Timestamp of the simulation frame processed in the current cycle.
+  cc::Timestamp current_timestamp;
   /// Set of all actors registered with traffic manager.
   AtomicActorSet registered_vehicles;
   /// State counter to track changes in registered actors.
@@ -86,6 +93,17 @@ private:
   TLFrame tl_frame;
   /// Array to hold output data of motion planning.
   ControlFrame control_frame;
+  /// Commands of the control frame packed to be sent to the simulator.
+  carla::rpc::VehicleControlBatch control_batch;
+  /// Encoded control batch, kept to reuse its memory every cycle.
+  std::vector<unsigned char> control_batch_buffer;
+  /// Whether the simulator accepts packed control batches. Cleared the first
+  /// time it rejects one, e.g. an older simulator, the generic batch is used
+  /// from then on.
+  bool use_control_batch {true};
+  /// Number of commands the simulator failed to apply, e.g. because their
+  /// vehicle was destroyed.
+  std::atomic<uint64_t> failed_commands {0u};
   /// Variable to keep track of currently reserved array space for frames.
   uint64_t current_reserved_capacity {0u};
   /// Various stages representing core operations of traffic manager.
@@ -95,6 +113,17 @@ private:
   MotionPlanStage motion_plan_stage;
   VehicleLightStage vehicle_light_stage;
   ALSM alsm;
+  /// Execution time measurements of the stages.
+  StageProfiler profiler;
+  /// Level of detail scheduling of the vehicle updates.
+  TickScheduler tick_scheduler;
+  /// Per-vehicle stages of a cycle, in the order they run.
+  StageSequence stage_sequence;
+  /// Indices of the vehicles updated and skipped in the current cycle.
+  std::vector<unsigned long> scheduled_vehicles;
+  std::vector<unsigned long> skipped_vehicles;
+  /// Locations of the hero vehicles in the current cycle.
+  std::vector<cg::Location> hero_locations;
   /// Traffic manager server instance.
   TrafficManagerServer server;
   /// Switch to turn on / turn off traffic manager.
@@ -109,6 +138,10 @@ private:
   std::condition_variable step_end_trigger;
   /// Single worker thread for sequential execution of sub-components.
   std::unique_ptr<std::thread> worker_thread;
+  /// Thread pool used to shard the per-vehicle stages in parallel mode.
+  std::unique_ptr<ThreadPool> stage_pool;
+  /// Number of threads currently running in the stage pool.
+  uint16_t stage_pool_size {0u};
   /// Randomization seed.
   uint64_t seed {static_cast<uint64_t>(time(NULL))};
   /// Structure holding random devices per vehicle.
@@ -120,6 +153,15 @@ private:
   /// Method to check if all traffic lights are frozen in a group.
   bool CheckAllFrozen(TLGroup tl_to_freeze);
 
+  /// Method to build the local map from its cache or from the world map.
+  std::shared_ptr<InMemoryMap> BuildLocalMap(const carla::SharedPtr<const cc::Map> &world_map);
+
+  /// Method to send the commands of the current cycle to the simulator.
+  void ApplyControlFrame();
+
+  /// Method to start, resize or stop the stage pool to match the parameters.
+  void UpdateStagePool();
+
 public:
   /// Private constructor for singleton lifecycle management.
   TrafficManagerLocal(std::vector<float> longitudinal_PID_parameters,
@@ -133,7 +175,8 @@ public:
   /// Destructor.
   virtual ~TrafficManagerLocal();
 
-  /// Method to setup InMemoryMap.
+  /// Method to setup InMemoryMap, shared with the other traffic managers of
+  /// the process attached to the same map.
   void SetupLocalMap();
 
   /// To start the TrafficManager.
@@ -157,6 +200,12 @@ public:
   /// This method unregisters a vehicle from traffic manager.
   void UnregisterVehicles(const std::vector<ActorPtr> &actor_list);
 
+  /// Number of commands sent by the traffic manager that the simulator failed
+  /// to apply since it started.
+  uint64_t GetFailedCommandCount() const {
+    return failed_commands.load();
+  }
+
   /// Method to set a vehicle's % decrease in velocity with respect to the speed limit.
   /// If less than 0, it's a % increase.
   void SetPercentageSpeedDifference(const ActorPtr &actor, const float percentage);
@@ -245,6 +294,15 @@ public:
   /// Method to set Open Street Map mode.
   void SetOSMMode(const bool mode_switch);
 
+  /// Method to set the number of threads the per-vehicle stages are sharded across.
+  void SetParallelStageThreads(const uint16_t num_threads);
+
+  /// Method to set the tick level of detail mode.
+  void SetTickLODMode(const bool mode_switch);
+
+  /// Method to set the distance bands of the tick level of detail.
+  void SetTickLODBands(const std::vector<float> &distances, const std::vector<uint16_t> &periods);
+
   /// Method to set our own imported path.
   void SetCustomPath(const ActorPtr &actor, const Path path, const bool empty_buffer);
 
@@ -278,6 +336,15 @@ public:
   /// Method to get the vehicle's action buffer.
   ActionBuffer GetActionBuffer(const ActorId &actor_id);
 
+  /// Method to get the execution time statistics of every stage.
+  std::vector<StageProfile> GetStageProfile();
+
+  /// Method to discard the execution time statistics of every stage.
+  void ResetStageProfile();
+
+  /// Method to get the latest cycles in Chrome trace event format.
+  std::string GetStageProfileTrace();
+
   void ShutDown() {};
 };
 
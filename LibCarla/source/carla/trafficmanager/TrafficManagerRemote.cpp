@@ -221,6 +221,18 @@ void TrafficManagerRemote::SetOSMMode(const bool mode_switch) {
   client.SetOSMMode(mode_switch);
 }
 
+void TrafficManagerRemote::SetParallelStageThreads(const uint16_t num_threads) {
+  client.SetParallelStageThreads(num_threads);
+}
+
+void TrafficManagerRemote::SetTickLODMode(const bool mode_switch) {
+  client.SetTickLODMode(mode_switch);
+}
+
+void TrafficManagerRemote::SetTickLODBands(const std::vector<float> &distances, const std::vector<uint16_t> &periods) {
+  client.SetTickLODBands(distances, periods);
+}
+
 void TrafficManagerRemote::SetCustomPath(const ActorPtr &_actor, const Path path, const bool empty_buffer) {
   carla::rpc::Actor actor(_actor->Serialize());
 
@@ -281,6 +293,18 @@ ActionBuffer TrafficManagerRemote::GetActionBuffer(const ActorId &actor_id) {
   return client.GetActionBuffer(actor_id);
 }
 
+std::vector<StageProfile> TrafficManagerRemote::GetStageProfile() {
+  return client.GetStageProfile();
+}
+
+void TrafficManagerRemote::ResetStageProfile() {
+  client.ResetStageProfile();
+}
+
+std::string TrafficManagerRemote::GetStageProfileTrace() {
+  return client.GetStageProfileTrace();
+}
+
 bool TrafficManagerRemote::SynchronousTick() {
   return false;
 }
@@ -128,6 +128,15 @@ public:
   /// Method to set Open Street Map mode.
   void SetOSMMode(const bool mode_switch);
 
+  /// Method to set the number of threads the per-vehicle stages are sharded across.
+  void SetParallelStageThreads(const uint16_t num_threads);
+
+  /// Method to set the tick level of detail mode.
+  void SetTickLODMode(const bool mode_switch);
+
+  /// Method to set the distance bands of the tick level of detail.
+  void SetTickLODBands(const std::vector<float> &distances, const std::vector<uint16_t> &periods);
+
   /// Method to set our own imported path.
   void SetCustomPath(const ActorPtr &actor, const Path path, const bool empty_buffer);
 
@@ -163,6 +172,15 @@ public:
   /// Method to get the vehicle's action buffer.
   ActionBuffer GetActionBuffer(const ActorId &actor_id);
 
+  /// Method to get the execution time statistics of every stage.
+  std::vector<StageProfile> GetStageProfile();
+
+  /// Method to discard the execution time statistics of every stage.
+  void ResetStageProfile();
+
+  /// Method to get the latest cycles in Chrome trace event format.
+  std::string GetStageProfileTrace();
+
   /// Method to provide synchronous tick
   bool SynchronousTick();
 
@@ -203,6 +203,21 @@ public:
         tm->SetOSMMode(mode_switch);
       });
 
+      /// Method to set the number of threads the stages are sharded across.
+      server->bind("set_parallel_stage_threads", [=](const uint16_t num_threads) {
+        tm->SetParallelStageThreads(num_threads);
+      });
+
+      /// Method to set the tick level of detail mode.
+      server->bind("set_tick_lod_mode", [=](const bool mode_switch) {
+        tm->SetTickLODMode(mode_switch);
+      });
+
+      /// Method to set the distance bands of the tick level of detail.
+      server->bind("set_tick_lod_bands", [=](const std::vector<float> distances, const std::vector<uint16_t> periods) {
+        tm->SetTickLODBands(distances, periods);
+      });
+
       /// Method to set our own imported path.
       server->bind("set_path", [=](carla::rpc::Actor actor, const Path path, const bool empty_buffer) {
         tm->SetCustomPath(carla::client::detail::ActorVariant(actor).Get(tm->GetEpisodeProxy()), path, empty_buffer);
@@ -253,6 +268,21 @@ public:
         tm->GetActionBuffer(actor_id);
       });
 
+      /// Method to get the execution time statistics of every stage.
+      server->bind("get_stage_profile", [=]() -> std::vector<StageProfile> {
+        return tm->GetStageProfile();
+      });
+
+      /// Method to discard the execution time statistics of every stage.
+      server->bind("reset_stage_profile", [=]() {
+        tm->ResetStageProfile();
+      });
+
+      /// Method to get the latest cycles in Chrome trace event format.
+      server->bind("get_stage_profile_trace", [=]() -> std::string {
+        return tm->GetStageProfileTrace();
+      });
+
       server->bind("shut_down", [=]() {
         tm->Release();
       });
@@ -13,18 +13,16 @@ VehicleLightStage::VehicleLightStage(
   const std::vector<ActorId> &vehicle_id_list,
   const BufferMap &buffer_map,
   const Parameters &parameters,
-  const cc::World &world,
   ControlFrame& control_frame)
   : vehicle_id_list(vehicle_id_list),
     buffer_map(buffer_map),
     parameters(parameters),
-    world(world),
     control_frame(control_frame) {}
 
-void VehicleLightStage::UpdateWorldInfo() {
-  // Get the global weather and all the vehicle light states at once
-  all_light_states = world.GetVehiclesLightStates();
-  weather = world.GetWeather();
+void VehicleLightStage::UpdateWorldInfo(rpc::VehicleLightStateList light_states,
+                                        const rpc::WeatherParameters &weather_parameters) {
+  all_light_states = std::move(light_states);
+  weather = weather_parameters;
 }
 
 void VehicleLightStage::Update(const unsigned long index) {
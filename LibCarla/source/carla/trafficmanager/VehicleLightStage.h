@@ -17,7 +17,6 @@ private:
   const std::vector<ActorId> &vehicle_id_list;
   const BufferMap &buffer_map;
   const Parameters &parameters;
-  const cc::World &world;
   ControlFrame& control_frame;
   /// All vehicle light states
   rpc::VehicleLightStateList all_light_states;
@@ -28,10 +27,10 @@ public:
   VehicleLightStage(const std::vector<ActorId> &vehicle_id_list,
                     const BufferMap &buffer_map,
                     const Parameters &parameters,
-                    const cc::World &world,
                     ControlFrame& control_frame);
 
-  void UpdateWorldInfo();
+  /// Sets the vehicle light states and the weather of the current cycle.
+  void UpdateWorldInfo(rpc::VehicleLightStateList light_states, const rpc::WeatherParameters &weather_parameters);
 
   void Update(const unsigned long index) override;
 
@@ -0,0 +1,188 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include "carla/Debug.h"
+#include "carla/Exception.h"
+
+#include "carla/trafficmanager/Constants.h"
+#include "carla/trafficmanager/SimpleWaypoint.h"
+
+namespace carla {
+namespace traffic_manager {
+
+  using SimpleWaypointPtr = std::shared_ptr<SimpleWaypoint>;
+  using NodeList = std::vector<SimpleWaypointPtr>;
+
+  /// Path of a vehicle through the waypoints of the local map.
+  ///
+  /// The buffer is a ring of 32-bit indices into the dense topology of the
+  /// InMemoryMap, which owns all the waypoints. Pushing and popping waypoints
+  /// never touches their reference counts, and the storage is allocated once
+  /// with the capacity of a typical path, growing only for unusually long
+  /// ones. Accessors return references to the waypoints held by the map.
+  class WaypointBuffer {
+  public:
+
+    using WaypointIndex = uint32_t;
+
+    class const_iterator {
+    public:
+
+      using iterator_category = std::forward_iterator_tag;
+      using value_type = SimpleWaypointPtr;
+      using difference_type = std::ptrdiff_t;
+      using pointer = const SimpleWaypointPtr *;
+      using reference = const SimpleWaypointPtr &;
+
+      const_iterator(const WaypointBuffer &buffer, std::size_t position)
+        : _waypoints(buffer._waypoints->data()),
+          _ring(buffer._ring.data()),
+          _mask(buffer._ring.empty() ? 0u : buffer._ring.size() - 1u),
+          _position(buffer._head + position) {}
+
+      reference operator*() const {
+        return _waypoints[_ring[_position & _mask]];
+      }
+
+      pointer operator->() const {
+        return &**this;
+      }
+
+      const_iterator &operator++() {
+        ++_position;
+        return *this;
+      }
+
+      bool operator==(const const_iterator &rhs) const {
+        return _position == rhs._position;
+      }
+
+      bool operator!=(const const_iterator &rhs) const {
+        return _position != rhs._position;
+      }
+
+    private:
+
+      const SimpleWaypointPtr *_waypoints;
+
+      const WaypointIndex *_ring;
+
+      std::size_t _mask;
+
+      std::size_t _position;
+    };
+
+    /// Creates a buffer over the dense topology of the local map. Only
+    /// waypoints of this topology can be pushed into the buffer, and the
+    /// topology must outlive it.
+    explicit WaypointBuffer(const NodeList &waypoints)
+      : _waypoints(&waypoints),
+        _ring(constants::PathBufferUpdate::INITIAL_BUFFER_CAPACITY) {}
+
+    bool empty() const {
+      return _size == 0u;
+    }
+
+    std::size_t size() const {
+      return _size;
+    }
+
+    std::size_t capacity() const {
+      return _ring.size();
+    }
+
+    const SimpleWaypointPtr &operator[](std::size_t i) const {
+      DEBUG_ASSERT(i < _size);
+      return (*_waypoints)[GetIndex(i)];
+    }
+
+    const SimpleWaypointPtr &at(std::size_t i) const {
+      if (i >= _size) {
+        throw_exception(std::out_of_range("waypoint buffer index out of range"));
+      }
+      return (*this)[i];
+    }
+
+    const SimpleWaypointPtr &front() const {
+      return (*this)[0u];
+    }
+
+    const SimpleWaypointPtr &back() const {
+      return (*this)[_size - 1u];
+    }
+
+    /// Index of the i-th waypoint of the buffer in the dense topology.
+    WaypointIndex GetIndex(std::size_t i) const {
+      return _ring[(_head + i) & (_ring.size() - 1u)];
+    }
+
+    void push_back(const SimpleWaypointPtr &waypoint) {
+      const WaypointIndex index = waypoint->GetIndex();
+      DEBUG_ASSERT(index < _waypoints->size() && (*_waypoints)[index] == waypoint);
+      if (_size == _ring.size()) {
+        Grow();
+      }
+      _ring[(_head + _size) & (_ring.size() - 1u)] = index;
+      ++_size;
+    }
+
+    void pop_front() {
+      DEBUG_ASSERT(_size > 0u);
+      _head = (_head + 1u) & (_ring.size() - 1u);
+      --_size;
+    }
+
+    void pop_back() {
+      DEBUG_ASSERT(_size > 0u);
+      --_size;
+    }
+
+    void clear() {
+      _head = 0u;
+      _size = 0u;
+    }
+
+    const_iterator begin() const {
+      return const_iterator(*this, 0u);
+    }
+
+    const_iterator end() const {
+      return const_iterator(*this, _size);
+    }
+
+  private:
+
+    /// Doubles the capacity of the ring, keeping it a power of two.
+    void Grow() {
+      std::vector<WaypointIndex> ring(_ring.empty() ? 1u : 2u * _ring.size());
+      for (std::size_t i = 0u; i < _size; ++i) {
+        ring[i] = GetIndex(i);
+      }
+      _ring.swap(ring);
+      _head = 0u;
+    }
+
+    /// Never null, as it can only be set from a reference. A pointer instead
+    /// of a reference keeps buffers assignable.
+    const NodeList *_waypoints;
+
+    std::vector<WaypointIndex> _ring;
+
+    std::size_t _head = 0u;
+
+    std::size_t _size = 0u;
+  };
+
+} // namespace traffic_manager
+} // namespace carla
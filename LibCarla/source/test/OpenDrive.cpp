@@ -0,0 +1,145 @@
+// Copyright (c) 2019 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "OpenDrive.h"
+
+#ifndef LIBCARLA_TEST_CONTENT_FOLDER
+#  error Please define LIBCARLA_TEST_CONTENT_FOLDER.
+#endif
+
+#include <pugixml/pugixml.hpp>
+
+#include <dirent.h>
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <streambuf>
+
+namespace util {
+
+  // Listed without carla::FileSystem, which is not part of the server
+  // library.
+  std::vector<std::string> OpenDrive::GetAvailableFiles() {
+    const std::string extension = ".xodr";
+    std::vector<std::string> result;
+    DIR *folder = opendir(LIBCARLA_TEST_CONTENT_FOLDER "/OpenDrive/");
+    if (folder == nullptr) {
+      return result;
+    }
+    while (const dirent *entry = readdir(folder)) {
+      const std::string filename = entry->d_name;
+      if (filename.size() > extension.size() &&
+          filename.compare(filename.size() - extension.size(), extension.size(), extension) == 0) {
+        result.emplace_back(filename);
+      }
+    }
+    closedir(folder);
+    std::sort(result.begin(), result.end());
+    return result;
+  }
+
+  std::string OpenDrive::Load(const std::string &filename) {
+    const std::string opendrive_folder = LIBCARLA_TEST_CONTENT_FOLDER "/OpenDrive/";
+    std::ifstream file(opendrive_folder + filename);
+    return std::string{std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+  }
+
+  static void OffsetId(pugi::xml_attribute attribute, long long offset) {
+    if (attribute) {
+      attribute.set_value(attribute.as_llong() + offset);
+    }
+  }
+
+  static void SuffixId(pugi::xml_attribute attribute, const std::string &suffix) {
+    if (attribute) {
+      attribute.set_value((std::string(attribute.value()) + suffix).c_str());
+    }
+  }
+
+  static void Translate(pugi::xml_node node, double dx, double dy) {
+    node.attribute("x").set_value(node.attribute("x").as_double() + dx);
+    node.attribute("y").set_value(node.attribute("y").as_double() + dy);
+  }
+
+  std::string OpenDrive::Tile(const std::string &opendrive, size_t count) {
+    constexpr double TILE_SIZE = 2000.0;
+
+    pugi::xml_document source;
+    source.load_string(opendrive.c_str());
+    const pugi::xml_node source_root = source.child("OpenDRIVE");
+
+    // Road and junction ids of each copy are offset past the largest id.
+    long long id_offset = 0;
+    for (pugi::xml_node node : source_root.children()) {
+      const std::string name = node.name();
+      if (name == "road" || name == "junction") {
+        id_offset = std::max(id_offset, node.attribute("id").as_llong() + 1);
+      }
+    }
+
+    size_t side = 1u;
+    while (side * side < count) {
+      ++side;
+    }
+
+    pugi::xml_document result;
+    pugi::xml_node root = result.append_child("OpenDRIVE");
+    root.append_copy(source_root.child("header"));
+    for (size_t tile = 0u; tile < count; ++tile) {
+      const long long offset = static_cast<long long>(tile) * id_offset;
+      const std::string suffix = "_" + std::to_string(tile);
+      const double dx = TILE_SIZE * static_cast<double>(tile % side);
+      const double dy = TILE_SIZE * static_cast<double>(tile / side);
+      for (pugi::xml_node node : source_root.children()) {
+        const std::string name = node.name();
+        if (name == "road") {
+          pugi::xml_node road = root.append_copy(node);
+          OffsetId(road.attribute("id"), offset);
+          if (road.attribute("junction").as_int() != -1) {
+            OffsetId(road.attribute("junction"), offset);
+          }
+          for (pugi::xml_node link : road.child("link").children()) {
+            OffsetId(link.attribute("elementId"), offset);
+          }
+          for (pugi::xml_node geometry : road.child("planView").children("geometry")) {
+            Translate(geometry, dx, dy);
+          }
+          for (pugi::xml_node signal : road.child("signals").children()) {
+            SuffixId(signal.attribute("id"), suffix);
+            for (pugi::xml_node position : signal.children("positionInertial")) {
+              Translate(position, dx, dy);
+            }
+          }
+          for (pugi::xml_node object : road.child("objects").children("object")) {
+            SuffixId(object.attribute("id"), suffix);
+          }
+        } else if (name == "junction") {
+          pugi::xml_node junction = root.append_copy(node);
+          OffsetId(junction.attribute("id"), offset);
+          for (pugi::xml_node connection : junction.children("connection")) {
+            OffsetId(connection.attribute("incomingRoad"), offset);
+            OffsetId(connection.attribute("connectingRoad"), offset);
+          }
+          for (pugi::xml_node controller : junction.children("controller")) {
+            SuffixId(controller.attribute("id"), suffix);
+          }
+        } else if (name == "controller") {
+          pugi::xml_node controller = root.append_copy(node);
+          SuffixId(controller.attribute("id"), suffix);
+          for (pugi::xml_node control : controller.children("control")) {
+            SuffixId(control.attribute("signalId"), suffix);
+          }
+        }
+      }
+    }
+
+    std::ostringstream stream;
+    result.save(stream);
+    return stream.str();
+  }
+
+} // namespace util
@@ -6,6 +6,7 @@
 
 #pragma once
 
+#include <cstddef>
 #include <string>
 #include <vector>
 
@@ -18,6 +19,11 @@ namespace util {
     static std::vector<std::string> GetAvailableFiles();
 
     static std::string Load(const std::string &filename);
+
+    /// Lays out @a count copies of the roads, junctions and controllers of
+    /// @a opendrive side by side in a grid, with their ids renamed so the
+    /// copies are not connected, to make a large map out of a test one.
+    static std::string Tile(const std::string &opendrive, size_t count);
   };
 
 } // namespace util
@@ -0,0 +1,295 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "OpenDrive.h"
+
+#include <carla/ThreadPool.h>
+#include <carla/client/Map.h>
+#include <carla/geom/Math.h>
+#include <carla/trafficmanager/CollisionStage.h>
+#include <carla/trafficmanager/InMemoryMap.h>
+#include <carla/trafficmanager/LocalizationStage.h>
+#include <carla/trafficmanager/MotionPlanStage.h>
+#include <carla/trafficmanager/StageProfiler.h>
+#include <carla/trafficmanager/StageSequence.h>
+#include <carla/trafficmanager/TickScheduler.h>
+#include <carla/trafficmanager/TrafficLightStage.h>
+#include <carla/trafficmanager/VehicleLightStage.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace util {
+
+  using namespace carla::traffic_manager;
+  namespace cg = carla::geom;
+  using ApplyTransform = carla::rpc::Command::ApplyTransform;
+  using ApplyVehicleControl = carla::rpc::Command::ApplyVehicleControl;
+  using SetVehicleLightState = carla::rpc::Command::SetVehicleLightState;
+
+  /// Runs the stages of the traffic manager on a town without a simulator,
+  /// through the same StageSequence as TrafficManagerLocal.
+  /// Vehicles are spawned on the local map and the commands of every cycle
+  /// are applied by a simple kinematic model in place of the simulator, so
+  /// that the pipeline can be tested and measured on any machine. Collision
+  /// hazards and commands are folded into a checksum that only changes when
+  /// the behaviour of the stages does. The collision stage runs on
+  /// @a collision_threads threads, or serially if lower than 2.
+  class TrafficManagerSimulation {
+  public:
+
+    static constexpr float DELTA_SECONDS = 0.05f;
+
+    /// Inputs of the collision stage in a cycle and the hazards it found, to
+    /// replay the stage on its own.
+    struct CollisionRecord {
+      std::vector<ActorId> vehicle_id_list;
+      SimulationState simulation_state;
+      BufferMap buffer_map;
+      TrackTraffic track_traffic;
+      CollisionFrame collision_frame;
+    };
+
+    TrafficManagerSimulation(
+        LocalMapPtr map,
+        std::size_t number_of_vehicles,
+        uint64_t seed,
+        std::size_t collision_threads = 0u)
+      : local_map(std::move(map)),
+        random_device(seed),
+        localization_stage(vehicle_id_list, buffer_map, simulation_state, track_traffic, local_map,
+                           parameters, marked_for_removal, localization_frame, random_device),
+        collision_stage(vehicle_id_list, simulation_state, buffer_map, track_traffic, parameters,
+                        collision_frame, random_device),
+        traffic_light_stage(vehicle_id_list, simulation_state, buffer_map, parameters, current_timestamp,
+                            tl_frame, random_device),
+        motion_plan_stage(vehicle_id_list, simulation_state, parameters, buffer_map, track_traffic,
+                          constants::PID::LONGITUDIAL_PARAM, constants::PID::LONGITUDIAL_HIGHWAY_PARAM,
+                          constants::PID::LATERAL_PARAM, constants::PID::LATERAL_HIGHWAY_PARAM,
+                          localization_frame, collision_frame, tl_frame, current_timestamp,
+                          control_frame, random_device, local_map),
+        vehicle_light_stage(vehicle_id_list, buffer_map, parameters, control_frame),
+        stage_sequence(vehicle_id_list, simulation_state, control_frame, localization_stage, collision_stage,
+                       traffic_light_stage, motion_plan_stage, vehicle_light_stage, tick_scheduler, profiler) {
+      if (collision_threads > 1u) {
+        collision_pool.AsyncRun(collision_threads);
+        number_of_collision_workers = collision_threads;
+      }
+      Spawn(number_of_vehicles);
+    }
+
+    /// Runs a traffic manager cycle and applies its commands.
+    void Tick() {
+      profiler.BeginCycle();
+      const std::size_t number_of_vehicles = vehicle_id_list.size();
+      localization_frame.clear();
+      localization_frame.resize(number_of_vehicles);
+      collision_frame.clear();
+      collision_frame.resize(number_of_vehicles);
+      tl_frame.clear();
+      tl_frame.resize(number_of_vehicles);
+      control_frame.clear();
+      control_frame.resize(number_of_vehicles);
+
+      scheduled_vehicles.resize(number_of_vehicles);
+      for (unsigned long index = 0u; index < number_of_vehicles; ++index) {
+        scheduled_vehicles[index] = index;
+      }
+      stage_sequence.Update(scheduled_vehicles, skipped_vehicles, false,
+                            number_of_collision_workers > 1u ? &collision_pool : nullptr,
+                            number_of_collision_workers, light_states, weather);
+      // Stuck vehicles are only removed by the actor life cycle management.
+      marked_for_removal.clear();
+      if (collision_records != nullptr) {
+        collision_records->push_back({vehicle_id_list, simulation_state, buffer_map, track_traffic, collision_frame});
+      }
+      for (const CollisionHazardData &hazard : collision_frame) {
+        Hash(&hazard.hazard_actor_id, sizeof(hazard.hazard_actor_id));
+        Hash(hazard.available_distance_margin);
+        hazards += hazard.hazard ? 1u : 0u;
+      }
+
+      // The simulator stand-in is accounted as the batch application.
+      StageProfiler::Clock::time_point stage_begin = StageProfiler::Now();
+      ApplyCommands();
+      profiler.Add(TMStage::ApplyBatch, stage_begin, StageProfiler::Now());
+      profiler.EndCycle(number_of_vehicles);
+    }
+
+    std::size_t GetNumberOfVehicles() const {
+      return vehicle_id_list.size();
+    }
+
+    uint64_t GetChecksum() const {
+      return checksum;
+    }
+
+    /// Number of collision hazards found over all the cycles.
+    std::size_t GetNumberOfHazards() const {
+      return hazards;
+    }
+
+    /// Sum of the distances travelled by all the vehicles.
+    float GetDistanceTravelled() const {
+      return distance_travelled;
+    }
+
+    const StageProfiler &GetProfiler() const {
+      return profiler;
+    }
+
+    /// Records the collision stage of the following cycles into @a records,
+    /// or stops recording if null.
+    void RecordCollisionStage(std::vector<CollisionRecord> *records) {
+      collision_records = records;
+    }
+
+  private:
+
+    void Spawn(std::size_t number_of_vehicles) {
+      std::vector<SimpleWaypointPtr> spawn_points;
+      for (const SimpleWaypointPtr &waypoint : local_map->GetDenseTopology()) {
+        if (!waypoint->CheckJunction()) {
+          spawn_points.push_back(waypoint);
+        }
+      }
+      // Spread the vehicles evenly over the roads, at least a car length apart.
+      const std::size_t step = std::max<std::size_t>(4u, spawn_points.size() / std::max<std::size_t>(1u, number_of_vehicles));
+      for (std::size_t i = 0u; i < spawn_points.size() && vehicle_id_list.size() < number_of_vehicles; i += step) {
+        const ActorId actor_id = static_cast<ActorId>(vehicle_id_list.size() + 1u);
+        cg::Transform transform = spawn_points[i]->GetTransform();
+        transform.location.z += 0.5f;
+        simulation_state.AddActor(
+            actor_id,
+            KinematicState{transform.location, transform.rotation, cg::Vector3D(), 50.0f, true, false, cg::Location()},
+            StaticAttributes{ActorType::Vehicle, 2.4f, 1.0f, 0.8f},
+            TrafficLightState{TLS::Green, false});
+        vehicle_id_list.push_back(actor_id);
+      }
+    }
+
+    void Hash(const void *data, std::size_t size) {
+      const auto *bytes = static_cast<const unsigned char *>(data);
+      for (std::size_t i = 0u; i < size; ++i) {
+        checksum = (checksum ^ bytes[i]) * 1099511628211ull;
+      }
+    }
+
+    void Hash(float value) {
+      uint32_t bits;
+      std::memcpy(&bits, &value, sizeof(bits));
+      Hash(&bits, sizeof(bits));
+    }
+
+    /// Kinematic bicycle model standing in for the vehicle physics.
+    void ApplyControl(const ApplyVehicleControl &command) {
+      constexpr float MAX_ACCELERATION = 3.0f;
+      constexpr float MAX_DECELERATION = 8.0f;
+      constexpr float MAX_STEER_ANGLE = 1.2f;
+      constexpr float WHEEL_BASE = 2.8f;
+      Hash(&command.actor, sizeof(command.actor));
+      Hash(command.control.throttle);
+      Hash(command.control.steer);
+      Hash(command.control.brake);
+
+      const ActorId actor_id = command.actor;
+      const cg::Vector3D heading = simulation_state.GetHeading(actor_id);
+      float speed = simulation_state.GetVelocity(actor_id).Length();
+      const float acceleration = command.control.throttle * MAX_ACCELERATION - command.control.brake * MAX_DECELERATION;
+      speed = std::max(0.0f, speed + acceleration * DELTA_SECONDS);
+      if (command.control.hand_brake) {
+        speed = 0.0f;
+      }
+      cg::Rotation rotation = simulation_state.GetRotation(actor_id);
+      const float yaw_rate = speed * std::tan(command.control.steer * MAX_STEER_ANGLE) / WHEEL_BASE;
+      rotation.yaw += cg::Math::ToDegrees(yaw_rate * DELTA_SECONDS);
+      const float yaw = cg::Math::ToRadians(rotation.yaw);
+      const cg::Vector3D velocity(speed * std::cos(yaw), speed * std::sin(yaw), 0.0f);
+      const cg::Location location = simulation_state.GetLocation(actor_id) + cg::Location(heading * (speed * DELTA_SECONDS));
+      distance_travelled += speed * DELTA_SECONDS;
+      simulation_state.UpdateKinematicState(
+          actor_id,
+          KinematicState{location, rotation, velocity, 50.0f, true, false, cg::Location()});
+    }
+
+    void ApplyTeleport(const ApplyTransform &command) {
+      Hash(&command.actor, sizeof(command.actor));
+      Hash(command.transform.location.x);
+      Hash(command.transform.location.y);
+      Hash(command.transform.rotation.yaw);
+
+      const ActorId actor_id = command.actor;
+      const cg::Vector3D displacement = command.transform.location - simulation_state.GetLocation(actor_id);
+      distance_travelled += displacement.Length();
+      simulation_state.UpdateKinematicState(
+          actor_id,
+          KinematicState{command.transform.location, command.transform.rotation,
+                         displacement * (1.0f / DELTA_SECONDS), 50.0f,
+                         simulation_state.IsPhysicsEnabled(actor_id), false, cg::Location()});
+    }
+
+    void ApplyCommands() {
+      for (const carla::rpc::Command &command : control_frame) {
+        if (const auto *control = boost::variant2::get_if<ApplyVehicleControl>(&command.command)) {
+          ApplyControl(*control);
+        } else if (const auto *teleport = boost::variant2::get_if<ApplyTransform>(&command.command)) {
+          ApplyTeleport(*teleport);
+        } else if (const auto *lights = boost::variant2::get_if<SetVehicleLightState>(&command.command)) {
+          Hash(&lights->light_state, sizeof(lights->light_state));
+        }
+      }
+      current_timestamp.frame += 1u;
+      current_timestamp.elapsed_seconds += DELTA_SECONDS;
+      current_timestamp.delta_seconds = DELTA_SECONDS;
+    }
+
+    LocalMapPtr local_map;
+    std::vector<ActorId> vehicle_id_list;
+    BufferMap buffer_map;
+    SimulationState simulation_state;
+    TrackTraffic track_traffic;
+    Parameters parameters;
+    std::vector<ActorId> marked_for_removal;
+    RandomGenerator random_device;
+    carla::client::Timestamp current_timestamp;
+    carla::rpc::VehicleLightStateList light_states;
+    carla::rpc::WeatherParameters weather;
+    LocalizationFrame localization_frame;
+    CollisionFrame collision_frame;
+    TLFrame tl_frame;
+    ControlFrame control_frame;
+    LocalizationStage localization_stage;
+    CollisionStage collision_stage;
+    TrafficLightStage traffic_light_stage;
+    MotionPlanStage motion_plan_stage;
+    VehicleLightStage vehicle_light_stage;
+    StageProfiler profiler;
+    TickScheduler tick_scheduler;
+    std::vector<unsigned long> scheduled_vehicles;
+    std::vector<unsigned long> skipped_vehicles;
+    StageSequence stage_sequence;
+    carla::ThreadPool collision_pool;
+    std::size_t number_of_collision_workers = 1u;
+    std::size_t hazards = 0u;
+    std::vector<CollisionRecord> *collision_records = nullptr;
+    uint64_t checksum = 14695981039346656037ull;
+    float distance_travelled = 0.0f;
+  };
+
+  /// Builds the local map of one of the test OpenDrive files.
+  inline LocalMapPtr make_local_map(const std::string &file) {
+    auto map = carla::MakeShared<carla::client::Map>(file, util::OpenDrive::Load(file));
+    auto local_map = std::make_shared<InMemoryMap>(map);
+    local_map->SetUp();
+    return local_map;
+  }
+
+} // namespace util
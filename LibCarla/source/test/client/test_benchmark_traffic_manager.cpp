@@ -0,0 +1,34 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+#include "TrafficManagerSimulation.h"
+
+using util::TrafficManagerSimulation;
+
+// Only run with "Check.sh --benchmark", the default unit test runs of the
+// client skip the benchmark suites.
+TEST(benchmark_traffic_manager, stages) {
+  constexpr std::size_t number_of_vehicles = 500u;
+  constexpr int number_of_cycles = 200;
+  for (const auto &file : util::OpenDrive::GetAvailableFiles()) {
+    TrafficManagerSimulation simulation(util::make_local_map(file), number_of_vehicles, 42u);
+    for (int i = 0; i < number_of_cycles; ++i) {
+      simulation.Tick();
+    }
+    carla::logging::log(
+        file, ":", simulation.GetNumberOfVehicles(), "vehicles,", number_of_cycles,
+        "cycles, checksum", simulation.GetChecksum());
+    for (const auto &stage : simulation.GetProfiler().GetProfile()) {
+      if (stage.name == "ALSM") {
+        continue;
+      }
+      carla::logging::log(
+          "  ", stage.name, "mean", stage.mean_ms, "ms, p50", stage.p50_ms,
+          "ms, p99", stage.p99_ms, "ms, max", stage.max_ms, "ms");
+    }
+  }
+}
@@ -0,0 +1,246 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+#include "Random.h"
+#include "TrafficManagerSimulation.h"
+
+#include <carla/StopWatch.h>
+#include <carla/geom/Math.h>
+#include <carla/trafficmanager/CollisionGeometry.h>
+#include <carla/trafficmanager/CollisionStage.h>
+#include <carla/trafficmanager/Constants.h>
+
+#if defined(__clang__)
+#  pragma clang diagnostic push
+#  pragma clang diagnostic ignored "-Wshadow"
+#endif
+#include <boost/geometry.hpp>
+#include <boost/geometry/geometries/point_xy.hpp>
+#include <boost/geometry/geometries/polygon.hpp>
+#if defined(__clang__)
+#  pragma clang diagnostic pop
+#endif
+
+#include <chrono>
+#include <vector>
+
+namespace bg = boost::geometry;
+
+using carla::geom::Location;
+using carla::traffic_manager::BoundaryPolygon;
+using carla::traffic_manager::GeometryComparison;
+using carla::traffic_manager::constants::Collision::OVERLAP_THRESHOLD;
+using util::Random;
+
+using LocationVector = std::vector<Location>;
+using Point2D = bg::model::point<double, 2, bg::cs::cartesian>;
+using Polygon = bg::model::polygon<bg::model::d2::point_xy<double>>;
+
+// Polygon as built by the collision stage before the distance kernel existed.
+static Polygon make_boost_polygon(const LocationVector &boundary) {
+  Polygon polygon;
+  for (const Location &location : boundary) {
+    bg::append(polygon.outer(), Point2D(location.x, location.y));
+  }
+  bg::append(polygon.outer(), Point2D(boundary.front().x, boundary.front().y));
+  return polygon;
+}
+
+// Actor of a synthetic frame: a bounding box and the path boundary ahead of
+// it, built the same way as the collision stage does.
+struct FrameActor {
+  LocationVector bbox;
+  LocationVector geodesic;
+};
+
+static FrameActor make_actor(float area_size) {
+  const Location location(
+      static_cast<float>(Random::Uniform(0.0, area_size)),
+      static_cast<float>(Random::Uniform(0.0, area_size)),
+      0.0f);
+  float yaw = static_cast<float>(Random::Uniform(-M_PI, M_PI));
+  const float curvature = static_cast<float>(Random::Uniform(-0.08, 0.08));
+  const float half_length = static_cast<float>(Random::Uniform(2.0, 3.0));
+  const float half_width = static_cast<float>(Random::Uniform(0.9, 1.2));
+  const int number_of_points = static_cast<int>(Random::Uniform(2.0, 12.0));
+
+  auto heading = [](float angle) { return Location(std::cos(angle), std::sin(angle), 0.0f); };
+  auto perpendicular = [](const Location &h) { return Location(-h.y, h.x, 0.0f); };
+
+  FrameActor actor;
+  const Location x_boundary = heading(yaw) * half_length;
+  const Location y_boundary = perpendicular(heading(yaw)) * half_width;
+  actor.bbox = {
+      location + x_boundary - y_boundary,
+      location - x_boundary - y_boundary,
+      location - x_boundary + y_boundary,
+      location + x_boundary + y_boundary};
+
+  LocationVector left_boundary;
+  LocationVector right_boundary;
+  Location point = location + x_boundary;
+  for (int i = 0; i < number_of_points; ++i) {
+    const Location side = perpendicular(heading(yaw)) * half_width;
+    left_boundary.push_back(point + side);
+    right_boundary.push_back(point - side);
+    point += heading(yaw) * 4.0f;
+    yaw += curvature * 4.0f;
+  }
+  std::reverse(right_boundary.begin(), right_boundary.end());
+  actor.geodesic.insert(actor.geodesic.end(), right_boundary.begin(), right_boundary.end());
+  actor.geodesic.insert(actor.geodesic.end(), actor.bbox.begin(), actor.bbox.end());
+  actor.geodesic.insert(actor.geodesic.end(), left_boundary.begin(), left_boundary.end());
+  return actor;
+}
+
+TEST(collision_geometry, distance) {
+  const LocationVector square = {{0.0f, 0.0f, 0.0f}, {0.0f, 2.0f, 0.0f}, {2.0f, 2.0f, 0.0f}, {2.0f, 0.0f, 0.0f}};
+  const LocationVector apart = {{5.0f, 0.0f, 0.0f}, {5.0f, 2.0f, 0.0f}, {7.0f, 2.0f, 0.0f}, {7.0f, 0.0f, 0.0f}};
+  const LocationVector inside = {{0.5f, 0.5f, 0.0f}, {0.5f, 1.5f, 0.0f}, {1.5f, 1.5f, 0.0f}, {1.5f, 0.5f, 0.0f}};
+  const LocationVector cross = {{-1.0f, 0.9f, 0.0f}, {-1.0f, 1.1f, 0.0f}, {3.0f, 1.1f, 0.0f}, {3.0f, 0.9f, 0.0f}};
+  const BoundaryPolygon square_polygon(square);
+  ASSERT_DOUBLE_EQ(square_polygon.Distance(BoundaryPolygon(apart)), 3.0);
+  ASSERT_DOUBLE_EQ(square_polygon.BoundingBoxDistance(BoundaryPolygon(apart)), 3.0);
+  ASSERT_DOUBLE_EQ(square_polygon.Distance(BoundaryPolygon(inside)), 0.0);
+  ASSERT_DOUBLE_EQ(BoundaryPolygon(inside).Distance(square_polygon), 0.0);
+  ASSERT_DOUBLE_EQ(square_polygon.Distance(BoundaryPolygon(cross)), 0.0);
+  ASSERT_DOUBLE_EQ(square_polygon.Distance(square_polygon), 0.0);
+}
+
+// Replays synthetic frames of vehicles with curved paths and checks that the
+// comparisons of the collision stage, with the broad phase and the distance
+// kernel, lead to the same hazard decisions as boost::geometry.
+TEST(collision_geometry, replay_frames) {
+  constexpr auto number_of_frames = 5u;
+  constexpr auto actors_per_frame = 150u;
+  constexpr float area_size = 150.0f;
+
+  std::size_t number_of_pairs = 0u;
+  std::size_t broad_phase_rejections = 0u;
+  std::size_t hazards = 0u;
+
+  for (auto frame = 0u; frame < number_of_frames; ++frame) {
+    std::vector<FrameActor> actors;
+    for (auto i = 0u; i < actors_per_frame; ++i) {
+      actors.push_back(make_actor(area_size));
+    }
+
+    for (auto i = 0u; i < actors.size(); ++i) {
+      for (auto j = i + 1u; j < actors.size(); ++j) {
+        const FrameActor &reference = actors[i];
+        const FrameActor &other = actors[j];
+        ++number_of_pairs;
+
+        const Polygon reference_polygon = make_boost_polygon(reference.bbox);
+        const Polygon other_polygon = make_boost_polygon(other.bbox);
+        const Polygon reference_geodesic_polygon = make_boost_polygon(reference.geodesic);
+        const Polygon other_geodesic_polygon = make_boost_polygon(other.geodesic);
+        const GeometryComparison expected = {
+            bg::distance(reference_polygon, other_geodesic_polygon),
+            bg::distance(other_polygon, reference_geodesic_polygon),
+            bg::distance(reference_geodesic_polygon, other_geodesic_polygon),
+            bg::distance(reference_polygon, other_polygon)};
+
+        const BoundaryPolygon reference_bbox(reference.bbox);
+        const BoundaryPolygon reference_geodesic(reference.geodesic);
+        const BoundaryPolygon other_bbox(other.bbox);
+        const BoundaryPolygon other_geodesic(other.geodesic);
+        const GeometryComparison result = carla::traffic_manager::CompareGeometry(
+            reference_bbox, reference_geodesic, other_bbox, other_geodesic);
+
+        const double bounding_box_distance = reference_geodesic.BoundingBoxDistance(other_geodesic);
+        if (bounding_box_distance >= OVERLAP_THRESHOLD) {
+          ++broad_phase_rejections;
+          ASSERT_DOUBLE_EQ(result.inter_geodesic_distance, bounding_box_distance);
+          ASSERT_LE(bounding_box_distance, expected.inter_geodesic_distance + 1e-9);
+        } else {
+          ASSERT_NEAR(result.reference_vehicle_to_other_geodesic, expected.reference_vehicle_to_other_geodesic, 1e-6);
+          ASSERT_NEAR(result.other_vehicle_to_reference_geodesic, expected.other_vehicle_to_reference_geodesic, 1e-6);
+          ASSERT_NEAR(result.inter_geodesic_distance, expected.inter_geodesic_distance, 1e-6);
+          ASSERT_NEAR(result.inter_bbox_distance, expected.inter_bbox_distance, 1e-6);
+        }
+        bool hazard = false;
+        for (const bool ego_angular_priority : {false, true}) {
+          const bool expected_hazard = carla::traffic_manager::IsCollisionHazard(expected, ego_angular_priority);
+          ASSERT_EQ(carla::traffic_manager::IsCollisionHazard(result, ego_angular_priority), expected_hazard);
+          hazard = hazard || expected_hazard;
+        }
+        hazards += hazard ? 1u : 0u;
+      }
+    }
+  }
+
+  // The frames must exercise both the broad phase and the distance kernel.
+  ASSERT_GT(broad_phase_rejections, 0u);
+  ASSERT_LT(broad_phase_rejections, number_of_pairs);
+  ASSERT_GT(hazards, 0u);
+}
+
+// Replays the collision stage over the frames recorded from the traffic
+// manager stages running on the test towns. The stage must find the same
+// hazards as in the recorded cycles, only its own time is measured.
+TEST(benchmark_collision, replay) {
+  using namespace carla::traffic_manager;
+  using util::TrafficManagerSimulation;
+  constexpr std::size_t number_of_vehicles = 300u;
+  constexpr int number_of_cycles = 50;
+  constexpr uint64_t seed = 42u;
+
+  for (const auto &file : util::OpenDrive::GetAvailableFiles()) {
+    // Recorded buffers point to the waypoints of the local map.
+    const util::LocalMapPtr local_map = util::make_local_map(file);
+    std::vector<TrafficManagerSimulation::CollisionRecord> records;
+    {
+      TrafficManagerSimulation simulation(local_map, number_of_vehicles, seed);
+      simulation.RecordCollisionStage(&records);
+      for (int i = 0; i < number_of_cycles; ++i) {
+        simulation.Tick();
+      }
+    }
+
+    std::vector<ActorId> vehicle_id_list;
+    SimulationState simulation_state;
+    BufferMap buffer_map;
+    TrackTraffic track_traffic;
+    Parameters parameters;
+    CollisionFrame collision_frame;
+    RandomGenerator random_device(seed);
+    CollisionStage collision_stage(vehicle_id_list, simulation_state, buffer_map, track_traffic,
+                                   parameters, collision_frame, random_device);
+
+    std::size_t hazards = 0u;
+    std::chrono::nanoseconds elapsed{0};
+    for (const TrafficManagerSimulation::CollisionRecord &record : records) {
+      vehicle_id_list = record.vehicle_id_list;
+      simulation_state = record.simulation_state;
+      buffer_map = record.buffer_map;
+      track_traffic = record.track_traffic;
+      collision_frame.clear();
+      collision_frame.resize(vehicle_id_list.size());
+
+      carla::StopWatch watch;
+      for (unsigned long index = 0u; index < vehicle_id_list.size(); ++index) {
+        collision_stage.Update(index);
+      }
+      collision_stage.ClearCycleCache();
+      watch.Stop();
+      elapsed += watch.GetDuration();
+
+      ASSERT_EQ(collision_frame.size(), record.collision_frame.size());
+      for (std::size_t i = 0u; i < collision_frame.size(); ++i) {
+        ASSERT_EQ(collision_frame[i].hazard, record.collision_frame[i].hazard) << file;
+        ASSERT_EQ(collision_frame[i].hazard_actor_id, record.collision_frame[i].hazard_actor_id) << file;
+        ASSERT_EQ(collision_frame[i].available_distance_margin, record.collision_frame[i].available_distance_margin) << file;
+        hazards += collision_frame[i].hazard ? 1u : 0u;
+      }
+    }
+    ASSERT_GT(hazards, 0u) << file;
+    carla::logging::log(
+        file, "collision stage:", vehicle_id_list.size(), "vehicles,", hazards, "hazards in", records.size(), "frames,",
+        std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count() / records.size(), "us per frame");
+  }
+}
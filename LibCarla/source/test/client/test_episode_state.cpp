@@ -0,0 +1,75 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+
+#include <carla/client/detail/EpisodeState.h>
+#include <carla/sensor/SensorRegistry.h>
+#include <carla/sensor/data/RawEpisodeState.h>
+#include <carla/sensor/s11n/SensorHeaderSerializer.h>
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+using carla::client::detail::EpisodeState;
+using carla::sensor::SensorRegistry;
+using carla::sensor::data::ActorDynamicState;
+using carla::sensor::data::RawEpisodeState;
+using EpisodeHeader = carla::sensor::s11n::EpisodeStateSerializer::Header;
+using SensorHeader = carla::sensor::s11n::SensorHeaderSerializer::Header;
+
+// Builds the state the episode would receive from the world observer.
+static std::shared_ptr<EpisodeState> make_state(
+    uint64_t frame,
+    const std::vector<carla::ActorId> &actor_ids) {
+  SensorHeader sensor_header{
+      SensorRegistry::get<FWorldObserver *>::index, frame, 0.0, carla::rpc::Transform()};
+  EpisodeHeader episode_header{1u, 0.0, 0.05f, carla::geom::Vector3DInt()};
+  std::vector<unsigned char> message(
+      sizeof(sensor_header) + sizeof(episode_header) + actor_ids.size() * sizeof(ActorDynamicState));
+  unsigned char *data = message.data();
+  std::memcpy(data, &sensor_header, sizeof(sensor_header));
+  data += sizeof(sensor_header);
+  std::memcpy(data, &episode_header, sizeof(episode_header));
+  data += sizeof(episode_header);
+  for (const carla::ActorId id : actor_ids) {
+    ActorDynamicState actor;
+    std::memset(&actor, 0, sizeof(actor));
+    actor.id = id;
+    std::memcpy(data, &actor, sizeof(actor));
+    data += sizeof(actor);
+  }
+  auto sensor_data = SensorRegistry::Deserialize(carla::Buffer(message));
+  return std::make_shared<EpisodeState>(static_cast<const RawEpisodeState &>(*sensor_data));
+}
+
+static std::vector<carla::ActorId> sorted(std::vector<carla::ActorId> ids) {
+  std::sort(ids.begin(), ids.end());
+  return ids;
+}
+
+TEST(episode_state, actor_delta) {
+  const auto previous = make_state(10u, {1u, 2u, 3u, 4u});
+  const auto next = make_state(11u, {2u, 4u, 5u, 6u});
+  ASSERT_EQ(next->size(), 4u);
+  ASSERT_EQ(next->GetActorDeltaBaseFrame(), 0u);
+  ASSERT_TRUE(next->GetAddedActorIds().empty());
+  ASSERT_TRUE(next->GetRemovedActorIds().empty());
+
+  next->SetActorDelta(*previous);
+  ASSERT_EQ(next->GetActorDeltaBaseFrame(), 10u);
+  // Actors 2 and 4 are in both states and show in neither list.
+  ASSERT_EQ(sorted(next->GetAddedActorIds()), (std::vector<carla::ActorId>{5u, 6u}));
+  ASSERT_EQ(sorted(next->GetRemovedActorIds()), (std::vector<carla::ActorId>{1u, 3u}));
+
+  // A state with the same actors has an empty delta.
+  const auto same = make_state(12u, {2u, 4u, 5u, 6u});
+  same->SetActorDelta(*next);
+  ASSERT_EQ(same->GetActorDeltaBaseFrame(), 11u);
+  ASSERT_TRUE(same->GetAddedActorIds().empty());
+  ASSERT_TRUE(same->GetRemovedActorIds().empty());
+}
@@ -0,0 +1,263 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+
+#include <carla/ThreadGroup.h>
+#include <carla/client/detail/FrameSynchronizer.h>
+#include <carla/sensor/SensorData.h>
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using carla::client::detail::FrameSynchronizer;
+using namespace std::chrono_literals;
+
+namespace {
+
+  class FakeSensorData : public carla::sensor::SensorData {
+  public:
+
+    explicit FakeSensorData(size_t frame)
+      : SensorData(frame, 0.0, carla::rpc::Transform{}) {}
+  };
+
+} // namespace
+
+static auto make_data(size_t frame) {
+  return carla::MakeShared<FakeSensorData>(frame);
+}
+
+static FrameSynchronizer::Settings make_settings(
+    size_t max_pending_frames,
+    FrameSynchronizer::MissingFramePolicy policy = FrameSynchronizer::MissingFramePolicy::Drop) {
+  FrameSynchronizer::Settings settings;
+  settings.max_pending_frames = max_pending_frames;
+  settings.missing_frame_policy = policy;
+  return settings;
+}
+
+TEST(frame_synchronizer, complete_frames_in_order) {
+  FrameSynchronizer synchronizer(3u, make_settings(8u));
+  for (auto frame = 10u; frame < 15u; ++frame) {
+    synchronizer.Push(2u, make_data(frame));
+    synchronizer.Push(0u, make_data(frame));
+    ASSERT_EQ(synchronizer.GetStatistics().complete, frame - 10u);
+    synchronizer.Push(1u, make_data(frame));
+  }
+  for (auto frame = 10u; frame < 15u; ++frame) {
+    auto bundle = synchronizer.Get(0ms);
+    ASSERT_NE(bundle, nullptr);
+    ASSERT_EQ(bundle->frame, frame);
+    ASSERT_TRUE(bundle->is_complete);
+    ASSERT_EQ(bundle->data.size(), 3u);
+    for (auto &data : bundle->data) {
+      ASSERT_NE(data, nullptr);
+      ASSERT_EQ(data->GetFrame(), frame);
+    }
+  }
+  ASSERT_EQ(synchronizer.Get(0ms), nullptr);
+}
+
+TEST(frame_synchronizer, missing_frame_dropped) {
+  FrameSynchronizer synchronizer(2u, make_settings(8u));
+  synchronizer.Push(0u, make_data(1u));
+  synchronizer.Push(1u, make_data(1u));
+  synchronizer.Push(0u, make_data(2u));
+  // Stream 1 skips frame 2, nothing to decide until it moves past it.
+  ASSERT_EQ(synchronizer.GetStatistics().dropped, 0u);
+  synchronizer.Push(1u, make_data(3u));
+  ASSERT_EQ(synchronizer.GetStatistics().dropped, 1u);
+  synchronizer.Push(0u, make_data(3u));
+  ASSERT_EQ(synchronizer.Get(0ms)->frame, 1u);
+  ASSERT_EQ(synchronizer.Get(0ms)->frame, 3u);
+  const auto stats = synchronizer.GetStatistics();
+  ASSERT_EQ(stats.complete, 2u);
+  ASSERT_EQ(stats.partial, 0u);
+}
+
+TEST(frame_synchronizer, missing_frame_partial) {
+  FrameSynchronizer synchronizer(
+      2u,
+      make_settings(8u, FrameSynchronizer::MissingFramePolicy::DeliverPartial));
+  synchronizer.Push(0u, make_data(1u));
+  synchronizer.Push(1u, make_data(2u));
+  synchronizer.Push(0u, make_data(2u));
+  auto bundle = synchronizer.Get(0ms);
+  ASSERT_EQ(bundle->frame, 1u);
+  ASSERT_FALSE(bundle->is_complete);
+  ASSERT_NE(bundle->data[0u], nullptr);
+  ASSERT_EQ(bundle->data[1u], nullptr);
+  bundle = synchronizer.Get(0ms);
+  ASSERT_EQ(bundle->frame, 2u);
+  ASSERT_TRUE(bundle->is_complete);
+  const auto stats = synchronizer.GetStatistics();
+  ASSERT_EQ(stats.complete, 1u);
+  ASSERT_EQ(stats.partial, 1u);
+}
+
+TEST(frame_synchronizer, stalled_stream_and_late_data) {
+  FrameSynchronizer synchronizer(2u, make_settings(4u));
+  std::vector<uint64_t> frames;
+  synchronizer.SetCallback([&](auto bundle) { frames.emplace_back(bundle->frame); });
+  synchronizer.Push(1u, make_data(1u));
+  // Stream 1 stalls, stream 0 runs ahead until the window is exhausted.
+  for (auto frame = 1u; frame <= 6u; ++frame) {
+    synchronizer.Push(0u, make_data(frame));
+  }
+  auto stats = synchronizer.GetStatistics();
+  ASSERT_EQ(stats.complete, 1u);
+  ASSERT_EQ(stats.dropped, 1u);
+  // Frame 2 is closed, stream 1 is late for it.
+  synchronizer.Push(1u, make_data(2u));
+  ASSERT_EQ(synchronizer.GetStatistics().late, 1u);
+  for (auto frame = 3u; frame <= 6u; ++frame) {
+    synchronizer.Push(1u, make_data(frame));
+  }
+  stats = synchronizer.GetStatistics();
+  ASSERT_EQ(stats.complete, 5u);
+  ASSERT_EQ(stats.dropped, 1u);
+  ASSERT_EQ(frames, (std::vector<uint64_t>{1u, 3u, 4u, 5u, 6u}));
+}
+
+TEST(frame_synchronizer, get_frame) {
+  FrameSynchronizer synchronizer(1u, make_settings(8u));
+  for (auto frame = 1u; frame <= 5u; ++frame) {
+    synchronizer.Push(0u, make_data(frame));
+  }
+  auto bundle = synchronizer.Get(3u, 0ms);
+  ASSERT_NE(bundle, nullptr);
+  ASSERT_EQ(bundle->frame, 3u);
+  ASSERT_EQ(synchronizer.Get(0ms)->frame, 4u);
+  // Already retrieved.
+  ASSERT_EQ(synchronizer.Get(2u, 0ms), nullptr);
+  // Waits for the frame to arrive.
+  carla::ThreadGroup threads;
+  threads.CreateThread([&]() {
+    std::this_thread::sleep_for(10ms);
+    synchronizer.Push(0u, make_data(6u));
+  });
+  bundle = synchronizer.Get(6u, 10s);
+  ASSERT_NE(bundle, nullptr);
+  ASSERT_EQ(bundle->frame, 6u);
+  ASSERT_EQ(synchronizer.Get(7u, 1ms), nullptr);
+}
+
+TEST(frame_synchronizer, queue_is_bounded) {
+  FrameSynchronizer synchronizer(1u, make_settings(4u));
+  for (auto frame = 0u; frame < 10u; ++frame) {
+    synchronizer.Push(0u, make_data(frame));
+  }
+  ASSERT_EQ(synchronizer.GetStatistics().dropped, 6u);
+  ASSERT_EQ(synchronizer.Get(0ms)->frame, 6u);
+  synchronizer.Reset();
+  ASSERT_EQ(synchronizer.Get(0ms), nullptr);
+  synchronizer.Push(0u, make_data(3u));
+  ASSERT_EQ(synchronizer.Get(0ms)->frame, 3u);
+}
+
+TEST(frame_synchronizer, concurrent_streams) {
+  constexpr auto number_of_streams = 4u;
+  constexpr auto number_of_frames = 2000u;
+  FrameSynchronizer synchronizer(number_of_streams, make_settings(number_of_frames));
+  std::atomic_size_t received{0u};
+  std::atomic_size_t out_of_order{0u};
+  uint64_t last_frame = 0u;
+  synchronizer.SetCallback([&](auto bundle) {
+    if (!bundle->is_complete || (bundle->frame != last_frame + 1u)) {
+      ++out_of_order;
+    }
+    last_frame = bundle->frame;
+    ++received;
+  });
+  // Push the first frame to start from a known frame.
+  for (auto i = 0u; i < number_of_streams; ++i) {
+    synchronizer.Push(i, make_data(0u));
+  }
+  {
+    carla::ThreadGroup threads;
+    for (auto i = 0u; i < number_of_streams; ++i) {
+      threads.CreateThread([&synchronizer, i]() {
+        for (auto frame = 1u; frame <= number_of_frames; ++frame) {
+          synchronizer.Push(i, make_data(frame));
+        }
+      });
+    }
+  }
+  ASSERT_EQ(received, number_of_frames + 1u);
+  ASSERT_EQ(out_of_order, 1u); // Frame zero.
+  const auto stats = synchronizer.GetStatistics();
+  ASSERT_EQ(stats.complete, number_of_frames + 1u);
+  ASSERT_EQ(stats.dropped + stats.partial + stats.late, 0u);
+}
+
+TEST(frame_synchronizer, callback_runs_without_lock) {
+  FrameSynchronizer synchronizer(1u, make_settings(8u));
+  // Stands for the Python GIL, held by the thread changing the callback and
+  // needed by the callback.
+  std::mutex gil;
+  std::atomic_bool is_in_callback{false};
+  std::vector<uint64_t> frames;
+  synchronizer.SetCallback([&](auto bundle) {
+    is_in_callback = true;
+    std::lock_guard<std::mutex> lock(gil);
+    frames.emplace_back(bundle->frame);
+  });
+  std::unique_lock<std::mutex> lock(gil);
+  {
+    carla::ThreadGroup threads;
+    threads.CreateThread([&]() { synchronizer.Push(0u, make_data(1u)); });
+    while (!is_in_callback) {
+      std::this_thread::yield();
+    }
+    // Would deadlock if the callback was called holding the lock.
+    synchronizer.SetCallback([&](auto bundle) { frames.emplace_back(bundle->frame); });
+    lock.unlock();
+  }
+  synchronizer.Push(0u, make_data(2u));
+  ASSERT_EQ(frames, (std::vector<uint64_t>{1u, 2u}));
+}
+
+TEST(frame_synchronizer, data_is_delivered_or_late) {
+  constexpr auto number_of_streams = 4u;
+  constexpr auto number_of_frames = 20000u;
+  // A window this small makes the streams running ahead force frames closed
+  // while the others are still writing them.
+  FrameSynchronizer synchronizer(
+      number_of_streams,
+      make_settings(2u, FrameSynchronizer::MissingFramePolicy::DeliverPartial));
+  std::atomic_size_t delivered{0u};
+  synchronizer.SetCallback([&](auto bundle) {
+    for (auto &data : bundle->data) {
+      if (data != nullptr) {
+        ASSERT_EQ(data->GetFrame(), bundle->frame);
+        ++delivered;
+      }
+    }
+  });
+  for (auto i = 0u; i < number_of_streams; ++i) {
+    synchronizer.Push(i, make_data(0u));
+  }
+  {
+    carla::ThreadGroup threads;
+    for (auto i = 0u; i < number_of_streams; ++i) {
+      threads.CreateThread([&synchronizer, i]() {
+        for (auto frame = 1u; frame <= number_of_frames; ++frame) {
+          synchronizer.Push(i, make_data(frame));
+        }
+      });
+    }
+  }
+  // One more frame from every stream closes every frame before it.
+  for (auto i = 0u; i < number_of_streams; ++i) {
+    synchronizer.Push(i, make_data(number_of_frames + 1u));
+  }
+  const auto stats = synchronizer.GetStatistics();
+  ASSERT_EQ(stats.dropped, 0u);
+  ASSERT_EQ(delivered + stats.late, (number_of_frames + 2u) * number_of_streams);
+}
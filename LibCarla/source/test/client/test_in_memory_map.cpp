@@ -0,0 +1,201 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+#include "OpenDrive.h"
+
+#include <carla/StopWatch.h>
+#include <carla/client/Map.h>
+#include <carla/trafficmanager/InMemoryMap.h>
+#include <carla/trafficmanager/InMemoryMapRegistry.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <future>
+#include <iterator>
+#include <thread>
+#include <vector>
+
+using carla::traffic_manager::InMemoryMap;
+
+static std::vector<char> read_file(const std::string &filename) {
+  std::ifstream file(filename, std::ios::binary);
+  return std::vector<char>{std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+}
+
+// Builds the local map of every town serially and on all the available
+// threads, and checks that both produce the same cache byte for byte.
+TEST(in_memory_map, parallel_set_up) {
+  const std::size_t number_of_threads = std::max(1u, std::thread::hardware_concurrency());
+  for (const auto &file : util::OpenDrive::GetAvailableFiles()) {
+    auto map = carla::MakeShared<carla::client::Map>(file, util::OpenDrive::Load(file));
+
+    InMemoryMap serial_map(map);
+    serial_map.SetUp(1u);
+
+    InMemoryMap parallel_map(map);
+    parallel_map.SetUp(number_of_threads);
+
+    const std::string serial_filename = file + ".serial.bin";
+    const std::string parallel_filename = file + ".parallel.bin";
+    serial_map.Save(serial_filename);
+    parallel_map.Save(parallel_filename);
+    const std::vector<char> serial_content = read_file(serial_filename);
+    const std::vector<char> parallel_content = read_file(parallel_filename);
+    std::remove(serial_filename.c_str());
+    std::remove(parallel_filename.c_str());
+
+    ASSERT_EQ(serial_map.GetDenseTopology().size(), parallel_map.GetDenseTopology().size()) << file;
+    ASSERT_TRUE(serial_content == parallel_content) << file;
+  }
+}
+
+// Startup cost of building the local map of every town serially and on all
+// the available threads.
+TEST(benchmark_in_memory_map, set_up) {
+  const std::size_t number_of_threads = std::max(1u, std::thread::hardware_concurrency());
+  for (const auto &file : util::OpenDrive::GetAvailableFiles()) {
+    auto map = carla::MakeShared<carla::client::Map>(file, util::OpenDrive::Load(file));
+    for (const std::size_t threads : {std::size_t(1u), number_of_threads}) {
+      InMemoryMap local_map(map);
+      carla::StopWatch watch;
+      local_map.SetUp(threads);
+      watch.Stop();
+      carla::logging::log(
+          file, ":", local_map.GetDenseTopology().size(), "waypoints,",
+          threads, "threads", watch.GetElapsedTime<std::chrono::milliseconds>(), "ms");
+    }
+  }
+}
+
+// Loads the saved cache of every town and checks that it restores the same
+// waypoints, transforms and links that were built from the road map.
+TEST(in_memory_map, save_and_load) {
+  for (const auto &file : util::OpenDrive::GetAvailableFiles()) {
+    auto map = carla::MakeShared<carla::client::Map>(file, util::OpenDrive::Load(file));
+    InMemoryMap built_map(map);
+    built_map.SetUp();
+
+    const std::string filename = file + ".cache.bin";
+    built_map.Save(filename);
+    InMemoryMap loaded_map(map);
+    const bool loaded = loaded_map.Load(filename);
+    // A cache is only valid for the OpenDRIVE it was built from.
+    auto edited_map = carla::MakeShared<carla::client::Map>(file, util::OpenDrive::Load(file) + " ");
+    const bool loaded_edited = InMemoryMap(edited_map).Load(filename);
+    std::remove(filename.c_str());
+    ASSERT_TRUE(loaded) << file;
+    ASSERT_FALSE(loaded_edited) << file;
+
+    const auto &built = built_map.GetDenseTopology();
+    const auto &restored = loaded_map.GetDenseTopology();
+    ASSERT_EQ(built.size(), restored.size()) << file;
+    auto indices = [](const std::vector<carla::traffic_manager::SimpleWaypointPtr> &waypoints) {
+      std::vector<uint32_t> result;
+      for (const auto &waypoint : waypoints) {
+        result.push_back(waypoint->GetIndex());
+      }
+      return result;
+    };
+    for (std::size_t i = 0u; i < built.size(); ++i) {
+      const auto expected = built[i]->GetWaypoint();
+      const auto actual = restored[i]->GetWaypoint();
+      ASSERT_EQ(expected->GetRoadId(), actual->GetRoadId()) << file;
+      ASSERT_EQ(expected->GetSectionId(), actual->GetSectionId()) << file;
+      ASSERT_EQ(expected->GetLaneId(), actual->GetLaneId()) << file;
+      ASSERT_EQ(expected->GetTransform(), actual->GetTransform()) << file;
+      ASSERT_EQ(indices(built[i]->GetNextWaypoint()), indices(restored[i]->GetNextWaypoint())) << file;
+      ASSERT_EQ(indices(built[i]->GetPreviousWaypoint()), indices(restored[i]->GetPreviousWaypoint())) << file;
+    }
+  }
+}
+
+// Traffic managers attached to the same map share its local map, which is
+// built only once and released with its last reference.
+TEST(in_memory_map, shared_registry) {
+  using carla::traffic_manager::InMemoryMapRegistry;
+  const auto files = util::OpenDrive::GetAvailableFiles();
+  ASSERT_FALSE(files.empty());
+  auto map = carla::MakeShared<carla::client::Map>(files[0], util::OpenDrive::Load(files[0]));
+  std::size_t number_of_builds = 0u;
+  auto builder = [&]() {
+    ++number_of_builds;
+    auto local_map = std::make_shared<InMemoryMap>(map);
+    local_map->SetUp();
+    return local_map;
+  };
+
+  const std::size_t initial_size = InMemoryMapRegistry::Size();
+  auto first = InMemoryMapRegistry::Get(*map, builder);
+  auto second = InMemoryMapRegistry::Get(*map, builder);
+  ASSERT_EQ(first, second);
+  ASSERT_EQ(number_of_builds, 1u);
+  ASSERT_EQ(InMemoryMapRegistry::Size(), initial_size + 1u);
+
+  // A map with the same name but a different content is not shared.
+  auto other_map = carla::MakeShared<carla::client::Map>(files[0], util::OpenDrive::Load(files[0]) + " ");
+  auto other = InMemoryMapRegistry::Get(*other_map, [&]() {
+    ++number_of_builds;
+    auto local_map = std::make_shared<InMemoryMap>(other_map);
+    local_map->SetUp();
+    return local_map;
+  });
+  ASSERT_NE(first, other);
+  ASSERT_EQ(number_of_builds, 2u);
+
+  first.reset();
+  second.reset();
+  other.reset();
+  ASSERT_EQ(InMemoryMapRegistry::Size(), initial_size);
+  InMemoryMapRegistry::Get(*map, builder);
+  ASSERT_EQ(number_of_builds, 3u);
+}
+
+TEST(in_memory_map, registry_builds_outside_lock) {
+  using carla::traffic_manager::InMemoryMapRegistry;
+  using namespace std::chrono_literals;
+  const auto files = util::OpenDrive::GetAvailableFiles();
+  ASSERT_FALSE(files.empty());
+  auto map = carla::MakeShared<carla::client::Map>(files[0], util::OpenDrive::Load(files[0]));
+
+  std::promise<void> first_building;
+  std::promise<void> other_built;
+  auto other_built_future = other_built.get_future();
+  std::atomic_size_t number_of_builds{0u};
+  auto first = std::async(std::launch::async, [&]() {
+    return InMemoryMapRegistry::Get("registry_test_first", [&]() {
+      ++number_of_builds;
+      first_building.set_value();
+      // Would never be ready if the registry was locked while building.
+      EXPECT_EQ(other_built_future.wait_for(5s), std::future_status::ready);
+      return std::make_shared<InMemoryMap>(map);
+    });
+  });
+  first_building.get_future().wait();
+
+  // Requests for the same map wait for the build in progress.
+  auto same = std::async(std::launch::async, [&]() {
+    return InMemoryMapRegistry::Get("registry_test_first", [&]() {
+      ++number_of_builds;
+      return std::make_shared<InMemoryMap>(map);
+    });
+  });
+
+  // Other maps are built meanwhile.
+  auto other = InMemoryMapRegistry::Get("registry_test_other", [&]() {
+    return std::make_shared<InMemoryMap>(map);
+  });
+  ASSERT_NE(other, nullptr);
+  other_built.set_value();
+
+  auto first_map = first.get();
+  ASSERT_NE(first_map, nullptr);
+  ASSERT_EQ(same.get(), first_map);
+  ASSERT_NE(first_map, other);
+  ASSERT_EQ(number_of_builds, 1u);
+}
@@ -0,0 +1,230 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+
+#include <carla/StopWatch.h>
+#include <carla/trafficmanager/CachedSimpleWaypoint.h>
+#include <carla/trafficmanager/InMemoryMapCache.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <unordered_map>
+#include <vector>
+
+using namespace carla::traffic_manager;
+using map_cache::WaypointRecord;
+
+using LinkList = std::vector<std::vector<uint32_t>>;
+
+static const InMemoryMapCache::OpenDriveKey OPENDRIVE_KEY = {0x0123456789ABCDEFull, 4096u};
+
+// Dense topology made of parallel lanes of consecutive waypoints, where every
+// waypoint links to the next one and to its neighbour lanes.
+struct Topology {
+  std::vector<WaypointRecord> records;
+  LinkList next;
+  LinkList previous;
+};
+
+static Topology make_topology(uint32_t number_of_lanes, uint32_t lane_length) {
+  Topology topology;
+  const uint32_t size = number_of_lanes * lane_length;
+  topology.next.resize(size);
+  topology.previous.resize(size);
+  for (uint32_t lane = 0u; lane < number_of_lanes; ++lane) {
+    for (uint32_t i = 0u; i < lane_length; ++i) {
+      const uint32_t index = lane * lane_length + i;
+      WaypointRecord record;
+      std::memset(&record, 0, sizeof(record));
+      record.road_id = lane / 4u;
+      record.lane_id = -static_cast<int32_t>(lane % 4u) - 1;
+      record.s = 2.0f * static_cast<float>(i);
+      record.x = record.s;
+      record.y = 3.5f * static_cast<float>(lane);
+      record.yaw = lane % 2u == 0u ? 0.0f : 180.0f;
+      record.geodesic_grid_id = static_cast<int32_t>(index / 10u);
+      record.left_index = lane % 4u > 0u ? index - lane_length : map_cache::INVALID_INDEX;
+      record.right_index = lane % 4u < 3u && lane + 1u < number_of_lanes ? index + lane_length : map_cache::INVALID_INDEX;
+      record.road_option = static_cast<uint8_t>(RoadOption::LaneFollow);
+      topology.records.push_back(record);
+      if (i + 1u < lane_length) {
+        topology.next[index].push_back(index + 1u);
+        topology.previous[index + 1u].push_back(index);
+      }
+    }
+  }
+  return topology;
+}
+
+static void check_topology(const InMemoryMapCache &cache, const Topology &topology) {
+  ASSERT_EQ(cache.GetWaypointCount(), topology.records.size());
+  for (uint32_t i = 0u; i < cache.GetWaypointCount(); ++i) {
+    const WaypointRecord &record = cache.GetRecord(i);
+    ASSERT_EQ(std::memcmp(&record, &topology.records[i], sizeof(record)), 0);
+    const std::vector<uint32_t> next(cache.GetNext(i).begin(), cache.GetNext(i).end());
+    const std::vector<uint32_t> previous(cache.GetPrevious(i).begin(), cache.GetPrevious(i).end());
+    ASSERT_EQ(next, topology.next[i]);
+    ASSERT_EQ(previous, topology.previous[i]);
+  }
+}
+
+TEST(in_memory_map_cache, round_trip) {
+  const Topology topology = make_topology(8u, 50u);
+  const std::vector<uint8_t> content = InMemoryMapCache::Serialize(topology.records, topology.next, topology.previous, OPENDRIVE_KEY);
+  ASSERT_TRUE(InMemoryMapCache::HasCacheHeader(content.data(), content.size()));
+
+  InMemoryMapCache cache;
+  ASSERT_TRUE(cache.Open(content.data(), content.size(), OPENDRIVE_KEY));
+  check_topology(cache, topology);
+}
+
+TEST(in_memory_map_cache, mapped_file) {
+  const Topology topology = make_topology(4u, 100u);
+  const std::vector<uint8_t> content = InMemoryMapCache::Serialize(topology.records, topology.next, topology.previous, OPENDRIVE_KEY);
+  const std::string filename = "test_in_memory_map_cache.bin";
+  {
+    std::ofstream out_file(filename, std::ios::binary);
+    out_file.write(reinterpret_cast<const char *>(content.data()), static_cast<std::streamsize>(content.size()));
+  }
+
+  InMemoryMapCache cache;
+  ASSERT_TRUE(cache.Open(filename, OPENDRIVE_KEY));
+  check_topology(cache, topology);
+  ASSERT_FALSE(InMemoryMapCache().Open(filename + ".missing", OPENDRIVE_KEY));
+  std::remove(filename.c_str());
+}
+
+TEST(in_memory_map_cache, rejects_invalid_content) {
+  const Topology topology = make_topology(4u, 20u);
+  const std::vector<uint8_t> content = InMemoryMapCache::Serialize(topology.records, topology.next, topology.previous, OPENDRIVE_KEY);
+  InMemoryMapCache cache;
+
+  // Corrupted payload.
+  std::vector<uint8_t> corrupted = content;
+  corrupted[sizeof(map_cache::Header) + 5u] ^= 0xFFu;
+  ASSERT_FALSE(cache.Open(corrupted.data(), corrupted.size(), OPENDRIVE_KEY));
+
+  // Truncated payload.
+  ASSERT_FALSE(cache.Open(content.data(), content.size() - 4u, OPENDRIVE_KEY));
+
+  // Newer version.
+  std::vector<uint8_t> newer = content;
+  const uint32_t version = map_cache::VERSION + 1u;
+  std::memcpy(newer.data() + offsetof(map_cache::Header, version), &version, sizeof(version));
+  ASSERT_FALSE(cache.Open(newer.data(), newer.size(), OPENDRIVE_KEY));
+
+  // Built from another OpenDRIVE.
+  ASSERT_FALSE(cache.Open(content.data(), content.size(), {OPENDRIVE_KEY.hash + 1u, OPENDRIVE_KEY.size}));
+  ASSERT_FALSE(cache.Open(content.data(), content.size(), {OPENDRIVE_KEY.hash, OPENDRIVE_KEY.size + 1u}));
+
+  // Older format.
+  const std::vector<uint8_t> legacy(64u, 0u);
+  ASSERT_FALSE(InMemoryMapCache::HasCacheHeader(legacy.data(), legacy.size()));
+  ASSERT_FALSE(cache.Open(legacy.data(), legacy.size(), OPENDRIVE_KEY));
+}
+
+TEST(in_memory_map_cache, versioned_filename) {
+  const std::string version = std::to_string(map_cache::VERSION);
+  ASSERT_EQ(InMemoryMapCache::GetVersionedFilename("Town01.bin"), "Town01.v" + version + ".bin");
+  ASSERT_EQ(InMemoryMapCache::GetVersionedFilename("a.b/TM/Town01.bin"), "a.b/TM/Town01.v" + version + ".bin");
+  ASSERT_EQ(InMemoryMapCache::GetVersionedFilename("a.b/TM/Town01"), "a.b/TM/Town01.v" + version);
+}
+
+// Writes the topology in the format of CachedSimpleWaypoint, where links are
+// waypoint ids.
+static std::vector<uint8_t> make_legacy_content(const Topology &topology) {
+  std::vector<uint8_t> content;
+  auto append = [&content](const auto &value) {
+    const auto *bytes = reinterpret_cast<const uint8_t *>(&value);
+    content.insert(content.end(), bytes, bytes + sizeof(value));
+  };
+  auto id_of = [](uint32_t index) { return static_cast<uint64_t>(index) + 1u; };
+  append(static_cast<uint32_t>(topology.records.size()));
+  for (uint32_t i = 0u; i < topology.records.size(); ++i) {
+    const WaypointRecord &record = topology.records[i];
+    append(id_of(i));
+    append(record.road_id);
+    append(record.section_id);
+    append(record.lane_id);
+    append(record.s);
+    append(static_cast<uint16_t>(topology.next[i].size()));
+    for (uint32_t index : topology.next[i]) {
+      append(id_of(index));
+    }
+    append(static_cast<uint16_t>(topology.previous[i].size()));
+    for (uint32_t index : topology.previous[i]) {
+      append(id_of(index));
+    }
+    append(record.left_index != map_cache::INVALID_INDEX ? id_of(record.left_index) : uint64_t(0u));
+    append(record.right_index != map_cache::INVALID_INDEX ? id_of(record.right_index) : uint64_t(0u));
+    append(record.geodesic_grid_id);
+    append(record.is_junction != 0u);
+    append(record.road_option);
+  }
+  return content;
+}
+
+// Compares the map independent part of loading a cache: parsing the older
+// format and resolving its ids, against validating a cache in the current
+// format and walking its links. Creating the road waypoints depends on the
+// map and is not measured here.
+TEST(benchmark_in_memory_map_cache, load) {
+  // Several times the number of waypoints of Town10.
+  const Topology topology = make_topology(400u, 500u);
+  const std::vector<uint8_t> legacy = make_legacy_content(topology);
+  const std::vector<uint8_t> content = InMemoryMapCache::Serialize(topology.records, topology.next, topology.previous, OPENDRIVE_KEY);
+
+  uint64_t legacy_links = 0u;
+  carla::StopWatch legacy_watch;
+  {
+    unsigned long pos = 0u;
+    uint32_t total;
+    std::memcpy(&total, &legacy[pos], sizeof(total));
+    pos += sizeof(total);
+    std::vector<CachedSimpleWaypoint> cached_waypoints;
+    std::unordered_map<uint64_t, uint32_t> id2index;
+    for (uint32_t i = 0u; i < total; ++i) {
+      CachedSimpleWaypoint cached_wp;
+      cached_wp.Read(legacy, pos);
+      cached_waypoints.push_back(cached_wp);
+      id2index.insert({cached_wp.waypoint_id, i});
+    }
+    for (const CachedSimpleWaypoint &cached_wp : cached_waypoints) {
+      for (uint64_t id : cached_wp.next_waypoints) {
+        legacy_links += id2index.at(id);
+      }
+      for (uint64_t id : cached_wp.previous_waypoints) {
+        legacy_links += id2index.at(id);
+      }
+    }
+  }
+  legacy_watch.Stop();
+
+  uint64_t cache_links = 0u;
+  carla::StopWatch cache_watch;
+  {
+    InMemoryMapCache cache;
+    ASSERT_TRUE(cache.Open(content.data(), content.size(), OPENDRIVE_KEY));
+    for (uint32_t i = 0u; i < cache.GetWaypointCount(); ++i) {
+      for (uint32_t index : cache.GetNext(i)) {
+        cache_links += index;
+      }
+      for (uint32_t index : cache.GetPrevious(i)) {
+        cache_links += index;
+      }
+    }
+  }
+  cache_watch.Stop();
+
+  ASSERT_EQ(legacy_links, cache_links);
+  carla::logging::log(
+      "in memory map cache with", topology.records.size(), "waypoints:",
+      "older format", legacy.size(), "bytes,", legacy_watch.GetElapsedTime<std::chrono::microseconds>(), "us;",
+      "current format", content.size(), "bytes,", cache_watch.GetElapsedTime<std::chrono::microseconds>(), "us");
+}
@@ -13,9 +13,13 @@
 #include <carla/geom/Location.h>
 #include <carla/geom/Math.h>
 #include <carla/opendrive/OpenDriveParser.h>
+#include <carla/road/InformationSet.h>
 #include <carla/road/MapBuilder.h>
 #include <carla/road/element/RoadInfoElevation.h>
 #include <carla/road/element/RoadInfoGeometry.h>
+#include <carla/road/element/RoadInfoIterator.h>
+#include <carla/road/element/RoadInfoLaneOffset.h>
+#include <carla/road/element/RoadInfoLaneWidth.h>
 #include <carla/road/element/RoadInfoMarkRecord.h>
 #include <carla/road/element/RoadInfoVisitor.h>
 
@@ -222,6 +226,97 @@ static void test_road_links(boost::optional<Map>& map) {
   }
 }
 
+// Every info carries its creation order in the "a" coefficient so the infos
+// of the indexed set can be matched against their copies in the plain set.
+static std::vector<std::unique_ptr<RoadInfo>> make_mixed_infos(size_t count) {
+  std::vector<std::unique_ptr<RoadInfo>> infos;
+  for (auto i = 0u; i < count; ++i) {
+    // Coarse distances so that several infos share the same s.
+    const double s = std::floor(Random::Uniform(0.0, 20.0));
+    switch (i % 3u) {
+      case 0u: infos.emplace_back(std::make_unique<RoadInfoLaneWidth>(s, i, 0.0, 0.0, 0.0)); break;
+      case 1u: infos.emplace_back(std::make_unique<RoadInfoLaneOffset>(s, i, 0.0, 0.0, 0.0)); break;
+      default: infos.emplace_back(std::make_unique<RoadInfoElevation>(s, i, 0.0, 0.0, 0.0)); break;
+    }
+  }
+  return infos;
+}
+
+static std::vector<std::unique_ptr<RoadInfo>> copy_infos(const std::vector<std::unique_ptr<RoadInfo>> &infos) {
+  std::vector<std::unique_ptr<RoadInfo>> result;
+  for (const auto &info : infos) {
+    if (auto *width = dynamic_cast<const RoadInfoLaneWidth *>(info.get())) {
+      result.emplace_back(std::make_unique<RoadInfoLaneWidth>(width->GetDistance(), width->GetPolynomial().GetA(), 0.0, 0.0, 0.0));
+    } else if (auto *offset = dynamic_cast<const RoadInfoLaneOffset *>(info.get())) {
+      result.emplace_back(std::make_unique<RoadInfoLaneOffset>(offset->GetDistance(), offset->GetPolynomial().GetA(), 0.0, 0.0, 0.0));
+    } else {
+      auto *elevation = static_cast<const RoadInfoElevation *>(info.get());
+      result.emplace_back(std::make_unique<RoadInfoElevation>(elevation->GetDistance(), elevation->GetPolynomial().GetA(), 0.0, 0.0, 0.0));
+    }
+  }
+  return result;
+}
+
+template <typename T, typename RangeT>
+static std::vector<double> ids_of(const RangeT &range) {
+  std::vector<double> ids;
+  for (auto it = MakeRoadInfoIterator<T>(range); !it.IsAtEnd(); ++it) {
+    ids.emplace_back(it->GetPolynomial().GetA());
+  }
+  return ids;
+}
+
+template <typename T>
+static std::vector<double> ids_of(const std::vector<const T *> &infos) {
+  std::vector<double> ids;
+  for (auto *info : infos) {
+    ids.emplace_back(info->GetPolynomial().GetA());
+  }
+  return ids;
+}
+
+// Checks the typed indexes of InformationSet against a visitor scan of the
+// same infos.
+template <typename T>
+static void test_information_set_queries(
+    const InformationSet &indexed,
+    const RoadElementSet<std::unique_ptr<RoadInfo>> &plain) {
+  ASSERT_EQ(ids_of<T>(indexed.template GetInfos<T>()), ids_of<T>(plain.GetAll()));
+  for (auto i = 0u; i < 200u; ++i) {
+    const double s = Random::Uniform(-1.0, 21.0);
+    const T *info = indexed.template GetInfo<T>(s);
+    auto it = MakeRoadInfoIterator<T>(plain.GetReverseSubset(s));
+    if (it.IsAtEnd()) {
+      ASSERT_EQ(info, nullptr);
+    } else {
+      ASSERT_NE(info, nullptr);
+      ASSERT_EQ(info->GetPolynomial().GetA(), it->GetPolynomial().GetA());
+    }
+    const double other_s = std::floor(Random::Uniform(-1.0, 21.0));
+    const double min_s = std::min(s, other_s);
+    const double max_s = std::max(s, other_s);
+    ASSERT_EQ(
+        ids_of<T>(indexed.template GetInfos<T>(min_s, max_s)),
+        ids_of<T>(plain.GetSubsetInRange(min_s, max_s)));
+    ASSERT_EQ(
+        ids_of<T>(indexed.template GetInfos<T>(max_s, min_s)),
+        ids_of<T>(plain.GetReverseSubsetInRange(min_s, max_s)));
+  }
+}
+
+TEST(road, information_set_typed_indexes) {
+  for (auto count : {0u, 1u, 7u, 100u}) {
+    auto infos = make_mixed_infos(count);
+    // Both sets sort the same distances in the same input order, so infos
+    // sharing a distance end up in the same relative order.
+    RoadElementSet<std::unique_ptr<RoadInfo>> plain(copy_infos(infos));
+    InformationSet indexed(std::move(infos));
+    test_information_set_queries<RoadInfoLaneWidth>(indexed, plain);
+    test_information_set_queries<RoadInfoLaneOffset>(indexed, plain);
+    test_information_set_queries<RoadInfoElevation>(indexed, plain);
+  }
+}
+
 TEST(road, parse_files) {
   for (const auto &file : util::OpenDrive::GetAvailableFiles()) {
     // std::cerr << file << std::endl;
@@ -301,6 +396,98 @@ TEST(road, parse_geometry) {
 
 }
 
+template <typename T>
+static std::vector<std::pair<RoadId, LaneId>> lane_ids_of(const T &lanes) {
+  std::vector<std::pair<RoadId, LaneId>> result;
+  for (const auto *lane : lanes) {
+    result.emplace_back(lane->GetRoad()->GetId(), lane->GetId());
+  }
+  return result;
+}
+
+template <typename T>
+static std::vector<RoadId> road_ids_of(const T &roads) {
+  std::vector<RoadId> result;
+  for (const auto *road : roads) {
+    result.emplace_back(road->GetId());
+  }
+  return result;
+}
+
+// Two maps built from the same OpenDRIVE must be identical: same links
+// between lanes and roads in the same order, same junction bounding boxes and
+// conflicts, same signal transforms and same waypoints.
+static void assert_same_map(Map &lhs, Map &rhs) {
+  const MapData &lhs_data = lhs.GetMap();
+  const MapData &rhs_data = rhs.GetMap();
+
+  ASSERT_EQ(lhs_data.GetRoadCount(), rhs_data.GetRoadCount());
+  for (const auto &pair : lhs_data.GetRoads()) {
+    const Road &road = pair.second;
+    const Road &other = rhs_data.GetRoad(pair.first);
+    ASSERT_EQ(road_ids_of(road.GetNexts()), road_ids_of(other.GetNexts()));
+    ASSERT_EQ(road_ids_of(road.GetPrevs()), road_ids_of(other.GetPrevs()));
+    for (const auto &section : road.GetLaneSections()) {
+      const auto &other_section = other.GetLaneSectionById(section.GetId());
+      ASSERT_EQ(section.GetLanes().size(), other_section.GetLanes().size());
+      for (const auto &lane : section.GetLanes()) {
+        const auto &other_lane = other_section.GetLanes().at(lane.first);
+        ASSERT_EQ(lane_ids_of(lane.second.GetNextLanes()), lane_ids_of(other_lane.GetNextLanes()));
+        ASSERT_EQ(lane_ids_of(lane.second.GetPreviousLanes()), lane_ids_of(other_lane.GetPreviousLanes()));
+      }
+    }
+  }
+
+  ASSERT_EQ(lhs_data.GetJunctions().size(), rhs_data.GetJunctions().size());
+  for (const auto &pair : lhs_data.GetJunctions()) {
+    const Junction &junction = pair.second;
+    const Junction *other = rhs_data.GetJunction(pair.first);
+    ASSERT_NE(other, nullptr);
+    ASSERT_EQ(junction.GetBoundingBox(), other->GetBoundingBox());
+    for (const auto &connection : junction.GetConnections()) {
+      const RoadId road_id = connection.second.connecting_road;
+      ASSERT_EQ(junction.RoadHasConflicts(road_id), other->RoadHasConflicts(road_id));
+      if (junction.RoadHasConflicts(road_id)) {
+        ASSERT_EQ(junction.GetConflictsOfRoad(road_id), other->GetConflictsOfRoad(road_id));
+      }
+    }
+  }
+
+  ASSERT_EQ(lhs.GetSignals().size(), rhs.GetSignals().size());
+  for (const auto &pair : lhs.GetSignals()) {
+    const auto it = rhs.GetSignals().find(pair.first);
+    ASSERT_NE(it, rhs.GetSignals().end());
+    ASSERT_EQ(pair.second->GetTransform(), it->second->GetTransform());
+  }
+
+  const auto waypoints = lhs.GenerateWaypoints(2.0);
+  const auto other_waypoints = rhs.GenerateWaypoints(2.0);
+  ASSERT_EQ(waypoints.size(), other_waypoints.size());
+  for (auto i = 0u; i < waypoints.size(); ++i) {
+    ASSERT_EQ(waypoints[i], other_waypoints[i]);
+    const auto transform = lhs.ComputeTransform(waypoints[i]);
+    ASSERT_EQ(transform, rhs.ComputeTransform(other_waypoints[i]));
+    ASSERT_TRUE(
+        lhs.GetClosestWaypointOnRoad(transform.location) ==
+        rhs.GetClosestWaypointOnRoad(transform.location));
+  }
+}
+
+// Loading with several threads must give the same map as loading serially,
+// also for a map large enough to be split in many chunks.
+TEST(road, parse_files_in_parallel) {
+  for (const auto &file : util::OpenDrive::GetAvailableFiles()) {
+    const auto opendrive = util::OpenDrive::Load(file);
+    for (const auto &xodr : {opendrive, util::OpenDrive::Tile(opendrive, 9u)}) {
+      auto serial = OpenDriveParser::Load(xodr, 1u);
+      auto parallel = OpenDriveParser::Load(xodr, 4u);
+      ASSERT_TRUE(serial.has_value());
+      ASSERT_TRUE(parallel.has_value());
+      assert_same_map(*serial, *parallel);
+    }
+  }
+}
+
 TEST(road, iterate_waypoints) {
   carla::ThreadPool pool;
   pool.AsyncRun();
@@ -378,6 +565,70 @@ TEST(road, iterate_waypoints) {
   }
 }
 
+static void assert_same_transform(const Transform &lhs, const Transform &rhs) {
+  ASSERT_NEAR(lhs.location.x, rhs.location.x, 1e-3f);
+  ASSERT_NEAR(lhs.location.y, rhs.location.y, 1e-3f);
+  ASSERT_NEAR(lhs.location.z, rhs.location.z, 1e-3f);
+  ASSERT_NEAR(lhs.rotation.pitch, rhs.rotation.pitch, 1e-3f);
+  ASSERT_NEAR(lhs.rotation.yaw, rhs.rotation.yaw, 1e-3f);
+  ASSERT_NEAR(lhs.rotation.roll, rhs.rotation.roll, 1e-3f);
+}
+
+TEST(road, compute_transforms) {
+  for (const auto &file : util::OpenDrive::GetAvailableFiles()) {
+    auto map = OpenDriveParser::Load(util::OpenDrive::Load(file));
+    ASSERT_TRUE(map.has_value());
+
+    // Waypoints of many lanes interleaved, as GenerateWaypoints returns them.
+    auto waypoints = map->GenerateWaypoints(0.5);
+    ASSERT_FALSE(waypoints.empty());
+    auto transforms = map->ComputeTransforms(waypoints);
+    ASSERT_EQ(transforms.size(), waypoints.size());
+    for (auto i = 0u; i < waypoints.size(); ++i) {
+      assert_same_transform(transforms[i], map->ComputeTransform(waypoints[i]));
+    }
+
+    // The same waypoints in random order.
+    Random::Shuffle(waypoints);
+    transforms = map->ComputeTransforms(waypoints);
+    for (auto i = 0u; i < waypoints.size(); ++i) {
+      assert_same_transform(transforms[i], map->ComputeTransform(waypoints[i]));
+    }
+
+    // Dense sampling of whole lanes, across their lane sections.
+    for (const auto &waypoint : map->GenerateWaypointsOnRoadEntries()) {
+      const auto &road = map->GetMap().GetRoad(waypoint.road_id);
+      std::vector<double> s_values;
+      for (double s = 0.0; s < road.GetLength(); s += 0.1) {
+        s_values.emplace_back(s);
+      }
+      std::vector<Transform> lane_transforms;
+      try {
+        lane_transforms = map->ComputeTransforms(waypoint.road_id, waypoint.lane_id, s_values);
+      } catch (const std::out_of_range &) {
+        // The lane does not span the whole road.
+        continue;
+      }
+      ASSERT_EQ(lane_transforms.size(), s_values.size());
+      for (auto i = 0u; i < s_values.size(); ++i) {
+        auto expected = map->GetWaypoint(waypoint.road_id, waypoint.lane_id, static_cast<float>(s_values[i]));
+        if (!expected.has_value()) {
+          continue;
+        }
+        expected->s = s_values[i];
+        // Skip the lane section boundaries, where rounding s to float may
+        // pick the neighbouring section.
+        const auto &lane = map->GetLane(*expected);
+        if (s_values[i] > lane.GetDistance() && s_values[i] < lane.GetDistance() + lane.GetLength()) {
+          assert_same_transform(lane_transforms[i], map->ComputeTransform(*expected));
+        }
+      }
+    }
+
+    ASSERT_THROW(map->ComputeTransforms(0u, 0, {-1.0}), std::out_of_range);
+  }
+}
+
 TEST(road, get_waypoint) {
   carla::ThreadPool pool;
   pool.AsyncRun();
@@ -424,3 +675,31 @@ TEST(road, get_waypoint) {
     result.get();
   }
 }
+
+// The batch queries must give the same waypoints as one query per location,
+// also with lane types other than driving and when reusing the buffers of a
+// larger batch.
+TEST(road, get_closest_waypoints_on_road) {
+  for (const auto &file : util::OpenDrive::GetAvailableFiles()) {
+    auto m = OpenDriveParser::Load(util::OpenDrive::Load(file));
+    ASSERT_TRUE(m.has_value());
+    const auto &map = *m;
+    const auto any_lane = static_cast<int32_t>(Lane::LaneType::Any);
+    for (const size_t batch_size : {1000u, 10u, 0u}) {
+      std::vector<Location> locations;
+      for (auto i = 0u; i < batch_size; ++i) {
+        locations.emplace_back(Random::Location(-500.0f, 500.0f));
+      }
+      for (const auto lane_type : {static_cast<int32_t>(Lane::LaneType::Driving), any_lane}) {
+        const auto closest = map.GetClosestWaypointsOnRoad(locations, lane_type);
+        const auto waypoints = map.GetWaypoints(locations, lane_type);
+        ASSERT_EQ(closest.size(), locations.size());
+        ASSERT_EQ(waypoints.size(), locations.size());
+        for (auto i = 0u; i < locations.size(); ++i) {
+          ASSERT_TRUE(closest[i] == map.GetClosestWaypointOnRoad(locations[i], lane_type));
+          ASSERT_TRUE(waypoints[i] == map.GetWaypoint(locations[i], lane_type));
+        }
+      }
+    }
+  }
+}
@@ -0,0 +1,196 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+
+#include <carla/StopWatch.h>
+#include <carla/trafficmanager/AtomicMap.h>
+#include <carla/trafficmanager/ParameterSnapshot.h>
+#include <carla/trafficmanager/Parameters.h>
+
+#include <chrono>
+#include <unordered_map>
+
+using namespace carla::traffic_manager;
+
+TEST(parameter_snapshot, lookup) {
+  std::unordered_map<ActorId, VehicleParameters> vehicles;
+  for (ActorId id = 1u; id <= 100u; ++id) {
+    VehicleParameters &vehicle = vehicles[id];
+    vehicle.perc_ignore_vehicles = static_cast<float>(id);
+    vehicle.ignore_collision = {id + 1u, id + 3u, id + 5u};
+  }
+  GlobalParameters globals;
+  globals.distance_to_leading_vehicle = 5.0f;
+
+  ParameterSnapshot snapshot;
+  ASSERT_EQ(snapshot.Find(1u), nullptr);
+  ASSERT_TRUE(snapshot.GetCollisionDetection(1u, 2u));
+
+  snapshot.Assign(vehicles, globals);
+  ASSERT_EQ(snapshot.size(), vehicles.size());
+  ASSERT_EQ(snapshot.GetGlobals().distance_to_leading_vehicle, 5.0f);
+  ASSERT_EQ(snapshot.Find(0u), nullptr);
+  for (ActorId id = 1u; id <= 100u; ++id) {
+    const VehicleParameters *vehicle = snapshot.Find(id);
+    ASSERT_NE(vehicle, nullptr);
+    ASSERT_EQ(vehicle->perc_ignore_vehicles, static_cast<float>(id));
+    ASSERT_FALSE(vehicle->Has(VehicleParameters::LANE_OFFSET));
+    ASSERT_FALSE(snapshot.GetCollisionDetection(id, id + 3u));
+    ASSERT_TRUE(snapshot.GetCollisionDetection(id, id + 2u));
+  }
+
+  // Reassigning reuses the storage and drops the vehicles no longer present.
+  vehicles.erase(1u);
+  snapshot.Assign(vehicles, globals);
+  ASSERT_EQ(snapshot.size(), vehicles.size());
+  ASSERT_EQ(snapshot.Find(1u), nullptr);
+  ASSERT_TRUE(snapshot.GetCollisionDetection(1u, 2u));
+}
+
+TEST(parameter_snapshot, publish) {
+  Parameters parameters;
+  parameters.SetPercentageSpeedDifference(1u, 50.0f);
+  // The stages keep reading the published snapshot until the next cycle.
+  ASSERT_EQ(parameters.GetVehicleTargetVelocity(1u, 100.0f), 100.0f);
+  parameters.PublishSnapshot();
+  ASSERT_EQ(parameters.GetVehicleTargetVelocity(1u, 100.0f), 50.0f);
+  ASSERT_EQ(parameters.GetVehicleTargetVelocity(2u, 100.0f), 100.0f);
+
+  // Unregistered vehicles fall back to the global values.
+  parameters.RemoveVehicle(1u);
+  ASSERT_EQ(parameters.GetVehicleTargetVelocity(1u, 100.0f), 50.0f);
+  parameters.PublishSnapshot();
+  ASSERT_EQ(parameters.GetVehicleTargetVelocity(1u, 100.0f), 100.0f);
+}
+
+TEST(parameter_snapshot, force_lane_change) {
+  Parameters parameters;
+  parameters.SetForceLaneChange(1u, true);
+  ASSERT_FALSE(parameters.GetForceLaneChange(1u).change_lane);
+  parameters.PublishSnapshot();
+  const ChangeLaneInfo info = parameters.GetForceLaneChange(1u);
+  ASSERT_TRUE(info.change_lane);
+  ASSERT_TRUE(info.direction);
+
+  // Consumed, it is gone from the next snapshot.
+  parameters.PublishSnapshot();
+  ASSERT_FALSE(parameters.GetForceLaneChange(1u).change_lane);
+
+  // A command set after the snapshot was published is not cleared when the
+  // previous one is consumed.
+  parameters.SetForceLaneChange(1u, true);
+  parameters.PublishSnapshot();
+  parameters.SetForceLaneChange(1u, false);
+  ASSERT_TRUE(parameters.GetForceLaneChange(1u).direction);
+  parameters.PublishSnapshot();
+  const ChangeLaneInfo next = parameters.GetForceLaneChange(1u);
+  ASSERT_TRUE(next.change_lane);
+  ASSERT_FALSE(next.direction);
+  parameters.PublishSnapshot();
+  ASSERT_FALSE(parameters.GetForceLaneChange(1u).change_lane);
+}
+
+TEST(parameter_snapshot, upload_path_and_route) {
+  Parameters parameters;
+  parameters.SetCustomPath(1u, {carla::geom::Location(1.0f, 2.0f, 0.0f)}, true);
+  parameters.SetImportedRoute(2u, {1u, 2u}, false);
+  ASSERT_FALSE(parameters.GetUploadPath(1u));
+  parameters.PublishSnapshot();
+  ASSERT_TRUE(parameters.GetUploadPath(1u));
+  ASSERT_EQ(parameters.GetCustomPath(1u).size(), 1u);
+  // Routes set without emptying the buffer have nothing to upload.
+  ASSERT_FALSE(parameters.GetUploadRoute(2u));
+  ASSERT_EQ(parameters.GetImportedRoute(2u).size(), 2u);
+
+  // Consumed uploads stay in the current snapshot and are gone from the next.
+  parameters.ConsumeUploadPath(1u);
+  ASSERT_TRUE(parameters.GetUploadPath(1u));
+  parameters.PublishSnapshot();
+  ASSERT_FALSE(parameters.GetUploadPath(1u));
+  ASSERT_EQ(parameters.GetCustomPath(1u).size(), 1u);
+
+  // An upload set after the snapshot was published survives the consumption
+  // of the previous one.
+  parameters.SetImportedRoute(2u, {3u}, true);
+  parameters.PublishSnapshot();
+  parameters.SetImportedRoute(2u, {4u}, true);
+  parameters.ConsumeUploadRoute(2u);
+  parameters.PublishSnapshot();
+  ASSERT_TRUE(parameters.GetUploadRoute(2u));
+  parameters.ConsumeUploadRoute(2u);
+  parameters.PublishSnapshot();
+  ASSERT_FALSE(parameters.GetUploadRoute(2u));
+}
+
+TEST(parameter_snapshot, target_velocity) {
+  Parameters parameters;
+  parameters.SetGlobalPercentageSpeedDifference(10.0f);
+  parameters.SetDesiredSpeed(1u, 20.0f);
+  parameters.PublishSnapshot();
+  ASSERT_EQ(parameters.GetVehicleTargetVelocity(1u, 100.0f), 20.0f);
+  ASSERT_EQ(parameters.GetVehicleTargetVelocity(2u, 100.0f), 90.0f);
+
+  // The last of the percentage and the exact speed set is the one applied.
+  parameters.SetPercentageSpeedDifference(1u, 50.0f);
+  parameters.PublishSnapshot();
+  ASSERT_EQ(parameters.GetVehicleTargetVelocity(1u, 100.0f), 50.0f);
+  parameters.SetDesiredSpeed(1u, 30.0f);
+  parameters.PublishSnapshot();
+  ASSERT_EQ(parameters.GetVehicleTargetVelocity(1u, 100.0f), 30.0f);
+}
+
+// Compares the per-vehicle lookups the stages perform every cycle, done
+// against a locked map per parameter and against a snapshot.
+TEST(benchmark_parameter_snapshot, lookup) {
+  constexpr ActorId number_of_vehicles = 1000u;
+  constexpr int number_of_lookups = 8;
+  constexpr int number_of_cycles = 100;
+
+  AtomicMap<ActorId, float> maps[number_of_lookups];
+  std::unordered_map<ActorId, VehicleParameters> vehicles;
+  for (ActorId id = 0u; id < number_of_vehicles; ++id) {
+    for (auto &map : maps) {
+      map.AddEntry({id, 1.0f});
+    }
+    vehicles[id].perc_ignore_vehicles = 1.0f;
+  }
+  ParameterSnapshot snapshot;
+  snapshot.Assign(vehicles, GlobalParameters());
+
+  float map_sum = 0.0f;
+  carla::StopWatch map_watch;
+  for (int cycle = 0; cycle < number_of_cycles; ++cycle) {
+    for (ActorId id = 0u; id < number_of_vehicles; ++id) {
+      for (const auto &map : maps) {
+        if (map.Contains(id)) {
+          map_sum += map.GetValue(id);
+        }
+      }
+    }
+  }
+  map_watch.Stop();
+
+  float snapshot_sum = 0.0f;
+  carla::StopWatch snapshot_watch;
+  for (int cycle = 0; cycle < number_of_cycles; ++cycle) {
+    for (ActorId id = 0u; id < number_of_vehicles; ++id) {
+      for (int i = 0; i < number_of_lookups; ++i) {
+        const VehicleParameters *vehicle = snapshot.Find(id);
+        if (vehicle != nullptr) {
+          snapshot_sum += vehicle->perc_ignore_vehicles;
+        }
+      }
+    }
+  }
+  snapshot_watch.Stop();
+
+  ASSERT_EQ(map_sum, snapshot_sum);
+  carla::logging::log(
+      "parameter lookups for", number_of_vehicles, "vehicles,", number_of_cycles, "cycles:",
+      "locked maps", map_watch.GetElapsedTime<std::chrono::microseconds>(), "us;",
+      "snapshot", snapshot_watch.GetElapsedTime<std::chrono::microseconds>(), "us");
+}
@@ -0,0 +1,190 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+#include "OpenDrive.h"
+
+#include <carla/opendrive/OpenDriveParser.h>
+#include <carla/road/PrecompiledMap.h>
+#include <carla/road/element/RoadInfoElevation.h>
+#include <carla/road/element/RoadInfoGeometry.h>
+#include <carla/road/element/RoadInfoLaneWidth.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include <tuple>
+#include <vector>
+
+using namespace carla::road;
+using namespace carla::road::element;
+using carla::opendrive::OpenDriveParser;
+
+template <typename T>
+static std::vector<std::tuple<RoadId, SectionId, LaneId>> lane_keys_of(const T &lanes) {
+  std::vector<std::tuple<RoadId, SectionId, LaneId>> result;
+  for (const auto *lane : lanes) {
+    result.emplace_back(lane->GetRoad()->GetId(), lane->GetLaneSection()->GetId(), lane->GetId());
+  }
+  return result;
+}
+
+template <typename T>
+static std::vector<RoadId> road_ids_of(const T &roads) {
+  std::vector<RoadId> result;
+  for (const auto *road : roads) {
+    result.emplace_back(road->GetId());
+  }
+  return result;
+}
+
+// Roads are restored in a different order, so waypoints are compared sorted.
+static std::vector<Waypoint> sorted(std::vector<Waypoint> waypoints) {
+  std::sort(waypoints.begin(), waypoints.end(), [](const Waypoint &lhs, const Waypoint &rhs) {
+    return std::make_tuple(lhs.road_id, lhs.section_id, lhs.lane_id, lhs.s) <
+           std::make_tuple(rhs.road_id, rhs.section_id, rhs.lane_id, rhs.s);
+  });
+  return waypoints;
+}
+
+static void assert_same_map(Map &parsed, Map &restored) {
+  const MapData &parsed_data = parsed.GetMap();
+  const MapData &restored_data = restored.GetMap();
+
+  ASSERT_EQ(parsed_data.GetRoadCount(), restored_data.GetRoadCount());
+  for (const auto &pair : parsed_data.GetRoads()) {
+    const Road &road = pair.second;
+    const Road &other = restored_data.GetRoad(pair.first);
+    ASSERT_EQ(road.GetName(), other.GetName());
+    ASSERT_EQ(road.GetLength(), other.GetLength());
+    ASSERT_EQ(road.GetJunctionId(), other.GetJunctionId());
+    ASSERT_EQ(road_ids_of(road.GetNexts()), road_ids_of(other.GetNexts()));
+    ASSERT_EQ(road_ids_of(road.GetPrevs()), road_ids_of(other.GetPrevs()));
+    ASSERT_EQ(road.GetInfos<RoadInfoGeometry>().size(), other.GetInfos<RoadInfoGeometry>().size());
+    ASSERT_EQ(road.GetInfos<RoadInfoElevation>().size(), other.GetInfos<RoadInfoElevation>().size());
+    for (const auto &section : road.GetLaneSections()) {
+      const auto &other_section = other.GetLaneSectionById(section.GetId());
+      ASSERT_EQ(section.GetDistance(), other_section.GetDistance());
+      ASSERT_EQ(section.GetLanes().size(), other_section.GetLanes().size());
+      for (const auto &lane : section.GetLanes()) {
+        const auto &other_lane = other_section.GetLanes().at(lane.first);
+        ASSERT_EQ(lane.second.GetType(), other_lane.GetType());
+        ASSERT_EQ(lane.second.GetLevel(), other_lane.GetLevel());
+        ASSERT_EQ(lane.second.GetInfos<RoadInfoLaneWidth>().size(), other_lane.GetInfos<RoadInfoLaneWidth>().size());
+        ASSERT_EQ(lane_keys_of(lane.second.GetNextLanes()), lane_keys_of(other_lane.GetNextLanes()));
+        ASSERT_EQ(lane_keys_of(lane.second.GetPreviousLanes()), lane_keys_of(other_lane.GetPreviousLanes()));
+      }
+    }
+  }
+
+  ASSERT_EQ(parsed_data.GetJunctions().size(), restored_data.GetJunctions().size());
+  for (const auto &pair : parsed_data.GetJunctions()) {
+    const Junction &junction = pair.second;
+    const Junction *other = restored_data.GetJunction(pair.first);
+    ASSERT_NE(other, nullptr);
+    ASSERT_EQ(junction.GetBoundingBox(), other->GetBoundingBox());
+    ASSERT_EQ(junction.GetConnections().size(), other->GetConnections().size());
+    for (const auto &connection : junction.GetConnections()) {
+      const RoadId road_id = connection.second.connecting_road;
+      ASSERT_EQ(junction.RoadHasConflicts(road_id), other->RoadHasConflicts(road_id));
+      if (junction.RoadHasConflicts(road_id)) {
+        ASSERT_EQ(junction.GetConflictsOfRoad(road_id), other->GetConflictsOfRoad(road_id));
+      }
+    }
+  }
+
+  ASSERT_EQ(parsed.GetControllers().size(), restored.GetControllers().size());
+  ASSERT_EQ(parsed.GetSignals().size(), restored.GetSignals().size());
+  for (const auto &pair : parsed.GetSignals()) {
+    const auto it = restored.GetSignals().find(pair.first);
+    ASSERT_NE(it, restored.GetSignals().end());
+    ASSERT_EQ(pair.second == nullptr, it->second == nullptr);
+    if (pair.second != nullptr) {
+      ASSERT_EQ(pair.second->GetTransform(), it->second->GetTransform());
+    }
+  }
+  ASSERT_EQ(parsed.GetAllSignalReferences().size(), restored.GetAllSignalReferences().size());
+
+  const auto waypoints = sorted(parsed.GenerateWaypoints(2.0));
+  const auto other_waypoints = sorted(restored.GenerateWaypoints(2.0));
+  ASSERT_EQ(waypoints.size(), other_waypoints.size());
+  for (auto i = 0u; i < waypoints.size(); ++i) {
+    ASSERT_EQ(waypoints[i], other_waypoints[i]);
+    const auto transform = parsed.ComputeTransform(waypoints[i]);
+    ASSERT_EQ(transform, restored.ComputeTransform(waypoints[i]));
+    ASSERT_EQ(parsed.GetLaneWidth(waypoints[i]), restored.GetLaneWidth(waypoints[i]));
+    ASSERT_EQ(sorted(parsed.GetNext(waypoints[i], 5.0)), sorted(restored.GetNext(waypoints[i], 5.0)));
+    // The Rtree is restored with the segments in the same order, so even ties
+    // between segments resolve the same way.
+    ASSERT_TRUE(
+        parsed.GetClosestWaypointOnRoad(transform.location) ==
+        restored.GetClosestWaypointOnRoad(transform.location));
+  }
+}
+
+TEST(precompiled_map, round_trip) {
+  for (const auto &file : util::OpenDrive::GetAvailableFiles()) {
+    const auto opendrive = util::OpenDrive::Load(file);
+    const auto key = PrecompiledMap::GetOpenDriveKey(opendrive);
+    auto parsed = OpenDriveParser::Load(opendrive);
+    ASSERT_TRUE(parsed.has_value());
+
+    const std::vector<uint8_t> content = PrecompiledMap::Serialize(*parsed, key);
+    ASSERT_TRUE(PrecompiledMap::HasHeader(content.data(), content.size()));
+    for (const size_t number_of_threads : {1u, 4u}) {
+      auto restored = PrecompiledMap::Load(content.data(), content.size(), key, number_of_threads);
+      ASSERT_TRUE(restored.has_value());
+      assert_same_map(*parsed, *restored);
+    }
+  }
+}
+
+TEST(precompiled_map, reject_invalid_content) {
+  const auto files = util::OpenDrive::GetAvailableFiles();
+  ASSERT_FALSE(files.empty());
+  const auto opendrive = util::OpenDrive::Load(files.front());
+  const auto key = PrecompiledMap::GetOpenDriveKey(opendrive);
+  auto map = OpenDriveParser::Load(opendrive);
+  ASSERT_TRUE(map.has_value());
+  const std::vector<uint8_t> content = PrecompiledMap::Serialize(*map, key);
+  ASSERT_TRUE(PrecompiledMap::Load(content.data(), content.size(), key).has_value());
+
+  // Built from a different OpenDRIVE.
+  ASSERT_FALSE(PrecompiledMap::Load(content.data(), content.size(), {key.hash + 1u, key.size}).has_value());
+  ASSERT_FALSE(PrecompiledMap::Load(content.data(), content.size(), {key.hash, key.size + 1u}).has_value());
+  const auto other_key = PrecompiledMap::GetOpenDriveKey(opendrive + " ");
+  ASSERT_NE(other_key.hash, key.hash);
+  ASSERT_NE(other_key.size, key.size);
+  // Flipping any single bit of the document changes its hash.
+  for (const size_t index : {size_t(0u), opendrive.size() / 2u, opendrive.size() - 1u}) {
+    for (auto bit = 0u; bit < 8u; ++bit) {
+      std::string modified = opendrive;
+      modified[index] = static_cast<char>(modified[index] ^ (1 << bit));
+      ASSERT_NE(PrecompiledMap::GetOpenDriveKey(modified).hash, key.hash);
+    }
+  }
+
+  // Truncated.
+  ASSERT_FALSE(PrecompiledMap::Load(content.data(), 0u, key).has_value());
+  ASSERT_FALSE(PrecompiledMap::Load(content.data(), sizeof(precompiled_map::Header), key).has_value());
+  ASSERT_FALSE(PrecompiledMap::Load(content.data(), content.size() - 1u, key).has_value());
+
+  // Corrupted payload.
+  std::vector<uint8_t> corrupted = content;
+  corrupted[corrupted.size() / 2u] ^= 0xFFu;
+  ASSERT_FALSE(PrecompiledMap::Load(corrupted.data(), corrupted.size(), key).has_value());
+
+  // Written by another version of the format.
+  std::vector<uint8_t> other_version = content;
+  const uint32_t version = precompiled_map::VERSION + 1u;
+  std::memcpy(other_version.data() + offsetof(precompiled_map::Header, version), &version, sizeof(version));
+  ASSERT_FALSE(PrecompiledMap::Load(other_version.data(), other_version.size(), key).has_value());
+
+  // Not a precompiled map at all.
+  ASSERT_FALSE(PrecompiledMap::HasHeader(
+      reinterpret_cast<const uint8_t *>(opendrive.data()), opendrive.size()));
+}
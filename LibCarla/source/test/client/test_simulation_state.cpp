@@ -0,0 +1,194 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+
+#include <carla/StopWatch.h>
+#include <carla/trafficmanager/SimulationState.h>
+
+#include <chrono>
+#include <unordered_map>
+#include <vector>
+
+using namespace carla::traffic_manager;
+using carla::geom::Location;
+using carla::geom::Rotation;
+using carla::geom::Vector3D;
+
+static KinematicState make_kinematic_state(float value) {
+  return KinematicState{
+      Location(value, 2.0f * value, 0.0f),
+      Rotation(0.0f, value, 0.0f),
+      Vector3D(value, 0.0f, 0.0f),
+      30.0f,
+      true,
+      false,
+      Location(value, value, 0.0f)};
+}
+
+static StaticAttributes make_attributes(float value) {
+  return StaticAttributes{ActorType::Vehicle, value, 1.0f, 0.75f};
+}
+
+static TrafficLightState make_tl_state(TLS state) {
+  return TrafficLightState{state, true};
+}
+
+TEST(simulation_state, add_and_get) {
+  SimulationState state;
+  state.AddActor(7u, make_kinematic_state(1.0f), make_attributes(2.0f), make_tl_state(TLS::Red));
+  ASSERT_TRUE(state.ContainsActor(7u));
+  ASSERT_FALSE(state.ContainsActor(8u));
+  ASSERT_EQ(state.Size(), 1u);
+  ASSERT_EQ(state.GetLocation(7u), Location(1.0f, 2.0f, 0.0f));
+  ASSERT_EQ(state.GetHybridEndLocation(7u), Location(1.0f, 1.0f, 0.0f));
+  ASSERT_EQ(state.GetVelocity(7u), Vector3D(1.0f, 0.0f, 0.0f));
+  ASSERT_EQ(state.GetHeading(7u), Rotation(0.0f, 1.0f, 0.0f).GetForwardVector());
+  ASSERT_EQ(state.GetDimensions(7u), Vector3D(2.0f, 1.0f, 0.75f));
+  ASSERT_EQ(state.GetType(7u), ActorType::Vehicle);
+  ASSERT_EQ(state.GetTLS(7u).tl_state, TLS::Red);
+  ASSERT_TRUE(state.IsPhysicsEnabled(7u));
+  ASSERT_FALSE(state.IsDormant(7u));
+}
+
+TEST(simulation_state, remove_keeps_slots_dense) {
+  SimulationState state;
+  for (auto i = 0u; i < 10u; ++i) {
+    state.AddActor(i, make_kinematic_state(float(i)), make_attributes(float(i)), make_tl_state(TLS::Green));
+  }
+  state.RemoveActor(3u);
+  state.RemoveActor(0u);
+  state.RemoveActor(42u);
+  ASSERT_EQ(state.Size(), 8u);
+  ASSERT_FALSE(state.ContainsActor(3u));
+  ASSERT_FALSE(state.ContainsActor(0u));
+  std::vector<bool> taken_slots(state.Size(), false);
+  for (ActorId actor_id = 1u; actor_id < 10u; ++actor_id) {
+    if (actor_id == 3u) {
+      continue;
+    }
+    const std::size_t slot = state.GetSlot(actor_id);
+    ASSERT_LT(slot, state.Size());
+    ASSERT_FALSE(taken_slots[slot]);
+    taken_slots[slot] = true;
+    ASSERT_EQ(state.GetLocationAt(slot), Location(float(actor_id), 2.0f * float(actor_id), 0.0f));
+    ASSERT_EQ(state.GetLocation(actor_id), state.GetLocationAt(slot));
+    ASSERT_EQ(state.GetDimensions(actor_id).x, float(actor_id));
+  }
+  state.Reset();
+  ASSERT_EQ(state.Size(), 0u);
+  ASSERT_FALSE(state.ContainsActor(1u));
+}
+
+TEST(simulation_state, slot_accessors) {
+  SimulationState state;
+  for (auto i = 1u; i <= 5u; ++i) {
+    state.AddActor(i, make_kinematic_state(float(i)), make_attributes(float(i)), make_tl_state(TLS::Red));
+  }
+  state.RemoveActor(2u);
+  ASSERT_EQ(state.FindSlot(2u), state.Size());
+  for (ActorId actor_id : {1u, 3u, 4u, 5u}) {
+    const std::size_t slot = state.FindSlot(actor_id);
+    ASSERT_EQ(slot, state.GetSlot(actor_id));
+    ASSERT_EQ(state.GetActorIdAt(slot), actor_id);
+    ASSERT_EQ(state.GetLocationAt(slot), state.GetLocation(actor_id));
+    ASSERT_EQ(state.GetHybridEndLocationAt(slot), state.GetHybridEndLocation(actor_id));
+    ASSERT_EQ(state.GetRotationAt(slot), state.GetRotation(actor_id));
+    ASSERT_EQ(state.GetHeadingAt(slot), state.GetHeading(actor_id));
+    ASSERT_EQ(state.GetVelocityAt(slot), state.GetVelocity(actor_id));
+    ASSERT_EQ(state.GetSpeedLimitAt(slot), state.GetSpeedLimit(actor_id));
+    ASSERT_EQ(state.IsPhysicsEnabledAt(slot), state.IsPhysicsEnabled(actor_id));
+    ASSERT_EQ(state.IsDormantAt(slot), state.IsDormant(actor_id));
+    ASSERT_EQ(state.GetTLSAt(slot).tl_state, state.GetTLS(actor_id).tl_state);
+    ASSERT_EQ(state.GetTypeAt(slot), state.GetType(actor_id));
+    ASSERT_EQ(state.GetDimensionsAt(slot), state.GetDimensions(actor_id));
+  }
+}
+
+TEST(simulation_state, green_light_is_held) {
+  SimulationState state;
+  state.AddActor(1u, make_kinematic_state(0.0f), make_attributes(1.0f), make_tl_state(TLS::Green));
+  state.UpdateTrafficLightState(1u, make_tl_state(TLS::Yellow));
+  ASSERT_EQ(state.GetTLS(1u).tl_state, TLS::Green);
+  state.UpdateTrafficLightState(1u, TrafficLightState{TLS::Red, false});
+  state.UpdateTrafficLightState(1u, make_tl_state(TLS::Red));
+  ASSERT_EQ(state.GetTLS(1u).tl_state, TLS::Red);
+}
+
+// Map of structures layout the simulation state used before, kept here as the
+// reference for the benchmark.
+struct MapOfStructsState {
+  std::unordered_map<ActorId, KinematicState> kinematic_state_map;
+  std::unordered_map<ActorId, StaticAttributes> static_attribute_map;
+};
+
+TEST(benchmark_simulation_state, getters) {
+  constexpr auto number_of_ticks = 100u;
+  for (auto number_of_actors : {100u, 1000u, 5000u}) {
+    SimulationState state;
+    MapOfStructsState reference;
+    std::vector<ActorId> actor_ids;
+    for (auto i = 0u; i < number_of_actors; ++i) {
+      const ActorId actor_id = 2u * i + 1u;
+      actor_ids.push_back(actor_id);
+      state.AddActor(actor_id, make_kinematic_state(float(i)), make_attributes(1.0f), make_tl_state(TLS::Green));
+      reference.kinematic_state_map.insert({actor_id, make_kinematic_state(float(i))});
+      reference.static_attribute_map.insert({actor_id, make_attributes(1.0f)});
+    }
+
+    // Every tick reads the location, heading, velocity and dimensions of all
+    // the actors, as the stages of the traffic manager do.
+    float reference_sum = 0.0f;
+    carla::StopWatch reference_watch;
+    for (auto tick = 0u; tick < number_of_ticks; ++tick) {
+      for (ActorId actor_id : actor_ids) {
+        const KinematicState &kinematic_state = reference.kinematic_state_map.at(actor_id);
+        const StaticAttributes &attributes = reference.static_attribute_map.at(actor_id);
+        reference_sum += kinematic_state.location.x
+            + kinematic_state.rotation.GetForwardVector().x
+            + kinematic_state.velocity.x
+            + attributes.half_length;
+      }
+    }
+    reference_watch.Stop();
+
+    float state_sum = 0.0f;
+    carla::StopWatch state_watch;
+    for (auto tick = 0u; tick < number_of_ticks; ++tick) {
+      for (ActorId actor_id : actor_ids) {
+        state_sum += state.GetLocation(actor_id).x
+            + state.GetHeading(actor_id).x
+            + state.GetVelocity(actor_id).x
+            + state.GetDimensions(actor_id).x;
+      }
+    }
+    state_watch.Stop();
+
+    // The stages resolve the slot of a vehicle once and read its state
+    // through the slot accessors.
+    float slot_sum = 0.0f;
+    carla::StopWatch slot_watch;
+    for (auto tick = 0u; tick < number_of_ticks; ++tick) {
+      for (ActorId actor_id : actor_ids) {
+        const std::size_t slot = state.GetSlot(actor_id);
+        slot_sum += state.GetLocationAt(slot).x
+            + state.GetHeadingAt(slot).x
+            + state.GetVelocityAt(slot).x
+            + state.GetDimensionsAt(slot).x;
+      }
+    }
+    slot_watch.Stop();
+
+    ASSERT_FLOAT_EQ(reference_sum, state_sum);
+    ASSERT_FLOAT_EQ(reference_sum, slot_sum);
+
+    carla::logging::log(
+        "simulation state with", number_of_actors, "actors,", number_of_ticks, "ticks:",
+        "map of structs", reference_watch.GetElapsedTime<std::chrono::microseconds>(), "us,",
+        "actor id getters", state_watch.GetElapsedTime<std::chrono::microseconds>(), "us,",
+        "slot accessors", slot_watch.GetElapsedTime<std::chrono::microseconds>(), "us");
+  }
+}
@@ -0,0 +1,128 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+
+#include <carla/StopWatch.h>
+#include <carla/trafficmanager/StageProfiler.h>
+
+#include <chrono>
+
+using namespace carla::traffic_manager;
+using Clock = StageProfiler::Clock;
+
+static const StageProfile &get_stage(const std::vector<StageProfile> &profile, TMStage stage) {
+  return profile.at(static_cast<std::size_t>(stage));
+}
+
+// Durations are synthetic, so that the expected statistics are known.
+TEST(stage_profiler, statistics) {
+  StageProfiler profiler;
+  const Clock::time_point origin = Clock::now();
+  for (int i = 1; i <= 100; ++i) {
+    profiler.BeginCycle();
+    profiler.Add(TMStage::Localization, origin, origin + std::chrono::microseconds(10 * i));
+    // Accumulated over several measurements per cycle.
+    profiler.Add(TMStage::MotionPlan, origin, origin + std::chrono::microseconds(100));
+    profiler.Add(TMStage::MotionPlan, origin, std::chrono::microseconds(100));
+    profiler.EndCycle(static_cast<std::size_t>(i));
+  }
+
+  const std::vector<StageProfile> profile = profiler.GetProfile();
+  ASSERT_EQ(profile.size(), static_cast<std::size_t>(TMStage::SIZE));
+
+  const StageProfile &localization = get_stage(profile, TMStage::Localization);
+  ASSERT_EQ(localization.name, "Localization");
+  ASSERT_EQ(localization.cycles, 100u);
+  ASSERT_NEAR(localization.mean_ms, 0.505, 1e-6);
+  ASSERT_NEAR(localization.max_ms, 1.0, 1e-6);
+  ASSERT_NEAR(localization.last_ms, 1.0, 1e-6);
+  // Percentiles are within the resolution of the histogram.
+  ASSERT_NEAR(localization.p50_ms, 0.5, 0.5 * 0.125);
+  ASSERT_NEAR(localization.p99_ms, 0.99, 0.99 * 0.125);
+  ASSERT_EQ(localization.last_vehicles, 100u);
+  ASSERT_EQ(localization.max_vehicles, 100u);
+
+  const StageProfile &motion_plan = get_stage(profile, TMStage::MotionPlan);
+  ASSERT_NEAR(motion_plan.mean_ms, 0.2, 1e-6);
+  ASSERT_NEAR(motion_plan.p50_ms, 0.2, 0.2 * 0.125);
+
+  // Stages not measured still count their cycles, with zero duration.
+  const StageProfile &collision = get_stage(profile, TMStage::Collision);
+  ASSERT_EQ(collision.cycles, 100u);
+  ASSERT_EQ(collision.max_ms, 0.0);
+
+  profiler.Reset();
+  for (const StageProfile &stage : profiler.GetProfile()) {
+    ASSERT_EQ(stage.cycles, 0u);
+    ASSERT_EQ(stage.p99_ms, 0.0);
+  }
+}
+
+TEST(stage_profiler, chrome_trace) {
+  StageProfiler profiler;
+  ASSERT_EQ(profiler.GetChromeTrace().find("\"ph\":\"X\""), std::string::npos);
+
+  const std::size_t number_of_cycles = constants::Profiler::TRACE_CAPACITY + 10u;
+  for (std::size_t i = 0u; i < number_of_cycles; ++i) {
+    profiler.BeginCycle();
+    const Clock::time_point begin = Clock::now();
+    profiler.Add(TMStage::Collision, begin, begin + std::chrono::microseconds(5));
+    profiler.EndCycle(3u);
+  }
+
+  const std::string trace = profiler.GetChromeTrace();
+  ASSERT_EQ(trace.find("{\"traceEvents\":["), 0u);
+  ASSERT_EQ(trace.back(), '}');
+  // Only the latest cycles are kept, with an event for the collision stage
+  // and another for the whole cycle.
+  std::size_t number_of_events = 0u;
+  for (auto pos = trace.find("\"ph\":\"X\""); pos != std::string::npos; pos = trace.find("\"ph\":\"X\"", pos + 1u)) {
+    ++number_of_events;
+  }
+  ASSERT_EQ(number_of_events, 2u * constants::Profiler::TRACE_CAPACITY);
+  ASSERT_NE(trace.find("\"name\":\"Collision\""), std::string::npos);
+  ASSERT_NE(trace.find("\"dur\":5.000,\"args\":{\"vehicles\":3}"), std::string::npos);
+}
+
+// Cost of instrumenting a cycle of the traffic manager, which takes one
+// timestamp per stage, and one per vehicle for each of the stages that are
+// interleaved per vehicle.
+TEST(benchmark_stage_profiler, overhead) {
+  constexpr std::size_t number_of_vehicles = 1000u;
+  constexpr std::size_t number_of_cycles = 1000u;
+  constexpr TMStage interleaved[] = {TMStage::TrafficLight, TMStage::MotionPlan, TMStage::VehicleLight};
+  StageProfiler profiler;
+  carla::StopWatch watch;
+  for (std::size_t cycle = 0u; cycle < number_of_cycles; ++cycle) {
+    profiler.BeginCycle();
+    Clock::time_point stage_end = StageProfiler::Now();
+    for (const TMStage stage : {TMStage::ALSM, TMStage::Localization, TMStage::Collision}) {
+      const Clock::time_point stage_begin = stage_end;
+      stage_end = StageProfiler::Now();
+      profiler.Add(stage, stage_begin, stage_end);
+    }
+    const Clock::time_point loop_begin = stage_end;
+    Clock::duration durations[3] = {};
+    for (std::size_t vehicle = 0u; vehicle < number_of_vehicles; ++vehicle) {
+      for (Clock::duration &duration : durations) {
+        const Clock::time_point stage_begin = stage_end;
+        stage_end = StageProfiler::Now();
+        duration += stage_end - stage_begin;
+      }
+    }
+    for (std::size_t stage = 0u; stage < 3u; ++stage) {
+      profiler.Add(interleaved[stage], loop_begin, durations[stage]);
+    }
+    profiler.Add(TMStage::ApplyBatch, stage_end, StageProfiler::Now());
+    profiler.EndCycle(number_of_vehicles);
+  }
+  watch.Stop();
+  ASSERT_EQ(get_stage(profiler.GetProfile(), TMStage::Cycle).cycles, number_of_cycles);
+  carla::logging::log(
+      "stage profiler overhead with", number_of_vehicles, "vehicles:",
+      watch.GetElapsedTime<std::chrono::nanoseconds>() / number_of_cycles, "ns per cycle");
+}
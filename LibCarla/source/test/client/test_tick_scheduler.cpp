@@ -0,0 +1,129 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+
+#include <carla/trafficmanager/TickScheduler.h>
+
+#include <algorithm>
+#include <vector>
+
+using namespace carla::traffic_manager;
+using carla::geom::Location;
+using carla::geom::Rotation;
+using carla::geom::Transform;
+using carla::geom::Vector3D;
+using ApplyTransform = carla::rpc::Command::ApplyTransform;
+using ApplyVehicleControl = carla::rpc::Command::ApplyVehicleControl;
+
+static void add_vehicle(SimulationState &state, ActorId actor_id, const Location &location) {
+  state.AddActor(
+      actor_id,
+      KinematicState{location, Rotation(), Vector3D(), 30.0f, true, false, location},
+      StaticAttributes{ActorType::Vehicle, 2.0f, 1.0f, 0.75f},
+      TrafficLightState{TLS::Green, false});
+}
+
+static const std::vector<TickLODBand> bands = {{150.0f, 2u}, {300.0f, 4u}, {600.0f, 8u}};
+
+TEST(tick_scheduler, periods) {
+  SimulationState state;
+  const std::vector<ActorId> vehicles = {10u, 11u, 12u, 13u};
+  add_vehicle(state, 10u, Location(0.0f, 0.0f, 0.0f));
+  add_vehicle(state, 11u, Location(200.0f, 0.0f, 0.0f));
+  add_vehicle(state, 12u, Location(0.0f, 400.0f, 0.0f));
+  add_vehicle(state, 13u, Location(800.0f, 0.0f, 0.0f));
+  const std::vector<Location> heroes = {Location(1000.0f, 0.0f, 0.0f), Location(0.0f, 0.0f, 0.0f)};
+
+  TickScheduler scheduler;
+  std::vector<unsigned long> scheduled;
+  std::vector<unsigned long> skipped;
+
+  // Vehicles without a command are always updated.
+  scheduler.Schedule(vehicles, state, heroes, bands, scheduled, skipped);
+  ASSERT_EQ(scheduled.size(), vehicles.size());
+  ASSERT_TRUE(skipped.empty());
+  for (const unsigned long index : scheduled) {
+    scheduler.StoreCommand(vehicles[index], ApplyVehicleControl(vehicles[index], {}), state.GetLocation(vehicles[index]));
+  }
+
+  // Over a whole period of the farthest band, each vehicle is updated
+  // according to its distance to the closest hero.
+  std::vector<unsigned> updates(vehicles.size(), 0u);
+  for (unsigned cycle = 0u; cycle < 8u; ++cycle) {
+    scheduler.Schedule(vehicles, state, heroes, bands, scheduled, skipped);
+    ASSERT_EQ(scheduled.size() + skipped.size(), vehicles.size());
+    for (const unsigned long index : scheduled) {
+      ++updates[index];
+    }
+  }
+  ASSERT_EQ(updates[0u], 8u);
+  ASSERT_EQ(updates[1u], 4u);
+  ASSERT_EQ(updates[2u], 2u);
+  // The first hero is 200 meters away.
+  ASSERT_EQ(updates[3u], 4u);
+
+  // Without heroes or bands every vehicle is updated.
+  scheduler.Schedule(vehicles, state, {}, bands, scheduled, skipped);
+  ASSERT_EQ(scheduled.size(), vehicles.size());
+  scheduler.Schedule(vehicles, state, heroes, {}, scheduled, skipped);
+  ASSERT_EQ(scheduled.size(), vehicles.size());
+
+  // Dropped vehicles are updated again as soon as they come back.
+  scheduler.Retain({10u});
+  scheduler.Schedule(vehicles, state, heroes, bands, scheduled, skipped);
+  ASSERT_EQ(scheduled.size(), vehicles.size());
+}
+
+TEST(tick_scheduler, staggering) {
+  SimulationState state;
+  std::vector<ActorId> vehicles;
+  for (ActorId actor_id = 0u; actor_id < 800u; ++actor_id) {
+    add_vehicle(state, actor_id, Location(1000.0f, 0.0f, 0.0f));
+    vehicles.push_back(actor_id);
+  }
+  const std::vector<Location> heroes = {Location(0.0f, 0.0f, 0.0f)};
+
+  TickScheduler scheduler;
+  std::vector<unsigned long> scheduled;
+  std::vector<unsigned long> skipped;
+  for (const ActorId actor_id : vehicles) {
+    scheduler.StoreCommand(actor_id, ApplyVehicleControl(actor_id, {}), state.GetLocation(actor_id));
+  }
+  // Vehicles sharing a band are spread evenly over its period.
+  for (unsigned cycle = 0u; cycle < 16u; ++cycle) {
+    scheduler.Schedule(vehicles, state, heroes, bands, scheduled, skipped);
+    ASSERT_EQ(scheduled.size(), 100u);
+  }
+}
+
+TEST(tick_scheduler, extrapolation) {
+  TickScheduler scheduler;
+  const Location location(10.0f, 20.0f, 0.0f);
+
+  // Vehicle controls are applied again as they were.
+  scheduler.StoreCommand(1u, ApplyVehicleControl(1u, {}), location);
+  const carla::rpc::Command control = scheduler.ExtrapolateCommand(1u, location);
+  ASSERT_NE(boost::variant2::get_if<ApplyVehicleControl>(&control.command), nullptr);
+
+  // Teleports keep moving the vehicle by the same displacement.
+  const Transform teleport(Location(11.0f, 20.5f, 0.0f), Rotation(0.0f, 30.0f, 0.0f));
+  scheduler.StoreCommand(2u, ApplyTransform(2u, teleport), location);
+  carla::rpc::Command command = scheduler.ExtrapolateCommand(2u, Location(11.0f, 20.5f, 0.0f));
+  const auto *transform = boost::variant2::get_if<ApplyTransform>(&command.command);
+  ASSERT_NE(transform, nullptr);
+  ASSERT_EQ(transform->actor, 2u);
+  ASSERT_NEAR(transform->transform.location.x, 12.0f, 1e-4f);
+  ASSERT_NEAR(transform->transform.location.y, 21.0f, 1e-4f);
+  ASSERT_NEAR(transform->transform.rotation.yaw, 30.0f, 1e-4f);
+
+  // Respawns of dormant vehicles are not repeated.
+  scheduler.StoreCommand(3u, ApplyTransform(3u, Transform(Location(500.0f, 0.0f, 0.0f))), location);
+  command = scheduler.ExtrapolateCommand(3u, Location(500.0f, 0.0f, 0.0f));
+  transform = boost::variant2::get_if<ApplyTransform>(&command.command);
+  ASSERT_NE(transform, nullptr);
+  ASSERT_NEAR(transform->transform.location.x, 500.0f, 1e-4f);
+}
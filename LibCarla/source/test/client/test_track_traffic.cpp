@@ -0,0 +1,179 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+#include "TrafficManagerSimulation.h"
+
+#include <carla/trafficmanager/TrackTraffic.h>
+
+#include <algorithm>
+#include <random>
+#include <set>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+using namespace carla::traffic_manager;
+
+// Grid occupancy as tracked before the flat spatial hash, with nested hash
+// containers between actors and geodesic grids.
+class ReferenceTrackTraffic {
+public:
+
+  void UpdateGridPosition(ActorId actor_id, const WaypointBuffer &buffer) {
+    if (buffer.empty()) {
+      return;
+    }
+    RemoveFromGrids(actor_id);
+    std::unordered_set<GeoGridId> current_grids;
+    for (const auto &waypoint : buffer) {
+      const GeoGridId grid_id = waypoint->GetGeodesicGridId();
+      current_grids.insert(grid_id);
+      grid_to_actors[grid_id].insert(actor_id);
+    }
+    actor_to_grids.insert({actor_id, current_grids});
+  }
+
+  void UpdateUnregisteredGridPosition(ActorId actor_id, const NodeList &waypoints) {
+    RemoveFromGrids(actor_id);
+    std::unordered_set<GeoGridId> current_grids;
+    for (const auto &waypoint : waypoints) {
+      const GeoGridId grid_id = waypoint->GetGeodesicGridId();
+      current_grids.insert(grid_id);
+      grid_to_actors[grid_id].insert(actor_id);
+    }
+    actor_to_grids.insert({actor_id, current_grids});
+  }
+
+  bool IsGeoGridFree(GeoGridId grid_id) const {
+    auto it = grid_to_actors.find(grid_id);
+    return it == grid_to_actors.end() || it->second.empty();
+  }
+
+  void AddTakenGrid(GeoGridId grid_id, ActorId actor_id) {
+    if (grid_to_actors.find(grid_id) == grid_to_actors.end()) {
+      grid_to_actors.insert({grid_id, {actor_id}});
+    }
+  }
+
+  ActorIdList GetOverlappingVehicles(ActorId actor_id) const {
+    std::set<ActorId> result;
+    auto it = actor_to_grids.find(actor_id);
+    if (it != actor_to_grids.end()) {
+      for (const GeoGridId grid_id : it->second) {
+        auto actors = grid_to_actors.find(grid_id);
+        if (actors != grid_to_actors.end()) {
+          result.insert(actors->second.begin(), actors->second.end());
+        }
+      }
+    }
+    return ActorIdList(result.begin(), result.end());
+  }
+
+  void DeleteActor(ActorId actor_id) {
+    RemoveFromGrids(actor_id);
+  }
+
+private:
+
+  void RemoveFromGrids(ActorId actor_id) {
+    auto it = actor_to_grids.find(actor_id);
+    if (it != actor_to_grids.end()) {
+      for (const GeoGridId grid_id : it->second) {
+        auto actors = grid_to_actors.find(grid_id);
+        if (actors != grid_to_actors.end()) {
+          actors->second.erase(actor_id);
+        }
+      }
+      actor_to_grids.erase(it);
+    }
+  }
+
+  std::unordered_map<ActorId, std::unordered_set<GeoGridId>> actor_to_grids;
+
+  std::unordered_map<GeoGridId, ActorIdSet> grid_to_actors;
+};
+
+// Applies the same random sequence of path updates, removals and taken
+// grids to both implementations and checks that every overlap query and
+// every grid occupancy agree.
+TEST(track_traffic, matches_reference) {
+  constexpr ActorId NUMBER_OF_ACTORS = 40u;
+  constexpr int NUMBER_OF_STEPS = 2000;
+  for (const auto &file : util::OpenDrive::GetAvailableFiles()) {
+    const util::LocalMapPtr local_map = util::make_local_map(file);
+    const NodeList &topology = local_map->GetDenseTopology();
+    ASSERT_FALSE(topology.empty()) << file;
+
+    std::set<GeoGridId> grid_ids;
+    for (const auto &waypoint : topology) {
+      grid_ids.insert(waypoint->GetGeodesicGridId());
+    }
+    // A grid no waypoint belongs to, as used for taken grids.
+    const GeoGridId unused_grid_id = *grid_ids.rbegin() + 1;
+    grid_ids.insert(unused_grid_id);
+
+    std::mt19937 random_engine(7u);
+    auto random_index = [&](std::size_t size) {
+      return std::uniform_int_distribution<std::size_t>(0u, size - 1u)(random_engine);
+    };
+    // Paths follow the successors of a random starting waypoint, like the
+    // buffers of the localization stage.
+    auto random_path = [&]() {
+      NodeList path{topology[random_index(topology.size())]};
+      const std::size_t length = random_index(30u);
+      for (std::size_t i = 0u; i < length; ++i) {
+        const auto next = path.back()->GetNextWaypoint();
+        if (next.empty()) {
+          break;
+        }
+        path.push_back(next[random_index(next.size())]);
+      }
+      return path;
+    };
+
+    TrackTraffic track_traffic;
+    ReferenceTrackTraffic reference;
+    ActorIdList overlapping;
+    for (int step = 0; step < NUMBER_OF_STEPS; ++step) {
+      const ActorId actor_id = static_cast<ActorId>(random_index(NUMBER_OF_ACTORS)) + 1u;
+      const std::size_t operation = random_index(10u);
+      if (operation < 6u) {
+        WaypointBuffer buffer(topology);
+        for (const auto &waypoint : random_path()) {
+          buffer.push_back(waypoint);
+        }
+        if (operation == 0u) {
+          buffer.clear();
+        }
+        track_traffic.UpdateGridPosition(actor_id, buffer);
+        reference.UpdateGridPosition(actor_id, buffer);
+      } else if (operation < 8u) {
+        const NodeList path = random_path();
+        track_traffic.UpdateUnregisteredGridPosition(actor_id, path);
+        reference.UpdateUnregisteredGridPosition(actor_id, path);
+      } else if (operation < 9u) {
+        track_traffic.DeleteActor(actor_id);
+        reference.DeleteActor(actor_id);
+      } else {
+        const GeoGridId grid_id = random_index(2u) == 0u ?
+            unused_grid_id :
+            topology[random_index(topology.size())]->GetGeodesicGridId();
+        track_traffic.AddTakenGrid(grid_id, actor_id);
+        reference.AddTakenGrid(grid_id, actor_id);
+      }
+
+      for (ActorId id = 1u; id <= NUMBER_OF_ACTORS; ++id) {
+        track_traffic.GetOverlappingVehicles(id, overlapping);
+        ASSERT_EQ(overlapping, reference.GetOverlappingVehicles(id)) << file << " step " << step;
+      }
+      for (const GeoGridId grid_id : grid_ids) {
+        ASSERT_EQ(track_traffic.IsGeoGridFree(grid_id), reference.IsGeoGridFree(grid_id))
+            << file << " step " << step;
+      }
+    }
+  }
+}
@@ -0,0 +1,67 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+#include "TrafficManagerSimulation.h"
+
+#include <unordered_map>
+
+using util::TrafficManagerSimulation;
+
+static constexpr std::size_t NUMBER_OF_VEHICLES = 50u;
+static constexpr int NUMBER_OF_CYCLES = 100;
+static constexpr uint64_t SEED = 42u;
+
+static uint64_t run_simulation(
+    const util::LocalMapPtr &local_map,
+    std::size_t collision_threads = 0u) {
+  TrafficManagerSimulation simulation(local_map, NUMBER_OF_VEHICLES, SEED, collision_threads);
+  for (int i = 0; i < NUMBER_OF_CYCLES; ++i) {
+    simulation.Tick();
+  }
+  if (simulation.GetNumberOfVehicles() > 0u) {
+    EXPECT_GT(simulation.GetDistanceTravelled(), 0.0f);
+  }
+  return simulation.GetChecksum();
+}
+
+TEST(traffic_manager_simulation, deterministic) {
+  for (const auto &file : util::OpenDrive::GetAvailableFiles()) {
+    const util::LocalMapPtr local_map = util::make_local_map(file);
+    ASSERT_EQ(run_simulation(local_map), run_simulation(local_map)) << file;
+  }
+}
+
+// The sharded collision stage finds the same hazards and samples the same
+// random numbers whatever the number of threads it runs on.
+TEST(traffic_manager_simulation, parallel_collision_stage) {
+  for (const auto &file : util::OpenDrive::GetAvailableFiles()) {
+    const util::LocalMapPtr local_map = util::make_local_map(file);
+    const uint64_t two_threads = run_simulation(local_map, 2u);
+    for (const std::size_t threads : {3u, 8u}) {
+      ASSERT_EQ(run_simulation(local_map, threads), two_threads) << file << " threads " << threads;
+    }
+  }
+}
+
+// Checksums of the collision hazards and commands produced by the stages. A
+// change in the behaviour of the vehicles changes these values; if intended,
+// update them with the ones printed by the failing test. Towns without a
+// stored checksum, such as the ones downloaded with the content, only log it.
+TEST(traffic_manager_simulation, checksum) {
+  const std::unordered_map<std::string, uint64_t> expected = {
+    {"TemplateOpenDrive.xodr", 12721925352020940769ull},
+  };
+  for (const auto &file : util::OpenDrive::GetAvailableFiles()) {
+    const uint64_t checksum = run_simulation(util::make_local_map(file));
+    const auto it = expected.find(file);
+    if (it == expected.end()) {
+      carla::logging::log("no stored checksum for", file, "checksum", checksum);
+      continue;
+    }
+    ASSERT_EQ(checksum, it->second) << file;
+  }
+}
@@ -0,0 +1,174 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+
+#include <carla/StopWatch.h>
+#include <carla/trafficmanager/WaypointBuffer.h>
+
+#include <chrono>
+#include <deque>
+#include <type_traits>
+#include <vector>
+
+using namespace carla::traffic_manager;
+
+// Buffers always refer to a topology, so there is no empty state to check.
+static_assert(!std::is_default_constructible<WaypointBuffer>::value, "WaypointBuffer needs a topology");
+static_assert(std::is_copy_assignable<WaypointBuffer>::value, "WaypointBuffer must stay assignable");
+
+// Dense topology of a map with the given number of waypoints. Only the
+// indices are used, so the waypoints do not wrap any road waypoint.
+static NodeList make_topology(std::size_t number_of_waypoints) {
+  NodeList topology;
+  for (auto i = 0u; i < number_of_waypoints; ++i) {
+    auto waypoint = std::make_shared<SimpleWaypoint>(nullptr);
+    waypoint->SetIndex(static_cast<uint32_t>(i));
+    topology.push_back(waypoint);
+  }
+  return topology;
+}
+
+TEST(waypoint_buffer, push_and_pop) {
+  const NodeList topology = make_topology(300u);
+  WaypointBuffer buffer(topology);
+  ASSERT_TRUE(buffer.empty());
+
+  // Push past the initial capacity while popping from the front, so the ring
+  // both wraps around and grows.
+  std::deque<SimpleWaypointPtr> expected;
+  for (auto i = 0u; i < 200u; ++i) {
+    buffer.push_back(topology[i]);
+    expected.push_back(topology[i]);
+    if (i % 3u == 0u) {
+      buffer.pop_front();
+      expected.pop_front();
+    }
+  }
+  buffer.pop_back();
+  expected.pop_back();
+
+  ASSERT_EQ(buffer.size(), expected.size());
+  ASSERT_GE(buffer.capacity(), buffer.size());
+  ASSERT_EQ(buffer.front(), expected.front());
+  ASSERT_EQ(buffer.back(), expected.back());
+  for (auto i = 0u; i < expected.size(); ++i) {
+    ASSERT_EQ(buffer.at(i), expected[i]);
+    ASSERT_EQ(buffer.GetIndex(i), expected[i]->GetIndex());
+  }
+  auto expected_it = expected.begin();
+  for (const SimpleWaypointPtr &waypoint : buffer) {
+    ASSERT_EQ(waypoint, *expected_it++);
+  }
+  ASSERT_THROW(buffer.at(expected.size()), std::out_of_range);
+
+  buffer.clear();
+  ASSERT_TRUE(buffer.empty());
+  ASSERT_TRUE(buffer.begin() == buffer.end());
+}
+
+// Allocator counting the bytes held by the containers it is used with.
+template <typename T>
+struct CountingAllocator {
+  using value_type = T;
+
+  std::size_t *bytes;
+
+  explicit CountingAllocator(std::size_t *bytes) : bytes(bytes) {}
+
+  template <typename U>
+  CountingAllocator(const CountingAllocator<U> &other) : bytes(other.bytes) {}
+
+  T *allocate(std::size_t n) {
+    *bytes += n * sizeof(T);
+    return std::allocator<T>().allocate(n);
+  }
+
+  void deallocate(T *p, std::size_t n) {
+    *bytes -= n * sizeof(T);
+    std::allocator<T>().deallocate(p, n);
+  }
+
+  template <typename U>
+  bool operator==(const CountingAllocator<U> &other) const {
+    return bytes == other.bytes;
+  }
+
+  template <typename U>
+  bool operator!=(const CountingAllocator<U> &other) const {
+    return bytes != other.bytes;
+  }
+};
+
+// Replays the buffer traffic of the localization stage: every tick each
+// vehicle drops the waypoint it passed, extends its path by one waypoint and
+// scans the path ahead.
+TEST(benchmark_waypoint_buffer, paths) {
+  constexpr auto number_of_vehicles = 1000u;
+  constexpr auto number_of_ticks = 200u;
+  constexpr auto path_length = 24u;
+  // Roughly the number of waypoints of a Town10 sized map at 5 m resolution.
+  constexpr auto number_of_waypoints = 25000u;
+  const NodeList topology = make_topology(number_of_waypoints);
+
+  auto waypoint_at = [&](std::size_t vehicle, std::size_t step) -> const SimpleWaypointPtr & {
+    return topology[(vehicle * 97u + step) % number_of_waypoints];
+  };
+
+  std::size_t deque_bytes = 0u;
+  using Deque = std::deque<SimpleWaypointPtr, CountingAllocator<SimpleWaypointPtr>>;
+  std::vector<Deque> deques;
+  std::vector<WaypointBuffer> buffers;
+  for (auto i = 0u; i < number_of_vehicles; ++i) {
+    deques.emplace_back(CountingAllocator<SimpleWaypointPtr>(&deque_bytes));
+    buffers.emplace_back(topology);
+    for (auto j = 0u; j < path_length; ++j) {
+      deques.back().push_back(waypoint_at(i, j));
+      buffers.back().push_back(waypoint_at(i, j));
+    }
+  }
+
+  uint64_t deque_checksum = 0u;
+  carla::StopWatch deque_watch;
+  for (auto tick = 0u; tick < number_of_ticks; ++tick) {
+    for (auto i = 0u; i < number_of_vehicles; ++i) {
+      Deque &path = deques[i];
+      path.pop_front();
+      SimpleWaypointPtr next = waypoint_at(i, tick + path_length);
+      path.push_back(next);
+      for (const SimpleWaypointPtr &waypoint : path) {
+        deque_checksum += waypoint->GetIndex();
+      }
+    }
+  }
+  deque_watch.Stop();
+
+  uint64_t buffer_checksum = 0u;
+  carla::StopWatch buffer_watch;
+  for (auto tick = 0u; tick < number_of_ticks; ++tick) {
+    for (auto i = 0u; i < number_of_vehicles; ++i) {
+      WaypointBuffer &path = buffers[i];
+      path.pop_front();
+      SimpleWaypointPtr next = waypoint_at(i, tick + path_length);
+      path.push_back(next);
+      for (const SimpleWaypointPtr &waypoint : path) {
+        buffer_checksum += waypoint->GetIndex();
+      }
+    }
+  }
+  buffer_watch.Stop();
+
+  ASSERT_EQ(deque_checksum, buffer_checksum);
+
+  std::size_t buffer_bytes = 0u;
+  for (const WaypointBuffer &buffer : buffers) {
+    buffer_bytes += buffer.capacity() * sizeof(WaypointBuffer::WaypointIndex);
+  }
+  carla::logging::log(
+      "waypoint buffers for", number_of_vehicles, "vehicles,", number_of_ticks, "ticks:",
+      "deque", deque_watch.GetElapsedTime<std::chrono::microseconds>(), "us,", deque_bytes, "bytes;",
+      "ring", buffer_watch.GetElapsedTime<std::chrono::microseconds>(), "us,", buffer_bytes, "bytes");
+}
@@ -13,6 +13,7 @@
 #include <list>
 #include <set>
 #include <string>
+#include <thread>
 #include <vector>
 
 using namespace util::buffer;
@@ -134,3 +135,89 @@ TEST(buffer, buffer_pool) {
   // Now delete the pool to test the weak reference inside the buffers.
   pool.reset();
 }
+
+TEST(buffer, buffer_pool_buckets) {
+  auto pool = std::make_shared<carla::BufferPool>();
+  const auto big_capacity = carla::BufferPool::GetBucketCapacity(1920u * 1080u * 4u);
+  ASSERT_GE(big_capacity, 1920u * 1080u * 4u);
+  ASSERT_LE(big_capacity, 1920u * 1080u * 5u);
+  {
+    auto big = pool->Pop(1920u * 1080u * 4u);
+    ASSERT_EQ(big.size(), 1920u * 1080u * 4u);
+    ASSERT_EQ(big.capacity(), big_capacity);
+    auto small = pool->Pop(100u);
+    ASSERT_EQ(small.size(), 100u);
+    ASSERT_EQ(small.capacity(), carla::BufferPool::GetBucketCapacity(100u));
+  }
+  auto stats = pool->GetStatistics();
+  ASSERT_EQ(stats.hits, 0u);
+  ASSERT_EQ(stats.misses, 2u);
+  ASSERT_EQ(stats.retained_bytes, big_capacity + carla::BufferPool::GetBucketCapacity(100u));
+  {
+    // Small messages do not get the big buffer.
+    auto small = pool->Pop(90u);
+    ASSERT_EQ(small.capacity(), carla::BufferPool::GetBucketCapacity(100u));
+    auto big = pool->Pop(1920u * 1080u * 4u - 1u);
+    ASSERT_EQ(big.capacity(), big_capacity);
+    ASSERT_EQ(pool->GetStatistics().retained_bytes, 0u);
+  }
+  stats = pool->GetStatistics();
+  ASSERT_EQ(stats.hits, 2u);
+  ASSERT_EQ(stats.misses, 2u);
+  ASSERT_EQ(stats.high_water_mark, stats.retained_bytes);
+}
+
+TEST(buffer, buffer_pool_max_retained_bytes) {
+  constexpr size_t size = 1000u;
+  const auto capacity = carla::BufferPool::GetBucketCapacity(size);
+  auto pool = std::make_shared<carla::BufferPool>();
+  pool->SetMaxRetainedBytes(2u * capacity);
+  {
+    std::vector<Buffer> buffers;
+    for (auto i = 0u; i < 5u; ++i) {
+      buffers.emplace_back(pool->Pop(size));
+    }
+  }
+  auto stats = pool->GetStatistics();
+  ASSERT_EQ(stats.misses, 5u);
+  ASSERT_EQ(stats.discarded, 3u);
+  ASSERT_EQ(stats.retained_bytes, 2u * capacity);
+  ASSERT_EQ(stats.high_water_mark, 2u * capacity);
+
+  pool->SetMaxRetainedBytes(capacity);
+  ASSERT_EQ(pool->GetStatistics().retained_bytes, capacity);
+  pool->Trim();
+  stats = pool->GetStatistics();
+  ASSERT_EQ(stats.retained_bytes, 0u);
+  ASSERT_EQ(stats.discarded, 5u);
+  ASSERT_EQ(stats.high_water_mark, 2u * capacity);
+
+  // Trimmed buffers are gone for good.
+  auto buffer = pool->Pop(size);
+  ASSERT_EQ(pool->GetStatistics().misses, 6u);
+}
+
+TEST(buffer, buffer_pool_concurrent) {
+  constexpr auto number_of_threads = 4u;
+  constexpr auto number_of_iterations = 1000u;
+  auto pool = std::make_shared<carla::BufferPool>();
+  pool->SetMaxRetainedBytes(1u << 20u);
+  std::vector<std::thread> threads;
+  for (auto t = 0u; t < number_of_threads; ++t) {
+    threads.emplace_back([pool, t]() {
+      for (auto i = 0u; i < number_of_iterations; ++i) {
+        const size_t size = 16u << ((i + t) % 14u);
+        auto buffer = pool->Pop(size);
+        ASSERT_EQ(buffer.size(), size);
+        buffer.data()[size - 1u] = 42u;
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  const auto stats = pool->GetStatistics();
+  ASSERT_EQ(stats.hits + stats.misses, number_of_threads * number_of_iterations);
+  ASSERT_LE(stats.retained_bytes, 1u << 20u);
+  ASSERT_LE(stats.high_water_mark, 1u << 20u);
+}
@@ -6,8 +6,44 @@
 
 #include "test.h"
 
+#include <carla/ThreadPool.h>
 #include <carla/Version.h>
 
+#include <thread>
+#include <vector>
+
 TEST(miscellaneous, version) {
   std::cout << "LibCarla " << carla::version() << std::endl;
 }
+
+TEST(miscellaneous, parallel_for_chunks) {
+  constexpr size_t number_of_threads = 4u;
+  constexpr size_t size = 1003u;
+  carla::ThreadPool thread_pool;
+  thread_pool.AsyncRun(number_of_threads);
+
+  std::vector<size_t> chunks(size, number_of_threads);
+  std::vector<std::thread::id> threads(size);
+  thread_pool.ParallelForChunks(size, [&](size_t index, size_t chunk) {
+    chunks[index] = chunk;
+    threads[index] = std::this_thread::get_id();
+  });
+  // Chunks are contiguous, in order, and each runs in a single thread.
+  ASSERT_EQ(chunks.front(), 0u);
+  ASSERT_EQ(chunks.back(), number_of_threads - 1u);
+  for (size_t index = 1u; index < size; ++index) {
+    ASSERT_TRUE(chunks[index] == chunks[index - 1u] || chunks[index] == chunks[index - 1u] + 1u);
+    if (chunks[index] == chunks[index - 1u]) {
+      ASSERT_EQ(threads[index], threads[index - 1u]);
+    }
+  }
+
+  // Without threads everything runs in this thread as chunk zero.
+  carla::ThreadPool serial_pool;
+  size_t count = 0u;
+  serial_pool.ParallelForChunks(size, [&](size_t, size_t chunk) {
+    ASSERT_EQ(chunk, 0u);
+    ++count;
+  });
+  ASSERT_EQ(count, size);
+}
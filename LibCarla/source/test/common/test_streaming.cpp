@@ -8,14 +8,29 @@
 
 #include <carla/ThreadGroup.h>
 #include <carla/streaming/Client.h>
+#include <carla/BufferPool.h>
 #include <carla/streaming/Server.h>
+#include <carla/streaming/detail/Compression.h>
 #include <carla/streaming/detail/Dispatcher.h>
+#include <carla/streaming/detail/shm/Ring.h>
 #include <carla/streaming/detail/tcp/Client.h>
 #include <carla/streaming/detail/tcp/Server.h>
 #include <carla/streaming/low_level/Client.h>
 #include <carla/streaming/low_level/Server.h>
 
+#include <boost/asio/read.hpp>
+#include <boost/asio/write.hpp>
+
 #include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <future>
+#include <limits>
+#include <mutex>
+#include <vector>
+
+#include <sys/wait.h>
+#include <unistd.h>
 
 using namespace std::chrono_literals;
 
@@ -277,3 +292,658 @@ TEST(streaming, multi_stream) {
     }
   }
 }
+
+TEST(streaming, low_level_tcp_send_queue) {
+  using namespace carla::streaming;
+  using namespace carla::streaming::detail;
+
+  constexpr size_t number_of_messages = 500u;
+
+  // Synchronous mode always blocks.
+  const std::vector<std::pair<bool, tcp::SendQueuePolicy>> configurations = {
+    {true, tcp::SendQueuePolicy::KeepLatest},
+    {false, tcp::SendQueuePolicy::DropOldest},
+    {false, tcp::SendQueuePolicy::KeepLatest}};
+  for (const auto &configuration : configurations) {
+    const bool synchronous = configuration.first;
+    io_context_running io;
+    tcp::Server srv(io.service, tcp::Server::endpoint(boost::asio::ip::tcp::v4(), TESTING_PORT));
+    srv.SetTimeout(1s);
+    srv.SetSynchronousMode(synchronous);
+    srv.SetSendQueueCapacity(2u);
+    srv.SetSendQueuePolicy(configuration.second);
+
+    std::promise<std::shared_ptr<tcp::ServerSession>> opened;
+    srv.Listen(
+        [&](std::shared_ptr<tcp::ServerSession> session) { opened.set_value(session); },
+        [](std::shared_ptr<tcp::ServerSession>) {});
+
+    std::atomic_size_t message_count{0u};
+    std::atomic_size_t last_received{0u};
+    std::atomic_bool in_order{true};
+    std::promise<void> received_last;
+    Dispatcher dispatcher{make_endpoint<tcp::Client::protocol_type>(srv.GetLocalEndpoint())};
+    auto stream = dispatcher.MakeStream();
+    auto c = std::make_shared<tcp::Client>(io.service, stream.token(), [&](carla::Buffer message) {
+      ASSERT_EQ(message.size(), sizeof(size_t));
+      size_t index;
+      std::memcpy(&index, message.data(), sizeof(size_t));
+      if (message_count > 0u && index <= last_received) {
+        in_order = false;
+      }
+      last_received = index;
+      ++message_count;
+      if (index == number_of_messages - 1u) {
+        received_last.set_value();
+      }
+    });
+    c->Connect();
+
+    auto session = opened.get_future().get();
+    for (size_t i = 0u; i < number_of_messages; ++i) {
+      carla::Buffer buffer(boost::asio::buffer(&i, sizeof(size_t)));
+      session->Write(carla::BufferView::CreateFrom(std::move(buffer)));
+    }
+
+    // The newest message is never discarded.
+    ASSERT_EQ(received_last.get_future().wait_for(1s), std::future_status::ready);
+    // The session counts a write once it completes, which may be after the
+    // client got it.
+    const auto deadline = std::chrono::steady_clock::now() + 1s;
+    auto stats = session->GetSendQueueStats();
+    while ((stats.sent_messages + stats.dropped_messages < number_of_messages) &&
+           (std::chrono::steady_clock::now() < deadline)) {
+      std::this_thread::yield();
+      stats = session->GetSendQueueStats();
+    }
+    c->Stop();
+
+    ASSERT_TRUE(in_order);
+    ASSERT_EQ(stats.queued_messages, number_of_messages);
+    ASSERT_EQ(stats.queued_bytes, number_of_messages * sizeof(size_t));
+    ASSERT_EQ(stats.sent_messages + stats.dropped_messages, number_of_messages);
+    ASSERT_EQ(stats.dropped_bytes, stats.dropped_messages * sizeof(size_t));
+    ASSERT_EQ(stats.sent_bytes, stats.sent_messages * sizeof(size_t));
+    ASSERT_EQ(stats.sent_messages, message_count);
+    if (synchronous) {
+      // Blocking on a full queue never discards messages.
+      ASSERT_EQ(stats.dropped_messages, 0u);
+    }
+
+    // The server counts the messages of all its sessions.
+    const auto server_stats = srv.GetSendQueueStats();
+    ASSERT_EQ(server_stats.queued_messages, stats.queued_messages);
+    ASSERT_EQ(server_stats.dropped_messages, stats.dropped_messages);
+    ASSERT_EQ(server_stats.sent_messages, stats.sent_messages);
+    ASSERT_EQ(server_stats.sent_bytes, stats.sent_bytes);
+
+    io.service.stop();
+  }
+}
+
+TEST(streaming, send_queue_stats) {
+  using namespace carla::streaming;
+  using namespace carla::streaming::detail;
+  constexpr size_t number_of_messages = 20u;
+  const std::string message_text = "Hello client!";
+
+  Server srv(TESTING_PORT);
+  srv.AsyncRun(2u);
+  srv.SetSynchronousMode(true);
+  auto stream = srv.MakeStream();
+
+  for (auto n = 0u; n < 2u; ++n) {
+    std::mutex mutex;
+    std::condition_variable received;
+    size_t message_count = 0u;
+    {
+      Client c;
+      c.AsyncRun(1u);
+      c.Subscribe(stream.token(), [&](carla::Buffer) {
+        std::lock_guard<std::mutex> lock(mutex);
+        ++message_count;
+        received.notify_all();
+      });
+      // Write until the session is registered.
+      carla::Buffer buffer(boost::asio::buffer(message_text));
+      auto view = carla::BufferView::CreateFrom(std::move(buffer));
+      std::unique_lock<std::mutex> lock(mutex);
+      for (auto i = 0u; (i < 500u) && (message_count == 0u); ++i) {
+        lock.unlock();
+        carla::SharedBufferView copy = view;
+        stream.Write(copy);
+        lock.lock();
+        received.wait_for(lock, 2ms, [&]() { return message_count > 0u; });
+      }
+      ASSERT_GT(message_count, 0u);
+      const size_t before = message_count;
+      lock.unlock();
+      for (auto i = 0u; i < number_of_messages; ++i) {
+        carla::SharedBufferView copy = view;
+        stream.Write(copy);
+      }
+      lock.lock();
+      ASSERT_TRUE(received.wait_for(lock, 1s, [&]() {
+        return message_count == before + number_of_messages;
+      }));
+    } // the client disconnects here.
+  }
+
+  // Both sessions count, although the first one is closed.
+  const auto stats = srv.GetSendQueueStats();
+  ASSERT_GE(stats.queued_messages, 2u * (number_of_messages + 1u));
+  ASSERT_EQ(stats.dropped_messages, 0u);
+  ASSERT_EQ(stats.queued_bytes, stats.queued_messages * message_text.size());
+}
+
+TEST(streaming, make_buffer_size_hint) {
+  using namespace carla::streaming;
+  constexpr size_t size = 300u * 1024u;
+
+  Server srv(TESTING_PORT);
+  srv.AsyncRun(1u);
+  auto stream = srv.MakeStream();
+
+  // Buffers without a size are popped the size of the last message written.
+  {
+    carla::Buffer buffer = stream.MakeBuffer(size);
+    stream.Write(carla::BufferView::CreateFrom(std::move(buffer)));
+  }
+  carla::Buffer buffer = stream.MakeBuffer();
+  ASSERT_EQ(buffer.size(), size);
+  ASSERT_GE(buffer.capacity(), size);
+}
+
+TEST(streaming, shared_memory_ring) {
+  using namespace carla::streaming::detail;
+  if (!shm::IsSupported()) {
+    return;
+  }
+  const std::string name = "/carla-streaming-test-ring";
+  auto ring = shm::Ring::Create(name, 4u, 64u);
+  auto reader = shm::Ring::Open(name);
+  ASSERT_NE(reader, nullptr);
+  ASSERT_EQ(reader->GetNumberOfSlots(), 4u);
+  ASSERT_EQ(reader->GetSlotCapacity(), 64u);
+
+  carla::Buffer buffer;
+  ASSERT_FALSE(reader->Read(1u, buffer));
+  for (size_t i = 1u; i <= 10u; ++i) {
+    carla::Buffer header(boost::asio::buffer(&i, sizeof(i)));
+    const std::string text = "message " + std::to_string(i);
+    carla::Buffer body(boost::asio::buffer(text));
+    tcp::Message message(
+        carla::BufferView::CreateFrom(std::move(header)),
+        carla::BufferView::CreateFrom(std::move(body)));
+    ring->Publish(message);
+  }
+  ASSERT_EQ(reader->GetSequence(), 10u);
+
+  // Only the last four messages are kept.
+  ASSERT_FALSE(reader->Read(6u, buffer));
+  for (size_t i = 7u; i <= 10u; ++i) {
+    ASSERT_TRUE(reader->Read(i, buffer));
+    size_t index;
+    std::memcpy(&index, buffer.data(), sizeof(index));
+    ASSERT_EQ(index, i);
+    const std::string text(
+        reinterpret_cast<const char *>(buffer.data()) + sizeof(index),
+        buffer.size() - sizeof(index));
+    ASSERT_EQ(text, "message " + std::to_string(i));
+  }
+  ASSERT_FALSE(reader->Read(11u, buffer));
+
+  ring->Invalidate(false);
+  ASSERT_TRUE(reader->IsClosed());
+  ring.reset();
+  ASSERT_EQ(shm::Ring::Open(name), nullptr);
+}
+
+TEST(streaming, shared_memory_readers) {
+  using namespace carla::streaming::detail;
+  if (!shm::IsSupported()) {
+    return;
+  }
+  const std::string name = "/carla-streaming-test-readers";
+  auto ring = shm::Ring::Create(name, 4u, 64u);
+  auto reader = shm::Ring::Open(name);
+  ASSERT_NE(reader, nullptr);
+  const auto id = shm::Ring::MakeReaderId();
+  const auto slot = reader->AttachReader(id);
+  ASSERT_NE(slot, shm::Ring::INVALID_READER);
+  ASSERT_EQ(reader->AttachReader(id, slot), slot);
+  ASSERT_EQ(ring->GetNumberOfReaders(), 1u);
+
+  // A reader that exits without detaching.
+  const pid_t pid = fork();
+  ASSERT_NE(pid, -1);
+  if (pid == 0) {
+    auto child = shm::Ring::Open(name);
+    const auto child_id = shm::Ring::MakeReaderId();
+    _exit(((child != nullptr) && (child->AttachReader(child_id) != shm::Ring::INVALID_READER)) ? 0 : 1);
+  }
+  int status = 0;
+  ASSERT_EQ(waitpid(pid, &status, 0), pid);
+  ASSERT_TRUE(WIFEXITED(status));
+  ASSERT_EQ(WEXITSTATUS(status), 0);
+  ASSERT_EQ(ring->GetNumberOfReaders(), 2u);
+
+  // Readers are freed by their heartbeat, not their process id; only the one
+  // that stopped sending heartbeats is freed once the timeout expires.
+  const auto timeout = carla::time_duration::milliseconds(20u);
+  ASSERT_EQ(ring->ReclaimReaders(timeout), 0u);
+  ASSERT_TRUE(reader->Heartbeat(id, slot));
+  ASSERT_EQ(ring->ReclaimReaders(timeout), 0u);
+  std::this_thread::sleep_for(timeout.to_chrono());
+  ASSERT_TRUE(reader->Heartbeat(id, slot));
+  ASSERT_EQ(ring->ReclaimReaders(timeout), 1u);
+  ASSERT_EQ(ring->GetNumberOfReaders(), 1u);
+
+  // A reader that was freed finds out on its next heartbeat.
+  std::this_thread::sleep_for(timeout.to_chrono());
+  ASSERT_EQ(ring->ReclaimReaders(timeout), 1u);
+  ASSERT_EQ(ring->GetNumberOfReaders(), 0u);
+  ASSERT_FALSE(reader->Heartbeat(id, slot));
+  ASSERT_EQ(reader->AttachReader(id), slot);
+  ASSERT_TRUE(reader->Heartbeat(id, slot));
+
+  // Readers keep their slot in a replacement segment.
+  ring->Unlink();
+  auto replacement = shm::Ring::Create(name, 4u, 128u);
+  replacement->CopyReaders(*ring);
+  ring->Invalidate(true);
+  ASSERT_TRUE(reader->IsReplaced());
+  reader = shm::Ring::Open(name);
+  ASSERT_NE(reader, nullptr);
+  ASSERT_EQ(reader->AttachReader(id, slot), slot);
+  ASSERT_EQ(replacement->GetNumberOfReaders(), 1u);
+
+  // Detaching with another id leaves the slot alone.
+  reader->DetachReader(id + 1u, slot);
+  ASSERT_EQ(replacement->GetNumberOfReaders(), 1u);
+  reader->DetachReader(id, slot);
+  ASSERT_EQ(replacement->GetNumberOfReaders(), 0u);
+}
+
+TEST(streaming, shared_memory_stream) {
+  using namespace carla::streaming;
+  using namespace carla::streaming::detail;
+  using namespace util::buffer;
+  if (!shm::IsSupported()) {
+    return;
+  }
+  constexpr size_t number_of_messages = 100u;
+  const auto pattern = [](size_t size, size_t index) {
+    return static_cast<unsigned char>((size + index) % 251u);
+  };
+  const auto wait_until = [](auto &&predicate) {
+    const auto deadline = std::chrono::steady_clock::now() + 1s;
+    while (!predicate() && (std::chrono::steady_clock::now() < deadline)) {
+      std::this_thread::yield();
+    }
+    return predicate();
+  };
+
+  Server srv(TESTING_PORT);
+  srv.SetSharedMemoryTransport(true);
+  srv.AsyncRun(2u);
+  auto stream = srv.MakeStream();
+  ASSERT_TRUE(token_type(stream.token()).protocol_is_shared_memory());
+  ASSERT_FALSE(stream.AreClientsListening());
+
+  std::mutex mutex;
+  std::condition_variable received;
+  size_t last_size = 0u;
+  size_t message_count = 0u;
+  bool is_valid = true;
+  {
+    Client c;
+    c.AsyncRun(2u);
+    c.Subscribe(stream.token(), [&](carla::Buffer message) {
+      bool is_message_valid = true;
+      for (size_t i = 0u; i < message.size(); ++i) {
+        is_message_valid &= (message.data()[i] == pattern(message.size(), i));
+      }
+      std::lock_guard<std::mutex> lock(mutex);
+      is_valid &= is_message_valid;
+      last_size = message.size();
+      ++message_count;
+      received.notify_all();
+    });
+    ASSERT_TRUE(wait_until([&]() { return stream.AreClientsListening(); }));
+    // The client reads from the segment, not from a TCP session.
+    auto ring = shm::Ring::Open(shm::MakeSegmentName(stream.token()));
+    ASSERT_NE(ring, nullptr);
+    ASSERT_EQ(ring->GetNumberOfReaders(), 1u);
+
+    // Messages grow past the initial capacity of the segment, which is
+    // replaced under the reader. Each one is written once the previous one
+    // arrived, so none is skipped.
+    for (size_t i = 1u; i <= number_of_messages; ++i) {
+      const size_t size = i * 1024u;
+      carla::Buffer buffer = stream.MakeBuffer();
+      buffer.reset(size);
+      for (size_t j = 0u; j < size; ++j) {
+        buffer.data()[j] = pattern(size, j);
+      }
+      stream.Write(carla::BufferView::CreateFrom(std::move(buffer)));
+      std::unique_lock<std::mutex> lock(mutex);
+      ASSERT_TRUE(received.wait_for(lock, 1s, [&]() { return last_size == size; }));
+    }
+  } // client detaches here.
+  ASSERT_TRUE(is_valid);
+  ASSERT_EQ(message_count, number_of_messages);
+  ASSERT_TRUE(wait_until([&]() { return !stream.AreClientsListening(); }));
+}
+
+TEST(streaming, shared_memory_slow_callback) {
+  using namespace carla::streaming;
+  using namespace carla::streaming::detail;
+  if (!shm::IsSupported()) {
+    return;
+  }
+  constexpr size_t number_of_messages = 50u;
+
+  Server srv(TESTING_PORT);
+  srv.SetSharedMemoryTransport(true);
+  srv.AsyncRun(2u);
+  auto stream = srv.MakeStream();
+
+  std::promise<void> callback_entered;
+  std::promise<void> release_callback;
+  auto released = release_callback.get_future().share();
+  std::mutex mutex;
+  std::condition_variable received;
+  std::vector<size_t> messages;
+  Client c;
+  c.AsyncRun(2u);
+  c.Subscribe(stream.token(), [&](carla::Buffer message) {
+    size_t index;
+    std::memcpy(&index, message.data(), sizeof(index));
+    if (index == 0u) {
+      callback_entered.set_value();
+      released.wait();
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    messages.emplace_back(index);
+    received.notify_all();
+  });
+  const auto write = [&](size_t index) {
+    carla::Buffer buffer(boost::asio::buffer(&index, sizeof(index)));
+    stream.Write(carla::BufferView::CreateFrom(std::move(buffer)));
+  };
+
+  // Keep writing the first message until the client gets it.
+  auto entered = callback_entered.get_future();
+  for (auto i = 0u; (i < 500u) && (entered.wait_for(2ms) != std::future_status::ready); ++i) {
+    write(0u);
+  }
+  ASSERT_EQ(entered.wait_for(1s), std::future_status::ready);
+
+  // While the callback blocks, nothing else is handed to the io_context.
+  for (size_t i = 1u; i <= number_of_messages; ++i) {
+    write(i);
+  }
+  release_callback.set_value();
+
+  // Only the newest message is delivered afterwards.
+  std::unique_lock<std::mutex> lock(mutex);
+  ASSERT_TRUE(received.wait_for(lock, 1s, [&]() {
+    return !messages.empty() && (messages.back() == number_of_messages);
+  }));
+  ASSERT_EQ(messages.size(), 2u);
+  ASSERT_EQ(messages.front(), 0u);
+}
+
+/// Segmentation-like frame, a few values with long runs that shift by @a frame
+/// pixels each frame.
+static carla::Buffer MakeSegmentationFrame(size_t frame, size_t size) {
+  carla::Buffer buffer(size);
+  for (size_t i = 0u; i < size; ++i) {
+    buffer.data()[i] = static_cast<unsigned char>(((i + frame) / 512u) % 7u);
+  }
+  return buffer;
+}
+
+TEST(streaming, compression_round_trip) {
+  using namespace carla::streaming::detail;
+  constexpr size_t size = 64u * 1024u;
+  for (auto codec : {Codec::LZ4, Codec::Zstd}) {
+    if (!IsCodecSupported(codec)) {
+      continue;
+    }
+    for (auto delta : {false, true}) {
+      CompressionSettings settings;
+      settings.codec = codec;
+      settings.delta = delta;
+      settings.keyframe_interval = 4u;
+      Compressor compressor(codec, settings);
+      Decompressor decompressor(std::make_shared<carla::BufferPool>());
+      for (size_t frame = 0u; frame < 10u; ++frame) {
+        carla::Buffer header(boost::asio::buffer(&frame, sizeof(frame)));
+        auto body = MakeSegmentationFrame(frame, size);
+        auto message = compressor.Compress({header.cbuffer(), body.cbuffer()});
+        ASSERT_LT(message.size(), size / 4u);
+        compression_header info;
+        std::memcpy(&info, message.data(), sizeof(info));
+        ASSERT_EQ(info.codec, codec);
+        ASSERT_EQ(info.raw_size, sizeof(frame) + size);
+        ASSERT_EQ((info.flags & compression_header::delta) != 0u, delta && (frame % 4u != 0u));
+        if (delta && frame == 5u) {
+          // Lost, the following delta frames cannot be decoded.
+          continue;
+        }
+        const bool decoded = decompressor.Decompress(message);
+        if (delta && (frame == 6u || frame == 7u)) {
+          ASSERT_FALSE(decoded);
+          continue;
+        }
+        ASSERT_TRUE(decoded);
+        ASSERT_EQ(message.size(), sizeof(frame) + size);
+        ASSERT_EQ(std::memcmp(message.data(), &frame, sizeof(frame)), 0);
+        ASSERT_EQ(std::memcmp(message.data() + sizeof(frame), body.data(), size), 0);
+      }
+    }
+  }
+}
+
+TEST(streaming, compression_incompressible) {
+  using namespace carla::streaming::detail;
+  for (auto codec : {Codec::LZ4, Codec::Zstd}) {
+    if (!IsCodecSupported(codec)) {
+      continue;
+    }
+    CompressionSettings settings;
+    settings.codec = codec;
+    Compressor compressor(codec, settings);
+    Decompressor decompressor(std::make_shared<carla::BufferPool>());
+    auto body = util::buffer::make_random(4096u);
+    auto message = compressor.Compress({body->cbuffer()});
+    compression_header info;
+    std::memcpy(&info, message.data(), sizeof(info));
+    // Sent raw instead.
+    ASSERT_EQ(info.codec, Codec::None);
+    ASSERT_EQ(message.size(), sizeof(info) + body->size());
+    ASSERT_TRUE(decompressor.Decompress(message));
+    ASSERT_EQ(message.size(), body->size());
+    ASSERT_EQ(std::memcmp(message.data(), body->data(), body->size()), 0);
+  }
+}
+
+TEST(streaming, compressed_stream) {
+  using namespace carla::streaming;
+  using namespace carla::streaming::detail;
+  constexpr size_t number_of_messages = 50u;
+  constexpr size_t size = 32u * 1024u;
+  for (auto codec : {Codec::None, Codec::LZ4, Codec::Zstd}) {
+    if (!IsCodecSupported(codec)) {
+      continue;
+    }
+    Server srv(TESTING_PORT);
+    srv.AsyncRun(2u);
+    auto stream = srv.MakeStream();
+    CompressionSettings settings;
+    settings.codec = codec;
+    settings.delta = true;
+    stream.SetCompression(settings);
+
+    std::atomic_size_t message_count{0u};
+    std::atomic_bool valid{true};
+    Client c;
+    c.AsyncRun(2u);
+    c.SetCompressionEnabled(true);
+    c.Subscribe(stream.token(), [&](carla::Buffer message) {
+      size_t frame;
+      std::memcpy(&frame, message.data(), sizeof(frame));
+      const auto expected = MakeSegmentationFrame(frame, size);
+      if ((message.size() != sizeof(frame) + size) ||
+          (std::memcmp(message.data() + sizeof(frame), expected.data(), size) != 0)) {
+        valid = false;
+      }
+      ++message_count;
+    });
+    std::this_thread::sleep_for(100ms);
+
+    for (size_t frame = 0u; frame < number_of_messages; ++frame) {
+      std::this_thread::sleep_for(2ms);
+      carla::Buffer header(boost::asio::buffer(&frame, sizeof(frame)));
+      stream.Write(
+          carla::BufferView::CreateFrom(std::move(header)),
+          carla::BufferView::CreateFrom(MakeSegmentationFrame(frame, size)));
+    }
+    std::this_thread::sleep_for(100ms);
+    ASSERT_TRUE(valid);
+    ASSERT_GE(message_count, number_of_messages - 3u);
+  }
+}
+
+TEST(streaming, compression_limits_decompressed_size) {
+  using namespace carla::streaming::detail;
+  constexpr message_size_type max_raw_size = 1024u;
+  Decompressor decompressor(std::make_shared<carla::BufferPool>(), max_raw_size);
+  for (auto raw_size : {max_raw_size, max_raw_size + 1u, std::numeric_limits<message_size_type>::max()}) {
+    compression_header header;
+    header.raw_size = raw_size;
+    carla::Buffer message(sizeof(header) + max_raw_size);
+    std::memset(message.data(), 7, message.size());
+    std::memcpy(message.data(), &header, sizeof(header));
+    if (raw_size > max_raw_size) {
+      ASSERT_FALSE(decompressor.Decompress(message));
+    } else {
+      ASSERT_TRUE(decompressor.Decompress(message));
+      ASSERT_EQ(message.size(), max_raw_size);
+      ASSERT_EQ(message.data()[max_raw_size - 1u], 7u);
+    }
+  }
+}
+
+TEST(streaming, compression_plain_handshake) {
+  using namespace carla::streaming;
+  using namespace carla::streaming::detail;
+  const std::string message_text = "Hello client!";
+
+  Server srv(TESTING_PORT);
+  srv.AsyncRun(2u);
+  auto stream = srv.MakeStream();
+  CompressionSettings settings;
+  settings.codec = IsCodecSupported(Codec::LZ4) ? Codec::LZ4 : Codec::None;
+  stream.SetCompression(settings);
+
+  // Subscribe like a client without compression support, sending only the
+  // stream id.
+  token_type token(stream.token());
+  if (!token.has_address()) {
+    token.set_address(make_localhost_address());
+  }
+  boost::asio::io_context io_context;
+  boost::asio::ip::tcp::socket socket(io_context);
+  boost::system::error_code ec;
+  socket.connect(token.to_tcp_endpoint(), ec);
+  ASSERT_FALSE(ec);
+  const stream_id_type stream_id = token.get_stream_id();
+  boost::asio::write(socket, boost::asio::buffer(&stream_id, sizeof(stream_id)), ec);
+  ASSERT_FALSE(ec);
+
+  auto received = std::async(std::launch::async, [&]() {
+    boost::system::error_code read_ec;
+    message_size_type size = 0u;
+    boost::asio::read(socket, boost::asio::buffer(&size, sizeof(size)), read_ec);
+    std::string text(read_ec ? 0u : size, '\0');
+    boost::asio::read(socket, boost::asio::buffer(&text[0], text.size()), read_ec);
+    return text;
+  });
+
+  // The session is registered asynchronously, write until it gets a message.
+  carla::Buffer buffer(boost::asio::buffer(message_text.c_str(), message_text.size()));
+  auto view = carla::BufferView::CreateFrom(std::move(buffer));
+  for (auto i = 0u; (i < 500u) && (received.wait_for(2ms) != std::future_status::ready); ++i) {
+    carla::SharedBufferView copy = view;
+    stream.Write(copy);
+  }
+  ASSERT_EQ(received.wait_for(1s), std::future_status::ready);
+  // No session reply in front and the message is not compressed.
+  ASSERT_EQ(received.get(), message_text);
+}
+
+TEST(streaming, compression_falls_back_to_plain_handshake) {
+  using namespace carla::streaming;
+  using namespace carla::streaming::detail;
+  using tcp_socket = boost::asio::ip::tcp::socket;
+  if (GetSupportedCodecs() == 0u) {
+    return;
+  }
+  constexpr stream_id_type stream_id = 42u;
+  const std::string message_text = "Hello client!";
+
+  io_context_running io;
+  boost::asio::ip::tcp::acceptor acceptor(
+      io.service,
+      boost::asio::ip::tcp::endpoint(make_localhost_address(), 0u));
+
+  // Behaves like a server without compression support, which closes the
+  // sessions asking for an unknown stream id.
+  std::atomic_size_t flagged_requests{0u};
+  auto server = std::async(std::launch::async, [&]() {
+    tcp_socket socket(io.service);
+    for (auto i = 0u; i < 2u; ++i) {
+      socket = tcp_socket(io.service);
+      boost::system::error_code ec;
+      acceptor.accept(socket, ec);
+      stream_id_type requested = 0u;
+      if (!ec) {
+        boost::asio::read(socket, boost::asio::buffer(&requested, sizeof(requested)), ec);
+      }
+      if (ec) {
+        break;
+      }
+      if (requested != stream_id) {
+        ++flagged_requests;
+        continue;
+      }
+      const auto size = static_cast<message_size_type>(message_text.size());
+      boost::asio::write(socket, boost::asio::buffer(&size, sizeof(size)), ec);
+      boost::asio::write(socket, boost::asio::buffer(message_text), ec);
+      break;
+    }
+    return socket;
+  });
+
+  std::promise<std::string> received;
+  std::atomic_bool is_received{false};
+  low_level::Client<tcp::Client> c;
+  c.SetAcceptedCodecs(GetSupportedCodecs());
+  c.Subscribe(
+      io.service,
+      token_type(stream_id, make_endpoint<boost::asio::ip::tcp>(acceptor.local_endpoint())),
+      [&](carla::Buffer message) {
+        if (!is_received.exchange(true)) {
+          received.set_value(std::string(reinterpret_cast<const char *>(message.data()), message.size()));
+        }
+      });
+
+  auto message = received.get_future();
+  ASSERT_EQ(message.wait_for(1s), std::future_status::ready);
+  ASSERT_EQ(message.get(), message_text);
+  ASSERT_EQ(flagged_requests, 1u);
+  c.UnSubscribe(token_type(stream_id, make_endpoint<boost::asio::ip::tcp>(acceptor.local_endpoint())));
+}
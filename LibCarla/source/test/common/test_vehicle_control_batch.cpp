@@ -0,0 +1,142 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+
+#include <carla/MsgPack.h>
+#include <carla/StopWatch.h>
+#include <carla/rpc/Command.h>
+#include <carla/rpc/CommandResponse.h>
+#include <carla/rpc/VehicleControlBatch.h>
+
+#include <chrono>
+#include <vector>
+
+using namespace carla::rpc;
+using carla::geom::Location;
+using carla::geom::Rotation;
+using carla::geom::Transform;
+
+static std::vector<Command> make_control_frame(std::size_t number_of_vehicles) {
+  std::vector<Command> commands;
+  commands.reserve(number_of_vehicles + number_of_vehicles / 10u);
+  for (std::size_t i = 0u; i < number_of_vehicles; ++i) {
+    const ActorId actor_id = static_cast<ActorId>(i + 100u);
+    const float value = static_cast<float>(i) / static_cast<float>(number_of_vehicles);
+    if (i % 4u == 3u) {
+      commands.emplace_back(Command::ApplyTransform(
+          actor_id, Transform(Location(value, 2.0f * value, 0.5f), Rotation(0.0f, 90.0f * value, 0.0f))));
+    } else {
+      commands.emplace_back(Command::ApplyVehicleControl(
+          actor_id, VehicleControl(value, -value, 1.0f - value, i % 2u == 0u, false, i % 3u == 0u, 1)));
+    }
+    if (i % 10u == 0u) {
+      commands.emplace_back(Command::SetVehicleLightState(actor_id, static_cast<VehicleLightState::flag_type>(i)));
+    }
+  }
+  return commands;
+}
+
+TEST(vehicle_control_batch, round_trip) {
+  const std::vector<Command> commands = make_control_frame(100u);
+  VehicleControlBatch batch;
+  for (const Command &command : commands) {
+    ASSERT_TRUE(batch.Add(command));
+  }
+  ASSERT_FALSE(batch.Add(Command::DestroyActor(1u)));
+  ASSERT_EQ(batch.size(), commands.size());
+
+  std::vector<unsigned char> data;
+  batch.Encode(data);
+  VehicleControlBatch decoded;
+  ASSERT_TRUE(decoded.Decode(data.data(), data.size()));
+  ASSERT_EQ(decoded.GetNumberOfControls(), 75u);
+  ASSERT_EQ(decoded.GetNumberOfTransforms(), 25u);
+  ASSERT_EQ(decoded.GetNumberOfLightStates(), 10u);
+
+  std::size_t control_index = 0u;
+  std::size_t transform_index = 0u;
+  std::size_t light_index = 0u;
+  for (const Command &command : commands) {
+    if (const auto *control = boost::variant2::get_if<Command::ApplyVehicleControl>(&command.command)) {
+      ASSERT_EQ(decoded.GetControlActor(control_index), control->actor);
+      ASSERT_EQ(decoded.GetControl(control_index), control->control);
+      ++control_index;
+    } else if (const auto *transform = boost::variant2::get_if<Command::ApplyTransform>(&command.command)) {
+      ASSERT_EQ(decoded.GetTransformActor(transform_index), transform->actor);
+      ASSERT_EQ(decoded.GetTransform(transform_index), transform->transform);
+      ++transform_index;
+    } else if (const auto *light = boost::variant2::get_if<Command::SetVehicleLightState>(&command.command)) {
+      ASSERT_EQ(decoded.GetLightStateActor(light_index), light->actor);
+      ASSERT_EQ(decoded.GetLightState(light_index), light->light_state);
+      ++light_index;
+    }
+  }
+
+  // Truncated or foreign data is rejected.
+  ASSERT_FALSE(decoded.Decode(data.data(), data.size() - 1u));
+  ASSERT_TRUE(decoded.empty());
+  data[0u] = 0xFF;
+  ASSERT_FALSE(decoded.Decode(data.data(), data.size()));
+  ASSERT_FALSE(decoded.Decode(nullptr, 0u));
+
+  VehicleControlBatch empty;
+  empty.Encode(data);
+  ASSERT_TRUE(decoded.Decode(data.data(), data.size()));
+  ASSERT_TRUE(decoded.empty());
+}
+
+// Encoding and decoding the commands of a traffic manager cycle, compared to
+// the generic batch of msgpack variants and its per-command responses.
+TEST(benchmark_vehicle_control_batch, serialize) {
+  constexpr std::size_t number_of_vehicles = 1000u;
+  constexpr std::size_t number_of_iterations = 100u;
+  using mp = carla::MsgPack;
+  const std::vector<Command> commands = make_control_frame(number_of_vehicles);
+
+  std::size_t generic_size = 0u;
+  carla::StopWatch generic_watch;
+  for (std::size_t i = 0u; i < number_of_iterations; ++i) {
+    const carla::Buffer buffer = mp::Pack(commands);
+    generic_size = buffer.size();
+    const auto decoded = mp::UnPack<std::vector<Command>>(buffer);
+    std::vector<CommandResponse> responses;
+    responses.reserve(decoded.size());
+    for (std::size_t j = 0u; j < decoded.size(); ++j) {
+      responses.emplace_back(static_cast<ActorId>(j));
+    }
+    const auto received = mp::UnPack<std::vector<CommandResponse>>(mp::Pack(responses));
+    ASSERT_EQ(received.size(), commands.size());
+  }
+  generic_watch.Stop();
+
+  VehicleControlBatch batch;
+  VehicleControlBatch decoded;
+  std::vector<unsigned char> data;
+  carla::StopWatch batch_watch;
+  for (std::size_t i = 0u; i < number_of_iterations; ++i) {
+    batch.Clear();
+    batch.Reserve(commands.size());
+    for (const Command &command : commands) {
+      batch.Add(command);
+    }
+    batch.Encode(data);
+    const carla::Buffer buffer = mp::Pack(data);
+    const auto received = mp::UnPack<std::vector<unsigned char>>(buffer);
+    ASSERT_TRUE(decoded.Decode(received.data(), received.size()));
+    const uint32_t failed_commands = mp::UnPack<uint32_t>(mp::Pack(uint32_t(0u)));
+    ASSERT_EQ(failed_commands, 0u);
+  }
+  batch_watch.Stop();
+  ASSERT_EQ(decoded.size(), commands.size());
+
+  carla::logging::log(
+      "control frame of", number_of_vehicles, "vehicles: generic batch",
+      generic_size, "bytes,",
+      generic_watch.GetElapsedTime<std::chrono::microseconds>() / number_of_iterations, "us;",
+      "vehicle control batch", data.size(), "bytes,",
+      batch_watch.GetElapsedTime<std::chrono::microseconds>() / number_of_iterations, "us");
+}
@@ -0,0 +1,95 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+
+#include <carla/BufferPool.h>
+#include <carla/ThreadGroup.h>
+
+#include <chrono>
+#include <deque>
+#include <limits>
+#include <random>
+#include <thread>
+#include <vector>
+
+using carla::Buffer;
+using carla::BufferPool;
+
+/// A sensor writing to a pool shared with other sensors, as the pool of a
+/// streaming client subscribed to several streams.
+struct SensorProfile {
+  const char *name;
+  size_t min_size;
+  size_t max_size;
+  /// Messages kept alive at the same time, e.g. queued in a session.
+  size_t in_flight;
+};
+
+static const std::vector<SensorProfile> MIXED_WORKLOAD = {
+  {"rgb camera 1920x1080", 1920u * 1080u * 4u, 1920u * 1080u * 4u, 2u},
+  {"depth camera 800x600", 800u * 600u * 4u, 800u * 600u * 4u, 2u},
+  {"lidar", 50000u * 16u, 120000u * 16u, 2u},
+  {"radar", 200u * 16u, 1500u * 16u, 4u},
+  {"imu", 48u, 48u, 8u},
+  {"gnss", 24u, 24u, 8u},
+  {"sensor header", 48u, 48u, 8u},
+};
+
+static void benchmark_mixed_workload(const bool use_size_hint, const size_t max_retained_bytes) {
+  constexpr auto number_of_messages = 2000u;
+  auto pool = std::make_shared<BufferPool>();
+  pool->SetMaxRetainedBytes(max_retained_bytes);
+
+  const auto start = std::chrono::steady_clock::now();
+  carla::ThreadGroup threads;
+  auto seed = 0u;
+  for (auto &sensor : MIXED_WORKLOAD) {
+    threads.CreateThread([=, &sensor]() {
+      std::mt19937_64 rng(seed);
+      std::uniform_int_distribution<size_t> size_dist(sensor.min_size, sensor.max_size);
+      std::deque<Buffer> in_flight;
+      for (auto i = 0u; i < number_of_messages; ++i) {
+        const auto size = size_dist(rng);
+        auto buffer = use_size_hint ? pool->Pop(size) : pool->Pop();
+        buffer.reset(static_cast<uint64_t>(size));
+        buffer.data()[0u] = buffer.data()[size - 1u] = 42u;
+        in_flight.emplace_back(std::move(buffer));
+        if (in_flight.size() > sensor.in_flight) {
+          in_flight.pop_front();
+        }
+      }
+    });
+    ++seed;
+  }
+  threads.JoinAll();
+  const auto seconds = std::chrono::duration<double>(
+      std::chrono::steady_clock::now() - start).count();
+
+  const auto stats = pool->GetStatistics();
+  const auto total = stats.hits + stats.misses;
+  ASSERT_EQ(total, number_of_messages * MIXED_WORKLOAD.size());
+  ASSERT_LE(stats.high_water_mark, max_retained_bytes);
+  std::cout << (use_size_hint ? "size hint" : "no size hint")
+            << (max_retained_bytes < (std::numeric_limits<size_t>::max)() ? " (capped)" : "")
+            << ": " << static_cast<double>(total) / seconds << " pops/s,"
+            << " hit ratio " << 100.0 * static_cast<double>(stats.hits) / static_cast<double>(total) << "%,"
+            << " discarded " << stats.discarded << ","
+            << " high-water mark " << static_cast<double>(stats.high_water_mark) / 1e6 << " MB"
+            << std::endl;
+}
+
+TEST(benchmark_buffer_pool, mixed_workload_no_hint) {
+  benchmark_mixed_workload(false, (std::numeric_limits<size_t>::max)());
+}
+
+TEST(benchmark_buffer_pool, mixed_workload_size_hint) {
+  benchmark_mixed_workload(true, (std::numeric_limits<size_t>::max)());
+}
+
+TEST(benchmark_buffer_pool, mixed_workload_size_hint_capped) {
+  benchmark_mixed_workload(true, 32u << 20u);
+}
@@ -0,0 +1,310 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+#include "OpenDrive.h"
+#include "Random.h"
+
+#include <carla/StopWatch.h>
+#include <carla/geom/Rtree.h>
+#include <carla/opendrive/OpenDriveParser.h>
+#include <carla/road/InformationSet.h>
+#include <carla/road/Map.h>
+#include <carla/road/PrecompiledMap.h>
+#include <carla/road/RoadElementSet.h>
+#include <carla/road/element/RoadInfoElevation.h>
+#include <carla/road/element/RoadInfoIterator.h>
+#include <carla/road/element/RoadInfoLaneOffset.h>
+#include <carla/road/element/RoadInfoLaneWidth.h>
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+using namespace carla::road;
+using namespace carla::road::element;
+using carla::opendrive::OpenDriveParser;
+
+static constexpr size_t NUMBER_OF_INFOS = 30u;
+static constexpr size_t NUMBER_OF_QUERIES = 1000000u;
+static constexpr double ROAD_LENGTH = 300.0;
+static constexpr size_t SYNTHETIC_MAP_SIZE = 32u << 20u;
+
+// A road with widths, offsets and elevations interleaved, which is what the
+// lookups of Lane::ComputeTransform have to skip through.
+static std::vector<std::unique_ptr<RoadInfo>> make_road_infos() {
+  std::vector<std::unique_ptr<RoadInfo>> infos;
+  for (auto i = 0u; i < NUMBER_OF_INFOS; ++i) {
+    const double s = ROAD_LENGTH * i / NUMBER_OF_INFOS;
+    infos.emplace_back(std::make_unique<RoadInfoLaneWidth>(s, 3.5, 0.0, 0.0, 0.0));
+    infos.emplace_back(std::make_unique<RoadInfoLaneOffset>(s, 0.1 * i, 0.0, 0.0, 0.0));
+    infos.emplace_back(std::make_unique<RoadInfoElevation>(s, 0.2 * i, 0.0, 0.0, 0.0));
+  }
+  return infos;
+}
+
+template <typename T, typename QueryT>
+static double time_queries(const std::vector<double> &distances, QueryT &&query, double &checksum) {
+  carla::StopWatch stop_watch;
+  for (auto s : distances) {
+    const T *info = query(s);
+    checksum += info != nullptr ? info->GetPolynomial().GetA() : 0.0;
+  }
+  stop_watch.Stop();
+  return static_cast<double>(stop_watch.GetElapsedTime<std::chrono::nanoseconds>()) / distances.size();
+}
+
+// Compares a single info lookup through the typed indexes of InformationSet
+// against the visitor scan it replaced, on the same infos.
+TEST(benchmark_map, get_info) {
+  std::vector<double> distances(NUMBER_OF_QUERIES);
+  for (auto &s : distances) {
+    s = util::Random::Uniform(0.0, ROAD_LENGTH);
+  }
+
+  const InformationSet indexed(make_road_infos());
+  const RoadElementSet<std::unique_ptr<RoadInfo>> plain(make_road_infos());
+
+  double indexed_checksum = 0.0;
+  const double indexed_ns = time_queries<RoadInfoElevation>(distances, [&](double s) {
+    return indexed.GetInfo<RoadInfoElevation>(s);
+  }, indexed_checksum);
+
+  double visitor_checksum = 0.0;
+  const double visitor_ns = time_queries<RoadInfoElevation>(distances, [&](double s) {
+    auto it = MakeRoadInfoIterator<RoadInfoElevation>(plain.GetReverseSubset(s));
+    return it.IsAtEnd() ? nullptr : &*it;
+  }, visitor_checksum);
+
+  ASSERT_EQ(indexed_checksum, visitor_checksum);
+  carla::logging::log(
+      "GetInfo over", 3u * NUMBER_OF_INFOS, "infos:",
+      "typed index", indexed_ns, "ns/query,",
+      "visitor scan", visitor_ns, "ns/query");
+}
+
+// Throughput of Map::ComputeTransform over every waypoint of each town.
+TEST(benchmark_map, compute_transform) {
+  constexpr size_t NUMBER_OF_PASSES = 5u;
+  for (const auto &file : util::OpenDrive::GetAvailableFiles()) {
+    auto map = OpenDriveParser::Load(util::OpenDrive::Load(file));
+    ASSERT_TRUE(map.has_value());
+    const auto waypoints = map->GenerateWaypoints(0.5);
+    ASSERT_FALSE(waypoints.empty());
+
+    float checksum = 0.0f;
+    carla::StopWatch stop_watch;
+    for (auto pass = 0u; pass < NUMBER_OF_PASSES; ++pass) {
+      for (const auto &waypoint : waypoints) {
+        checksum += map->ComputeTransform(waypoint).location.z;
+      }
+    }
+    stop_watch.Stop();
+
+    const auto transforms = NUMBER_OF_PASSES * waypoints.size();
+    const auto elapsed = stop_watch.GetElapsedTime<std::chrono::microseconds>();
+    carla::logging::log(
+        file, ":", transforms, "transforms in", elapsed / 1000u, "ms,",
+        static_cast<double>(transforms) / std::max<size_t>(1u, elapsed), "transforms/us",
+        "(checksum", checksum, ")");
+  }
+}
+
+// Map::ComputeTransform one waypoint at a time against Map::ComputeTransforms,
+// both for the waypoints of GenerateWaypoints and for dense sampling of
+// every lane. Only dense sampling gains much, about 3x on
+// TemplateOpenDrive.xodr; GenerateWaypoints interleaves lanes on short
+// roads, so its runs are a few waypoints long and the bulk path is within
+// noise of the single one.
+TEST(benchmark_map, compute_transforms) {
+  constexpr size_t NUMBER_OF_PASSES = 5u;
+  for (const auto &file : util::OpenDrive::GetAvailableFiles()) {
+    auto map = OpenDriveParser::Load(util::OpenDrive::Load(file));
+    ASSERT_TRUE(map.has_value());
+
+    const auto waypoints = map->GenerateWaypoints(0.5);
+    ASSERT_FALSE(waypoints.empty());
+    carla::StopWatch single_watch;
+    for (auto pass = 0u; pass < NUMBER_OF_PASSES; ++pass) {
+      for (const auto &waypoint : waypoints) {
+        map->ComputeTransform(waypoint);
+      }
+    }
+    single_watch.Stop();
+    carla::StopWatch bulk_watch;
+    for (auto pass = 0u; pass < NUMBER_OF_PASSES; ++pass) {
+      map->ComputeTransforms(waypoints);
+    }
+    bulk_watch.Stop();
+
+    // Every lane of the first lane section of each road, every centimetre.
+    size_t number_of_samples = 0u;
+    size_t dense_single_us = 0u;
+    size_t dense_bulk_us = 0u;
+    for (const auto &waypoint : map->GenerateWaypointsOnRoadEntries()) {
+      const auto &lane = map->GetLane(waypoint);
+      std::vector<double> s_values;
+      for (double s = lane.GetDistance(); s < lane.GetDistance() + lane.GetLength(); s += 0.01) {
+        s_values.emplace_back(s);
+      }
+      number_of_samples += s_values.size();
+      carla::StopWatch dense_single_watch;
+      for (const auto s : s_values) {
+        lane.ComputeTransform(s);
+      }
+      dense_single_watch.Stop();
+      std::vector<carla::geom::Transform> transforms(s_values.size());
+      carla::StopWatch dense_bulk_watch;
+      lane.ComputeTransforms(s_values.data(), s_values.size(), transforms.data());
+      dense_bulk_watch.Stop();
+      dense_single_us += dense_single_watch.GetElapsedTime<std::chrono::microseconds>();
+      dense_bulk_us += dense_bulk_watch.GetElapsedTime<std::chrono::microseconds>();
+    }
+
+    carla::logging::log(
+        file, ":", NUMBER_OF_PASSES * waypoints.size(), "waypoints,",
+        "single", single_watch.GetElapsedTime<std::chrono::microseconds>(), "us,",
+        "bulk", bulk_watch.GetElapsedTime<std::chrono::microseconds>(), "us;",
+        number_of_samples, "lane samples,",
+        "single", dense_single_us, "us,",
+        "bulk", dense_bulk_us, "us");
+  }
+}
+
+// OpenDriveParser::Load on one thread against all the hardware threads, for
+// each town and for a large map made of copies of the largest one.
+TEST(benchmark_map, parse) {
+  std::vector<std::pair<std::string, std::string>> maps;
+  for (const auto &file : util::OpenDrive::GetAvailableFiles()) {
+    maps.emplace_back(file, util::OpenDrive::Load(file));
+  }
+  ASSERT_FALSE(maps.empty());
+  const auto &largest = *std::max_element(maps.begin(), maps.end(), [](const auto &lhs, const auto &rhs) {
+    return lhs.second.size() < rhs.second.size();
+  });
+  const size_t copies = std::max<size_t>(1u, SYNTHETIC_MAP_SIZE / std::max<size_t>(1u, largest.second.size()));
+  maps.emplace_back(
+      std::to_string(copies) + " copies of " + largest.first,
+      util::OpenDrive::Tile(largest.second, copies));
+
+  const size_t number_of_threads = std::max(1u, std::thread::hardware_concurrency());
+  for (const auto &map : maps) {
+    carla::StopWatch serial_watch;
+    auto serial = OpenDriveParser::Load(map.second, 1u);
+    serial_watch.Stop();
+    carla::StopWatch parallel_watch;
+    auto parallel = OpenDriveParser::Load(map.second, number_of_threads);
+    parallel_watch.Stop();
+
+    ASSERT_TRUE(serial.has_value());
+    ASSERT_TRUE(parallel.has_value());
+    ASSERT_EQ(serial->GetMap().GetRoadCount(), parallel->GetMap().GetRoadCount());
+    carla::logging::log(
+        map.first, ":", map.second.size() / 1024u, "KB,",
+        serial->GetMap().GetRoadCount(), "roads,",
+        "1 thread", serial_watch.GetElapsedTime(), "ms,",
+        number_of_threads, "threads", parallel_watch.GetElapsedTime(), "ms");
+  }
+}
+
+// OpenDriveParser::Load against restoring the same map with
+// PrecompiledMap::Load, for each town.
+TEST(benchmark_map, precompiled_load) {
+  for (const auto &file : util::OpenDrive::GetAvailableFiles()) {
+    const auto opendrive = util::OpenDrive::Load(file);
+    const auto key = PrecompiledMap::GetOpenDriveKey(opendrive);
+    carla::StopWatch parse_watch;
+    auto parsed = OpenDriveParser::Load(opendrive);
+    parse_watch.Stop();
+    ASSERT_TRUE(parsed.has_value());
+
+    const auto content = PrecompiledMap::Serialize(*parsed, key);
+    carla::StopWatch load_watch;
+    auto restored = PrecompiledMap::Load(content.data(), content.size(), key);
+    load_watch.Stop();
+    ASSERT_TRUE(restored.has_value());
+    ASSERT_EQ(parsed->GetMap().GetRoadCount(), restored->GetMap().GetRoadCount());
+    carla::logging::log(
+        file, ":", opendrive.size() / 1024u, "KB OpenDRIVE,",
+        content.size() / 1024u, "KB precompiled,",
+        "parse", parse_watch.GetElapsedTime(), "ms,",
+        "load", load_watch.GetElapsedTime(), "ms");
+  }
+}
+
+// Rtree of segments between consecutive waypoints of each town, filled one
+// element at a time against bulk loaded, and GetClosestWaypointOnRoad one
+// location at a time against GetClosestWaypointsOnRoad.
+TEST(benchmark_map, closest_waypoints) {
+  constexpr size_t NUMBER_OF_LOCATIONS = 100000u;
+  using Rtree = carla::geom::SegmentCloudRtree<Waypoint>;
+  for (const auto &file : util::OpenDrive::GetAvailableFiles()) {
+    auto map = OpenDriveParser::Load(util::OpenDrive::Load(file));
+    ASSERT_TRUE(map.has_value());
+
+    std::vector<Rtree::TreeElement> elements;
+    for (const auto &waypoint : map->GenerateWaypoints(1.0)) {
+      for (const auto &next : map->GetNext(waypoint, 1.0)) {
+        const auto start = map->ComputeTransform(waypoint).location;
+        const auto end = map->ComputeTransform(next).location;
+        elements.emplace_back(
+            Rtree::BSegment(Rtree::BPoint(start.x, start.y, start.z), Rtree::BPoint(end.x, end.y, end.z)),
+            std::make_pair(waypoint, next));
+      }
+    }
+    carla::StopWatch insert_watch;
+    Rtree inserted;
+    inserted.InsertElements(elements);
+    insert_watch.Stop();
+    carla::StopWatch build_watch;
+    Rtree built;
+    built.Build(elements);
+    build_watch.Stop();
+
+    std::vector<carla::geom::Location> locations(NUMBER_OF_LOCATIONS);
+    std::vector<Rtree::BPoint> points;
+    for (auto &location : locations) {
+      location = util::Random::Location(-500.0f, 500.0f);
+      points.emplace_back(location.x, location.y, location.z);
+    }
+    auto accept_all = [](const Rtree::TreeElement &) { return true; };
+    Rtree::NearestBatch batch;
+    carla::StopWatch inserted_query_watch;
+    inserted.GetNearestNeighbourBatchWithFilter(points, accept_all, batch);
+    inserted_query_watch.Stop();
+    carla::StopWatch built_query_watch;
+    built.GetNearestNeighbourBatchWithFilter(points, accept_all, batch);
+    built_query_watch.Stop();
+
+    carla::StopWatch single_watch;
+    size_t single_found = 0u;
+    for (const auto &location : locations) {
+      single_found += map->GetClosestWaypointOnRoad(location).has_value() ? 1u : 0u;
+    }
+    single_watch.Stop();
+    carla::StopWatch batch_watch;
+    const auto waypoints = map->GetClosestWaypointsOnRoad(locations);
+    batch_watch.Stop();
+    const auto batch_found = std::count_if(waypoints.begin(), waypoints.end(), [](const auto &waypoint) {
+      return waypoint.has_value();
+    });
+    ASSERT_EQ(single_found, static_cast<size_t>(batch_found));
+
+    carla::logging::log(
+        file, ":", elements.size(), "segments,",
+        "insert", insert_watch.GetElapsedTime(), "ms,",
+        "bulk load", build_watch.GetElapsedTime(), "ms;",
+        NUMBER_OF_LOCATIONS, "nearest queries on inserted tree",
+        inserted_query_watch.GetElapsedTime(), "ms,",
+        "on bulk loaded tree", built_query_watch.GetElapsedTime(), "ms;",
+        "GetClosestWaypointOnRoad", single_watch.GetElapsedTime(), "ms,",
+        "GetClosestWaypointsOnRoad", batch_watch.GetElapsedTime(), "ms");
+  }
+}
@@ -14,6 +14,14 @@
 #include <boost/asio/post.hpp>
 
 #include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <numeric>
+#include <sstream>
 
 using namespace carla::streaming;
 using namespace std::chrono_literals;
@@ -27,23 +35,52 @@ static auto make_special_message(size_t size) {
   return BufView;
 }
 
+/// Frames of a semantic segmentation image; tags are laid out in long runs
+/// that shift a few pixels every frame.
+static auto make_segmentation_messages(size_t dimensions, size_t number_of_frames) {
+  std::vector<carla::SharedBufferView> messages;
+  for (auto frame = 0u; frame < number_of_frames; ++frame) {
+    carla::Buffer msg(static_cast<uint64_t>(4u * dimensions));
+    for (auto i = 0u; i < dimensions; ++i) {
+      const auto tag = static_cast<unsigned char>(((i + 3u * frame) / 64u) % 23u);
+      msg.data()[4u * i + 0u] = 0u;
+      msg.data()[4u * i + 1u] = 0u;
+      msg.data()[4u * i + 2u] = tag;
+      msg.data()[4u * i + 3u] = 255u;
+    }
+    messages.emplace_back(carla::BufferView::CreateFrom(std::move(msg)));
+  }
+  return messages;
+}
+
 class Benchmark {
 public:
 
   Benchmark(uint16_t port, size_t message_size, double success_ratio)
+    : Benchmark(port, {make_special_message(message_size)}, success_ratio) {}
+
+  Benchmark(
+      uint16_t port,
+      std::vector<carla::SharedBufferView> messages,
+      double success_ratio,
+      detail::CompressionSettings compression = {})
     : _server(port),
       _client(),
-      _message(make_special_message(message_size)),
+      _messages(std::move(messages)),
       _client_callback(),
       _work_to_do(_client_callback),
-      _success_ratio(success_ratio) {}
+      _success_ratio(success_ratio),
+      _compression(compression) {
+    DEBUG_ASSERT(!_messages.empty());
+  }
 
   void AddStream() {
     Stream stream = _server.MakeStream();
+    stream.SetCompression(_compression);
 
     _client.Subscribe(stream.token(), [this](carla::Buffer msg) {
       carla::SharedBufferView BufView = carla::BufferView::CreateFrom(std::move(msg));
-      DEBUG_ASSERT_EQ(BufView->size(), _message->size());
+      DEBUG_ASSERT_EQ(BufView->size(), _messages.front()->size());
       boost::asio::post(_client_callback, [this]() {
         CARLA_PROFILE_FPS(client, listen_callback);
         ++_number_of_messages_received;
@@ -67,13 +104,16 @@ public:
     std::this_thread::sleep_for(1s); // the client needs to be ready so we make
                                      // sure we get all the messages.
 
+    const auto wall_start = std::chrono::steady_clock::now();
+    const auto cpu_start = std::clock();
+
     for (auto &&stream : _streams) {
       _threads.CreateThread([=]() mutable {
         for (auto i = 0u; i < number_of_messages; ++i) {
           std::this_thread::sleep_for(11ms); // ~90FPS.
           {
             CARLA_PROFILE_SCOPE(game, write_to_stream);
-            stream.Write(_message);
+            stream.Write(_messages[i % _messages.size()]);
           }
         }
       });
@@ -98,6 +138,19 @@ public:
     _threads.JoinAll();
     std::cout << " done." << std::endl;
 
+    // Client and server run in this process, CPU time accounts for both ends.
+    const auto cpu_seconds =
+        static_cast<double>(std::clock() - cpu_start) / static_cast<double>(CLOCKS_PER_SEC);
+    const auto wall_seconds = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - wall_start).count();
+    const auto megabytes =
+        static_cast<double>(_number_of_messages_received * _messages.front()->size()) / 1e6;
+    std::cout << "codec " << static_cast<int>(_compression.codec)
+              << (_compression.delta ? " (delta)" : "")
+              << ": " << megabytes / wall_seconds << " MB/s,"
+              << " cpu " << cpu_seconds << " s"
+              << " (" << 100.0 * cpu_seconds / wall_seconds << "%)" << std::endl;
+
 #ifdef NDEBUG
     ASSERT_GE(_number_of_messages_received, threshold);
 #else
@@ -115,7 +168,7 @@ private:
 
   Client _client;
 
-  const carla::SharedBufferView _message;
+  const std::vector<carla::SharedBufferView> _messages;
 
   boost::asio::io_context _client_callback;
 
@@ -123,6 +176,8 @@ private:
 
   const double _success_ratio;
 
+  const detail::CompressionSettings _compression;
+
   std::vector<Stream> _streams;
 
   std::atomic_size_t _number_of_messages_received{0u};
@@ -167,3 +222,362 @@ TEST(benchmark_streaming, image_800x600_mt) {
 TEST(benchmark_streaming, image_1920x1080_mt) {
   benchmark_image(1920u * 1080u, get_max_concurrency(), 0.9);
 }
+
+static void benchmark_codec(
+    const detail::Codec codec,
+    const bool delta,
+    const size_t dimensions = 800u * 600u,
+    const double success_ratio = 0.9) {
+  if (!detail::IsCodecSupported(codec)) {
+    carla::log_warning("codec", static_cast<int>(codec), "not supported by this build, skipped");
+    return;
+  }
+  constexpr auto number_of_messages = 100u;
+  constexpr auto number_of_frames = 10u;
+  const auto number_of_streams = get_max_concurrency();
+  carla::logging::log("Benchmark:", number_of_streams, "segmentation streams at 90FPS.");
+  detail::CompressionSettings compression;
+  compression.codec = codec;
+  compression.delta = delta;
+  Benchmark benchmark(
+      TESTING_PORT,
+      make_segmentation_messages(dimensions, number_of_frames),
+      success_ratio,
+      compression);
+  benchmark.AddStreams(number_of_streams);
+  benchmark.Run(number_of_messages);
+}
+
+TEST(benchmark_streaming, codec_none) {
+  benchmark_codec(detail::Codec::None, false);
+}
+
+TEST(benchmark_streaming, codec_lz4) {
+  benchmark_codec(detail::Codec::LZ4, false);
+}
+
+TEST(benchmark_streaming, codec_lz4_delta) {
+  benchmark_codec(detail::Codec::LZ4, true);
+}
+
+TEST(benchmark_streaming, codec_zstd) {
+  benchmark_codec(detail::Codec::Zstd, false);
+}
+
+TEST(benchmark_streaming, codec_zstd_delta) {
+  benchmark_codec(detail::Codec::Zstd, true);
+}
+
+// =============================================================================
+// -- Scenarios ----------------------------------------------------------------
+// =============================================================================
+
+/// Payload written by a kind of sensor every tick.
+struct PayloadProfile {
+  const char *name;
+  size_t size;
+};
+
+static constexpr PayloadProfile IMU{"imu", 96u};
+static constexpr PayloadProfile GNSS{"gnss", 72u};
+static constexpr PayloadProfile RADAR{"radar", 1500u * 16u};
+static constexpr PayloadProfile LIDAR{"lidar", 80000u * 16u};
+static constexpr PayloadProfile CAMERA_1080P{"camera_1920x1080", 1920u * 1080u * 4u};
+static constexpr PayloadProfile CAMERA_4K{"camera_3840x2160", 3840u * 2160u * 4u};
+
+/// A set of streams written at the same rate, as the sensors of a simulation
+/// ticking at a fixed step, each read by one or more clients.
+struct StreamingScenario {
+  const char *name;
+  /// Payload and number of streams of each kind.
+  std::vector<std::pair<PayloadProfile, size_t>> streams;
+  /// Clients subscribed to every stream, more than one goes through
+  /// MultiStreamState.
+  size_t subscribers = 1u;
+  bool synchronous_mode = true;
+  double frames_per_second = 20.0;
+  size_t number_of_frames = 100u;
+  double success_ratio = 1.0;
+};
+
+/// Messages start with the time they were written at, so the subscribers can
+/// measure the end-to-end latency. Client and server run in this process and
+/// share the steady clock.
+static constexpr size_t LATENCY_HEADER_SIZE = sizeof(uint64_t);
+
+static uint64_t now_in_nanoseconds() {
+  return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+/// Latencies of the messages of a stream received by a subscriber.
+class LatencyRecorder {
+public:
+
+  explicit LatencyRecorder(size_t capacity) : _samples(capacity) {}
+
+  void Add(uint64_t nanoseconds) {
+    const auto index = _count++;
+    if (index < _samples.size()) {
+      _samples[index] = nanoseconds;
+    }
+  }
+
+  size_t size() const {
+    return std::min(_count.load(), _samples.size());
+  }
+
+  void AppendTo(std::vector<uint64_t> &samples) const {
+    samples.insert(samples.end(), _samples.begin(), _samples.begin() + size());
+  }
+
+private:
+
+  std::vector<uint64_t> _samples;
+
+  std::atomic_size_t _count{0u};
+};
+
+/// Value at @a percentile of sorted @a samples, in microseconds.
+static double get_percentile(const std::vector<uint64_t> &samples, double percentile) {
+  if (samples.empty()) {
+    return 0.0;
+  }
+  const auto rank = static_cast<size_t>(percentile * static_cast<double>(samples.size() - 1u) + 0.5);
+  return static_cast<double>(samples[rank]) / 1e3;
+}
+
+/// Results of every scenario run by this process, written as a JSON array to
+/// the file in CARLA_STREAMING_BENCHMARK_OUTPUT, if set, after each scenario.
+static void write_benchmark_result(const std::string &json) {
+  static std::vector<std::string> results;
+  results.emplace_back(json);
+  const char *path = std::getenv("CARLA_STREAMING_BENCHMARK_OUTPUT");
+  if (path == nullptr) {
+    return;
+  }
+  std::ofstream out(path, std::ios::trunc);
+  out << "[\n";
+  for (auto i = 0u; i < results.size(); ++i) {
+    out << results[i] << (i + 1u < results.size() ? ",\n" : "\n");
+  }
+  out << "]\n";
+  if (!out) {
+    carla::log_warning("unable to write benchmark results to", path);
+  }
+}
+
+static void benchmark_scenario(const StreamingScenario &scenario) {
+  struct StreamEntry {
+    const PayloadProfile *payload;
+    Stream stream;
+    /// One per subscriber.
+    std::vector<std::unique_ptr<LatencyRecorder>> latencies;
+  };
+
+  const auto worker_threads = get_max_concurrency();
+
+  // Declared before the clients, their callbacks write into these.
+  std::vector<StreamEntry> entries;
+  std::atomic_size_t number_of_messages_received{0u};
+  std::atomic_size_t number_of_bytes_received{0u};
+
+  Server server(TESTING_PORT);
+  server.SetSynchronousMode(scenario.synchronous_mode);
+  for (auto &&kind : scenario.streams) {
+    DEBUG_ASSERT(kind.first.size >= LATENCY_HEADER_SIZE);
+    for (auto i = 0u; i < kind.second; ++i) {
+      entries.push_back(StreamEntry{&kind.first, server.MakeStream(), {}});
+    }
+  }
+
+  std::vector<std::unique_ptr<Client>> clients;
+  for (auto i = 0u; i < scenario.subscribers; ++i) {
+    clients.emplace_back(std::make_unique<Client>());
+    for (auto &&entry : entries) {
+      entry.latencies.emplace_back(std::make_unique<LatencyRecorder>(scenario.number_of_frames));
+      auto *latencies = entry.latencies.back().get();
+      clients.back()->Subscribe(entry.stream.token(), [&, latencies](carla::Buffer msg) {
+        const auto received = now_in_nanoseconds();
+        uint64_t sent;
+        DEBUG_ASSERT(msg.size() >= LATENCY_HEADER_SIZE);
+        std::memcpy(&sent, msg.data(), LATENCY_HEADER_SIZE);
+        latencies->Add(received - sent);
+        number_of_bytes_received += msg.size();
+        ++number_of_messages_received;
+      });
+    }
+  }
+
+  server.AsyncRun(worker_threads);
+  for (auto &&client : clients) {
+    client->AsyncRun(worker_threads);
+  }
+
+  std::this_thread::sleep_for(1s); // the clients need to be ready so we make
+                                   // sure we get all the messages.
+
+  const auto period = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+      std::chrono::duration<double>(1.0 / scenario.frames_per_second));
+  const auto wall_start = std::chrono::steady_clock::now();
+  const auto cpu_start = std::clock();
+  {
+    carla::ThreadGroup writers;
+    for (auto &&entry : entries) {
+      writers.CreateThread([&, wall_start, period, size=entry.payload->size, stream=entry.stream]() mutable {
+        for (auto frame = 0u; frame < scenario.number_of_frames; ++frame) {
+          std::this_thread::sleep_until(wall_start + (frame + 1u) * period);
+          auto buffer = stream.MakeBuffer(size);
+          const auto sent = now_in_nanoseconds();
+          std::memcpy(buffer.data(), &sent, LATENCY_HEADER_SIZE);
+          stream.Write(carla::BufferView::CreateFrom(std::move(buffer)));
+        }
+      });
+    }
+  }
+
+  const auto expected_number_of_messages =
+      entries.size() * scenario.subscribers * scenario.number_of_frames;
+  for (auto i = 0u; i < 100u; ++i) {
+    if (number_of_messages_received >= expected_number_of_messages) {
+      break;
+    }
+    std::this_thread::sleep_for(100ms);
+  }
+
+  // Client and server run in this process, CPU time accounts for both ends.
+  const auto cpu_seconds =
+      static_cast<double>(std::clock() - cpu_start) / static_cast<double>(CLOCKS_PER_SEC);
+  const auto wall_seconds = std::chrono::duration<double>(
+      std::chrono::steady_clock::now() - wall_start).count();
+  clients.clear();
+
+  std::ostringstream json;
+  json << std::fixed << std::setprecision(3);
+  json << "{\"scenario\": \"" << scenario.name << "\""
+       << ", \"synchronous_mode\": " << (scenario.synchronous_mode ? "true" : "false")
+       << ", \"subscribers\": " << scenario.subscribers
+       << ", \"frames_per_second\": " << scenario.frames_per_second
+       << ", \"frames\": " << scenario.number_of_frames
+       << ", \"wall_seconds\": " << wall_seconds
+       << ", \"cpu_seconds\": " << cpu_seconds
+       << ", \"megabytes_per_second\": " << static_cast<double>(number_of_bytes_received) / 1e6 / wall_seconds
+       << ", \"payloads\": [";
+  std::cout << scenario.name << (scenario.synchronous_mode ? " (sync)" : " (async)")
+            << ": cpu " << cpu_seconds << " s (" << 100.0 * cpu_seconds / wall_seconds << "%)" << std::endl;
+  auto is_first = true;
+  for (auto &&kind : scenario.streams) {
+    std::vector<uint64_t> samples;
+    for (auto &&entry : entries) {
+      if (entry.payload == &kind.first) {
+        for (auto &&latencies : entry.latencies) {
+          latencies->AppendTo(samples);
+        }
+      }
+    }
+    std::sort(samples.begin(), samples.end());
+    const auto sent = kind.second * scenario.subscribers * scenario.number_of_frames;
+    const auto mean = samples.empty() ? 0.0 :
+        static_cast<double>(std::accumulate(samples.begin(), samples.end(), uint64_t(0u))) /
+        static_cast<double>(samples.size()) / 1e3;
+    const auto p50 = get_percentile(samples, 0.5);
+    const auto p90 = get_percentile(samples, 0.9);
+    const auto p99 = get_percentile(samples, 0.99);
+    const auto max = get_percentile(samples, 1.0);
+    json << (is_first ? "" : ", ")
+         << "{\"name\": \"" << kind.first.name << "\""
+         << ", \"size\": " << kind.first.size
+         << ", \"streams\": " << kind.second
+         << ", \"expected\": " << sent
+         << ", \"received\": " << samples.size()
+         << ", \"latency_us\": {\"mean\": " << mean
+         << ", \"p50\": " << p50
+         << ", \"p90\": " << p90
+         << ", \"p99\": " << p99
+         << ", \"max\": " << max << "}}";
+    is_first = false;
+    std::cout << "  " << kind.second << "x " << kind.first.name
+              << ": received " << samples.size() << " of " << sent
+              << ", latency mean " << mean << " us, p50 " << p50
+              << " us, p90 " << p90 << " us, p99 " << p99
+              << " us, max " << max << " us" << std::endl;
+  }
+  json << "]}";
+  write_benchmark_result(json.str());
+
+  const auto threshold = static_cast<size_t>(
+      scenario.success_ratio * static_cast<double>(expected_number_of_messages));
+#ifdef NDEBUG
+  ASSERT_GE(number_of_messages_received, threshold);
+#else
+  if (number_of_messages_received < threshold) {
+    carla::log_warning("threshold unmet:", number_of_messages_received.load(), '/', threshold);
+  }
+#endif // NDEBUG
+}
+
+static StreamingScenario make_mixed_scenario(bool synchronous_mode) {
+  StreamingScenario scenario;
+  scenario.name = "mixed_sensors";
+  scenario.streams = {
+    {CAMERA_4K, 1u},
+    {CAMERA_1080P, 2u},
+    {LIDAR, 2u},
+    {RADAR, 4u},
+    {IMU, 4u},
+    {GNSS, 4u}};
+  scenario.synchronous_mode = synchronous_mode;
+  scenario.success_ratio = synchronous_mode ? 1.0 : 0.9;
+  return scenario;
+}
+
+static StreamingScenario make_many_streams_scenario(bool synchronous_mode) {
+  StreamingScenario scenario;
+  scenario.name = "many_small_streams";
+  scenario.streams = {
+    {IMU, 64u},
+    {GNSS, 64u},
+    {RADAR, 16u}};
+  scenario.frames_per_second = 90.0;
+  scenario.number_of_frames = 300u;
+  scenario.synchronous_mode = synchronous_mode;
+  scenario.success_ratio = synchronous_mode ? 1.0 : 0.9;
+  return scenario;
+}
+
+static StreamingScenario make_multiple_subscribers_scenario(bool synchronous_mode) {
+  StreamingScenario scenario;
+  scenario.name = "multiple_subscribers";
+  scenario.streams = {
+    {CAMERA_1080P, 1u},
+    {LIDAR, 1u},
+    {IMU, 2u}};
+  scenario.subscribers = 4u;
+  scenario.synchronous_mode = synchronous_mode;
+  scenario.success_ratio = synchronous_mode ? 1.0 : 0.9;
+  return scenario;
+}
+
+TEST(benchmark_streaming, scenario_mixed_sensors_sync) {
+  benchmark_scenario(make_mixed_scenario(true));
+}
+
+TEST(benchmark_streaming, scenario_mixed_sensors_async) {
+  benchmark_scenario(make_mixed_scenario(false));
+}
+
+TEST(benchmark_streaming, scenario_many_small_streams_sync) {
+  benchmark_scenario(make_many_streams_scenario(true));
+}
+
+TEST(benchmark_streaming, scenario_many_small_streams_async) {
+  benchmark_scenario(make_many_streams_scenario(false));
+}
+
+TEST(benchmark_streaming, scenario_multiple_subscribers_sync) {
+  benchmark_scenario(make_multiple_subscribers_scenario(true));
+}
+
+TEST(benchmark_streaming, scenario_multiple_subscribers_async) {
+  benchmark_scenario(make_multiple_subscribers_scenario(false));
+}
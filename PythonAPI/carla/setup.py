@@ -52,7 +52,9 @@ def get_libcarla_extensions():
                 os.path.join(pwd, 'dependencies/lib/libDetour.a'),
                 os.path.join(pwd, 'dependencies/lib/libDetourCrowd.a'),
                 os.path.join(pwd, 'dependencies/lib/libosm2odr.a'),
-                os.path.join(pwd, 'dependencies/lib/libxerces-c.a')]
+                os.path.join(pwd, 'dependencies/lib/libxerces-c.a'),
+                os.path.join(pwd, 'dependencies/lib/liblz4.a'),
+                os.path.join(pwd, 'dependencies/lib/libzstd.a')]
             extra_link_args += ['-lz']
             extra_compile_args = [
                 '-isystem', 'dependencies/include/system', '-fPIC', '-std=c++14',
@@ -94,6 +96,9 @@ def get_libcarla_extensions():
             else:
                 extra_link_args += ['-lpng', '-ljpeg', '-ltiff']
                 extra_compile_args += ['-DLIBCARLA_IMAGE_WITH_PNG_SUPPORT=true']
+
+            # shm_open, used by the shared memory streaming transport.
+            extra_link_args += ['-lrt']
             # @todo Why would we need this?
             # include_dirs += ['/usr/lib/gcc/x86_64-linux-gnu/7/include']
             # library_dirs += ['/usr/lib/gcc/x86_64-linux-gnu/7']
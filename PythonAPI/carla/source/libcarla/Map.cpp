@@ -15,6 +15,8 @@
 
 #include <ostream>
 #include <fstream>
+#include <string>
+#include <vector>
 
 namespace carla {
 namespace client {
@@ -72,6 +74,86 @@ static auto GetLaneValidities(const carla::client::Landmark &self){
   return result;
 }
 
+static auto GetWaypoints(
+    const carla::client::Map &self,
+    const boost::python::object &locations,
+    bool project_to_road,
+    int32_t lane_type) {
+  const std::vector<carla::geom::Location> query{
+      boost::python::stl_input_iterator<carla::geom::Location>(locations),
+      boost::python::stl_input_iterator<carla::geom::Location>()};
+  std::vector<carla::SharedPtr<carla::client::Waypoint>> waypoints;
+  {
+    carla::PythonUtil::ReleaseGIL unlock;
+    waypoints = self.GetWaypoints(query, project_to_road, lane_type);
+  }
+  boost::python::list result;
+  for (const auto &waypoint : waypoints) {
+    result.append(waypoint);
+  }
+  return result;
+}
+
+// Reads the distances straight from the memory of objects exposing a
+// contiguous buffer of doubles, like float64 numpy arrays, and element by
+// element from any other iterable.
+static std::vector<double> ToDistanceVector(const boost::python::object &s_values) {
+#if PY_MAJOR_VERSION >= 3
+  if (PyObject_CheckBuffer(s_values.ptr())) {
+    Py_buffer view;
+    if (PyObject_GetBuffer(s_values.ptr(), &view, PyBUF_C_CONTIGUOUS | PyBUF_FORMAT) == 0) {
+      const bool is_double =
+          view.format != nullptr &&
+          std::string(view.format) == "d" &&
+          view.itemsize == sizeof(double);
+      std::vector<double> result;
+      if (is_double) {
+        const auto *data = static_cast<const double *>(view.buf);
+        result.assign(data, data + view.len / view.itemsize);
+      }
+      PyBuffer_Release(&view);
+      if (is_double) {
+        return result;
+      }
+    } else {
+      PyErr_Clear();
+    }
+  }
+#endif
+  return std::vector<double>{
+      boost::python::stl_input_iterator<double>(s_values),
+      boost::python::stl_input_iterator<double>()};
+}
+
+// Returns the transforms as the bytes of a float32 array of N rows of
+// (x, y, z, pitch, yaw, roll), ready for numpy.frombuffer.
+static auto ComputeTransformsXODR(
+    const carla::client::Map &self,
+    carla::road::RoadId road_id,
+    carla::road::LaneId lane_id,
+    const boost::python::object &s_values) {
+  const auto distances = ToDistanceVector(s_values);
+  std::vector<float> data;
+  {
+    carla::PythonUtil::ReleaseGIL unlock;
+    const auto transforms = self.ComputeTransformsXODR(road_id, lane_id, distances);
+    data.reserve(6u * transforms.size());
+    for (const auto &transform : transforms) {
+      data.insert(data.end(), {
+          transform.location.x,
+          transform.location.y,
+          transform.location.z,
+          transform.rotation.pitch,
+          transform.rotation.yaw,
+          transform.rotation.roll});
+    }
+  }
+  auto *bytes = PyBytes_FromStringAndSize(
+      reinterpret_cast<const char *>(data.data()),
+      static_cast<Py_ssize_t>(sizeof(float) * data.size()));
+  return boost::python::object(boost::python::handle<>(bytes));
+}
+
 static carla::geom::GeoLocation ToGeolocation(
     const carla::client::Map &self,
     const carla::geom::Location &location) {
@@ -159,7 +241,9 @@ void export_map() {
     .add_property("name", CALL_RETURNING_COPY(cc::Map, GetName))
     .def("get_spawn_points", CALL_RETURNING_LIST(cc::Map, GetRecommendedSpawnPoints))
     .def("get_waypoint", &cc::Map::GetWaypoint, (arg("location"), arg("project_to_road")=true, arg("lane_type")=cr::Lane::LaneType::Driving))
+    .def("get_waypoints", &GetWaypoints, (arg("locations"), arg("project_to_road")=true, arg("lane_type")=cr::Lane::LaneType::Driving))
     .def("get_waypoint_xodr", &cc::Map::GetWaypointXODR, (arg("road_id"), arg("lane_id"), arg("s")))
+    .def("compute_transforms_xodr", &ComputeTransformsXODR, (arg("road_id"), arg("lane_id"), arg("s_values")))
     .def("get_topology", &GetTopology)
     .def("generate_waypoints", CALL_RETURNING_LIST_1(cc::Map, GenerateWaypoints, double), (args("distance")))
     .def("transform_to_geolocation", &ToGeolocation, (arg("location")))
@@ -8,6 +8,7 @@
 #include <carla/client/ClientSideSensor.h>
 #include <carla/client/LaneInvasionSensor.h>
 #include <carla/client/Sensor.h>
+#include <carla/client/SensorSynchronizer.h>
 #include <carla/client/ServerSideSensor.h>
 
 static void SubscribeToStream(carla::client::Sensor &self, boost::python::object callback) {
@@ -21,6 +22,68 @@ static void SubscribeToGBuffer(
   self.ListenToGBuffer(GBufferId, MakeCallback(std::move(callback)));
 }
 
+static auto MakeSensorSynchronizer(
+    const boost::python::list &sensors,
+    size_t max_pending_frames,
+    bool deliver_partial) {
+  namespace cc = carla::client;
+  cc::SensorSynchronizer::Settings settings;
+  settings.max_pending_frames = max_pending_frames;
+  settings.missing_frame_policy = deliver_partial ?
+      cc::SensorSynchronizer::MissingFramePolicy::DeliverPartial :
+      cc::SensorSynchronizer::MissingFramePolicy::Drop;
+  std::vector<carla::SharedPtr<cc::Sensor>> list{
+      boost::python::stl_input_iterator<carla::SharedPtr<cc::Sensor>>(sensors),
+      boost::python::stl_input_iterator<carla::SharedPtr<cc::Sensor>>()};
+  return boost::make_shared<cc::SensorSynchronizer>(std::move(list), settings);
+}
+
+static void SynchronizerListen(carla::client::SensorSynchronizer &self, boost::python::object callback) {
+  if (callback.is_none()) {
+    carla::PythonUtil::ReleaseGIL unlock;
+    self.Listen();
+  } else {
+    auto function = MakeCallback(std::move(callback));
+    // Listen takes locks shared with the streaming threads, which may be
+    // waiting for the GIL to run the callback.
+    carla::PythonUtil::ReleaseGIL unlock;
+    self.Listen(std::move(function));
+  }
+}
+
+static auto SynchronizerGet(carla::client::SensorSynchronizer &self, double seconds) {
+  carla::PythonUtil::ReleaseGIL unlock;
+  return self.Get(TimeDurationFromSeconds(seconds));
+}
+
+static auto SynchronizerGetFrame(carla::client::SensorSynchronizer &self, uint64_t frame, double seconds) {
+  carla::PythonUtil::ReleaseGIL unlock;
+  return self.Get(frame, TimeDurationFromSeconds(seconds));
+}
+
+static auto SynchronizerStop(carla::client::SensorSynchronizer &self) {
+  carla::PythonUtil::ReleaseGIL unlock;
+  self.Stop();
+}
+
+static auto GetSynchronizerStatistics(const carla::client::SensorSynchronizer &self) {
+  const auto stats = self.GetStatistics();
+  boost::python::dict result;
+  result["complete"] = stats.complete;
+  result["partial"] = stats.partial;
+  result["dropped"] = stats.dropped;
+  result["late"] = stats.late;
+  return result;
+}
+
+static auto GetBundleData(const carla::client::SensorSynchronizer::Bundle &self) {
+  boost::python::list result;
+  for (auto &data : self.data) {
+    result.append(data == nullptr ? boost::python::object() : boost::python::object(data));
+  }
+  return result;
+}
+
 void export_sensor() {
   using namespace boost::python;
   namespace cc = carla::client;
@@ -54,4 +117,25 @@ void export_sensor() {
     .def(self_ns::str(self_ns::self))
   ;
 
+  class_<cc::SensorSynchronizer::Bundle, boost::noncopyable, boost::shared_ptr<cc::SensorSynchronizer::Bundle>>
+      ("SensorBundle", no_init)
+    .def_readonly("frame", &cc::SensorSynchronizer::Bundle::frame)
+    .def_readonly("is_complete", &cc::SensorSynchronizer::Bundle::is_complete)
+    .add_property("data", &GetBundleData)
+    .def("__len__", +[](const cc::SensorSynchronizer::Bundle &self) { return self.data.size(); })
+  ;
+
+  class_<cc::SensorSynchronizer, boost::noncopyable, boost::shared_ptr<cc::SensorSynchronizer>>
+      ("SensorSynchronizer", no_init)
+    .def("__init__", make_constructor(&MakeSensorSynchronizer, default_call_policies(),
+        (arg("sensors"), arg("max_pending_frames")=8u, arg("deliver_partial")=false)))
+    .add_property("is_listening", &cc::SensorSynchronizer::IsListening)
+    .add_property("sensors", CALL_RETURNING_LIST(cc::SensorSynchronizer, GetSensors))
+    .def("listen", &SynchronizerListen, (arg("callback")=object()))
+    .def("stop", &SynchronizerStop)
+    .def("get", &SynchronizerGet, (arg("seconds")=10.0))
+    .def("get_frame", &SynchronizerGetFrame, (arg("frame"), arg("seconds")=10.0))
+    .def("get_statistics", &GetSynchronizerStatistics)
+  ;
+
 }
@@ -54,6 +54,10 @@ void InterSetCustomPath(carla::traffic_manager::TrafficManager& self, const Acto
   self.SetCustomPath(actor, PythonLitstToVector<carla::geom::Location>(input), empty_buffer);
 }
 
+void InterSetTickLODBands(carla::traffic_manager::TrafficManager& self, boost::python::list distances, boost::python::list periods) {
+  self.SetTickLODBands(PythonLitstToVector<float>(distances), PythonLitstToVector<uint16_t>(periods));
+}
+
 void InterSetImportedRoute(carla::traffic_manager::TrafficManager& self, const ActorPtr &actor, boost::python::list input, bool empty_buffer) {
   self.SetImportedRoute(actor, RoadOptionToUint(input), empty_buffer);
 }
@@ -79,11 +83,31 @@ boost::python::list InterGetActionBuffer(carla::traffic_manager::TrafficManager&
 }
 
 
+boost::python::list InterGetStageProfile(carla::traffic_manager::TrafficManager& self) {
+  boost::python::list l;
+  for (auto &stage : self.GetStageProfile()) {
+    l.append(stage);
+  }
+  return l;
+}
+
 void export_trafficmanager() {
   namespace cc = carla::client;
   namespace ctm = carla::traffic_manager;
   using namespace boost::python;
 
+  class_<ctm::StageProfile>("TrafficManagerStageProfile", no_init)
+    .def_readonly("name", &ctm::StageProfile::name)
+    .def_readonly("cycles", &ctm::StageProfile::cycles)
+    .def_readonly("mean_ms", &ctm::StageProfile::mean_ms)
+    .def_readonly("p50_ms", &ctm::StageProfile::p50_ms)
+    .def_readonly("p99_ms", &ctm::StageProfile::p99_ms)
+    .def_readonly("max_ms", &ctm::StageProfile::max_ms)
+    .def_readonly("last_ms", &ctm::StageProfile::last_ms)
+    .def_readonly("last_vehicles", &ctm::StageProfile::last_vehicles)
+    .def_readonly("max_vehicles", &ctm::StageProfile::max_vehicles)
+  ;
+
   class_<ctm::TrafficManager>("TrafficManager", no_init)
     .def("get_port", &ctm::TrafficManager::Port)
     .def("vehicle_percentage_speed_difference", &ctm::TrafficManager::SetPercentageSpeedDifference, (arg("actor"), arg("percentage")))
@@ -109,11 +133,17 @@ void export_trafficmanager() {
     .def("set_hybrid_physics_radius", &ctm::TrafficManager::SetHybridPhysicsRadius, (arg("r")))
     .def("set_random_device_seed", &ctm::TrafficManager::SetRandomDeviceSeed, (arg("value")))
     .def("set_osm_mode", &carla::traffic_manager::TrafficManager::SetOSMMode, (arg("mode_switch")))
+    .def("set_parallel_stage_threads", &carla::traffic_manager::TrafficManager::SetParallelStageThreads, (arg("num_threads")))
+    .def("set_tick_lod_mode", &carla::traffic_manager::TrafficManager::SetTickLODMode, (arg("mode_switch")))
+    .def("set_tick_lod_bands", &InterSetTickLODBands, (arg("distances"), arg("periods")))
     .def("set_path", &InterSetCustomPath, (arg("actor"), arg("path"), arg("empty_buffer")=true))
     .def("set_route", &InterSetImportedRoute, (arg("actor"), arg("path"), arg("empty_buffer")=true))
     .def("set_respawn_dormant_vehicles", &carla::traffic_manager::TrafficManager::SetRespawnDormantVehicles, (arg("mode_switch")))
     .def("set_boundaries_respawn_dormant_vehicles", &carla::traffic_manager::TrafficManager::SetBoundariesRespawnDormantVehicles, (arg("lower_bound"), arg("upper_bound")))
     .def("get_next_action", &InterGetNextAction, (arg("actor")))
     .def("get_all_actions", &InterGetActionBuffer, (arg("actor")))
+    .def("get_stage_profile", &InterGetStageProfile)
+    .def("reset_stage_profile", &ctm::TrafficManager::ResetStageProfile)
+    .def("get_stage_profile_trace", &ctm::TrafficManager::GetStageProfileTrace)
     .def("shut_down", &ctm::TrafficManager::ShutDown);
 }
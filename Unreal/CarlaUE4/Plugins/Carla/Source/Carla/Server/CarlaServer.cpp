@@ -56,6 +56,7 @@
 #include <carla/rpc/VehicleDoor.h>
 #include <carla/rpc/VehicleAckermannControl.h>
 #include <carla/rpc/VehicleControl.h>
+#include <carla/rpc/VehicleControlBatch.h>
 #include <carla/rpc/VehiclePhysicsControl.h>
 #include <carla/rpc/VehicleLightState.h>
 #include <carla/rpc/VehicleLightStateList.h>
@@ -2520,6 +2521,44 @@ BIND_SYNC(is_sensor_enabled_for_ros) << [this](carla::streaming::detail::stream_
     return result;
   };
 
+  BIND_SYNC(apply_vehicle_control_batch) << [=](
+      const std::vector<unsigned char> &data,
+      bool do_tick_cue) -> R<uint32_t>
+  {
+    cr::VehicleControlBatch batch;
+    if (!batch.Decode(data.data(), data.size()))
+    {
+      RESPOND_ERROR("apply_vehicle_control_batch: invalid batch");
+    }
+    uint32_t failed_commands = 0u;
+    for (size_t i = 0u; i < batch.GetNumberOfControls(); ++i)
+    {
+      if (apply_control_to_vehicle(batch.GetControlActor(i), batch.GetControl(i)).HasError())
+      {
+        ++failed_commands;
+      }
+    }
+    for (size_t i = 0u; i < batch.GetNumberOfTransforms(); ++i)
+    {
+      if (set_actor_transform(batch.GetTransformActor(i), batch.GetTransform(i)).HasError())
+      {
+        ++failed_commands;
+      }
+    }
+    for (size_t i = 0u; i < batch.GetNumberOfLightStates(); ++i)
+    {
+      if (set_vehicle_light_state(batch.GetLightStateActor(i), batch.GetLightState(i)).HasError())
+      {
+        ++failed_commands;
+      }
+    }
+    if (do_tick_cue)
+    {
+      tick_cue();
+    }
+    return failed_commands;
+  };
+
   // ~~ Light Subsystem ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
   BIND_SYNC(query_lights_state) << [this](std::string client) -> R<std::vector<cr::LightState>>
@@ -2676,6 +2715,37 @@ void FCarlaServer::AsyncRun(uint32 NumberOfWorkerThreads)
   UE_LOG(LogCarla, Log, TEXT("FCarlaServer AsyncRun %d, RPCThreads %d, StreamingThreads %d, SecondaryThreads %d"),
         NumberOfWorkerThreads, RPCThreads, StreamingThreads, SecondaryThreads);
 
+  if (FParse::Param(FCommandLine::Get(), TEXT("-SharedMemoryStreaming")))
+  {
+    // Sensor streams are also published through shared memory for the
+    // clients running on this host.
+    UE_LOG(LogCarla, Log, TEXT("FCarlaServer shared memory streaming enabled"));
+    Pimpl->StreamingServer.SetSharedMemoryTransport(true);
+  }
+
+  FString StreamingCompression;
+  if (FParse::Value(FCommandLine::Get(), TEXT("-StreamingCompression="), StreamingCompression))
+  {
+    // Sensor streams are compressed for the clients that support the codec.
+    carla::streaming::detail::CompressionSettings Compression;
+    if (StreamingCompression.Equals(TEXT("lz4"), ESearchCase::IgnoreCase))
+    {
+      Compression.codec = carla::streaming::detail::Codec::LZ4;
+    }
+    else if (StreamingCompression.Equals(TEXT("zstd"), ESearchCase::IgnoreCase))
+    {
+      Compression.codec = carla::streaming::detail::Codec::Zstd;
+    }
+    else
+    {
+      UE_LOG(LogCarla, Warning, TEXT("FCarlaServer unknown streaming codec %s, streams not compressed"), *StreamingCompression);
+    }
+    Compression.delta = FParse::Param(FCommandLine::Get(), TEXT("-StreamingCompressionDelta"));
+    UE_LOG(LogCarla, Log, TEXT("FCarlaServer streaming compression %s%s"),
+        *StreamingCompression, Compression.delta ? TEXT(" (delta)") : TEXT(""));
+    Pimpl->StreamingServer.SetDefaultCompression(Compression);
+  }
+
   Pimpl->Server.AsyncRun(RPCThreads);
   Pimpl->StreamingServer.AsyncRun(StreamingThreads);
   Pimpl->SecondaryServer->AsyncRun(SecondaryThreads);
@@ -35,6 +35,9 @@ LIBCARLA_DEBUG=false
 SMOKE_TESTS=false
 PYTHON_API=false
 RUN_BENCHMARK=false
+# The benchmarks of the client are left out of its unit test runs, a filter in
+# GTEST_ARGS takes precedence since it is passed afterwards.
+CLIENT_GTEST_FILTER="--gtest_filter=-benchmark*"
 
 OPTS=`getopt -o h --long help,gdb,xml,gtest_args:,all,libcarla-release,libcarla-debug,python-api,smoke,benchmark,python-version:, -n 'parse-options' -- "$@"`
 
@@ -78,6 +81,7 @@ while [[ $# -gt 0 ]]; do
       LIBCARLA_RELEASE=true;
       RUN_BENCHMARK=true;
       GTEST_ARGS="--gtest_filter=benchmark*";
+      CLIENT_GTEST_FILTER=;
       shift ;;
     --python-version )
       PY_VERSION_LIST="$2"
@@ -138,8 +142,8 @@ if ${LIBCARLA_DEBUG} ; then
   LD_LIBRARY_PATH=${LIBCARLA_INSTALL_SERVER_FOLDER}/lib ${GDB} ${LIBCARLA_INSTALL_SERVER_FOLDER}/test/libcarla_test_server_debug ${GTEST_ARGS} ${EXTRA_ARGS}
 
   log "Running LibCarla.client unit tests (debug)."
-  echo "Running: ${GDB} libcarla_test_client_debug ${GTEST_ARGS} ${EXTRA_ARGS}"
-  ${GDB} ${LIBCARLA_INSTALL_CLIENT_FOLDER}/test/libcarla_test_client_debug ${GTEST_ARGS} ${EXTRA_ARGS}
+  echo "Running: ${GDB} libcarla_test_client_debug ${CLIENT_GTEST_FILTER} ${GTEST_ARGS} ${EXTRA_ARGS}"
+  ${GDB} ${LIBCARLA_INSTALL_CLIENT_FOLDER}/test/libcarla_test_client_debug ${CLIENT_GTEST_FILTER} ${GTEST_ARGS} ${EXTRA_ARGS}
 
 fi
 
@@ -147,6 +151,9 @@ if ${LIBCARLA_RELEASE} ; then
 
   if ${XML_OUTPUT} ; then
     EXTRA_ARGS="--gtest_output=xml:${CARLA_TEST_RESULTS_FOLDER}/libcarla-release.xml"
+    if ${RUN_BENCHMARK} ; then
+      export CARLA_STREAMING_BENCHMARK_OUTPUT="${CARLA_TEST_RESULTS_FOLDER}/benchmark-streaming.json"
+    fi
   else
     EXTRA_ARGS=
   fi
@@ -155,13 +162,9 @@ if ${LIBCARLA_RELEASE} ; then
   echo "Running: ${GDB} libcarla_test_server_release ${GTEST_ARGS} ${EXTRA_ARGS}"
   LD_LIBRARY_PATH=${LIBCARLA_INSTALL_SERVER_FOLDER}/lib ${GDB} ${LIBCARLA_INSTALL_SERVER_FOLDER}/test/libcarla_test_server_release ${GTEST_ARGS} ${EXTRA_ARGS}
 
-  if ! { ${RUN_BENCHMARK} ; }; then
-
-    log "Running LibCarla.client unit tests (release)."
-    echo "Running: ${GDB} libcarla_test_client_debug ${GTEST_ARGS} ${EXTRA_ARGS}"
-    ${GDB} ${LIBCARLA_INSTALL_CLIENT_FOLDER}/test/libcarla_test_client_release ${GTEST_ARGS} ${EXTRA_ARGS}
-
-  fi
+  log "Running LibCarla.client unit tests (release)."
+  echo "Running: ${GDB} libcarla_test_client_release ${CLIENT_GTEST_FILTER} ${GTEST_ARGS} ${EXTRA_ARGS}"
+  ${GDB} ${LIBCARLA_INSTALL_CLIENT_FOLDER}/test/libcarla_test_client_release ${CLIENT_GTEST_FILTER} ${GTEST_ARGS} ${EXTRA_ARGS}
 
 fi
 
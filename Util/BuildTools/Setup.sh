@@ -600,6 +600,71 @@ cp ${SQLITE_LIB} ${LIBCARLA_INSTALL_CLIENT_FOLDER}/lib/
 mkdir -p ${LIBCARLA_INSTALL_SERVER_FOLDER}/lib/
 cp -p -r ${SQLITE_FULL_LIB} ${LIBCARLA_INSTALL_SERVER_FOLDER}
 
+# ==============================================================================
+# -- Get and compile LZ4 and zstd (streaming compression) ----------------------
+# ==============================================================================
+
+LZ4_VERSION=1.9.4
+LZ4_REPO=https://github.com/lz4/lz4/archive/refs/tags/v${LZ4_VERSION}.tar.gz
+LZ4_BASENAME=lz4-${LZ4_VERSION}
+
+LZ4_INCLUDE=${PWD}/${LZ4_BASENAME}-install/include
+LZ4_LIB=${PWD}/${LZ4_BASENAME}-install/lib/liblz4.a
+
+if [[ -d ${LZ4_BASENAME}-install ]] ; then
+  log "LZ4 already installed."
+else
+  log "Retrieving LZ4."
+  wget ${LZ4_REPO} -O ${LZ4_BASENAME}.tar.gz
+
+  log "Extracting LZ4."
+  tar -xzf ${LZ4_BASENAME}.tar.gz
+  mv ${LZ4_BASENAME} ${LZ4_BASENAME}-source
+
+  pushd ${LZ4_BASENAME}-source >/dev/null
+
+  # C library, the same build links with both libc++ and libstdc++.
+  CFLAGS="-fPIC -O3" make -C lib install BUILD_SHARED=no PREFIX=${CARLA_BUILD_FOLDER}/${LZ4_BASENAME}-install
+
+  popd >/dev/null
+
+  rm -Rf ${LZ4_BASENAME}.tar.gz
+  rm -Rf ${LZ4_BASENAME}-source
+fi
+
+ZSTD_VERSION=1.5.5
+ZSTD_REPO=https://github.com/facebook/zstd/releases/download/v${ZSTD_VERSION}/zstd-${ZSTD_VERSION}.tar.gz
+ZSTD_BASENAME=zstd-${ZSTD_VERSION}
+
+ZSTD_INCLUDE=${PWD}/${ZSTD_BASENAME}-install/include
+ZSTD_LIB=${PWD}/${ZSTD_BASENAME}-install/lib/libzstd.a
+
+if [[ -d ${ZSTD_BASENAME}-install ]] ; then
+  log "zstd already installed."
+else
+  log "Retrieving zstd."
+  wget ${ZSTD_REPO}
+
+  log "Extracting zstd."
+  tar -xzf ${ZSTD_BASENAME}.tar.gz
+  mv ${ZSTD_BASENAME} ${ZSTD_BASENAME}-source
+
+  pushd ${ZSTD_BASENAME}-source >/dev/null
+
+  CFLAGS="-fPIC -O3" make -C lib install-static install-includes PREFIX=${CARLA_BUILD_FOLDER}/${ZSTD_BASENAME}-install
+
+  popd >/dev/null
+
+  rm -Rf ${ZSTD_BASENAME}.tar.gz
+  rm -Rf ${ZSTD_BASENAME}-source
+fi
+
+mkdir -p ${LIBCARLA_INSTALL_CLIENT_FOLDER}/lib/
+cp ${LZ4_LIB} ${ZSTD_LIB} ${LIBCARLA_INSTALL_CLIENT_FOLDER}/lib/
+
+mkdir -p ${LIBCARLA_INSTALL_SERVER_FOLDER}/lib/
+cp ${LZ4_LIB} ${ZSTD_LIB} ${LIBCARLA_INSTALL_SERVER_FOLDER}/lib/
+
 # ==============================================================================
 # -- Get and compile PROJ ------------------------------------------------------
 # ==============================================================================
@@ -948,7 +1013,14 @@ endif ()
 
 add_definitions(-DLIBCARLA_TEST_CONTENT_FOLDER="${LIBCARLA_TEST_CONTENT_FOLDER}")
 
+add_definitions(-DLIBCARLA_STREAMING_WITH_LZ4_SUPPORT=true)
+add_definitions(-DLIBCARLA_STREAMING_WITH_ZSTD_SUPPORT=true)
+
 set(BOOST_INCLUDE_PATH "${BOOST_INCLUDE}")
+set(LZ4_INCLUDE_PATH "${LZ4_INCLUDE}")
+set(LZ4_LIBRARY "${LZ4_LIB}")
+set(ZSTD_INCLUDE_PATH "${ZSTD_INCLUDE}")
+set(ZSTD_LIBRARY "${ZSTD_LIB}")
 set(FASTDDS_INCLUDE_PATH "${FASTDDS_INCLUDE}")
 set(FASTDDS_LIB_PATH "${FASTDDS_LIB}")
 